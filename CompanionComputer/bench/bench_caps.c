@@ -0,0 +1,166 @@
+/**
+ * @file        bench_caps.c
+ * @author      Adam Csizy
+ * @date        2021-05-12
+ * @version     v1.1.0
+ *
+ * @brief       Camera capabilities benchmarks
+ */
+
+
+#include <gst/gst.h>
+#include <stdlib.h>
+
+#include "bench_utils.h"
+#include "camera_utils.h"
+
+
+/* Caps benchmark related macro definitions */
+
+#define NUM_BENCH_CAPS_PARSES       20000U  /**< Parses per repetition at scale 1.0 */
+#define NUM_BENCH_CAPS_STR_SIZE     65536U  /**< Size of the synthetic caps string */
+
+
+/* Caps benchmark related static variable declarations */
+
+/** Media types of the synthetic capabilities (a UVC camera exposes the first three) */
+static const char *const benchMediaTypes[] = {"image/jpeg", "video/x-raw", "video/x-h264", "video/x-h265", "video/x-vp8", "video/x-vp9", "video/x-h263"};
+
+/** Resolutions of the synthetic capabilities (largest last, like v4l2src lists them) */
+static const int benchResolutions[][2] = {
+    {160, 120}, {320, 240}, {424, 240}, {640, 360}, {640, 480}, {800, 448}, {800, 600}, {848, 480},
+    {960, 540}, {1024, 576}, {1280, 720}, {1280, 960}, {1600, 896}, {1920, 1080}, {2304, 1296}, {2560, 1440}
+};
+
+/** Framerates of the synthetic capabilities */
+static const char *const benchFramerates = "{ (fraction)30/1, (fraction)24/1, (fraction)20/1, (fraction)15/1, (fraction)10/1, (fraction)15/2, (fraction)5/1, (fraction)60/1 }";
+
+
+/* Caps benchmark related static function declarations */
+
+/**
+ * @brief       Create synthetic camera capabilities.
+ *
+ * @param[in]   mediaTypes Number of media types (from benchMediaTypes).
+ * @param[in]   resolutions Number of resolutions per media type (from benchResolutions).
+ *
+ * @return      Capabilities (unref with 'gst_caps_unref()') or NULL.
+ */
+static GstCaps* createBenchCaps(const size_t mediaTypes, const size_t resolutions);
+
+/**
+ * @brief       Run a parse benchmark.
+ *
+ * @param[in,out]   ctx Benchmark run context.
+ * @param[in]   name Benchmark name.
+ * @param[in]   mediaTypes Number of media types.
+ * @param[in]   resolutions Number of resolutions per media type.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+static int runCapsBenchmark(BenchContext_T *ctx, const char *name, const size_t mediaTypes, const size_t resolutions);
+
+
+/* Caps benchmark related function definitions */
+
+int runCapsBenchmarks(BenchContext_T *ctx) {
+
+    int retval = 0;
+
+    gst_init(NULL, NULL);
+
+    /* MJPEG, YUY2 and H.264 in 8 resolutions: a typical UVC camera */
+    retval |= runCapsBenchmark(ctx, "caps_parse_uvc", 3, 8);
+    retval |= runCapsBenchmark(ctx, "caps_parse_large", sizeof(benchMediaTypes) / sizeof(benchMediaTypes[0]),
+        sizeof(benchResolutions) / sizeof(benchResolutions[0]));
+
+    return retval;
+}
+
+static GstCaps* createBenchCaps(const size_t mediaTypes, const size_t resolutions) {
+
+    size_t type, resolution, length = 0;
+    char *string = NULL;
+    GstCaps *capabilities = NULL;
+
+    string = (char*)calloc(1, NUM_BENCH_CAPS_STR_SIZE);
+    if(NULL == string) {
+
+        return NULL;
+    }
+
+    for(type = 0;type < mediaTypes;++type) {
+
+        for(resolution = 0;resolution < resolutions;++resolution) {
+
+            length += (size_t)snprintf(&string[length], NUM_BENCH_CAPS_STR_SIZE - length,
+                "%s%s, width=(int)%d, height=(int)%d, pixel-aspect-ratio=(fraction)1/1, framerate=%s",
+                (0 < length) ? "; " : "", benchMediaTypes[type], benchResolutions[resolution][0],
+                benchResolutions[resolution][1], benchFramerates);
+        }
+    }
+
+    if(NUM_BENCH_CAPS_STR_SIZE > length) {
+
+        capabilities = gst_caps_from_string(string);
+    }
+    free(string);
+
+    return capabilities;
+}
+
+static int runCapsBenchmark(BenchContext_T *ctx, const char *name, const size_t mediaTypes, const size_t resolutions) {
+
+    int retval = 0;
+    unsigned int repeat;
+    uint64_t i, parses, startNs;
+    uint64_t elapsedNs[ctx->repeats];
+    GstCaps *capabilities = NULL;
+    VideoCodingFormatCaps_T capsArray[NUM_SUP_VID_COD_FMT];
+    VideoCodingFormatContext_T capsCtx = {.capsArray = capsArray, .size = NUM_SUP_VID_COD_FMT};
+
+    if(!isBenchSelected(ctx, name)) {
+
+        return 0;
+    }
+
+    capabilities = createBenchCaps(mediaTypes, resolutions);
+    if(NULL == capabilities) {
+
+        fprintf(stderr, "runCapsBenchmark(): Failed to create synthetic capabilities.\n");
+        retval = -1;
+        return retval;
+    }
+
+    parses = getBenchIterations(ctx, NUM_BENCH_CAPS_PARSES);
+
+    for(repeat = 0;(0 == retval) && (repeat < ctx->repeats);++repeat) {
+
+        startNs = getBenchTimeNs();
+        for(i = 0;(0 == retval) && (i < parses);++i) {
+
+            retval = parseCameraCapabilities(capabilities, &capsCtx);
+        }
+        elapsedNs[repeat] = getBenchTimeNs() - startNs;
+    }
+
+    /* Sanity check: the best resolution and framerate of the first media type were found */
+    if((0 == retval) && (1 != capsArray[CAM_FMT_JPEG].supported || benchResolutions[resolutions - 1][0] != capsArray[CAM_FMT_JPEG].width ||
+       60 != (capsArray[CAM_FMT_JPEG].framerateNumerator / capsArray[CAM_FMT_JPEG].framerateDenominator))) {
+
+        fprintf(stderr, "runCapsBenchmark(): Unexpected parse result.\n");
+        retval = -1;
+    }
+
+    gst_caps_unref(capabilities);
+
+    if(0 == retval) {
+
+        retval = addBenchResult(ctx, name, parses, elapsedNs, ctx->repeats, NULL, 0);
+    }
+
+    return retval;
+}
@@ -0,0 +1,147 @@
+/**
+ * @file        bench_log.c
+ * @author      Adam Csizy
+ * @date        2021-05-12
+ * @version     v1.1.0
+ *
+ * @brief       Logging benchmarks
+ */
+
+
+#include <syslog.h>
+
+#include "bench_utils.h"
+#include "log_utils.h"
+
+
+/* Log benchmark related macro definitions */
+
+#define NUM_BENCH_LOG_RECORDS       100000U /**< Records per repetition at scale 1.0 */
+#define NUM_BENCH_LOG_SYNC_RECORDS  20000U  /**< Records per repetition of the synchronous benchmark at scale 1.0 */
+#define NUM_BENCH_LOG_BATCH         32U     /**< Records between two flushes (below the per-thread ring size, so nothing is dropped) */
+#define NUM_BENCH_LOG_FILTERED      10000000U /**< Disabled log site calls per repetition at scale 1.0 */
+#define STR_BENCH_LOG_MESSAGE       "bench(): Benchmark log record of typical length, not written anywhere."    /**< Logged message */
+#define STR_BENCH_LOG_FORMAT        "bench(): Benchmark log record" LOG_KV("seq", "%llu") LOG_KV("state", "%s")   /**< Logged format */
+
+
+/* Log benchmark related type definitions */
+
+/**
+ * @brief   Kinds of log benchmarks.
+ */
+typedef enum LogBenchKind {
+
+    LOG_BENCH_PLAIN     = 0,    /**< createLogMessage() */
+    LOG_BENCH_FORMAT    = 1,    /**< createLogMessageFormat() with two arguments */
+    LOG_BENCH_FILTERED  = 2     /**< LOG_MSG_DBG() with the debug level disabled */
+
+} LogBenchKind_T;
+
+
+/* Log benchmark related static function declarations */
+
+/**
+ * @brief       Run a log benchmark.
+ *
+ * @details     Only the producer-side cost is measured: records
+ *              are created in batches and the rings are flushed
+ *              between the batches outside the measured time.
+ *
+ * @param[in,out]   ctx Benchmark run context.
+ * @param[in]   name Benchmark name.
+ * @param[in]   kind Kind of the benchmark.
+ * @param[in]   base Records per repetition at scale 1.0.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+static int runLogBenchmark(BenchContext_T *ctx, const char *name, const LogBenchKind_T kind, const uint64_t base);
+
+
+/* Log benchmark related function definitions */
+
+int runLogBenchmarks(BenchContext_T *ctx) {
+
+    int retval = 0;
+
+    /* Records still reach syslog(); keep them out of the system log */
+    openlog("streamerbench", LOG_NDELAY, LOG_USER);
+    setlogmask(LOG_MASK(LOG_EMERG));
+
+    /* Until initLogModule() records are written synchronously by the caller */
+    retval |= runLogBenchmark(ctx, "log_create_sync", LOG_BENCH_PLAIN, NUM_BENCH_LOG_SYNC_RECORDS);
+
+    if(initLogModule()) {
+
+        fprintf(stderr, "runLogBenchmarks(): Failed to start the asynchronous logger.\n");
+        retval = -1;
+        return retval;
+    }
+
+    retval |= runLogBenchmark(ctx, "log_create_async", LOG_BENCH_PLAIN, NUM_BENCH_LOG_RECORDS);
+    retval |= runLogBenchmark(ctx, "log_create_format_async", LOG_BENCH_FORMAT, NUM_BENCH_LOG_RECORDS);
+
+    setLogLevel(LOG_MOD_GENERAL, LOG_SVRTY_INF);
+    retval |= runLogBenchmark(ctx, "log_filtered_debug", LOG_BENCH_FILTERED, NUM_BENCH_LOG_FILTERED);
+
+    return retval;
+}
+
+static int runLogBenchmark(BenchContext_T *ctx, const char *name, const LogBenchKind_T kind, const uint64_t base) {
+
+    unsigned int repeat;
+    uint64_t i, j, batch, records, startNs;
+    uint64_t elapsedNs[ctx->repeats];
+
+    if(!isBenchSelected(ctx, name)) {
+
+        return 0;
+    }
+
+    records = getBenchIterations(ctx, base);
+
+    for(repeat = 0;repeat < ctx->repeats;++repeat) {
+
+        elapsedNs[repeat] = 0;
+        for(i = 0;i < records;i += batch) {
+
+            batch = ((records - i) < NUM_BENCH_LOG_BATCH) ? (records - i) : NUM_BENCH_LOG_BATCH;
+            if(LOG_BENCH_FILTERED == kind) {
+
+                batch = records - i;
+            }
+
+            startNs = getBenchTimeNs();
+            switch(kind) {
+
+                case LOG_BENCH_PLAIN:
+                    for(j = 0;j < batch;++j) {
+
+                        createLogMessage(STR_BENCH_LOG_MESSAGE, LOG_SVRTY_INF);
+                    }
+                    break;
+
+                case LOG_BENCH_FORMAT:
+                    for(j = 0;j < batch;++j) {
+
+                        createLogMessageFormat(LOG_SVRTY_INF, STR_BENCH_LOG_FORMAT, (unsigned long long)(i + j), "PLAYING");
+                    }
+                    break;
+
+                case LOG_BENCH_FILTERED:
+                    for(j = 0;j < batch;++j) {
+
+                        LOG_MSG_DBG(LOG_MOD_GENERAL, STR_BENCH_LOG_FORMAT, (unsigned long long)(i + j), "PLAYING");
+                    }
+                    break;
+            }
+            elapsedNs[repeat] += getBenchTimeNs() - startNs;
+
+            flushLogMessages();
+        }
+    }
+
+    return addBenchResult(ctx, name, records, elapsedNs, ctx->repeats, NULL, 0);
+}
@@ -0,0 +1,118 @@
+/**
+ * @file        bench_main.c
+ * @author      Adam Csizy
+ * @date        2021-05-12
+ * @version     v1.1.0
+ *
+ * @brief       Microbenchmark program of the streamer's core primitives
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bench_utils.h"
+
+/*
+ * Build and run with the Makefile of the CompanionComputer directory:
+ *
+ * make bench-run                                   # writes build/bench.json
+ * make bench-run BENCH_BASELINE=<old_bench.json>   # also compares against a baseline
+ *
+ * Or launch like this:
+ *
+ * ./streamerbench [-o <JSON_FILE>] [-r <REPEATS>] [-s <SCALE>] [-f <NAME_FILTER>]
+ *
+ * Human readable results go to stderr, JSON to the given file (default: stdout).
+ * Compare two result files with bench/compare_bench.py. Benchmark an
+ * optimized build (not DEBUG=1): debug builds also print every log record.
+ */
+
+
+/**
+ * @brief       Print usage.
+ *
+ * @param[in]   program Program name.
+ */
+static void printUsage(const char *program) {
+
+    fprintf(stderr, "Usage: %s [-o <JSON_FILE>] [-r <REPEATS>] [-s <SCALE>] [-f <NAME_FILTER>]\n", program);
+}
+
+/**
+ * @brief       The benchmark program's main function.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      1 Failure
+ */
+int main(int argc, char *argv[]) {
+
+    int option, retval = 0;
+    const char *outputPath = NULL;
+    FILE *output = stdout;
+    static BenchContext_T ctx;
+
+    ctx.repeats = NUM_BENCH_DEFAULT_REPEATS;
+    ctx.scale = 1.0;
+
+    while(-1 != (option = getopt(argc, argv, "o:r:s:f:h"))) {
+
+        switch(option) {
+
+            case 'o':
+                outputPath = optarg;
+                break;
+
+            case 'r':
+                ctx.repeats = (unsigned int)strtoul(optarg, NULL, 10);
+                break;
+
+            case 's':
+                ctx.scale = strtod(optarg, NULL);
+                break;
+
+            case 'f':
+                ctx.filter = optarg;
+                break;
+
+            default:
+                printUsage(argv[0]);
+                return 1;
+        }
+    }
+
+    if((0 == ctx.repeats) || (0.0 >= ctx.scale)) {
+
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    /* Logging benchmarks go last: they start the asynchronous logger */
+    retval |= runProtocolBenchmarks(&ctx);
+    retval |= runMsgqBenchmarks(&ctx);
+    retval |= runCapsBenchmarks(&ctx);
+    retval |= runLogBenchmarks(&ctx);
+
+    if(NULL != outputPath) {
+
+        output = fopen(outputPath, "w");
+        if(NULL == output) {
+
+            perror(outputPath);
+            return 1;
+        }
+    }
+
+    retval |= writeBenchResults(&ctx, output);
+
+    if(stdout != output) {
+
+        fclose(output);
+    }
+
+    return (0 == retval) ? 0 : 1;
+}
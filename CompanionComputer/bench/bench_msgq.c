@@ -0,0 +1,260 @@
+/**
+ * @file        bench_msgq.c
+ * @author      Adam Csizy
+ * @date        2021-05-12
+ * @version     v1.1.0
+ *
+ * @brief       Module message queue benchmarks
+ */
+
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench_utils.h"
+#include "com_utils.h"
+
+
+/* Message queue benchmark related macro definitions */
+
+#define NUM_BENCH_MSGQ_SIZE         16U     /**< Size of the benchmarked queue (same as the network module's) */
+#define NUM_BENCH_MSGQ_MESSAGES     200000U /**< Messages per repetition at scale 1.0 */
+#define NUM_BENCH_MSGQ_PRODUCERS    4U      /**< Producers of the MPSC benchmarks */
+#define NUM_BENCH_MSGQ_PAIRS        1000000U /**< Insert/remove pairs of the uncontended benchmark at scale 1.0 */
+
+
+/* Message queue benchmark related type definitions */
+
+/**
+ * @brief   Shared state of a queue benchmark repetition.
+ */
+typedef struct MsgqBench {
+
+    ModuleMessageQueue_T queue;         /**< Benchmarked queue */
+    ModuleMessage_T *messages;          /**< Message pool (one message per operation) */
+    uint64_t *insertNs;                 /**< Insertion time of each message */
+    uint32_t *latencyNs;                /**< Latency samples of all repetitions */
+    size_t latencyCount;                /**< Number of latency samples */
+    pthread_barrier_t start;            /**< Start barrier of the producers and the consumer */
+    uint64_t messagesPerProducer;       /**< Messages inserted by each producer */
+    int noblock;                        /**< Queue flag of the benchmark */
+
+} MsgqBench_T;
+
+/**
+ * @brief   Arguments of a producer thread.
+ */
+typedef struct MsgqProducer {
+
+    MsgqBench_T *bench;                 /**< Shared state */
+    uint64_t first;                     /**< Index of the producer's first message in the pool */
+
+} MsgqProducer_T;
+
+
+/* Message queue benchmark related static function declarations */
+
+/**
+ * @brief       Producer thread function.
+ *
+ * @param[in]   arg Producer arguments (MsgqProducer_T).
+ *
+ * @return      NULL
+ */
+static void* threadFuncProducer(void *arg);
+
+/**
+ * @brief       Run a producer/consumer benchmark.
+ *
+ * @details     The calling thread is the consumer. Throughput is
+ *              measured from the start barrier until the last
+ *              message is removed; latency is the time between
+ *              the insertion attempt and the removal of each
+ *              message.
+ *
+ * @param[in,out]   ctx Benchmark run context.
+ * @param[in]   name Benchmark name.
+ * @param[in]   producers Number of producer threads.
+ * @param[in]   noblock Queue flag.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+static int runProducerConsumer(BenchContext_T *ctx, const char *name, const unsigned int producers, const int noblock);
+
+/**
+ * @brief       Run the uncontended insert/remove benchmark.
+ *
+ * @param[in,out]   ctx Benchmark run context.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+static int runUncontended(BenchContext_T *ctx);
+
+
+/* Message queue benchmark related function definitions */
+
+int runMsgqBenchmarks(BenchContext_T *ctx) {
+
+    int retval = 0;
+
+    retval |= runUncontended(ctx);
+    retval |= runProducerConsumer(ctx, "msgq_spsc_block", 1, MOD_MSGQ_BLOCK);
+    retval |= runProducerConsumer(ctx, "msgq_spsc_noblock", 1, MOD_MSGQ_NOBLOCK);
+    retval |= runProducerConsumer(ctx, "msgq_mpsc4_block", NUM_BENCH_MSGQ_PRODUCERS, MOD_MSGQ_BLOCK);
+    retval |= runProducerConsumer(ctx, "msgq_mpsc4_noblock", NUM_BENCH_MSGQ_PRODUCERS, MOD_MSGQ_NOBLOCK);
+
+    return retval;
+}
+
+static void* threadFuncProducer(void *arg) {
+
+    uint64_t i;
+    MsgqProducer_T *producer = (MsgqProducer_T*)arg;
+    MsgqBench_T *bench = producer->bench;
+
+    pthread_barrier_wait(&bench->start);
+
+    for(i = producer->first;i < (producer->first + bench->messagesPerProducer);++i) {
+
+        bench->insertNs[i] = getBenchTimeNs();
+        while(0 != insertModuleMessage(&bench->queue, &bench->messages[i], bench->noblock)) {
+
+            sched_yield();
+        }
+    }
+
+    return NULL;
+}
+
+static int runProducerConsumer(BenchContext_T *ctx, const char *name, const unsigned int producers, const int noblock) {
+
+    int retval = 0;
+    unsigned int repeat, thread;
+    uint64_t i, total, startNs;
+    uint64_t elapsedNs[ctx->repeats];
+    pthread_t threads[producers];
+    MsgqProducer_T producerArgs[producers];
+    ModuleMessage_T *message = NULL;
+    MsgqBench_T bench;
+
+    if(!isBenchSelected(ctx, name)) {
+
+        return 0;
+    }
+
+    memset(&bench, 0, sizeof(bench));
+    bench.noblock = noblock;
+    bench.messagesPerProducer = getBenchIterations(ctx, NUM_BENCH_MSGQ_MESSAGES / producers);
+    total = bench.messagesPerProducer * producers;
+
+    bench.messages = (ModuleMessage_T*)calloc(total, sizeof(ModuleMessage_T));
+    bench.insertNs = (uint64_t*)calloc(total, sizeof(uint64_t));
+    bench.latencyNs = (uint32_t*)calloc(total * ctx->repeats, sizeof(uint32_t));
+    if((NULL == bench.messages) || (NULL == bench.insertNs) || (NULL == bench.latencyNs)) {
+
+        free(bench.messages);
+        free(bench.insertNs);
+        free(bench.latencyNs);
+        retval = -1;
+        return retval;
+    }
+
+    for(i = 0;i < total;++i) {
+
+        bench.messages[i].address = MOD_NAME_STREAM;
+        bench.messages[i].code = MOD_MSG_CODE_STREAM_START;
+    }
+
+    for(repeat = 0;(0 == retval) && (repeat < ctx->repeats);++repeat) {
+
+        if(initModuleMessageQueue(&bench.queue, NUM_BENCH_MSGQ_SIZE)) {
+
+            retval = -1;
+            break;
+        }
+        pthread_barrier_init(&bench.start, NULL, producers + 1);
+
+        for(thread = 0;thread < producers;++thread) {
+
+            producerArgs[thread].bench = &bench;
+            producerArgs[thread].first = thread * bench.messagesPerProducer;
+            pthread_create(&threads[thread], NULL, threadFuncProducer, &producerArgs[thread]);
+        }
+
+        pthread_barrier_wait(&bench.start);
+        startNs = getBenchTimeNs();
+
+        for(i = 0;i < total;++i) {
+
+            while(0 != removeModuleMessage(&bench.queue, &message, noblock)) {
+
+                sched_yield();
+            }
+            bench.latencyNs[bench.latencyCount++] = (uint32_t)(getBenchTimeNs() - bench.insertNs[message - bench.messages]);
+        }
+
+        elapsedNs[repeat] = getBenchTimeNs() - startNs;
+
+        for(thread = 0;thread < producers;++thread) {
+
+            pthread_join(threads[thread], NULL);
+        }
+        pthread_barrier_destroy(&bench.start);
+        deinitModuleMessageQueue(&bench.queue);
+    }
+
+    if(0 == retval) {
+
+        retval = addBenchResult(ctx, name, total, elapsedNs, ctx->repeats, bench.latencyNs, bench.latencyCount);
+    }
+
+    free(bench.messages);
+    free(bench.insertNs);
+    free(bench.latencyNs);
+
+    return retval;
+}
+
+static int runUncontended(BenchContext_T *ctx) {
+
+    unsigned int repeat;
+    uint64_t i, pairs, startNs;
+    uint64_t elapsedNs[ctx->repeats];
+    ModuleMessageQueue_T queue;
+    ModuleMessage_T message = {.address = MOD_NAME_STREAM, .code = MOD_MSG_CODE_STREAM_START};
+    ModuleMessage_T *removed = NULL;
+
+    if(!isBenchSelected(ctx, "msgq_insert_remove")) {
+
+        return 0;
+    }
+
+    pairs = getBenchIterations(ctx, NUM_BENCH_MSGQ_PAIRS);
+    if(initModuleMessageQueue(&queue, NUM_BENCH_MSGQ_SIZE)) {
+
+        return -1;
+    }
+
+    for(repeat = 0;repeat < ctx->repeats;++repeat) {
+
+        startNs = getBenchTimeNs();
+        for(i = 0;i < pairs;++i) {
+
+            insertModuleMessage(&queue, &message, MOD_MSGQ_BLOCK);
+            removeModuleMessage(&queue, &removed, MOD_MSGQ_BLOCK);
+        }
+        elapsedNs[repeat] = getBenchTimeNs() - startNs;
+    }
+
+    deinitModuleMessageQueue(&queue);
+
+    return addBenchResult(ctx, "msgq_insert_remove", pairs, elapsedNs, ctx->repeats, NULL, 0);
+}
@@ -0,0 +1,82 @@
+/**
+ * @file        bench_protocol.c
+ * @author      Adam Csizy
+ * @date        2021-05-12
+ * @version     v1.1.0
+ *
+ * @brief       Network protocol benchmarks
+ */
+
+
+#include "bench_utils.h"
+#include "com_utils.h"
+
+
+/* Protocol benchmark related macro definitions */
+
+#define NUM_BENCH_PROTO_MESSAGES    5000000U    /**< Messages per repetition at scale 1.0 */
+
+
+/* Protocol benchmark related static variable declarations */
+
+static volatile uint64_t benchSink = 0;     /**< Keeps the compiler from discarding the measured work */
+
+
+/* Protocol benchmark related function definitions */
+
+int runProtocolBenchmarks(BenchContext_T *ctx) {
+
+    int retval = 0;
+    unsigned int repeat;
+    uint64_t i, messages, startNs, sink;
+    uint64_t elapsedNs[ctx->repeats];
+    uint8_t buffer[NUM_NET_MSG_MAX_SIZE] = {0};
+    ModuleMessage_T message = {.address = MOD_NAME_GCCOMMON, .code = MOD_MSG_CODE_STREAM_TYPE};
+    ModuleMessage_T decoded = {0};
+
+    messages = getBenchIterations(ctx, NUM_BENCH_PROTO_MESSAGES);
+
+    if(isBenchSelected(ctx, "proto_encode")) {
+
+        for(repeat = 0;repeat < ctx->repeats;++repeat) {
+
+            sink = 0;
+            startNs = getBenchTimeNs();
+            for(i = 0;i < messages;++i) {
+
+                message.data.codingFormat = (VideoCodingFormat_T)(i % NUM_SUP_VID_COD_FMT);
+                sink += (uint64_t)encodeNetworkMessage(&message, buffer, sizeof(buffer));
+                sink += buffer[NUM_NET_MSG_HEADER_SIZE];
+            }
+            elapsedNs[repeat] = getBenchTimeNs() - startNs;
+            benchSink += sink;
+        }
+        retval |= addBenchResult(ctx, "proto_encode", messages, elapsedNs, ctx->repeats, NULL, 0);
+    }
+
+    if(isBenchSelected(ctx, "proto_decode")) {
+
+        message.code = MOD_MSG_CODE_STREAM_REQ;
+        message.data.videoStreamPort = 5000U;
+        encodeNetworkMessage(&message, buffer, sizeof(buffer));
+
+        for(repeat = 0;repeat < ctx->repeats;++repeat) {
+
+            sink = 0;
+            startNs = getBenchTimeNs();
+            for(i = 0;i < messages;++i) {
+
+                buffer[NUM_NET_MSG_HEADER_SIZE] = (uint8_t)(i);
+                decodeNetworkMessageHeader(buffer, sizeof(buffer), &decoded);
+                decodeNetworkMessageData(&buffer[NUM_NET_MSG_HEADER_SIZE],
+                    sizeof(buffer) - NUM_NET_MSG_HEADER_SIZE, &decoded);
+                sink += decoded.data.videoStreamPort;
+            }
+            elapsedNs[repeat] = getBenchTimeNs() - startNs;
+            benchSink += sink;
+        }
+        retval |= addBenchResult(ctx, "proto_decode", messages, elapsedNs, ctx->repeats, NULL, 0);
+    }
+
+    return retval;
+}
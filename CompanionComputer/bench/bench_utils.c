@@ -0,0 +1,177 @@
+/**
+ * @file        bench_utils.c
+ * @author      Adam Csizy
+ * @date        2021-05-12
+ * @version     v1.1.0
+ *
+ * @brief       Microbenchmark utilities
+ */
+
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "bench_utils.h"
+
+
+/* Benchmark related static function declarations */
+
+/**
+ * @brief       Compare 64 bit unsigned integers (qsort callback).
+ *
+ * @param[in]   first Pointer to the first value.
+ * @param[in]   second Pointer to the second value.
+ *
+ * @return      Negative, zero or positive like 'strcmp()'.
+ */
+static int compareU64(const void *first, const void *second);
+
+/**
+ * @brief       Compare 32 bit unsigned integers (qsort callback).
+ *
+ * @param[in]   first Pointer to the first value.
+ * @param[in]   second Pointer to the second value.
+ *
+ * @return      Negative, zero or positive like 'strcmp()'.
+ */
+static int compareU32(const void *first, const void *second);
+
+/**
+ * @brief       Get percentile of sorted samples.
+ *
+ * @param[in]   samples Sorted samples.
+ * @param[in]   count Number of samples (non-zero).
+ * @param[in]   percentile Percentile (0..100).
+ *
+ * @return      Nearest-rank percentile.
+ */
+static double getPercentile(const uint32_t samples[], const size_t count, const double percentile);
+
+
+/* Benchmark related function definitions */
+
+uint64_t getBenchTimeNs(void) {
+
+    struct timespec now = {0};
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return ((uint64_t)(now.tv_sec) * NUM_NSEC_PER_SEC) + (uint64_t)(now.tv_nsec);
+}
+
+int isBenchSelected(const BenchContext_T *ctx, const char *name) {
+
+    return ((NULL == ctx->filter) || (NULL != strstr(name, ctx->filter)));
+}
+
+uint64_t getBenchIterations(const BenchContext_T *ctx, const uint64_t base) {
+
+    uint64_t iterations = (uint64_t)((double)(base) * ctx->scale);
+
+    return (0 < iterations) ? iterations : 1;
+}
+
+int addBenchResult(BenchContext_T *ctx, const char *name, const uint64_t iterations,
+    uint64_t elapsedNs[], const size_t repeats, uint32_t latencyNs[], const size_t latencyCount) {
+
+    BenchResult_T *result = NULL;
+
+    if((NULL == ctx) || (NULL == name) || (NULL == elapsedNs) || (0 == repeats) || (0 == iterations) ||
+       (NUM_BENCH_MAX_RESULTS <= ctx->count)) {
+
+        return -1;
+    }
+
+    result = &ctx->results[ctx->count];
+    memset(result, 0, sizeof(BenchResult_T));
+    strncpy(result->name, name, NUM_BENCH_NAME_SIZE - 1);
+    result->iterations = iterations;
+
+    qsort(elapsedNs, repeats, sizeof(uint64_t), compareU64);
+    result->nsPerOp = (double)(elapsedNs[repeats / 2]) / (double)(iterations);
+    result->nsPerOpMin = (double)(elapsedNs[0]) / (double)(iterations);
+
+    if((NULL != latencyNs) && (0 < latencyCount)) {
+
+        qsort(latencyNs, latencyCount, sizeof(uint32_t), compareU32);
+        result->hasLatency = 1;
+        result->latencyP50Ns = getPercentile(latencyNs, latencyCount, 50.0);
+        result->latencyP99Ns = getPercentile(latencyNs, latencyCount, 99.0);
+        result->latencyMaxNs = (double)(latencyNs[latencyCount - 1]);
+    }
+
+    fprintf(stderr, "%-32s %12.1f ns/op %14.0f ops/s", result->name, result->nsPerOp, NUM_NSEC_PER_SEC / result->nsPerOp);
+    if(result->hasLatency) {
+
+        fprintf(stderr, "   latency p50 %.0f ns p99 %.0f ns max %.0f ns", result->latencyP50Ns, result->latencyP99Ns, result->latencyMaxNs);
+    }
+    fprintf(stderr, "\n");
+
+    ctx->count++;
+
+    return 0;
+}
+
+int writeBenchResults(const BenchContext_T *ctx, FILE *file) {
+
+    size_t i;
+    char hostName[64] = {0};
+    const BenchResult_T *result = NULL;
+
+    if((NULL == ctx) || (NULL == file)) {
+
+        return -1;
+    }
+
+    gethostname(hostName, sizeof(hostName) - 1);
+
+    fprintf(file, "{\n  \"version\": %u,\n  \"host\": \"%s\",\n  \"timestamp\": %lld,\n  \"repeats\": %u,\n  \"scale\": %g,\n  \"results\": [",
+        NUM_BENCH_FORMAT_VERSION, hostName, (long long)(time(NULL)), ctx->repeats, ctx->scale);
+
+    for(i = 0;i < ctx->count;++i) {
+
+        result = &ctx->results[i];
+        fprintf(file, "%s\n    {\"name\": \"%s\", \"iterations\": %" PRIu64 ", \"ns_per_op\": %.3f, \"ns_per_op_min\": %.3f, \"ops_per_sec\": %.1f",
+            (0 < i) ? "," : "", result->name, result->iterations, result->nsPerOp, result->nsPerOpMin, NUM_NSEC_PER_SEC / result->nsPerOp);
+        if(result->hasLatency) {
+
+            fprintf(file, ", \"p50_ns\": %.1f, \"p99_ns\": %.1f, \"max_ns\": %.1f", result->latencyP50Ns, result->latencyP99Ns, result->latencyMaxNs);
+        }
+        fprintf(file, "}");
+    }
+
+    fprintf(file, "\n  ]\n}\n");
+
+    return (0 == ferror(file)) ? 0 : -1;
+}
+
+static int compareU64(const void *first, const void *second) {
+
+    uint64_t a = *(const uint64_t*)first;
+    uint64_t b = *(const uint64_t*)second;
+
+    return (a > b) - (a < b);
+}
+
+static int compareU32(const void *first, const void *second) {
+
+    uint32_t a = *(const uint32_t*)first;
+    uint32_t b = *(const uint32_t*)second;
+
+    return (a > b) - (a < b);
+}
+
+static double getPercentile(const uint32_t samples[], const size_t count, const double percentile) {
+
+    size_t rank = (size_t)((percentile / 100.0) * (double)(count));
+
+    if(rank >= count) {
+
+        rank = count - 1;
+    }
+
+    return (double)(samples[rank]);
+}
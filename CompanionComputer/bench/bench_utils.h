@@ -0,0 +1,185 @@
+/**
+ * @file        bench_utils.h
+ * @author      Adam Csizy
+ * @date        2021-05-12
+ * @version     v1.1.0
+ *
+ * @brief       Microbenchmark utilities
+ */
+
+#pragma once
+
+
+#include <stdint.h>
+#include <stdio.h>
+
+
+/* Benchmark related public macro definitions */
+
+#define NUM_BENCH_NAME_SIZE         48U     /**< Size of a benchmark name including the terminator */
+#define NUM_BENCH_MAX_RESULTS       64U     /**< Maximum number of benchmark results */
+#define NUM_BENCH_DEFAULT_REPEATS   5U      /**< Default number of repetitions of each benchmark */
+#define NUM_BENCH_FORMAT_VERSION    1U      /**< Version of the JSON result format */
+#define NUM_NSEC_PER_SEC            1000000000ULL /**< Nanoseconds per second */
+
+
+/* Benchmark related public type definitions */
+
+/**
+ * @brief   Result of a single benchmark.
+ */
+typedef struct BenchResult {
+
+    char name[NUM_BENCH_NAME_SIZE];     /**< Benchmark name */
+    uint64_t iterations;                /**< Operations per repetition */
+    double nsPerOp;                     /**< Median cost of an operation over the repetitions */
+    double nsPerOpMin;                  /**< Minimum cost of an operation over the repetitions */
+    int hasLatency;                     /**< Flag whether the latency fields are valid */
+    double latencyP50Ns;                /**< Median latency */
+    double latencyP99Ns;                /**< 99th percentile latency */
+    double latencyMaxNs;                /**< Maximum latency */
+
+} BenchResult_T;
+
+/**
+ * @brief   Benchmark run context.
+ */
+typedef struct BenchContext {
+
+    unsigned int repeats;               /**< Repetitions of each benchmark (the median is reported) */
+    double scale;                       /**< Multiplier of the iteration counts */
+    const char *filter;                 /**< Only run benchmarks whose name contains this string (NULL: all) */
+    size_t count;                       /**< Number of results */
+    BenchResult_T results[NUM_BENCH_MAX_RESULTS];   /**< Results */
+
+} BenchContext_T;
+
+
+/* Benchmark related public function declarations */
+
+/**
+ * @brief       Get monotonic time in nanoseconds.
+ *
+ * @return      CLOCK_MONOTONIC time in nanoseconds.
+ */
+uint64_t getBenchTimeNs(void);
+
+/**
+ * @brief       Check whether a benchmark is selected by the filter.
+ *
+ * @param[in]   ctx Benchmark run context.
+ * @param[in]   name Benchmark name.
+ *
+ * @return      Non-zero if the benchmark should run.
+ */
+int isBenchSelected(const BenchContext_T *ctx, const char *name);
+
+/**
+ * @brief       Get scaled iteration count.
+ *
+ * @param[in]   ctx Benchmark run context.
+ * @param[in]   base Iteration count at scale 1.0.
+ *
+ * @return      Scaled iteration count (at least 1).
+ */
+uint64_t getBenchIterations(const BenchContext_T *ctx, const uint64_t base);
+
+/**
+ * @brief       Add benchmark result.
+ *
+ * @details     Stores the median and minimum cost per operation
+ *              of the repetitions and, if latency samples are
+ *              given, their percentiles. The latency array is
+ *              sorted in place.
+ *
+ * @param[in,out]   ctx Benchmark run context.
+ * @param[in]   name Benchmark name.
+ * @param[in]   iterations Operations per repetition.
+ * @param[in,out]   elapsedNs Elapsed time of each repetition (sorted in place).
+ * @param[in]   repeats Number of repetitions.
+ * @param[in,out]   latencyNs Latency samples or NULL.
+ * @param[in]   latencyCount Number of latency samples.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+int addBenchResult(BenchContext_T *ctx, const char *name, const uint64_t iterations,
+    uint64_t elapsedNs[], const size_t repeats, uint32_t latencyNs[], const size_t latencyCount);
+
+/**
+ * @brief       Write benchmark results as JSON.
+ *
+ * @param[in]   ctx Benchmark run context.
+ * @param[in]   file Output stream.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+int writeBenchResults(const BenchContext_T *ctx, FILE *file);
+
+/**
+ * @brief       Run module message queue benchmarks.
+ *
+ * @details     Throughput and latency of ModuleMessageQueue_T
+ *              with one and with several producers, blocking
+ *              and non-blocking.
+ *
+ * @param[in,out]   ctx Benchmark run context.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+int runMsgqBenchmarks(BenchContext_T *ctx);
+
+/**
+ * @brief       Run network protocol benchmarks.
+ *
+ * @details     Cost of encoding and decoding network messages.
+ *
+ * @param[in,out]   ctx Benchmark run context.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+int runProtocolBenchmarks(BenchContext_T *ctx);
+
+/**
+ * @brief       Run logging benchmarks.
+ *
+ * @details     Caller-side cost of createLogMessage() before and
+ *              after the asynchronous logger is started and the
+ *              cost of a log site disabled by its level. Starts
+ *              the asynchronous logger, so it has to run after
+ *              every other benchmark that logs synchronously.
+ *
+ * @param[in,out]   ctx Benchmark run context.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+int runLogBenchmarks(BenchContext_T *ctx);
+
+/**
+ * @brief       Run camera capabilities benchmarks.
+ *
+ * @details     Cost of parseCameraCapabilities() on synthetic
+ *              capabilities shaped like those of USB cameras.
+ *
+ * @param[in,out]   ctx Benchmark run context.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+int runCapsBenchmarks(BenchContext_T *ctx);
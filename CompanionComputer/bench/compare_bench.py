@@ -0,0 +1,90 @@
+#!/usr/bin/env python3
+"""
+@file        compare_bench.py
+@author      Adam Csizy
+@date        2021-05-12
+@version     v1.1.0
+
+@brief       Compares two streamerbench JSON result files
+
+Launch like this:
+
+./compare_bench.py <BASELINE_JSON> <CURRENT_JSON> [--threshold <PERCENT>] [--metric <NAME>]...
+
+Every metric is lower-is-better (ns_per_op, p50_ns, p99_ns, max_ns).
+Exits with 1 if any benchmark regressed by more than the threshold,
+with 2 if a file cannot be read.
+"""
+
+import argparse
+import json
+import sys
+
+
+DEFAULT_THRESHOLD_PERCENT = 10.0    # Regression threshold in percent
+DEFAULT_METRICS = ["ns_per_op"]     # Compared metrics
+
+
+def load_results(path):
+    """Load a result file and index its results by benchmark name."""
+
+    with open(path) as file:
+        document = json.load(file)
+
+    return {result["name"]: result for result in document.get("results", [])}
+
+
+def main():
+
+    parser = argparse.ArgumentParser(description="Compare two streamerbench result files.")
+    parser.add_argument("baseline", help="baseline result file")
+    parser.add_argument("current", help="current result file")
+    parser.add_argument("--threshold", type=float, default=DEFAULT_THRESHOLD_PERCENT,
+                        help="regression threshold in percent (default: %(default)s)")
+    parser.add_argument("--metric", action="append", dest="metrics",
+                        help="metric to compare, repeatable (default: ns_per_op)")
+    args = parser.parse_args()
+    metrics = args.metrics or DEFAULT_METRICS
+
+    try:
+        baseline = load_results(args.baseline)
+        current = load_results(args.current)
+    except (OSError, ValueError, KeyError) as error:
+        print("compare_bench: %s" % error, file=sys.stderr)
+        return 2
+
+    regressions = 0
+    print("%-32s %-10s %14s %14s %9s" % ("benchmark", "metric", "baseline", "current", "change"))
+
+    for name in sorted(set(baseline) | set(current)):
+
+        if name not in baseline or name not in current:
+            print("%-32s %s" % (name, "only in current" if name in current else "only in baseline"))
+            continue
+
+        for metric in metrics:
+
+            old = baseline[name].get(metric)
+            new = current[name].get(metric)
+            if old is None or new is None:
+                continue
+
+            change = ((new - old) / old * 100.0) if old > 0 else 0.0
+            flag = ""
+            if change > args.threshold:
+                flag = "  REGRESSION"
+                regressions += 1
+            elif change < -args.threshold:
+                flag = "  improved"
+
+            print("%-32s %-10s %14.1f %14.1f %+8.1f%%%s" % (name, metric, old, new, change, flag))
+
+    if regressions:
+        print("%d regression(s) above %.1f%%" % (regressions, args.threshold), file=sys.stderr)
+        return 1
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
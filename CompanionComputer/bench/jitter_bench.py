@@ -0,0 +1,256 @@
+#!/usr/bin/env python3
+"""
+@file        jitter_bench.py
+@author      Adam Csizy
+@date        2021-05-25
+@version     v1.1.0
+
+@brief       Frame jitter benchmark of the streamer's thread scheduling
+
+Runs the streamer (with a virtual camera, see getVideoSourceConfig())
+against a headless ground control dumping the received RTP packets
+(controlapp -d) over loopback, once with the default scheduling and once
+with a CC_SCHED specification (see sched_utils.h), optionally next to
+busy-looping load processes competing for the CPUs. Reports per format
+and variant, over the frames (the packets with the RTP marker bit) after
+the warmup:
+
+    interval_sd_ms      standard deviation of the frame arrival intervals
+    interval_p99_ms     99th percentile of the absolute deviation of an
+                        interval from the frame period (1 / fps)
+    interval_max_ms     largest frame arrival interval
+    rtp_jitter_ms       RFC 3550 interarrival jitter at the end of the run
+                        (90 kHz clock of the video payloaders)
+    sched_failures      scheduling failures the streamer logged (real-time
+                        policies need CAP_SYS_NICE, run as root otherwise)
+
+Launch like this (or "make jitter-run [LOAD=<N>] [SCHED=<SPEC>]"):
+
+./jitter_bench.py --streamerapp <PATH> --controlapp <PATH> [-o <JSON_FILE>] [--format <FMT>]...
+                  [--sched <SPEC>] [--load <N>]
+
+The result file has the layout of the streamerbench results, compare the
+two variants (or two runs) with compare_bench.py "--metric interval_p99_ms".
+"""
+
+import argparse
+import json
+import math
+import os
+import socket
+import struct
+import subprocess
+import sys
+import tempfile
+import time
+
+from loopback_bench import HeadlessReport, wait_for_listen, stop, SERVER_PORT, STREAM_PORT, DEFAULT_FORMATS, FIRST_FRAME_TIMEOUT_S
+
+
+DEFAULT_SIZE = "640x480"                    # Virtual camera resolution
+DEFAULT_FPS = 30                            # Virtual camera framerate
+DEFAULT_WARMUP_S = 3.0                      # Frames before this (after the first one) are not measured
+DEFAULT_DURATION_S = 20.0                   # Measurement window
+DEFAULT_LOAD = 0                            # Busy-looping load processes
+DEFAULT_SCHED = "capture=fifo:50 encode=fifo:50 send=fifo:50 control=rr:10 network=rr:10 log=idle"
+RTP_DUMP_MAGIC = b"GCRTPDMP"                # Ground control RTP dump (see GroundControl stream_utils.c)
+RTP_DUMP_VERSION = 1
+RTP_DUMP_HEADER = struct.Struct("=II")      # Version, reserved
+RTP_DUMP_RECORD = struct.Struct("=QI")      # Arrival time in ns, packet length
+RTP_HEADER = struct.Struct("!BBHII")        # V/P/X/CC, M/PT, sequence, timestamp, SSRC
+RTP_CLOCK_RATE = 90000.0
+SCHED_FAILURE_PATTERN = "applyThreadScheduling(): Failed"
+
+
+def read_frame_arrivals(path):
+    """Return the (arrival_ns, rtp_timestamp) of every marker packet of an RTP dump."""
+
+    frames = []
+    with open(path, "rb") as file:
+        if RTP_DUMP_MAGIC != file.read(len(RTP_DUMP_MAGIC)):
+            raise ValueError("not an RTP dump")
+        header = file.read(RTP_DUMP_HEADER.size)
+        if len(header) != RTP_DUMP_HEADER.size or RTP_DUMP_VERSION != RTP_DUMP_HEADER.unpack(header)[0]:
+            raise ValueError("unsupported RTP dump version")
+
+        while True:
+            record = file.read(RTP_DUMP_RECORD.size)
+            if len(record) != RTP_DUMP_RECORD.size:
+                break
+            arrival_ns, length = RTP_DUMP_RECORD.unpack(record)
+            packet = file.read(length)
+            if len(packet) != length:
+                break
+            if length >= RTP_HEADER.size:
+                _, marker_type, _, timestamp, _ = RTP_HEADER.unpack_from(packet)
+                if marker_type & 0x80:
+                    frames.append((arrival_ns, timestamp))
+    return frames
+
+
+def frame_statistics(frames, fps):
+    """Return the jitter metrics of the measured frames or None."""
+
+    if len(frames) < 3:
+        return None
+
+    period_ms = 1e3 / fps
+    intervals = [(b[0] - a[0]) / 1e6 for a, b in zip(frames, frames[1:])]
+    mean = sum(intervals) / len(intervals)
+    deviations = sorted(abs(interval - period_ms) for interval in intervals)
+
+    # RFC 3550 A.8 on the frame arrivals (one marker packet per frame)
+    jitter = 0.0
+    for a, b in zip(frames, frames[1:]):
+        transit = ((b[0] - a[0]) / 1e9 * RTP_CLOCK_RATE) - ((b[1] - a[1]) & 0xFFFFFFFF)
+        jitter += (abs(transit) - jitter) / 16.0
+
+    return {
+        "frames": len(frames),
+        "interval_sd_ms": math.sqrt(sum((interval - mean) ** 2 for interval in intervals) / len(intervals)),
+        "interval_p99_ms": deviations[min(len(deviations) - 1, int(0.99 * len(deviations)))],
+        "interval_max_ms": max(intervals),
+        "rtp_jitter_ms": jitter / RTP_CLOCK_RATE * 1e3,
+    }
+
+
+def count_sched_failures(path):
+    """Return the number of scheduling failures in the streamer's log file."""
+
+    try:
+        with open(path, errors="replace") as file:
+            return sum(1 for line in file if SCHED_FAILURE_PATTERN in line)
+    except OSError:
+        return 0
+
+
+def run_variant(args, source_format, variant, workdir):
+    """Run one streamer/ground control pair and return its result entry or None."""
+
+    name = "jitter_%s_%s" % (source_format, variant)
+    dump_path = os.path.join(workdir, "%s.rtpdump" % name)
+    log_path = os.path.join(workdir, "%s.log" % name)
+    controlapp = subprocess.Popen([args.controlapp, "-H", "-p", STREAM_PORT, "-d", dump_path],
+                                  stdout=subprocess.PIPE, stderr=subprocess.DEVNULL, universal_newlines=True, bufsize=1)
+    streamerapp = None
+
+    try:
+        report = HeadlessReport(controlapp.stdout)
+        if not wait_for_listen(SERVER_PORT, 5.0):
+            print("jitter_bench: %s: ground control did not start" % name, file=sys.stderr)
+            return None
+
+        environment = dict(os.environ,
+                           CC_FOREGROUND="1",
+                           CC_LOG_FILE=log_path,
+                           CC_VIDEO_SOURCE="test:%s:%s@%d" % (source_format, args.size, args.fps),
+                           CC_STREAM_DEST_ADDR="127.0.0.1",
+                           CC_RECORDER_FILE=os.path.join(workdir, "recorder_%s.bin" % name),
+                           CC_TRACE_FILE=os.path.join(workdir, "trace_%s.bin" % name))
+        environment.pop("CC_SCHED", None)
+        if "sched" == variant:
+            environment["CC_SCHED"] = args.sched
+        streamerapp = subprocess.Popen([args.streamerapp, "127.0.0.1", SERVER_PORT], env=environment,
+                                       stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+
+        deadline = time.monotonic() + FIRST_FRAME_TIMEOUT_S
+        while report.first_frame_ns is None and time.monotonic() < deadline and streamerapp.poll() is None:
+            time.sleep(0.05)
+        if report.first_frame_ns is None:
+            print("jitter_bench: %s: no frame received" % name, file=sys.stderr)
+            return None
+
+        time.sleep(args.warmup + args.duration)
+
+    except OSError as error:
+        print("jitter_bench: %s: %s" % (name, error), file=sys.stderr)
+        return None
+
+    finally:
+        if streamerapp is not None:
+            stop(streamerapp)
+        stop(controlapp)
+
+    # The dump is complete once the ground control exited
+    try:
+        frames = read_frame_arrivals(dump_path)
+    except (OSError, ValueError) as error:
+        print("jitter_bench: %s: %s" % (name, error), file=sys.stderr)
+        return None
+
+    if frames:
+        start_ns = frames[0][0] + int(args.warmup * 1e9)
+        end_ns = start_ns + int(args.duration * 1e9)
+        frames = [frame for frame in frames if start_ns <= frame[0] < end_ns]
+
+    statistics = frame_statistics(frames, args.fps)
+    if statistics is None:
+        print("jitter_bench: %s: too few frames" % name, file=sys.stderr)
+        return None
+
+    result = dict(name=name, **statistics)
+    result["sched_failures"] = count_sched_failures(log_path)
+
+    print("%-24s sd %6.2f ms  p99 %6.2f ms  max %7.2f ms  rtp jitter %6.2f ms%s" % (
+          result["name"], result["interval_sd_ms"], result["interval_p99_ms"], result["interval_max_ms"], result["rtp_jitter_ms"],
+          ("  (%d scheduling failures)" % result["sched_failures"]) if result["sched_failures"] else ""), file=sys.stderr)
+    return result
+
+
+def main():
+
+    parser = argparse.ArgumentParser(description="Benchmark the frame jitter with and without thread scheduling.")
+    parser.add_argument("--streamerapp", required=True, help="streamer binary (optimized build)")
+    parser.add_argument("--controlapp", required=True, help="ground control binary")
+    parser.add_argument("-o", "--output", help="JSON result file (default: stdout)")
+    parser.add_argument("--format", action="append", dest="formats", choices=DEFAULT_FORMATS,
+                        help="virtual camera format, repeatable (default: all)")
+    parser.add_argument("--size", default=DEFAULT_SIZE, help="virtual camera resolution (default: %(default)s)")
+    parser.add_argument("--fps", type=int, default=DEFAULT_FPS, help="virtual camera framerate (default: %(default)s)")
+    parser.add_argument("--warmup", type=float, default=DEFAULT_WARMUP_S, help="seconds after the first frame (default: %(default)s)")
+    parser.add_argument("--duration", type=float, default=DEFAULT_DURATION_S, help="measured seconds (default: %(default)s)")
+    parser.add_argument("--sched", default=DEFAULT_SCHED, help="CC_SCHED of the sched variant (default: \"%(default)s\")")
+    parser.add_argument("--load", type=int, default=DEFAULT_LOAD, help="busy-looping load processes (default: %(default)s)")
+    args = parser.parse_args()
+
+    load = [subprocess.Popen([sys.executable, "-c", "while True: pass"]) for _ in range(args.load)]
+
+    results = []
+    failures = 0
+    try:
+        with tempfile.TemporaryDirectory(prefix="jitter_bench_") as workdir:
+            for source_format in args.formats or DEFAULT_FORMATS:
+                for variant in ("default", "sched"):
+                    result = run_variant(args, source_format, variant, workdir)
+                    if result is None:
+                        failures += 1
+                    else:
+                        results.append(result)
+    finally:
+        for process in load:
+            stop(process)
+
+    document = {
+        "version": 1,
+        "host": socket.gethostname(),
+        "timestamp": int(time.time()),
+        "size": args.size,
+        "framerate": args.fps,
+        "sched": args.sched,
+        "load": args.load,
+        "results": results,
+    }
+
+    if args.output:
+        with open(args.output, "w") as file:
+            json.dump(document, file, indent=2)
+            file.write("\n")
+    else:
+        json.dump(document, sys.stdout, indent=2)
+        sys.stdout.write("\n")
+
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,255 @@
+#!/usr/bin/env python3
+"""
+@file        latency_bench.py
+@author      Adam Csizy
+@date        2021-05-16
+@version     v1.1.0
+
+@brief       Glass-to-glass latency benchmark
+
+Streams a test source with latency stamp (CC_LATENCY_STAMP, see
+createVideoSource()) to a ground control decoding the stamps ("-L"), for
+every combination of video source format, profile and impairment
+scenario, and reports the latency distribution of each combination:
+
+    p50_ms, p90_ms, p99_ms, max_ms, mean_ms
+                    latency of the stamped frames (capture before encoding
+                    to the decoded frame on the ground control)
+    frames          frames with a valid stamp in the measurement window
+    undecoded       frames without a valid stamp (corrupted by loss or coding)
+    lost            frame counter gaps (frames that never reached the decoder)
+
+A profile is a named source configuration "<NAME>=<W>x<H>@<FPS>". The
+scenario "none" runs without the impairment proxy, any other is a
+scenario file of tools/impairment_proxy.c. Both apps run on this host, so
+the capture and arrival times come from the same clock.
+
+Launch like this (or "make latency-run [IMPAIRMENT=<SCENARIO>]"):
+
+./latency_bench.py --streamerapp <PATH> --controlapp <PATH> [-o <JSON_FILE>] [--format <FMT>]...
+                   [--profile <NAME>=<W>x<H>@<FPS>]... [--proxy <PATH>] [--impairment none|<SCENARIO>]...
+
+The result file has the layout of the streamerbench results, compare two
+runs with compare_bench.py "--metric p50_ms --metric p99_ms".
+"""
+
+import argparse
+import json
+import math
+import os
+import socket
+import subprocess
+import sys
+import tempfile
+import time
+
+from loopback_bench import (HeadlessReport, wait_for_listen, stop, read_ground_truth, DEFAULT_FORMATS,
+                            FIRST_FRAME_TIMEOUT_S, SERVER_PORT, STREAM_PORT, PROXY_SERVER_PORT,
+                            PROXY_STREAM_PORT, PROXY_SEED)
+
+
+DEFAULT_PROFILES = ["vga30=640x480@30"]     # Source configurations (name=size@fps)
+DEFAULT_SCENARIOS = ["none"]                # Impairment scenarios ("none": no proxy)
+DEFAULT_WARMUP_S = 3.0                      # Settling time after the first frame
+DEFAULT_DURATION_S = 10.0                   # Measurement window
+FRAME_COUNTER_MODULO = 1 << 16              # The stamp's frame counter is 16 bits wide
+
+
+class LatencyReport(HeadlessReport):
+    """Collects the '[headless]' and '[latency]' lines of a ground control's standard output."""
+
+    def __init__(self, stream):
+        self.latencies = []                 # (frame, latency_us)
+        self.undecoded = 0
+        self.recording = False
+        super().__init__(stream)
+
+    def parse(self, tag, fields):
+        super().parse(tag, fields)
+        if "[latency]" != tag:
+            return
+        if "undecoded" in fields:
+            self.undecoded = int(fields["undecoded"])
+        if self.recording and "frame" in fields and "latency_us" in fields:
+            self.latencies.append((int(fields["frame"]), int(fields["latency_us"])))
+
+    def record(self, enabled):
+        """Start or stop collecting latency samples; return the undecoded count."""
+
+        with self.lock:
+            self.recording = enabled
+            return self.undecoded
+
+
+def percentile(values, fraction):
+    """Nearest-rank percentile of sorted values."""
+
+    return values[min(len(values) - 1, max(0, math.ceil(fraction * len(values)) - 1))]
+
+
+def count_lost(frames):
+    """Count the frame counter gaps of the received frames (in arrival order)."""
+
+    lost = 0
+    for previous, current in zip(frames, frames[1:]):
+        gap = (current - previous) % FRAME_COUNTER_MODULO
+        if 1 < gap < FRAME_COUNTER_MODULO // 2:
+            lost += gap - 1
+    return lost
+
+
+def run_combination(args, source_format, profile, scenario, workdir):
+    """Run one streamer/ground control pair and return its result entry or None."""
+
+    profile_name, source_size = profile.split("=", 1)
+    scenario_name = os.path.splitext(os.path.basename(scenario))[0]
+    name = "latency_%s_%s_%s" % (source_format, profile_name, scenario_name)
+    truth_path = os.path.join(workdir, "truth_%s.jsonl" % name)
+    impaired = "none" != scenario
+
+    controlapp = subprocess.Popen([args.controlapp, "-L", "-p", PROXY_STREAM_PORT if impaired else STREAM_PORT],
+                                  stdout=subprocess.PIPE, stderr=subprocess.DEVNULL, universal_newlines=True, bufsize=1)
+    streamerapp = None
+    proxy = None
+    server_port = SERVER_PORT
+
+    try:
+        report = LatencyReport(controlapp.stdout)
+        if not wait_for_listen(SERVER_PORT, 5.0):
+            print("latency_bench: %s: ground control did not start" % name, file=sys.stderr)
+            return None
+
+        if impaired:
+            proxy = subprocess.Popen([args.proxy, "-t", "%s:127.0.0.1:%s" % (PROXY_SERVER_PORT, SERVER_PORT),
+                                      "-u", "%s:127.0.0.1:%s" % (PROXY_STREAM_PORT, STREAM_PORT),
+                                      "-f", scenario, "-s", PROXY_SEED, "-l", truth_path],
+                                     stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+            server_port = PROXY_SERVER_PORT
+            if not wait_for_listen(PROXY_SERVER_PORT, 5.0):
+                print("latency_bench: %s: impairment proxy did not start" % name, file=sys.stderr)
+                return None
+
+        environment = dict(os.environ,
+                           CC_FOREGROUND="1",
+                           CC_LATENCY_STAMP="1",
+                           CC_VIDEO_SOURCE="test:%s:%s" % (source_format, source_size),
+                           CC_STREAM_DEST_ADDR="127.0.0.1",
+                           CC_RECORDER_FILE=os.path.join(workdir, "recorder_%s.bin" % name),
+                           CC_TRACE_FILE=os.path.join(workdir, "trace_%s.bin" % name))
+        streamerapp = subprocess.Popen([args.streamerapp, "127.0.0.1", server_port], env=environment,
+                                       stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+
+        deadline = time.monotonic() + FIRST_FRAME_TIMEOUT_S
+        while report.first_frame_ns is None and time.monotonic() < deadline and streamerapp.poll() is None:
+            time.sleep(0.05)
+        if report.first_frame_ns is None:
+            print("latency_bench: %s: no frame received" % name, file=sys.stderr)
+            return None
+
+        time.sleep(args.warmup)
+        start_undecoded = report.record(True)
+        time.sleep(args.duration)
+        # The undecoded count is reported every second: wait for the one closing the window
+        time.sleep(1.0)
+        end_undecoded = report.record(False)
+
+        if not report.latencies:
+            print("latency_bench: %s: no stamped frame decoded (is CC_LATENCY_STAMP supported by the source?)" % name,
+                  file=sys.stderr)
+            return None
+
+        latencies_ms = sorted(latency / 1000.0 for _, latency in report.latencies)
+        result = {
+            "name": name,
+            "format": source_format,
+            "profile": profile,
+            "scenario": scenario_name,
+            "p50_ms": percentile(latencies_ms, 0.50),
+            "p90_ms": percentile(latencies_ms, 0.90),
+            "p99_ms": percentile(latencies_ms, 0.99),
+            "max_ms": latencies_ms[-1],
+            "mean_ms": sum(latencies_ms) / len(latencies_ms),
+            "frames": len(latencies_ms),
+            "undecoded": end_undecoded - start_undecoded,
+            "lost": count_lost([frame for frame, _ in report.latencies]),
+        }
+
+        if proxy is not None:
+            stop(proxy)
+            truth = read_ground_truth(truth_path, "udp_up")
+            if truth is not None:
+                result["net_sent"] = truth["in"]
+                result["net_lost"] = truth["in"] - truth["out"] - truth["held"]
+                result["net_delay_ms"] = truth["delay_avg_ms"]
+
+        print("%-36s p50 %7.1f  p90 %7.1f  p99 %7.1f  max %7.1f ms  %5d frames  %4d undecoded  %4d lost" % (
+              name, result["p50_ms"], result["p90_ms"], result["p99_ms"], result["max_ms"], result["frames"],
+              result["undecoded"], result["lost"]), file=sys.stderr)
+        return result
+
+    except OSError as error:
+        print("latency_bench: %s: %s" % (name, error), file=sys.stderr)
+        return None
+
+    finally:
+        if streamerapp is not None:
+            stop(streamerapp)
+        if proxy is not None:
+            stop(proxy)
+        stop(controlapp)
+
+
+def main():
+
+    parser = argparse.ArgumentParser(description="Benchmark glass-to-glass latency over loopback.")
+    parser.add_argument("--streamerapp", required=True, help="streamer binary (optimized build)")
+    parser.add_argument("--controlapp", required=True, help="ground control binary")
+    parser.add_argument("-o", "--output", help="JSON result file (default: stdout)")
+    parser.add_argument("--format", action="append", dest="formats", choices=DEFAULT_FORMATS,
+                        help="test source format, repeatable (default: all)")
+    parser.add_argument("--profile", action="append", dest="profiles",
+                        help="source profile <NAME>=<W>x<H>@<FPS>, repeatable (default: %s)" % DEFAULT_PROFILES[0])
+    parser.add_argument("--proxy", default="build/impairment_proxy", help="impairment proxy binary (default: %(default)s)")
+    parser.add_argument("--impairment", action="append", dest="scenarios",
+                        help="'none' or impairment scenario file, repeatable (default: none)")
+    parser.add_argument("--warmup", type=float, default=DEFAULT_WARMUP_S, help="seconds after the first frame (default: %(default)s)")
+    parser.add_argument("--duration", type=float, default=DEFAULT_DURATION_S, help="measured seconds (default: %(default)s)")
+    args = parser.parse_args()
+
+    profiles = args.profiles or DEFAULT_PROFILES
+    for profile in profiles:
+        if "=" not in profile:
+            parser.error("invalid profile '%s' (expected <NAME>=<W>x<H>@<FPS>)" % profile)
+
+    results = []
+    failures = 0
+    with tempfile.TemporaryDirectory(prefix="latency_bench_") as workdir:
+        for scenario in args.scenarios or DEFAULT_SCENARIOS:
+            for profile in profiles:
+                for source_format in args.formats or DEFAULT_FORMATS:
+                    result = run_combination(args, source_format, profile, scenario, workdir)
+                    if result is None:
+                        failures += 1
+                    else:
+                        results.append(result)
+
+    document = {
+        "version": 1,
+        "host": socket.gethostname(),
+        "timestamp": int(time.time()),
+        "results": results,
+    }
+
+    if args.output:
+        with open(args.output, "w") as file:
+            json.dump(document, file, indent=2)
+            file.write("\n")
+    else:
+        json.dump(document, sys.stdout, indent=2)
+        sys.stdout.write("\n")
+
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,350 @@
+#!/usr/bin/env python3
+"""
+@file        loopback_bench.py
+@author      Adam Csizy
+@date        2021-05-14
+@version     v1.1.0
+
+@brief       End-to-end loopback streaming benchmark
+
+Runs the streamer (with a virtual camera, see getVideoSourceConfig())
+and a headless ground control over loopback for every video source
+format and reports per format:
+
+    ttff_ms         streamer launch to the first decoded frame on the ground control
+    fps             steady-state decoded frames per second
+    drone_cpu_pct   streamer CPU usage (100 = one core)
+    drone_rss_kb    streamer resident set size at the end of the run
+    gc_cpu_pct      ground control CPU usage
+    gc_rss_kb       ground control resident set size at the end of the run
+    arrival_latency_ms  capture on the drone to arrival on the ground control
+                    (steady-state mean, once the drone's clock is synchronized)
+    clock_uncertainty_ms  error bound of the arrival latency
+
+With --impairment the traffic goes through tools/impairment_proxy.c
+running the given scenario, and the ground truth of the video stream is
+added per format:
+
+    net_sent        RTP packets the streamer sent
+    net_lost        RTP packets the proxy dropped (loss, burst, queue and outage)
+    net_delay_ms    average forwarding delay of the proxy
+
+With --multipath the streamer sends over two loopback source addresses
+(127.0.0.2 and 127.0.0.3, see registerNetworkSink()) in the given mode
+and the ground control deduplicates (its -m option), reordering bonded
+paths as well (its -M option):
+
+    gc_duplicates   duplicate RTP packets the ground control dropped
+
+Combined with --impairment only the first path goes through the proxy,
+so the scenario's losses and outages hit one path of two (the control
+link stays on the proxy).
+
+Launch like this (or "make loopback-run [IMPAIRMENT=<SCENARIO>]"):
+
+./loopback_bench.py --streamerapp <PATH> --controlapp <PATH> [-o <JSON_FILE>] [--format <FMT>]...
+                    [--proxy <PATH> --impairment <SCENARIO>] [--multipath <redundant|bonding>]
+
+The result file has the layout of the streamerbench results, so two runs
+can be compared with compare_bench.py, e.g. "--metric ttff_ms --metric
+drone_cpu_pct" (fps is higher-is-better and is not meant for it).
+"""
+
+import argparse
+import json
+import os
+import signal
+import socket
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+
+
+DEFAULT_FORMATS = ["jpeg", "h264", "raw"]   # Virtual camera formats (CC_VIDEO_SOURCE=test:<FMT>:...)
+DEFAULT_SIZE = "640x480"                    # Virtual camera resolution
+DEFAULT_FPS = 30                            # Virtual camera framerate
+DEFAULT_WARMUP_S = 3.0                      # Settling time after the first frame
+DEFAULT_DURATION_S = 10.0                   # Steady-state measurement window
+FIRST_FRAME_TIMEOUT_S = 20.0                # Give up on a format without frames after this
+SERVER_PORT = "5010"                        # TCP port of the ground control server (NUM_SERVER_PORT)
+STREAM_PORT = "5000"                        # UDP port of the ground control network source (NUM_STREAM_SRC_PORT)
+PROXY_SERVER_PORT = "5011"                  # TCP port the impairment proxy relays to SERVER_PORT
+PROXY_STREAM_PORT = "5001"                  # UDP port the impairment proxy relays to STREAM_PORT
+PROXY_SEED = "1"                            # Impairment proxy PRNG seed (same losses in every run)
+MULTIPATH_SOURCES = ["127.0.0.2", "127.0.0.3"]  # Loopback source addresses of the multipath paths
+MULTIPATH_REORDER_MS = "50"                 # Ground control reorder window of the bonded paths
+CLOCK_TICKS = os.sysconf("SC_CLK_TCK")
+
+
+class HeadlessReport:
+    """Collects the '[headless]' lines of a ground control's standard output."""
+
+    def __init__(self, stream):
+        self.first_frame_ns = None
+        self.samples = []                   # (t_ns, frames)
+        self.duplicates = None
+        self.arrivals = []                  # (mean_us, uncertainty_us)
+        self.lock = threading.Lock()
+        self.thread = threading.Thread(target=self.read, args=(stream,), daemon=True)
+        self.thread.start()
+
+    def read(self, stream):
+        for line in stream:
+            fields = dict(item.split("=", 1) for item in line.split()[1:] if "=" in item)
+            with self.lock:
+                self.parse(line.split(" ", 1)[0], fields)
+
+    def parse(self, tag, fields):
+        """Handle one report line (called with the lock held)."""
+
+        if "[headless]" != tag:
+            return
+        if "first_frame_ns" in fields:
+            self.first_frame_ns = int(fields["first_frame_ns"])
+        if "frames" in fields and "t_ns" in fields:
+            self.samples.append((int(fields["t_ns"]), int(fields["frames"])))
+        if "duplicates" in fields:
+            self.duplicates = int(fields["duplicates"])
+        if "arrival_latency_us" in fields:
+            self.arrivals.append((int(fields["arrival_latency_us"]), int(fields["clock_uncertainty_us"])))
+
+    def last_sample(self):
+        with self.lock:
+            return self.samples[-1] if self.samples else None
+
+    def arrival_count(self):
+        with self.lock:
+            return len(self.arrivals)
+
+    def arrivals_since(self, count):
+        with self.lock:
+            return self.arrivals[count:]
+
+
+def read_cpu_ticks(pid):
+    """Return utime + stime of a process in clock ticks."""
+
+    with open("/proc/%d/stat" % pid) as file:
+        fields = file.read().rsplit(")", 1)[1].split()
+    return int(fields[11]) + int(fields[12])
+
+
+def read_rss_kb(pid):
+    """Return the resident set size of a process in kB."""
+
+    with open("/proc/%d/status" % pid) as file:
+        for line in file:
+            if line.startswith("VmRSS:"):
+                return int(line.split()[1])
+    return 0
+
+
+def wait_for_listen(port, timeout, interval=0.05):
+    """Wait until a TCP port is in LISTEN state (without connecting: the ground control would take it for a drone)."""
+
+    local_port = ":%04X" % int(port)
+    deadline = time.monotonic() + timeout
+    while time.monotonic() < deadline:
+        for table in ("/proc/net/tcp", "/proc/net/tcp6"):
+            try:
+                with open(table) as file:
+                    for line in file.readlines()[1:]:
+                        fields = line.split()
+                        if fields[1].endswith(local_port) and "0A" == fields[3]:
+                            return True
+            except OSError:
+                pass
+        time.sleep(interval)
+    return False
+
+
+def read_ground_truth(path, link):
+    """Return the last ground truth record of a proxy link or None."""
+
+    record = None
+    try:
+        with open(path) as file:
+            for line in file:
+                entry = json.loads(line)
+                if link == entry.get("link"):
+                    record = entry
+    except (OSError, ValueError):
+        pass
+    return record
+
+
+def stop(process):
+    """Terminate a process (SIGTERM, then SIGKILL)."""
+
+    if process.poll() is None:
+        process.send_signal(signal.SIGTERM)
+        try:
+            process.wait(timeout=3)
+        except subprocess.TimeoutExpired:
+            process.kill()
+            process.wait()
+
+
+def run_format(args, source_format, workdir):
+    """Run one streamer/ground control pair and return its result entry or None."""
+
+    truth_path = os.path.join(workdir, "truth_%s.jsonl" % source_format)
+    control_args = [args.controlapp, "-H", "-p", PROXY_STREAM_PORT if args.impairment else STREAM_PORT]
+    if args.multipath == "bonding":
+        control_args += ["-M", MULTIPATH_REORDER_MS]
+    elif args.multipath:
+        control_args += ["-m"]
+    controlapp = subprocess.Popen(control_args,
+                                  stdout=subprocess.PIPE, stderr=subprocess.DEVNULL, universal_newlines=True, bufsize=1)
+    streamerapp = None
+    proxy = None
+    server_port = SERVER_PORT
+
+    try:
+        report = HeadlessReport(controlapp.stdout)
+        if not wait_for_listen(SERVER_PORT, 5.0):
+            print("loopback_bench: %s: ground control did not start" % source_format, file=sys.stderr)
+            return None
+
+        if args.impairment:
+            proxy = subprocess.Popen([args.proxy, "-t", "%s:127.0.0.1:%s" % (PROXY_SERVER_PORT, SERVER_PORT),
+                                      "-u", "%s:127.0.0.1:%s" % (PROXY_STREAM_PORT, STREAM_PORT),
+                                      "-f", args.impairment, "-s", PROXY_SEED, "-l", truth_path],
+                                     stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+            server_port = PROXY_SERVER_PORT
+            if not wait_for_listen(PROXY_SERVER_PORT, 5.0):
+                print("loopback_bench: %s: impairment proxy did not start" % source_format, file=sys.stderr)
+                return None
+
+        environment = dict(os.environ,
+                           CC_FOREGROUND="1",
+                           CC_VIDEO_SOURCE="test:%s:%s@%d" % (source_format, args.size, args.fps),
+                           CC_STREAM_DEST_ADDR="127.0.0.1",
+                           CC_RECORDER_FILE=os.path.join(workdir, "recorder_%s.bin" % source_format),
+                           CC_TRACE_FILE=os.path.join(workdir, "trace_%s.bin" % source_format))
+        if args.multipath:
+            # The second path bypasses the proxy with a port of its own
+            paths = [MULTIPATH_SOURCES[0], "%s@127.0.0.1:%s" % (MULTIPATH_SOURCES[1], STREAM_PORT)] if args.impairment else MULTIPATH_SOURCES
+            environment.update(CC_MULTIPATH_PATHS=",".join(paths), CC_MULTIPATH_MODE=args.multipath)
+        launch_ns = time.time_ns()
+        streamerapp = subprocess.Popen([args.streamerapp, "127.0.0.1", server_port], env=environment,
+                                       stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+
+        deadline = time.monotonic() + FIRST_FRAME_TIMEOUT_S
+        while report.first_frame_ns is None and time.monotonic() < deadline and streamerapp.poll() is None:
+            time.sleep(0.05)
+        if report.first_frame_ns is None:
+            print("loopback_bench: %s: no frame received" % source_format, file=sys.stderr)
+            return None
+
+        time.sleep(args.warmup)
+
+        # Steady-state window: frame counts from the reports, CPU from /proc
+        start_sample = report.last_sample()
+        start_arrivals = report.arrival_count()
+        start_ticks = (read_cpu_ticks(streamerapp.pid), read_cpu_ticks(controlapp.pid))
+        start_wall = time.monotonic()
+        time.sleep(args.duration)
+        end_sample = report.last_sample()
+        end_ticks = (read_cpu_ticks(streamerapp.pid), read_cpu_ticks(controlapp.pid))
+        wall = time.monotonic() - start_wall
+        rss = (read_rss_kb(streamerapp.pid), read_rss_kb(controlapp.pid))
+
+        if start_sample is None or end_sample is None or end_sample[0] <= start_sample[0]:
+            print("loopback_bench: %s: no frame reports" % source_format, file=sys.stderr)
+            return None
+
+        result = {
+            "name": "loopback_%s" % source_format,
+            "ttff_ms": (report.first_frame_ns - launch_ns) / 1e6,
+            "fps": (end_sample[1] - start_sample[1]) * 1e9 / (end_sample[0] - start_sample[0]),
+            "drone_cpu_pct": (end_ticks[0] - start_ticks[0]) * 100.0 / CLOCK_TICKS / wall,
+            "drone_rss_kb": rss[0],
+            "gc_cpu_pct": (end_ticks[1] - start_ticks[1]) * 100.0 / CLOCK_TICKS / wall,
+            "gc_rss_kb": rss[1],
+        }
+        arrivals = report.arrivals_since(start_arrivals)
+        if arrivals:
+            result["arrival_latency_ms"] = sum(mean for mean, _ in arrivals) / len(arrivals) / 1e3
+            result["clock_uncertainty_ms"] = max(uncertainty for _, uncertainty in arrivals) / 1e3
+        if args.multipath and report.duplicates is not None:
+            result["gc_duplicates"] = report.duplicates
+
+        if proxy is not None:
+            stop(proxy)
+            truth = read_ground_truth(truth_path, "udp_up")
+            if truth is not None:
+                result["net_sent"] = truth["in"]
+                result["net_lost"] = truth["in"] - truth["out"] - truth["held"]
+                result["net_delay_ms"] = truth["delay_avg_ms"]
+
+        print("%-16s ttff %8.1f ms  %6.1f fps  drone %5.1f%% %7d kB  gc %5.1f%% %7d kB" % (
+              result["name"], result["ttff_ms"], result["fps"], result["drone_cpu_pct"],
+              result["drone_rss_kb"], result["gc_cpu_pct"], result["gc_rss_kb"]), file=sys.stderr)
+        return result
+
+    except OSError as error:
+        print("loopback_bench: %s: %s" % (source_format, error), file=sys.stderr)
+        return None
+
+    finally:
+        if streamerapp is not None:
+            stop(streamerapp)
+        if proxy is not None:
+            stop(proxy)
+        stop(controlapp)
+
+
+def main():
+
+    parser = argparse.ArgumentParser(description="Benchmark streaming end to end over loopback.")
+    parser.add_argument("--streamerapp", required=True, help="streamer binary (optimized build)")
+    parser.add_argument("--controlapp", required=True, help="ground control binary")
+    parser.add_argument("-o", "--output", help="JSON result file (default: stdout)")
+    parser.add_argument("--format", action="append", dest="formats", choices=DEFAULT_FORMATS,
+                        help="virtual camera format, repeatable (default: all)")
+    parser.add_argument("--size", default=DEFAULT_SIZE, help="virtual camera resolution (default: %(default)s)")
+    parser.add_argument("--fps", type=int, default=DEFAULT_FPS, help="virtual camera framerate (default: %(default)s)")
+    parser.add_argument("--warmup", type=float, default=DEFAULT_WARMUP_S, help="seconds after the first frame (default: %(default)s)")
+    parser.add_argument("--duration", type=float, default=DEFAULT_DURATION_S, help="measured seconds (default: %(default)s)")
+    parser.add_argument("--proxy", default="build/impairment_proxy", help="impairment proxy binary (default: %(default)s)")
+    parser.add_argument("--impairment", help="impairment scenario file (default: no proxy)")
+    parser.add_argument("--multipath", choices=["redundant", "bonding"], help="stream over two loopback paths (default: single path)")
+    args = parser.parse_args()
+
+    results = []
+    failures = 0
+    with tempfile.TemporaryDirectory(prefix="loopback_bench_") as workdir:
+        for source_format in args.formats or DEFAULT_FORMATS:
+            result = run_format(args, source_format, workdir)
+            if result is None:
+                failures += 1
+            else:
+                results.append(result)
+
+    document = {
+        "version": 1,
+        "host": socket.gethostname(),
+        "timestamp": int(time.time()),
+        "size": args.size,
+        "framerate": args.fps,
+        "impairment": os.path.basename(args.impairment) if args.impairment else None,
+        "multipath": args.multipath,
+        "results": results,
+    }
+
+    if args.output:
+        with open(args.output, "w") as file:
+            json.dump(document, file, indent=2)
+            file.write("\n")
+    else:
+        json.dump(document, sys.stdout, indent=2)
+        sys.stdout.write("\n")
+
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,786 @@
+/**
+ * @file        quality_bench.c
+ * @author      Adam Csizy
+ * @date        2021-05-17
+ * @version     v1.1.0
+ *
+ * @brief       Objective quality-per-bit benchmark of the video coding formats
+ */
+
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <gst/gst.h>
+
+#include "bench_utils.h"
+
+/*
+ * Build and run with the Makefile of the CompanionComputer directory:
+ *
+ * make quality-run                                 # writes build/quality.json
+ *
+ * Or launch like this:
+ *
+ * ./qualitybench [-o <JSON_FILE>] [-n <FRAMES>] [-s <W>x<H>@<FPS>] [-f <CODEC_FILTER>]
+ *                [-i <CLIP_FILE>]... [-e "<NAME>|<ENCODER>|<DECODER>"]...
+ *
+ * Every clip of the corpus (deterministic videotestsrc clips and the given
+ * recorded clips, decoded and scaled to the benchmark size) is encoded at
+ * every rate point of every codec configuration and decoded again with the
+ * decoder of the ground control. The decoded frames are compared with the
+ * source frames:
+ *
+ *   kbps           bitrate actually produced by the encoder
+ *   psnr_y_db      mean luma PSNR (100 dB for identical frames)
+ *   psnr_db        mean PSNR over all planes
+ *   ssim_y         mean luma SSIM (8x8 windows, 4 pixel step)
+ *   enc_ms         encoding wall time per frame
+ *   dec_ms         decoding wall time per frame (including the conversion to I420)
+ *
+ * The rate-distortion table goes to stderr, the JSON results (streamerbench
+ * layout) to the given file (default: stdout). Codec configurations are
+ * listed in VideoCodingFormat_T priority order; their encoder settings
+ * follow the drone (zero latency, a keyframe every second). -e adds a
+ * configuration: the encoder description gets the rate point (kbps) via
+ * "%d", e.g. -e "h264-fast|x264enc tune=zerolatency speed-preset=veryfast bitrate=%d ! h264parse|h264parse ! avdec_h264".
+ * Missing encoder or decoder plugins skip the configuration.
+ */
+
+
+/* Quality benchmark related macro definitions */
+
+#define NUM_QUALITY_MAX_CLIPS       8U          /**< Maximum number of clips */
+#define NUM_QUALITY_MAX_CODECS      16U         /**< Maximum number of codec configurations */
+#define NUM_QUALITY_MAX_RESULTS     256U        /**< Maximum number of results */
+#define NUM_QUALITY_NAME_SIZE       64U         /**< Size of clip, codec and result names */
+#define NUM_QUALITY_DESC_SIZE       1024U       /**< Size of a pipeline description */
+#define NUM_QUALITY_DEFAULT_FRAMES  90U         /**< Default clip length in frames */
+#define NUM_QUALITY_DEFAULT_WIDTH   640         /**< Default frame width */
+#define NUM_QUALITY_DEFAULT_HEIGHT  480         /**< Default frame height */
+#define NUM_QUALITY_DEFAULT_FPS     30          /**< Default framerate */
+#define NUM_QUALITY_PULL_TIMEOUT_NS 10000000000ULL  /**< Longest wait for a frame of a pipeline */
+#define NUM_QUALITY_PSNR_MAX_DB     100.0       /**< PSNR of identical frames */
+#define NUM_QUALITY_SSIM_WINDOW     8           /**< SSIM window size */
+#define NUM_QUALITY_SSIM_STEP       4           /**< SSIM window step */
+#define NUM_QUALITY_SSIM_C1         6.5025      /**< SSIM constant (0.01 * 255)^2 */
+#define NUM_QUALITY_SSIM_C2         58.5225     /**< SSIM constant (0.03 * 255)^2 */
+#define NUM_NSEC_PER_MSEC           1000000.0   /**< Nanoseconds per millisecond */
+
+
+/* Quality benchmark related type definitions */
+
+/**
+ * @brief   Codec configuration (encode and decode path).
+ */
+typedef struct CodecConfig {
+
+    const char *name;               /**< Name in the results */
+    const char *encoder;            /**< Encoder description ("%d": rate point) */
+    const char *decoder;            /**< Decoder description (ground control's decoder) */
+    const char *rateName;           /**< Unit of the rate points */
+    const int *ratePoints;          /**< Rate points */
+    size_t rateCount;               /**< Number of rate points */
+
+} CodecConfig_T;
+
+/**
+ * @brief   Clip of the corpus (raw I420 frames).
+ */
+typedef struct Clip {
+
+    char name[NUM_QUALITY_NAME_SIZE];   /**< Name in the results */
+    GstCaps *caps;                  /**< Raw frame capabilities */
+    GstBuffer **frames;             /**< Frames */
+    size_t count;                   /**< Number of frames */
+
+} Clip_T;
+
+/**
+ * @brief   Result of a clip encoded at a rate point.
+ */
+typedef struct QualityResult {
+
+    char name[NUM_QUALITY_NAME_SIZE];   /**< Result name */
+    const char *clip;               /**< Clip name */
+    const char *codec;              /**< Codec configuration name */
+    const char *rateName;           /**< Unit of the rate point */
+    int rate;                       /**< Rate point */
+    double kbps;                    /**< Produced bitrate */
+    double psnrY;                   /**< Mean luma PSNR */
+    double psnr;                    /**< Mean PSNR over all planes */
+    double ssimY;                   /**< Mean luma SSIM */
+    double encodeMs;                /**< Encoding time per frame */
+    double decodeMs;                /**< Decoding time per frame */
+    size_t frames;                  /**< Compared frames */
+    size_t lost;                    /**< Frames the encode/decode path did not return */
+
+} QualityResult_T;
+
+/**
+ * @brief   Quality benchmark run context.
+ */
+typedef struct QualityContext {
+
+    int width;                      /**< Frame width */
+    int height;                     /**< Frame height */
+    int framerate;                  /**< Framerate */
+    unsigned int frames;            /**< Clip length */
+    const char *filter;             /**< Only run codecs whose name contains this string (NULL: all) */
+    size_t clipCount;               /**< Number of clips */
+    Clip_T clips[NUM_QUALITY_MAX_CLIPS];    /**< Corpus */
+    size_t codecCount;              /**< Number of codec configurations */
+    CodecConfig_T codecs[NUM_QUALITY_MAX_CODECS];   /**< Codec configurations */
+    size_t count;                   /**< Number of results */
+    QualityResult_T results[NUM_QUALITY_MAX_RESULTS];   /**< Results */
+
+} QualityContext_T;
+
+
+/* Quality benchmark related static variable declarations */
+
+static const int bitratePoints[] = {500, 1000, 2000, 4000};     /**< Bitrate points in kbps */
+static const int qualityPoints[] = {40, 60, 80, 95};            /**< JPEG quality points */
+
+/**
+ * @brief   Built-in codec configurations (VideoCodingFormat_T priority order).
+ */
+static const CodecConfig_T defaultCodecs[] = {
+    {"h265", "x265enc tune=zerolatency speed-preset=ultrafast key-int-max=30 bitrate=%d ! h265parse", "h265parse ! avdec_h265",
+        "kbps", bitratePoints, sizeof(bitratePoints) / sizeof(bitratePoints[0])},
+    {"h264", "x264enc tune=zerolatency speed-preset=ultrafast key-int-max=30 bitrate=%d ! h264parse", "h264parse ! avdec_h264",
+        "kbps", bitratePoints, sizeof(bitratePoints) / sizeof(bitratePoints[0])},
+    {"h264-veryfast", "x264enc tune=zerolatency speed-preset=veryfast key-int-max=30 bitrate=%d ! h264parse", "h264parse ! avdec_h264",
+        "kbps", bitratePoints, sizeof(bitratePoints) / sizeof(bitratePoints[0])},
+    {"vp8", "vp8enc deadline=1 lag-in-frames=0 end-usage=cbr keyframe-max-dist=30 target-bitrate=%d000", "vp8dec",
+        "kbps", bitratePoints, sizeof(bitratePoints) / sizeof(bitratePoints[0])},
+    {"vp9", "vp9enc deadline=1 cpu-used=8 lag-in-frames=0 end-usage=cbr keyframe-max-dist=30 target-bitrate=%d000", "vp9dec",
+        "kbps", bitratePoints, sizeof(bitratePoints) / sizeof(bitratePoints[0])},
+    {"jpeg", "jpegenc quality=%d", "jpegdec",
+        "quality", qualityPoints, sizeof(qualityPoints) / sizeof(qualityPoints[0])},
+};
+
+/**
+ * @brief   Synthetic clips: name and videotestsrc settings.
+ */
+static const char *const syntheticClips[][2] = {
+    {"smpte", "pattern=smpte"},                                     /* Static, flat areas and sharp edges */
+    {"ball", "pattern=ball motion=wavy"},                           /* Moving object on a flat background */
+    {"zoneplate", "pattern=zone-plate kx2=20 ky2=20 kt=1"},         /* Moving high-frequency detail */
+};
+
+
+/* Quality benchmark related function definitions */
+
+/**
+ * @brief       Run a pipeline on buffers.
+ *
+ * @details     Builds the pipeline "appsrc name=src ! <DESC> !
+ *              appsink name=sink", pushes the input buffers,
+ *              ends the stream and collects the output buffers.
+ *              Without input the description must contain its
+ *              own source ("<DESC> ! appsink name=sink") and at
+ *              most outputLimit buffers are collected.
+ *
+ * @param[in]   description Pipeline description between the app elements.
+ * @param[in]   caps Capabilities of the input (NULL: no input).
+ * @param[in]   input Input buffers.
+ * @param[in]   inputCount Number of input buffers.
+ * @param[in]   outputLimit Maximum number of output buffers.
+ * @param[out]  output Output buffers (unref each and g_free() the array).
+ * @param[out]  outputCount Number of output buffers.
+ * @param[out]  outputCaps Capabilities of the output (unref) or NULL.
+ * @param[out]  elapsedNs Time from the start of the input until the end of the output.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+static int runPipeline(const char *description, GstCaps *caps, GstBuffer **input, const size_t inputCount, const size_t outputLimit,
+                       GstBuffer ***output, size_t *outputCount, GstCaps **outputCaps, uint64_t *elapsedNs) {
+
+    int retval = 0;
+    size_t i;
+    uint64_t startNs;
+    char launch[NUM_QUALITY_DESC_SIZE];
+    GError *error = NULL;
+    GstFlowReturn flow;
+    GstElement *pipeline = NULL;
+    GstElement *source = NULL;
+    GstElement *sink = NULL;
+    GstSample *sample = NULL;
+    GstMessage *message = NULL;
+    GstBus *bus = NULL;
+
+    *output = g_new0(GstBuffer*, outputLimit);
+    *outputCount = 0;
+    *outputCaps = NULL;
+
+    snprintf(launch, sizeof(launch), "%s%s ! appsink name=sink sync=false", (NULL != caps) ? "appsrc name=src format=time ! " : "", description);
+    pipeline = gst_parse_launch(launch, &error);
+    if((NULL == pipeline) || (NULL != error)) {
+
+        fprintf(stderr, "qualitybench: %s: %s\n", description, (NULL != error) ? error->message : "parse failed");
+        g_clear_error(&error);
+        g_clear_object(&pipeline);
+        retval = -1;
+        return retval;
+    }
+
+    sink = gst_bin_get_by_name(GST_BIN(pipeline), "sink");
+    if(NULL != caps) {
+
+        source = gst_bin_get_by_name(GST_BIN(pipeline), "src");
+        g_object_set(source, "caps", caps, NULL);
+    }
+
+    if(GST_STATE_CHANGE_FAILURE == gst_element_set_state(pipeline, GST_STATE_PLAYING)) {
+
+        fprintf(stderr, "qualitybench: %s: cannot start\n", description);
+        retval = -1;
+    }
+
+    startNs = getBenchTimeNs();
+    if((0 == retval) && (NULL != source)) {
+
+        /* The app source queues without limit and does not take over the buffers */
+        for(i = 0;i < inputCount;++i) {
+
+            g_signal_emit_by_name(source, "push-buffer", input[i], &flow);
+        }
+        g_signal_emit_by_name(source, "end-of-stream", &flow);
+    }
+
+    while((0 == retval) && (*outputCount < outputLimit)) {
+
+        sample = NULL;
+        g_signal_emit_by_name(sink, "try-pull-sample", (GstClockTime)(NUM_QUALITY_PULL_TIMEOUT_NS), &sample);
+        if(NULL == sample) {
+
+            /* End of stream, error or timeout */
+            break;
+        }
+
+        if(NULL == *outputCaps) {
+
+            *outputCaps = gst_caps_ref(gst_sample_get_caps(sample));
+        }
+        (*output)[(*outputCount)++] = gst_buffer_ref(gst_sample_get_buffer(sample));
+        gst_sample_unref(sample);
+    }
+    *elapsedNs = getBenchTimeNs() - startNs;
+
+    /* Report pipeline errors (missing plugins, negotiation) */
+    bus = gst_element_get_bus(pipeline);
+    message = gst_bus_pop_filtered(bus, GST_MESSAGE_ERROR);
+    if(NULL != message) {
+
+        gst_message_parse_error(message, &error, NULL);
+        fprintf(stderr, "qualitybench: %s: %s\n", description, error->message);
+        g_clear_error(&error);
+        gst_message_unref(message);
+        retval = -1;
+    }
+    gst_object_unref(bus);
+
+    gst_element_set_state(pipeline, GST_STATE_NULL);
+    g_clear_object(&source);
+    g_clear_object(&sink);
+    gst_object_unref(pipeline);
+
+    return retval;
+}
+
+/**
+ * @brief       Release buffers collected by runPipeline().
+ *
+ * @param[in,out]   buffers Buffers.
+ * @param[in]   count Number of buffers.
+ */
+static void releaseBuffers(GstBuffer **buffers, const size_t count) {
+
+    size_t i;
+
+    for(i = 0;i < count;++i) {
+
+        gst_buffer_unref(buffers[i]);
+    }
+    g_free(buffers);
+}
+
+/**
+ * @brief       Add a clip to the corpus.
+ *
+ * @param[in,out]   ctx Quality benchmark run context.
+ * @param[in]   name Clip name.
+ * @param[in]   source Source description producing raw frames.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+static int addClip(QualityContext_T *ctx, const char *name, const char *source) {
+
+    uint64_t elapsedNs;
+    char description[NUM_QUALITY_DESC_SIZE];
+    Clip_T *clip = NULL;
+
+    if(NUM_QUALITY_MAX_CLIPS <= ctx->clipCount) {
+
+        fprintf(stderr, "qualitybench: too many clips\n");
+        return -1;
+    }
+
+    clip = &ctx->clips[ctx->clipCount];
+    snprintf(clip->name, sizeof(clip->name), "%s", name);
+    snprintf(description, sizeof(description), "%s ! videoconvert ! videoscale ! videorate ! video/x-raw,format=I420,width=%d,height=%d,framerate=%d/1",
+        source, ctx->width, ctx->height, ctx->framerate);
+
+    if(runPipeline(description, NULL, NULL, 0, ctx->frames, &clip->frames, &clip->count, &clip->caps, &elapsedNs) || (0 == clip->count)) {
+
+        fprintf(stderr, "qualitybench: clip %s has no frames\n", name);
+        releaseBuffers(clip->frames, clip->count);
+        if(NULL != clip->caps) {
+
+            gst_caps_unref(clip->caps);
+        }
+        memset(clip, 0, sizeof(Clip_T));
+        return -1;
+    }
+
+    ++ctx->clipCount;
+
+    return 0;
+}
+
+/**
+ * @brief       Compare a decoded frame with its source frame.
+ *
+ * @param[in]   reference Source frame (I420).
+ * @param[in]   decoded Decoded frame (I420).
+ * @param[in]   width Frame width.
+ * @param[in]   height Frame height.
+ * @param[out]  mseY Luma mean squared error.
+ * @param[out]  mse Mean squared error over all planes.
+ * @param[out]  ssimY Mean luma SSIM.
+ */
+static void compareFrames(const guint8 *reference, const guint8 *decoded, const int width, const int height,
+                          double *mseY, double *mse, double *ssimY) {
+
+    int x, y, i, j, plane, planeWidth, planeHeight, windows = 0;
+    gsize stride, offset = 0;
+    double difference, squaredSum[3] = {0.0}, ssimSum = 0.0;
+    double pixelA, pixelB, sumA, sumB, sumAA, sumBB, sumAB, meanA, meanB, varA, varB, cov;
+    const double samples = NUM_QUALITY_SSIM_WINDOW * NUM_QUALITY_SSIM_WINDOW;
+
+    /* Squared errors of the visible pixels of every plane (default I420 layout) */
+    for(plane = 0;plane < 3;++plane) {
+
+        planeWidth = (0 == plane) ? width : (width + 1) / 2;
+        planeHeight = (0 == plane) ? height : (height + 1) / 2;
+        stride = (0 == plane) ? GST_ROUND_UP_4(width) : GST_ROUND_UP_4(GST_ROUND_UP_2(width) / 2);
+
+        for(y = 0;y < planeHeight;++y) {
+
+            for(x = 0;x < planeWidth;++x) {
+
+                difference = (double)(reference[offset + y * stride + x]) - (double)(decoded[offset + y * stride + x]);
+                squaredSum[plane] += difference * difference;
+            }
+        }
+
+        offset += stride * ((0 == plane) ? GST_ROUND_UP_2(height) : GST_ROUND_UP_2(height) / 2);
+    }
+
+    *mseY = squaredSum[0] / ((double)(width) * (double)(height));
+    *mse = (squaredSum[0] + squaredSum[1] + squaredSum[2]) /
+        ((double)(width) * (double)(height) + 2.0 * (double)((width + 1) / 2) * (double)((height + 1) / 2));
+
+    /* Luma SSIM over overlapping windows */
+    stride = GST_ROUND_UP_4(width);
+    for(y = 0;y + NUM_QUALITY_SSIM_WINDOW <= height;y += NUM_QUALITY_SSIM_STEP) {
+
+        for(x = 0;x + NUM_QUALITY_SSIM_WINDOW <= width;x += NUM_QUALITY_SSIM_STEP) {
+
+            sumA = sumB = sumAA = sumBB = sumAB = 0.0;
+            for(j = 0;j < NUM_QUALITY_SSIM_WINDOW;++j) {
+
+                for(i = 0;i < NUM_QUALITY_SSIM_WINDOW;++i) {
+
+                    pixelA = reference[(y + j) * stride + x + i];
+                    pixelB = decoded[(y + j) * stride + x + i];
+                    sumA += pixelA;
+                    sumB += pixelB;
+                    sumAA += pixelA * pixelA;
+                    sumBB += pixelB * pixelB;
+                    sumAB += pixelA * pixelB;
+                }
+            }
+
+            meanA = sumA / samples;
+            meanB = sumB / samples;
+            varA = sumAA / samples - meanA * meanA;
+            varB = sumBB / samples - meanB * meanB;
+            cov = sumAB / samples - meanA * meanB;
+            ssimSum += ((2.0 * meanA * meanB + NUM_QUALITY_SSIM_C1) * (2.0 * cov + NUM_QUALITY_SSIM_C2)) /
+                ((meanA * meanA + meanB * meanB + NUM_QUALITY_SSIM_C1) * (varA + varB + NUM_QUALITY_SSIM_C2));
+            ++windows;
+        }
+    }
+
+    *ssimY = (0 < windows) ? ssimSum / windows : 1.0;
+}
+
+/**
+ * @brief       Convert mean squared error to PSNR.
+ *
+ * @param[in]   mse Mean squared error.
+ *
+ * @return      PSNR in dB (NUM_QUALITY_PSNR_MAX_DB at most).
+ */
+static double getPsnr(const double mse) {
+
+    double psnr = NUM_QUALITY_PSNR_MAX_DB;
+
+    if(0.0 < mse) {
+
+        psnr = 10.0 * log10(255.0 * 255.0 / mse);
+    }
+
+    return (psnr < NUM_QUALITY_PSNR_MAX_DB) ? psnr : NUM_QUALITY_PSNR_MAX_DB;
+}
+
+/**
+ * @brief       Encode, decode and compare a clip at a rate point.
+ *
+ * @param[in,out]   ctx Quality benchmark run context.
+ * @param[in]   clip Clip.
+ * @param[in]   codec Codec configuration.
+ * @param[in]   rate Rate point.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+static int runQualityBenchmark(QualityContext_T *ctx, const Clip_T *clip, const CodecConfig_T *codec, const int rate) {
+
+    int retval = 0;
+    size_t i, encodedCount = 0, decodedCount = 0;
+    gsize encodedBytes = 0;
+    uint64_t encodeNs = 0, decodeNs = 0;
+    double mseY, mse, ssimY;
+    char encoder[NUM_QUALITY_DESC_SIZE];
+    char decoder[NUM_QUALITY_DESC_SIZE];
+    GstCaps *encodedCaps = NULL;
+    GstCaps *decodedCaps = NULL;
+    GstBuffer **encoded = NULL;
+    GstBuffer **decoded = NULL;
+    GstMapInfo referenceMap, decodedMap;
+    QualityResult_T *result = NULL;
+
+    if(NUM_QUALITY_MAX_RESULTS <= ctx->count) {
+
+        fprintf(stderr, "qualitybench: too many results\n");
+        return -1;
+    }
+
+    result = &ctx->results[ctx->count];
+    memset(result, 0, sizeof(QualityResult_T));
+    snprintf(result->name, sizeof(result->name), "quality_%s_%s_%d", clip->name, codec->name, rate);
+    result->clip = clip->name;
+    result->codec = codec->name;
+    result->rateName = codec->rateName;
+    result->rate = rate;
+
+    /* Encode (encoders may hold frames back, so every frame may yield zero or more buffers) */
+    snprintf(encoder, sizeof(encoder), codec->encoder, rate);
+    retval = runPipeline(encoder, clip->caps, clip->frames, clip->count, 4 * clip->count, &encoded, &encodedCount, &encodedCaps, &encodeNs);
+
+    /* Decode with the ground control's decoder into the source layout */
+    if((0 == retval) && (0 < encodedCount)) {
+
+        snprintf(decoder, sizeof(decoder), "%s ! videoconvert ! video/x-raw,format=I420,width=%d,height=%d", codec->decoder, ctx->width, ctx->height);
+        retval = runPipeline(decoder, encodedCaps, encoded, encodedCount, clip->count, &decoded, &decodedCount, &decodedCaps, &decodeNs);
+    }
+
+    if((0 != retval) || (0 == decodedCount)) {
+
+        fprintf(stderr, "qualitybench: %s skipped\n", result->name);
+        releaseBuffers(encoded, encodedCount);
+        releaseBuffers(decoded, decodedCount);
+        g_clear_pointer(&encodedCaps, gst_caps_unref);
+        g_clear_pointer(&decodedCaps, gst_caps_unref);
+        retval = -1;
+        return retval;
+    }
+
+    for(i = 0;i < encodedCount;++i) {
+
+        encodedBytes += gst_buffer_get_size(encoded[i]);
+    }
+
+    /* Decoded frames come out in source order: compare pairwise */
+    for(i = 0;i < decodedCount;++i) {
+
+        if(TRUE != gst_buffer_map(clip->frames[i], &referenceMap, GST_MAP_READ)) {
+
+            continue;
+        }
+        if(TRUE != gst_buffer_map(decoded[i], &decodedMap, GST_MAP_READ)) {
+
+            gst_buffer_unmap(clip->frames[i], &referenceMap);
+            continue;
+        }
+
+        if(decodedMap.size == referenceMap.size) {
+
+            compareFrames(referenceMap.data, decodedMap.data, ctx->width, ctx->height, &mseY, &mse, &ssimY);
+            result->psnrY += getPsnr(mseY);
+            result->psnr += getPsnr(mse);
+            result->ssimY += ssimY;
+            ++result->frames;
+        }
+
+        gst_buffer_unmap(decoded[i], &decodedMap);
+        gst_buffer_unmap(clip->frames[i], &referenceMap);
+    }
+
+    if(0 < result->frames) {
+
+        result->psnrY /= result->frames;
+        result->psnr /= result->frames;
+        result->ssimY /= result->frames;
+        result->kbps = (double)(encodedBytes) * 8.0 * ctx->framerate / (double)(clip->count) / 1000.0;
+        result->encodeMs = (double)(encodeNs) / NUM_NSEC_PER_MSEC / (double)(clip->count);
+        result->decodeMs = (double)(decodeNs) / NUM_NSEC_PER_MSEC / (double)(decodedCount);
+        result->lost = clip->count - result->frames;
+        ++ctx->count;
+
+        fprintf(stderr, "%-10s %-14s %4d %-7s %9.1f %8.2f %8.2f %7.4f %8.3f %8.3f %5zu\n",
+            clip->name, codec->name, rate, codec->rateName, result->kbps, result->psnrY, result->psnr, result->ssimY,
+            result->encodeMs, result->decodeMs, result->lost);
+    }
+    else {
+
+        fprintf(stderr, "qualitybench: %s: decoded frames do not match the source layout\n", result->name);
+        retval = -1;
+    }
+
+    releaseBuffers(encoded, encodedCount);
+    releaseBuffers(decoded, decodedCount);
+    gst_caps_unref(encodedCaps);
+    gst_caps_unref(decodedCaps);
+
+    return retval;
+}
+
+/**
+ * @brief       Write the results in JSON format.
+ *
+ * @param[in]   ctx Quality benchmark run context.
+ * @param[out]  file Output stream.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+static int writeQualityResults(const QualityContext_T *ctx, FILE *file) {
+
+    size_t i;
+    char hostName[64] = {0};
+    const QualityResult_T *result = NULL;
+
+    gethostname(hostName, sizeof(hostName) - 1);
+
+    fprintf(file, "{\n  \"version\": %u,\n  \"host\": \"%s\",\n  \"timestamp\": %lld,\n  \"size\": \"%dx%d\",\n  \"framerate\": %d,\n  \"frames\": %u,\n  \"results\": [",
+        NUM_BENCH_FORMAT_VERSION, hostName, (long long)(time(NULL)), ctx->width, ctx->height, ctx->framerate, ctx->frames);
+
+    for(i = 0;i < ctx->count;++i) {
+
+        result = &ctx->results[i];
+        fprintf(file, "%s\n    {\"name\": \"%s\", \"clip\": \"%s\", \"codec\": \"%s\", \"%s\": %d, \"kbps\": %.1f, \"psnr_y_db\": %.3f, \"psnr_db\": %.3f, "
+            "\"ssim_y\": %.5f, \"enc_ms\": %.3f, \"dec_ms\": %.3f, \"frames\": %zu, \"lost\": %zu}",
+            (0 < i) ? "," : "", result->name, result->clip, result->codec, result->rateName, result->rate, result->kbps,
+            result->psnrY, result->psnr, result->ssimY, result->encodeMs, result->decodeMs, result->frames, result->lost);
+    }
+
+    fprintf(file, "\n  ]\n}\n");
+
+    return (0 == ferror(file)) ? 0 : -1;
+}
+
+/**
+ * @brief       Print usage.
+ *
+ * @param[in]   program Program name.
+ */
+static void printUsage(const char *program) {
+
+    fprintf(stderr, "Usage: %s [-o <JSON_FILE>] [-n <FRAMES>] [-s <W>x<H>@<FPS>] [-f <CODEC_FILTER>] [-i <CLIP_FILE>]... [-e \"<NAME>|<ENCODER>|<DECODER>\"]...\n", program);
+}
+
+/**
+ * @brief       The quality benchmark program's main function.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      1 Failure
+ */
+int main(int argc, char *argv[]) {
+
+    int option, retval = 0;
+    size_t i, codec, clip, rate, fileCount = 0;
+    char name[NUM_QUALITY_NAME_SIZE];
+    char source[NUM_QUALITY_DESC_SIZE];
+    char *separator = NULL;
+    const char *outputPath = NULL;
+    const char *files[NUM_QUALITY_MAX_CLIPS];
+    FILE *output = stdout;
+    static QualityContext_T ctx;
+
+    ctx.width = NUM_QUALITY_DEFAULT_WIDTH;
+    ctx.height = NUM_QUALITY_DEFAULT_HEIGHT;
+    ctx.framerate = NUM_QUALITY_DEFAULT_FPS;
+    ctx.frames = NUM_QUALITY_DEFAULT_FRAMES;
+    for(i = 0;i < sizeof(defaultCodecs) / sizeof(defaultCodecs[0]);++i) {
+
+        ctx.codecs[ctx.codecCount++] = defaultCodecs[i];
+    }
+
+    gst_init(&argc, &argv);
+
+    while(-1 != (option = getopt(argc, argv, "o:n:s:f:i:e:h"))) {
+
+        switch(option) {
+
+            case 'o':
+                outputPath = optarg;
+                break;
+
+            case 'n':
+                ctx.frames = (unsigned int)strtoul(optarg, NULL, 10);
+                break;
+
+            case 's':
+                if(3 != sscanf(optarg, "%dx%d@%d", &ctx.width, &ctx.height, &ctx.framerate)) {
+
+                    printUsage(argv[0]);
+                    return 1;
+                }
+                break;
+
+            case 'f':
+                ctx.filter = optarg;
+                break;
+
+            case 'i':
+                if(NUM_QUALITY_MAX_CLIPS <= fileCount) {
+
+                    printUsage(argv[0]);
+                    return 1;
+                }
+                files[fileCount++] = optarg;
+                break;
+
+            case 'e':
+                /* "<NAME>|<ENCODER>|<DECODER>" (kept in argv) */
+                if((NUM_QUALITY_MAX_CODECS <= ctx.codecCount) || (NULL == (separator = strchr(optarg, '|'))) || (NULL == strchr(separator + 1, '|'))) {
+
+                    printUsage(argv[0]);
+                    return 1;
+                }
+                ctx.codecs[ctx.codecCount].name = optarg;
+                *separator = '\0';
+                ctx.codecs[ctx.codecCount].encoder = separator + 1;
+                separator = strchr(separator + 1, '|');
+                *separator = '\0';
+                ctx.codecs[ctx.codecCount].decoder = separator + 1;
+                ctx.codecs[ctx.codecCount].rateName = "kbps";
+                ctx.codecs[ctx.codecCount].ratePoints = bitratePoints;
+                ctx.codecs[ctx.codecCount].rateCount = sizeof(bitratePoints) / sizeof(bitratePoints[0]);
+                ++ctx.codecCount;
+                break;
+
+            default:
+                printUsage(argv[0]);
+                return 1;
+        }
+    }
+
+    if((0 == ctx.frames) || (0 >= ctx.width) || (0 >= ctx.height) || (0 >= ctx.framerate)) {
+
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    /* Corpus: deterministic synthetic clips, then the recorded ones */
+    for(i = 0;i < sizeof(syntheticClips) / sizeof(syntheticClips[0]);++i) {
+
+        snprintf(source, sizeof(source), "videotestsrc %s num-buffers=%u", syntheticClips[i][1], ctx.frames);
+        retval |= addClip(&ctx, syntheticClips[i][0], source);
+    }
+
+    for(i = 0;i < fileCount;++i) {
+
+        snprintf(name, sizeof(name), "file%zu", i);
+        snprintf(source, sizeof(source), "filesrc location=\"%s\" ! decodebin", files[i]);
+        retval |= addClip(&ctx, name, source);
+    }
+
+    fprintf(stderr, "%-10s %-14s %4s %-7s %9s %8s %8s %7s %8s %8s %5s\n",
+        "clip", "codec", "rate", "unit", "kbps", "psnr_y", "psnr", "ssim_y", "enc_ms", "dec_ms", "lost");
+
+    for(codec = 0;codec < ctx.codecCount;++codec) {
+
+        if((NULL != ctx.filter) && (NULL == strstr(ctx.codecs[codec].name, ctx.filter))) {
+
+            continue;
+        }
+
+        for(clip = 0;clip < ctx.clipCount;++clip) {
+
+            for(rate = 0;rate < ctx.codecs[codec].rateCount;++rate) {
+
+                /* A missing plugin skips the codec on the clip, not the run */
+                if(runQualityBenchmark(&ctx, &ctx.clips[clip], &ctx.codecs[codec], ctx.codecs[codec].ratePoints[rate])) {
+
+                    break;
+                }
+            }
+        }
+    }
+
+    if(NULL != outputPath) {
+
+        output = fopen(outputPath, "w");
+        if(NULL == output) {
+
+            perror(outputPath);
+            return 1;
+        }
+    }
+
+    retval |= writeQualityResults(&ctx, output);
+
+    if(stdout != output) {
+
+        fclose(output);
+    }
+
+    for(clip = 0;clip < ctx.clipCount;++clip) {
+
+        releaseBuffers(ctx.clips[clip].frames, ctx.clips[clip].count);
+        gst_caps_unref(ctx.clips[clip].caps);
+    }
+
+    return ((0 == retval) && (0 < ctx.count)) ? 0 : 1;
+}
@@ -0,0 +1,491 @@
+#!/usr/bin/env python3
+"""
+@file        soak_bench.py
+@author      Adam Csizy
+@date        2021-05-16
+@version     v1.1.0
+
+@brief       Long-running soak test of the streamer against a scripted ground control
+
+Plays the ground control for the streamer (with a virtual camera, see
+getVideoSourceConfig()) and drives it through login/request/start/stop
+sessions with injected errors and disconnects for hours:
+
+    stream          request, start, stream for a while, stop
+    pipeline_error  request, start and stream until the test source ends
+                    (frame limit), which the streamer reports as a stream error,
+                    then wait for the streamer to recover and resume the stream
+    invalid_module  message to an unknown module
+    invalid_code    stream message with an unknown code
+    truncated       half of a message header (the streamer times out on it)
+
+Each session ends with a disconnect: an orderly close, a reset (RST), a
+refused reconnect (the listening socket is closed for a while) or a
+rejected login (LOGIN_NACK). Refused and rejected logins cost the
+streamer's reconnect cooldown, so they are rare.
+
+The streamer's resident set size, open descriptors and threads are
+sampled over time, and so are the command latencies:
+
+    request_ms      stream request to the stream type reply
+    first_packet_ms stream start to the first RTP packet
+    reconnect_ms    disconnect to the next login
+    recovery_ms     stream error to the stream recovered message (pipeline
+                    rebuilt and playing again, see streamErrorHandler())
+
+After the warmup the samples are split into thirds. A metric fails when
+the medians of the thirds grow monotonically by more than its tolerance
+(leaks grow with the cycles, warm caches do not). The run also fails when
+the streamer exits or stops answering.
+
+Launch like this (or "make soak-run [SOAK_DURATION=<SECONDS>]"):
+
+./soak_bench.py --streamerapp <PATH> [-o <JSON_FILE>] [--duration <SECONDS>] [--cycles <SESSIONS>]
+                [--format <FMT>] [--seed <SEED>]
+"""
+
+import argparse
+import json
+import os
+import random
+import socket
+import statistics
+import struct
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+
+from loopback_bench import read_rss_kb, stop
+
+
+DEFAULT_FORMAT = "jpeg"             # Virtual camera format (CC_VIDEO_SOURCE=test:<FMT>:...)
+DEFAULT_SIZE = "320x240"            # Virtual camera resolution
+DEFAULT_FPS = 30                    # Virtual camera framerate
+DEFAULT_FRAME_LIMIT = 150           # Test source frames until it ends the stream (pipeline error)
+DEFAULT_DURATION_S = 3600.0         # Soak duration
+DEFAULT_WARMUP_S = 60.0             # Samples before this are not checked for growth
+DEFAULT_SAMPLE_S = 5.0              # Resource sampling period
+DEFAULT_SEED = 1                    # Session script PRNG seed (same script in every run)
+DEFAULT_RSS_TOLERANCE_KB = 1024     # Allowed monotonic growth of the resident set size
+DEFAULT_LATENCY_TOLERANCE_MS = 50.0 # Allowed monotonic growth of the command latencies
+REPLY_TIMEOUT_S = 5.0               # Give up on an expected message after this
+CONNECT_TIMEOUT_S = 30.0            # Give up on a (re)connecting streamer after this (reconnect cooldown included)
+REFUSE_S = 1.0                      # Listening socket closed for this long on a refused reconnect
+TRUNCATED_WAIT_S = 2.5              # Streamer's header receive timeout (2 s) and some slack
+
+DRONE_ID = 12                       # DRONE_ID of com_utils.h
+MOD_NAME_NETWORK = 1                # ModuleName_T of com_utils.h
+MOD_NAME_STREAM = 2
+MOD_NAME_GCCOMMON = 3
+MOD_NAME_INVALID = 9
+MOD_MSG_CODE_LOGIN = 1              # ModuleMessageCode_T of com_utils.h
+MOD_MSG_CODE_LOGIN_ACK = 2
+MOD_MSG_CODE_STREAM_REQ = 3
+MOD_MSG_CODE_STREAM_ERROR = 4
+MOD_MSG_CODE_STREAM_START = 5
+MOD_MSG_CODE_STREAM_STOP = 6
+MOD_MSG_CODE_STREAM_TYPE = 7
+MOD_MSG_CODE_LOGIN_NACK = 8
+MOD_MSG_CODE_STREAM_RECOVERED = 11
+MOD_MSG_CODE_INVALID = 42
+FIELD = struct.Struct("=I")         # Message fields are host order uint32 (see encodeNetworkMessageHeader())
+HEADER = struct.Struct("=II")
+DATA_CODES = (MOD_MSG_CODE_STREAM_TYPE, MOD_MSG_CODE_STREAM_RECOVERED)  # Messages to the ground control with a data field
+
+ACTIONS = [("stream", 60), ("pipeline_error", 10), ("invalid_module", 10), ("invalid_code", 10), ("truncated", 5)]
+DISCONNECTS = [("close", 70), ("reset", 26), ("refuse", 2), ("login_nack", 2)]
+METRICS = ["rss_kb", "fds", "threads", "request_ms", "first_packet_ms", "reconnect_ms", "recovery_ms"]
+
+
+class SoakError(Exception):
+    """The streamer misbehaved (no reply, unexpected message, exited)."""
+
+
+class PacketCounter:
+    """Counts the RTP packets arriving on a UDP socket."""
+
+    def __init__(self):
+        self.socket = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        self.socket.bind(("127.0.0.1", 0))
+        self.port = self.socket.getsockname()[1]
+        self.packets = 0
+        self.condition = threading.Condition()
+        self.thread = threading.Thread(target=self.read, daemon=True)
+        self.thread.start()
+
+    def read(self):
+        while True:
+            self.socket.recv(65536)
+            with self.condition:
+                self.packets += 1
+                self.condition.notify_all()
+
+    def wait_packet(self, count, timeout):
+        """Wait for a packet after the first 'count' ones; return False on timeout."""
+
+        with self.condition:
+            return self.condition.wait_for(lambda: self.packets > count, timeout)
+
+
+class GroundControl:
+    """Scripted stand-in of the ground control server."""
+
+    def __init__(self, args, counter):
+        self.args = args
+        self.counter = counter
+        self.server = None
+        self.port = None
+        self.connection = None
+        self.stream_errors = 0
+        self.recoveries = 0
+        self.listen()
+
+    def listen(self):
+        self.server = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        self.server.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+        self.server.bind(("127.0.0.1", self.port or 0))
+        self.server.listen(1)
+        self.port = self.server.getsockname()[1]
+
+    def accept(self, ack=True):
+        """Accept the streamer's connection and answer its login."""
+
+        self.server.settimeout(CONNECT_TIMEOUT_S)
+        try:
+            self.connection, _ = self.server.accept()
+        except socket.timeout:
+            raise SoakError("streamer did not connect")
+        self.connection.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        code, drone_id = HEADER.unpack(self.receive(HEADER.size))
+        if MOD_MSG_CODE_LOGIN != code or DRONE_ID != drone_id:
+            raise SoakError("invalid login %d/%d" % (code, drone_id))
+        self.connection.sendall(HEADER.pack(MOD_MSG_CODE_LOGIN_ACK if ack else MOD_MSG_CODE_LOGIN_NACK, DRONE_ID))
+
+    def receive(self, size, timeout=REPLY_TIMEOUT_S):
+        data = b""
+        self.connection.settimeout(timeout)
+        try:
+            while len(data) < size:
+                chunk = self.connection.recv(size - len(data))
+                if not chunk:
+                    raise SoakError("streamer closed the connection")
+                data += chunk
+        except socket.timeout:
+            raise SoakError("no message from the streamer")
+        return data
+
+    def expect(self, code, timeout=REPLY_TIMEOUT_S):
+        """Wait for a message to the ground control; stream errors on the way are counted."""
+
+        deadline = time.monotonic() + timeout
+        while True:
+            module, received = HEADER.unpack(self.receive(HEADER.size, max(deadline - time.monotonic(), 0.001)))
+            data = FIELD.unpack(self.receive(FIELD.size))[0] if received in DATA_CODES else None
+            if MOD_NAME_GCCOMMON != module:
+                raise SoakError("message to module %d" % module)
+            if MOD_MSG_CODE_STREAM_ERROR == received:
+                self.stream_errors += 1
+            elif MOD_MSG_CODE_STREAM_RECOVERED == received:
+                self.recoveries += 1
+            if code == received:
+                return data
+
+    def drain(self):
+        """Count the stream errors and recoveries that arrived without being waited for."""
+
+        self.connection.setblocking(False)
+        try:
+            while True:
+                module, received = HEADER.unpack(self.connection.recv(HEADER.size, socket.MSG_PEEK | socket.MSG_WAITALL))
+                if MOD_MSG_CODE_STREAM_ERROR == received:
+                    self.connection.recv(HEADER.size)
+                    self.stream_errors += 1
+                elif MOD_MSG_CODE_STREAM_RECOVERED == received:
+                    if HEADER.size + FIELD.size > len(self.connection.recv(HEADER.size + FIELD.size, socket.MSG_PEEK)):
+                        break
+                    self.connection.recv(HEADER.size + FIELD.size)
+                    self.recoveries += 1
+                else:
+                    break
+        except (BlockingIOError, struct.error):
+            pass
+        self.connection.setblocking(True)
+
+    def send(self, module, code, data=None):
+        message = HEADER.pack(module, code) + (FIELD.pack(data) if data is not None else b"")
+        self.connection.sendall(message)
+
+    def request(self):
+        """Request the stream; return the request latency in ms."""
+
+        start = time.monotonic()
+        self.send(MOD_NAME_STREAM, MOD_MSG_CODE_STREAM_REQ, self.counter.port)
+        self.expect(MOD_MSG_CODE_STREAM_TYPE)
+        return (time.monotonic() - start) * 1e3
+
+    def recover(self):
+        """Wait for the streamer to resume after a stream error; return the outage in ms."""
+
+        start = time.monotonic()
+        self.expect(MOD_MSG_CODE_STREAM_RECOVERED)
+        return (time.monotonic() - start) * 1e3
+
+    def start(self):
+        """Start the stream; return the latency of its first packet in ms."""
+
+        packets = self.counter.packets
+        start = time.monotonic()
+        self.send(MOD_NAME_STREAM, MOD_MSG_CODE_STREAM_START)
+        if not self.counter.wait_packet(packets, REPLY_TIMEOUT_S):
+            raise SoakError("no RTP packet after stream start")
+        return (time.monotonic() - start) * 1e3
+
+    def disconnect(self, reset):
+        if reset:
+            self.connection.setsockopt(socket.SOL_SOCKET, socket.SO_LINGER, struct.pack("ii", 1, 0))
+        self.connection.close()
+        self.connection = None
+
+    def refuse(self):
+        """Disconnect with the listening socket closed so that the reconnect fails."""
+
+        self.server.close()
+        self.disconnect(False)
+        time.sleep(REFUSE_S)
+        self.listen()
+
+
+class ResourceSampler:
+    """Samples the resource usage of a process periodically."""
+
+    def __init__(self, pid, period, progress):
+        self.pid = pid
+        self.period = period
+        self.progress = progress
+        self.start = time.monotonic()
+        self.samples = []
+        self.lock = threading.Lock()
+        self.stopped = threading.Event()
+        self.thread = threading.Thread(target=self.run, daemon=True)
+        self.thread.start()
+
+    def run(self):
+        while not self.stopped.wait(self.period):
+            try:
+                sample = {
+                    "t_s": round(time.monotonic() - self.start, 1),
+                    "sessions": self.progress(),
+                    "rss_kb": read_rss_kb(self.pid),
+                    "fds": len(os.listdir("/proc/%d/fd" % self.pid)),
+                    "threads": read_threads(self.pid),
+                }
+            except OSError:
+                return
+            with self.lock:
+                self.samples.append(sample)
+
+    def finish(self):
+        self.stopped.set()
+        self.thread.join()
+        return self.samples
+
+
+def read_threads(pid):
+    """Return the thread count of a process."""
+
+    with open("/proc/%d/status" % pid) as file:
+        for line in file:
+            if line.startswith("Threads:"):
+                return int(line.split()[1])
+    return 0
+
+
+def pick(generator, choices):
+    return generator.choices([name for name, _ in choices], [weight for _, weight in choices])[0]
+
+
+def run_session(control, generator, args, latencies, counts, elapsed):
+    """Play one session on an accepted connection (all but the disconnect)."""
+
+    for _ in range(generator.randint(1, 5)):
+        action = pick(generator, ACTIONS)
+        if "pipeline_error" == action and not args.frame_limit:
+            action = "stream"
+        counts[action] = counts.get(action, 0) + 1
+
+        if action in ("stream", "pipeline_error"):
+            latencies["request_ms"].append((elapsed(), control.request()))
+            latencies["first_packet_ms"].append((elapsed(), control.start()))
+            if "stream" == action:
+                time.sleep(generator.uniform(0.2, 1.5))
+            else:
+                errors = control.stream_errors
+                control.expect(MOD_MSG_CODE_STREAM_ERROR, args.frame_limit / args.fps + REPLY_TIMEOUT_S)
+                if control.stream_errors == errors:
+                    raise SoakError("no stream error after the frame limit")
+                latencies["recovery_ms"].append((elapsed(), control.recover()))
+            control.send(MOD_NAME_STREAM, MOD_MSG_CODE_STREAM_STOP)
+
+        elif "invalid_module" == action:
+            control.send(MOD_NAME_INVALID, MOD_MSG_CODE_STREAM_START)
+            time.sleep(0.2)
+
+        elif "invalid_code" == action:
+            control.send(MOD_NAME_STREAM, MOD_MSG_CODE_INVALID)
+            time.sleep(0.2)
+
+        else:
+            control.connection.sendall(FIELD.pack(MOD_NAME_STREAM))
+            time.sleep(TRUNCATED_WAIT_S)
+
+        control.drain()
+
+
+def check_growth(series, tolerance, warmup):
+    """Return the growth verdict of a metric's (t_s, value) series."""
+
+    values = [value for t, value in series if t >= warmup]
+    if len(values) < 6:
+        return {"samples": len(values), "growing": False}
+    third = len(values) // 3
+    medians = [statistics.median(values[:third]), statistics.median(values[third:-third]), statistics.median(values[-third:])]
+    times = [t for t, _ in series if t >= warmup]
+    mean_t = statistics.mean(times)
+    mean_v = statistics.mean(values)
+    variance = sum((t - mean_t) ** 2 for t in times)
+    slope = sum((t - mean_t) * (v - mean_v) for t, v in zip(times, values)) / variance if variance else 0.0
+    growing = medians[0] < medians[1] < medians[2] and medians[2] - medians[0] > tolerance
+    return {
+        "samples": len(values),
+        "thirds": medians,
+        "slope_per_hour": slope * 3600.0,
+        "tolerance": tolerance,
+        "growing": growing,
+    }
+
+
+def main():
+
+    parser = argparse.ArgumentParser(description="Soak the streamer against a scripted ground control.")
+    parser.add_argument("--streamerapp", required=True, help="streamer binary")
+    parser.add_argument("-o", "--output", help="JSON result file (default: stdout)")
+    parser.add_argument("--format", default=DEFAULT_FORMAT, help="virtual camera format (default: %(default)s)")
+    parser.add_argument("--size", default=DEFAULT_SIZE, help="virtual camera resolution (default: %(default)s)")
+    parser.add_argument("--fps", type=int, default=DEFAULT_FPS, help="virtual camera framerate (default: %(default)s)")
+    parser.add_argument("--frame-limit", type=int, default=DEFAULT_FRAME_LIMIT,
+                        help="test source frames until a pipeline error, 0: no pipeline errors (default: %(default)s)")
+    parser.add_argument("--duration", type=float, default=DEFAULT_DURATION_S, help="soak seconds (default: %(default)s)")
+    parser.add_argument("--cycles", type=int, default=0, help="stop after this many sessions (default: duration only)")
+    parser.add_argument("--warmup", type=float, default=DEFAULT_WARMUP_S, help="seconds not checked for growth (default: %(default)s)")
+    parser.add_argument("--sample-period", type=float, default=DEFAULT_SAMPLE_S, help="resource sampling seconds (default: %(default)s)")
+    parser.add_argument("--seed", type=int, default=DEFAULT_SEED, help="session script seed (default: %(default)s)")
+    parser.add_argument("--rss-tolerance", type=float, default=DEFAULT_RSS_TOLERANCE_KB, help="kB (default: %(default)s)")
+    parser.add_argument("--latency-tolerance", type=float, default=DEFAULT_LATENCY_TOLERANCE_MS, help="ms (default: %(default)s)")
+    args = parser.parse_args()
+
+    generator = random.Random(args.seed)
+    counter = PacketCounter()
+    control = GroundControl(args, counter)
+    latencies = {"request_ms": [], "first_packet_ms": [], "reconnect_ms": [], "recovery_ms": []}
+    counts = {}
+    sessions = 0
+    failure = None
+
+    with tempfile.TemporaryDirectory(prefix="soak_bench_") as workdir:
+        source = "test:%s:%s@%d" % (args.format, args.size, args.fps)
+        if args.frame_limit:
+            source += ":%d" % args.frame_limit
+        environment = dict(os.environ,
+                           CC_FOREGROUND="1",
+                           CC_LOG_LEVEL="error",
+                           CC_VIDEO_SOURCE=source,
+                           CC_STREAM_DEST_ADDR="127.0.0.1",
+                           CC_RECORDER_FILE=os.path.join(workdir, "recorder.bin"),
+                           CC_TRACE_FILE=os.path.join(workdir, "trace.bin"))
+        streamerapp = subprocess.Popen([args.streamerapp, "127.0.0.1", str(control.port)], env=environment,
+                                       stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+        sampler = ResourceSampler(streamerapp.pid, args.sample_period, lambda: sessions)
+        elapsed = lambda: time.monotonic() - sampler.start
+
+        try:
+            control.accept()
+            while elapsed() < args.duration and (not args.cycles or sessions < args.cycles):
+                run_session(control, generator, args, latencies, counts, elapsed)
+
+                disconnect = pick(generator, DISCONNECTS)
+                counts[disconnect] = counts.get(disconnect, 0) + 1
+                disconnect_time = time.monotonic()
+                if "refuse" == disconnect:
+                    control.refuse()
+                else:
+                    control.disconnect("reset" == disconnect)
+                if "login_nack" == disconnect:
+                    control.accept(ack=False)
+                    control.disconnect(False)
+                control.accept()
+                latencies["reconnect_ms"].append((elapsed(), (time.monotonic() - disconnect_time) * 1e3))
+
+                sessions += 1
+                if 0 == sessions % 100:
+                    print("soak_bench: %d sessions in %.0f s, %d stream errors" % (sessions, elapsed(), control.stream_errors),
+                          file=sys.stderr)
+                if streamerapp.poll() is not None:
+                    raise SoakError("streamer exited with %d" % streamerapp.returncode)
+
+        except (SoakError, OSError) as error:
+            failure = "session %d: %s" % (sessions, error)
+            if streamerapp.poll() is not None:
+                failure += " (streamer exited with %d)" % streamerapp.returncode
+            print("soak_bench: %s" % failure, file=sys.stderr)
+
+        finally:
+            samples = sampler.finish()
+            stop(streamerapp)
+
+    tolerances = {"rss_kb": args.rss_tolerance, "fds": 0, "threads": 0, "request_ms": args.latency_tolerance,
+                  "first_packet_ms": args.latency_tolerance, "reconnect_ms": args.latency_tolerance,
+                  "recovery_ms": args.latency_tolerance}
+    series = {metric: [(sample["t_s"], sample[metric]) for sample in samples] for metric in ["rss_kb", "fds", "threads"]}
+    series.update(latencies)
+    verdicts = {metric: check_growth(series[metric], tolerances[metric], args.warmup) for metric in METRICS}
+    growing = [metric for metric in METRICS if verdicts[metric]["growing"]]
+
+    for metric in METRICS:
+        verdict = verdicts[metric]
+        if "thirds" in verdict:
+            print("%-16s %10.1f %10.1f %10.1f  %+10.1f/h  %s" % (metric, verdict["thirds"][0], verdict["thirds"][1],
+                  verdict["thirds"][2], verdict["slope_per_hour"], "GROWING" if verdict["growing"] else "ok"), file=sys.stderr)
+
+    document = {
+        "version": 1,
+        "host": socket.gethostname(),
+        "timestamp": int(time.time()),
+        "source": source,
+        "seed": args.seed,
+        "duration_s": round(elapsed(), 1),
+        "sessions": sessions,
+        "actions": counts,
+        "stream_errors": control.stream_errors,
+        "recoveries": control.recoveries,
+        "packets": counter.packets,
+        "failure": failure,
+        "growing": growing,
+        "metrics": verdicts,
+        "samples": samples,
+    }
+
+    if args.output:
+        with open(args.output, "w") as file:
+            json.dump(document, file, indent=2)
+            file.write("\n")
+    else:
+        json.dump(document, sys.stdout, indent=2)
+        sys.stdout.write("\n")
+
+    return 1 if failure or growing else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,236 @@
+#!/usr/bin/env python3
+"""
+@file        startup_bench.py
+@author      Adam Csizy
+@date        2021-05-21
+@version     v1.1.0
+
+@brief       Process start to ready benchmark of the streamer and the ground control
+
+Launches each application repeatedly and measures the time from the
+launch to the point it is ready:
+
+    streamer        its "milestone=ready" log record (pipeline built, see
+                    startup_utils.h), read from its log file
+    ground control  its server socket listening (streaming services and
+                    GStreamer initialized before, see its main.c)
+
+with every plugin loading variant:
+
+    scan            empty registry: every system plugin is loaded and scanned
+    cached          warm registry of the system plugins: every plugin file
+                    is validated (stat) on startup, GStreamer's default
+    pinned          pinned plugin directory (see tools/pin_gst_plugins.py)
+    static          binaries built with "make GST_STATIC=1" (--static only)
+
+and reports per application and variant:
+
+    ready_ms        median launch to ready
+    ready_min_ms    fastest launch to ready
+    self_ready_ms   median of the streamer's own ready time (from main(),
+                    without loading and dynamic linking)
+
+With --drop-caches the page cache is dropped before every launch (root
+only), which is what a cold boot from an SD card looks like.
+
+Launch like this (or "make startup-run"):
+
+./startup_bench.py --streamerapp <PATH> --controlapp <PATH> [-o <JSON_FILE>] [--runs <N>]
+                   [--drone-plugins <DIR>] [--gc-plugins <DIR>] [--static] [--drop-caches]
+
+The result file has the layout of the streamerbench results, compare two
+runs with compare_bench.py "--metric ready_ms".
+"""
+
+import argparse
+import json
+import os
+import re
+import socket
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+
+from loopback_bench import wait_for_listen, stop, SERVER_PORT, STREAM_PORT
+
+
+DEFAULT_RUNS = 5                            # Launches per application and variant
+READY_TIMEOUT_S = 60.0                      # Give up on a launch after this
+POLL_S = 0.002                              # Polling period of the readiness checks
+UNUSED_SERVER_PORT = "1"                    # The streamer does not need a ground control to get ready
+READY_PATTERN = re.compile(r"milestone=ready elapsed_ms=([0-9.]+)")
+
+
+def drop_caches():
+    """Drop the page cache (needs root)."""
+
+    subprocess.run(["sync"], check=False)
+    with open("/proc/sys/vm/drop_caches", "w") as file:
+        file.write("3\n")
+
+
+def variant_environment(variant, workdir, plugins):
+    """Return the GStreamer environment of a variant."""
+
+    environment = dict(os.environ)
+    for name in ("GST_REGISTRY_1_0", "GST_REGISTRY", "GST_REGISTRY_UPDATE", "GST_PLUGIN_PATH_1_0", "CC_GST_PLUGIN_DIR"):
+        environment.pop(name, None)
+
+    if "scan" == variant:
+        environment["GST_REGISTRY_1_0"] = os.path.join(workdir, "scan.bin")
+    elif "cached" == variant:
+        environment["GST_REGISTRY_1_0"] = os.path.join(workdir, "cached.bin")
+    elif "pinned" == variant:
+        environment["CC_GST_PLUGIN_DIR"] = os.path.abspath(plugins)
+    return environment
+
+
+def launch_streamer(args, environment, workdir):
+    """Launch the streamer once and return (ready_ms, self_ready_ms) or None."""
+
+    log_path = os.path.join(workdir, "streamer.log")
+    if os.path.exists(log_path):
+        os.remove(log_path)
+
+    environment = dict(environment,
+                       CC_FOREGROUND="1",
+                       CC_LOG_FILE=log_path,
+                       CC_VIDEO_SOURCE="test:jpeg:320x240@30",
+                       CC_RECORDER_FILE=os.path.join(workdir, "recorder.bin"),
+                       CC_TRACE_FILE=os.path.join(workdir, "trace.bin"))
+
+    launch = time.monotonic()
+    streamerapp = subprocess.Popen([args.streamerapp, "127.0.0.1", UNUSED_SERVER_PORT], env=environment,
+                                   stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+    try:
+        while time.monotonic() - launch < READY_TIMEOUT_S and streamerapp.poll() is None:
+            try:
+                with open(log_path) as file:
+                    match = READY_PATTERN.search(file.read())
+            except OSError:
+                match = None
+            if match is not None:
+                return ((time.monotonic() - launch) * 1e3, float(match.group(1)))
+            time.sleep(POLL_S)
+        return None
+    finally:
+        stop(streamerapp)
+
+
+def launch_controlapp(args, environment, plugins):
+    """Launch the ground control once and return (ready_ms, None) or None."""
+
+    command = [args.controlapp, "-H", "-p", STREAM_PORT]
+    if plugins is not None:
+        command += ["-R", os.path.abspath(plugins)]
+
+    launch = time.monotonic()
+    controlapp = subprocess.Popen(command, env=environment, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+    try:
+        if wait_for_listen(SERVER_PORT, READY_TIMEOUT_S, POLL_S):
+            return ((time.monotonic() - launch) * 1e3, None)
+        return None
+    finally:
+        stop(controlapp)
+
+
+def run_variant(args, application, variant, workdir):
+    """Launch an application with a plugin loading variant and return its result entry or None."""
+
+    plugins = args.drone_plugins if "drone" == application else args.gc_plugins
+    environment = variant_environment(variant, workdir, plugins)
+    if "scan" != variant and "static" != variant:
+        # Warm up: writes the cached registry, pages the binaries in
+        run_once(args, application, variant, environment, workdir, plugins)
+
+    samples = []
+    for _ in range(args.runs):
+        if "scan" == variant and os.path.exists(environment["GST_REGISTRY_1_0"]):
+            os.remove(environment["GST_REGISTRY_1_0"])
+        if args.drop_caches:
+            drop_caches()
+        sample = run_once(args, application, variant, environment, workdir, plugins)
+        if sample is None:
+            print("startup_bench: %s/%s: not ready after %.0f s" % (application, variant, READY_TIMEOUT_S), file=sys.stderr)
+            return None
+        samples.append(sample)
+
+    ready = [sample[0] for sample in samples]
+    result = {
+        "name": "startup_%s_%s" % (application, variant),
+        "ready_ms": statistics.median(ready),
+        "ready_min_ms": min(ready),
+    }
+    if samples[0][1] is not None:
+        result["self_ready_ms"] = statistics.median(sample[1] for sample in samples)
+
+    print("%-24s ready %8.1f ms (min %8.1f ms)%s" % (result["name"], result["ready_ms"], result["ready_min_ms"],
+          ("  self %8.1f ms" % result["self_ready_ms"]) if "self_ready_ms" in result else ""), file=sys.stderr)
+    return result
+
+
+def run_once(args, application, variant, environment, workdir, plugins):
+    """Launch an application once and return its sample or None."""
+
+    if "drone" == application:
+        return launch_streamer(args, environment, workdir)
+    return launch_controlapp(args, environment, plugins if "pinned" == variant else None)
+
+
+def main():
+
+    parser = argparse.ArgumentParser(description="Benchmark process start to ready of both applications.")
+    parser.add_argument("--streamerapp", required=True, help="streamer binary (optimized build)")
+    parser.add_argument("--controlapp", required=True, help="ground control binary")
+    parser.add_argument("-o", "--output", help="JSON result file (default: stdout)")
+    parser.add_argument("--runs", type=int, default=DEFAULT_RUNS, help="launches per variant (default: %(default)s)")
+    parser.add_argument("--drone-plugins", default="build/gst-plugins", help="pinned plugins of the streamer (default: %(default)s)")
+    parser.add_argument("--gc-plugins", default="build/gc-gst-plugins", help="pinned plugins of the ground control (default: %(default)s)")
+    parser.add_argument("--static", action="store_true", help="binaries were built with GST_STATIC=1")
+    parser.add_argument("--drop-caches", action="store_true", help="drop the page cache before every launch (root)")
+    args = parser.parse_args()
+
+    if args.static:
+        variants = ["static"]
+    else:
+        variants = ["scan", "cached"]
+        if os.path.isdir(args.drone_plugins) and os.path.isdir(args.gc_plugins):
+            variants.append("pinned")
+        else:
+            print("startup_bench: no pinned plugins (run \"make plugins\"), pinned variant skipped", file=sys.stderr)
+
+    results = []
+    failures = 0
+    with tempfile.TemporaryDirectory(prefix="startup_bench_") as workdir:
+        for application in ("drone", "gc"):
+            for variant in variants:
+                result = run_variant(args, application, variant, workdir)
+                if result is None:
+                    failures += 1
+                else:
+                    results.append(result)
+
+    document = {
+        "version": 1,
+        "host": socket.gethostname(),
+        "timestamp": int(time.time()),
+        "runs": args.runs,
+        "drop_caches": args.drop_caches,
+        "results": results,
+    }
+
+    if args.output:
+        with open(args.output, "w") as file:
+            json.dump(document, file, indent=2)
+            file.write("\n")
+    else:
+        json.dump(document, sys.stdout, indent=2)
+        sys.stdout.write("\n")
+
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
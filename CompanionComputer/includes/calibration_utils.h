@@ -0,0 +1,117 @@
+/**
+ * @file        calibration_utils.h
+ * @author      Adam Csizy
+ * @date        2021-05-29
+ * @version     v1.1.0
+ *
+ * @brief       Video coding format calibration utilities
+ */
+
+#pragma once
+
+
+#include <gst/gst.h>
+
+#include "camera_utils.h"
+
+
+/* Calibration related public macro definitions */
+
+#define STR_CALIBRATION_ENV_OBJECTIVE   "CC_FORMAT_OBJECTIVE"   /**< Environment variable of the ranking objective ("latency", "bandwidth", "cpu"; unset: enum order) */
+#define STR_CALIBRATION_ENV_FILE        "CC_CALIBRATION_FILE"   /**< Environment variable overriding the calibration cache path */
+#define STR_CALIBRATION_ENV_SECONDS     "CC_CALIBRATION_SECONDS" /**< Environment variable of the measurement time per format */
+#define STR_CALIBRATION_FILE_DEFAULT    "/var/tmp/DroneVideoStreamer.cal" /**< Default calibration cache path */
+#define NUM_CALIBRATION_SECONDS         2U      /**< Default measurement time per format and encoder in seconds */
+#define NUM_CALIBRATION_SECONDS_MAX     30U     /**< Maximum measurement time per format and encoder in seconds */
+#define NUM_CALIBRATION_WARMUP_MS       500U    /**< Time from PLAYING to the start of the measurement */
+#define NUM_CALIBRATION_ENCODER_MAX     4U      /**< Maximum number of H.264 encoder candidates for RAW sources */
+#define NUM_CALIBRATION_MIN_FPS_PERCENT 50U     /**< Formats below this share of the nominal framerate rank last */
+
+
+/* Calibration related public type definitions */
+
+/**
+ * @brief   Enumeration of format ranking objectives.
+ */
+typedef enum CalibrationObjective {
+
+    CAL_OBJ_NONE        = 0,    /**< No calibration, VideoCodingFormat_T order */
+    CAL_OBJ_LATENCY     = 1,    /**< Lowest capture to payloader latency plus frame interval ("latency") */
+    CAL_OBJ_BANDWIDTH   = 2,    /**< Lowest bits per pixel ("bandwidth") */
+    CAL_OBJ_CPU         = 3     /**< Lowest CPU load ("cpu") */
+
+} CalibrationObjective_T;
+
+/**
+ * @brief   Build function of a calibration pipeline.
+ *
+ * @details Builds the streaming pipeline of a format in its initial
+ *          state with a null sink in place of the network sink.
+ *          The returned elements are owned by the pipeline.
+ *
+ * @param[out]  pipeline Calibration pipeline.
+ * @param[out]  capsfilter Capture caps filter of the pipeline.
+ * @param[out]  payloader Payloader of the pipeline.
+ * @param[in]   codingFormat Video coding format.
+ * @param[in]   encoder Index of the H.264 encoder (RAW only, -1 otherwise).
+ * @param[in]   data User data.
+ *
+ * @return      0 on success, -1 on failure.
+ */
+typedef int (*CalibrationBuildFunc_T)(GstElement* *pipeline, GstElement* *capsfilter, GstElement* *payloader,
+                                      const VideoCodingFormat_T codingFormat, const int encoder, void *data);
+
+
+/* Calibration related public function declarations */
+
+/**
+ * @brief       Initialize format ranking.
+ *
+ * @details     Ranks the supported video coding formats by the
+ *              objective of CC_FORMAT_OBJECTIVE. Every supported
+ *              format (RAW with every available H.264 encoder) is
+ *              streamed into a null sink for CC_CALIBRATION_SECONDS
+ *              measuring the achieved framerate, the CPU load of the
+ *              process, the bits per frame and the capture to
+ *              payloader latency. The results are cached in
+ *              CC_CALIBRATION_FILE and reused while the video source,
+ *              its capabilities and the available encoders are
+ *              unchanged (delete the file to calibrate again).
+ *              Formats below NUM_CALIBRATION_MIN_FPS_PERCENT of their
+ *              nominal framerate or failing rank last. Keeps the
+ *              VideoCodingFormat_T order if unset or on failure.
+ *              Must be called before the streaming pipelines are
+ *              built (the camera must not be in use).
+ *
+ * @param[in]   source Video source configuration.
+ * @param[in]   caps Video coding capabilities of the source.
+ * @param[in]   encoderNames H.264 encoder candidates for RAW sources.
+ * @param[in]   encoderCount Number of encoder candidates.
+ * @param[in]   build Build function of the calibration pipelines.
+ * @param[in]   data User data of the build function.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success (or calibration disabled)
+ * @retval      -1 Failure (enum order kept)
+ */
+int initFormatRanking(const VideoSourceConfig_T *source, const VideoCodingFormatCaps_T caps[NUM_SUP_VID_COD_FMT],
+                      const char *const encoderNames[], const unsigned int encoderCount, CalibrationBuildFunc_T build, void *data);
+
+/**
+ * @brief       Get format ranking.
+ *
+ * @details     Every video coding format of this software in the
+ *              order of preference: ranked formats first, then the
+ *              rest in VideoCodingFormat_T order.
+ *
+ * @param[out]  ranking Video coding formats in the order of preference.
+ */
+void getFormatRanking(VideoCodingFormat_T ranking[NUM_SUP_VID_COD_FMT]);
+
+/**
+ * @brief       Get ranked H.264 encoder.
+ *
+ * @return      Index of the best H.264 encoder for RAW sources or -1 if not ranked.
+ */
+int getRankedEncoder(void);
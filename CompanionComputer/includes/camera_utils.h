@@ -16,6 +16,24 @@
 /* Camera related public macro definitions */
 
 #define NUM_SUP_VID_COD_FMT   7U    /**< Number of supported video coding formats (see VideoCodingFormat_T). */
+#define NUM_VID_SRC_PATH_SIZE 256U  /**< Size of the video source path (device node or file location) */
+#define STR_VIDEO_SOURCE_ENV  "CC_VIDEO_SOURCE" /**< Environment variable selecting the video source (see getVideoSourceConfig()) */
+#define STR_LATENCY_STAMP_ENV "CC_LATENCY_STAMP" /**< Environment variable enabling the latency stamp of test sources (see createVideoSource()) */
+
+/*
+ * Latency stamp: a NUM_LATENCY_STAMP_ROWS x NUM_LATENCY_STAMP_COLUMNS grid
+ * of NUM_LATENCY_STAMP_BLOCK pixel wide luma blocks in the top left corner
+ * of the frame, one 16-bit word per row, most significant bit first, white
+ * for 1 and black for 0. Words: CLOCK_REALTIME capture time in microseconds
+ * (the ground control's once synchronized, see clock_utils.h; 4 words, most
+ * significant first), frame counter, check word
+ * (NUM_LATENCY_STAMP_CHECK ^ every other word). Must match the latency
+ * decoder of the ground control (GroundControl/CLIGroundControl/src/stream_utils.c).
+ */
+#define NUM_LATENCY_STAMP_BLOCK     16      /**< Latency stamp block size in pixels (one macroblock) */
+#define NUM_LATENCY_STAMP_COLUMNS   16      /**< Latency stamp bits per row */
+#define NUM_LATENCY_STAMP_ROWS      6       /**< Latency stamp words */
+#define NUM_LATENCY_STAMP_CHECK     0x5A5AU /**< Latency stamp check word seed */
 
 
 /* Camera related public type definitions */
@@ -28,7 +46,8 @@
  *              enumerated formats.
  * 
  *              The enumeration values also define the priorities
- *              of the preferred video coding formats.
+ *              of the preferred video coding formats unless they
+ *              are ranked on the hardware (see calibration_utils.h).
  */
 typedef enum VideoCodingFormat {
 
@@ -86,6 +105,39 @@ typedef struct VideoCodingFormatContext {
 
 } VideoCodingFormatContext_T;
 
+/**
+ * @brief       Enumeration of video source types.
+ */
+typedef enum VideoSourceType {
+
+  VIDEO_SRC_V4L2  = 0,      /**< V4L2 camera device (v4l2src) */
+  VIDEO_SRC_TEST  = 1,      /**< Synthetic test pattern (videotestsrc, encoded if needed) */
+  VIDEO_SRC_FILE  = 2       /**< Looped file(s) (multifilesrc) */
+
+} VideoSourceType_T;
+
+/**
+ * @brief       Video source configuration.
+ *
+ * @details     Describes where the video streaming pipeline
+ *              takes its frames from. Virtual sources (test
+ *              and file) advertise exactly one video coding
+ *              format with the given capabilities; the V4L2
+ *              source advertises whatever the device supports.
+ */
+typedef struct VideoSourceConfig {
+
+  VideoSourceType_T type;               /**< Type of the video source */
+  VideoCodingFormat_T format;           /**< Advertised video coding format (virtual sources only) */
+  int width;                            /**< Advertised frame width (virtual sources only) */
+  int height;                           /**< Advertised frame height (virtual sources only) */
+  int framerate;                        /**< Advertised framerate in frames per second (virtual sources only) */
+  char path[NUM_VID_SRC_PATH_SIZE];     /**< Camera device path or file location (multifilesrc syntax) */
+  int latencyStamp;                     /**< Flag whether frames carry the latency stamp (test sources only) */
+  int frameLimit;                       /**< Frames after which the source ends the stream (test sources only, 0: endless) */
+
+} VideoSourceConfig_T;
+
 
 /* Camera related public function declarations */
 
@@ -154,4 +206,95 @@ int getCameraDevicePath(char cameraDevicePath[], const size_t size);
  * @retval      0 Success
  * @retval      -1 Failure
  */
-int getCameraCapabilities(GstElement *v4l2srcElement, VideoCodingFormatContext_T *ctx);
\ No newline at end of file
+int getCameraCapabilities(GstElement *v4l2srcElement, VideoCodingFormatContext_T *ctx);
+
+/**
+ * @brief       Parses camera capabilities.
+ * 
+ * @details     Selects the best resolution and the highest
+ *              framerate of each video coding format found in the
+ *              given capabilities and stores them in the user
+ *              data context like getCameraCapabilities() does.
+ *              Separated from the pad query so that synthetic
+ *              capabilities can be parsed as well (benchmarks).
+ * 
+ * @param[in]   capabilities Capabilities of a camera device source pad.
+ * @param[in,out]   ctx User data context.
+ * 
+ * @return      Result of execution.
+ * 
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+int parseCameraCapabilities(const GstCaps *capabilities, VideoCodingFormatContext_T *ctx);
+
+/**
+ * @brief       Gets the video source configuration.
+ *
+ * @details     Parses the STR_VIDEO_SOURCE_ENV environment
+ *              variable:
+ *
+ *              (unset), "v4l2"              first compatible camera device (getCameraDevicePath())
+ *              "v4l2:<DEVICE>"              the given camera device
+ *              "test:<FMT>[:<W>x<H>@<FPS>[:<FRAMES>]]" videotestsrc (default 640x480@30)
+ *              "file:<FMT>:<W>x<H>@<FPS>:<LOCATION>"  looped multifilesrc location
+ *
+ *              where <FMT> is one of "jpeg", "h264" and "raw".
+ *              Virtual sources make the streamer usable without
+ *              a camera (loopback benchmarks, CI). A test source
+ *              with <FRAMES> ends the stream after that many frames
+ *              like a failing camera would (soak benchmark). A non-empty
+ *              STR_LATENCY_STAMP_ENV other than "0" turns on the
+ *              latency stamp of test sources.
+ *
+ * @param[out]  config Video source configuration.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+int getVideoSourceConfig(VideoSourceConfig_T *config);
+
+/**
+ * @brief       Creates the video source element.
+ *
+ * @details     Creates a v4l2src element for V4L2 sources.
+ *              Virtual sources are built as a bin with a
+ *              single 'src' ghost pad producing the configured
+ *              video coding format at the configured rate, so
+ *              the rest of the pipeline cannot tell them from
+ *              a camera. Test sources with latency stamp write
+ *              the capture time and a frame counter into the
+ *              raw I420 frames before encoding (see
+ *              NUM_LATENCY_STAMP_BLOCK), so the ground control
+ *              can measure glass-to-glass latency on the decoded
+ *              frames.
+ *
+ * @note        GStreamer core and plugins must be initialized
+ *              using 'gst_init()' before invoking this function.
+ *
+ * @param[in]   config Video source configuration.
+ * @param[in]   name Name of the created element.
+ *
+ * @return      Floating reference to the created element or NULL.
+ */
+GstElement* createVideoSource(const VideoSourceConfig_T *config, const char *name);
+
+/**
+ * @brief       Gets the capabilities of a virtual video source.
+ *
+ * @details     Builds the capabilities advertised by a test or
+ *              file video source and parses them into the user
+ *              data context like getCameraCapabilities() does
+ *              for camera devices.
+ *
+ * @param[in]   config Video source configuration.
+ * @param[in,out]   ctx User data context.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+int getVideoSourceCapabilities(const VideoSourceConfig_T *config, VideoCodingFormatContext_T *ctx);
\ No newline at end of file
@@ -0,0 +1,248 @@
+/**
+ * @file        clock_utils.h
+ * @author      Adam Csizy
+ * @date        2021-05-31
+ * @version     v1.1.0
+ *
+ * @brief       Ground control clock synchronization utilities
+ *
+ * @details     Estimates the offset and the drift of the ground
+ *              control's clock (CLOCK_REALTIME of the ground control,
+ *              the common timebase of every drone) against the local
+ *              CLOCK_MONOTONIC from timestamped request and response
+ *              exchanges on the control link, the way NTP does:
+ *
+ *                  t1  local time of sending the request
+ *                  t2  ground time of receiving the request
+ *                  t3  ground time of sending the response
+ *                  t4  local time of receiving the response
+ *
+ *                  offset = ((t2 - t1) + (t3 - t4)) / 2
+ *                  delay  = (t4 - t1) - (t3 - t2)
+ *
+ *              The error of an exchange's offset is at most half its
+ *              delay, so only the exchanges with a delay near the
+ *              smallest one of the last NUM_CLOCK_SAMPLES are used (the
+ *              rest waited in a queue on the way). A line fitted to
+ *              their offsets gives the drift, exchanges far off the
+ *              line are dropped as outliers. A step of the ground
+ *              clock restarts the estimation.
+ */
+
+#pragma once
+
+
+#include <stdint.h>
+
+
+/* Clock synchronization related public macro definitions */
+
+#define STR_CLOCK_ENV_INTERVAL          "CC_CLOCK_SYNC_INTERVAL_MS" /**< Environment variable of the exchange interval (0 disables clock synchronization) */
+#define NUM_CLOCK_INTERVAL_MS           2000U   /**< Default exchange interval in milliseconds */
+#define NUM_CLOCK_BURST_INTERVAL_MS     200U    /**< Exchange interval after (re)connecting */
+#define NUM_CLOCK_BURST_EXCHANGES       8U      /**< Number of exchanges at the burst interval after (re)connecting */
+#define NUM_CLOCK_SAMPLES               32U     /**< Number of exchanges the estimate is made of */
+#define NUM_CLOCK_MAP_INTERVAL_MS       1000U   /**< Interval of the RTP clock mappings sent to the ground control */
+#define NUM_CLOCK_RTP_RATE              90000U  /**< RTP clock rate of the video payloaders in Hz */
+
+
+/* Clock synchronization related public type definitions */
+
+/**
+ * @brief   Struct of a clock exchange.
+ *
+ * @details A request carries the origin time only, the response
+ *          carries all three (see the file description).
+ */
+typedef struct ClockExchange {
+
+    uint64_t originNs;      /**< Local time of sending the request (t1) */
+    uint64_t receiveNs;     /**< Ground time of receiving the request (t2) */
+    uint64_t transmitNs;    /**< Ground time of sending the response (t3) */
+
+} ClockExchange_T;
+
+/**
+ * @brief   Struct of an RTP clock mapping.
+ *
+ * @details Maps an RTP timestamp of the video stream to the ground
+ *          time of the frame's capture (like the NTP and RTP
+ *          timestamp pair of an RTCP sender report, see RFC 7273 for
+ *          the clock signaling). Other RTP timestamps of the stream
+ *          follow at NUM_CLOCK_RTP_RATE.
+ */
+typedef struct ClockMapping {
+
+    uint32_t ssrc;              /**< SSRC of the video stream */
+    uint32_t rtpTimestamp;      /**< RTP timestamp */
+    uint64_t groundNs;          /**< Ground time of the capture of the RTP timestamp's frame */
+    uint32_t uncertaintyUs;     /**< Error bound of the ground time in microseconds */
+
+} ClockMapping_T;
+
+/**
+ * @brief   Struct of the clock synchronization status.
+ */
+typedef struct ClockSyncStatus {
+
+    int synchronized;           /**< Flag whether the ground time is known */
+    int64_t offsetNs;           /**< Ground time minus local time now */
+    int32_t driftPpb;           /**< Rate of the ground clock against the local clock in parts per billion */
+    uint32_t delayNs;           /**< Smallest round trip delay of the exchanges */
+    uint32_t uncertaintyNs;     /**< Error bound of the ground time */
+    uint32_t samples;           /**< Exchanges the estimate is made of */
+    uint64_t ageMs;             /**< Time since the last exchange used in milliseconds */
+
+} ClockSyncStatus_T;
+
+
+/* Clock synchronization related public function declarations */
+
+struct _GstElement;
+
+/**
+ * @brief       Initialize clock synchronization.
+ *
+ * @details     Reads the exchange interval (CC_CLOCK_SYNC_INTERVAL_MS).
+ *              Must be called before the network module starts.
+ *              Clock synchronization stays disabled with a zero
+ *              interval: the ground time is unknown then.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success (or disabled)
+ * @retval      -1 Failure (default interval used)
+ */
+int initClockSync(void);
+
+/**
+ * @brief       Restart clock synchronization.
+ *
+ * @details     Drops the exchanges of the previous connection (the
+ *              ground control may be another one) and exchanges at
+ *              the burst interval. Called after connecting to the
+ *              ground control. Thread-safe.
+ */
+void restartClockSync(void);
+
+/**
+ * @brief       Take clock request to be sent.
+ *
+ * @details     Stamps the origin time of the next request if it is
+ *              due. Called by the network output thread right before
+ *              sending while the link is idle (queued bytes would
+ *              delay the request). Only the response to the latest
+ *              request is accepted. Thread-safe.
+ *
+ * @param[out]  exchange Request to be sent (origin time set).
+ * @param[out]  delayMs Time until the next request is due (retval 1).
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Request due
+ * @retval      1 No request due
+ * @retval      -1 Clock synchronization disabled
+ */
+int takeClockRequest(ClockExchange_T *exchange, unsigned int *delayMs);
+
+/**
+ * @brief       Process clock response.
+ *
+ * @details     Adds the exchange to the estimate. Called by the
+ *              network input thread. Thread-safe.
+ *
+ * @param[in]   exchange Response of the ground control.
+ * @param[in]   arrivalNs Local time of receiving the response (t4, see getLocalClockNs()).
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Exchange used
+ * @retval      -1 Exchange dropped (stale, invalid or outlier)
+ */
+int processClockResponse(const ClockExchange_T *exchange, const uint64_t arrivalNs);
+
+/**
+ * @brief       Get local time.
+ *
+ * @return      CLOCK_MONOTONIC time in nanoseconds (the clock of the pipelines).
+ */
+uint64_t getLocalClockNs(void);
+
+/**
+ * @brief       Convert local time to ground time.
+ *
+ * @details     Thread-safe.
+ *
+ * @param[in]   localNs Local time (see getLocalClockNs()).
+ * @param[out]  groundNs Ground time (CLOCK_REALTIME of the ground control).
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure (not synchronized)
+ */
+int convertToGroundTime(const uint64_t localNs, uint64_t *groundNs);
+
+/**
+ * @brief       Get ground time.
+ *
+ * @details     Thread-safe.
+ *
+ * @param[out]  groundNs Ground time now (CLOCK_REALTIME of the ground control).
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure (not synchronized)
+ */
+int getGroundTimeNs(uint64_t *groundNs);
+
+/**
+ * @brief       Get clock synchronization status.
+ *
+ * @details     Thread-safe.
+ *
+ * @param[out]  status Status of the estimate.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+int getClockSyncStatus(ClockSyncStatus_T *status);
+
+/**
+ * @brief       Attach RTP clock mapping.
+ *
+ * @details     Taps the payloader's source pad of a new pipeline:
+ *              every NUM_CLOCK_MAP_INTERVAL_MS the RTP timestamp of a
+ *              packet is mapped to the ground time of its frame's
+ *              capture (presentation timestamp on the pipeline
+ *              clock). The ground control maps the RTP timestamps of
+ *              the stream with it. No-op if clock synchronization is
+ *              disabled.
+ *
+ * @param[in]   payloader Payloader (GstElement).
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure (the stream is not affected)
+ */
+int attachClockMapping(struct _GstElement *payloader);
+
+/**
+ * @brief       Take RTP clock mapping to be sent.
+ *
+ * @details     Takes the latest mapping not sent yet. Called by the
+ *              network output thread when no control message is
+ *              waiting. Thread-safe.
+ *
+ * @param[out]  mapping Mapping to be sent.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Mapping taken
+ * @retval      1 No new mapping
+ */
+int takeClockMapping(ClockMapping_T *mapping);
@@ -16,6 +16,9 @@
 #include <unistd.h>
 
 #include "camera_utils.h" 
+#include "clock_utils.h"
+#include "snapshot_utils.h"
+#include "telemetry_utils.h"
 
 
 /* Communication related public macro definitions */
@@ -24,6 +27,15 @@
 #define VideoStreamPort_T       uint32_t    /**< Type of video streaming port number */
 #define MOD_MSGQ_NOBLOCK        1           /**< Module message queue non-blocking flag */
 #define MOD_MSGQ_BLOCK          0           /**< Module message queue blocking flag */
+#define NUM_NET_MSG_HEADER_SIZE 8U          /**< Size of network message header in bytes (module name and message code) */
+#define NUM_NET_MSG_DATA_SIZE   4U          /**< Size of network message data in bytes (if the message code carries data) */
+#define NUM_NET_MSG_TELEMETRY_SIZE 20U      /**< Size of telemetry network message data in bytes (channel, age and values) */
+#define NUM_NET_MSG_SNAPSHOT_SIZE 12U       /**< Size of snapshot network message data in bytes (ID, size and status) */
+#define NUM_NET_MSG_SNAPSHOT_DATA_SIZE 12U  /**< Size of snapshot data network message data in bytes (ID, offset and length, the chunk follows) */
+#define NUM_NET_MSG_CLOCK_REQ_SIZE 8U       /**< Size of clock request network message data in bytes (origin time) */
+#define NUM_NET_MSG_CLOCK_RESP_SIZE 24U     /**< Size of clock response network message data in bytes (origin, receive and transmit time) */
+#define NUM_NET_MSG_CLOCK_MAP_SIZE 20U      /**< Size of RTP clock mapping network message data in bytes (SSRC, RTP timestamp, ground time and uncertainty) */
+#define NUM_NET_MSG_MAX_SIZE    (NUM_NET_MSG_HEADER_SIZE + NUM_NET_MSG_CLOCK_RESP_SIZE) /**< Maximum size of an encoded network message in bytes */
 
 
 /* Communication related public type definitions */
@@ -51,7 +63,18 @@ typedef enum ModuleMessageCode {
     MOD_MSG_CODE_STREAM_START   = 5,    /**< Start video stream (ground control) */
     MOD_MSG_CODE_STREAM_STOP    = 6,    /**< Stop video stream (ground control) */
     MOD_MSG_CODE_STREAM_TYPE    = 7,    /**< Type of requested video stream (drone) */
-    MOD_MSG_CODE_LOGIN_NACK     = 8     /**< Login not confirmed (ground control) */
+    MOD_MSG_CODE_LOGIN_NACK     = 8,    /**< Login not confirmed (ground control) */
+    MOD_MSG_CODE_PROFILE_DUMP   = 9,    /**< Dump pipeline profile (ground control, see profiler_utils.h) */
+    MOD_MSG_CODE_STREAM_RETRY   = 10,   /**< Retry pipeline recovery (drone internal, see streamErrorHandler()) */
+    MOD_MSG_CODE_STREAM_RECOVERED = 11, /**< Video stream recovered and resumed in the given coding format (drone) */
+    MOD_MSG_CODE_STREAM_STALL   = 12,   /**< Pipeline stalled without error (drone internal, see watchdog_utils.h) */
+    MOD_MSG_CODE_TELEMETRY      = 13,   /**< Latest telemetry sample of a channel (drone, see telemetry_utils.h) */
+    MOD_MSG_CODE_SNAPSHOT_REQ   = 14,   /**< Take a still snapshot (ground control, see snapshot_utils.h) */
+    MOD_MSG_CODE_SNAPSHOT       = 15,   /**< Snapshot captured or failed (drone) */
+    MOD_MSG_CODE_SNAPSHOT_DATA  = 16,   /**< Chunk of a captured snapshot (drone, sent on an idle link only) */
+    MOD_MSG_CODE_CLOCK_REQ      = 17,   /**< Clock exchange request (drone, see clock_utils.h) */
+    MOD_MSG_CODE_CLOCK_RESP     = 18,   /**< Clock exchange response (ground control) */
+    MOD_MSG_CODE_CLOCK_MAP      = 19    /**< RTP timestamp to ground time mapping of the video stream (drone) */
 
 } ModuleMessageCode_T;
 
@@ -62,6 +85,10 @@ typedef union ModuleMessageData {
 
     VideoCodingFormat_T codingFormat;   /**< Video coding format */
     VideoStreamPort_T videoStreamPort;  /**< Port number on which the ground control accepts the video stream  */
+    TelemetrySample_T telemetry;        /**< Telemetry sample */
+    SnapshotInfo_T snapshot;            /**< Snapshot result */
+    ClockExchange_T clockExchange;      /**< Clock exchange */
+    ClockMapping_T clockMapping;        /**< RTP clock mapping */
 
 } ModuleMessageData_T;
 
@@ -218,6 +245,28 @@ int insertModuleMessage(ModuleMessageQueue_T *messageQueue, ModuleMessage_T *mes
  */
 int removeModuleMessage(ModuleMessageQueue_T *messageQueue, ModuleMessage_T* *message, const int noblock);
 
+/**
+ * @brief       Remove message from module message queue with timeout.
+ * 
+ * @details     Removes module message from the given module
+ *              message queue (FIFO), waiting at most the given
+ *              time for one. The message object must be freed
+ *              by the receiver.
+ *
+ * @note        Thread safe.
+ *
+ * @param[in,out]   messageQueue Module message queue object.
+ * @param[out]   message Module message object pointer.
+ * @param[in]   timeoutMs Longest wait in milliseconds.
+ * 
+ * @return      Result of execution.
+ * 
+ * @retval      0 Success
+ * @retval      -1 Failure
+ * @retval      -3 Message queue stayed empty (timeout)
+ */
+int removeModuleMessageTimed(ModuleMessageQueue_T *messageQueue, ModuleMessage_T* *message, const unsigned int timeoutMs);
+
 /**
  * @brief       Wrapper for 'recv()' with timeout option.
  * 
@@ -237,6 +286,69 @@ int removeModuleMessage(ModuleMessageQueue_T *messageQueue, ModuleMessage_T* *me
  */
 ssize_t recvTimeout(int sockfd, void *buf, size_t len, int flags, time_t sec, useconds_t usec);
 
+/**
+ * @brief       Encode module message to network format.
+ * 
+ * @details     Encodes the header (module address and message
+ *              code) and, for message codes carrying data, the
+ *              message data of the given module message into the
+ *              given buffer. Fields are 32 bit integers in host
+ *              byte order (64 bit times are two fields, high
+ *              half first).
+ *
+ * @param[in]   message Module message to be encoded.
+ * @param[out]  buffer Buffer of the encoded message.
+ * @param[in]   size Size of the buffer (at least NUM_NET_MSG_MAX_SIZE is always enough).
+ * 
+ * @return      Size of the encoded message in bytes, or -1 on failure.
+ */
+ssize_t encodeNetworkMessage(const ModuleMessage_T *message, uint8_t buffer[], const size_t size);
+
+/**
+ * @brief       Decode network message header.
+ * 
+ * @details     Decodes the module address and the message code
+ *              of an encoded network message. The values are not
+ *              validated.
+ *
+ * @param[in]   buffer Encoded message header.
+ * @param[in]   size Size of the buffer (at least NUM_NET_MSG_HEADER_SIZE).
+ * @param[out]  message Module message receiving the address and the code.
+ * 
+ * @return      Result of execution.
+ * 
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+int decodeNetworkMessageHeader(const uint8_t buffer[], const size_t size, ModuleMessage_T *message);
+
+/**
+ * @brief       Get size of network message data.
+ *
+ * @param[in]   code Module message code.
+ *
+ * @return      Size of the data following the header in bytes (zero if the code carries no data).
+ */
+size_t getNetworkMessageDataSize(const ModuleMessageCode_T code);
+
+/**
+ * @brief       Decode network message data.
+ * 
+ * @details     Decodes the data of an encoded network message
+ *              according to the message code already set in the
+ *              given module message.
+ *
+ * @param[in]   buffer Encoded message data (without header).
+ * @param[in]   size Size of the buffer (at least getNetworkMessageDataSize()).
+ * @param[in,out]   message Module message receiving the data.
+ * 
+ * @return      Result of execution.
+ * 
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+int decodeNetworkMessageData(const uint8_t buffer[], const size_t size, ModuleMessage_T *message);
+
 /**
  * @brief       Initialize network handler module.
  * 
@@ -0,0 +1,184 @@
+/**
+ * @file        frame_export_utils.h
+ * @author      Adam Csizy
+ * @date        2021-05-28
+ * @version     v1.1.0
+ *
+ * @brief       Shared memory frame export utilities
+ *
+ * @details     Publishes the frames of the streaming pipeline to other
+ *              on board processes (e.g. a tracker or a recorder)
+ *              through a POSIX shared memory ring per export point.
+ *              Consumers read the frames in place. The writer never
+ *              waits for a consumer: a consumer still reading a slot
+ *              the writer needs is dropped from the frame (see
+ *              FrameExportConsumer_T). The layout below is shared
+ *              with the consumers (see tools/frame_export_reader.c),
+ *              this header does not need GStreamer.
+ */
+
+#pragma once
+
+
+#include <stdatomic.h>
+#include <stdint.h>
+
+
+/* Frame export related public macro definitions */
+
+#define STR_FRAME_EXPORT_ENV_POINTS     "CC_FRAME_EXPORT"           /**< Environment variable of the exported points, e.g. "capture,encoded" (disabled if unset) */
+#define STR_FRAME_EXPORT_ENV_CONSUMERS  "CC_FRAME_EXPORT_CONSUMERS" /**< Environment variable of the number of consumers per point */
+#define STR_FRAME_EXPORT_ENV_SLOT_KB    "CC_FRAME_EXPORT_SLOT_KB"   /**< Environment variable of the slot size in KiB */
+#define STR_FRAME_EXPORT_SHM_CAPTURE    "/cc_frames_capture"        /**< Shared memory object of the capture point */
+#define STR_FRAME_EXPORT_SHM_ENCODED    "/cc_frames_encoded"        /**< Shared memory object of the encoded point */
+#define STR_FRAME_EXPORT_MAGIC          "CCFRMEXP"  /**< Area signature (8 bytes, not terminated) */
+#define NUM_FRAME_EXPORT_MAGIC_SIZE     8U          /**< Size of the area signature */
+#define NUM_FRAME_EXPORT_VERSION        1U          /**< Area layout version */
+#define NUM_FRAME_EXPORT_SLOTS          4U          /**< Number of frame slots (a consumer has three frame periods to read one) */
+#define NUM_FRAME_EXPORT_CONSUMERS      4U          /**< Default number of consumers per point */
+#define NUM_FRAME_EXPORT_CONSUMER_MAX   16U         /**< Maximum number of consumers per point */
+#define NUM_FRAME_EXPORT_SLOT_KB        4096U       /**< Default slot size in KiB (a 1080p I420 frame is 3038 KiB) */
+#define NUM_FRAME_EXPORT_SLOT_KB_MAX    65536U      /**< Maximum slot size in KiB */
+#define NUM_FRAME_EXPORT_CAPS_SIZE      1024U       /**< Size of the caps string including the terminator */
+#define NUM_FRAME_EXPORT_DATA_ALIGN     4096U       /**< Alignment of the slot data */
+#define NUM_FRAME_EXPORT_PTS_NONE       UINT64_MAX  /**< Presentation timestamp of a frame without one */
+#define NUM_FRAME_EXPORT_FLAG_DELTA     0x1U        /**< Frame flag: not a key frame (encoded point only) */
+
+
+/* Frame export related public type definitions */
+
+/**
+ * @brief   Enumeration of frame export points.
+ */
+typedef enum FrameExportPoint {
+
+    FRAME_EXPORT_CAPTURE        = 0,    /**< Output of the capture caps filter ("capture", RAW frames for RAW streams) */
+    FRAME_EXPORT_ENCODED        = 1,    /**< Input of the payloader ("encoded") */
+    FRAME_EXPORT_POINT_COUNT    = 2     /**< Number of export points */
+
+} FrameExportPoint_T;
+
+/**
+ * @brief   Enumeration of consumer entry states.
+ */
+typedef enum FrameExportConsumerState {
+
+    FRAME_CONSUMER_FREE     = 0,    /**< Entry not used */
+    FRAME_CONSUMER_ATTACHED = 1,    /**< Consumer attached */
+    FRAME_CONSUMER_DROPPED  = 2     /**< Slot of the consumer's frame overwritten during the read (set by the writer) */
+
+} FrameExportConsumerState_T;
+
+/**
+ * @brief   Consumer entry.
+ *
+ * @details A consumer claims a free entry by swapping its PID into
+ *          'pid' and then sets 'state' to attached. Before reading a
+ *          slot it stores the slot's sequence in 'reading' and checks
+ *          the slot's sequence again; after the read it issues an
+ *          acquire fence (atomic_thread_fence(memory_order_acquire):
+ *          the plain loads of the frame data must not move past the
+ *          check on weakly ordered CPUs like ARM), checks that the
+ *          slot's sequence is unchanged and its entry was not
+ *          dropped, then clears 'reading'. A dropped consumer sets
+ *          its state back to attached and continues with the newest
+ *          frame. Entries of exited consumers are freed by the writer.
+ */
+typedef struct FrameExportConsumer {
+
+    _Atomic int32_t pid;        /**< PID of the consumer (0 if free) */
+    _Atomic uint32_t state;     /**< State of the entry (FrameExportConsumerState_T) */
+    _Atomic uint64_t reading;   /**< Sequence of the frame being read (0 if none) */
+    _Atomic uint64_t drops;     /**< Number of frames the consumer was dropped from */
+
+} FrameExportConsumer_T;
+
+/**
+ * @brief   Frame slot.
+ *
+ * @details The slot holds a frame while 'sequence' is non-zero. The
+ *          writer clears it before overwriting the data and stores
+ *          the new frame's sequence after the data is written.
+ */
+typedef struct FrameExportSlot {
+
+    _Atomic uint64_t sequence;  /**< Sequence of the frame in the slot (0 while written) */
+    uint64_t pts;               /**< Presentation timestamp in nanoseconds (NUM_FRAME_EXPORT_PTS_NONE if unknown) */
+    uint32_t size;              /**< Size of the frame in bytes */
+    uint32_t flags;             /**< Frame flags (NUM_FRAME_EXPORT_FLAG_*) */
+
+} FrameExportSlot_T;
+
+/**
+ * @brief   Header of a frame export area.
+ *
+ * @details The data of slot i starts at 'dataOffset' + i * 'slotSize'
+ *          from the beginning of the area. The frame with sequence
+ *          s (counting from 1) is in slot (s % slotCount). 'futex'
+ *          is incremented and woken (FUTEX_WAKE, not private) after
+ *          every frame. 'caps' is written like a sequence lock: it is
+ *          valid while 'capsSequence' is even and unchanged.
+ */
+typedef struct FrameExportHeader {
+
+    char magic[NUM_FRAME_EXPORT_MAGIC_SIZE];    /**< Area signature (STR_FRAME_EXPORT_MAGIC) */
+    uint32_t version;                           /**< Layout version (NUM_FRAME_EXPORT_VERSION) */
+    uint32_t headerSize;                        /**< Size of this header */
+    uint32_t slotCount;                         /**< Number of frame slots */
+    uint32_t slotSize;                          /**< Size of a slot in bytes */
+    uint32_t consumerCount;                     /**< Number of usable consumer entries */
+    uint32_t dataOffset;                        /**< Offset of the first slot's data */
+    _Atomic int32_t writerPid;                  /**< PID of the streamer */
+    _Atomic uint32_t futex;                     /**< Frame counter to wait on */
+    _Atomic uint64_t sequence;                  /**< Sequence of the newest frame (0 if none) */
+    _Atomic uint64_t oversize;                  /**< Frames not exported for being larger than a slot */
+    _Atomic uint32_t capsSequence;              /**< Sequence lock of the caps string */
+    char caps[NUM_FRAME_EXPORT_CAPS_SIZE];      /**< Caps of the frames (GStreamer caps string) */
+    FrameExportConsumer_T consumers[NUM_FRAME_EXPORT_CONSUMER_MAX];    /**< Consumer entries */
+    FrameExportSlot_T slots[NUM_FRAME_EXPORT_SLOTS];                    /**< Frame slots */
+
+} FrameExportHeader_T;
+
+
+/* Frame export related public function declarations */
+
+struct _GstElement;
+
+/**
+ * @brief       Initialize frame export.
+ *
+ * @details     Creates the shared memory areas of the points listed
+ *              in CC_FRAME_EXPORT ("capture", "encoded", comma
+ *              separated) with CC_FRAME_EXPORT_CONSUMERS consumer
+ *              entries and CC_FRAME_EXPORT_SLOT_KB sized slots, and
+ *              starts their export threads. Areas of a previous
+ *              instance are replaced. Must be called before the
+ *              streaming module starts. Export stays disabled if
+ *              unset or on failure.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success (or disabled)
+ * @retval      -1 Failure
+ */
+int initFrameExport(void);
+
+/**
+ * @brief       Attach frame export.
+ *
+ * @details     Taps the capture caps filter's source pad and the
+ *              payloader's sink pad of a new pipeline. The streaming
+ *              threads only take a reference of the newest frame,
+ *              the export threads copy it into the shared memory
+ *              (a frame still waiting is replaced). No-op for points
+ *              not exported.
+ *
+ * @param[in]   capsfilter Capture caps filter (GstElement).
+ * @param[in]   payloader Payloader (GstElement).
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure (the stream is not affected)
+ */
+int attachFrameExport(struct _GstElement *capsfilter, struct _GstElement *payloader);
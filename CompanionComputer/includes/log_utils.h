@@ -11,13 +11,109 @@
 #pragma once
 
 
+#include <stdatomic.h>
+#include <stdint.h>
+
+
 /* Log related public macro definitions */
 
+#define NUM_LOG_LEVEL_ERR                       0       /**< Preprocessor value of LOG_SVRTY_ERR */
+#define NUM_LOG_LEVEL_WRN                       1       /**< Preprocessor value of LOG_SVRTY_WRN */
+#define NUM_LOG_LEVEL_INF                       2       /**< Preprocessor value of LOG_SVRTY_INF */
+#define NUM_LOG_LEVEL_DBG                       3       /**< Preprocessor value of LOG_SVRTY_DBG */
+
+#ifndef CC_LOG_COMPILE_LEVEL
+#define CC_LOG_COMPILE_LEVEL                    NUM_LOG_LEVEL_DBG /**< Log sites less severe than this level are compiled out (override with -DCC_LOG_COMPILE_LEVEL=<0..3>) */
+#endif
+
+#define NUM_LOG_RATE_BURST                      10U     /**< Default number of records a log site may emit per rate window */
+#define NUM_LOG_RATE_WINDOW_SEC                 60U     /**< Default length of the per-site rate window in seconds */
+
+#define STR_LOG_ENV_FILE                        "CC_LOG_FILE" /**< Environment variable naming an optional log file (appended) */
+#define STR_LOG_ENV_LEVEL                       "CC_LOG_LEVEL" /**< Environment variable of runtime log levels, e.g. "info" or "info,network=debug,netsink=warning" */
+
+/**
+ * @brief   Key/value field of a log format string.
+ *
+ * @details Appends " key=<conversion>" to a format string
+ *          literal at compile time (logfmt style), e.g.
+ *          LOG_MSG_WRN(LOG_MOD_NETWORK, "Send failed." LOG_KV("errno", "%d"), errno);
+ */
+#define LOG_KV(key, conversion)                 " " key "=" conversion
+
+#define LOG_SITE_INIT(burst, windowSec)         {__FILE__, __LINE__, (burst), (windowSec), 0, 0, 0} /**< Static initializer of a log site */
+
+/**
+ * @brief   Log site with a rate limit (backend of the gated macros below).
+ *
+ * @details Expands to a call of createLogRecord() with a static
+ *          per-site rate limiter. At most 'burst' records are
+ *          emitted per 'windowSec' seconds; the rest are counted
+ *          and reported as a single "N messages suppressed" record
+ *          once the site logs again in a later window. Not gated
+ *          by CC_LOG_COMPILE_LEVEL: log with LOG_MSG_RATE_<LEVEL>()
+ *          or LOG_MSG_<LEVEL>() instead.
+ */
+#define LOG_MSG_SITE(severity, module, burst, windowSec, ...) \
+    do { \
+        static LogSite_T logSite = LOG_SITE_INIT(burst, windowSec); \
+        createLogRecord(&logSite, (severity), (module), __VA_ARGS__); \
+    } while(0)
+
+/**
+ * @brief   Compiled-out log site.
+ *
+ * @details The arguments are not evaluated (keep side effects out
+ *          of them) but still type-checked against the format and
+ *          count as used, so a variable only logged does not warn.
+ */
+#define LOG_MSG_NONE(module, ...) \
+    do { \
+        if(0) { \
+            createLogRecord((LogSite_T*)(0), LOG_SVRTY_DBG, (module), __VA_ARGS__); \
+        } \
+    } while(0)
+
+#if CC_LOG_COMPILE_LEVEL >= NUM_LOG_LEVEL_ERR
+#define LOG_MSG_RATE_ERR(module, burst, windowSec, ...) LOG_MSG_SITE(LOG_SVRTY_ERR, module, burst, windowSec, __VA_ARGS__) /**< Log an error record with an explicit rate limit */
+#else
+#define LOG_MSG_RATE_ERR(module, burst, windowSec, ...) LOG_MSG_NONE(module, __VA_ARGS__)
+#endif
+
+#if CC_LOG_COMPILE_LEVEL >= NUM_LOG_LEVEL_WRN
+#define LOG_MSG_RATE_WRN(module, burst, windowSec, ...) LOG_MSG_SITE(LOG_SVRTY_WRN, module, burst, windowSec, __VA_ARGS__) /**< Log a warning record with an explicit rate limit */
+#else
+#define LOG_MSG_RATE_WRN(module, burst, windowSec, ...) LOG_MSG_NONE(module, __VA_ARGS__)
+#endif
+
+#if CC_LOG_COMPILE_LEVEL >= NUM_LOG_LEVEL_INF
+#define LOG_MSG_RATE_INF(module, burst, windowSec, ...) LOG_MSG_SITE(LOG_SVRTY_INF, module, burst, windowSec, __VA_ARGS__) /**< Log an information record with an explicit rate limit */
+#else
+#define LOG_MSG_RATE_INF(module, burst, windowSec, ...) LOG_MSG_NONE(module, __VA_ARGS__)
+#endif
+
+#if CC_LOG_COMPILE_LEVEL >= NUM_LOG_LEVEL_DBG
+#define LOG_MSG_RATE_DBG(module, burst, windowSec, ...) LOG_MSG_SITE(LOG_SVRTY_DBG, module, burst, windowSec, __VA_ARGS__) /**< Log a debug record with an explicit rate limit */
+#else
+#define LOG_MSG_RATE_DBG(module, burst, windowSec, ...) LOG_MSG_NONE(module, __VA_ARGS__)
+#endif
+
+#define LOG_MSG_ERR(module, ...)                LOG_MSG_RATE_ERR(module, NUM_LOG_RATE_BURST, NUM_LOG_RATE_WINDOW_SEC, __VA_ARGS__) /**< Log an error record */
+#define LOG_MSG_WRN(module, ...)                LOG_MSG_RATE_WRN(module, NUM_LOG_RATE_BURST, NUM_LOG_RATE_WINDOW_SEC, __VA_ARGS__) /**< Log a warning record */
+#define LOG_MSG_INF(module, ...)                LOG_MSG_RATE_INF(module, NUM_LOG_RATE_BURST, NUM_LOG_RATE_WINDOW_SEC, __VA_ARGS__) /**< Log an information record */
+#define LOG_MSG_DBG(module, ...)                LOG_MSG_RATE_DBG(module, NUM_LOG_RATE_BURST, NUM_LOG_RATE_WINDOW_SEC, __VA_ARGS__) /**< Log a debug record */
+
 #define STR_LOG_MSG_UNEXP_SVRTY_LVL             "createLogMessage(): Unexpected log message severity level."
+#define STR_LOG_MSG_LOG_FILE_OPEN_FAIL          "initLogModule(): Failed to open log file %s: %s"
+#define STR_LOG_MSG_LOG_THRD_START_FAIL         "initLogModule(): Failed to start log drainer thread. Logging synchronously."
+#define STR_LOG_MSG_LOG_RECORDS_DROPPED         "drainLogRings(): %llu log record(s) dropped on thread ring overflow."
+#define STR_LOG_MSG_LOG_SUPPRESSED              "%llu message(s) suppressed" LOG_KV("site", "%s:%d")
+#define STR_LOG_MSG_LOG_LEVEL_INVAL             "parseLogLevels(): Ignoring invalid log level specification: %s"
+#define STR_LOG_MSG_LOG_STATS                   "drainLogRings(): %llu records logged, %llu dropped, producer cost %.0f ns average, %llu ns maximum."
 #define STR_LOG_MSG_FUNC1_ARG_INVAL             "getCameraDevicePath(): Invalid input argument(s)."
 #define STR_LOG_MSG_FUNC1_OPEN_DIR_FAIL         "getCameraDevicePath(): Failed to open device directory."
-#define STR_LOG_MSG_FUNC1_OPEN_DEV_FAIL         "[WARNING] getCameraDevicePath(): Failed to open video device: %s.\n"
-#define STR_LOG_MSG_FUNC1_QUERY_CAP_FAIL        "[WARNING] getCameraDevicePath(): Failed to query video device capabilities. Device (%s) might not support V4L2 interface.\n"
+#define STR_LOG_MSG_FUNC1_OPEN_DEV_FAIL         "getCameraDevicePath(): Failed to open video device: %s."
+#define STR_LOG_MSG_FUNC1_QUERY_CAP_FAIL        "getCameraDevicePath(): Failed to query video device capabilities. Device (%s) might not support V4L2 interface."
 
 #define STR_LOG_MSG_FUNC2_ARG_INVAL             "stringToVideoCodingFormat(): Invalid input argument(s)."
 
@@ -26,8 +122,6 @@
 #define STR_LOG_MSG_FUNC4_OUT_OF_RANGE          "retrieveVideoCodingFormatCap(): Video coding format is out of range."
 
 #define STR_LOG_MSG_FUNC5_ARG_INVAL             "getCameraCapabilities(): Invalid input argument(s)."
-#define STR_LOG_MSG_FUNC5_CAPS_ANY              "getCameraCapabilities(): Camera device has ANY video coding format capabilities."
-#define STR_LOG_MSG_FUNC5_CAPS_EMPTY            "getCameraCapabilities(): Camera device has EMPTY set of video coding format capbilities."
 #define STR_LOG_MSG_FUNC5_SRCPAD_RTRV_FAIL      "getCameraCapabilities(): Failed to retrieve source pad of camera device pipeline element."
 #define STR_LOG_MSG_FUNC5_CAPS_RTRV_FAIL        "getCameraCapabilities(): Failed to retrieve capabilities of source pad."
 
@@ -37,6 +131,7 @@
 #define STR_LOG_MSG_FUNC7_MTX_ATTR_SET_TYPE_FAIL "initModuleMessageQueue(): Failed to set type of mutex attribute."
 #define STR_LOG_MSG_FUNC7_MTX_INIT_FAIL         "initModuleMessageQueue(): Failed to initialize mutex."
 #define STR_LOG_MSG_FUNC7_COND_ATTR_INIT_FAIL   "initModuleMessageQueue(): Failed to initialize conditional variable attribute."
+#define STR_LOG_MSG_FUNC7_COND_ATTR_SET_CLOCK_FAIL "initModuleMessageQueue(): Failed to set clock of conditional variable attribute."
 #define STR_LOG_MSG_FUNC7_COND_INIT_FAIL        "initModuleMessageQueue(): Failed to initialize conditional variable."
 
 #define STR_LOG_MSG_FUNC8_ARG_INVAL             "deinitModuleMessageQueue(): Invalid input argument(s)."
@@ -51,20 +146,22 @@
 
 #define STR_LOG_MSG_FUNC12_ARG_INVAL            "connectToGroundControl(): Invalid input argument(s)."
 #define STR_LOG_MSG_FUNC12_GC_ADDR_RESLV_FAIL   "connectToGroundControl(): Failed to resolve address of ground control."
-#define STR_LOG_MSG_FUNC12_GETADDRINFO_FAIL     "[ERROR] connectToGroundControl(): getaddrinfo(): %s\n"
+#define STR_LOG_MSG_FUNC12_GETADDRINFO_FAIL     "connectToGroundControl(): getaddrinfo(): %s"
 #define STR_LOG_MSG_FUNC12_GC_NOT_FOUND         "connectToGroundControl(): No ground control found with the given parameters."
 #define STR_LOG_MSG_FUNC12_CREAT_SOCK_FAIL      "connectToGroundControl(): Failed to create socket."
 #define STR_LOG_MSG_FUNC12_GC_CONN_FAIL         "connectToGroundControl(): Failed to estabilish connection with ground control."
+#define STR_LOG_MSG_FUNC12_MPTCP_FALLBACK       "connectToGroundControl(): Multipath TCP is not available, connecting with TCP."
+#define STR_LOG_MSG_FUNC12_SET_QOS_FAIL         "connectToGroundControl(): Failed to set control traffic class."
 #define STR_LOG_MSG_FUNC12_SET_KEEPALIVE_FAIL   "connectToGroundControl(): Failed to set keep alive on socket."
-#define STR_LOG_MSG_FUNC12_GC_CONN_SUCCESS      "[INFO] connectToGroundControl(): Successfully estabilished connection with ground control (%s:%s).\n"
+#define STR_LOG_MSG_FUNC12_GC_CONN_SUCCESS      "connectToGroundControl(): Successfully estabilished connection with ground control (%s:%s)."
 #define STR_LOG_MSG_FUNC12_LOGIN_SEND_FAIL      "connectToGroundControl(): Failed to send login message to ground control."
 #define STR_LOG_MSG_FUNC12_LOGIN_ACK_INVAL      "connectToGroundControl(): Invalid login message acknowledgement from ground control."
 #define STR_LOG_MSG_FUNC12_LOGIN_RECV_FAIL      "connectToGroundControl(): Failed to receive login message from ground control."
 
 #define STR_LOG_MSG_FUNC13_THRD_START_FAIL      "threadFuncNetworkIn(): Failed to start network output handler thread."
 #define STR_LOG_MSG_FUNC13_GC_CONN_CLOSED       "threadFuncNetworkIn(): Connection lost/closed to ground control."
-#define STR_LOG_MSG_FUNC13_CONN_FAIL_RETRY      "[WARNING] threadFuncNetworkIn(): Failed to connect to ground control. Retrying after %d seconds.\n"
-#define STR_LOG_MSG_FUNC13_RECONN_FAIL_RETRY    "[WARNING] threadFuncNetworkIn(): Failed to reconnect to ground control. Retrying after %d seconds.\n"
+#define STR_LOG_MSG_FUNC13_CONN_FAIL_RETRY      "threadFuncNetworkIn(): Failed to connect to ground control." LOG_KV("attempt", "%u") LOG_KV("retry_sec", "%u")
+#define STR_LOG_MSG_FUNC13_RECONN_FAIL_RETRY    "threadFuncNetworkIn(): Failed to reconnect to ground control." LOG_KV("attempt", "%u") LOG_KV("retry_sec", "%u")
 
 #define STR_LOG_MSG_FUNC14_MSG_RMV_FAIL         "threadFuncNetworkOut(): Failed to remove message from network module's message queue."
 
@@ -92,6 +189,8 @@
 #define STR_LOG_MSG_FUNC20_MSGQ_INIT_FAIL       "initStreamModule(): Failed to initialize streaming module's message queue."
 #define STR_LOG_MSG_FUNC20_THRD_CTRL_START_FAIL "initStreamModule(): Failed to start stream control thread."
 #define STR_LOG_MSG_FUNC20_GST_INIT_FAIL        "initStreamModule(): Failed to initialize GStreamer."
+#define STR_LOG_MSG_FUNC20_NETSINK_REG_FAIL     "initStreamModule(): Failed to register batched UDP network sink."
+#define STR_LOG_MSG_FUNC20_STALL_TIMEOUT_INVAL  "initStreamModule(): Invalid stall timeout %s, using the default." LOG_KV("timeout_ms", "%u")
 
 #define STR_LOG_MSG_FUNC21_MSG_RMV_FAIL         "threadFuncStreamControl(): Failed to remove message from streaming module's message queue."
 #define STR_LOG_MSG_FUNC21_CODE_INVAL           "threadFuncStreamControl(): Invalid module message code."
@@ -104,28 +203,31 @@
 #define STR_LOG_MSG_FUNC22_ARG_INVAL            "initCameraCapabilities(): Invalid input argument(s)."
 #define STR_LOG_MSG_FUNC22_CREAT_ELEM_FAIL      "initCameraCapabilities(): Failed to create pipeline element(s)."
 #define STR_LOG_MSG_FUNC22_PIPE_STATE_SET_FAIL  "initCameraCapabilities(): Failed to set pipeline state."
-#define STR_LOG_MSG_FUNC22_PIPE_ELEM_ERROR_MSG  "[ERROR] initCameraCapabilities(): Error received from element %s: %s.\n"
-#define STR_LOG_MSG_FUNC22_PIPE_ELEM_ERROR_DBG  "[ERROR] initCameraCapabilities(): Debugging information: %s.\n"
+#define STR_LOG_MSG_FUNC22_PIPE_ELEM_ERROR_MSG  "initCameraCapabilities(): Error received from element %s: %s."
+#define STR_LOG_MSG_FUNC22_PIPE_ELEM_ERROR_DBG  "initCameraCapabilities(): Debugging information: %s."
 #define STR_LOG_MSG_FUNC22_CAM_CAPS_GET_FAIL    "initCameraCapabilities(): Failed to get camera capabilities."
 #define STR_LOG_MSG_FUNC22_MSG_UNEXP            "initCameraCapabilities(): Unexpected message received."
 
 #define STR_LOG_MSG_FUNC30_ARG_INVAL            "pipeBuilder(): Invalid input argument(s)."
 #define STR_LOG_MSG_FUNC30_CREAT_ELEM_FAIL      "pipeBuilder(): Failed to create pipeline element(s)."
+#define STR_LOG_MSG_FUNC30_NETSINK_FALLBACK     "pipeBuilder(): Batched UDP network sink is not available. Using stock udpsink."
+#define STR_LOG_MSG_FUNC30_METER_ATTACH_FAIL    "pipeBuilder(): Failed to attach network sink meter."
+#define STR_LOG_MSG_FUNC30_MULTIPATH_UNAVAIL    "pipeBuilder(): Multipath sending needs the batched UDP network sink. Sending on a single path."
 #define STR_LOG_MSG_FUNC30_PIPE_LINK_FAIL       "pipeBuilder(): Failed to link pipeline elements."
 #define STR_LOG_MSG_FUNC30_PIPE_SET_INIT_FAIL   "pipeBuilder(): Failed to set pipeline to its initial state."
 #define STR_LOG_MSG_FUNC30_CODING_FMT_INVAL     "pipeBuilder(): Invalid video coding format."
-#define STR_LOG_MSG_FUNC30_PIPE_TYPE_INFO       "[INFO] pipeBuilder(): Constructed video streaming pipeline using %s camera output format.\n"
+#define STR_LOG_MSG_FUNC30_PIPE_TYPE_INFO       "pipeBuilder(): Constructed video streaming pipeline using %s camera output format."
 
 #define STR_LOG_MSG_FUNC31_ARG_INVAL            "pipelineErrorCallback(): Invalid input argument(s)."
-#define STR_LOG_MSG_FUNC31_PIPE_ELEM_ERROR_MSG  "[INFO] pipelineErrorCallback(): Error received from element %s: %s.\n"
-#define STR_LOG_MSG_FUNC31_PIPE_ELEM_ERROR_DBG  "[INFO] pipelineErrorCallback(): Debugging information: %s.\n"
+#define STR_LOG_MSG_FUNC31_PIPE_ELEM_ERROR_MSG  "pipelineErrorCallback(): Error received from element %s: %s."
+#define STR_LOG_MSG_FUNC31_PIPE_ELEM_ERROR_DBG  "pipelineErrorCallback(): Debugging information: %s."
 #define STR_LOG_MSG_FUNC31_MSG_ALLOC_FAIL       "pipelineErrorCallback(): Failed to allocate module message object."
 
 #define STR_LOG_MSG_FUNC32_PIPE_EOS             "pipelineEosCallback(): End of videostream (EOS) detected."
 #define STR_LOG_MSG_FUNC32_MSG_ALLOC_FAIL       "pipelineEosCallback(): Failed to allocate module message object."
 
 #define STR_LOG_MSG_FUNC33_ARG_INVAL            "pipelineStatechangedCallback(): Invalid input argument(s)."
-#define STR_LOG_MSG_FUNC33_PIPE_STATE_CHANGE    "[INFO] pipelineStatechangedCallback(): Pipeline state changed from %s to %s.\n"
+#define STR_LOG_MSG_FUNC33_PIPE_STATE_CHANGE    "pipelineStatechangedCallback(): Pipeline state changed from %s to %s."
 
 #define STR_LOG_MSG_FUNC34_ARG_INVAL            "registerCallbackFunctions(): Invalid input argument(s)."
 
@@ -146,11 +248,234 @@
 #define STR_LOG_MSG_FUNC39_SM_STATE_INCON       "streamStartHandler(): State machine might enter into an inconsistent state."
 
 #define STR_LOG_MSG_FUNC40_ARG_INVAL            "streamErrorHandler(): Invalid input argument(s)."
-#define STR_LOG_MSG_FUNC40_PIPE_SET_NULL_FAIL   "streamErrorHandler(): Failed to set pipeline to NULL state."
-#define STR_LOG_MSG_FUNC40_SM_STATE_INCON       "streamErrorHandler(): State machine might enter into an inconsistent state."
+#define STR_LOG_MSG_FUNC40_RECOVERY_START      "streamErrorHandler(): Video streaming pipeline released, recovery started." LOG_KV("format", "%d")
 
 #define STR_LOG_MSG_FUNC41_ARG_INVAL            "videoCodingFormatToString(): Invalid input argument(s)."
 
+#define STR_LOG_MSG_FUNC42_ELEM_REG_FAIL        "registerNetworkSink(): Failed to register batched UDP network sink element."
+
+#define STR_LOG_MSG_FUNC43_ARG_INVAL            "attachNetworkSinkMeter(): Invalid input argument(s)."
+#define STR_LOG_MSG_FUNC43_PAD_GET_FAIL         "attachNetworkSinkMeter(): Failed to get network sink element's sink pad."
+
+#define STR_LOG_MSG_FUNC44_GETADDRINFO_FAIL     "batchUdpSinkStart(): Failed to resolve %s: %s"
+#define STR_LOG_MSG_FUNC44_SOCK_CREAT_FAIL      "batchUdpSinkStart(): Failed to create UDP socket."
+#define STR_LOG_MSG_FUNC44_GSO_UNSUPPORTED      "batchUdpSinkStart(): UDP segmentation offload is not supported by the kernel. Using plain batched sending."
+#define STR_LOG_MSG_FUNC44_MPMODE_INVAL         "batchUdpSinkStart(): Invalid multipath mode." LOG_KV("mode", "%s")
+#define STR_LOG_MSG_FUNC44_MULTIPATH_INFO       "batchUdpSinkStart(): Multipath sending started." LOG_KV("mode", "%s") LOG_KV("paths", "%u")
+
+#define STR_LOG_MSG_FUNC45_STATS_INFO           "batchUdpSinkStop(): Sent %llu packets in %llu renders (%.1f packets/render, %.2f syscalls/render, %.1f us CPU/render, %llu GSO messages, %llu send errors)."
+#define STR_LOG_MSG_FUNC45_PATH_STATS_INFO      "batchUdpSinkStop(): Network path statistics." LOG_KV("path", "%s") LOG_KV("packets", "%llu") LOG_KV("bytes", "%llu") LOG_KV("errors", "%llu") LOG_KV("capacity_kbps", "%.0f")
+
+#define STR_LOG_MSG_FUNC46_BUF_MAP_FAIL         "batchUdpSinkRender(): Failed to map RTP packet buffer."
+
+#define STR_LOG_MSG_FUNC47_GSO_DISABLED         "sendPacketBatch(): UDP segmentation offload rejected (%s). Falling back to plain batched sending."
+
+#define STR_LOG_MSG_FUNC48_METER_BATCH_INFO     "networkSinkMeterProbe(): %.1f packets/frame, %.2f syscalls/frame, %.1f us CPU/frame over %llu frames."
+#define STR_LOG_MSG_FUNC48_METER_STOCK_INFO     "networkSinkMeterProbe(): %.1f packets/frame, %.1f us CPU/frame over %llu frames (stock sink)."
+
+#define STR_LOG_MSG_FUNC49_ARG_INVAL            "setSocketDscp(): Invalid input argument(s)."
+#define STR_LOG_MSG_FUNC49_SOCK_NAME_FAIL       "setSocketDscp(): Failed to get socket address family."
+#define STR_LOG_MSG_FUNC49_TOS_SET_FAIL         "setSocketDscp(): Failed to set socket option IP_TOS."
+#define STR_LOG_MSG_FUNC49_TCLASS_SET_FAIL      "setSocketDscp(): Failed to set socket option IPV6_TCLASS."
+
+#define STR_LOG_MSG_FUNC50_PRIO_SET_FAIL        "setSocketPriority(): Failed to set socket option SO_PRIORITY."
+
+#define STR_LOG_MSG_FUNC51_ARG_INVAL            "setSocketBufferSize(): Invalid input argument(s)."
+#define STR_LOG_MSG_FUNC51_BUF_SET_FAIL         "setSocketBufferSize(): Failed to set socket buffer size."
+#define STR_LOG_MSG_FUNC51_BUF_GET_FAIL         "setSocketBufferSize(): Failed to get socket buffer size."
+#define STR_LOG_MSG_FUNC51_BUF_CAPPED           "setSocketBufferSize(): Socket buffer size capped by the kernel. Raise net.core.wmem_max/rmem_max or run with CAP_NET_ADMIN."
+
+#define STR_LOG_MSG_FUNC52_OPEN_FAIL            "initFlightRecorder(): Failed to open flight recorder file %s: %s"
+#define STR_LOG_MSG_FUNC52_SIZE_FAIL            "initFlightRecorder(): Failed to size flight recorder file %s: %s"
+#define STR_LOG_MSG_FUNC52_MMAP_FAIL            "initFlightRecorder(): Failed to map flight recorder file %s: %s"
+#define STR_LOG_MSG_FUNC52_FILE_RESET           "initFlightRecorder(): Initialized flight recorder file %s."
+#define STR_LOG_MSG_FUNC52_FILE_RESUMED         "initFlightRecorder(): Continuing flight recorder file %s" LOG_KV("events", "%llu") LOG_KV("session", "%u")
+
+#define STR_LOG_MSG_FUNC53_SIGACTION_FAIL       "initTraceModule(): Failed to install trace file signal handlers."
+#define STR_LOG_MSG_FUNC53_TRACE_ENABLED        "initTraceModule(): Tracing enabled. Trace file %s is written at exit and on SIGUSR1."
+
+#define STR_LOG_MSG_FUNC54_ARG_INVAL            "parseCameraCapabilities(): Invalid input argument(s)."
+#define STR_LOG_MSG_FUNC54_CAPS_ANY             "parseCameraCapabilities(): Camera device has ANY video coding format capabilities."
+#define STR_LOG_MSG_FUNC54_CAPS_EMPTY           "parseCameraCapabilities(): Camera device has EMPTY set of video coding format capbilities."
+
+#define STR_LOG_MSG_FUNC55_ARG_INVAL            "getVideoSourceConfig(): Invalid input argument(s)."
+#define STR_LOG_MSG_FUNC55_SPEC_INVAL           "getVideoSourceConfig(): Invalid video source specification: %s"
+#define STR_LOG_MSG_FUNC55_SOURCE_INFO          "getVideoSourceConfig(): Using video source" LOG_KV("type", "%s") LOG_KV("format", "%s") LOG_KV("size", "%dx%d") LOG_KV("fps", "%d") LOG_KV("path", "%s") LOG_KV("latency_stamp", "%d") LOG_KV("frame_limit", "%d")
+#define STR_LOG_MSG_FUNC55_STAMP_IGNORED        "getVideoSourceConfig(): Latency stamp needs a test source of at least %dx%d, ignored."
+
+#define STR_LOG_MSG_FUNC56_ARG_INVAL            "createVideoSource(): Invalid input argument(s)."
+#define STR_LOG_MSG_FUNC56_CREAT_ELEM_FAIL      "createVideoSource(): Failed to create video source element(s)."
+#define STR_LOG_MSG_FUNC56_LINK_FAIL            "createVideoSource(): Failed to link video source elements."
+#define STR_LOG_MSG_FUNC56_GHOST_PAD_FAIL       "createVideoSource(): Failed to add source ghost pad."
+
+#define STR_LOG_MSG_FUNC57_ARG_INVAL            "getVideoSourceCapabilities(): Invalid input argument(s)."
+#define STR_LOG_MSG_FUNC57_CAPS_CREAT_FAIL      "getVideoSourceCapabilities(): Failed to create video source capabilities."
+
+#define STR_LOG_MSG_FUNC58_ENC_NOT_FOUND        "createH264Encoder(): No H.264 encoder is available."
+#define STR_LOG_MSG_FUNC58_ENC_SELECTED         "createH264Encoder(): Using H.264 encoder" LOG_KV("encoder", "%s")
+
+#define STR_LOG_MSG_FUNC59_SIGNAL_ADD_FAIL      "initPipelineProfiler(): Failed to add SIGUSR2 source. Dumps are available on ground control command only."
+#define STR_LOG_MSG_FUNC59_PROFILER_ENABLED     "initPipelineProfiler(): Pipeline profiling enabled. Profiles are written to %s on SIGUSR2 and on ground control command."
+
+#define STR_LOG_MSG_FUNC60_ITERATE_FAIL         "attachPipelineProfiler(): Failed to profile every pipeline element."
+
+#define STR_LOG_MSG_FUNC61_FILE_OPEN_FAIL       "writePipelineProfile(): Failed to open profile file %s."
+#define STR_LOG_MSG_FUNC61_FILE_WRITE_FAIL      "writePipelineProfile(): Failed to write profile file %s."
+#define STR_LOG_MSG_FUNC61_PROFILE_WRITTEN      "writePipelineProfile(): Profile written to %s" LOG_KV("bottleneck", "%s") LOG_KV("share_pct", "%.1f")
+
+#define STR_LOG_MSG_FUNC62_ARG_INVAL            "runStartupTasks(): Invalid input argument(s)."
+#define STR_LOG_MSG_FUNC62_THRD_START_FAIL      "runStartupTasks(): Failed to start startup task thread." LOG_KV("task", "%s")
+#define STR_LOG_MSG_FUNC62_TASK_DONE            "runStartupTasks(): Startup task done." LOG_KV("task", "%s") LOG_KV("start_ms", "%.1f") LOG_KV("duration_ms", "%.1f")
+#define STR_LOG_MSG_FUNC62_TASK_FAIL            "runStartupTasks(): Startup task failed." LOG_KV("task", "%s") LOG_KV("duration_ms", "%.1f")
+#define STR_LOG_MSG_FUNC62_TASK_SKIPPED         "runStartupTasks(): Startup task skipped (dependency failed or cyclic)." LOG_KV("task", "%s")
+
+#define STR_LOG_MSG_FUNC63_MILESTONE            "markStartupMilestone(): Startup milestone reached." LOG_KV("milestone", "%s") LOG_KV("elapsed_ms", "%.1f")
+
+#define STR_LOG_MSG_FUNC64_CANDIDATE_FAIL       "buildPipelineCandidates(): Failed to start pipeline candidate thread, building in place." LOG_KV("format", "%d")
+#define STR_LOG_MSG_FUNC64_CANDIDATES_BUILT     "buildPipelineCandidates(): Pipeline candidates built." LOG_KV("built", "%d") LOG_KV("candidates", "%d") LOG_KV("selected_format", "%d")
+
+#define STR_LOG_MSG_FUNC65_STATIC               "initPluginRegistry(): Static GStreamer build, plugin registry disabled."
+#define STR_LOG_MSG_FUNC65_DIR_INVAL            "initPluginRegistry(): Pinned plugin directory %s is not a directory. Using the system plugins."
+#define STR_LOG_MSG_FUNC65_PINNED               "initPluginRegistry(): Using pinned plugin registry %s without rescanning."
+#define STR_LOG_MSG_FUNC65_REGISTRY_MISSING     "initPluginRegistry(): Pinned plugin registry %s is missing. Scanning the pinned plugins once."
+
+#define STR_LOG_MSG_FUNC66_ELEM_MISSING         "checkRequiredPlugins(): Required element is missing (stale pinned plugins?)." LOG_KV("element", "%s")
+#define STR_LOG_MSG_FUNC66_ELEM_UNAVAILABLE     "checkRequiredPlugins(): Optional element is not available." LOG_KV("element", "%s")
+
+#define STR_LOG_MSG_FUNC67_MSG_ALLOC_FAIL       "threadFuncRecoveryTimer(): Failed to allocate module message. Pipeline recovery stalled."
+#define STR_LOG_MSG_FUNC67_THRD_START_FAIL      "scheduleRecoveryAttempt(): Failed to start recovery timer thread, waiting in place."
+
+#define STR_LOG_MSG_FUNC68_ATTEMPT              "recoverPipeline(): Recovering video streaming pipeline." LOG_KV("attempt", "%u") LOG_KV("format", "%d") LOG_KV("spare", "%d")
+#define STR_LOG_MSG_FUNC68_ATTEMPT_FAIL         "recoverPipeline(): Recovery attempt failed." LOG_KV("attempt", "%u") LOG_KV("format", "%d")
+#define STR_LOG_MSG_FUNC68_LOWER_MODE           "recoverPipeline(): Falling back to a lower H.264 encoder." LOG_KV("encoder", "%s")
+#define STR_LOG_MSG_FUNC68_RECOVERED            "recoverPipeline(): Video streaming pipeline recovered." LOG_KV("format", "%d") LOG_KV("attempts", "%u") LOG_KV("recovery_ms", "%.1f")
+
+#define STR_LOG_MSG_FUNC69_SPARE_BUILT          "buildSparePipeline(): Warm spare pipeline ready." LOG_KV("format", "%d")
+#define STR_LOG_MSG_FUNC69_SPARE_FAIL           "buildSparePipeline(): Failed to build warm spare pipeline." LOG_KV("format", "%d")
+
+#define STR_LOG_MSG_FUNC70_ARG_INVAL            "streamRecoveryHandler(): Invalid input argument(s)."
+
+#define STR_LOG_MSG_FUNC71_ARG_INVAL            "streamResumeHandler(): Invalid input argument(s)."
+#define STR_LOG_MSG_FUNC71_PIPE_SET_PLAY_FAIL   "streamResumeHandler(): Failed to set recovered pipeline to playing state."
+#define STR_LOG_MSG_FUNC71_MSG_ALLOC_FAIL       "streamResumeHandler(): Failed to allocate module message."
+#define STR_LOG_MSG_FUNC71_RESUMED              "streamResumeHandler(): Video stream resumed." LOG_KV("format", "%d") LOG_KV("outage_ms", "%.1f")
+
+#define STR_LOG_MSG_FUNC72_ARG_INVAL            "initStallWatchdog(): Invalid input argument(s)."
+
+#define STR_LOG_MSG_FUNC73_ARG_INVAL            "addStallWatch(): Invalid input argument(s)."
+#define STR_LOG_MSG_FUNC73_PAD_NOT_FOUND        "addStallWatch(): Watched pad not found." LOG_KV("watch", "%s") LOG_KV("element", "%s") LOG_KV("pad", "%s")
+#define STR_LOG_MSG_FUNC73_WATCHES_FULL         "addStallWatch(): No free stall watch." LOG_KV("watch", "%s")
+#define STR_LOG_MSG_FUNC73_WATCH_ADDED          "addStallWatch(): Stall watch added." LOG_KV("watch", "%s") LOG_KV("element", "%s") LOG_KV("pad", "%s") LOG_KV("threshold_ms", "%u")
+
+#define STR_LOG_MSG_FUNC74_STALLED              "stallCheckCallback(): Pipeline stalled without error." LOG_KV("watch", "%s") LOG_KV("stalled_ms", "%u")
+
+#define STR_LOG_MSG_FUNC75_MSG_ALLOC_FAIL       "pipelineStallCallback(): Failed to allocate module message."
+
+#define STR_LOG_MSG_FUNC76_WATCH_FAIL           "attachStallWatches(): Failed to watch pipeline, stalls go undetected." LOG_KV("watch", "%s")
+
+#define STR_LOG_MSG_FUNC77_SPEC_TOO_LONG        "initThreadScheduling(): Scheduling specification too long, default scheduling used." LOG_KV("max_length", "%u")
+#define STR_LOG_MSG_FUNC77_ENTRY_INVAL          "initThreadScheduling(): Invalid scheduling entry ignored." LOG_KV("entry", "%s")
+#define STR_LOG_MSG_FUNC77_ENABLED              "initThreadScheduling(): Thread scheduling enabled." LOG_KV("spec", "%s")
+
+#define STR_LOG_MSG_FUNC78_ARG_INVAL            "applyThreadScheduling(): Invalid input argument(s)."
+#define STR_LOG_MSG_FUNC78_POLICY_FAIL          "applyThreadScheduling(): Failed to set scheduling policy." LOG_KV("class", "%s") LOG_KV("error", "%s")
+#define STR_LOG_MSG_FUNC78_NICE_FAIL            "applyThreadScheduling(): Failed to set nice value." LOG_KV("class", "%s") LOG_KV("error", "%s")
+#define STR_LOG_MSG_FUNC78_AFFINITY_FAIL        "applyThreadScheduling(): Failed to set CPU affinity." LOG_KV("class", "%s") LOG_KV("error", "%s")
+#define STR_LOG_MSG_FUNC78_APPLIED              "applyThreadScheduling(): Thread scheduling applied." LOG_KV("class", "%s") LOG_KV("tid", "%d")
+
+#define STR_LOG_MSG_FUNC79_RATE_INVAL           "initTelemetryModule(): Invalid telemetry rate %s, using the default." LOG_KV("rate_hz", "%u")
+#define STR_LOG_MSG_FUNC79_DISABLED             "initTelemetryModule(): Telemetry disabled."
+#define STR_LOG_MSG_FUNC79_PATH_INVAL           "initTelemetryModule(): Telemetry socket path too long, telemetry disabled." LOG_KV("path", "%s")
+#define STR_LOG_MSG_FUNC79_SOCK_FAIL            "initTelemetryModule(): Failed to open telemetry socket, telemetry disabled." LOG_KV("path", "%s") LOG_KV("error", "%s")
+#define STR_LOG_MSG_FUNC79_THRD_START_FAIL      "initTelemetryModule(): Failed to start telemetry producer thread, telemetry disabled."
+#define STR_LOG_MSG_FUNC79_ENABLED              "initTelemetryModule(): Telemetry enabled." LOG_KV("path", "%s") LOG_KV("rate_hz", "%u")
+
+#define STR_LOG_MSG_FUNC80_ARG_INVAL            "publishTelemetry(): Invalid input argument(s)."
+
+#define STR_LOG_MSG_FUNC81_RECV_FAIL            "threadFuncTelemetryProducer(): Failed to receive telemetry sample." LOG_KV("error", "%s")
+#define STR_LOG_MSG_FUNC81_SAMPLE_INVAL         "threadFuncTelemetryProducer(): Invalid telemetry sample ignored." LOG_KV("sample", "%s")
+
+#define STR_LOG_MSG_FUNC82_REPLACED             "takeTelemetrySample(): Unsent telemetry samples replaced by newer ones." LOG_KV("channel", "%s") LOG_KV("replaced", "%llu")
+
+#define STR_LOG_MSG_FUNC83_ARG_INVAL            "removeModuleMessageTimed(): Invalid input argument(s)."
+
+#define STR_LOG_MSG_FUNC84_SEND_FAIL            "threadFuncNetworkOut(): Failed to send telemetry sample." LOG_KV("channel", "%s")
+#define STR_LOG_MSG_FUNC84_SNAPSHOT_SEND_FAIL   "threadFuncNetworkOut(): Failed to send snapshot data." LOG_KV("id", "%u") LOG_KV("offset", "%u")
+#define STR_LOG_MSG_FUNC84_CLOCK_SEND_FAIL      "threadFuncNetworkOut(): Failed to send clock request."
+#define STR_LOG_MSG_FUNC84_MAPPING_SEND_FAIL    "threadFuncNetworkOut(): Failed to send RTP clock mapping."
+
+#define STR_LOG_MSG_FUNC85_ARG_INVAL            "attachSnapshotBranch(): Invalid input argument(s)."
+#define STR_LOG_MSG_FUNC85_CREAT_ELEM_FAIL      "attachSnapshotBranch(): Failed to create snapshot branch elements, snapshots disabled."
+#define STR_LOG_MSG_FUNC85_LINK_FAIL            "attachSnapshotBranch(): Failed to link snapshot branch, snapshots disabled."
+
+#define STR_LOG_MSG_FUNC86_BUSY                 "requestSnapshot(): Previous snapshot still in progress." LOG_KV("id", "%u")
+#define STR_LOG_MSG_FUNC86_UNAVAILABLE          "requestSnapshot(): Snapshot unavailable." LOG_KV("id", "%u") LOG_KV("reason", "%s")
+#define STR_LOG_MSG_FUNC86_REQUESTED            "requestSnapshot(): Snapshot requested." LOG_KV("id", "%u")
+
+#define STR_LOG_MSG_FUNC87_MAP_FAIL             "snapshotHandoffCallback(): Failed to map snapshot buffer."
+#define STR_LOG_MSG_FUNC87_ALLOC_FAIL           "snapshotHandoffCallback(): Failed to store snapshot image."
+#define STR_LOG_MSG_FUNC87_CAPTURED             "snapshotHandoffCallback(): Snapshot captured." LOG_KV("id", "%u") LOG_KV("bytes", "%u") LOG_KV("capture_ms", "%u")
+
+#define STR_LOG_MSG_FUNC88_WRITE_FAIL           "saveSnapshot(): Failed to save snapshot on board." LOG_KV("path", "%s") LOG_KV("error", "%s")
+
+#define STR_LOG_MSG_FUNC89_MSG_ALLOC_FAIL       "announceSnapshot(): Failed to allocate module message object."
+
+#define STR_LOG_MSG_FUNC90_POINT_INVAL          "initFrameExport(): Unknown frame export point ignored." LOG_KV("point", "%.*s")
+#define STR_LOG_MSG_FUNC90_THREAD_FAIL          "initFrameExport(): Failed to start export thread, point not exported." LOG_KV("point", "%s")
+#define STR_LOG_MSG_FUNC90_EXPORTING            "initFrameExport(): Exporting frames." LOG_KV("point", "%s") LOG_KV("shm", "%s") LOG_KV("consumers", "%u") LOG_KV("slot_kb", "%u")
+
+#define STR_LOG_MSG_FUNC91_ARG_INVAL            "attachFrameExport(): Invalid input argument(s)."
+#define STR_LOG_MSG_FUNC91_PAD_FAIL             "attachFrameExport(): Failed to get pad of export point." LOG_KV("point", "%s")
+
+#define STR_LOG_MSG_FUNC92_SETTING_INVAL        "getExportSetting(): Invalid frame export setting, using default." LOG_KV("variable", "%s") LOG_KV("value", "%s") LOG_KV("default", "%lu")
+
+#define STR_LOG_MSG_FUNC93_AREA_FAIL            "createExportArea(): Failed to create frame export area, point not exported." LOG_KV("shm", "%s") LOG_KV("error", "%s")
+
+#define STR_LOG_MSG_FUNC94_REPLACED             "threadFuncFrameExport(): Frames replaced before being exported." LOG_KV("point", "%s") LOG_KV("replaced", "%llu")
+#define STR_LOG_MSG_FUNC94_MAP_FAIL             "threadFuncFrameExport(): Failed to map frame." LOG_KV("point", "%s")
+#define STR_LOG_MSG_FUNC94_OVERSIZE             "threadFuncFrameExport(): Frame larger than a slot not exported (raise CC_FRAME_EXPORT_SLOT_KB)." LOG_KV("point", "%s") LOG_KV("bytes", "%u") LOG_KV("slot_bytes", "%u")
+
+#define STR_LOG_MSG_FUNC95_OBJECTIVE_INVAL      "initFormatRanking(): Invalid format ranking objective, enum order kept." LOG_KV("objective", "%s")
+#define STR_LOG_MSG_FUNC95_SECONDS_INVAL        "initFormatRanking(): Invalid calibration time, using default." LOG_KV("value", "%s") LOG_KV("default", "%u")
+#define STR_LOG_MSG_FUNC95_CALIBRATING          "initFormatRanking(): Calibrating video coding formats." LOG_KV("cache", "%s") LOG_KV("seconds", "%u")
+#define STR_LOG_MSG_FUNC95_CACHED               "initFormatRanking(): Using cached format calibration." LOG_KV("cache", "%s")
+#define STR_LOG_MSG_FUNC95_RESULT               "initFormatRanking(): Format calibration result." LOG_KV("format", "%s") LOG_KV("encoder", "%s") LOG_KV("status", "%d") LOG_KV("fps", "%.1f") LOG_KV("nominal_fps", "%.1f") LOG_KV("cpu_percent", "%.1f") LOG_KV("bits_per_frame", "%.0f") LOG_KV("latency_ms", "%.2f")
+
+#define STR_LOG_MSG_FUNC96_BUILD_FAIL           "measureFormat(): Failed to build calibration pipeline." LOG_KV("format", "%s") LOG_KV("encoder", "%d")
+#define STR_LOG_MSG_FUNC96_PLAY_FAIL            "measureFormat(): Failed to play calibration pipeline." LOG_KV("format", "%s") LOG_KV("encoder", "%d")
+#define STR_LOG_MSG_FUNC96_PIPE_FAIL            "measureFormat(): Calibration pipeline failed." LOG_KV("format", "%s") LOG_KV("encoder", "%d")
+
+#define STR_LOG_MSG_FUNC97_STALE                "loadCalibration(): Cached format calibration of another setup ignored." LOG_KV("cache", "%s")
+#define STR_LOG_MSG_FUNC97_LINE_INVAL           "loadCalibration(): Damaged format calibration cache ignored." LOG_KV("cache", "%s")
+
+#define STR_LOG_MSG_FUNC98_WRITE_FAIL           "saveCalibration(): Failed to save format calibration." LOG_KV("cache", "%s") LOG_KV("error", "%s")
+
+#define STR_LOG_MSG_FUNC99_RANKED               "rankFormats(): Video coding formats ranked." LOG_KV("objective", "%s") LOG_KV("ranking", "%s")
+
+#define STR_LOG_MSG_FUNC100_PATH_COUNT_INVAL    "parseNetworkPaths(): Number of network paths out of range." LOG_KV("max", "%u")
+#define STR_LOG_MSG_FUNC100_PATH_INVAL          "parseNetworkPaths(): Invalid network path." LOG_KV("path", "%s")
+#define STR_LOG_MSG_FUNC100_RESOLVE_FAIL        "parseNetworkPaths(): Failed to resolve network path destination." LOG_KV("path", "%s") LOG_KV("host", "%s") LOG_KV("error", "%s")
+#define STR_LOG_MSG_FUNC100_PATH_INFO           "parseNetworkPaths(): Network path configured." LOG_KV("path", "%s") LOG_KV("host", "%s") LOG_KV("port", "%d") LOG_KV("state", "%s")
+
+#define STR_LOG_MSG_FUNC101_OPEN_FAIL           "openNetworkPath(): Failed to open network path." LOG_KV("path", "%s") LOG_KV("error", "%s")
+#define STR_LOG_MSG_FUNC101_GSO_UNSUPPORTED     "openNetworkPath(): UDP segmentation offload is not supported on a network path. Using plain batched sending."
+
+#define STR_LOG_MSG_FUNC102_PATH_RETRY          "updateNetworkPaths(): Retrying network path." LOG_KV("path", "%s")
+
+#define STR_LOG_MSG_FUNC103_PATH_DOWN           "takeNetworkPathDown(): Network path down, failing over to the other paths." LOG_KV("path", "%s") LOG_KV("error", "%s")
+
+#define STR_LOG_MSG_FUNC104_INTERVAL_INVAL      "initClockSync(): Invalid clock exchange interval %s, using the default." LOG_KV("interval_ms", "%u")
+#define STR_LOG_MSG_FUNC104_DISABLED            "initClockSync(): Clock synchronization disabled."
+
+#define STR_LOG_MSG_FUNC105_SYNCHRONIZED        "processClockResponse(): Clock synchronized to the ground control." LOG_KV("offset_ms", "%.3f") LOG_KV("delay_ms", "%.3f") LOG_KV("uncertainty_us", "%u")
+#define STR_LOG_MSG_FUNC105_STEP                "processClockResponse(): Ground control clock stepped, synchronizing again." LOG_KV("step_ms", "%.3f")
+
+#define STR_LOG_MSG_FUNC106_ARG_INVAL           "attachClockMapping(): Invalid input argument(s)."
+#define STR_LOG_MSG_FUNC106_PAD_FAIL            "attachClockMapping(): Failed to get payloader source pad, RTP timestamps not mapped."
+
+#define STR_LOG_MSG_FUNC107_CODE_INVAL          "networkToClockMessage(): Invalid module message code."
+#define STR_LOG_MSG_FUNC107_DATA_RECV_FAIL      "networkToClockMessage(): Failed to receive clock response."
+
 #define STR_LOG_MSG_MAIN_PROG_STARTUP           "main(): Streamer program launched!"
 #define STR_LOG_MSG_MAIN_MOD_NET_INIT_FAIL      "main(): Failed to initialize and start network module."
 #define STR_LOG_MSG_MAIN_MOD_STRM_INIT_FAIL     "main(): Failed to initialize and start streaming module."
@@ -170,6 +495,59 @@ typedef enum LogSeverity {
 
 } LogSeverity_T;
 
+/**
+ * @brief   Enumeration of log modules.
+ *
+ * @details Each module has its own runtime log level. Records
+ *          of the legacy createLogMessage() interface belong to
+ *          LOG_MOD_GENERAL.
+ */
+typedef enum LogModule {
+
+    LOG_MOD_GENERAL =   0,  /**< Uncategorized records and the main module */
+    LOG_MOD_NETWORK =   1,  /**< Ground control connection (com_utils) */
+    LOG_MOD_STREAM  =   2,  /**< Streaming state machine and pipeline (stream_utils) */
+    LOG_MOD_CAMERA  =   3,  /**< Camera discovery (camera_utils) */
+    LOG_MOD_NETSINK =   4,  /**< Batched UDP network sink (netsink_utils) */
+    LOG_MOD_QOS     =   5,  /**< Traffic classes and socket buffers (qos_utils) */
+    LOG_MOD_COUNT   =   6   /**< Number of log modules */
+
+} LogModule_T;
+
+/**
+ * @brief   Log call site.
+ *
+ * @details Static state of a single LOG_MSG_* call site used
+ *          for rate limiting. Shared by every thread passing
+ *          the site; updated with atomic operations only.
+ */
+typedef struct LogSite {
+
+    const char *file;                   /**< Source file of the site */
+    int line;                           /**< Source line of the site */
+    uint32_t burst;                     /**< Records allowed per window */
+    uint32_t windowSec;                 /**< Window length in seconds */
+    _Atomic uint64_t windowStart;       /**< Start of the current window (monotonic seconds + 1, 0 if unused) */
+    _Atomic uint32_t count;             /**< Records passed in the current window */
+    _Atomic uint64_t suppressed;        /**< Records suppressed since the last summary */
+
+} LogSite_T;
+
+/**
+ * @brief   Log statistics.
+ *
+ * @details Producer-side cost is the time spent inside the log
+ *          functions by the calling (possibly hot) thread.
+ */
+typedef struct LogStatistics {
+
+    uint64_t produced;          /**< Number of records written into thread rings */
+    uint64_t dropped;           /**< Number of records dropped on ring overflow */
+    uint64_t producerNsTotal;   /**< Total producer-side cost in nanoseconds */
+    uint64_t producerNsMax;     /**< Maximum producer-side cost of a single record in nanoseconds */
+
+} LogStatistics_T;
+
 
 /* Log related public function declarations */
 
@@ -179,11 +557,116 @@ typedef enum LogSeverity {
  * @details     Generates a log entry in the system log
  *              and prints the log message on the standard
  *              output with the given severity level if
- *              debug mode is enabled.
+ *              debug mode is enabled. The entry is queued
+ *              and written asynchronously (see
+ *              createLogMessageFormat()).
  * 
  * @note        None
  * 
  * @param[in]   message Log message.
  * @param[in]   severity Log severity level.
  */
-void createLogMessage(const char message[], const LogSeverity_T severity);
\ No newline at end of file
+void createLogMessage(const char message[], const LogSeverity_T severity);
+
+/**
+ * @brief       Create formatted log message.
+ *
+ * @details     Formats the message directly into the calling
+ *              thread's log ring and returns without any system
+ *              call. The record is written to the system log (and
+ *              to the standard output in debug mode, and to the
+ *              file named by STR_LOG_ENV_FILE if set) by the log
+ *              drainer thread. If the ring is full the record is
+ *              dropped and counted instead of blocking the caller.
+ *
+ * @param[in]   severity Log severity level.
+ * @param[in]   format printf-style format string.
+ */
+void createLogMessageFormat(const LogSeverity_T severity, const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+/**
+ * @brief       Create log record.
+ *
+ * @details     Backend of the LOG_MSG_* macros. Returns without
+ *              formatting if the severity is below the runtime level
+ *              of the module or the call site exceeded its rate
+ *              limit. The module name is prepended to the message.
+ *
+ * @param[in,out]   site Call site state (see LOG_MSG_SITE()).
+ * @param[in]   severity Log severity level.
+ * @param[in]   module Log module.
+ * @param[in]   format printf-style format string (see LOG_KV()).
+ */
+void createLogRecord(LogSite_T *site, const LogSeverity_T severity, const LogModule_T module, const char *format, ...) __attribute__((format(printf, 4, 5)));
+
+/**
+ * @brief       Set log level of a module.
+ *
+ * @details     Records less severe than 'severity' are discarded
+ *              by the producer before formatting. Levels above
+ *              CC_LOG_COMPILE_LEVEL have no effect on LOG_MSG_*
+ *              sites which were compiled out.
+ *
+ * @param[in]   module Log module or LOG_MOD_COUNT for all modules.
+ * @param[in]   severity Least severe level to emit.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+int setLogLevel(const LogModule_T module, const LogSeverity_T severity);
+
+/**
+ * @brief       Check log level of a module.
+ *
+ * @param[in]   module Log module.
+ * @param[in]   severity Log severity level.
+ *
+ * @return      Non-zero if records of the given severity are emitted.
+ */
+int isLogLevelEnabled(const LogModule_T module, const LogSeverity_T severity);
+
+/**
+ * @brief       Initialize log module.
+ *
+ * @details     Applies the runtime log levels given in the
+ *              environment variable STR_LOG_ENV_LEVEL (default
+ *              "info", "debug" in debug mode), opens the optional
+ *              log file and starts the log drainer thread. Until this function succeeds log
+ *              messages are written synchronously by the caller.
+ *              Pending records are flushed on exit().
+ *
+ * @note        The connection to the system logger should be
+ *              opened with 'openlog()' before invoking this function.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure (logging stays synchronous)
+ */
+int initLogModule(void);
+
+/**
+ * @brief       Flush log messages.
+ *
+ * @details     Writes every pending record of every thread ring
+ *              on the calling thread. Intended for paths which
+ *              terminate the process with a signal (e.g. SIGTERM)
+ *              where the drainer thread gets no chance to run.
+ */
+void flushLogMessages(void);
+
+/**
+ * @brief       Get log statistics.
+ *
+ * @details     Sums the producer-side counters of all thread rings.
+ *
+ * @param[out]  stats Log statistics.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+int getLogStatistics(LogStatistics_T *stats);
\ No newline at end of file
@@ -0,0 +1,124 @@
+/**
+ * @file        netsink_utils.h
+ * @author      Adam Csizy
+ * @date        2021-05-02
+ * @version     v1.1.0
+ *
+ * @brief       Batched UDP network sink utilities
+ */
+
+#pragma once
+
+
+#include <gst/gst.h>
+
+
+/* Network sink related public macro definitions */
+
+#define STR_NETSINK_FACTORY_NAME    "batchudpsink"  /**< Factory name of the batched UDP network sink element */
+#define STR_NETSINK_STOCK_NAME      "udpsink"       /**< Factory name of the stock GStreamer UDP network sink element */
+#define STR_NETSINK_MULTIPATH_REDUNDANT "redundant" /**< Multipath mode sending every packet on every path */
+#define STR_NETSINK_MULTIPATH_BONDING   "bonding"   /**< Multipath mode splitting the packets by path capacity */
+
+
+/* Network sink related public type definitions */
+
+/**
+ * @brief       Network sink statistics.
+ *
+ * @details     Counters collected by the batched UDP network
+ *              sink element while it is started. The counters
+ *              are reset on each NULL/READY -> PAUSED transition
+ *              and reported on the way back.
+ */
+typedef struct NetworkSinkStatistics {
+
+    guint64 buffers;        /**< Number of render calls with a single buffer */
+    guint64 bufferLists;    /**< Number of render calls with a buffer list */
+    guint64 packets;        /**< Number of RTP packets handed to the kernel */
+    guint64 bytes;          /**< Number of payload bytes handed to the kernel */
+    guint64 syscalls;       /**< Number of send system calls */
+    guint64 gsoMessages;    /**< Number of messages sent with UDP segmentation offload */
+    guint64 sendErrors;     /**< Number of failed send system calls */
+    guint64 cpuTimeNs;      /**< Thread CPU time spent in the send path (nanoseconds) */
+
+} NetworkSinkStatistics_T;
+
+
+/* Network sink related public function declarations */
+
+/**
+ * @brief       Register batched UDP network sink.
+ *
+ * @details     Registers the batched UDP network sink element
+ *              as a static element under the factory name
+ *              STR_NETSINK_FACTORY_NAME. The element accepts the
+ *              same 'host', 'port', 'qos-dscp' and 'buffer-size'
+ *              properties as the stock 'udpsink' (plus 'priority'
+ *              for SO_PRIORITY) and sends each buffer list pushed by a
+ *              RTP payloader with 'sendmmsg()'. Where the kernel
+ *              supports UDP segmentation offload (UDP_SEGMENT)
+ *              consecutive equal-sized packets are coalesced into
+ *              a single message, so a whole frame normally leaves
+ *              in one or two system calls.
+ *
+ *              With the 'paths' property set (up to four comma
+ *              separated "<local address|interface>[@<host>[:<port>]]"
+ *              entries) the element sends over one socket per path
+ *              instead: 'multipath-mode' "redundant" sends every
+ *              packet on every path (the receiver drops duplicates by
+ *              RTP sequence number), "bonding" splits each batch over
+ *              the paths by their capacity estimated from the send
+ *              queues. A path never blocks the others: a full or
+ *              failing path hands its packets to the other paths
+ *              within the same render call and is retried later.
+ *
+ * @note        GStreamer core must be initialized using 'gst_init()'
+ *              before invoking this function.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+int registerNetworkSink(void);
+
+/**
+ * @brief       Get network sink statistics.
+ *
+ * @details     Copies the statistics of the given batched UDP
+ *              network sink element into 'stats'.
+ *
+ * @param[in]   networkSink Batched UDP network sink element.
+ * @param[out]  stats Network sink statistics.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure (e.g. element is not a batched sink)
+ */
+int getNetworkSinkStatistics(GstElement *networkSink, NetworkSinkStatistics_T *stats);
+
+/**
+ * @brief       Attach network sink meter.
+ *
+ * @details     Installs a pad probe on the sink pad of the given
+ *              network sink element which counts video frames
+ *              (RTP packets with the marker bit set) and the CPU
+ *              time consumed by the streaming thread between them.
+ *              Every NUM_NETSINK_METER_REPORT_FRAMES frames packets,
+ *              send system calls (batched sink only) and CPU time
+ *              per frame are logged. The meter works with both the
+ *              batched and the stock 'udpsink' element, so the two
+ *              can be compared on the same camera and pipeline. The
+ *              stock element does not expose its system call count;
+ *              measure it with 'strace -c -f -e trace=network'.
+ *
+ * @param[in,out]   networkSink Network sink element.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+int attachNetworkSinkMeter(GstElement *networkSink);
@@ -0,0 +1,65 @@
+/**
+ * @file        plugin_utils.h
+ * @author      Adam Csizy
+ * @date        2021-05-21
+ * @version     v1.1.0
+ *
+ * @brief       GStreamer plugin loading utilities
+ */
+
+#pragma once
+
+
+/* Plugin related public macro definitions */
+
+#define STR_PLUGIN_ENV_DIR              "CC_GST_PLUGIN_DIR" /**< Environment variable naming a pinned plugin directory (see tools/pin_gst_plugins.py) */
+#define STR_PLUGIN_REGISTRY_FILE        "registry.bin"      /**< Registry file of a pinned plugin directory */
+
+
+/* Plugin related public function declarations */
+
+/**
+ * @brief       Initialize plugin registry.
+ *
+ * @details     Must be called before 'gst_init()'. Configures
+ *              GStreamer through the environment so that it does
+ *              not scan the system plugin directories on startup:
+ *
+ *              - Static build (CC_GST_STATIC, linked against
+ *                gstreamer-full): the required elements are linked
+ *                into the program and the registry is disabled.
+ *              - Pinned plugin directory: only the plugins of the
+ *                directory (symbolic links to the required ones)
+ *                are loaded and the registry is read from the
+ *                directory's STR_PLUGIN_REGISTRY_FILE without
+ *                checking the plugins for updates. A missing
+ *                registry is written on the first start.
+ *
+ *              Otherwise GStreamer's defaults are left alone.
+ *
+ * @param[in]   directory Pinned plugin directory (NULL or empty: none).
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success (or nothing to do)
+ * @retval      -1 Failure (GStreamer's defaults are used)
+ */
+int initPluginRegistry(const char *directory);
+
+/**
+ * @brief       Check required plugins.
+ *
+ * @details     Looks up the element factories the streaming
+ *              pipelines may use and logs the missing ones, so a
+ *              stale pinned plugin directory or static build is
+ *              reported on startup instead of as a failed pipeline
+ *              build. Some of the elements have fallbacks (e.g.
+ *              the H.264 encoders), so missing elements are not
+ *              fatal.
+ *
+ * @note        GStreamer must be initialized before invoking this
+ *              function.
+ *
+ * @return      Number of missing elements.
+ */
+int checkRequiredPlugins(void);
@@ -0,0 +1,140 @@
+/**
+ * @file        recorder_utils.h
+ * @author      Adam Csizy
+ * @date        2021-05-08
+ * @version     v1.1.0
+ *
+ * @brief       Flight recorder utilities
+ */
+
+#pragma once
+
+
+#include <stdatomic.h>
+#include <stdint.h>
+
+
+/* Flight recorder related public macro definitions */
+
+#define STR_RECORDER_ENV_FILE           "CC_RECORDER_FILE"  /**< Environment variable overriding the flight recorder file path */
+#define STR_RECORDER_FILE_DEFAULT       "/var/tmp/DroneVideoStreamer.rec" /**< Default flight recorder file path */
+#define STR_RECORDER_MAGIC              "CCFLTREC"  /**< File signature (8 bytes, not terminated in the file) */
+#define NUM_RECORDER_MAGIC_SIZE         8U          /**< Size of the file signature */
+#define NUM_RECORDER_VERSION            1U          /**< File format version */
+#define NUM_RECORDER_CAPACITY           8192U       /**< Number of event slots (1 MiB file) */
+#define NUM_RECORDER_TEXT_SIZE          88U         /**< Size of the event text including the terminator */
+
+
+/* Flight recorder related public type definitions */
+
+/**
+ * @brief   Enumeration of flight recorder event types.
+ */
+typedef enum FlightEventType {
+
+    REC_EVT_SESSION     = 1,    /**< Recorder opened by a process (arg0: PID) */
+    REC_EVT_STATE       = 2,    /**< Stream state machine transition (code: event, arg0: old state, arg1: new state) */
+    REC_EVT_MSG_IN      = 3,    /**< Protocol message received (code: message code, arg0: module) */
+    REC_EVT_MSG_OUT     = 4,    /**< Protocol message sent (code: message code, arg0: module) */
+    REC_EVT_BUS         = 5,    /**< Pipeline bus message (code: FlightBusCode_T, arg0/arg1: GstState on state change, text: source) */
+    REC_EVT_LOG         = 6     /**< Error or warning log record (code: LogSeverity_T, arg0: LogModule_T, text: message) */
+
+} FlightEventType_T;
+
+/**
+ * @brief   Enumeration of recorded pipeline bus messages.
+ */
+typedef enum FlightBusCode {
+
+    REC_BUS_ERROR           = 1,    /**< GST_MESSAGE_ERROR */
+    REC_BUS_EOS             = 2,    /**< GST_MESSAGE_EOS */
+    REC_BUS_STATE_CHANGED   = 3,    /**< GST_MESSAGE_STATE_CHANGED of the pipeline */
+    REC_BUS_STALL           = 4     /**< Pipeline stalled without bus message (arg0: stalled milliseconds, text: watch, see watchdog_utils.h) */
+
+} FlightBusCode_T;
+
+/**
+ * @brief   Flight recorder event slot (128 bytes).
+ *
+ * @details A slot is valid when 'sequence' is non-zero and
+ *          (sequence - 1) % capacity equals the slot index. The
+ *          writer clears 'sequence' before filling the slot and
+ *          publishes it last, so a slot torn by a crash is skipped
+ *          by the decoder.
+ */
+typedef struct FlightEvent {
+
+    _Atomic uint64_t sequence;          /**< Global event index + 1 (0 while being written) */
+    uint64_t timestampNs;               /**< Wall clock time (CLOCK_REALTIME) */
+    uint64_t monotonicNs;               /**< Monotonic time (CLOCK_MONOTONIC) */
+    uint16_t type;                      /**< FlightEventType_T */
+    uint16_t code;                      /**< Type specific code */
+    uint32_t threadId;                  /**< Kernel thread identifier of the writer */
+    int32_t arg0;                       /**< Type specific argument */
+    int32_t arg1;                       /**< Type specific argument */
+    char text[NUM_RECORDER_TEXT_SIZE];  /**< Type specific text (terminated) */
+
+} FlightEvent_T;
+
+/**
+ * @brief   Flight recorder file header (64 bytes).
+ *
+ * @details The header is followed by 'capacity' event slots.
+ */
+typedef struct FlightRecorderHeader {
+
+    char magic[NUM_RECORDER_MAGIC_SIZE];    /**< STR_RECORDER_MAGIC */
+    uint32_t version;                       /**< NUM_RECORDER_VERSION */
+    uint32_t eventSize;                     /**< sizeof(FlightEvent_T) */
+    uint32_t capacity;                      /**< Number of event slots */
+    uint32_t sessions;                      /**< Number of processes which opened the file */
+    _Atomic uint64_t nextIndex;             /**< Index of the next event to be written */
+    uint8_t reserved[32];                   /**< Reserved (zero) */
+
+} FlightRecorderHeader_T;
+
+
+/* Flight recorder related public function declarations */
+
+/**
+ * @brief       Initialize flight recorder.
+ *
+ * @details     Maps the flight recorder file (STR_RECORDER_ENV_FILE
+ *              or STR_RECORDER_FILE_DEFAULT) with MAP_SHARED. Events
+ *              written into the mapping live in the kernel page cache
+ *              and reach the file even if the process crashes. A file
+ *              with matching geometry is continued, otherwise it is
+ *              reinitialized. A REC_EVT_SESSION event marks the start.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure (events are discarded)
+ */
+int initFlightRecorder(void);
+
+/**
+ * @brief       Record flight event.
+ *
+ * @details     Appends an event to the circular log without locks:
+ *              the slot is claimed with an atomic fetch-and-add on
+ *              the shared index and published with a release store
+ *              of its sequence number. Safe to call from any thread
+ *              and a no-op before initFlightRecorder() succeeds.
+ *
+ * @param[in]   type Event type.
+ * @param[in]   code Type specific code.
+ * @param[in]   arg0 Type specific argument.
+ * @param[in]   arg1 Type specific argument.
+ * @param[in]   text Type specific text (truncated) or NULL.
+ */
+void recordFlightEvent(const FlightEventType_T type, const uint16_t code, const int32_t arg0, const int32_t arg1, const char *text);
+
+/**
+ * @brief       Synchronize flight recorder.
+ *
+ * @details     Schedules write-back of the mapping to the file.
+ *              Not required for crash survival (the page cache
+ *              outlives the process) but limits loss on power cut.
+ */
+void syncFlightRecorder(void);
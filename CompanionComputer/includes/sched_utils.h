@@ -0,0 +1,114 @@
+/**
+ * @file        sched_utils.h
+ * @author      Adam Csizy
+ * @date        2021-05-25
+ * @version     v1.1.0
+ *
+ * @brief       Thread scheduling and CPU affinity utilities
+ */
+
+#pragma once
+
+
+#include <gst/gst.h>
+
+
+/* Scheduling related public macro definitions */
+
+#define STR_SCHED_ENV_SPEC              "CC_SCHED"  /**< Environment variable of the thread scheduling specification (see initThreadScheduling()) */
+
+
+/* Scheduling related public type definitions */
+
+/**
+ * @brief   Enumeration of thread scheduling classes.
+ */
+typedef enum SchedClass {
+
+    SCHED_CLASS_CAPTURE     = 0,    /**< Streaming threads of the video source ("capture") */
+    SCHED_CLASS_ENCODE      = 1,    /**< Streaming threads of the converter and encoder ("encode") */
+    SCHED_CLASS_SEND        = 2,    /**< Streaming threads of the payloader and network sink ("send") */
+    SCHED_CLASS_CONTROL     = 3,    /**< Stream control thread ("control") */
+    SCHED_CLASS_NETWORK     = 4,    /**< Ground control connection threads ("network") */
+    SCHED_CLASS_MAIN_LOOP   = 5,    /**< GLib main loop thread of the pipeline events ("mainloop") */
+    SCHED_CLASS_LOG         = 6,    /**< Log drainer thread ("log") */
+    SCHED_CLASS_COUNT       = 7     /**< Number of scheduling classes */
+
+} SchedClass_T;
+
+
+/* Scheduling related public function declarations */
+
+/**
+ * @brief       Initialize thread scheduling.
+ *
+ * @details     Parses the scheduling specification: whitespace
+ *              separated entries of the form
+ *
+ *                  <class>=[<policy>[:<priority>]][@<cpus>]
+ *
+ *              where the class is one of "capture", "encode", "send",
+ *              "control", "network", "mainloop" and "log", the policy
+ *              one of "other", "batch", "idle", "fifo" and "rr", the
+ *              priority the real-time priority of "fifo" and "rr"
+ *              (1..99) or the nice value of "other" and "batch"
+ *              (-20..19) and the CPUs a list like "2" or "0-1,3",
+ *              e.g. "capture=fifo:50@2 send=fifo:50@2 log=idle@0".
+ *              Classes without an entry keep the default scheduling.
+ *              Invalid entries are logged and ignored. Real-time
+ *              policies and negative nice values need CAP_SYS_NICE
+ *              (or RLIMIT_RTPRIO/RLIMIT_NICE). Must be called before
+ *              the application's threads are started.
+ *
+ * @param[in]   spec Scheduling specification (NULL or empty: default scheduling).
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success (every entry valid)
+ * @retval      -1 Failure (invalid entries ignored)
+ */
+int initThreadScheduling(const char *spec);
+
+/**
+ * @brief       Apply thread scheduling.
+ *
+ * @details     Sets the policy, priority and CPU affinity of the
+ *              calling thread according to its class. Failures are
+ *              logged, the thread keeps running with its previous
+ *              scheduling. No-op for classes without an entry.
+ *
+ * @param[in]   threadClass Scheduling class of the calling thread.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success (or nothing to apply)
+ * @retval      -1 Failure
+ */
+int applyThreadScheduling(const SchedClass_T threadClass);
+
+/**
+ * @brief       Set pipeline stage of an element.
+ *
+ * @details     Tags an element (or bin) with the scheduling class of
+ *              the streaming threads it starts. Threads of untagged
+ *              elements take the class of the nearest tagged parent
+ *              bin, or keep the default scheduling.
+ *
+ * @param[in,out]   element Pipeline element.
+ * @param[in]   stage Scheduling class of the element's streaming threads.
+ */
+void setPipelineStage(GstElement *element, const SchedClass_T stage);
+
+/**
+ * @brief       Attach thread scheduling to a pipeline.
+ *
+ * @details     Installs a synchronous bus handler applying the class
+ *              of the owning pipeline stage to every streaming thread
+ *              entering its task (GST_STREAM_STATUS_TYPE_ENTER, handled
+ *              in the streaming thread itself) and restoring the
+ *              default scheduling when it leaves (task pool threads
+ *              are reused). No-op without a scheduling specification.
+ *
+ * @param[in]   pipeline GStreamer pipeline.
+ */
+void attachPipelineScheduling(GstElement *pipeline);
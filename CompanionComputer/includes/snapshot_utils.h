@@ -0,0 +1,123 @@
+/**
+ * @file        snapshot_utils.h
+ * @author      Adam Csizy
+ * @date        2021-05-27
+ * @version     v1.1.0
+ *
+ * @brief       Still snapshot utilities
+ */
+
+#pragma once
+
+
+#include <gst/gst.h>
+#include <stdint.h>
+
+#include "camera_utils.h"
+
+
+/* Snapshot related public macro definitions */
+
+#define STR_SNAPSHOT_ENV_DIR            "CC_SNAPSHOT_DIR"   /**< Environment variable of the on board snapshot directory (not saved if unset) */
+#define STR_PIPE_ELEM_NAME_SNAPTEE      "Snapshot_Tee"      /**< Name of the tee splitting the capture output */
+#define NUM_SNAPSHOT_CHUNK_SIZE         8192U   /**< Maximum size of a snapshot data chunk on the control link in bytes */
+#define NUM_SNAPSHOT_CAPTURE_TIMEOUT_MS 2000U   /**< A capture without a frame for longer is abandoned by the next request */
+#define NUM_SNAPSHOT_SEND_WAIT_MS       5U      /**< Longest wait of the sender for a congested link while a snapshot is pending */
+
+
+/* Snapshot related public type definitions */
+
+/**
+ * @brief   Struct of a snapshot result.
+ *
+ * @details Reported to the ground control when a snapshot is
+ *          captured (its data follows in chunks) or failed.
+ */
+typedef struct SnapshotInfo {
+
+    uint32_t id;        /**< Snapshot ID (counts from 1) */
+    uint32_t size;      /**< Size of the JPEG image in bytes */
+    int32_t status;     /**< 0 on success, -1 on failure (no data follows) */
+
+} SnapshotInfo_T;
+
+
+/* Snapshot related public function declarations */
+
+/**
+ * @brief       Check snapshot support of a coding format.
+ *
+ * @details     RAW frames are encoded to JPEG, JPEG frames of the
+ *              camera are passed through. Inter-coded formats would
+ *              need a decoder and a key frame.
+ *
+ * @param[in]   codingFormat Video coding format of the camera output.
+ *
+ * @return      Non-zero if supported.
+ */
+int isSnapshotSupported(const VideoCodingFormat_T codingFormat);
+
+/**
+ * @brief       Attach snapshot branch.
+ *
+ * @details     Links a closed valve, a leaky single buffer queue, a
+ *              JPEG encoder (RAW only) and a sink to the tee after
+ *              the capture. The live branch keeps the capture
+ *              thread, the valve passes nothing until a snapshot is
+ *              requested. Must be called before the pipeline leaves
+ *              the NULL state.
+ *
+ * @param[in]   pipeline GStreamer pipeline.
+ * @param[in]   tee Tee of the capture output (in the pipeline).
+ * @param[in]   codingFormat Video coding format of the camera output.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure (the tee feeds the live branch only)
+ */
+int attachSnapshotBranch(GstElement *pipeline, GstElement *tee, const VideoCodingFormat_T codingFormat);
+
+/**
+ * @brief       Request snapshot.
+ *
+ * @details     Opens the valve of the playing pipeline for exactly
+ *              one frame. The JPEG image is saved on board (if
+ *              CC_SNAPSHOT_DIR is set) and reported to the ground
+ *              control. One snapshot is taken at a time. Failures
+ *              are reported to the ground control as well.
+ *
+ * @param[in]   pipeline GStreamer pipeline (may be NULL).
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+int requestSnapshot(GstElement *pipeline);
+
+/**
+ * @brief       Check pending snapshot data.
+ *
+ * @return      Non-zero if snapshot data is waiting to be sent.
+ */
+int isSnapshotPending(void);
+
+/**
+ * @brief       Take snapshot data chunk to be sent.
+ *
+ * @details     Takes the next chunk of the captured snapshot.
+ *              Called by the network output thread when the link
+ *              is idle. Thread-safe.
+ *
+ * @param[out]  id Snapshot ID.
+ * @param[out]  offset Offset of the chunk in the image.
+ * @param[out]  data Chunk data (NUM_SNAPSHOT_CHUNK_SIZE bytes).
+ * @param[out]  length Length of the chunk.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Chunk taken
+ * @retval      1 No snapshot data pending
+ */
+int takeSnapshotChunk(uint32_t *id, uint32_t *offset, uint8_t data[NUM_SNAPSHOT_CHUNK_SIZE], uint32_t *length);
@@ -0,0 +1,101 @@
+/**
+ * @file        startup_utils.h
+ * @author      Adam Csizy
+ * @date        2021-05-20
+ * @version     v1.1.0
+ *
+ * @brief       Startup task graph and startup milestone utilities
+ */
+
+#pragma once
+
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+/* Startup related public macro definitions */
+
+#define NUM_STARTUP_TASK_MAX            32U     /**< Maximum number of tasks of a startup task graph (one dependency bit each) */
+#define STARTUP_TASK_BIT(index)         (UINT32_C(1) << (index))    /**< Dependency mask bit of a startup task index */
+
+
+/* Startup related public type definitions */
+
+/**
+ * @brief   Startup task function.
+ *
+ * @param[in,out]   arg Task argument.
+ *
+ * @return      0 on success, -1 on failure (dependent tasks are skipped).
+ */
+typedef int (*StartupTaskFunc_T)(void *arg);
+
+/**
+ * @brief   Struct of a startup task (node of a startup task graph).
+ */
+typedef struct StartupTask {
+
+    const char *name;               /**< Task name (logged) */
+    StartupTaskFunc_T function;     /**< Task function */
+    void *argument;                 /**< Task argument */
+    uint32_t dependencies;          /**< Tasks which must succeed before this task starts (STARTUP_TASK_BIT() of their indexes) */
+
+} StartupTask_T;
+
+/**
+ * @brief   Enumeration of startup milestones.
+ */
+typedef enum StartupMilestone {
+
+    STARTUP_MILESTONE_CONNECTED     = 0,    /**< First login to the ground control succeeded */
+    STARTUP_MILESTONE_READY         = 1,    /**< Streaming pipeline built and waiting for the stream start */
+    STARTUP_MILESTONE_FIRST_PACKET  = 2,    /**< First RTP packet handed to the network sink */
+    STARTUP_MILESTONE_COUNT         = 3     /**< Number of startup milestones */
+
+} StartupMilestone_T;
+
+
+/* Startup related public function declarations */
+
+/**
+ * @brief       Initialize startup clock.
+ *
+ * @details     Takes the reference time of the startup milestones.
+ *              Should be called first thing in 'main()'. Milestones
+ *              marked before this call are measured from the first
+ *              milestone.
+ */
+void initStartupClock(void);
+
+/**
+ * @brief       Mark startup milestone.
+ *
+ * @details     Logs the time elapsed since initStartupClock() the
+ *              first time a milestone is reached. Later calls
+ *              (e.g. on reconnection or pipeline rebuild) are
+ *              ignored. Thread-safe and cheap enough for a pad probe.
+ *
+ * @param[in]   milestone Startup milestone.
+ */
+void markStartupMilestone(const StartupMilestone_T milestone);
+
+/**
+ * @brief       Run startup task graph.
+ *
+ * @details     Starts every task on its own thread as soon as all
+ *              of its dependencies succeeded, so independent tasks
+ *              run concurrently. Tasks whose dependencies failed (or
+ *              form a cycle) are skipped. Returns when every task
+ *              finished or was skipped. The start offset and the
+ *              duration of each task is logged.
+ *
+ * @param[in]   tasks Startup tasks (dependencies refer to indexes of this array).
+ * @param[in]   count Number of startup tasks (at most NUM_STARTUP_TASK_MAX).
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success (every task succeeded)
+ * @retval      -1 Failure (a task failed or was skipped)
+ */
+int runStartupTasks(const StartupTask_T tasks[], const size_t count);
@@ -13,6 +13,27 @@
 #include "com_utils.h"
 
 
+/* Streaming related public macro definitions */
+
+#define STR_STREAM_ENV_DEST_ADDR    "CC_STREAM_DEST_ADDR"   /**< Environment variable overriding the RTP stream destination address */
+#define STR_STREAM_ENV_STALL_TIMEOUT "CC_STALL_TIMEOUT_MS"  /**< Environment variable overriding the pipeline stall threshold in milliseconds (default 3000, 0: watchdog disabled, see watchdog_utils.h) */
+#define STR_STREAM_ENV_MULTIPATH    "CC_MULTIPATH_PATHS"    /**< Environment variable of the multipath paths (see registerNetworkSink(), also enables Multipath TCP on the control link) */
+#define STR_STREAM_ENV_MULTIPATH_MODE "CC_MULTIPATH_MODE"   /**< Environment variable of the multipath mode ("redundant" or "bonding") */
+
+/*
+ * Multipath streaming: CC_MULTIPATH_PATHS=<local address|interface>[@<host>[:<port>]][,...]
+ * (up to 4, e.g. "wlan0,wwan0" or "192.168.1.10,10.64.0.2@10.8.0.1") streams over several
+ * networks at once, CC_MULTIPATH_MODE=redundant (default, every packet on every path) or
+ * bonding (packets split by the measured path capacity, see registerNetworkSink()); run the
+ * ground control with -m (redundant) or -M <REORDER_MS> (bonding). The control link becomes a Multipath TCP connection that survives
+ * a path loss without reconnecting: give the kernel the subflow endpoints, e.g.
+ * "sysctl net.mptcp.enabled=1; ip mptcp limits set subflows 4; ip mptcp endpoint add
+ * 10.64.0.2 dev wwan0 subflow". Interface paths need CAP_NET_RAW, address paths need a
+ * source routing rule per network ("ip rule add from <address> table <N>"). Test on one
+ * host with loopback aliases ("make loopback-run MULTIPATH=bonding") or veth pairs.
+ */
+
+
 /* Streaming related global variable declarations */
 
 extern ModuleMessageQueue_T streamMsgq;     /**< Module message queue of the video streaming module */
@@ -0,0 +1,117 @@
+/**
+ * @file        telemetry_utils.h
+ * @author      Adam Csizy
+ * @date        2021-05-26
+ * @version     v1.1.0
+ *
+ * @brief       Flight telemetry utilities
+ */
+
+#pragma once
+
+
+#include <stdint.h>
+
+
+/* Telemetry related public macro definitions */
+
+#define STR_TELEMETRY_ENV_SOCKET        "CC_TELEMETRY_SOCKET"   /**< Environment variable of the producer socket path */
+#define STR_TELEMETRY_ENV_RATE          "CC_TELEMETRY_RATE_HZ"  /**< Environment variable of the per channel send rate (0 disables telemetry) */
+#define STR_TELEMETRY_SOCKET_DEFAULT    "/tmp/cc_telemetry.sock" /**< Default path of the producer socket */
+#define NUM_TELEMETRY_RATE_HZ           5U      /**< Default send rate of a channel in samples per second */
+#define NUM_TELEMETRY_IDLE_WAIT_MS      50U     /**< Longest wait of the sender for a new sample */
+#define NUM_TELEMETRY_VALUES            3U      /**< Number of values in a telemetry sample */
+
+
+/* Telemetry related public type definitions */
+
+/**
+ * @brief   Enumeration of telemetry channels.
+ *
+ * @details The meaning of the sample values per channel. Values are
+ *          integers in the given units, unused values are zero.
+ */
+typedef enum TelemetryChannel {
+
+    TLM_CHAN_POSITION   = 0,    /**< Latitude and longitude (1e-7 degrees), altitude (mm) ("position") */
+    TLM_CHAN_BATTERY    = 1,    /**< Voltage (mV), current (mA), remaining capacity (%) ("battery") */
+    TLM_CHAN_LINK       = 2,    /**< RSSI (dBm), link quality (%), noise (dBm) ("link") */
+    TLM_CHAN_COUNT      = 3     /**< Number of telemetry channels */
+
+} TelemetryChannel_T;
+
+/**
+ * @brief   Struct of a telemetry sample.
+ */
+typedef struct TelemetrySample {
+
+    TelemetryChannel_T channel;             /**< Telemetry channel */
+    uint32_t ageMs;                         /**< Time from publishing to sending in milliseconds */
+    int32_t values[NUM_TELEMETRY_VALUES];   /**< Sample values (see TelemetryChannel_T) */
+
+} TelemetrySample_T;
+
+
+/* Telemetry related public function declarations */
+
+/**
+ * @brief       Initialize telemetry module.
+ *
+ * @details     Opens the local producer socket (Unix datagram
+ *              socket at CC_TELEMETRY_SOCKET) and starts its reader
+ *              thread. Producers send one sample per datagram as
+ *              text: "<channel> <value> [<value> [<value>]]", e.g.
+ *              "battery 11800 -2300 76". Must be called before the
+ *              network module starts. Telemetry stays disabled on
+ *              failure or with a zero CC_TELEMETRY_RATE_HZ.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success (or disabled)
+ * @retval      -1 Failure
+ */
+int initTelemetryModule(void);
+
+/**
+ * @brief       Publish telemetry sample.
+ *
+ * @details     Stores the latest sample of a channel: an unsent
+ *              older sample of the channel is replaced. Thread-safe.
+ *
+ * @param[in]   channel Telemetry channel.
+ * @param[in]   values Sample values (see TelemetryChannel_T).
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+int publishTelemetry(const TelemetryChannel_T channel, const int32_t values[NUM_TELEMETRY_VALUES]);
+
+/**
+ * @brief       Take telemetry sample to be sent.
+ *
+ * @details     Takes the next pending sample whose channel is due
+ *              according to the send rate (channels take turns).
+ *              Called by the network output thread when no control
+ *              message is waiting. Thread-safe.
+ *
+ * @param[out]  sample Sample to be sent.
+ * @param[out]  delayMs Time until the next sample may be due (retval 1).
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Sample taken
+ * @retval      1 No sample due
+ * @retval      -1 Telemetry disabled
+ */
+int takeTelemetrySample(TelemetrySample_T *sample, unsigned int *delayMs);
+
+/**
+ * @brief       Get telemetry channel name.
+ *
+ * @param[in]   channel Telemetry channel.
+ *
+ * @return      Name of the channel ("unknown" if invalid).
+ */
+const char *getTelemetryChannelName(const TelemetryChannel_T channel);
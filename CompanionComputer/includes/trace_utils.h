@@ -0,0 +1,194 @@
+/**
+ * @file        trace_utils.h
+ * @author      Adam Csizy
+ * @date        2021-05-10
+ * @version     v1.1.0
+ *
+ * @brief       Event tracing utilities
+ */
+
+#pragma once
+
+
+#include <stdint.h>
+
+
+/* Trace related public macro definitions */
+
+#define STR_TRACE_ENV_FILE          "CC_TRACE_FILE"     /**< Environment variable overriding the trace file path */
+#define STR_TRACE_FILE_DEFAULT      "/var/tmp/DroneVideoStreamer.trace" /**< Default trace file path */
+#define STR_TRACE_MAGIC             "CCTRACE1"          /**< File signature (8 bytes, not terminated in the file) */
+#define NUM_TRACE_MAGIC_SIZE        8U                  /**< Size of the file signature */
+#define NUM_TRACE_VERSION           1U                  /**< File format version */
+#define NUM_TRACE_BUFFER_RECORDS    16384U              /**< Number of records per thread buffer (power of two, oldest overwritten) */
+#define NUM_TRACE_THREAD_NAME_SIZE  16U                 /**< Size of a thread name including the terminator */
+
+/**
+ * @brief   Names of the trace points (indexed by TracePoint_T).
+ */
+#define TRACE_POINT_NAMES { \
+    NULL, \
+    "msgq_insert", \
+    "msgq_remove", \
+    "msgq_message", \
+    "sm_transition", \
+    "sock_send", \
+    "sock_recv", \
+    "sock_sendmmsg", \
+    "pipe_set_state", \
+    "pipe_state_changed", \
+    "pipe_build", \
+    "pipe_caps", \
+    "frame" \
+}
+
+/*
+ * Trace macros. Build with -DCC_TRACE_ENABLED to enable them; otherwise
+ * their arguments are not evaluated (only type-checked inside sizeof, so
+ * locals that only feed trace calls do not warn as unused).
+ *
+ * TRACE_BEGIN/TRACE_END        Duration slice on the calling thread ('arg' shown in the slice)
+ * TRACE_INSTANT                Point in time event
+ * TRACE_FLOW_START/TRACE_FLOW_END  Arrow between two slices sharing 'id' (e.g. a queued message)
+ */
+#ifdef CC_TRACE_ENABLED
+#define TRACE_BEGIN(point, arg)         recordTraceEvent((point), TRACE_PHASE_BEGIN, (int64_t)(arg))
+#define TRACE_END(point, arg)           recordTraceEvent((point), TRACE_PHASE_END, (int64_t)(arg))
+#define TRACE_INSTANT(point, arg)       recordTraceEvent((point), TRACE_PHASE_INSTANT, (int64_t)(arg))
+#define TRACE_FLOW_START(point, id)     recordTraceEvent((point), TRACE_PHASE_FLOW_START, (int64_t)(intptr_t)(id))
+#define TRACE_FLOW_END(point, id)       recordTraceEvent((point), TRACE_PHASE_FLOW_END, (int64_t)(intptr_t)(id))
+#else
+#define TRACE_NONE(point, arg)          do { (void)sizeof(point); (void)sizeof(arg); } while(0)
+#define TRACE_BEGIN(point, arg)         TRACE_NONE((point), (int64_t)(arg))
+#define TRACE_END(point, arg)           TRACE_NONE((point), (int64_t)(arg))
+#define TRACE_INSTANT(point, arg)       TRACE_NONE((point), (int64_t)(arg))
+#define TRACE_FLOW_START(point, id)     TRACE_NONE((point), (int64_t)(intptr_t)(id))
+#define TRACE_FLOW_END(point, id)       TRACE_NONE((point), (int64_t)(intptr_t)(id))
+#endif
+
+
+/* Trace related public type definitions */
+
+/**
+ * @brief   Enumeration of trace points.
+ */
+typedef enum TracePoint {
+
+    TRACE_MSGQ_INSERT           = 1,    /**< insertModuleMessage() incl. waiting for space (arg: message code) */
+    TRACE_MSGQ_REMOVE           = 2,    /**< removeModuleMessage() incl. waiting for a message (arg: message code) */
+    TRACE_MSGQ_MESSAGE          = 3,    /**< Flow of a module message from insertion to removal (id: message) */
+    TRACE_SM_TRANSITION         = 4,    /**< Stream state machine event handler (begin arg: event, end arg: next state) */
+    TRACE_SOCK_SEND             = 5,    /**< send() on the control socket (end arg: result) */
+    TRACE_SOCK_RECV             = 6,    /**< recv() on the control socket (end arg: result) */
+    TRACE_SOCK_SENDMMSG         = 7,    /**< sendmmsg() of the network sink (begin arg: messages, end arg: result) */
+    TRACE_PIPE_SET_STATE        = 8,    /**< gst_element_set_state() call (begin arg: target state, end arg: result) */
+    TRACE_PIPE_STATE_CHANGED    = 9,    /**< Pipeline state changed bus message (arg: old state * 16 + new state) */
+    TRACE_PIPE_BUILD            = 10,   /**< Pipeline construction (end arg: result) */
+    TRACE_PIPE_CAPS             = 11,   /**< Caps event reached the network sink (caps negotiated) */
+    TRACE_FRAME                 = 12,   /**< Last RTP packet of a frame reached the network sink (arg: frames in the current meter report window) */
+    TRACE_POINT_COUNT           = 13    /**< Number of trace points */
+
+} TracePoint_T;
+
+/**
+ * @brief   Enumeration of trace record phases (Chrome trace event phases).
+ */
+typedef enum TracePhase {
+
+    TRACE_PHASE_BEGIN           = 'B',  /**< Slice begin */
+    TRACE_PHASE_END             = 'E',  /**< Slice end */
+    TRACE_PHASE_INSTANT         = 'i',  /**< Instant event */
+    TRACE_PHASE_FLOW_START      = 's',  /**< Flow start */
+    TRACE_PHASE_FLOW_END        = 'f'   /**< Flow end */
+
+} TracePhase_T;
+
+/**
+ * @brief   Trace record (24 bytes).
+ */
+typedef struct TraceRecord {
+
+    uint64_t timestampNs;       /**< CLOCK_MONOTONIC time */
+    int64_t arg;                /**< Trace point specific argument or flow identifier */
+    uint16_t point;             /**< TracePoint_T */
+    uint8_t phase;              /**< TracePhase_T */
+    uint8_t reserved[5];        /**< Reserved (zero) */
+
+} TraceRecord_T;
+
+/**
+ * @brief   Trace file header (32 bytes).
+ *
+ * @details The header is followed by 'threads' thread sections.
+ */
+typedef struct TraceFileHeader {
+
+    char magic[NUM_TRACE_MAGIC_SIZE];   /**< STR_TRACE_MAGIC */
+    uint32_t version;                   /**< NUM_TRACE_VERSION */
+    uint32_t recordSize;                /**< sizeof(TraceRecord_T) */
+    uint32_t threads;                   /**< Number of thread sections */
+    uint32_t pid;                       /**< Process identifier */
+    int64_t realtimeOffsetNs;           /**< CLOCK_REALTIME - CLOCK_MONOTONIC at write time */
+
+} TraceFileHeader_T;
+
+/**
+ * @brief   Trace file thread section header (32 bytes).
+ *
+ * @details Followed by 'records' records in chronological order.
+ */
+typedef struct TraceThreadHeader {
+
+    uint32_t threadId;                          /**< Kernel thread identifier */
+    uint32_t records;                           /**< Number of records in the section */
+    uint64_t overwritten;                       /**< Number of records lost to buffer wrap-around */
+    char name[NUM_TRACE_THREAD_NAME_SIZE];      /**< Thread name (terminated) */
+
+} TraceThreadHeader_T;
+
+
+/* Trace related public function declarations */
+
+/**
+ * @brief       Initialize trace module.
+ *
+ * @details     Registers the trace file to be written at exit, on
+ *              SIGTERM/SIGINT (after which the default action is
+ *              taken) and on SIGUSR1 (process keeps running).
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+int initTraceModule(void);
+
+/**
+ * @brief       Record trace event.
+ *
+ * @details     Appends a record to the calling thread's trace
+ *              buffer. The buffer is allocated on the first call of
+ *              each thread; when full the oldest records are
+ *              overwritten. Use the TRACE_* macros instead of calling
+ *              this function directly.
+ *
+ * @param[in]   point Trace point.
+ * @param[in]   phase Trace record phase.
+ * @param[in]   arg Trace point specific argument.
+ */
+void recordTraceEvent(const TracePoint_T point, const TracePhase_T phase, const int64_t arg);
+
+/**
+ * @brief       Write trace file.
+ *
+ * @details     Writes the buffers of all threads to the trace file
+ *              (STR_TRACE_ENV_FILE or STR_TRACE_FILE_DEFAULT). Uses
+ *              async-signal-safe calls only. Convert the file with
+ *              tools/trace_to_json.c.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+int writeTraceFile(void);
@@ -0,0 +1,695 @@
+/**
+ * @file        calibration_utils.c
+ * @author      Adam Csizy
+ * @date        2021-05-29
+ * @version     v1.1.0
+ *
+ * @brief       Video coding format calibration utilities
+ */
+
+
+#include <errno.h>
+#include <gst/gst.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+
+#include "calibration_utils.h"
+#include "log_utils.h"
+
+
+/* Calibration related macro definitions */
+
+#define STR_CALIBRATION_FILE_HEADER     "CCCAL 1"   /**< First line of the calibration cache */
+#define NUM_CALIBRATION_RESULT_MAX      (NUM_SUP_VID_COD_FMT - 1U + NUM_CALIBRATION_ENCODER_MAX) /**< Maximum number of measured format and encoder pairs */
+#define NUM_CALIBRATION_KEY_SIZE        512U    /**< Size of the calibration key */
+#define NUM_CALIBRATION_LINE_SIZE       640U    /**< Size of a calibration cache line */
+#define NUM_CALIBRATION_RANKING_SIZE    64U     /**< Size of the ranking string */
+#define NUM_CALIBRATION_PTS_RING        64U     /**< Capture timestamps kept for the latency measurement */
+#define NUM_NSEC_PER_USEC               1000ULL /**< Nanoseconds in a microsecond */
+#define NUM_NSEC_PER_SEC                1000000000ULL /**< Nanoseconds in a second */
+
+
+/* Calibration related static type declarations */
+
+/**
+ * @brief   Struct of a calibration result.
+ */
+typedef struct CalibrationResult {
+
+    VideoCodingFormat_T codingFormat;   /**< Video coding format */
+    int encoder;                        /**< Index of the H.264 encoder (RAW only, -1 otherwise) */
+    int status;                         /**< 0 if measured, -1 if the pipeline failed */
+    double fps;                         /**< Achieved framerate */
+    double nominalFps;                  /**< Framerate of the capabilities */
+    double cpuPercent;                  /**< CPU load of the process (percent of a core) */
+    double bitsPerFrame;                /**< Mean size of a frame at the payloader in bits */
+    double latencyMs;                   /**< Mean capture to payloader latency in milliseconds */
+    unsigned int pixels;                /**< Pixels of a frame */
+
+} CalibrationResult_T;
+
+/**
+ * @brief   Struct of the measurement counters of the running calibration pipeline.
+ */
+typedef struct CalibrationCounters {
+
+    int measuring;                                  /**< Flag whether the measurement window is open */
+    uint64_t frames;                                /**< Frames at the payloader */
+    uint64_t bytes;                                 /**< Bytes at the payloader */
+    uint64_t latencyNs;                             /**< Sum of the matched capture to payloader latencies */
+    uint64_t latencySamples;                        /**< Number of matched frames */
+    uint64_t capturePts[NUM_CALIBRATION_PTS_RING];  /**< Timestamps of the last captured frames */
+    uint64_t captureNs[NUM_CALIBRATION_PTS_RING];   /**< Monotonic capture times of the last captured frames */
+    unsigned int next;                              /**< Next entry of the capture ring */
+
+} CalibrationCounters_T;
+
+
+/* Calibration related static variable declarations */
+
+static VideoCodingFormat_T formatRanking[NUM_SUP_VID_COD_FMT] = {
+
+    CAM_FMT_H265, CAM_FMT_H264, CAM_FMT_VP8, CAM_FMT_VP9, CAM_FMT_JPEG, CAM_FMT_H263, CAM_FMT_RAW
+};  /**< Video coding formats in the order of preference */
+static int rankedEncoder = -1;                      /**< Best H.264 encoder of RAW sources (-1 if not ranked) */
+static CalibrationCounters_T counters;              /**< Counters of the running calibration pipeline */
+static pthread_mutex_t countersLock = PTHREAD_MUTEX_INITIALIZER;   /**< Lock of the counters */
+static const char *const objectiveNames[] = {"none", "latency", "bandwidth", "cpu"};           /**< Names of the ranking objectives */
+static const char *const formatNames[NUM_SUP_VID_COD_FMT] = {"H265", "H264", "VP8", "VP9", "JPEG", "H263", "RAW"}; /**< Short names of the video coding formats */
+
+
+/* Calibration related static function declarations */
+
+/**
+ * @brief       Get monotonic time.
+ *
+ * @return      CLOCK_MONOTONIC time in nanoseconds.
+ */
+static uint64_t getMonotonicNs(void);
+
+/**
+ * @brief       Get CPU time of the process.
+ *
+ * @return      User and system time in nanoseconds.
+ */
+static uint64_t getProcessCpuNs(void);
+
+/**
+ * @brief       Build calibration key.
+ *
+ * @details     Describes everything the results depend on: the video
+ *              source, its capabilities, the available encoders and
+ *              the measurement time.
+ *
+ * @param[in]   source Video source configuration.
+ * @param[in]   caps Video coding capabilities of the source.
+ * @param[in]   encoderNames H.264 encoder candidates.
+ * @param[in]   encoderAvailable Flags whether the encoders are available.
+ * @param[in]   encoderCount Number of encoder candidates.
+ * @param[in]   seconds Measurement time per format.
+ * @param[out]  key Calibration key.
+ * @param[in]   size Size of the key.
+ */
+static void buildCalibrationKey(const VideoSourceConfig_T *source, const VideoCodingFormatCaps_T caps[NUM_SUP_VID_COD_FMT],
+                                const char *const encoderNames[], const int encoderAvailable[], const unsigned int encoderCount,
+                                const unsigned int seconds, char key[], const size_t size);
+
+/**
+ * @brief       Measure a format.
+ *
+ * @details     Builds the calibration pipeline, plays it for the warm
+ *              up and the measurement time and releases it.
+ *
+ * @param[in]   build Build function of the calibration pipelines.
+ * @param[in]   data User data of the build function.
+ * @param[in]   durationMs Measurement time in milliseconds.
+ * @param[in,out]   result Calibration result (format and encoder set).
+ */
+static void measureFormat(CalibrationBuildFunc_T build, void *data, const unsigned int durationMs, CalibrationResult_T *result);
+
+/**
+ * @brief       Pad probe of the capture caps filter's source pad.
+ *
+ * @param[in]   pad Source pad of the caps filter.
+ * @param[in]   info Probe info.
+ * @param[in]   data User data (not used).
+ *
+ * @return      GST_PAD_PROBE_OK
+ */
+static GstPadProbeReturn captureProbe(GstPad *pad, GstPadProbeInfo *info, gpointer data);
+
+/**
+ * @brief       Pad probe of the payloader's sink pad.
+ *
+ * @param[in]   pad Sink pad of the payloader.
+ * @param[in]   info Probe info.
+ * @param[in]   data User data (not used).
+ *
+ * @return      GST_PAD_PROBE_OK
+ */
+static GstPadProbeReturn payloaderProbe(GstPad *pad, GstPadProbeInfo *info, gpointer data);
+
+/**
+ * @brief       Load cached calibration results.
+ *
+ * @param[in]   path Path of the calibration cache.
+ * @param[in]   key Calibration key of the current setup.
+ * @param[in]   encoderCount Number of encoder candidates.
+ * @param[out]  results Calibration results.
+ * @param[out]  count Number of results.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 No cache of the current setup
+ */
+static int loadCalibration(const char *path, const char *key, const unsigned int encoderCount,
+                           CalibrationResult_T results[NUM_CALIBRATION_RESULT_MAX], unsigned int *count);
+
+/**
+ * @brief       Save calibration results.
+ *
+ * @param[in]   path Path of the calibration cache.
+ * @param[in]   key Calibration key of the current setup.
+ * @param[in]   results Calibration results.
+ * @param[in]   count Number of results.
+ * @param[in]   encoderNames H.264 encoder candidates (for the reader only).
+ */
+static void saveCalibration(const char *path, const char *key, const CalibrationResult_T results[], const unsigned int count,
+                            const char *const encoderNames[]);
+
+/**
+ * @brief       Get cost of a calibration result.
+ *
+ * @param[in]   objective Ranking objective.
+ * @param[in]   result Calibration result.
+ * @param[out]  cost Cost of the result (lower is better).
+ *
+ * @return      Non-zero if the result may be ranked.
+ */
+static int getCalibrationCost(const CalibrationObjective_T objective, const CalibrationResult_T *result, double *cost);
+
+/**
+ * @brief       Rank formats by their calibration results.
+ *
+ * @param[in]   objective Ranking objective.
+ * @param[in]   results Calibration results.
+ * @param[in]   count Number of results.
+ */
+static void rankFormats(const CalibrationObjective_T objective, const CalibrationResult_T results[], const unsigned int count);
+
+
+/* Calibration related function definitions */
+
+int initFormatRanking(const VideoSourceConfig_T *source, const VideoCodingFormatCaps_T caps[NUM_SUP_VID_COD_FMT],
+                      const char *const encoderNames[], const unsigned int encoderCount, CalibrationBuildFunc_T build, void *data) {
+
+    int retval = 0;
+    unsigned int i, e, count = 0;
+    unsigned int encoders;
+    unsigned long seconds = NUM_CALIBRATION_SECONDS;
+    int encoderAvailable[NUM_CALIBRATION_ENCODER_MAX] = {0};
+    CalibrationObjective_T objective = CAL_OBJ_NONE;
+    CalibrationResult_T results[NUM_CALIBRATION_RESULT_MAX];
+    GstElementFactory *factory = NULL;
+    char key[NUM_CALIBRATION_KEY_SIZE];
+    char *end = NULL;
+    const char *text = NULL;
+    const char *path = NULL;
+
+    text = getenv(STR_CALIBRATION_ENV_OBJECTIVE);
+    if((NULL == text) || ('\0' == text[0])) {
+
+        return retval;
+    }
+
+    for(i = CAL_OBJ_LATENCY;i <= CAL_OBJ_CPU;++i) {
+
+        if(0 == strcmp(text, objectiveNames[i])) {
+
+            objective = (CalibrationObjective_T)(i);
+        }
+    }
+
+    if((CAL_OBJ_NONE == objective) || (NULL == source) || (NULL == caps) || (NULL == build) || ((0U < encoderCount) && (NULL == encoderNames))) {
+
+        LOG_MSG_WRN(LOG_MOD_STREAM, STR_LOG_MSG_FUNC95_OBJECTIVE_INVAL, text);
+        retval = -1;
+        return retval;
+    }
+
+    text = getenv(STR_CALIBRATION_ENV_SECONDS);
+    if((NULL != text) && ('\0' != text[0])) {
+
+        errno = 0;
+        seconds = strtoul(text, &end, 10);
+        if((0 != errno) || ('\0' != *end) || (0UL == seconds) || (NUM_CALIBRATION_SECONDS_MAX < seconds)) {
+
+            LOG_MSG_WRN(LOG_MOD_STREAM, STR_LOG_MSG_FUNC95_SECONDS_INVAL, text, NUM_CALIBRATION_SECONDS);
+            seconds = NUM_CALIBRATION_SECONDS;
+        }
+    }
+
+    path = getenv(STR_CALIBRATION_ENV_FILE);
+    if((NULL == path) || ('\0' == path[0])) {
+
+        path = STR_CALIBRATION_FILE_DEFAULT;
+    }
+
+    /* Only the installed encoders are measured (and part of the key) */
+    encoders = MIN(encoderCount, NUM_CALIBRATION_ENCODER_MAX);
+    for(e = 0;e < encoders;++e) {
+
+        factory = gst_element_factory_find(encoderNames[e]);
+        if(NULL != factory) {
+
+            encoderAvailable[e] = 1;
+            gst_object_unref(factory);
+        }
+    }
+
+    buildCalibrationKey(source, caps, encoderNames, encoderAvailable, encoders, (unsigned int)(seconds), key, sizeof(key));
+
+    if(loadCalibration(path, key, encoders, results, &count)) {
+
+        LOG_MSG_INF(LOG_MOD_STREAM, STR_LOG_MSG_FUNC95_CALIBRATING, path, (unsigned int)(seconds));
+
+        count = 0;
+        for(i = 0;i < NUM_SUP_VID_COD_FMT;++i) {
+
+            if(!caps[i].supported) {
+
+                continue;
+            }
+
+            for(e = 0;(e < ((CAM_FMT_RAW == i) ? encoders : 1U)) && (count < NUM_CALIBRATION_RESULT_MAX);++e) {
+
+                if((CAM_FMT_RAW == i) && !encoderAvailable[e]) {
+
+                    continue;
+                }
+
+                memset(&results[count], 0, sizeof(results[count]));
+                results[count].codingFormat = (VideoCodingFormat_T)(i);
+                results[count].encoder = (CAM_FMT_RAW == i) ? (int)(e) : -1;
+                results[count].pixels = (unsigned int)(caps[i].width) * (unsigned int)(caps[i].height);
+                results[count].nominalFps = (0 < caps[i].framerateDenominator) ?
+                    ((double)(caps[i].framerateNumerator) / (double)(caps[i].framerateDenominator)) : 0.0;
+
+                measureFormat(build, data, (unsigned int)(seconds) * 1000U, &results[count]);
+                ++count;
+            }
+        }
+
+        saveCalibration(path, key, results, count, encoderNames);
+    }
+    else {
+
+        LOG_MSG_INF(LOG_MOD_STREAM, STR_LOG_MSG_FUNC95_CACHED, path);
+    }
+
+    for(i = 0;i < count;++i) {
+
+        LOG_MSG_INF(LOG_MOD_STREAM, STR_LOG_MSG_FUNC95_RESULT, formatNames[results[i].codingFormat],
+            (0 <= results[i].encoder) ? encoderNames[results[i].encoder] : "-", results[i].status,
+            results[i].fps, results[i].nominalFps, results[i].cpuPercent, results[i].bitsPerFrame, results[i].latencyMs);
+    }
+
+    rankFormats(objective, results, count);
+
+    return retval;
+}
+
+void getFormatRanking(VideoCodingFormat_T ranking[NUM_SUP_VID_COD_FMT]) {
+
+    memcpy(ranking, formatRanking, sizeof(formatRanking));
+}
+
+int getRankedEncoder(void) {
+
+    return rankedEncoder;
+}
+
+static uint64_t getMonotonicNs(void) {
+
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return ((uint64_t)(now.tv_sec) * NUM_NSEC_PER_SEC) + (uint64_t)(now.tv_nsec);
+}
+
+static uint64_t getProcessCpuNs(void) {
+
+    struct rusage usage;
+
+    getrusage(RUSAGE_SELF, &usage);
+
+    return (((uint64_t)(usage.ru_utime.tv_sec) + (uint64_t)(usage.ru_stime.tv_sec)) * NUM_NSEC_PER_SEC) +
+           (((uint64_t)(usage.ru_utime.tv_usec) + (uint64_t)(usage.ru_stime.tv_usec)) * NUM_NSEC_PER_USEC);
+}
+
+static void buildCalibrationKey(const VideoSourceConfig_T *source, const VideoCodingFormatCaps_T caps[NUM_SUP_VID_COD_FMT],
+                                const char *const encoderNames[], const int encoderAvailable[], const unsigned int encoderCount,
+                                const unsigned int seconds, char key[], const size_t size) {
+
+    unsigned int i;
+    size_t length;
+
+    length = (size_t)snprintf(key, size, "source=%d:%s:%d;seconds=%u", (int)(source->type), source->path, (int)(source->format), seconds);
+    for(i = 0;(i < NUM_SUP_VID_COD_FMT) && (length < size);++i) {
+
+        if(caps[i].supported) {
+
+            length += (size_t)snprintf(key + length, size - length, ";%s=%dx%d@%d/%d", formatNames[i],
+                caps[i].width, caps[i].height, caps[i].framerateNumerator, caps[i].framerateDenominator);
+        }
+    }
+    for(i = 0;(i < encoderCount) && (length < size);++i) {
+
+        if(encoderAvailable[i]) {
+
+            length += (size_t)snprintf(key + length, size - length, ";enc=%s", encoderNames[i]);
+        }
+    }
+}
+
+static void measureFormat(CalibrationBuildFunc_T build, void *data, const unsigned int durationMs, CalibrationResult_T *result) {
+
+    uint64_t startNs, endNs;
+    uint64_t startCpuNs, endCpuNs;
+    GstElement *pipeline = NULL;
+    GstElement *capsfilter = NULL;
+    GstElement *payloader = NULL;
+    GstPad *pad = NULL;
+    GstBus *bus = NULL;
+    GstMessage *message = NULL;
+    CalibrationCounters_T measured;
+
+    result->status = -1;
+
+    if(build(&pipeline, &capsfilter, &payloader, result->codingFormat, result->encoder, data) || (NULL == pipeline)) {
+
+        LOG_MSG_WRN(LOG_MOD_STREAM, STR_LOG_MSG_FUNC96_BUILD_FAIL, formatNames[result->codingFormat], result->encoder);
+        return;
+    }
+
+    pthread_mutex_lock(&countersLock);
+    memset(&counters, 0, sizeof(counters));
+    pthread_mutex_unlock(&countersLock);
+
+    pad = gst_element_get_static_pad(capsfilter, "src");
+    if(NULL != pad) {
+
+        gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, captureProbe, NULL, NULL);
+        gst_object_unref(pad);
+    }
+    pad = gst_element_get_static_pad(payloader, "sink");
+    if(NULL != pad) {
+
+        gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, payloaderProbe, NULL, NULL);
+        gst_object_unref(pad);
+    }
+
+    bus = gst_element_get_bus(pipeline);
+    if(GST_STATE_CHANGE_FAILURE == gst_element_set_state(pipeline, GST_STATE_PLAYING)) {
+
+        LOG_MSG_WRN(LOG_MOD_STREAM, STR_LOG_MSG_FUNC96_PLAY_FAIL, formatNames[result->codingFormat], result->encoder);
+    }
+    else {
+
+        /* The bus wait doubles as the timer: an error ends the measurement early */
+        message = gst_bus_timed_pop_filtered(bus, NUM_CALIBRATION_WARMUP_MS * GST_MSECOND, GST_MESSAGE_ERROR | GST_MESSAGE_EOS);
+        if(NULL == message) {
+
+            pthread_mutex_lock(&countersLock);
+            counters.measuring = 1;
+            pthread_mutex_unlock(&countersLock);
+            startNs = getMonotonicNs();
+            startCpuNs = getProcessCpuNs();
+
+            message = gst_bus_timed_pop_filtered(bus, durationMs * GST_MSECOND, GST_MESSAGE_ERROR | GST_MESSAGE_EOS);
+
+            pthread_mutex_lock(&countersLock);
+            counters.measuring = 0;
+            measured = counters;
+            pthread_mutex_unlock(&countersLock);
+            endNs = getMonotonicNs();
+            endCpuNs = getProcessCpuNs();
+
+            if((NULL == message) && (0U < measured.frames) && (endNs > startNs)) {
+
+                result->status = 0;
+                result->fps = (double)(measured.frames) * NUM_NSEC_PER_SEC / (double)(endNs - startNs);
+                result->cpuPercent = 100.0 * (double)(endCpuNs - startCpuNs) / (double)(endNs - startNs);
+                result->bitsPerFrame = 8.0 * (double)(measured.bytes) / (double)(measured.frames);
+                result->latencyMs = (0U < measured.latencySamples) ?
+                    ((double)(measured.latencyNs) / (double)(measured.latencySamples) / 1e6) : 0.0;
+            }
+        }
+
+        if(NULL != message) {
+
+            LOG_MSG_WRN(LOG_MOD_STREAM, STR_LOG_MSG_FUNC96_PIPE_FAIL, formatNames[result->codingFormat], result->encoder);
+            gst_message_unref(message);
+        }
+    }
+
+    gst_object_unref(bus);
+    gst_element_set_state(pipeline, GST_STATE_NULL);
+    gst_object_unref(pipeline);
+}
+
+static GstPadProbeReturn captureProbe(GstPad *pad, GstPadProbeInfo *info, gpointer data) {
+
+    GstBuffer *buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+
+    pthread_mutex_lock(&countersLock);
+    if(counters.measuring && GST_CLOCK_TIME_IS_VALID(GST_BUFFER_PTS(buffer))) {
+
+        counters.capturePts[counters.next] = (uint64_t)(GST_BUFFER_PTS(buffer));
+        counters.captureNs[counters.next] = getMonotonicNs();
+        counters.next = (counters.next + 1U) % NUM_CALIBRATION_PTS_RING;
+    }
+    pthread_mutex_unlock(&countersLock);
+
+    return GST_PAD_PROBE_OK;
+}
+
+static GstPadProbeReturn payloaderProbe(GstPad *pad, GstPadProbeInfo *info, gpointer data) {
+
+    unsigned int i;
+    uint64_t pts;
+    GstBuffer *buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+
+    pthread_mutex_lock(&countersLock);
+    if(counters.measuring) {
+
+        ++counters.frames;
+        counters.bytes += gst_buffer_get_size(buffer);
+
+        /* Encoders keep the capture timestamp */
+        pts = (uint64_t)(GST_BUFFER_PTS(buffer));
+        for(i = 0;GST_CLOCK_TIME_IS_VALID(GST_BUFFER_PTS(buffer)) && (i < NUM_CALIBRATION_PTS_RING);++i) {
+
+            if((0U != counters.captureNs[i]) && (pts == counters.capturePts[i])) {
+
+                counters.latencyNs += getMonotonicNs() - counters.captureNs[i];
+                ++counters.latencySamples;
+                counters.captureNs[i] = 0U;
+                break;
+            }
+        }
+    }
+    pthread_mutex_unlock(&countersLock);
+
+    return GST_PAD_PROBE_OK;
+}
+
+static int loadCalibration(const char *path, const char *key, const unsigned int encoderCount,
+                           CalibrationResult_T results[NUM_CALIBRATION_RESULT_MAX], unsigned int *count) {
+
+    int retval = -1;
+    int codingFormat;
+    FILE *file = NULL;
+    CalibrationResult_T *result = NULL;
+    char line[NUM_CALIBRATION_LINE_SIZE];
+
+    *count = 0;
+
+    file = fopen(path, "r");
+    if(NULL == file) {
+
+        return retval;
+    }
+
+    /* Header and key must match the current setup */
+    if((NULL == fgets(line, sizeof(line), file)) || (0 != strcmp(line, STR_CALIBRATION_FILE_HEADER "\n"))) {
+
+        fclose(file);
+        return retval;
+    }
+    if((NULL == fgets(line, sizeof(line), file)) || (0 != strncmp(line, "key ", 4))) {
+
+        fclose(file);
+        return retval;
+    }
+    line[strcspn(line, "\n")] = '\0';
+    if(0 != strcmp(line + 4, key)) {
+
+        LOG_MSG_INF(LOG_MOD_STREAM, STR_LOG_MSG_FUNC97_STALE, path);
+        fclose(file);
+        return retval;
+    }
+
+    retval = 0;
+    while((NULL != fgets(line, sizeof(line), file)) && (*count < NUM_CALIBRATION_RESULT_MAX)) {
+
+        result = &results[*count];
+        memset(result, 0, sizeof(*result));
+        if((9 != sscanf(line, "result %d %d %d %lf %lf %lf %lf %lf %u", &codingFormat, &result->encoder, &result->status,
+                        &result->fps, &result->nominalFps, &result->cpuPercent, &result->bitsPerFrame, &result->latencyMs, &result->pixels)) ||
+           (0 > codingFormat) || (NUM_SUP_VID_COD_FMT <= (unsigned int)(codingFormat)) ||
+           ((CAM_FMT_RAW == codingFormat) ? ((0 > result->encoder) || (encoderCount <= (unsigned int)(result->encoder))) : (-1 != result->encoder))) {
+
+            /* A damaged cache is measured again */
+            LOG_MSG_WRN(LOG_MOD_STREAM, STR_LOG_MSG_FUNC97_LINE_INVAL, path);
+            retval = -1;
+            break;
+        }
+        result->codingFormat = (VideoCodingFormat_T)(codingFormat);
+        ++(*count);
+    }
+
+    fclose(file);
+
+    if((0 == retval) && (0U == *count)) {
+
+        retval = -1;
+    }
+
+    return retval;
+}
+
+static void saveCalibration(const char *path, const char *key, const CalibrationResult_T results[], const unsigned int count,
+                            const char *const encoderNames[]) {
+
+    unsigned int i;
+    FILE *file = NULL;
+
+    file = fopen(path, "w");
+    if(NULL == file) {
+
+        LOG_MSG_WRN(LOG_MOD_STREAM, STR_LOG_MSG_FUNC98_WRITE_FAIL, path, strerror(errno));
+        return;
+    }
+
+    /* One line per format and encoder, the trailing names are for the reader */
+    fprintf(file, STR_CALIBRATION_FILE_HEADER "\nkey %s\n", key);
+    for(i = 0;i < count;++i) {
+
+        fprintf(file, "result %d %d %d %.2f %.2f %.1f %.0f %.2f %u %s %s\n", (int)(results[i].codingFormat), results[i].encoder,
+            results[i].status, results[i].fps, results[i].nominalFps, results[i].cpuPercent, results[i].bitsPerFrame,
+            results[i].latencyMs, results[i].pixels, formatNames[results[i].codingFormat],
+            (0 <= results[i].encoder) ? encoderNames[results[i].encoder] : "-");
+    }
+
+    if(fclose(file)) {
+
+        LOG_MSG_WRN(LOG_MOD_STREAM, STR_LOG_MSG_FUNC98_WRITE_FAIL, path, strerror(errno));
+        remove(path);
+    }
+}
+
+static int getCalibrationCost(const CalibrationObjective_T objective, const CalibrationResult_T *result, double *cost) {
+
+    if((0 != result->status) || (0.0 >= result->fps) ||
+       ((100.0 * result->fps) < ((double)(NUM_CALIBRATION_MIN_FPS_PERCENT) * result->nominalFps))) {
+
+        return 0;
+    }
+
+    switch(objective) {
+
+        case CAL_OBJ_LATENCY:
+
+            /* A frame waits a frame interval on average to be captured */
+            *cost = result->latencyMs + (1000.0 / result->fps);
+            break;
+
+        case CAL_OBJ_BANDWIDTH:
+
+            /* Bits per pixel: resolution independent */
+            *cost = result->bitsPerFrame / (double)((0U < result->pixels) ? result->pixels : 1U);
+            break;
+
+        case CAL_OBJ_CPU:
+
+            *cost = result->cpuPercent;
+            break;
+
+        default:
+
+            return 0;
+    }
+
+    return 1;
+}
+
+static void rankFormats(const CalibrationObjective_T objective, const CalibrationResult_T results[], const unsigned int count) {
+
+    unsigned int i, j, rank = 0;
+    int ranked[NUM_SUP_VID_COD_FMT] = {0};
+    int valid[NUM_SUP_VID_COD_FMT] = {0};
+    int encoder[NUM_SUP_VID_COD_FMT];
+    double best[NUM_SUP_VID_COD_FMT];
+    double cost;
+    VideoCodingFormat_T ranking[NUM_SUP_VID_COD_FMT];
+    char rankingString[NUM_CALIBRATION_RANKING_SIZE] = {0};
+    size_t length = 0;
+    int pick;
+
+    /* Best result of every format (RAW: of every encoder) */
+    for(i = 0;i < NUM_SUP_VID_COD_FMT;++i) {
+
+        encoder[i] = -1;
+    }
+    for(i = 0;i < count;++i) {
+
+        j = (unsigned int)(results[i].codingFormat);
+        if(getCalibrationCost(objective, &results[i], &cost) && (!valid[j] || (cost < best[j]))) {
+
+            valid[j] = 1;
+            best[j] = cost;
+            encoder[j] = results[i].encoder;
+        }
+    }
+
+    /* Lowest cost first (ties keep the enum order), then the rest in enum order */
+    for(rank = 0;rank < NUM_SUP_VID_COD_FMT;++rank) {
+
+        pick = -1;
+        for(i = 0;i < NUM_SUP_VID_COD_FMT;++i) {
+
+            if(!ranked[i] && ((-1 == pick) || (valid[i] && (!valid[pick] || (best[i] < best[pick]))))) {
+
+                pick = (int)(i);
+            }
+        }
+        ranked[pick] = 1;
+        ranking[rank] = (VideoCodingFormat_T)(pick);
+        if(valid[pick] && (length < sizeof(rankingString))) {
+
+            length += (size_t)snprintf(rankingString + length, sizeof(rankingString) - length, "%s%s", (0U < length) ? "," : "", formatNames[pick]);
+        }
+    }
+
+    memcpy(formatRanking, ranking, sizeof(formatRanking));
+    rankedEncoder = encoder[CAM_FMT_RAW];
+
+    LOG_MSG_INF(LOG_MOD_STREAM, STR_LOG_MSG_FUNC99_RANKED, objectiveNames[objective], ('\0' != rankingString[0]) ? rankingString : "-");
+}
@@ -12,13 +12,16 @@
 #include <fcntl.h>
 #include <linux/videodev2.h>
 #include <stdio.h>
-#include <syslog.h>
+#include <stdlib.h>
+#include <string.h>
 #include <sys/ioctl.h>
+#include <time.h>
 #include <unistd.h>
 
 #include <gst/gst.h>
 
 #include "camera_utils.h"
+#include "clock_utils.h"
 #include "log_utils.h"
 
 
@@ -44,6 +47,36 @@
 #define CAM_FMT_SUPPORTED       1                   /**< Supported camera output video coding format */
 #define CAM_FMT_NOT_SUPPORTED   0                   /**< Unsupported camera output video coding format */
 
+#define STR_VID_SRC_TYPE_V4L2   "v4l2"              /**< Video source specification type: camera device */
+#define STR_VID_SRC_TYPE_TEST   "test"              /**< Video source specification type: test pattern */
+#define STR_VID_SRC_TYPE_FILE   "file"              /**< Video source specification type: looped file(s) */
+#define STR_VID_SRC_FMT_JPEG    "jpeg"              /**< Video source specification format: JPEG */
+#define STR_VID_SRC_FMT_H264    "h264"              /**< Video source specification format: H.264 */
+#define STR_VID_SRC_FMT_RAW     "raw"               /**< Video source specification format: RAW */
+#define STR_VID_SRC_FMT_ANY     "any"               /**< Format of camera device sources in log records */
+#define NUM_VID_SRC_FMT_NAME_SIZE   8U              /**< Size of the format name of a video source specification */
+#define NUM_VID_SRC_DEFAULT_WIDTH   640             /**< Default frame width of virtual video sources */
+#define NUM_VID_SRC_DEFAULT_HEIGHT  480             /**< Default frame height of virtual video sources */
+#define NUM_VID_SRC_DEFAULT_FPS     30              /**< Default framerate of virtual video sources */
+#define STR_VID_SRC_STAMP_FORMAT    "I420"          /**< Raw format of test sources with latency stamp */
+#define NUM_LATENCY_STAMP_BLACK     16U             /**< Luma of latency stamp 0 bits */
+#define NUM_LATENCY_STAMP_WHITE     235U            /**< Luma of latency stamp 1 bits */
+#define NUM_LATENCY_STAMP_CHROMA    128U            /**< Chroma of the latency stamp area (grey) */
+
+
+/* Camera related type definitions */
+
+/**
+ * @brief       Latency stamp state of a test source.
+ */
+typedef struct LatencyStamp {
+
+    int width;                  /**< Frame width */
+    int height;                 /**< Frame height */
+    guint16 frameCounter;       /**< Counter of the next stamped frame */
+
+} LatencyStamp_T;
+
 
 /* Camera related function definitions */
 
@@ -348,93 +381,18 @@ static int printVideoCodingFormatCaps(const VideoCodingFormatCaps_T capabilities
 int getCameraCapabilities(GstElement *v4l2srcElement, VideoCodingFormatContext_T *ctx) {
 
   int retval = 0;
-  int width, height, framerateNum, framerateDenom;
-  int listElemIndex;
-  guint i = 0;
   GstPad *sourcePad = NULL;
   GstCaps *capabilities = NULL;
-  GstStructure *capsStructure = NULL;
-  const GValue *framerateFract = NULL;
-  const GValue *framerateList = NULL;
-  VideoCodingFormat_T selectedFormat = CAM_FMT_UNK;
 
   if((NULL != v4l2srcElement) && (NULL != ctx)) {
 
-    memset(ctx->capsArray, 0, sizeof(VideoCodingFormatCaps_T)*ctx->size);
-
     sourcePad = gst_element_get_static_pad(v4l2srcElement, "src");
     if(NULL != sourcePad ) {
 
       capabilities = gst_pad_query_caps(sourcePad, NULL);
       if(NULL != capabilities) {
 
-        if(gst_caps_is_any(capabilities)) {
-        
-          createLogMessage(STR_LOG_MSG_FUNC5_CAPS_ANY, LOG_SVRTY_ERR);
-          retval = -1;
-        }
-        else if(gst_caps_is_empty(capabilities)) {
-          
-          createLogMessage(STR_LOG_MSG_FUNC5_CAPS_EMPTY, LOG_SVRTY_ERR);
-          retval = -1;
-        }
-        else {
-
-          /* Iterate over camera output formats */
-          for (i = 0; i < gst_caps_get_size(capabilities); ++i) {
-
-            capsStructure = gst_caps_get_structure(capabilities, i);
-
-            stringToVideoCodingFormat(gst_structure_get_name(capsStructure), &selectedFormat);
-            if(ctx->size > selectedFormat) {
-              
-              /* Update capabilities of supported format */
-              width = height = 0;
-              framerateNum = framerateDenom = 0;
-              framerateFract = NULL;
-              framerateList = NULL;
-
-              ctx->capsArray[selectedFormat].supported = CAM_FMT_SUPPORTED;
-              gst_structure_get_int(capsStructure, "width", &width);
-              gst_structure_get_int(capsStructure, "height", &height);
-
-              /* Check update condition (best resolution) */
-              if(
-                (width * height)
-                >
-                (ctx->capsArray[selectedFormat].width * ctx->capsArray[selectedFormat].height)
-              ) {
-
-                ctx->capsArray[selectedFormat].width = width;
-                ctx->capsArray[selectedFormat].height = height;
-
-                framerateList = gst_structure_get_value(capsStructure, "framerate");
-                for(listElemIndex = 0; listElemIndex < gst_value_list_get_size(framerateList); ++listElemIndex) {
-
-                  framerateFract = gst_value_list_get_value(framerateList, listElemIndex);
-                  if(
-                    (
-                    (float)(((float)gst_value_get_fraction_numerator(framerateFract))/((float)gst_value_get_fraction_denominator(framerateFract)))
-                    >
-                    (float)(((float)framerateNum)/((float)framerateDenom))
-                    )
-
-                    ||
-
-                    (0 == framerateDenom)
-                  ) {
-
-                    framerateNum = gst_value_get_fraction_numerator(framerateFract);
-                    framerateDenom = gst_value_get_fraction_denominator(framerateFract);
-                  }
-                }
-
-                ctx->capsArray[selectedFormat].framerateNumerator = framerateNum;
-                ctx->capsArray[selectedFormat].framerateDenominator = framerateDenom;
-              }
-            }
-          }
-        }
+        retval = parseCameraCapabilities(capabilities, ctx);
 
         gst_caps_unref(capabilities);
         gst_object_unref(sourcePad);
@@ -461,6 +419,107 @@ int getCameraCapabilities(GstElement *v4l2srcElement, VideoCodingFormatContext_T
   return retval;
 }
 
+int parseCameraCapabilities(const GstCaps *capabilities, VideoCodingFormatContext_T *ctx) {
+
+  int retval = 0;
+  int width, height, framerateNum, framerateDenom;
+  int listElemIndex;
+  guint i = 0;
+  const GstStructure *capsStructure = NULL;
+  const GValue *framerateFract = NULL;
+  const GValue *framerateList = NULL;
+  VideoCodingFormat_T selectedFormat = CAM_FMT_UNK;
+
+  if((NULL != capabilities) && (NULL != ctx)) {
+
+    memset(ctx->capsArray, 0, sizeof(VideoCodingFormatCaps_T)*ctx->size);
+
+    if(gst_caps_is_any(capabilities)) {
+    
+      createLogMessage(STR_LOG_MSG_FUNC54_CAPS_ANY, LOG_SVRTY_ERR);
+      retval = -1;
+    }
+    else if(gst_caps_is_empty(capabilities)) {
+      
+      createLogMessage(STR_LOG_MSG_FUNC54_CAPS_EMPTY, LOG_SVRTY_ERR);
+      retval = -1;
+    }
+    else {
+
+      /* Iterate over camera output formats */
+      for (i = 0; i < gst_caps_get_size(capabilities); ++i) {
+
+        capsStructure = gst_caps_get_structure(capabilities, i);
+
+        stringToVideoCodingFormat(gst_structure_get_name(capsStructure), &selectedFormat);
+        if(ctx->size > selectedFormat) {
+          
+          /* Update capabilities of supported format */
+          width = height = 0;
+          framerateNum = framerateDenom = 0;
+          framerateFract = NULL;
+          framerateList = NULL;
+
+          ctx->capsArray[selectedFormat].supported = CAM_FMT_SUPPORTED;
+          gst_structure_get_int(capsStructure, "width", &width);
+          gst_structure_get_int(capsStructure, "height", &height);
+
+          /* Check update condition (best resolution) */
+          if(
+            (width * height)
+            >
+            (ctx->capsArray[selectedFormat].width * ctx->capsArray[selectedFormat].height)
+          ) {
+
+            ctx->capsArray[selectedFormat].width = width;
+            ctx->capsArray[selectedFormat].height = height;
+
+            framerateList = gst_structure_get_value(capsStructure, "framerate");
+            if((NULL != framerateList) && GST_VALUE_HOLDS_FRACTION(framerateList)) {
+
+              /* Single framerate (fixed caps of virtual video sources) */
+              framerateNum = gst_value_get_fraction_numerator(framerateList);
+              framerateDenom = gst_value_get_fraction_denominator(framerateList);
+            }
+            else if((NULL != framerateList) && GST_VALUE_HOLDS_LIST(framerateList)) {
+
+              for(listElemIndex = 0; listElemIndex < gst_value_list_get_size(framerateList); ++listElemIndex) {
+
+                framerateFract = gst_value_list_get_value(framerateList, listElemIndex);
+                if(
+                  (
+                  (float)(((float)gst_value_get_fraction_numerator(framerateFract))/((float)gst_value_get_fraction_denominator(framerateFract)))
+                  >
+                  (float)(((float)framerateNum)/((float)framerateDenom))
+                  )
+
+                  ||
+
+                  (0 == framerateDenom)
+                ) {
+
+                  framerateNum = gst_value_get_fraction_numerator(framerateFract);
+                  framerateDenom = gst_value_get_fraction_denominator(framerateFract);
+                }
+              }
+            }
+
+            ctx->capsArray[selectedFormat].framerateNumerator = framerateNum;
+            ctx->capsArray[selectedFormat].framerateDenominator = framerateDenom;
+          }
+        }
+      }
+    }
+  }
+  else {
+
+    createLogMessage(STR_LOG_MSG_FUNC54_ARG_INVAL, LOG_SVRTY_ERR);
+    retval = -1;
+  }
+
+  return retval;
+}
+
 /**
  * @brief       Prints V4L2 device capabilities on the standard output.
  * 
@@ -553,10 +612,8 @@ int getCameraDevicePath(char cameraDevicePath[], const size_t size) {
                     #ifdef CC_DEBUG_MODE
                     perror("open");
                     fflush(stderr);
-                    fprintf(stdout, STR_LOG_MSG_FUNC1_OPEN_DEV_FAIL, deviceEntry->d_name);
-                    fflush(stdout);
                     #endif
-                    syslog(LOG_DAEMON | LOG_WARNING, STR_LOG_MSG_FUNC1_OPEN_DEV_FAIL, deviceEntry->d_name);
+                    LOG_MSG_WRN(LOG_MOD_CAMERA, STR_LOG_MSG_FUNC1_OPEN_DEV_FAIL, deviceEntry->d_name);
                 }
                 else {
              
@@ -566,10 +623,8 @@ int getCameraDevicePath(char cameraDevicePath[], const size_t size) {
                         #ifdef CC_DEBUG_MODE
                         perror("ioctl");
                         fflush(stderr);
-                        fprintf(stdout, STR_LOG_MSG_FUNC1_QUERY_CAP_FAIL, deviceEntry->d_name);
-                        fflush(stdout);
                         #endif
-                        syslog(LOG_DAEMON | LOG_WARNING, STR_LOG_MSG_FUNC1_QUERY_CAP_FAIL, deviceEntry->d_name);
+                        LOG_MSG_WRN(LOG_MOD_CAMERA, STR_LOG_MSG_FUNC1_QUERY_CAP_FAIL, deviceEntry->d_name);
                     }
                     else {
                         
@@ -596,4 +651,446 @@ int getCameraDevicePath(char cameraDevicePath[], const size_t size) {
     
     retval = -1;
     return retval;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief       Converts a video source format name.
+ *
+ * @param[in]   name Format name of a video source specification.
+ *
+ * @return      Video coding format or CAM_FMT_UNK.
+ */
+static VideoCodingFormat_T sourceFormatNameToVideoCodingFormat(const char *name) {
+
+    VideoCodingFormat_T format = CAM_FMT_UNK;
+
+    if(0 == strcmp(name, STR_VID_SRC_FMT_JPEG)) {
+
+        format = CAM_FMT_JPEG;
+    }
+    else if(0 == strcmp(name, STR_VID_SRC_FMT_H264)) {
+
+        format = CAM_FMT_H264;
+    }
+    else if(0 == strcmp(name, STR_VID_SRC_FMT_RAW)) {
+
+        format = CAM_FMT_RAW;
+    }
+
+    return format;
+}
+
+/**
+ * @brief       Creates the capabilities of a virtual video source.
+ *
+ * @param[in]   config Video source configuration.
+ * @param[in]   format Video coding format of the capabilities.
+ *
+ * @return      Capabilities (unref with 'gst_caps_unref()') or NULL.
+ */
+static GstCaps* createVideoSourceCaps(const VideoSourceConfig_T *config, const VideoCodingFormat_T format) {
+
+    char mediaType[32] = {0};
+
+    if(videoCodingFormatToString(format, mediaType, sizeof(mediaType))) {
+
+        return NULL;
+    }
+
+    return gst_caps_new_simple(
+        mediaType,
+        "width", G_TYPE_INT, config->width,
+        "height", G_TYPE_INT, config->height,
+        "framerate", GST_TYPE_FRACTION, config->framerate, 1,
+        NULL
+    );
+}
+
+/**
+ * @brief       Latency stamp buffer probe.
+ *
+ * @details     Writes the capture time and the frame counter
+ *              into the top left corner of a raw I420 frame
+ *              (see NUM_LATENCY_STAMP_BLOCK). Invoked in the
+ *              streaming thread of the test source.
+ *
+ * @param[in]   pad Source pad of the raw capsfilter.
+ * @param[in,out]   info Probe info holding the frame.
+ * @param[in,out]   data Latency stamp state (LatencyStamp_T).
+ *
+ * @return      GST_PAD_PROBE_OK (pass the frame).
+ */
+static GstPadProbeReturn latencyStampProbe(GstPad *pad, GstPadProbeInfo *info, gpointer data) {
+
+    int x, y, word;
+    guint16 words[NUM_LATENCY_STAMP_ROWS] = {0};
+    guint64 captureUs;
+    uint64_t groundNs;
+    gsize lumaStride, chromaStride, chromaSize, chromaOffset;
+    struct timespec now;
+    GstMapInfo map;
+    GstBuffer *buffer = NULL;
+    LatencyStamp_T *stamp = (LatencyStamp_T*)data;
+
+    /* Ground control's clock once synchronized: the latency holds across hosts */
+    if(0 == getGroundTimeNs(&groundNs)) {
+
+        captureUs = groundNs / 1000ULL;
+    }
+    else {
+
+        clock_gettime(CLOCK_REALTIME, &now);
+        captureUs = (guint64)(now.tv_sec) * 1000000ULL + (guint64)(now.tv_nsec) / 1000ULL;
+    }
+
+    words[0] = (guint16)(captureUs >> 48);
+    words[1] = (guint16)(captureUs >> 32);
+    words[2] = (guint16)(captureUs >> 16);
+    words[3] = (guint16)(captureUs);
+    words[4] = stamp->frameCounter++;
+    words[5] = NUM_LATENCY_STAMP_CHECK;
+    for(word = 0;word < NUM_LATENCY_STAMP_ROWS - 1;++word) {
+
+        words[NUM_LATENCY_STAMP_ROWS - 1] ^= words[word];
+    }
+
+    /* The frame may be shared with the previous element: stamp a writable one */
+    buffer = gst_buffer_make_writable(GST_PAD_PROBE_INFO_BUFFER(info));
+    GST_PAD_PROBE_INFO_DATA(info) = buffer;
+
+    if(TRUE != gst_buffer_map(buffer, &map, GST_MAP_WRITE)) {
+
+        return GST_PAD_PROBE_OK;
+    }
+
+    /* I420 plane layout of GStreamer (default strides and offsets) */
+    lumaStride = GST_ROUND_UP_4(stamp->width);
+    chromaStride = GST_ROUND_UP_4(GST_ROUND_UP_2(stamp->width) / 2);
+    chromaSize = chromaStride * (GST_ROUND_UP_2(stamp->height) / 2);
+    chromaOffset = lumaStride * GST_ROUND_UP_2(stamp->height);
+
+    if(map.size >= chromaOffset + 2 * chromaSize) {
+
+        for(y = 0;y < NUM_LATENCY_STAMP_ROWS * NUM_LATENCY_STAMP_BLOCK;++y) {
+
+            for(x = 0;x < NUM_LATENCY_STAMP_COLUMNS * NUM_LATENCY_STAMP_BLOCK;++x) {
+
+                map.data[y * lumaStride + x] = ((words[y / NUM_LATENCY_STAMP_BLOCK] >> (NUM_LATENCY_STAMP_COLUMNS - 1 - x / NUM_LATENCY_STAMP_BLOCK)) & 1U) ?
+                    NUM_LATENCY_STAMP_WHITE : NUM_LATENCY_STAMP_BLACK;
+            }
+        }
+
+        /* Grey chroma: colored test patterns would bleed into the luma after encoding */
+        for(y = 0;y < NUM_LATENCY_STAMP_ROWS * NUM_LATENCY_STAMP_BLOCK / 2;++y) {
+
+            memset(&map.data[chromaOffset + y * chromaStride], NUM_LATENCY_STAMP_CHROMA, NUM_LATENCY_STAMP_COLUMNS * NUM_LATENCY_STAMP_BLOCK / 2);
+            memset(&map.data[chromaOffset + chromaSize + y * chromaStride], NUM_LATENCY_STAMP_CHROMA, NUM_LATENCY_STAMP_COLUMNS * NUM_LATENCY_STAMP_BLOCK / 2);
+        }
+    }
+
+    gst_buffer_unmap(buffer, &map);
+
+    return GST_PAD_PROBE_OK;
+}
+
+int getVideoSourceConfig(VideoSourceConfig_T *config) {
+
+    int retval = 0;
+    int fields = 0;
+    int consumed = 0;
+    int specificationValid = TRUE;
+    char formatName[NUM_VID_SRC_FMT_NAME_SIZE] = {0};
+    char mediaType[32] = STR_VID_SRC_FMT_ANY;
+    const char *specification = NULL;
+    const char *location = NULL;
+    const char *typeName = STR_VID_SRC_TYPE_V4L2;
+    const char *latencyStamp = NULL;
+
+    if(NULL == config) {
+
+        createLogMessage(STR_LOG_MSG_FUNC55_ARG_INVAL, LOG_SVRTY_ERR);
+        retval = -1;
+        return retval;
+    }
+
+    memset(config, 0, sizeof(VideoSourceConfig_T));
+    config->type = VIDEO_SRC_V4L2;
+    config->format = CAM_FMT_UNK;
+    config->width = NUM_VID_SRC_DEFAULT_WIDTH;
+    config->height = NUM_VID_SRC_DEFAULT_HEIGHT;
+    config->framerate = NUM_VID_SRC_DEFAULT_FPS;
+
+    specification = getenv(STR_VIDEO_SOURCE_ENV);
+    if((NULL == specification) || ('\0' == specification[0]) || (0 == strcmp(specification, STR_VID_SRC_TYPE_V4L2))) {
+
+        /* Default: first compatible camera device */
+        retval = getCameraDevicePath(config->path, sizeof(config->path));
+    }
+    else if(0 == strncmp(specification, STR_VID_SRC_TYPE_V4L2 ":", strlen(STR_VID_SRC_TYPE_V4L2 ":"))) {
+
+        strncpy(config->path, specification + strlen(STR_VID_SRC_TYPE_V4L2 ":"), sizeof(config->path) - 1);
+        specificationValid = ('\0' != config->path[0]);
+    }
+    else if(0 == strncmp(specification, STR_VID_SRC_TYPE_TEST ":", strlen(STR_VID_SRC_TYPE_TEST ":"))) {
+
+        /* Size and framerate are optional, so is the frame limit after them */
+        config->type = VIDEO_SRC_TEST;
+        typeName = STR_VID_SRC_TYPE_TEST;
+        fields = sscanf(specification + strlen(STR_VID_SRC_TYPE_TEST ":"), "%7[^:]:%dx%d@%d:%d",
+            formatName, &config->width, &config->height, &config->framerate, &config->frameLimit);
+        specificationValid = ((1 == fields) || (4 == fields) || ((5 == fields) && (0 < config->frameLimit)));
+    }
+    else if(0 == strncmp(specification, STR_VID_SRC_TYPE_FILE ":", strlen(STR_VID_SRC_TYPE_FILE ":"))) {
+
+        /* The location is the rest of the specification (may contain ':') */
+        config->type = VIDEO_SRC_FILE;
+        typeName = STR_VID_SRC_TYPE_FILE;
+        location = specification + strlen(STR_VID_SRC_TYPE_FILE ":");
+        fields = sscanf(location, "%7[^:]:%dx%d@%d:%n",
+            formatName, &config->width, &config->height, &config->framerate, &consumed);
+        specificationValid = ((4 == fields) && (0 < consumed) && ('\0' != location[consumed]));
+        if(specificationValid) {
+
+            strncpy(config->path, &location[consumed], sizeof(config->path) - 1);
+        }
+    }
+    else {
+
+        specificationValid = FALSE;
+    }
+
+    /* Virtual sources advertise exactly one valid format */
+    if(specificationValid && (VIDEO_SRC_V4L2 != config->type)) {
+
+        config->format = sourceFormatNameToVideoCodingFormat(formatName);
+        specificationValid = ((CAM_FMT_UNK != config->format) && (0 < config->width) && (0 < config->height) && (0 < config->framerate));
+        videoCodingFormatToString(config->format, mediaType, sizeof(mediaType));
+    }
+
+    /* Latency stamp: test sources large enough for the stamp only */
+    latencyStamp = getenv(STR_LATENCY_STAMP_ENV);
+    if(specificationValid && (NULL != latencyStamp) && ('\0' != latencyStamp[0]) && (0 != strcmp(latencyStamp, "0"))) {
+
+        if((VIDEO_SRC_TEST == config->type) &&
+           (NUM_LATENCY_STAMP_COLUMNS * NUM_LATENCY_STAMP_BLOCK <= config->width) &&
+           (NUM_LATENCY_STAMP_ROWS * NUM_LATENCY_STAMP_BLOCK <= config->height)) {
+
+            config->latencyStamp = TRUE;
+        }
+        else {
+
+            LOG_MSG_WRN(LOG_MOD_CAMERA, STR_LOG_MSG_FUNC55_STAMP_IGNORED,
+                NUM_LATENCY_STAMP_COLUMNS * NUM_LATENCY_STAMP_BLOCK, NUM_LATENCY_STAMP_ROWS * NUM_LATENCY_STAMP_BLOCK);
+        }
+    }
+
+    if(!specificationValid) {
+
+        LOG_MSG_ERR(LOG_MOD_CAMERA, STR_LOG_MSG_FUNC55_SPEC_INVAL, specification);
+        retval = -1;
+    }
+    else if(0 == retval) {
+
+        LOG_MSG_INF(LOG_MOD_CAMERA, STR_LOG_MSG_FUNC55_SOURCE_INFO, typeName, mediaType,
+            config->width, config->height, config->framerate, config->path, config->latencyStamp, config->frameLimit);
+    }
+
+    return retval;
+}
+
+GstElement* createVideoSource(const VideoSourceConfig_T *config, const char *name) {
+
+    GstCaps *capsConfig = NULL;
+    GstPad *sourcePad = NULL;
+    GstElement *videoSource = NULL;
+    GstElement *source = NULL;
+    GstElement *capsfilter = NULL;
+    GstElement *converter = NULL;
+    GstElement *pacer = NULL;
+    GstElement *last = NULL;
+    LatencyStamp_T *stamp = NULL;
+
+    if((NULL == config) || (NULL == name)) {
+
+        createLogMessage(STR_LOG_MSG_FUNC56_ARG_INVAL, LOG_SVRTY_ERR);
+        return NULL;
+    }
+
+    /* Camera device */
+    if(VIDEO_SRC_V4L2 == config->type) {
+
+        videoSource = gst_element_factory_make("v4l2src", name);
+        if(NULL == videoSource) {
+
+            createLogMessage(STR_LOG_MSG_FUNC56_CREAT_ELEM_FAIL, LOG_SVRTY_ERR);
+            return NULL;
+        }
+
+        g_object_set(videoSource, "device", config->path, NULL);
+        return videoSource;
+    }
+
+    /*
+     * Virtual sources:
+     *
+     * test: videotestsrc ! capsfilter (raw, latency stamp probe) [! jpegenc | x264enc]
+     * file: multifilesrc [! jpegparse | h264parse] ! identity (paced to the clock)
+     */
+    videoSource = gst_bin_new(name);
+    if(VIDEO_SRC_TEST == config->type) {
+
+        source = gst_element_factory_make("videotestsrc", NULL);
+        capsfilter = gst_element_factory_make("capsfilter", NULL);
+        if(CAM_FMT_JPEG == config->format) {
+
+            converter = gst_element_factory_make("jpegenc", NULL);
+        }
+        else if(CAM_FMT_H264 == config->format) {
+
+            converter = gst_element_factory_make("x264enc", NULL);
+        }
+    }
+    else {
+
+        source = gst_element_factory_make("multifilesrc", NULL);
+        pacer = gst_element_factory_make("identity", NULL);
+        if(CAM_FMT_JPEG == config->format) {
+
+            converter = gst_element_factory_make("jpegparse", NULL);
+        }
+        else if(CAM_FMT_H264 == config->format) {
+
+            converter = gst_element_factory_make("h264parse", NULL);
+        }
+    }
+
+    if(!videoSource || !source || ((VIDEO_SRC_TEST == config->type) && !capsfilter) || ((VIDEO_SRC_FILE == config->type) && !pacer) ||
+       ((CAM_FMT_RAW != config->format) && !converter)) {
+
+        createLogMessage(STR_LOG_MSG_FUNC56_CREAT_ELEM_FAIL, LOG_SVRTY_ERR);
+
+        /* Elements are not in the bin yet: release them one by one */
+        g_clear_object(&videoSource);
+        g_clear_object(&source);
+        g_clear_object(&capsfilter);
+        g_clear_object(&converter);
+        g_clear_object(&pacer);
+        return NULL;
+    }
+
+    /* Configure, add and link the elements in stream order */
+    if(VIDEO_SRC_TEST == config->type) {
+
+        g_object_set(source, "is-live", TRUE, NULL);
+        gst_util_set_object_arg(G_OBJECT(source), "pattern", "ball");
+        if(0 < config->frameLimit) {
+
+            /* End of stream after the limit (handled as a pipeline error by the streamer) */
+            g_object_set(source, "num-buffers", (gint)(config->frameLimit), NULL);
+        }
+
+        capsConfig = createVideoSourceCaps(config, CAM_FMT_RAW);
+        if(config->latencyStamp) {
+
+            /* The stamp is written into a known plane layout */
+            gst_caps_set_simple(capsConfig, "format", G_TYPE_STRING, STR_VID_SRC_STAMP_FORMAT, NULL);
+        }
+        g_object_set(capsfilter, "caps", capsConfig, NULL);
+        gst_caps_unref(capsConfig);
+
+        if(CAM_FMT_H264 == config->format) {
+
+            /* Encode like a camera would: no lookahead, a keyframe every second */
+            gst_util_set_object_arg(G_OBJECT(converter), "tune", "zerolatency");
+            gst_util_set_object_arg(G_OBJECT(converter), "speed-preset", "ultrafast");
+            g_object_set(converter, "key-int-max", (guint)(config->framerate), NULL);
+        }
+
+        gst_bin_add_many(GST_BIN(videoSource), source, capsfilter, NULL);
+        last = capsfilter;
+        if(TRUE != gst_element_link(source, capsfilter)) {
+
+            last = NULL;
+        }
+
+        if(config->latencyStamp) {
+
+            /* Stamp the raw frames before they are encoded (the pad owns the state) */
+            stamp = g_new0(LatencyStamp_T, 1);
+            stamp->width = config->width;
+            stamp->height = config->height;
+            sourcePad = gst_element_get_static_pad(capsfilter, "src");
+            gst_pad_add_probe(sourcePad, GST_PAD_PROBE_TYPE_BUFFER, latencyStampProbe, stamp, g_free);
+            gst_object_unref(sourcePad);
+            sourcePad = NULL;
+        }
+    }
+    else {
+
+        capsConfig = createVideoSourceCaps(config, config->format);
+        g_object_set(source, "location", config->path, "loop", TRUE, "caps", capsConfig, NULL);
+        gst_caps_unref(capsConfig);
+        g_object_set(pacer, "sync", TRUE, NULL);
+
+        gst_bin_add(GST_BIN(videoSource), source);
+        last = source;
+    }
+
+    if((NULL != last) && (NULL != converter)) {
+
+        gst_bin_add(GST_BIN(videoSource), converter);
+        last = (TRUE == gst_element_link(last, converter)) ? converter : NULL;
+    }
+
+    if((NULL != last) && (NULL != pacer)) {
+
+        gst_bin_add(GST_BIN(videoSource), pacer);
+        last = (TRUE == gst_element_link(last, pacer)) ? pacer : NULL;
+    }
+
+    if(NULL == last) {
+
+        createLogMessage(STR_LOG_MSG_FUNC56_LINK_FAIL, LOG_SVRTY_ERR);
+        gst_object_unref(videoSource);
+        return NULL;
+    }
+
+    /* Expose the last element's source pad as the bin's 'src' pad */
+    sourcePad = gst_element_get_static_pad(last, "src");
+    if((NULL == sourcePad) || (TRUE != gst_element_add_pad(videoSource, gst_ghost_pad_new("src", sourcePad)))) {
+
+        createLogMessage(STR_LOG_MSG_FUNC56_GHOST_PAD_FAIL, LOG_SVRTY_ERR);
+        g_clear_object(&sourcePad);
+        gst_object_unref(videoSource);
+        return NULL;
+    }
+    gst_object_unref(sourcePad);
+
+    return videoSource;
+}
+
+int getVideoSourceCapabilities(const VideoSourceConfig_T *config, VideoCodingFormatContext_T *ctx) {
+
+    int retval = 0;
+    GstCaps *capabilities = NULL;
+
+    if((NULL == config) || (NULL == ctx) || (VIDEO_SRC_V4L2 == config->type)) {
+
+        createLogMessage(STR_LOG_MSG_FUNC57_ARG_INVAL, LOG_SVRTY_ERR);
+        retval = -1;
+        return retval;
+    }
+
+    capabilities = createVideoSourceCaps(config, config->format);
+    if(NULL == capabilities) {
+
+        createLogMessage(STR_LOG_MSG_FUNC57_CAPS_CREAT_FAIL, LOG_SVRTY_ERR);
+        retval = -1;
+        return retval;
+    }
+
+    retval = parseCameraCapabilities(capabilities, ctx);
+    gst_caps_unref(capabilities);
+
+    return retval;
+}
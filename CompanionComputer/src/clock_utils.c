@@ -0,0 +1,698 @@
+/**
+ * @file        clock_utils.c
+ * @author      Adam Csizy
+ * @date        2021-05-31
+ * @version     v1.1.0
+ *
+ * @brief       Ground control clock synchronization utilities
+ */
+
+
+#include <errno.h>
+#include <gst/gst.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "clock_utils.h"
+#include "log_utils.h"
+
+
+/* Clock synchronization related macro definitions */
+
+#define NUM_CLOCK_INTERVAL_MAX_MS       60000UL     /**< Maximum exchange interval in milliseconds */
+#define NUM_CLOCK_DELAY_MAX_NS          2000000000LL /**< Exchanges with a longer round trip are dropped */
+#define NUM_CLOCK_DELAY_MARGIN_NS       1000000ULL  /**< Exchanges up to twice the smallest delay plus this margin are used */
+#define NUM_CLOCK_FIT_MIN               4U          /**< Minimum number of exchanges of a drift estimate */
+#define NUM_CLOCK_FIT_SPAN_NS           10000000000ULL /**< Minimum time covered by the exchanges of a drift estimate */
+#define NUM_CLOCK_FIT_PASSES            2U          /**< Outlier removal passes of the drift estimate */
+#define NUM_CLOCK_OUTLIER_FACTOR        3.0         /**< Exchanges off the line by more than this times the median deviation ... */
+#define NUM_CLOCK_OUTLIER_MIN_NS        20000.0     /**< ... plus this are outliers */
+#define NUM_CLOCK_DRIFT_MAX_PPB         500000.0    /**< Drift estimates are limited to +-500 ppm */
+#define NUM_CLOCK_STEP_NS               50000000LL  /**< Offset change of a clean exchange taken for a step of the ground clock */
+#define NUM_CLOCK_STEP_CONFIRM          3U          /**< Consecutive stepped exchanges restarting the estimation */
+#define NUM_RTP_HEADER_SIZE             12U         /**< Size of the fixed RTP header */
+#define NUM_RTP_VERSION                 2U          /**< RTP version */
+#define NUM_NSEC_PER_MSEC               1000000ULL  /**< Nanoseconds in a millisecond */
+
+
+/* Clock synchronization related static type declarations */
+
+/**
+ * @brief   Struct of a clock exchange's result.
+ */
+typedef struct ClockSample {
+
+    uint64_t localNs;       /**< Local time of the middle of the exchange */
+    int64_t offsetNs;       /**< Ground time minus local time */
+    uint64_t delayNs;       /**< Round trip delay */
+
+} ClockSample_T;
+
+/**
+ * @brief   Struct of the clock model.
+ *
+ * @details ground = local + offsetNs + (local - refNs) * driftPpb / 1e9
+ */
+typedef struct ClockModel {
+
+    int valid;                  /**< Flag whether the model is set */
+    uint64_t refNs;             /**< Local reference time */
+    int64_t offsetNs;           /**< Offset at the reference time */
+    double driftPpb;            /**< Drift in parts per billion */
+    uint64_t delayNs;           /**< Smallest round trip delay of the exchanges */
+    uint64_t uncertaintyNs;     /**< Error bound */
+    unsigned int samples;       /**< Exchanges the model is made of */
+    uint64_t updatedNs;         /**< Local time of the last exchange used */
+
+} ClockModel_T;
+
+/**
+ * @brief   Struct of the RTP clock mapping probe's state.
+ */
+typedef struct ClockMappingProbe {
+
+    GstElement *payloader;      /**< Payloader (owns the probed pad) */
+    uint64_t mappedNs;          /**< Local time of the last mapping */
+
+} ClockMappingProbe_T;
+
+
+/* Clock synchronization related static variable declarations */
+
+static ClockSample_T samples[NUM_CLOCK_SAMPLES];    /**< Ring of the latest exchanges */
+static unsigned int sampleCount = 0;                /**< Number of exchanges in the ring */
+static unsigned int sampleNext = 0;                 /**< Ring index of the next exchange */
+static unsigned int stepCount = 0;                  /**< Consecutive exchanges off the model by a step */
+static ClockModel_T model = {0};                    /**< Current clock model */
+static int requestPending = 0;                      /**< Flag whether a response is awaited */
+static uint64_t requestOriginNs = 0;                /**< Origin time of the latest request */
+static uint64_t nextRequestNs = 0;                  /**< Local time the next request is due */
+static unsigned int burstLeft = NUM_CLOCK_BURST_EXCHANGES; /**< Exchanges left at the burst interval */
+static uint64_t intervalNs = NUM_CLOCK_INTERVAL_MS * NUM_NSEC_PER_MSEC; /**< Exchange interval */
+static atomic_int clockEnabled = 0;                 /**< Flag whether clock synchronization runs */
+static ClockMapping_T latestMapping;                /**< Latest RTP clock mapping */
+static int mappingPending = 0;                      /**< Flag whether the mapping is not sent yet */
+static pthread_mutex_t clockLock = PTHREAD_MUTEX_INITIALIZER;  /**< Lock of the exchanges, the model and the mapping */
+
+
+/* Clock synchronization related static function declarations */
+
+/**
+ * @brief       Convert local time to ground time.
+ *
+ * @note        The clock lock must be held.
+ *
+ * @param[in]   localNs Local time.
+ *
+ * @return      Ground time (the model must be valid).
+ */
+static uint64_t applyClockModel(const uint64_t localNs);
+
+/**
+ * @brief       Fit line to clock exchanges.
+ *
+ * @details     Least squares line of the exchanges' offsets (relative
+ *              to the base offset) over their local times (relative
+ *              to the reference time).
+ *
+ * @param[in]   used Exchanges.
+ * @param[in]   count Number of exchanges.
+ * @param[in]   refNs Local reference time.
+ * @param[in]   baseNs Base offset.
+ * @param[out]  slope Drift in parts per billion.
+ * @param[out]  intercept Offset at the reference time relative to the base offset.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure (too few exchanges or too short time covered)
+ */
+static int fitClockLine(const ClockSample_T *const used[], const unsigned int count, const uint64_t refNs,
+                        const int64_t baseNs, double *slope, double *intercept);
+
+/**
+ * @brief       Update clock model.
+ *
+ * @details     Keeps the exchanges whose delay is near the smallest
+ *              one, fits a line to their offsets and drops the
+ *              exchanges far off the line before fitting again.
+ *              Without enough exchanges for a line, the offset of the
+ *              exchange with the smallest delay is taken with the
+ *              previous drift.
+ *
+ * @note        The clock lock must be held, the ring must not be empty.
+ */
+static void updateClockModel(void);
+
+/**
+ * @brief       Compare two doubles (qsort).
+ */
+static int compareDouble(const void *a, const void *b);
+
+/**
+ * @brief       RTP clock mapping buffer probe.
+ *
+ * @details     Maps the RTP timestamp of a packet (the first of a
+ *              list) to the ground time of its presentation
+ *              timestamp every NUM_CLOCK_MAP_INTERVAL_MS. Invoked in
+ *              the streaming thread of the payloader.
+ *
+ * @param[in]   pad Source pad of the payloader.
+ * @param[in]   info Probe info holding the packet(s).
+ * @param[in,out]   data Probe state (ClockMappingProbe_T).
+ *
+ * @return      GST_PAD_PROBE_OK (pass the packets).
+ */
+static GstPadProbeReturn clockMappingProbe(GstPad *pad, GstPadProbeInfo *info, gpointer data);
+
+
+/* Clock synchronization related function definitions */
+
+int initClockSync(void) {
+
+    int retval = 0;
+    unsigned long interval = NUM_CLOCK_INTERVAL_MS;
+    char *end = NULL;
+    const char *text = NULL;
+
+    text = getenv(STR_CLOCK_ENV_INTERVAL);
+    if((NULL != text) && ('\0' != text[0])) {
+
+        errno = 0;
+        interval = strtoul(text, &end, 10);
+        if((0 != errno) || ('\0' != *end) || (NUM_CLOCK_INTERVAL_MAX_MS < interval)) {
+
+            LOG_MSG_WRN(LOG_MOD_NETWORK, STR_LOG_MSG_FUNC104_INTERVAL_INVAL, text, NUM_CLOCK_INTERVAL_MS);
+            interval = NUM_CLOCK_INTERVAL_MS;
+            retval = -1;
+        }
+    }
+
+    if(0UL == interval) {
+
+        LOG_MSG_INF(LOG_MOD_NETWORK, STR_LOG_MSG_FUNC104_DISABLED);
+        return retval;
+    }
+
+    intervalNs = (uint64_t)(interval) * NUM_NSEC_PER_MSEC;
+    atomic_store(&clockEnabled, 1);
+
+    return retval;
+}
+
+void restartClockSync(void) {
+
+    pthread_mutex_lock(&clockLock);
+
+    sampleCount = 0;
+    sampleNext = 0;
+    stepCount = 0;
+    memset(&model, 0, sizeof(model));
+    requestPending = 0;
+    nextRequestNs = 0;
+    burstLeft = NUM_CLOCK_BURST_EXCHANGES;
+    mappingPending = 0;
+
+    pthread_mutex_unlock(&clockLock);
+}
+
+int takeClockRequest(ClockExchange_T *exchange, unsigned int *delayMs) {
+
+    int retval = 0;
+    uint64_t now;
+
+    if(!atomic_load(&clockEnabled)) {
+
+        retval = -1;
+        return retval;
+    }
+
+    pthread_mutex_lock(&clockLock);
+
+    now = getLocalClockNs();
+    if(now < nextRequestNs) {
+
+        *delayMs = (unsigned int)((nextRequestNs - now + NUM_NSEC_PER_MSEC - 1ULL) / NUM_NSEC_PER_MSEC);
+        retval = 1;
+    }
+    else {
+
+        if(0U < burstLeft) {
+
+            --burstLeft;
+            nextRequestNs = now + NUM_CLOCK_BURST_INTERVAL_MS * NUM_NSEC_PER_MSEC;
+        }
+        else {
+
+            nextRequestNs = now + intervalNs;
+        }
+
+        /* A response to an older request is stale from now on */
+        requestPending = 1;
+        requestOriginNs = now;
+
+        exchange->originNs = now;
+        exchange->receiveNs = 0ULL;
+        exchange->transmitNs = 0ULL;
+    }
+
+    pthread_mutex_unlock(&clockLock);
+
+    return retval;
+}
+
+int processClockResponse(const ClockExchange_T *exchange, const uint64_t arrivalNs) {
+
+    int retval = 0;
+    int64_t delay, offset, predicted;
+    ClockSample_T sample;
+
+    if(NULL == exchange) {
+
+        retval = -1;
+        return retval;
+    }
+
+    pthread_mutex_lock(&clockLock);
+
+    if((!requestPending) || (exchange->originNs != requestOriginNs) || (arrivalNs < exchange->originNs) ||
+       (exchange->transmitNs < exchange->receiveNs)) {
+
+        /* Stale (restarted meanwhile) or the ground clock stepped within the exchange */
+        pthread_mutex_unlock(&clockLock);
+        retval = -1;
+        return retval;
+    }
+    requestPending = 0;
+
+    delay = (int64_t)(arrivalNs - exchange->originNs) - (int64_t)(exchange->transmitNs - exchange->receiveNs);
+    if(0 > delay) {
+
+        /* Ground clock faster than the local one within the exchange */
+        delay = 0;
+    }
+    if(NUM_CLOCK_DELAY_MAX_NS < delay) {
+
+        pthread_mutex_unlock(&clockLock);
+        retval = -1;
+        return retval;
+    }
+
+    /* Each half fits in 63 bits (ground time since 1970 minus local time since boot) */
+    offset = (int64_t)(exchange->receiveNs - exchange->originNs) / 2 + (int64_t)(exchange->transmitNs - arrivalNs) / 2;
+
+    sample.localNs = exchange->originNs + (arrivalNs - exchange->originNs) / 2ULL;
+    sample.offsetNs = offset;
+    sample.delayNs = (uint64_t)(delay);
+
+    /* A clean exchange far off the model: outlier, or the ground clock stepped */
+    if(model.valid && ((uint64_t)(delay) <= 2ULL * model.delayNs + NUM_CLOCK_DELAY_MARGIN_NS)) {
+
+        predicted = (int64_t)(applyClockModel(sample.localNs) - sample.localNs);
+        if(NUM_CLOCK_STEP_NS < llabs(offset - predicted)) {
+
+            if(NUM_CLOCK_STEP_CONFIRM > ++stepCount) {
+
+                pthread_mutex_unlock(&clockLock);
+                retval = -1;
+                return retval;
+            }
+
+            LOG_MSG_WRN(LOG_MOD_NETWORK, STR_LOG_MSG_FUNC105_STEP, (double)(offset - predicted) / 1e6);
+            sampleCount = 0;
+            sampleNext = 0;
+            model.valid = 0;
+        }
+        stepCount = 0;
+    }
+
+    samples[sampleNext] = sample;
+    sampleNext = (sampleNext + 1U) % NUM_CLOCK_SAMPLES;
+    if(NUM_CLOCK_SAMPLES > sampleCount) {
+
+        ++sampleCount;
+    }
+
+    if(!model.valid) {
+
+        updateClockModel();
+        LOG_MSG_INF(LOG_MOD_NETWORK, STR_LOG_MSG_FUNC105_SYNCHRONIZED, (double)(model.offsetNs) / 1e6,
+            (double)(model.delayNs) / 1e6, (unsigned int)(model.uncertaintyNs / 1000ULL));
+    }
+    else {
+
+        updateClockModel();
+    }
+    model.updatedNs = arrivalNs;
+
+    pthread_mutex_unlock(&clockLock);
+
+    return retval;
+}
+
+uint64_t getLocalClockNs(void) {
+
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)(now.tv_sec) * 1000000000ULL + (uint64_t)(now.tv_nsec);
+}
+
+int convertToGroundTime(const uint64_t localNs, uint64_t *groundNs) {
+
+    int retval = 0;
+
+    if(NULL == groundNs) {
+
+        retval = -1;
+        return retval;
+    }
+
+    pthread_mutex_lock(&clockLock);
+
+    if(model.valid) {
+
+        *groundNs = applyClockModel(localNs);
+    }
+    else {
+
+        retval = -1;
+    }
+
+    pthread_mutex_unlock(&clockLock);
+
+    return retval;
+}
+
+int getGroundTimeNs(uint64_t *groundNs) {
+
+    return convertToGroundTime(getLocalClockNs(), groundNs);
+}
+
+int getClockSyncStatus(ClockSyncStatus_T *status) {
+
+    int retval = 0;
+    uint64_t now;
+
+    if(NULL == status) {
+
+        retval = -1;
+        return retval;
+    }
+
+    memset(status, 0, sizeof(*status));
+
+    pthread_mutex_lock(&clockLock);
+
+    if(model.valid) {
+
+        now = getLocalClockNs();
+        status->synchronized = 1;
+        status->offsetNs = (int64_t)(applyClockModel(now) - now);
+        status->driftPpb = (int32_t)(lround(model.driftPpb));
+        status->delayNs = (uint32_t)(model.delayNs);
+        status->uncertaintyNs = (uint32_t)(model.uncertaintyNs);
+        status->samples = model.samples;
+        status->ageMs = (now - model.updatedNs) / NUM_NSEC_PER_MSEC;
+    }
+
+    pthread_mutex_unlock(&clockLock);
+
+    return retval;
+}
+
+int attachClockMapping(struct _GstElement *payloader) {
+
+    int retval = 0;
+    GstPad *pad = NULL;
+    ClockMappingProbe_T *state = NULL;
+
+    if(!atomic_load(&clockEnabled)) {
+
+        return retval;
+    }
+
+    if(NULL == payloader) {
+
+        LOG_MSG_ERR(LOG_MOD_NETWORK, STR_LOG_MSG_FUNC106_ARG_INVAL);
+        retval = -1;
+        return retval;
+    }
+
+    pad = gst_element_get_static_pad(payloader, "src");
+    if(NULL == pad) {
+
+        LOG_MSG_WRN(LOG_MOD_NETWORK, STR_LOG_MSG_FUNC106_PAD_FAIL);
+        retval = -1;
+        return retval;
+    }
+
+    /* The payloader outlives the probe of its own pad: no reference needed */
+    state = g_new0(ClockMappingProbe_T, 1);
+    state->payloader = payloader;
+    gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST, clockMappingProbe, state, g_free);
+    gst_object_unref(pad);
+
+    return retval;
+}
+
+int takeClockMapping(ClockMapping_T *mapping) {
+
+    int retval = 1;
+
+    pthread_mutex_lock(&clockLock);
+
+    if(mappingPending) {
+
+        *mapping = latestMapping;
+        mappingPending = 0;
+        retval = 0;
+    }
+
+    pthread_mutex_unlock(&clockLock);
+
+    return retval;
+}
+
+static uint64_t applyClockModel(const uint64_t localNs) {
+
+    return localNs + (uint64_t)(model.offsetNs + (int64_t)(llround((double)((int64_t)(localNs - model.refNs)) * model.driftPpb / 1e9)));
+}
+
+static int fitClockLine(const ClockSample_T *const used[], const unsigned int count, const uint64_t refNs,
+                        const int64_t baseNs, double *slope, double *intercept) {
+
+    unsigned int i;
+    double x, y, meanX = 0.0, meanY = 0.0, sxx = 0.0, sxy = 0.0;
+    uint64_t first = UINT64_MAX, last = 0ULL;
+
+    for(i = 0;i < count;++i) {
+
+        first = (used[i]->localNs < first) ? used[i]->localNs : first;
+        last = (used[i]->localNs > last) ? used[i]->localNs : last;
+    }
+    if((NUM_CLOCK_FIT_MIN > count) || (NUM_CLOCK_FIT_SPAN_NS > last - first)) {
+
+        return -1;
+    }
+
+    /* Seconds against nanoseconds: the slope is in parts per billion */
+    for(i = 0;i < count;++i) {
+
+        meanX += (double)((int64_t)(used[i]->localNs - refNs)) / 1e9;
+        meanY += (double)(used[i]->offsetNs - baseNs);
+    }
+    meanX /= (double)(count);
+    meanY /= (double)(count);
+
+    for(i = 0;i < count;++i) {
+
+        x = (double)((int64_t)(used[i]->localNs - refNs)) / 1e9 - meanX;
+        y = (double)(used[i]->offsetNs - baseNs) - meanY;
+        sxx += x * x;
+        sxy += x * y;
+    }
+
+    *slope = sxy / sxx;
+    if(NUM_CLOCK_DRIFT_MAX_PPB < fabs(*slope)) {
+
+        *slope = copysign(NUM_CLOCK_DRIFT_MAX_PPB, *slope);
+    }
+    *intercept = meanY - *slope * meanX;
+
+    return 0;
+}
+
+static void updateClockModel(void) {
+
+    unsigned int i, count = 0, kept, pass;
+    uint64_t minDelay = UINT64_MAX;
+    double slope = model.valid ? model.driftPpb : 0.0;
+    double intercept = 0.0;
+    double x, residual, median, sumSquares = 0.0;
+    double deviations[NUM_CLOCK_SAMPLES];
+    double sorted[NUM_CLOCK_SAMPLES];
+    const ClockSample_T *best = NULL;
+    const ClockSample_T *used[NUM_CLOCK_SAMPLES];
+
+    /* Smallest delay: the exchange waited least on the way */
+    for(i = 0;i < sampleCount;++i) {
+
+        if(samples[i].delayNs < minDelay) {
+
+            minDelay = samples[i].delayNs;
+            best = &samples[i];
+        }
+    }
+
+    for(i = 0;i < sampleCount;++i) {
+
+        if(samples[i].delayNs <= 2ULL * minDelay + NUM_CLOCK_DELAY_MARGIN_NS) {
+
+            used[count++] = &samples[i];
+        }
+    }
+
+    if(0 == fitClockLine(used, count, best->localNs, best->offsetNs, &slope, &intercept)) {
+
+        for(pass = 0;pass < NUM_CLOCK_FIT_PASSES;++pass) {
+
+            for(i = 0;i < count;++i) {
+
+                x = (double)((int64_t)(used[i]->localNs - best->localNs)) / 1e9;
+                deviations[i] = fabs((double)(used[i]->offsetNs - best->offsetNs) - (intercept + slope * x));
+                sorted[i] = deviations[i];
+            }
+            qsort(sorted, count, sizeof(sorted[0]), compareDouble);
+            median = sorted[count / 2U];
+
+            kept = 0;
+            for(i = 0;i < count;++i) {
+
+                if(deviations[i] <= NUM_CLOCK_OUTLIER_FACTOR * median + NUM_CLOCK_OUTLIER_MIN_NS) {
+
+                    used[kept++] = used[i];
+                }
+            }
+
+            /* The previous line stays if too few exchanges are left */
+            if((kept == count) || fitClockLine(used, kept, best->localNs, best->offsetNs, &slope, &intercept)) {
+
+                break;
+            }
+            count = kept;
+        }
+    }
+    else {
+
+        /* Not enough for a line: offset of the best exchange, previous drift */
+        count = 1U;
+        used[0] = best;
+    }
+
+    for(i = 0;i < count;++i) {
+
+        x = (double)((int64_t)(used[i]->localNs - best->localNs)) / 1e9;
+        residual = (double)(used[i]->offsetNs - best->offsetNs) - (intercept + slope * x);
+        sumSquares += residual * residual;
+    }
+
+    model.valid = 1;
+    model.refNs = best->localNs;
+    model.offsetNs = best->offsetNs + (int64_t)(llround(intercept));
+    model.driftPpb = slope;
+    model.delayNs = minDelay;
+    model.uncertaintyNs = minDelay / 2ULL + (uint64_t)(llround(sqrt(sumSquares / (double)(count))));
+    model.samples = count;
+}
+
+static int compareDouble(const void *a, const void *b) {
+
+    double left = *(const double*)(a);
+    double right = *(const double*)(b);
+
+    return (left > right) - (left < right);
+}
+
+static GstPadProbeReturn clockMappingProbe(GstPad *pad, GstPadProbeInfo *info, gpointer data) {
+
+    guint8 header[NUM_RTP_HEADER_SIZE];
+    guint64 runningTime;
+    uint64_t now, groundNs;
+    int64_t captureNs;
+    GstClockTime clockNow;
+    GstClock *clock = NULL;
+    GstEvent *event = NULL;
+    const GstSegment *segment = NULL;
+    GstBuffer *buffer = NULL;
+    ClockMappingProbe_T *state = (ClockMappingProbe_T*)(data);
+
+    now = getLocalClockNs();
+    if((0ULL != state->mappedNs) && (NUM_CLOCK_MAP_INTERVAL_MS * NUM_NSEC_PER_MSEC > now - state->mappedNs)) {
+
+        return GST_PAD_PROBE_OK;
+    }
+
+    if(GST_PAD_PROBE_INFO_TYPE(info) & GST_PAD_PROBE_TYPE_BUFFER_LIST) {
+
+        buffer = (0U < gst_buffer_list_length(GST_PAD_PROBE_INFO_BUFFER_LIST(info))) ?
+            gst_buffer_list_get(GST_PAD_PROBE_INFO_BUFFER_LIST(info), 0) : NULL;
+    }
+    else {
+
+        buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+    }
+
+    if((NULL == buffer) || (!GST_BUFFER_PTS_IS_VALID(buffer)) ||
+       (sizeof(header) != gst_buffer_extract(buffer, 0, header, sizeof(header))) || (NUM_RTP_VERSION != (header[0] >> 6))) {
+
+        return GST_PAD_PROBE_OK;
+    }
+
+    /* Presentation timestamp to running time to pipeline clock time */
+    event = gst_pad_get_sticky_event(pad, GST_EVENT_SEGMENT, 0);
+    if(NULL == event) {
+
+        return GST_PAD_PROBE_OK;
+    }
+    gst_event_parse_segment(event, &segment);
+    runningTime = gst_segment_to_running_time(segment, GST_FORMAT_TIME, GST_BUFFER_PTS(buffer));
+    gst_event_unref(event);
+
+    clock = gst_element_get_clock(state->payloader);
+    if((NULL == clock) || (!GST_CLOCK_TIME_IS_VALID(runningTime))) {
+
+        if(clock) {
+            gst_object_unref(clock);
+        }
+        return GST_PAD_PROBE_OK;
+    }
+    clockNow = gst_clock_get_time(clock);
+    now = getLocalClockNs();
+    gst_object_unref(clock);
+
+    /* Pipeline clock to local clock (the same clock unless another element provides one) */
+    captureNs = (int64_t)(now) - ((int64_t)(clockNow) - (int64_t)(gst_element_get_base_time(state->payloader) + runningTime));
+
+    pthread_mutex_lock(&clockLock);
+
+    if(model.valid && (0 < captureNs)) {
+
+        groundNs = applyClockModel((uint64_t)(captureNs));
+        latestMapping.ssrc = ((guint32)(header[8]) << 24) | ((guint32)(header[9]) << 16) | ((guint32)(header[10]) << 8) | (guint32)(header[11]);
+        latestMapping.rtpTimestamp = ((guint32)(header[4]) << 24) | ((guint32)(header[5]) << 16) | ((guint32)(header[6]) << 8) | (guint32)(header[7]);
+        latestMapping.groundNs = groundNs;
+        latestMapping.uncertaintyUs = (uint32_t)(model.uncertaintyNs / 1000ULL);
+        mappingPending = 1;
+        state->mappedNs = now;
+    }
+
+    pthread_mutex_unlock(&clockLock);
+
+    return GST_PAD_PROBE_OK;
+}
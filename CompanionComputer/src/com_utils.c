@@ -8,20 +8,31 @@
  */
 
 
+#include <errno.h>
+#include <linux/sockios.h>
 #include <netdb.h>
 #include <poll.h>
 #include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/ioctl.h>
 #include <sys/types.h>
 #include <sys/socket.h>
-#include <syslog.h>
+#include <time.h>
 #include <unistd.h>
 
+#include "clock_utils.h"
 #include "com_utils.h"
 #include "log_utils.h"
+#include "recorder_utils.h"
+#include "startup_utils.h"
+#include "trace_utils.h"
+#include "qos_utils.h"
+#include "sched_utils.h"
+#include "snapshot_utils.h"
 #include "stream_utils.h"
+#include "telemetry_utils.h"
 
 
 /* Communication related macro definitions */
@@ -31,7 +42,13 @@
 
 #define STR_FORMAT_MOD_MSG          "\nModule Message:\n\tAddress: %d\n\tCode: %d\n"    /**< Module message string format */
 #define SOCK_FD_INVAL               -1  /**< Invalid socket file descriptor */
+#ifndef IPPROTO_MPTCP
+#define IPPROTO_MPTCP               262 /**< Multipath TCP protocol number (older libc headers, Linux 5.6+) */
+#endif
 #define RECONNECT_COOLDOWN_SEC      10U /**< Cooldown in seconds before initiating a reconnection to the ground control */
+#define RECONNECT_LOG_BURST         3U  /**< Number of records a connection log site may emit per RECONNECT_LOG_WINDOW_SEC */
+#define RECONNECT_LOG_WINDOW_SEC    600U /**< Rate window of connection log sites in seconds (the retry loop runs forever) */
+#define LOG_MSG_CONN(level, ...)    LOG_MSG_RATE_##level(LOG_MOD_NETWORK, RECONNECT_LOG_BURST, RECONNECT_LOG_WINDOW_SEC, __VA_ARGS__) /**< Log a record of the (re)connection path (level: ERR, WRN, INF or DBG) */
 #define NUM_GC_ADDR_SIZE            64U /**< Size of ground control address string */
 #define NUM_GC_PORT_SIZE            16U /**< Size of ground control port string */
 #define STR_GC_ADDR_DEFAULT_LAN     "195.441.0.134" /**< Default address of ground control (LAN) */
@@ -42,12 +59,44 @@
 #define NUM_POLL_ARRAY_SIZE         1U  /**< Size of poll array */
 #define IDX_SOCK                    0U  /**< Socket index */
 #define NUM_NETWORK_MSGQ_SIZE       16U /**< Size of network module's message queue */
+#define MessageDataField_T          uint32_t    /**< Type of the data field of network messages */
 #define NUM_MSG_HEADER_SIZE         2U  /**< Size of message header array in MessageHeaderField_T */
 #define IDX_MSG_HEADER_MODULE       0U  /**< Index of module name in message header array */
 #define IDX_MSG_HEADER_CODE         1U  /**< Index of module message code in message header array */
 #define NUM_LOGIN_MSG_SIZE          2U  /**< Size of login message array in LoginMessageField_T */
 #define IDX_LOGIN_MSG_CODE          0U  /**< Index of module message code in login message array */
 #define IDX_LOGIN_MSG_ID            1U  /**< Index of drone ID in login message array */
+#define NUM_TELEMETRY_MSG_FIELDS    5U  /**< Size of telemetry message data array in MessageDataField_T */
+#define IDX_TELEMETRY_MSG_CHANNEL   0U  /**< Index of telemetry channel in telemetry message data array */
+#define IDX_TELEMETRY_MSG_AGE       1U  /**< Index of sample age in telemetry message data array */
+#define IDX_TELEMETRY_MSG_VALUES    2U  /**< Index of the first sample value in telemetry message data array */
+#define NUM_TELEMETRY_MAX_OUTQ      2048U /**< Telemetry is held back while more unsent bytes are queued on the socket */
+#define NUM_SNAPSHOT_MSG_FIELDS     3U  /**< Size of snapshot (and snapshot data) message data array in MessageDataField_T */
+#define IDX_SNAPSHOT_MSG_ID         0U  /**< Index of snapshot ID in snapshot message data array */
+#define IDX_SNAPSHOT_MSG_SIZE       1U  /**< Index of image size in snapshot message data array */
+#define IDX_SNAPSHOT_MSG_STATUS     2U  /**< Index of status in snapshot message data array */
+#define IDX_SNAPSHOT_MSG_OFFSET     1U  /**< Index of chunk offset in snapshot data message data array */
+#define IDX_SNAPSHOT_MSG_LENGTH     2U  /**< Index of chunk length in snapshot data message data array */
+#define NUM_CLOCK_REQ_MSG_FIELDS    2U  /**< Size of clock request message data array in MessageDataField_T */
+#define NUM_CLOCK_RESP_MSG_FIELDS   6U  /**< Size of clock response message data array in MessageDataField_T */
+#define IDX_CLOCK_MSG_ORIGIN        0U  /**< Index of origin time (high half) in clock message data array */
+#define IDX_CLOCK_MSG_RECEIVE       2U  /**< Index of receive time (high half) in clock response message data array */
+#define IDX_CLOCK_MSG_TRANSMIT      4U  /**< Index of transmit time (high half) in clock response message data array */
+#define NUM_CLOCK_MAP_MSG_FIELDS    5U  /**< Size of RTP clock mapping message data array in MessageDataField_T */
+#define IDX_CLOCK_MAP_MSG_SSRC      0U  /**< Index of SSRC in RTP clock mapping message data array */
+#define IDX_CLOCK_MAP_MSG_RTP       1U  /**< Index of RTP timestamp in RTP clock mapping message data array */
+#define IDX_CLOCK_MAP_MSG_GROUND    2U  /**< Index of ground time (high half) in RTP clock mapping message data array */
+#define IDX_CLOCK_MAP_MSG_UNCERTAINTY 4U /**< Index of uncertainty in RTP clock mapping message data array */
+
+_Static_assert(NUM_NET_MSG_HEADER_SIZE == (NUM_MSG_HEADER_SIZE * sizeof(MessageHeaderField_T)), "Network message header layout changed");
+_Static_assert(NUM_NET_MSG_DATA_SIZE == sizeof(MessageDataField_T), "Network message data layout changed");
+_Static_assert(NUM_NET_MSG_TELEMETRY_SIZE == (NUM_TELEMETRY_MSG_FIELDS * sizeof(MessageDataField_T)), "Telemetry message data layout changed");
+_Static_assert(NUM_TELEMETRY_MSG_FIELDS == (IDX_TELEMETRY_MSG_VALUES + NUM_TELEMETRY_VALUES), "Telemetry message data layout changed");
+_Static_assert(NUM_NET_MSG_SNAPSHOT_SIZE == (NUM_SNAPSHOT_MSG_FIELDS * sizeof(MessageDataField_T)), "Snapshot message data layout changed");
+_Static_assert(NUM_NET_MSG_SNAPSHOT_DATA_SIZE == (NUM_SNAPSHOT_MSG_FIELDS * sizeof(MessageDataField_T)), "Snapshot data message data layout changed");
+_Static_assert(NUM_NET_MSG_CLOCK_REQ_SIZE == (NUM_CLOCK_REQ_MSG_FIELDS * sizeof(MessageDataField_T)), "Clock request message data layout changed");
+_Static_assert(NUM_NET_MSG_CLOCK_RESP_SIZE == (NUM_CLOCK_RESP_MSG_FIELDS * sizeof(MessageDataField_T)), "Clock response message data layout changed");
+_Static_assert(NUM_NET_MSG_CLOCK_MAP_SIZE == (NUM_CLOCK_MAP_MSG_FIELDS * sizeof(MessageDataField_T)), "RTP clock mapping message data layout changed");
 
 /* Communication related global variable declarations */
 
@@ -154,6 +203,26 @@ static void cleanupInputMessages(const int sockFd);
  */
 static int networkToStreamMessage(const int sockFd, const ModuleMessageCode_T code);
 
+/**
+ * @brief       Convert network data to clock response.
+ * 
+ * @details     Reads the clock response of the ground control
+ *              from the network and adds the exchange to the
+ *              clock estimate (see clock_utils.h).
+ *
+ * @note        Not thread safe (network input thread only).
+ * 
+ * @param[in]   sockFd Network socket file descriptor.
+ * @param[in]   code Network module message code.
+ * @param[in]   arrivalNs Local time of the message's arrival.
+ * 
+ * @return      Result of execution.
+ * 
+ * @retval      0 Success (the exchange may still be dropped)
+ * @retval      -1 Failure
+ */
+static int networkToClockMessage(const int sockFd, const ModuleMessageCode_T code, const uint64_t arrivalNs);
+
 /**
  * @brief       Convert GC common module message to network data.
  * 
@@ -175,6 +244,38 @@ static int networkToStreamMessage(const int sockFd, const ModuleMessageCode_T co
  */
 static int gccommonMessageToNetwork(const int *sockFd, const ModuleMessage_T *message);
 
+/**
+ * @brief       Check whether telemetry may be sent.
+ * 
+ * @details     Telemetry is held back while the socket has more
+ *              than NUM_TELEMETRY_MAX_OUTQ unsent bytes queued, so
+ *              samples never pile up in front of control messages
+ *              on a slow link (they are replaced by newer ones
+ *              meanwhile, see publishTelemetry()).
+ * 
+ * @param[in]   sockFd Network socket file descriptor.
+ * 
+ * @return      Non-zero if a telemetry message may be sent.
+ */
+static int isTelemetrySendable(const int sockFd);
+
+/**
+ * @brief       Send snapshot data chunk.
+ * 
+ * @details     Sends the next chunk of a captured snapshot (see
+ *              takeSnapshotChunk()) as a snapshot data message.
+ *              Only called when the link is idle, like telemetry.
+ * 
+ * @param[in]   sockFd Network socket file descriptor.
+ * 
+ * @return      Result of execution.
+ * 
+ * @retval      0 Chunk sent
+ * @retval      1 No snapshot data pending
+ * @retval      -1 Failure (the chunk is lost, the ground control drops the snapshot)
+ */
+static int snapshotDataToNetwork(const int *sockFd);
+
 /**
  * @brief       Start routine of network input handler thread.
  * 
@@ -267,6 +368,10 @@ int initModuleMessageQueue(ModuleMessageQueue_T *messageQueue, const size_t size
                 createLogMessage(STR_LOG_MSG_FUNC7_COND_ATTR_INIT_FAIL, LOG_SVRTY_ERR);
                 retval = -1;
             }
+            else if(pthread_condattr_setclock(&condvarAttribute, CLOCK_MONOTONIC)) {
+                createLogMessage(STR_LOG_MSG_FUNC7_COND_ATTR_SET_CLOCK_FAIL, LOG_SVRTY_ERR);
+                retval = -1;
+            }
             else if(pthread_cond_init(&(messageQueue->update), &condvarAttribute)) {
                 createLogMessage(STR_LOG_MSG_FUNC7_COND_INIT_FAIL, LOG_SVRTY_ERR);
                 retval = -1;
@@ -328,16 +433,19 @@ int insertModuleMessage(ModuleMessageQueue_T *messageQueue, ModuleMessage_T *mes
 
     if((NULL != messageQueue) && (NULL != message)) {
 
+        TRACE_BEGIN(TRACE_MSGQ_INSERT, message->code);
         if(noblock) {
 
             if(pthread_mutex_trylock(&(messageQueue->lock))) {
 
+                TRACE_END(TRACE_MSGQ_INSERT, -2);
                 retval = -2;
                 return retval;
             }
             else if(NULL != messageQueue->messages[messageQueue->front]) {
 
                 pthread_mutex_unlock(&(messageQueue->lock));
+                TRACE_END(TRACE_MSGQ_INSERT, -3);
                 retval = -3;
                 return retval;
             }
@@ -350,10 +458,12 @@ int insertModuleMessage(ModuleMessageQueue_T *messageQueue, ModuleMessage_T *mes
                 pthread_cond_wait(&(messageQueue->update), &(messageQueue->lock));
             }
         }
+        TRACE_FLOW_START(TRACE_MSGQ_MESSAGE, message);
         messageQueue->messages[messageQueue->front] = message;
         messageQueue->front = ((messageQueue->front + 1) & (messageQueue->size - 1));
         pthread_cond_broadcast(&(messageQueue->update));
         pthread_mutex_unlock(&(messageQueue->lock));
+        TRACE_END(TRACE_MSGQ_INSERT, message->code);
     }
     else {
 
@@ -370,16 +480,19 @@ int removeModuleMessage(ModuleMessageQueue_T *messageQueue, ModuleMessage_T* *me
 
     if((NULL != messageQueue) && (NULL != message)) {
 
+        TRACE_BEGIN(TRACE_MSGQ_REMOVE, 0);
         if(noblock) {
 
             if(pthread_mutex_trylock(&(messageQueue->lock))) {
 
+                TRACE_END(TRACE_MSGQ_REMOVE, -2);
                 retval = -2;
                 return retval;
             }
             else if(NULL == messageQueue->messages[messageQueue->back]) {
 
                 pthread_mutex_unlock(&(messageQueue->lock));
+                TRACE_END(TRACE_MSGQ_REMOVE, -3);
                 retval = -3;
                 return retval;
             }
@@ -393,10 +506,12 @@ int removeModuleMessage(ModuleMessageQueue_T *messageQueue, ModuleMessage_T* *me
             }
         }
         *message = messageQueue->messages[messageQueue->back];
+        TRACE_FLOW_END(TRACE_MSGQ_MESSAGE, *message);
         messageQueue->messages[messageQueue->back] = NULL;
         messageQueue->back = ((messageQueue->back + 1) & (messageQueue->size - 1));
         pthread_cond_broadcast(&(messageQueue->update));
         pthread_mutex_unlock(&(messageQueue->lock));
+        TRACE_END(TRACE_MSGQ_REMOVE, (*message)->code);
     }
     else {
 
@@ -407,6 +522,57 @@ int removeModuleMessage(ModuleMessageQueue_T *messageQueue, ModuleMessage_T* *me
     return retval;
 }
 
+int removeModuleMessageTimed(ModuleMessageQueue_T *messageQueue, ModuleMessage_T* *message, const unsigned int timeoutMs) {
+
+    int retval = 0;
+    struct timespec deadline;
+
+    if((NULL == messageQueue) || (NULL == message)) {
+
+        createLogMessage(STR_LOG_MSG_FUNC83_ARG_INVAL, LOG_SVRTY_ERR);
+        retval = -1;
+        return retval;
+    }
+
+    /* The condition variable runs on CLOCK_MONOTONIC (see initModuleMessageQueue()) */
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += (time_t)(timeoutMs / 1000U);
+    deadline.tv_nsec += (long)(timeoutMs % 1000U) * 1000000L;
+    if(1000000000L <= deadline.tv_nsec) {
+
+        deadline.tv_sec += 1;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    TRACE_BEGIN(TRACE_MSGQ_REMOVE, 0);
+    pthread_mutex_lock(&(messageQueue->lock));
+    while(NULL == messageQueue->messages[messageQueue->back]) {
+
+        if(ETIMEDOUT == pthread_cond_timedwait(&(messageQueue->update), &(messageQueue->lock), &deadline)) {
+
+            break;
+        }
+    }
+
+    if(NULL == messageQueue->messages[messageQueue->back]) {
+
+        pthread_mutex_unlock(&(messageQueue->lock));
+        TRACE_END(TRACE_MSGQ_REMOVE, -3);
+        retval = -3;
+        return retval;
+    }
+
+    *message = messageQueue->messages[messageQueue->back];
+    TRACE_FLOW_END(TRACE_MSGQ_MESSAGE, *message);
+    messageQueue->messages[messageQueue->back] = NULL;
+    messageQueue->back = ((messageQueue->back + 1) & (messageQueue->size - 1));
+    pthread_cond_broadcast(&(messageQueue->update));
+    pthread_mutex_unlock(&(messageQueue->lock));
+    TRACE_END(TRACE_MSGQ_REMOVE, (*message)->code);
+
+    return retval;
+}
+
 ssize_t recvTimeout(int sockfd, void *buf, size_t len, int flags, time_t sec, useconds_t usec) {
 
     ssize_t retval;
@@ -417,13 +583,226 @@ ssize_t recvTimeout(int sockfd, void *buf, size_t len, int flags, time_t sec, us
     };
     
     setsockopt(sockfd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    TRACE_BEGIN(TRACE_SOCK_RECV, len);
     retval = recv(sockfd, buf, len, flags);
+    TRACE_END(TRACE_SOCK_RECV, retval);
     timeout = (struct timeval){ .tv_sec = 0, .tv_usec = 0 };
     setsockopt(sockfd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
 
     return retval;
 }
 
+ssize_t encodeNetworkMessage(const ModuleMessage_T *message, uint8_t buffer[], const size_t size) {
+
+    size_t length = NUM_NET_MSG_HEADER_SIZE;
+    unsigned int i;
+    MessageHeaderField_T messageHeader[NUM_MSG_HEADER_SIZE] = {0};
+    MessageDataField_T messageData = 0U;
+    MessageDataField_T telemetryData[NUM_TELEMETRY_MSG_FIELDS] = {0};
+    MessageDataField_T snapshotData[NUM_SNAPSHOT_MSG_FIELDS] = {0};
+    MessageDataField_T clockData[NUM_CLOCK_MAP_MSG_FIELDS] = {0};
+
+    if((NULL == message) || (NULL == buffer)) {
+
+        return -1;
+    }
+
+    length += getNetworkMessageDataSize(message->code);
+    if(size < length) {
+
+        return -1;
+    }
+
+    messageHeader[IDX_MSG_HEADER_MODULE] = (MessageHeaderField_T)message->address;
+    messageHeader[IDX_MSG_HEADER_CODE] = (MessageHeaderField_T)message->code;
+    memcpy(buffer, messageHeader, sizeof(messageHeader));
+
+    switch(message->code) {
+
+        case MOD_MSG_CODE_STREAM_REQ:
+
+            messageData = (MessageDataField_T)message->data.videoStreamPort;
+            memcpy(&buffer[NUM_NET_MSG_HEADER_SIZE], &messageData, sizeof(messageData));
+            break;
+
+        case MOD_MSG_CODE_STREAM_TYPE:
+        case MOD_MSG_CODE_STREAM_RECOVERED:
+
+            messageData = (MessageDataField_T)message->data.codingFormat;
+            memcpy(&buffer[NUM_NET_MSG_HEADER_SIZE], &messageData, sizeof(messageData));
+            break;
+
+        case MOD_MSG_CODE_TELEMETRY:
+
+            telemetryData[IDX_TELEMETRY_MSG_CHANNEL] = (MessageDataField_T)message->data.telemetry.channel;
+            telemetryData[IDX_TELEMETRY_MSG_AGE] = (MessageDataField_T)message->data.telemetry.ageMs;
+            for(i = 0;i < NUM_TELEMETRY_VALUES;++i) {
+
+                telemetryData[IDX_TELEMETRY_MSG_VALUES + i] = (MessageDataField_T)message->data.telemetry.values[i];
+            }
+            memcpy(&buffer[NUM_NET_MSG_HEADER_SIZE], telemetryData, sizeof(telemetryData));
+            break;
+
+        case MOD_MSG_CODE_SNAPSHOT:
+
+            snapshotData[IDX_SNAPSHOT_MSG_ID] = (MessageDataField_T)message->data.snapshot.id;
+            snapshotData[IDX_SNAPSHOT_MSG_SIZE] = (MessageDataField_T)message->data.snapshot.size;
+            snapshotData[IDX_SNAPSHOT_MSG_STATUS] = (MessageDataField_T)message->data.snapshot.status;
+            memcpy(&buffer[NUM_NET_MSG_HEADER_SIZE], snapshotData, sizeof(snapshotData));
+            break;
+
+        case MOD_MSG_CODE_CLOCK_REQ:
+
+            clockData[IDX_CLOCK_MSG_ORIGIN] = (MessageDataField_T)(message->data.clockExchange.originNs >> 32);
+            clockData[IDX_CLOCK_MSG_ORIGIN + 1U] = (MessageDataField_T)message->data.clockExchange.originNs;
+            memcpy(&buffer[NUM_NET_MSG_HEADER_SIZE], clockData, NUM_NET_MSG_CLOCK_REQ_SIZE);
+            break;
+
+        case MOD_MSG_CODE_CLOCK_MAP:
+
+            clockData[IDX_CLOCK_MAP_MSG_SSRC] = (MessageDataField_T)message->data.clockMapping.ssrc;
+            clockData[IDX_CLOCK_MAP_MSG_RTP] = (MessageDataField_T)message->data.clockMapping.rtpTimestamp;
+            clockData[IDX_CLOCK_MAP_MSG_GROUND] = (MessageDataField_T)(message->data.clockMapping.groundNs >> 32);
+            clockData[IDX_CLOCK_MAP_MSG_GROUND + 1U] = (MessageDataField_T)message->data.clockMapping.groundNs;
+            clockData[IDX_CLOCK_MAP_MSG_UNCERTAINTY] = (MessageDataField_T)message->data.clockMapping.uncertaintyUs;
+            memcpy(&buffer[NUM_NET_MSG_HEADER_SIZE], clockData, NUM_NET_MSG_CLOCK_MAP_SIZE);
+            break;
+
+        default:
+
+            // NOP
+            break;
+    }
+
+    return (ssize_t)length;
+}
+
+int decodeNetworkMessageHeader(const uint8_t buffer[], const size_t size, ModuleMessage_T *message) {
+
+    int retval = 0;
+    MessageHeaderField_T messageHeader[NUM_MSG_HEADER_SIZE] = {0};
+
+    if((NULL != buffer) && (NUM_NET_MSG_HEADER_SIZE <= size) && (NULL != message)) {
+
+        memcpy(messageHeader, buffer, sizeof(messageHeader));
+        message->address = (ModuleName_T)messageHeader[IDX_MSG_HEADER_MODULE];
+        message->code = (ModuleMessageCode_T)messageHeader[IDX_MSG_HEADER_CODE];
+    }
+    else {
+
+        retval = -1;
+    }
+
+    return retval;
+}
+
+size_t getNetworkMessageDataSize(const ModuleMessageCode_T code) {
+
+    switch(code) {
+
+        case MOD_MSG_CODE_STREAM_REQ:
+        case MOD_MSG_CODE_STREAM_TYPE:
+        case MOD_MSG_CODE_STREAM_RECOVERED:
+
+            return sizeof(MessageDataField_T);
+
+        case MOD_MSG_CODE_TELEMETRY:
+
+            return NUM_NET_MSG_TELEMETRY_SIZE;
+
+        case MOD_MSG_CODE_SNAPSHOT:
+
+            return NUM_NET_MSG_SNAPSHOT_SIZE;
+
+        case MOD_MSG_CODE_SNAPSHOT_DATA:
+
+            /* Fixed part only: the chunk follows (see snapshotDataToNetwork()) */
+            return NUM_NET_MSG_SNAPSHOT_DATA_SIZE;
+
+        case MOD_MSG_CODE_CLOCK_REQ:
+
+            return NUM_NET_MSG_CLOCK_REQ_SIZE;
+
+        case MOD_MSG_CODE_CLOCK_RESP:
+
+            return NUM_NET_MSG_CLOCK_RESP_SIZE;
+
+        case MOD_MSG_CODE_CLOCK_MAP:
+
+            return NUM_NET_MSG_CLOCK_MAP_SIZE;
+
+        default:
+
+            return 0;
+    }
+}
+
+int decodeNetworkMessageData(const uint8_t buffer[], const size_t size, ModuleMessage_T *message) {
+
+    int retval = 0;
+    unsigned int i;
+    MessageDataField_T messageData = 0U;
+    MessageDataField_T telemetryData[NUM_TELEMETRY_MSG_FIELDS] = {0};
+    MessageDataField_T snapshotData[NUM_SNAPSHOT_MSG_FIELDS] = {0};
+    MessageDataField_T clockData[NUM_CLOCK_RESP_MSG_FIELDS] = {0};
+
+    if((NULL == buffer) || (NULL == message) || (getNetworkMessageDataSize(message->code) > size)) {
+
+        retval = -1;
+        return retval;
+    }
+
+    switch(message->code) {
+
+        case MOD_MSG_CODE_STREAM_REQ:
+
+            memcpy(&messageData, buffer, sizeof(messageData));
+            message->data.videoStreamPort = (VideoStreamPort_T)messageData;
+            break;
+
+        case MOD_MSG_CODE_STREAM_TYPE:
+        case MOD_MSG_CODE_STREAM_RECOVERED:
+
+            memcpy(&messageData, buffer, sizeof(messageData));
+            message->data.codingFormat = (VideoCodingFormat_T)messageData;
+            break;
+
+        case MOD_MSG_CODE_TELEMETRY:
+
+            memcpy(telemetryData, buffer, sizeof(telemetryData));
+            message->data.telemetry.channel = (TelemetryChannel_T)telemetryData[IDX_TELEMETRY_MSG_CHANNEL];
+            message->data.telemetry.ageMs = (uint32_t)telemetryData[IDX_TELEMETRY_MSG_AGE];
+            for(i = 0;i < NUM_TELEMETRY_VALUES;++i) {
+
+                message->data.telemetry.values[i] = (int32_t)telemetryData[IDX_TELEMETRY_MSG_VALUES + i];
+            }
+            break;
+
+        case MOD_MSG_CODE_SNAPSHOT:
+
+            memcpy(snapshotData, buffer, sizeof(snapshotData));
+            message->data.snapshot.id = (uint32_t)snapshotData[IDX_SNAPSHOT_MSG_ID];
+            message->data.snapshot.size = (uint32_t)snapshotData[IDX_SNAPSHOT_MSG_SIZE];
+            message->data.snapshot.status = (int32_t)snapshotData[IDX_SNAPSHOT_MSG_STATUS];
+            break;
+
+        case MOD_MSG_CODE_CLOCK_RESP:
+
+            memcpy(clockData, buffer, sizeof(clockData));
+            message->data.clockExchange.originNs = ((uint64_t)clockData[IDX_CLOCK_MSG_ORIGIN] << 32) | (uint64_t)clockData[IDX_CLOCK_MSG_ORIGIN + 1U];
+            message->data.clockExchange.receiveNs = ((uint64_t)clockData[IDX_CLOCK_MSG_RECEIVE] << 32) | (uint64_t)clockData[IDX_CLOCK_MSG_RECEIVE + 1U];
+            message->data.clockExchange.transmitNs = ((uint64_t)clockData[IDX_CLOCK_MSG_TRANSMIT] << 32) | (uint64_t)clockData[IDX_CLOCK_MSG_TRANSMIT + 1U];
+            break;
+
+        default:
+
+            // NOP
+            break;
+    }
+
+    return retval;
+}
+
 int initNetworkModule(NetworkInitContext_T *initCtx) {
 
     int retval = 0;
@@ -451,11 +830,85 @@ int initNetworkModule(NetworkInitContext_T *initCtx) {
 static void* threadFuncNetworkOut(void *arg) {
 
     int *socketFileDescriptor = (int*)arg;
+    int result, clockResult;
+    unsigned int delayMs = 0;
+    unsigned int clockDelayMs = 0;
     ModuleMessage_T *message = NULL;
+    ModuleMessage_T telemetryMessage = {.address = MOD_NAME_GCCOMMON, .code = MOD_MSG_CODE_TELEMETRY};
+    ModuleMessage_T clockMessage = {.address = MOD_NAME_GCCOMMON, .code = MOD_MSG_CODE_CLOCK_REQ};
+    ModuleMessage_T mappingMessage = {.address = MOD_NAME_GCCOMMON, .code = MOD_MSG_CODE_CLOCK_MAP};
+
+    applyThreadScheduling(SCHED_CLASS_NETWORK);
 
     while(1) {
 
-        if(0 != removeModuleMessage(&networkMsgq, &message, MOD_MSGQ_BLOCK)) {
+        /* Control messages first: telemetry only goes out while none is waiting */
+        result = removeModuleMessage(&networkMsgq, &message, MOD_MSGQ_NOBLOCK);
+        if((-2 == result) || (-3 == result)) {
+
+            if(!isTelemetrySendable(*socketFileDescriptor)) {
+
+                /* Disconnected or congested: samples are replaced by newer ones meanwhile */
+                result = removeModuleMessageTimed(&networkMsgq, &message,
+                    isSnapshotPending() ? NUM_SNAPSHOT_SEND_WAIT_MS : NUM_TELEMETRY_IDLE_WAIT_MS);
+            }
+            else {
+
+                /* Clock requests first: bytes queued ahead would add to the measured delay */
+                clockResult = takeClockRequest(&clockMessage.data.clockExchange, &clockDelayMs);
+                if(0 == clockResult) {
+
+                    if(gccommonMessageToNetwork(socketFileDescriptor, &clockMessage)) {
+
+                        LOG_MSG_WRN(LOG_MOD_NETWORK, STR_LOG_MSG_FUNC84_CLOCK_SEND_FAIL);
+                    }
+                    continue;
+                }
+
+                /* Latest RTP clock mapping of the stream (see attachClockMapping()) */
+                if(0 == takeClockMapping(&mappingMessage.data.clockMapping)) {
+
+                    if(gccommonMessageToNetwork(socketFileDescriptor, &mappingMessage)) {
+
+                        LOG_MSG_WRN(LOG_MOD_NETWORK, STR_LOG_MSG_FUNC84_MAPPING_SEND_FAIL);
+                    }
+                    continue;
+                }
+
+                result = takeTelemetrySample(&telemetryMessage.data.telemetry, &delayMs);
+                if(0 == result) {
+
+                    if(gccommonMessageToNetwork(socketFileDescriptor, &telemetryMessage)) {
+
+                        LOG_MSG_WRN(LOG_MOD_NETWORK, STR_LOG_MSG_FUNC84_SEND_FAIL, getTelemetryChannelName(telemetryMessage.data.telemetry.channel));
+                    }
+                    continue;
+                }
+
+                /* Snapshot data fills the idle link after telemetry */
+                if(1 != snapshotDataToNetwork(socketFileDescriptor)) {
+
+                    continue;
+                }
+
+                /* Wait for control messages until the next sample or clock request is due (a snapshot result wakes the thread) */
+                if(1 == clockResult) {
+
+                    delayMs = ((0 < result) && (delayMs < clockDelayMs)) ? delayMs : clockDelayMs;
+                    result = 1;
+                }
+                result = (0 < result) ? removeModuleMessageTimed(&networkMsgq, &message, delayMs) :
+                                        removeModuleMessage(&networkMsgq, &message, MOD_MSGQ_BLOCK);
+            }
+
+            if(-3 == result) {
+
+                /* Nothing to send yet */
+                continue;
+            }
+        }
+
+        if(0 != result) {
 
             createLogMessage(STR_LOG_MSG_FUNC14_MSG_RMV_FAIL, LOG_SVRTY_ERR);
         }
@@ -495,12 +948,15 @@ static void* threadFuncNetworkOut(void *arg) {
 static void* threadFuncNetworkIn(void *arg) {
 
     int errorCode = 0;
+    unsigned int attempts = 0;
     char testBuf[1] = {0};
     char gcAddress[NUM_GC_ADDR_SIZE] = STR_GC_ADDR_DEFAULT_WAN;
     char gcPort[NUM_GC_PORT_SIZE] = STR_GC_PORT_DEFAULT_WAN;
     NetworkInitContext_T *initCtx = (NetworkInitContext_T*)arg;
     struct pollfd pollArray[NUM_POLL_ARRAY_SIZE] = {0};
 
+    applyThreadScheduling(SCHED_CLASS_NETWORK);
+
     /* Initialize network context */
     if(initCtx) {
 
@@ -518,19 +974,20 @@ static void* threadFuncNetworkIn(void *arg) {
     /* Connect to ground control */
     while(connectToGroundControl(gcAddress, gcPort, &(pollArray[IDX_SOCK].fd))) {
 
-        #ifdef CC_DEBUG_MODE
-        fprintf(stdout, STR_LOG_MSG_FUNC13_CONN_FAIL_RETRY, RECONNECT_COOLDOWN_SEC);
-        #endif
-        syslog(LOG_DAEMON | LOG_WARNING, STR_LOG_MSG_FUNC13_CONN_FAIL_RETRY, RECONNECT_COOLDOWN_SEC);
+        ++attempts;
+        LOG_MSG_CONN(WRN, STR_LOG_MSG_FUNC13_CONN_FAIL_RETRY, attempts, RECONNECT_COOLDOWN_SEC);
 
         sleep(RECONNECT_COOLDOWN_SEC);
     }
 
+    markStartupMilestone(STARTUP_MILESTONE_CONNECTED);
+
     /* Start network output handler thread */
     errorCode = pthread_create(&threadNetworkOut, NULL, threadFuncNetworkOut, &(pollArray[IDX_SOCK].fd));
     if(0 != errorCode) {
 
         createLogMessage(STR_LOG_MSG_FUNC13_THRD_START_FAIL, LOG_SVRTY_ERR);
+        flushLogMessages();
         kill(getpid(), SIGTERM);
         pthread_exit(NULL);
     }
@@ -552,12 +1009,11 @@ static void* threadFuncNetworkIn(void *arg) {
                 pollArray[IDX_SOCK].fd = SOCK_FD_INVAL;
                 
                 /* Reconnect to ground control */
+                attempts = 0;
                 while(connectToGroundControl(gcAddress, gcPort, &(pollArray[IDX_SOCK].fd))) {
 
-                    #ifdef CC_DEBUG_MODE
-                    fprintf(stdout, STR_LOG_MSG_FUNC13_RECONN_FAIL_RETRY, RECONNECT_COOLDOWN_SEC);
-                    #endif
-                    syslog(LOG_DAEMON | LOG_WARNING, STR_LOG_MSG_FUNC13_RECONN_FAIL_RETRY, RECONNECT_COOLDOWN_SEC);
+                    ++attempts;
+                    LOG_MSG_CONN(WRN, STR_LOG_MSG_FUNC13_RECONN_FAIL_RETRY, attempts, RECONNECT_COOLDOWN_SEC);
 
                     sleep(RECONNECT_COOLDOWN_SEC);
                 }
@@ -576,12 +1032,11 @@ static void* threadFuncNetworkIn(void *arg) {
                     pollArray[IDX_SOCK].fd = SOCK_FD_INVAL;
                     
                     /* Reconnect to ground control */
+                    attempts = 0;
                     while(connectToGroundControl(gcAddress, gcPort, &(pollArray[IDX_SOCK].fd))) {
 
-                        #ifdef CC_DEBUG_MODE
-                        fprintf(stdout, STR_LOG_MSG_FUNC13_RECONN_FAIL_RETRY, RECONNECT_COOLDOWN_SEC);
-                        #endif
-                        syslog(LOG_DAEMON | LOG_WARNING, STR_LOG_MSG_FUNC13_RECONN_FAIL_RETRY, RECONNECT_COOLDOWN_SEC);
+                        ++attempts;
+                        LOG_MSG_CONN(WRN, STR_LOG_MSG_FUNC13_RECONN_FAIL_RETRY, attempts, RECONNECT_COOLDOWN_SEC);
 
                         sleep(RECONNECT_COOLDOWN_SEC);
                     }
@@ -607,6 +1062,7 @@ static int connectToGroundControl(const char *node, const char *service, int *fd
     LoginMessageField_T loginMessage[NUM_LOGIN_MSG_SIZE] = {0};
     int length;
     int keepAliveState = 1;
+    const char *multipathPaths = NULL;
     
     struct addrinfo hints;
     struct addrinfo *result;
@@ -624,12 +1080,8 @@ static int connectToGroundControl(const char *node, const char *service, int *fd
         if(errorCode) {
         
             /* Failed to resolve ground control address */
-            #ifdef CC_DEBUG_MODE
-            fprintf(stdout, STR_LOG_MSG_FUNC12_GETADDRINFO_FAIL, gai_strerror(errorCode));
-            fflush(stdout);
-            #endif
-            syslog(LOG_DAEMON | LOG_ERR, STR_LOG_MSG_FUNC12_GETADDRINFO_FAIL, gai_strerror(errorCode));
-            createLogMessage(STR_LOG_MSG_FUNC12_GC_ADDR_RESLV_FAIL, LOG_SVRTY_ERR);
+            LOG_MSG_CONN(ERR, STR_LOG_MSG_FUNC12_GETADDRINFO_FAIL, gai_strerror(errorCode));
+            LOG_MSG_CONN(ERR, STR_LOG_MSG_FUNC12_GC_ADDR_RESLV_FAIL);
         
             *fd = SOCK_FD_INVAL;
             retval = -1;
@@ -638,15 +1090,31 @@ static int connectToGroundControl(const char *node, const char *service, int *fd
         else if(NULL == result) {
         
             /* No ground control found with the given parameters */
-            createLogMessage(STR_LOG_MSG_FUNC12_GC_NOT_FOUND, LOG_SVRTY_ERR);
+            LOG_MSG_CONN(ERR, STR_LOG_MSG_FUNC12_GC_NOT_FOUND);
 
             *fd = SOCK_FD_INVAL;
             retval = -1;
             return retval;
         }
 
+        /* With multipath streaming the control link is a Multipath TCP connection: its subflows over the
+           other paths carry on when one fails, without a reconnect (plain TCP if the kernel lacks it) */
+        *fd = SOCK_FD_INVAL;
+        multipathPaths = getenv(STR_STREAM_ENV_MULTIPATH);
+        if((NULL != multipathPaths) && ('\0' != multipathPaths[0])) {
+
+            *fd = socket(result->ai_family, result->ai_socktype, IPPROTO_MPTCP);
+            if(*fd < 0) {
+
+                LOG_MSG_CONN(WRN, STR_LOG_MSG_FUNC12_MPTCP_FALLBACK);
+            }
+        }
+
         /* Create socket based on the result's settings */
-        *fd = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
+        if(*fd < 0) {
+
+            *fd = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
+        }
         if(*fd < 0) {
         
             /* Failed to create socket */
@@ -654,7 +1122,7 @@ static int connectToGroundControl(const char *node, const char *service, int *fd
             perror("socket");
             fflush(stderr);
             #endif
-            createLogMessage(STR_LOG_MSG_FUNC12_CREAT_SOCK_FAIL, LOG_SVRTY_ERR);
+            LOG_MSG_CONN(ERR, STR_LOG_MSG_FUNC12_CREAT_SOCK_FAIL);
         
             /* Free resources */
             freeaddrinfo(result);
@@ -664,6 +1132,12 @@ static int connectToGroundControl(const char *node, const char *service, int *fd
             return retval;
         }
 
+        /* Mark control traffic above video before the handshake (SYN included) */
+        if(setSocketTrafficClass(*fd, QOS_CLASS_CONTROL)) {
+
+            LOG_MSG_CONN(WRN, STR_LOG_MSG_FUNC12_SET_QOS_FAIL);
+        }
+
         /* Connect socket to ground control referenced to by ai_addr */
         if(connect(*fd, result->ai_addr, result->ai_addrlen) < 0) {
         
@@ -672,10 +1146,11 @@ static int connectToGroundControl(const char *node, const char *service, int *fd
             perror("connect");
             fflush(stderr);
             #endif
-            createLogMessage(STR_LOG_MSG_FUNC12_GC_CONN_FAIL, LOG_SVRTY_ERR);
+            LOG_MSG_CONN(ERR, STR_LOG_MSG_FUNC12_GC_CONN_FAIL);
         
             /* Free resources */
             freeaddrinfo(result);
+            close(*fd);
             *fd = SOCK_FD_INVAL;
 
             retval = -1;
@@ -685,7 +1160,10 @@ static int connectToGroundControl(const char *node, const char *service, int *fd
         /* Send login message to ground control */
         loginMessage[IDX_LOGIN_MSG_CODE] = (LoginMessageField_T)MOD_MSG_CODE_LOGIN;
         loginMessage[IDX_LOGIN_MSG_ID] = DRONE_ID;
+        recordFlightEvent(REC_EVT_MSG_OUT, (uint16_t)MOD_MSG_CODE_LOGIN, (int32_t)MOD_NAME_NETWORK, 0, node);
+        TRACE_BEGIN(TRACE_SOCK_SEND, sizeof(loginMessage));
         length = send(*fd, loginMessage, sizeof(loginMessage), MSG_NOSIGNAL);
+        TRACE_END(TRACE_SOCK_SEND, length);
         if((length < 0) || (length < sizeof(loginMessage))) {
         
             /* Failed to send login message to ground control */
@@ -693,7 +1171,7 @@ static int connectToGroundControl(const char *node, const char *service, int *fd
             perror("send");
             fflush(stderr);
             #endif
-            createLogMessage(STR_LOG_MSG_FUNC12_LOGIN_SEND_FAIL, LOG_SVRTY_ERR);
+            LOG_MSG_CONN(ERR, STR_LOG_MSG_FUNC12_LOGIN_SEND_FAIL);
         
             /* Free resources */
             freeaddrinfo(result);
@@ -714,7 +1192,7 @@ static int connectToGroundControl(const char *node, const char *service, int *fd
             perror("recv");
             fflush(stderr);
             #endif
-            createLogMessage(STR_LOG_MSG_FUNC12_LOGIN_RECV_FAIL, LOG_SVRTY_ERR);
+            LOG_MSG_CONN(ERR, STR_LOG_MSG_FUNC12_LOGIN_RECV_FAIL);
 
             /* Free resources */
             freeaddrinfo(result);
@@ -726,10 +1204,11 @@ static int connectToGroundControl(const char *node, const char *service, int *fd
         }
     
         /* Validate login message */
+        recordFlightEvent(REC_EVT_MSG_IN, (uint16_t)loginMessage[IDX_LOGIN_MSG_CODE], (int32_t)MOD_NAME_NETWORK, (int32_t)loginMessage[IDX_LOGIN_MSG_ID], node);
         if((loginMessage[IDX_LOGIN_MSG_CODE] != (LoginMessageField_T)MOD_MSG_CODE_LOGIN_ACK) || (loginMessage[IDX_LOGIN_MSG_ID] != DRONE_ID)) {
 
             /* Invalid login message acknowledgement from ground control */
-            createLogMessage(STR_LOG_MSG_FUNC12_LOGIN_ACK_INVAL , LOG_SVRTY_ERR);
+            LOG_MSG_CONN(ERR, STR_LOG_MSG_FUNC12_LOGIN_ACK_INVAL);
 
             /* Free resources */
             freeaddrinfo(result);
@@ -748,18 +1227,17 @@ static int connectToGroundControl(const char *node, const char *service, int *fd
             perror("setsockopt");
             fflush(stderr);
             #endif
-            createLogMessage(STR_LOG_MSG_FUNC12_SET_KEEPALIVE_FAIL, LOG_SVRTY_WRN);
+            LOG_MSG_CONN(WRN, STR_LOG_MSG_FUNC12_SET_KEEPALIVE_FAIL);
         }
 
         /* Free address-info list pointed by result */
         freeaddrinfo(result);
     
         /* Connection was successfully estabilished */
-        #ifdef CC_DEBUG_MODE
-        fprintf(stdout, STR_LOG_MSG_FUNC12_GC_CONN_SUCCESS, node, service);
-        fflush(stdout);
-        #endif
-        syslog(LOG_DAEMON | LOG_INFO, STR_LOG_MSG_FUNC12_GC_CONN_SUCCESS, node, service);
+        LOG_MSG_INF(LOG_MOD_NETWORK, STR_LOG_MSG_FUNC12_GC_CONN_SUCCESS, node, service);
+
+        /* The ground control may be another one: synchronize its clock from scratch */
+        restartClockSync();
     }
     else {
 
@@ -774,13 +1252,18 @@ static int inputMessageHandler(const int sockFd) {
 
     int retval = 0;
     int length;
-    MessageHeaderField_T messageHeader[NUM_MSG_HEADER_SIZE] = {0};
+    uint64_t arrivalNs;
+    uint8_t messageBuffer[NUM_NET_MSG_HEADER_SIZE] = {0};
+    ModuleMessage_T messageHeader = {0};
 
     if(0 <= sockFd) {
 
+        /* Arrival time of clock responses (the poll just returned) */
+        arrivalNs = getLocalClockNs();
+
         /* Read message header (module address and message code) */
-        length = recvTimeout(sockFd, messageHeader, sizeof(messageHeader), MSG_WAITALL, 2, 0);
-        if(length < 0) {
+        length = recvTimeout(sockFd, messageBuffer, sizeof(messageBuffer), MSG_WAITALL, 2, 0);
+        if((length < 0) || decodeNetworkMessageHeader(messageBuffer, (size_t)length, &messageHeader)) {
 
             /* Failed to receive message header */
             createLogMessage(STR_LOG_MSG_FUNC15_HDR_RECV_FAIL, LOG_SVRTY_ERR);
@@ -789,12 +1272,14 @@ static int inputMessageHandler(const int sockFd) {
         }
         else {
 
+            recordFlightEvent(REC_EVT_MSG_IN, (uint16_t)messageHeader.code, (int32_t)messageHeader.address, 0, NULL);
+
             /* Parse module name */
-            switch((ModuleName_T)messageHeader[IDX_MSG_HEADER_MODULE]) {
+            switch(messageHeader.address) {
 
                 case MOD_NAME_STREAM:
 
-                    if(networkToStreamMessage(sockFd, (ModuleMessageCode_T)messageHeader[IDX_MSG_HEADER_CODE])) {
+                    if(networkToStreamMessage(sockFd, messageHeader.code)) {
 
                         createLogMessage(STR_LOG_MSG_FUNC15_PROC_MSG_STRM_FAIL, LOG_SVRTY_WRN);
                         cleanupInputMessages(sockFd);
@@ -802,6 +1287,15 @@ static int inputMessageHandler(const int sockFd) {
                     }
                     break;
 
+                case MOD_NAME_NETWORK:
+
+                    if(networkToClockMessage(sockFd, messageHeader.code, arrivalNs)) {
+
+                        cleanupInputMessages(sockFd);
+                        retval = -1;
+                    }
+                    break;
+
                 default:
 
                     createLogMessage(STR_LOG_MSG_FUNC15_MOD_NAME_INVAL, LOG_SVRTY_WRN);
@@ -834,6 +1328,7 @@ static int networkToStreamMessage(const int sockFd, const ModuleMessageCode_T co
 
     int retval = 0;
     int length;
+    uint8_t messageBuffer[NUM_NET_MSG_DATA_SIZE] = {0};
     ModuleMessage_T *message = NULL;
 
     if(0 <= sockFd) {
@@ -849,16 +1344,10 @@ static int networkToStreamMessage(const int sockFd, const ModuleMessageCode_T co
                 case MOD_MSG_CODE_STREAM_REQ:
 
                     /* Request video stream */
-                    length = recvTimeout(sockFd, &(message->data.videoStreamPort),
-                        sizeof(message->data.videoStreamPort), MSG_WAITALL, 2, 0);
-
-                    /* 
-                     * We can read directly into message data as long as
-                     * the video stream port's type is fixed among platforms.
-                     * (unsigned 32 bit integer currently)
-                     */
+                    length = recvTimeout(sockFd, messageBuffer,
+                        getNetworkMessageDataSize(code), MSG_WAITALL, 2, 0);
 
-                    if(sizeof(message->data.videoStreamPort) > length) {
+                    if((0 > length) || decodeNetworkMessageData(messageBuffer, (size_t)length, message)) {
 
                         if(0 > length) {
                             #ifdef CC_DEBUG_MODE
@@ -889,6 +1378,18 @@ static int networkToStreamMessage(const int sockFd, const ModuleMessageCode_T co
                     // On failure free message and return immediately
                     break;
 
+                case MOD_MSG_CODE_PROFILE_DUMP:
+
+                    /* Dump pipeline profile */
+                    // NOP
+                    break;
+
+                case MOD_MSG_CODE_SNAPSHOT_REQ:
+
+                    /* Take snapshot */
+                    // NOP
+                    break;
+
                 default:
 
                     /* Invalid module message code */
@@ -918,23 +1419,85 @@ static int networkToStreamMessage(const int sockFd, const ModuleMessageCode_T co
     return retval;
 }
 
-static int gccommonMessageToNetwork(const int *sockFd, const ModuleMessage_T *message) {
+static int networkToClockMessage(const int sockFd, const ModuleMessageCode_T code, const uint64_t arrivalNs) {
 
     int retval = 0;
     int length;
-    MessageHeaderField_T messageHeader[NUM_MSG_HEADER_SIZE] = {0};
-    uint32_t codingFormat = 0U;
+    uint8_t messageBuffer[NUM_NET_MSG_CLOCK_RESP_SIZE] = {0};
+    ModuleMessage_T message = {.address = MOD_NAME_NETWORK, .code = code};
+
+    if(MOD_MSG_CODE_CLOCK_RESP != code) {
+
+        createLogMessage(STR_LOG_MSG_FUNC107_CODE_INVAL, LOG_SVRTY_WRN);
+        retval = -1;
+        return retval;
+    }
+
+    length = recvTimeout(sockFd, messageBuffer, sizeof(messageBuffer), MSG_WAITALL, 2, 0);
+    if((0 > length) || decodeNetworkMessageData(messageBuffer, (size_t)length, &message)) {
+
+        createLogMessage(STR_LOG_MSG_FUNC107_DATA_RECV_FAIL, LOG_SVRTY_ERR);
+        retval = -1;
+        return retval;
+    }
+
+    /* Stale and outlier exchanges are dropped silently */
+    processClockResponse(&message.data.clockExchange, arrivalNs);
+
+    return retval;
+}
+
+static int gccommonMessageToNetwork(const int *sockFd, const ModuleMessage_T *message) {
+
+    int retval = 0;
+    ssize_t length, messageLength;
+    uint8_t messageBuffer[NUM_NET_MSG_MAX_SIZE] = {0};
 
     if((NULL != sockFd) && (NULL != message)) {
 
-        messageHeader[IDX_MSG_HEADER_MODULE] = (MessageHeaderField_T)message->address;
-        messageHeader[IDX_MSG_HEADER_CODE] = (MessageHeaderField_T)message->code;
+        /* Check message code (only these are sent to the ground control) */
+        switch(message->code) {
+
+            case MOD_MSG_CODE_STREAM_TYPE:
+            case MOD_MSG_CODE_STREAM_ERROR:
+            case MOD_MSG_CODE_STREAM_RECOVERED:
+            case MOD_MSG_CODE_TELEMETRY:
+            case MOD_MSG_CODE_SNAPSHOT:
+            case MOD_MSG_CODE_CLOCK_REQ:
+            case MOD_MSG_CODE_CLOCK_MAP:
+
+                // NOP
+                break;
+
+            default:
+
+                createLogMessage(STR_LOG_MSG_FUNC18_CODE_INVAL, LOG_SVRTY_ERR);
+                retval = -1;
+                return retval;
+        }
 
-        /* Send message header to network */
+        /* Header and data go out in a single send */
+        messageLength = encodeNetworkMessage(message, messageBuffer, sizeof(messageBuffer));
+        if(0 > messageLength) {
+
+            createLogMessage(STR_LOG_MSG_FUNC18_ARG_INVAL, LOG_SVRTY_ERR);
+            retval = -1;
+            return retval;
+        }
+        /* Periodic messages would push the control events out of the flight recorder */
+        if((MOD_MSG_CODE_TELEMETRY != message->code) && (MOD_MSG_CODE_CLOCK_REQ != message->code) && (MOD_MSG_CODE_CLOCK_MAP != message->code)) {
+
+            recordFlightEvent(REC_EVT_MSG_OUT, (uint16_t)message->code, (int32_t)message->address, 0, NULL);
+        }
+
+        /* Send message to network */
         pthread_mutex_lock(&socketFdLock);
-        length = send(*sockFd, messageHeader, sizeof(messageHeader), MSG_NOSIGNAL);
+        TRACE_BEGIN(TRACE_SOCK_SEND, messageLength);
+        length = send(*sockFd, messageBuffer, (size_t)messageLength, MSG_NOSIGNAL);
+        TRACE_END(TRACE_SOCK_SEND, length);
+        pthread_mutex_unlock(&socketFdLock);
 
-        if(sizeof(messageHeader) > length) {
+        if(messageLength > length) {
 
             if(0 > length) {
                 #ifdef CC_DEBUG_MODE
@@ -942,52 +1505,71 @@ static int gccommonMessageToNetwork(const int *sockFd, const ModuleMessage_T *me
                 fflush(stderr);
                 #endif
             }
-            createLogMessage(STR_LOG_MSG_FUNC18_HDR_SEND_FAIL, LOG_SVRTY_ERR);
+            createLogMessage((NUM_NET_MSG_HEADER_SIZE > length) ? STR_LOG_MSG_FUNC18_HDR_SEND_FAIL : STR_LOG_MSG_FUNC18_DATA_SEND_FAIL, LOG_SVRTY_ERR);
             retval = -1;
         }
-        else {
+    }
+    else {
 
-            /* Process message data if needed */
-            switch(message->code) {
+        createLogMessage(STR_LOG_MSG_FUNC18_ARG_INVAL , LOG_SVRTY_ERR);
+        retval = -1;
+    }
 
-                case MOD_MSG_CODE_STREAM_TYPE:
+    return retval;
+}
 
-                    codingFormat = (uint32_t)message->data.codingFormat;
+static int isTelemetrySendable(const int sockFd) {
 
-                    /* Send video coding format to network */
-                    length = send(*sockFd, &codingFormat, sizeof(codingFormat), MSG_NOSIGNAL);
-                    if(sizeof(codingFormat) > length) {
+    int queued = 0;
 
-                        if(0 > length) {
-                            #ifdef CC_DEBUG_MODE
-                            perror("send");
-                            fflush(stderr);
-                            #endif
-                        }
-                        createLogMessage(STR_LOG_MSG_FUNC18_DATA_SEND_FAIL, LOG_SVRTY_ERR);
-                        retval = -1;
-                    }
-                    break;
+    if((0 > sockFd) || (0 > ioctl(sockFd, SIOCOUTQ, &queued))) {
 
-                case MOD_MSG_CODE_STREAM_ERROR:
+        return 0;
+    }
 
-                    // NOP
-                    break;
+    return (NUM_TELEMETRY_MAX_OUTQ >= (unsigned int)(queued));
+}
 
-                default:
+static int snapshotDataToNetwork(const int *sockFd) {
 
-                    createLogMessage(STR_LOG_MSG_FUNC18_CODE_INVAL, LOG_SVRTY_ERR);
-                    retval = -1;
-                    break;
-            }
-        }
-        pthread_mutex_unlock(&socketFdLock);
+    int retval = 0;
+    ssize_t length;
+    size_t messageLength;
+    uint32_t id = 0U;
+    uint32_t offset = 0U;
+    uint32_t chunkLength = 0U;
+    MessageHeaderField_T messageHeader[NUM_MSG_HEADER_SIZE] = {0};
+    MessageDataField_T snapshotData[NUM_SNAPSHOT_MSG_FIELDS] = {0};
+    static uint8_t messageBuffer[NUM_NET_MSG_HEADER_SIZE + NUM_NET_MSG_SNAPSHOT_DATA_SIZE + NUM_SNAPSHOT_CHUNK_SIZE];
+
+    /* Only the network output thread sends chunks: the buffer is not shared */
+    if(takeSnapshotChunk(&id, &offset, &messageBuffer[NUM_NET_MSG_HEADER_SIZE + NUM_NET_MSG_SNAPSHOT_DATA_SIZE], &chunkLength)) {
+
+        retval = 1;
+        return retval;
     }
-    else {
 
-        createLogMessage(STR_LOG_MSG_FUNC18_ARG_INVAL , LOG_SVRTY_ERR);
+    messageHeader[IDX_MSG_HEADER_MODULE] = (MessageHeaderField_T)MOD_NAME_GCCOMMON;
+    messageHeader[IDX_MSG_HEADER_CODE] = (MessageHeaderField_T)MOD_MSG_CODE_SNAPSHOT_DATA;
+    snapshotData[IDX_SNAPSHOT_MSG_ID] = (MessageDataField_T)id;
+    snapshotData[IDX_SNAPSHOT_MSG_OFFSET] = (MessageDataField_T)offset;
+    snapshotData[IDX_SNAPSHOT_MSG_LENGTH] = (MessageDataField_T)chunkLength;
+    memcpy(messageBuffer, messageHeader, sizeof(messageHeader));
+    memcpy(&messageBuffer[NUM_NET_MSG_HEADER_SIZE], snapshotData, sizeof(snapshotData));
+    messageLength = NUM_NET_MSG_HEADER_SIZE + NUM_NET_MSG_SNAPSHOT_DATA_SIZE + chunkLength;
+
+    /* Header, fixed part and chunk go out in a single send */
+    pthread_mutex_lock(&socketFdLock);
+    TRACE_BEGIN(TRACE_SOCK_SEND, messageLength);
+    length = send(*sockFd, messageBuffer, messageLength, MSG_NOSIGNAL);
+    TRACE_END(TRACE_SOCK_SEND, length);
+    pthread_mutex_unlock(&socketFdLock);
+
+    if((ssize_t)(messageLength) > length) {
+
+        LOG_MSG_WRN(LOG_MOD_NETWORK, STR_LOG_MSG_FUNC84_SNAPSHOT_SEND_FAIL, id, offset);
         retval = -1;
     }
 
     return retval;
-}
\ No newline at end of file
+}
@@ -0,0 +1,529 @@
+/**
+ * @file        frame_export_utils.c
+ * @author      Adam Csizy
+ * @date        2021-05-28
+ * @version     v1.1.0
+ *
+ * @brief       Shared memory frame export utilities
+ */
+
+
+#include <errno.h>
+#include <fcntl.h>
+#include <gst/gst.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "frame_export_utils.h"
+#include "log_utils.h"
+#include "sched_utils.h"
+
+
+/* Frame export related macro definitions */
+
+#define NUM_FRAME_EXPORT_RECLAIM_PERIOD 64U     /**< Frames between two checks for exited consumers */
+#define NUM_FRAME_EXPORT_AREA_MODE      0660    /**< Access mode of the shared memory objects */
+
+
+/* Frame export related static type declarations */
+
+/**
+ * @brief   Struct of an export point.
+ */
+typedef struct ExportPoint {
+
+    const char *name;               /**< Name of the point in CC_FRAME_EXPORT */
+    const char *shmName;            /**< Name of the shared memory object */
+    int enabled;                    /**< Flag whether the point is exported */
+    FrameExportHeader_T *header;    /**< Mapped area */
+    size_t areaSize;                /**< Size of the mapped area */
+    uint64_t sequence;              /**< Sequence of the last written frame */
+    pthread_t thread;               /**< Export thread */
+    pthread_mutex_t lock;           /**< Lock of the mailbox */
+    pthread_cond_t cond;            /**< Signals a new frame or caps in the mailbox */
+    GstBuffer *pendingBuffer;       /**< Newest frame not exported yet (mailbox) */
+    gchar *pendingCaps;             /**< New caps not exported yet (mailbox) */
+    uint64_t replaced;              /**< Frames replaced in the mailbox before being exported */
+
+} ExportPoint_T;
+
+
+/* Frame export related static variable declarations */
+
+static ExportPoint_T points[FRAME_EXPORT_POINT_COUNT] = {
+
+    {.name = "capture", .shmName = STR_FRAME_EXPORT_SHM_CAPTURE, .lock = PTHREAD_MUTEX_INITIALIZER, .cond = PTHREAD_COND_INITIALIZER},
+    {.name = "encoded", .shmName = STR_FRAME_EXPORT_SHM_ENCODED, .lock = PTHREAD_MUTEX_INITIALIZER, .cond = PTHREAD_COND_INITIALIZER}
+};  /**< Export points */
+
+
+/* Frame export related static function declarations */
+
+/**
+ * @brief       Parse a numeric environment variable.
+ *
+ * @param[in]   name Name of the environment variable.
+ * @param[in]   defaultValue Value if unset or invalid.
+ * @param[in]   maxValue Largest valid value (the smallest is 1).
+ *
+ * @return      Value of the environment variable.
+ */
+static unsigned long getExportSetting(const char *name, const unsigned long defaultValue, const unsigned long maxValue);
+
+/**
+ * @brief       Create the shared memory area of an export point.
+ *
+ * @param[in,out]   point Export point.
+ * @param[in]   consumerCount Number of consumer entries.
+ * @param[in]   slotSize Size of a slot in bytes.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+static int createExportArea(ExportPoint_T *point, const uint32_t consumerCount, const uint32_t slotSize);
+
+/**
+ * @brief       Pad probe of an export point.
+ *
+ * @details     Puts a reference of the frame (or the new caps) into
+ *              the point's mailbox. Runs on the streaming thread.
+ *
+ * @param[in]   pad Tapped pad.
+ * @param[in]   info Probe info.
+ * @param[in]   data Export point.
+ *
+ * @return      GST_PAD_PROBE_OK
+ */
+static GstPadProbeReturn frameExportProbe(GstPad *pad, GstPadProbeInfo *info, gpointer data);
+
+/**
+ * @brief       Thread function of an export point.
+ *
+ * @details     Copies the frames and caps of the mailbox into the
+ *              shared memory area.
+ *
+ * @param[in]   arg Export point.
+ *
+ * @return      NULL
+ */
+static void *threadFuncFrameExport(void *arg);
+
+/**
+ * @brief       Write frame into the shared memory area.
+ *
+ * @details     Drops the consumers still reading the slot, copies
+ *              the frame, publishes its sequence and wakes the
+ *              waiting consumers.
+ *
+ * @param[in,out]   point Export point.
+ * @param[in]   frame Frame data.
+ * @param[in]   size Size of the frame (at most the slot size).
+ * @param[in]   pts Presentation timestamp in nanoseconds.
+ * @param[in]   flags Frame flags.
+ */
+static void writeExportFrame(ExportPoint_T *point, const uint8_t *frame, const uint32_t size, const uint64_t pts, const uint32_t flags);
+
+/**
+ * @brief       Write caps into the shared memory area.
+ *
+ * @param[in,out]   header Mapped area.
+ * @param[in]   caps Caps string.
+ */
+static void writeExportCaps(FrameExportHeader_T *header, const char *caps);
+
+/**
+ * @brief       Free the entries of exited consumers.
+ *
+ * @param[in,out]   header Mapped area.
+ */
+static void reclaimExportConsumers(FrameExportHeader_T *header);
+
+
+/* Frame export related function definitions */
+
+int initFrameExport(void) {
+
+    int retval = 0;
+    unsigned int i;
+    unsigned long consumerCount;
+    unsigned long slotKb;
+    const char *list = NULL;
+    const char *token = NULL;
+    size_t length;
+
+    list = getenv(STR_FRAME_EXPORT_ENV_POINTS);
+    if((NULL == list) || ('\0' == list[0])) {
+
+        return retval;
+    }
+
+    /* Comma separated point names */
+    for(token = list;'\0' != *token;token += length + (',' == token[length])) {
+
+        length = strcspn(token, ",");
+        for(i = 0;i < FRAME_EXPORT_POINT_COUNT;++i) {
+
+            if((length == strlen(points[i].name)) && (0 == strncmp(token, points[i].name, length))) {
+
+                points[i].enabled = 1;
+                break;
+            }
+        }
+        if((FRAME_EXPORT_POINT_COUNT == i) && (0 < length)) {
+
+            LOG_MSG_WRN(LOG_MOD_STREAM, STR_LOG_MSG_FUNC90_POINT_INVAL, (int)(length), token);
+        }
+    }
+
+    consumerCount = getExportSetting(STR_FRAME_EXPORT_ENV_CONSUMERS, NUM_FRAME_EXPORT_CONSUMERS, NUM_FRAME_EXPORT_CONSUMER_MAX);
+    slotKb = getExportSetting(STR_FRAME_EXPORT_ENV_SLOT_KB, NUM_FRAME_EXPORT_SLOT_KB, NUM_FRAME_EXPORT_SLOT_KB_MAX);
+
+    for(i = 0;i < FRAME_EXPORT_POINT_COUNT;++i) {
+
+        if(!points[i].enabled) {
+
+            continue;
+        }
+
+        if(createExportArea(&points[i], (uint32_t)(consumerCount), (uint32_t)(slotKb * 1024UL))) {
+
+            points[i].enabled = 0;
+            retval = -1;
+            continue;
+        }
+
+        if(pthread_create(&points[i].thread, NULL, threadFuncFrameExport, &points[i])) {
+
+            LOG_MSG_ERR(LOG_MOD_STREAM, STR_LOG_MSG_FUNC90_THREAD_FAIL, points[i].name);
+            munmap(points[i].header, points[i].areaSize);
+            shm_unlink(points[i].shmName);
+            points[i].header = NULL;
+            points[i].enabled = 0;
+            retval = -1;
+            continue;
+        }
+        pthread_detach(points[i].thread);
+
+        LOG_MSG_INF(LOG_MOD_STREAM, STR_LOG_MSG_FUNC90_EXPORTING, points[i].name, points[i].shmName, (unsigned int)(consumerCount), (unsigned int)(slotKb));
+    }
+
+    return retval;
+}
+
+int attachFrameExport(struct _GstElement *capsfilter, struct _GstElement *payloader) {
+
+    int retval = 0;
+    unsigned int i;
+    GstPad *pad = NULL;
+
+    if((NULL == capsfilter) || (NULL == payloader)) {
+
+        createLogMessage(STR_LOG_MSG_FUNC91_ARG_INVAL, LOG_SVRTY_ERR);
+        retval = -1;
+        return retval;
+    }
+
+    for(i = 0;i < FRAME_EXPORT_POINT_COUNT;++i) {
+
+        if(!points[i].enabled) {
+
+            continue;
+        }
+
+        pad = (FRAME_EXPORT_CAPTURE == i) ? gst_element_get_static_pad(capsfilter, "src") : gst_element_get_static_pad(payloader, "sink");
+        if(NULL == pad) {
+
+            LOG_MSG_WRN(LOG_MOD_STREAM, STR_LOG_MSG_FUNC91_PAD_FAIL, points[i].name);
+            retval = -1;
+            continue;
+        }
+
+        gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM, frameExportProbe, &points[i], NULL);
+        gst_object_unref(pad);
+    }
+
+    return retval;
+}
+
+static unsigned long getExportSetting(const char *name, const unsigned long defaultValue, const unsigned long maxValue) {
+
+    unsigned long value = defaultValue;
+    char *end = NULL;
+    const char *text = NULL;
+
+    text = getenv(name);
+    if((NULL != text) && ('\0' != text[0])) {
+
+        errno = 0;
+        value = strtoul(text, &end, 10);
+        if((0 != errno) || ('\0' != *end) || (0UL == value) || (maxValue < value)) {
+
+            LOG_MSG_WRN(LOG_MOD_STREAM, STR_LOG_MSG_FUNC92_SETTING_INVAL, name, text, defaultValue);
+            value = defaultValue;
+        }
+    }
+
+    return value;
+}
+
+static int createExportArea(ExportPoint_T *point, const uint32_t consumerCount, const uint32_t slotSize) {
+
+    int retval = 0;
+    int fd = -1;
+    uint32_t dataOffset;
+    FrameExportHeader_T *header = NULL;
+
+    dataOffset = (uint32_t)((sizeof(FrameExportHeader_T) + NUM_FRAME_EXPORT_DATA_ALIGN - 1) / NUM_FRAME_EXPORT_DATA_ALIGN * NUM_FRAME_EXPORT_DATA_ALIGN);
+    point->areaSize = (size_t)(dataOffset) + ((size_t)(NUM_FRAME_EXPORT_SLOTS) * slotSize);
+
+    /* Consumers of a previous instance keep their mapping of the old object */
+    shm_unlink(point->shmName);
+    fd = shm_open(point->shmName, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, NUM_FRAME_EXPORT_AREA_MODE);
+    if(0 > fd) {
+
+        LOG_MSG_ERR(LOG_MOD_STREAM, STR_LOG_MSG_FUNC93_AREA_FAIL, point->shmName, strerror(errno));
+        retval = -1;
+        return retval;
+    }
+
+    if(0 > ftruncate(fd, (off_t)(point->areaSize))) {
+
+        LOG_MSG_ERR(LOG_MOD_STREAM, STR_LOG_MSG_FUNC93_AREA_FAIL, point->shmName, strerror(errno));
+        close(fd);
+        shm_unlink(point->shmName);
+        retval = -1;
+        return retval;
+    }
+
+    header = (FrameExportHeader_T*)mmap(NULL, point->areaSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if(MAP_FAILED == header) {
+
+        LOG_MSG_ERR(LOG_MOD_STREAM, STR_LOG_MSG_FUNC93_AREA_FAIL, point->shmName, strerror(errno));
+        shm_unlink(point->shmName);
+        retval = -1;
+        return retval;
+    }
+
+    /* A new object reads as zeros: frames, caps and consumer entries start empty */
+    header->version = NUM_FRAME_EXPORT_VERSION;
+    header->headerSize = (uint32_t)(sizeof(FrameExportHeader_T));
+    header->slotCount = NUM_FRAME_EXPORT_SLOTS;
+    header->slotSize = slotSize;
+    header->consumerCount = consumerCount;
+    header->dataOffset = dataOffset;
+    atomic_store(&header->writerPid, (int32_t)(getpid()));
+
+    /* Consumers check the signature last */
+    atomic_thread_fence(memory_order_release);
+    memcpy(header->magic, STR_FRAME_EXPORT_MAGIC, NUM_FRAME_EXPORT_MAGIC_SIZE);
+
+    point->header = header;
+
+    return retval;
+}
+
+static GstPadProbeReturn frameExportProbe(GstPad *pad, GstPadProbeInfo *info, gpointer data) {
+
+    ExportPoint_T *point = (ExportPoint_T*)data;
+    GstEvent *event = NULL;
+    GstCaps *caps = NULL;
+
+    (void)pad;
+
+    if(GST_PAD_PROBE_INFO_TYPE(info) & GST_PAD_PROBE_TYPE_BUFFER) {
+
+        pthread_mutex_lock(&point->lock);
+        if(NULL != point->pendingBuffer) {
+
+            gst_buffer_unref(point->pendingBuffer);
+            ++point->replaced;
+        }
+        point->pendingBuffer = gst_buffer_ref(GST_PAD_PROBE_INFO_BUFFER(info));
+        pthread_cond_signal(&point->cond);
+        pthread_mutex_unlock(&point->lock);
+    }
+    else {
+
+        event = GST_PAD_PROBE_INFO_EVENT(info);
+        if(GST_EVENT_CAPS == GST_EVENT_TYPE(event)) {
+
+            gst_event_parse_caps(event, &caps);
+
+            /* A waiting frame of the old caps is not exported after the new caps */
+            pthread_mutex_lock(&point->lock);
+            if(NULL != point->pendingBuffer) {
+
+                gst_buffer_unref(point->pendingBuffer);
+                point->pendingBuffer = NULL;
+                ++point->replaced;
+            }
+            g_free(point->pendingCaps);
+            point->pendingCaps = gst_caps_to_string(caps);
+            pthread_cond_signal(&point->cond);
+            pthread_mutex_unlock(&point->lock);
+        }
+    }
+
+    return GST_PAD_PROBE_OK;
+}
+
+static void *threadFuncFrameExport(void *arg) {
+
+    ExportPoint_T *point = (ExportPoint_T*)arg;
+    GstBuffer *buffer = NULL;
+    gchar *caps = NULL;
+    GstMapInfo map;
+    uint64_t pts;
+    uint64_t replaced;
+    int oversizeLogged = 0;
+
+    /* Best effort side work: scheduled like the log drainer */
+    applyThreadScheduling(SCHED_CLASS_LOG);
+
+    while(1) {
+
+        pthread_mutex_lock(&point->lock);
+        while((NULL == point->pendingBuffer) && (NULL == point->pendingCaps)) {
+
+            pthread_cond_wait(&point->cond, &point->lock);
+        }
+        buffer = point->pendingBuffer;
+        caps = point->pendingCaps;
+        replaced = point->replaced;
+        point->pendingBuffer = NULL;
+        point->pendingCaps = NULL;
+        point->replaced = 0U;
+        pthread_mutex_unlock(&point->lock);
+
+        if(0U < replaced) {
+
+            LOG_MSG_DBG(LOG_MOD_STREAM, STR_LOG_MSG_FUNC94_REPLACED, point->name, (unsigned long long)(replaced));
+        }
+
+        if(NULL != caps) {
+
+            writeExportCaps(point->header, caps);
+            g_free(caps);
+        }
+
+        if(NULL == buffer) {
+
+            continue;
+        }
+
+        if(TRUE != gst_buffer_map(buffer, &map, GST_MAP_READ)) {
+
+            LOG_MSG_WRN(LOG_MOD_STREAM, STR_LOG_MSG_FUNC94_MAP_FAIL, point->name);
+            gst_buffer_unref(buffer);
+            continue;
+        }
+
+        if(map.size > point->header->slotSize) {
+
+            atomic_fetch_add(&point->header->oversize, 1U);
+            if(!oversizeLogged) {
+
+                LOG_MSG_WRN(LOG_MOD_STREAM, STR_LOG_MSG_FUNC94_OVERSIZE, point->name, (unsigned int)(map.size), point->header->slotSize);
+                oversizeLogged = 1;
+            }
+        }
+        else {
+
+            pts = GST_CLOCK_TIME_IS_VALID(GST_BUFFER_PTS(buffer)) ? (uint64_t)(GST_BUFFER_PTS(buffer)) : NUM_FRAME_EXPORT_PTS_NONE;
+            writeExportFrame(point, map.data, (uint32_t)(map.size), pts,
+                GST_BUFFER_FLAG_IS_SET(buffer, GST_BUFFER_FLAG_DELTA_UNIT) ? NUM_FRAME_EXPORT_FLAG_DELTA : 0U);
+        }
+
+        gst_buffer_unmap(buffer, &map);
+        gst_buffer_unref(buffer);
+    }
+
+    return NULL;
+}
+
+static void writeExportFrame(ExportPoint_T *point, const uint8_t *frame, const uint32_t size, const uint64_t pts, const uint32_t flags) {
+
+    unsigned int i;
+    uint64_t sequence;
+    uint64_t previous;
+    uint32_t expected;
+    FrameExportHeader_T *header = point->header;
+    FrameExportSlot_T *slot = NULL;
+    FrameExportConsumer_T *consumer = NULL;
+
+    sequence = ++point->sequence;
+    slot = &header->slots[sequence % NUM_FRAME_EXPORT_SLOTS];
+
+    /* Invalidate the slot before checking its readers (pairs with the consumers' 'reading' store and re-check) */
+    previous = atomic_exchange(&slot->sequence, 0U);
+    if(0U != previous) {
+
+        for(i = 0;i < header->consumerCount;++i) {
+
+            consumer = &header->consumers[i];
+            expected = FRAME_CONSUMER_ATTACHED;
+            if((previous == atomic_load(&consumer->reading)) &&
+               atomic_compare_exchange_strong(&consumer->state, &expected, FRAME_CONSUMER_DROPPED)) {
+
+                atomic_fetch_add(&consumer->drops, 1U);
+            }
+        }
+    }
+    atomic_thread_fence(memory_order_release);
+
+    memcpy((uint8_t*)header + header->dataOffset + ((size_t)(sequence % NUM_FRAME_EXPORT_SLOTS) * header->slotSize), frame, size);
+    slot->pts = pts;
+    slot->size = size;
+    slot->flags = flags;
+
+    atomic_store_explicit(&slot->sequence, sequence, memory_order_release);
+    atomic_store_explicit(&header->sequence, sequence, memory_order_release);
+    atomic_fetch_add(&header->futex, 1U);
+    syscall(SYS_futex, &header->futex, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+
+    if(0U == (sequence % NUM_FRAME_EXPORT_RECLAIM_PERIOD)) {
+
+        reclaimExportConsumers(header);
+    }
+}
+
+static void writeExportCaps(FrameExportHeader_T *header, const char *caps) {
+
+    atomic_fetch_add(&header->capsSequence, 1U);
+    atomic_thread_fence(memory_order_release);
+    strncpy(header->caps, caps, NUM_FRAME_EXPORT_CAPS_SIZE - 1);
+    header->caps[NUM_FRAME_EXPORT_CAPS_SIZE - 1] = '\0';
+    atomic_fetch_add_explicit(&header->capsSequence, 1U, memory_order_release);
+}
+
+static void reclaimExportConsumers(FrameExportHeader_T *header) {
+
+    unsigned int i;
+    int32_t pid;
+    FrameExportConsumer_T *consumer = NULL;
+
+    for(i = 0;i < header->consumerCount;++i) {
+
+        consumer = &header->consumers[i];
+        pid = atomic_load(&consumer->pid);
+        if((0 != pid) && (0 > kill((pid_t)(pid), 0)) && (ESRCH == errno)) {
+
+            atomic_store(&consumer->state, FRAME_CONSUMER_FREE);
+            atomic_store(&consumer->reading, 0U);
+            atomic_store(&consumer->drops, 0U);
+            atomic_compare_exchange_strong(&consumer->pid, &pid, 0);
+        }
+    }
+}
@@ -3,66 +3,838 @@
  * @author      Adam Csizy
  * @date        2021-03-19
  * @version     v1.1.0
- * 
+ *
  * @brief       Logging utilities
  */
 
 
+#include <errno.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <syslog.h>
+#include <time.h>
 
 #include "log_utils.h"
+#include "recorder_utils.h"
+#include "sched_utils.h"
+
+
+/* Log related macro definitions */
+
+#define NUM_LOG_RING_SIZE           64U     /**< Number of records per thread ring (power of two) */
+#define NUM_LOG_RING_MASK           (NUM_LOG_RING_SIZE - 1U) /**< Ring index mask */
+#define NUM_LOG_RECORD_TEXT_SIZE    240U    /**< Maximum length of a formatted record including the terminator */
+#define NUM_LOG_DRAIN_PERIOD_NS     20000000L /**< Sleep of the drainer thread when all rings are empty (20 ms) */
+#define NUM_LOG_STATS_PERIOD_SEC    300U    /**< Period of the logger's own statistics record in seconds */
+#define NUM_NSEC_PER_SEC            1000000000ULL /**< Nanoseconds per second */
+#define NUM_LOG_TIME_STR_SIZE       32U     /**< Size of the log file timestamp string */
+
+#ifdef CC_DEBUG_MODE
+#define NUM_LOG_LEVEL_DEFAULT       NUM_LOG_LEVEL_DBG /**< Default runtime log level of every module */
+#else
+#define NUM_LOG_LEVEL_DEFAULT       NUM_LOG_LEVEL_INF /**< Default runtime log level of every module */
+#endif
+
+
+/* Log related static type declarations */
+
+/**
+ * @brief   Preformatted log record.
+ */
+typedef struct LogRecord {
+
+    uint64_t timestampNs;                   /**< Wall clock time of the record (CLOCK_REALTIME) */
+    LogSeverity_T severity;                 /**< Severity level */
+    char text[NUM_LOG_RECORD_TEXT_SIZE];    /**< Formatted message */
+
+} LogRecord_T;
+
+/**
+ * @brief   Per-thread log ring.
+ *
+ * @details Single-producer single-consumer ring: only the owner
+ *          thread advances 'head' and only the drainer (under
+ *          'drainLock') advances 'tail'. Rings are never freed; a
+ *          ring whose thread exited is marked unowned and adopted
+ *          by the next new thread right away, records still queued
+ *          included (the producer side is handed over, see
+ *          releaseThreadRing()).
+ */
+typedef struct LogRing {
+
+    LogRecord_T records[NUM_LOG_RING_SIZE]; /**< Record slots */
+    _Atomic uint32_t head;                  /**< Next slot to write (producer) */
+    _Atomic uint32_t tail;                  /**< Next slot to read (drainer) */
+    _Atomic uint64_t dropped;               /**< Records dropped on overflow (producer) */
+    _Atomic uint64_t produced;              /**< Records written (producer) */
+    _Atomic uint64_t producerNsTotal;       /**< Total producer cost (producer) */
+    _Atomic uint64_t producerNsMax;         /**< Maximum producer cost (producer) */
+    _Atomic int owned;                      /**< Non-zero while a live thread owns the ring */
+    uint64_t reportedDropped;               /**< Dropped count already reported (drainer) */
+    struct LogRing *next;                   /**< Next ring in the global list (immutable once published) */
+
+} LogRing_T;
+
+
+/* Log related static variable declarations */
+
+static _Atomic(LogRing_T*) ringList = NULL;         /**< Lock-free list of all thread rings */
+static __thread LogRing_T *threadRing = NULL;       /**< Ring of the calling thread */
+static pthread_key_t ringKey;                       /**< Key whose destructor releases a thread's ring */
+static pthread_once_t ringKeyOnce = PTHREAD_ONCE_INIT; /**< One-time initializer of 'ringKey' */
+static pthread_mutex_t drainLock = PTHREAD_MUTEX_INITIALIZER; /**< Serializes consumers (drainer thread and flushes) */
+static pthread_t threadLogDrainer;                  /**< Thread object of the log drainer */
+static _Atomic int drainerRunning = 0;              /**< Non-zero once the drainer thread runs */
+static _Atomic uint64_t ringlessDropped = 0;        /**< Records dropped because no ring could be allocated */
+static FILE *logFile = NULL;                        /**< Optional log file (see STR_LOG_ENV_FILE) */
+static _Atomic int logLevels[LOG_MOD_COUNT] = {[0 ... (LOG_MOD_COUNT - 1)] = NUM_LOG_LEVEL_DEFAULT}; /**< Runtime log level of each module */
+
+static const char *const logModuleNames[LOG_MOD_COUNT] = {
+
+    "general", "network", "stream", "camera", "netsink", "qos"
+
+}; /**< Names of the log modules (record prefix and STR_LOG_ENV_LEVEL keys) */
+
+static const char *const logLevelNames[] = {
+
+    "error", "warning", "info", "debug"
+
+}; /**< Names of the log severity levels in STR_LOG_ENV_LEVEL */
+
+
+/* Log related static function declarations */
+
+/**
+ * @brief       Get clock time in nanoseconds.
+ *
+ * @param[in]   clockId Clock identifier.
+ *
+ * @return      Clock time in nanoseconds.
+ */
+static uint64_t getClockNs(const clockid_t clockId);
+
+/**
+ * @brief       Create ring key.
+ *
+ * @details     One-time initializer creating the thread-specific
+ *              key whose destructor releases the ring of an exiting
+ *              thread.
+ */
+static void createRingKey(void);
+
+/**
+ * @brief       Release thread ring.
+ *
+ * @details     Thread-specific data destructor. Marks the ring as
+ *              unowned so that the next new thread adopts it, even
+ *              with records still queued: this release store and the
+ *              adopter's acq_rel compare-and-swap on 'owned' hand
+ *              'head' and the producer counters over, so there is
+ *              still a single producer and the drainer keeps reading
+ *              the queued records in order.
+ *
+ * @param[in,out]   ring Ring of the exiting thread.
+ */
+static void releaseThreadRing(void *ring);
+
+/**
+ * @brief       Acquire thread ring.
+ *
+ * @details     Returns the calling thread's ring. On the first call
+ *              of a thread an unowned ring is adopted or a new one is
+ *              allocated and pushed onto the global list with a
+ *              compare-and-swap.
+ *
+ * @return      Ring of the calling thread or NULL on allocation failure.
+ */
+static LogRing_T* acquireThreadRing(void);
+
+/**
+ * @brief       Format log record text.
+ *
+ * @details     Writes the module prefix (except for LOG_MOD_GENERAL)
+ *              and the formatted message into 'text'. Longer messages
+ *              are truncated.
+ *
+ * @param[out]  text Record text buffer.
+ * @param[in]   size Size of the record text buffer.
+ * @param[in]   module Log module.
+ * @param[in]   format printf-style format string.
+ * @param[in]   arguments Format arguments.
+ */
+static void formatRecordText(char *text, const size_t size, const LogModule_T module, const char *format, va_list arguments);
+
+/**
+ * @brief       Produce log record.
+ *
+ * @details     Formats the message into the next free slot of the
+ *              calling thread's ring and publishes it. Falls back to
+ *              a synchronous write while the drainer is not running.
+ *
+ * @param[in]   severity Log severity level.
+ * @param[in]   module Log module.
+ * @param[in]   format printf-style format string.
+ * @param[in]   arguments Format arguments.
+ */
+static void produceLogRecord(const LogSeverity_T severity, const LogModule_T module, const char *format, va_list arguments);
+
+/**
+ * @brief       Produce formatted log record.
+ *
+ * @details     Variadic wrapper of produceLogRecord().
+ *
+ * @param[in]   severity Log severity level.
+ * @param[in]   module Log module.
+ * @param[in]   format printf-style format string.
+ */
+static void produceLogRecordFormat(const LogSeverity_T severity, const LogModule_T module, const char *format, ...) __attribute__((format(printf, 3, 4)));
+
+/**
+ * @brief       Check log site rate limit.
+ *
+ * @details     Counts the record against the current window of the
+ *              site, opening a new window when the previous one has
+ *              expired. The number of records suppressed in expired
+ *              windows is returned through 'suppressed' exactly once.
+ *
+ * @param[in,out]   site Log call site.
+ * @param[out]  suppressed Records suppressed since the last summary
+ *              (non-zero only when a new window was opened).
+ *
+ * @return      Non-zero if the record may be emitted.
+ */
+static int checkLogSiteRate(LogSite_T *site, uint64_t *suppressed);
+
+/**
+ * @brief       Parse log levels.
+ *
+ * @details     Applies a comma separated list of "<level>" (all
+ *              modules) and "<module>=<level>" items, e.g.
+ *              "warning,network=debug". Invalid items are logged and
+ *              skipped.
+ *
+ * @param[in]   specification Log level specification.
+ */
+static void parseLogLevels(const char *specification);
+
+/**
+ * @brief       Find name in table.
+ *
+ * @param[in]   names Name table.
+ * @param[in]   count Number of names in the table.
+ * @param[in]   name Name to look up (need not be terminated).
+ * @param[in]   length Length of the name.
+ *
+ * @return      Index of the name or -1 if not found.
+ */
+static int findName(const char *const names[], const int count, const char *name, const size_t length);
+
+/**
+ * @brief       Emit log record.
+ *
+ * @details     Writes a record to the system log, the standard
+ *              output (debug mode) and the log file. Standard output
+ *              and the file are not flushed here so that a drain pass
+ *              costs a single flush per stream.
+ *
+ * @param[in]   record Log record.
+ */
+static void emitLogRecord(const LogRecord_T *record);
+
+/**
+ * @brief       Emit internal log record.
+ *
+ * @details     Formats and emits a record of the logger itself
+ *              directly, bypassing the rings.
+ *
+ * @param[in]   severity Log severity level.
+ * @param[in]   format printf-style format string.
+ */
+static void emitInternalRecord(const LogSeverity_T severity, const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+/**
+ * @brief       Drain log rings.
+ *
+ * @details     Emits every pending record of every ring in timestamp
+ *              order (k-way merge of the per-thread rings), reports
+ *              new overflow drops and flushes the output streams once.
+ *
+ * @return      Number of records emitted.
+ */
+static size_t drainLogRings(void);
+
+/**
+ * @brief       Start routine of the log drainer thread.
+ *
+ * @details     Drains the rings until they are empty, then sleeps
+ *              NUM_LOG_DRAIN_PERIOD_NS. Every NUM_LOG_STATS_PERIOD_SEC
+ *              seconds the producer-side statistics are logged.
+ *
+ * @param[in]   arg Launch argument (not used).
+ *
+ * @return      Any (not used).
+ */
+static void* threadFuncLogDrainer(void *arg);
 
 
 /* Log related function definitions */
 
 void createLogMessage(const char message[], const LogSeverity_T severity) {
 
-    switch(severity) {
+    createLogMessageFormat(severity, "%s", message);
+}
 
-        case LOG_SVRTY_ERR:
+void createLogMessageFormat(const LogSeverity_T severity, const char *format, ...) {
+
+    va_list arguments;
+
+    if(!isLogLevelEnabled(LOG_MOD_GENERAL, severity)) {
+
+        return;
+    }
+
+    va_start(arguments, format);
+    produceLogRecord(severity, LOG_MOD_GENERAL, format, arguments);
+    va_end(arguments);
+}
+
+void createLogRecord(LogSite_T *site, const LogSeverity_T severity, const LogModule_T module, const char *format, ...) {
+
+    uint64_t suppressed = 0;
+    va_list arguments;
+
+    if(!isLogLevelEnabled(module, severity)) {
+
+        return;
+    }
+
+    if(!checkLogSiteRate(site, &suppressed)) {
+
+        return;
+    }
+
+    if(0 < suppressed) {
+
+        produceLogRecordFormat(severity, module, STR_LOG_MSG_LOG_SUPPRESSED, (unsigned long long)(suppressed), site->file, site->line);
+    }
+
+    va_start(arguments, format);
+    produceLogRecord(severity, module, format, arguments);
+    va_end(arguments);
+}
+
+int setLogLevel(const LogModule_T module, const LogSeverity_T severity) {
+
+    int retval = 0;
+    int index;
+
+    if((0 > (int)(module)) || (LOG_MOD_COUNT < module) || (LOG_SVRTY_ERR > severity) || (LOG_SVRTY_DBG < severity)) {
+
+        retval = -1;
+        return retval;
+    }
+
+    for(index = 0;index < LOG_MOD_COUNT;++index) {
+
+        if((LOG_MOD_COUNT == module) || (index == (int)(module))) {
+
+            atomic_store_explicit(&logLevels[index], (int)(severity), memory_order_relaxed);
+        }
+    }
+
+    return retval;
+}
+
+int isLogLevelEnabled(const LogModule_T module, const LogSeverity_T severity) {
+
+    if((0 > (int)(module)) || (LOG_MOD_COUNT <= module)) {
+
+        return 1;
+    }
+
+    return ((int)(severity) <= atomic_load_explicit(&logLevels[module], memory_order_relaxed));
+}
+
+int initLogModule(void) {
+
+    int retval = 0;
+    const char *logFilePath = NULL;
+    const char *levelSpecification = NULL;
+
+    levelSpecification = getenv(STR_LOG_ENV_LEVEL);
+    if(NULL != levelSpecification) {
+
+        parseLogLevels(levelSpecification);
+    }
+
+    logFilePath = getenv(STR_LOG_ENV_FILE);
+    if((NULL != logFilePath) && ('\0' != logFilePath[0])) {
+
+        logFile = fopen(logFilePath, "a");
+        if(NULL == logFile) {
+
+            emitInternalRecord(LOG_SVRTY_WRN, STR_LOG_MSG_LOG_FILE_OPEN_FAIL, logFilePath, strerror(errno));
+        }
+    }
+
+    if(pthread_create(&threadLogDrainer, NULL, threadFuncLogDrainer, NULL)) {
+
+        emitInternalRecord(LOG_SVRTY_ERR, STR_LOG_MSG_LOG_THRD_START_FAIL);
+        retval = -1;
+        return retval;
+    }
+
+    atomic_store_explicit(&drainerRunning, 1, memory_order_release);
+    atexit(flushLogMessages);
+
+    return retval;
+}
+
+void flushLogMessages(void) {
+
+    drainLogRings();
+}
+
+int getLogStatistics(LogStatistics_T *stats) {
+
+    int retval = 0;
+    uint64_t ringMax;
+    LogRing_T *ring = NULL;
+
+    if(NULL == stats) {
+
+        retval = -1;
+        return retval;
+    }
+
+    memset(stats, 0, sizeof(*stats));
+    stats->dropped = atomic_load_explicit(&ringlessDropped, memory_order_relaxed);
+
+    for(ring = atomic_load_explicit(&ringList, memory_order_acquire);NULL != ring;ring = ring->next) {
+
+        stats->produced += atomic_load_explicit(&ring->produced, memory_order_relaxed);
+        stats->dropped += atomic_load_explicit(&ring->dropped, memory_order_relaxed);
+        stats->producerNsTotal += atomic_load_explicit(&ring->producerNsTotal, memory_order_relaxed);
+        ringMax = atomic_load_explicit(&ring->producerNsMax, memory_order_relaxed);
+        if(ringMax > stats->producerNsMax) {
+
+            stats->producerNsMax = ringMax;
+        }
+    }
+
+    return retval;
+}
+
+static uint64_t getClockNs(const clockid_t clockId) {
+
+    struct timespec now = {0};
+
+    clock_gettime(clockId, &now);
+
+    return ((uint64_t)(now.tv_sec) * NUM_NSEC_PER_SEC) + (uint64_t)(now.tv_nsec);
+}
+
+static void createRingKey(void) {
+
+    pthread_key_create(&ringKey, releaseThreadRing);
+}
+
+static void releaseThreadRing(void *ring) {
+
+    atomic_store_explicit(&((LogRing_T*)ring)->owned, 0, memory_order_release);
+}
+
+static LogRing_T* acquireThreadRing(void) {
+
+    int expected;
+    LogRing_T *ring = NULL;
+    LogRing_T *listHead = NULL;
+
+    if(NULL != threadRing) {
+
+        return threadRing;
+    }
+
+    /* Adopt the ring of an exited thread */
+    for(ring = atomic_load_explicit(&ringList, memory_order_acquire);NULL != ring;ring = ring->next) {
+
+        expected = 0;
+        if(atomic_compare_exchange_strong_explicit(&ring->owned, &expected, 1, memory_order_acq_rel, memory_order_relaxed)) {
 
-            syslog(LOG_DAEMON | LOG_ERR, "%s\n", message);
-            #ifdef CC_DEBUG_MODE
-            fprintf(stdout, "[ERROR] %s\n", message);
-            fflush(stdout);
-            #endif
             break;
+        }
+    }
 
-        case LOG_SVRTY_WRN:
+    /* Allocate and publish a new ring */
+    if(NULL == ring) {
+
+        ring = (LogRing_T*)calloc(1, sizeof(LogRing_T));
+        if(NULL == ring) {
+
+            return NULL;
+        }
+
+        atomic_init(&ring->owned, 1);
+        listHead = atomic_load_explicit(&ringList, memory_order_relaxed);
+        do {
+
+            ring->next = listHead;
+
+        } while(!atomic_compare_exchange_weak_explicit(&ringList, &listHead, ring, memory_order_release, memory_order_relaxed));
+    }
+
+    pthread_once(&ringKeyOnce, createRingKey);
+    pthread_setspecific(ringKey, ring);
+    threadRing = ring;
+
+    return ring;
+}
+
+static void formatRecordText(char *text, const size_t size, const LogModule_T module, const char *format, va_list arguments) {
+
+    int prefixLength = 0;
+
+    if((LOG_MOD_GENERAL != module) && (0 <= (int)(module)) && (LOG_MOD_COUNT > module)) {
+
+        prefixLength = snprintf(text, size, "%s: ", logModuleNames[module]);
+        if((0 > prefixLength) || ((size_t)(prefixLength) >= size)) {
+
+            prefixLength = 0;
+        }
+    }
+
+    vsnprintf(text + prefixLength, size - (size_t)(prefixLength), format, arguments);
+}
+
+static void produceLogRecordFormat(const LogSeverity_T severity, const LogModule_T module, const char *format, ...) {
+
+    va_list arguments;
+
+    va_start(arguments, format);
+    produceLogRecord(severity, module, format, arguments);
+    va_end(arguments);
+}
+
+static int checkLogSiteRate(LogSite_T *site, uint64_t *suppressed) {
+
+    uint64_t now, windowStart;
+
+    *suppressed = 0;
+
+    /* Window start is stored as seconds + 1 so that 0 marks an unused site */
+    now = (getClockNs(CLOCK_MONOTONIC) / NUM_NSEC_PER_SEC) + 1U;
+    windowStart = atomic_load_explicit(&site->windowStart, memory_order_acquire);
+
+    if((0 == windowStart) || ((now - windowStart) >= site->windowSec)) {
+
+        /* Only the thread winning the exchange opens the window and collects the summary */
+        if(atomic_compare_exchange_strong_explicit(&site->windowStart, &windowStart, now, memory_order_acq_rel, memory_order_relaxed)) {
+
+            atomic_store_explicit(&site->count, 0, memory_order_relaxed);
+            *suppressed = atomic_exchange_explicit(&site->suppressed, 0, memory_order_relaxed);
+        }
+    }
+
+    if(atomic_fetch_add_explicit(&site->count, 1, memory_order_relaxed) < site->burst) {
+
+        return 1;
+    }
+
+    atomic_fetch_add_explicit(&site->suppressed, 1, memory_order_relaxed);
+
+    return 0;
+}
+
+static int findName(const char *const names[], const int count, const char *name, const size_t length) {
+
+    int index;
+
+    for(index = 0;index < count;++index) {
+
+        if((strlen(names[index]) == length) && (0 == strncmp(names[index], name, length))) {
+
+            return index;
+        }
+    }
+
+    return -1;
+}
+
+static void parseLogLevels(const char *specification) {
+
+    int module, level;
+    size_t itemLength;
+    const char *item = specification;
+    const char *itemEnd = NULL;
+    const char *separator = NULL;
+
+    while('\0' != *item) {
+
+        itemEnd = strchr(item, ',');
+        if(NULL == itemEnd) {
+
+            itemEnd = item + strlen(item);
+        }
+        itemLength = (size_t)(itemEnd - item);
+
+        separator = memchr(item, '=', itemLength);
+        if(NULL == separator) {
+
+            /* "<level>": applies to every module */
+            module = LOG_MOD_COUNT;
+            level = findName(logLevelNames, (int)(sizeof(logLevelNames) / sizeof(logLevelNames[0])), item, itemLength);
+        }
+        else {
+
+            /* "<module>=<level>" */
+            module = findName(logModuleNames, LOG_MOD_COUNT, item, (size_t)(separator - item));
+            level = findName(logLevelNames, (int)(sizeof(logLevelNames) / sizeof(logLevelNames[0])), separator + 1, (size_t)(itemEnd - separator - 1));
+        }
+
+        if((0 < itemLength) && ((0 > module) || (0 > level) || setLogLevel((LogModule_T)(module), (LogSeverity_T)(level)))) {
+
+            emitInternalRecord(LOG_SVRTY_WRN, STR_LOG_MSG_LOG_LEVEL_INVAL, specification);
+        }
+
+        item = ('\0' == *itemEnd) ? itemEnd : (itemEnd + 1);
+    }
+}
+
+static void produceLogRecord(const LogSeverity_T severity, const LogModule_T module, const char *format, va_list arguments) {
+
+    uint32_t head, tail;
+    uint64_t start, elapsed;
+    LogRing_T *ring = NULL;
+    LogRecord_T *record = NULL;
+    LogRecord_T localRecord;
+
+    start = getClockNs(CLOCK_MONOTONIC);
+
+    /* No drainer yet (or it failed to start): keep the original synchronous behaviour */
+    if(!atomic_load_explicit(&drainerRunning, memory_order_acquire)) {
+
+        localRecord.timestampNs = getClockNs(CLOCK_REALTIME);
+        localRecord.severity = severity;
+        formatRecordText(localRecord.text, sizeof(localRecord.text), module, format, arguments);
+        if(LOG_SVRTY_WRN >= severity) {
+
+            recordFlightEvent(REC_EVT_LOG, (uint16_t)(severity), (int32_t)(module), 0, localRecord.text);
+        }
+        emitLogRecord(&localRecord);
+        fflush(stdout);
+        return;
+    }
 
-            syslog(LOG_DAEMON | LOG_WARNING, "%s\n", message);
-            #ifdef CC_DEBUG_MODE
-            fprintf(stdout, "[WARNING] %s\n", message);
-            fflush(stdout);
-            #endif
+    ring = acquireThreadRing();
+    if(NULL == ring) {
+
+        atomic_fetch_add_explicit(&ringlessDropped, 1, memory_order_relaxed);
+        return;
+    }
+
+    head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+    if(NUM_LOG_RING_SIZE <= (head - tail)) {
+
+        /* Ring full: drop instead of blocking the (possibly real-time) caller */
+        atomic_store_explicit(&ring->dropped, atomic_load_explicit(&ring->dropped, memory_order_relaxed) + 1, memory_order_relaxed);
+        return;
+    }
+
+    record = &ring->records[head & NUM_LOG_RING_MASK];
+    record->timestampNs = getClockNs(CLOCK_REALTIME);
+    record->severity = severity;
+    formatRecordText(record->text, sizeof(record->text), module, format, arguments);
+    if(LOG_SVRTY_WRN >= severity) {
+
+        recordFlightEvent(REC_EVT_LOG, (uint16_t)(severity), (int32_t)(module), 0, record->text);
+    }
+
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+
+    /* Producer-side cost (single writer: plain load/store suffices) */
+    elapsed = getClockNs(CLOCK_MONOTONIC) - start;
+    atomic_store_explicit(&ring->produced, atomic_load_explicit(&ring->produced, memory_order_relaxed) + 1, memory_order_relaxed);
+    atomic_store_explicit(&ring->producerNsTotal, atomic_load_explicit(&ring->producerNsTotal, memory_order_relaxed) + elapsed, memory_order_relaxed);
+    if(elapsed > atomic_load_explicit(&ring->producerNsMax, memory_order_relaxed)) {
+
+        atomic_store_explicit(&ring->producerNsMax, elapsed, memory_order_relaxed);
+    }
+}
+
+static void emitLogRecord(const LogRecord_T *record) {
+
+    int priority;
+    const char *label = NULL;
+    const char *text = record->text;
+    char timeString[NUM_LOG_TIME_STR_SIZE] = {0};
+    time_t seconds;
+    struct tm localTime;
+
+    switch(record->severity) {
+
+        case LOG_SVRTY_ERR:
+            priority = LOG_ERR;
+            label = "ERROR";
             break;
 
-        case LOG_SVRTY_INF:
+        case LOG_SVRTY_WRN:
+            priority = LOG_WARNING;
+            label = "WARNING";
+            break;
 
-            syslog(LOG_DAEMON | LOG_INFO, "%s\n", message);
-            #ifdef CC_DEBUG_MODE
-            fprintf(stdout, "[INFORMATION] %s\n", message);
-            fflush(stdout);
-            #endif
+        case LOG_SVRTY_INF:
+            priority = LOG_INFO;
+            label = "INFORMATION";
             break;
 
         case LOG_SVRTY_DBG:
-
-            syslog(LOG_DAEMON | LOG_DEBUG, "%s\n", message);
-            #ifdef CC_DEBUG_MODE
-            fprintf(stdout, "[DEBUG] %s\n", message);
-            fflush(stdout);
-            #endif
+            priority = LOG_DEBUG;
+            label = "DEBUG";
             break;
 
         default:
-
-            syslog(LOG_DAEMON | LOG_WARNING, STR_LOG_MSG_UNEXP_SVRTY_LVL);
-            #ifdef CC_DEBUG_MODE
-            fprintf(stdout, "[WARNING] %s\n", STR_LOG_MSG_UNEXP_SVRTY_LVL);
-            fflush(stdout);
-            #endif
+            priority = LOG_WARNING;
+            label = "WARNING";
+            text = STR_LOG_MSG_UNEXP_SVRTY_LVL;
             break;
     }
-}
\ No newline at end of file
+
+    syslog(LOG_DAEMON | priority, "%s", text);
+
+    #ifdef CC_DEBUG_MODE
+    fprintf(stdout, "[%s] %s\n", label, text);
+    #endif
+
+    if(NULL != logFile) {
+
+        seconds = (time_t)(record->timestampNs / NUM_NSEC_PER_SEC);
+        localtime_r(&seconds, &localTime);
+        strftime(timeString, sizeof(timeString), "%Y-%m-%d %H:%M:%S", &localTime);
+        fprintf(logFile, "%s.%06llu [%s] %s\n", timeString,
+            (unsigned long long)((record->timestampNs % NUM_NSEC_PER_SEC) / 1000ULL), label, text);
+    }
+}
+
+static void emitInternalRecord(const LogSeverity_T severity, const char *format, ...) {
+
+    va_list arguments;
+    LogRecord_T record;
+
+    record.timestampNs = getClockNs(CLOCK_REALTIME);
+    record.severity = severity;
+
+    va_start(arguments, format);
+    vsnprintf(record.text, sizeof(record.text), format, arguments);
+    va_end(arguments);
+
+    emitLogRecord(&record);
+}
+
+static size_t drainLogRings(void) {
+
+    size_t emitted = 0;
+    size_t reports = 0;
+    uint32_t head, tail;
+    uint64_t dropped;
+    LogRing_T *ring = NULL;
+    LogRing_T *oldest = NULL;
+    LogRecord_T *record = NULL;
+    LogRecord_T *oldestRecord = NULL;
+
+    pthread_mutex_lock(&drainLock);
+
+    /* Merge rings by timestamp so the output keeps cross-thread order */
+    do {
+
+        oldest = NULL;
+        oldestRecord = NULL;
+
+        for(ring = atomic_load_explicit(&ringList, memory_order_acquire);NULL != ring;ring = ring->next) {
+
+            tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+            head = atomic_load_explicit(&ring->head, memory_order_acquire);
+            if(tail != head) {
+
+                record = &ring->records[tail & NUM_LOG_RING_MASK];
+                if((NULL == oldestRecord) || (record->timestampNs < oldestRecord->timestampNs)) {
+
+                    oldest = ring;
+                    oldestRecord = record;
+                }
+            }
+        }
+
+        if(NULL != oldest) {
+
+            emitLogRecord(oldestRecord);
+            tail = atomic_load_explicit(&oldest->tail, memory_order_relaxed);
+            atomic_store_explicit(&oldest->tail, tail + 1, memory_order_release);
+            ++emitted;
+        }
+
+    } while(NULL != oldest);
+
+    /* Report overflow drops since the previous pass */
+    for(ring = atomic_load_explicit(&ringList, memory_order_acquire);NULL != ring;ring = ring->next) {
+
+        dropped = atomic_load_explicit(&ring->dropped, memory_order_relaxed);
+        if(dropped != ring->reportedDropped) {
+
+            emitInternalRecord(LOG_SVRTY_WRN, STR_LOG_MSG_LOG_RECORDS_DROPPED, (unsigned long long)(dropped - ring->reportedDropped));
+            ring->reportedDropped = dropped;
+            ++reports;
+        }
+    }
+
+    if(0 < (emitted + reports)) {
+
+        fflush(stdout);
+        if(NULL != logFile) {
+
+            fflush(logFile);
+        }
+    }
+
+    pthread_mutex_unlock(&drainLock);
+
+    return emitted;
+}
+
+static void* threadFuncLogDrainer(void *arg) {
+
+    uint64_t now, lastStats;
+    struct timespec period = {.tv_sec = 0, .tv_nsec = NUM_LOG_DRAIN_PERIOD_NS};
+    LogStatistics_T stats;
+
+    applyThreadScheduling(SCHED_CLASS_LOG);
+
+    lastStats = getClockNs(CLOCK_MONOTONIC);
+
+    while(1) {
+
+        if(0 == drainLogRings()) {
+
+            nanosleep(&period, NULL);
+        }
+
+        now = getClockNs(CLOCK_MONOTONIC);
+        if((now - lastStats) >= (NUM_LOG_STATS_PERIOD_SEC * NUM_NSEC_PER_SEC)) {
+
+            getLogStatistics(&stats);
+            emitInternalRecord(LOG_SVRTY_DBG, STR_LOG_MSG_LOG_STATS,
+                (unsigned long long)(stats.produced), (unsigned long long)(stats.dropped),
+                (0 < stats.produced) ? ((double)(stats.producerNsTotal) / (double)(stats.produced)) : 0.0,
+                (unsigned long long)(stats.producerNsMax));
+            lastStats = now;
+        }
+    }
+
+    return NULL;
+}
@@ -15,23 +15,33 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include "clock_utils.h"
 #include "com_utils.h"
+#include "frame_export_utils.h"
 #include "log_utils.h"
+#include "recorder_utils.h"
+#include "sched_utils.h"
+#include "startup_utils.h"
 #include "stream_utils.h"
+#include "telemetry_utils.h"
+#include "trace_utils.h"
 
 /*
- * Compile like this:
+ * Compile like this (from the CompanionComputer directory, see the Makefile for every option):
  * 
- * gcc -DCC_DEBUG_MODE -O0 -ggdb -Wall log_utils.c com_utils.c camera_utils.c stream_utils.c main.c -pthread -I/<path_to_repo>/CompanionComputer/includes -o streamerapp `pkg-config --cflags --libs gstreamer-1.0`
+ * make DEBUG=1                 # build/streamerapp
  *
  * Launch like this:
  * 
  * ./streamerapp
  * ./streamerapp <GC_IP> <GC_PORT>
+ *
+ * Optional features are set with CC_* environment variables (see the module headers).
  */
 
 
 #define STR_SYSLOG_PROG_NAME                "DroneVideoStreamer" /**< Program's name in the system logger */
+#define STR_ENV_FOREGROUND                  "CC_FOREGROUND" /**< Environment variable keeping the program in the foreground (no daemon) */
 
 
 /**
@@ -49,9 +59,12 @@ int main(int argc, char* argv[]) {
     
     NetworkInitContext_T *networkCtx = NULL;
 
+    /* Reference time of the startup milestones (connected, ready, first packet) */
+    initStartupClock();
+
     /* Start program as system daemon */
     #ifndef CC_DEBUG_MODE
-    if(daemon(0, 0) < 0) {
+    if((NULL == getenv(STR_ENV_FOREGROUND)) && (daemon(0, 0) < 0)) {
         
         /* Failed to create daemon */
         perror("daemon");
@@ -64,6 +77,20 @@ int main(int argc, char* argv[]) {
     /* Open connection to the system logger */
     openlog(STR_SYSLOG_PROG_NAME, LOG_PID | LOG_NDELAY, LOG_DAEMON);
 
+    /* Thread scheduling and CPU affinity (before any thread starts, optional) */
+    initThreadScheduling(getenv(STR_SCHED_ENV_SPEC));
+
+    /* Start asynchronous logging (falls back to synchronous logging on failure) */
+    initLogModule();
+
+    /* Open crash-surviving flight recorder (optional) */
+    initFlightRecorder();
+
+    /* Write event trace at exit and on SIGUSR1 */
+    #ifdef CC_TRACE_ENABLED
+    initTraceModule();
+    #endif
+
     /* Log program startup */
     createLogMessage(STR_LOG_MSG_MAIN_PROG_STARTUP, LOG_SVRTY_INF);
 
@@ -83,18 +110,29 @@ int main(int argc, char* argv[]) {
         exit(EXIT_FAILURE);
     }
 
+    /* Accept telemetry from local producers (optional, before the network module sends it) */
+    initTelemetryModule();
+
+    /* Synchronize to the ground control's clock (optional, before the network module exchanges) */
+    initClockSync();
+
     /* Initialize and start network module */
     if(initNetworkModule(networkCtx)) {
 
         createLogMessage(STR_LOG_MSG_MAIN_MOD_NET_INIT_FAIL, LOG_SVRTY_ERR);
+        flushLogMessages();
         closelog();
         exit(EXIT_FAILURE);
     }
 
+    /* Export frames to other on board processes (optional, before the first pipeline is built) */
+    initFrameExport();
+
     /* Initialize and start streaming module */
     if(initStreamModule()) {
 
         createLogMessage(STR_LOG_MSG_MAIN_MOD_STRM_INIT_FAIL, LOG_SVRTY_ERR);
+        flushLogMessages();
         closelog();
         exit(EXIT_FAILURE);
     }
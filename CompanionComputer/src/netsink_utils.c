@@ -0,0 +1,1862 @@
+/**
+ * @file        netsink_utils.c
+ * @author      Adam Csizy
+ * @date        2021-05-02
+ * @version     v1.1.0
+ *
+ * @brief       Batched UDP network sink utilities
+ */
+
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE     /**< sendmmsg() and struct mmsghdr */
+#endif
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <gst/gst.h>
+#include <gst/base/gstbasesink.h>
+#include <linux/sockios.h>
+#include <net/if.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "log_utils.h"
+#include "netsink_utils.h"
+#include "qos_utils.h"
+#include "trace_utils.h"
+
+
+/* Network sink related macro definitions */
+
+#ifndef SOL_UDP
+#define SOL_UDP                             17      /**< Socket option level of UDP (older libc headers) */
+#endif
+
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT                         103     /**< UDP segmentation offload socket option (Linux 4.18+) */
+#endif
+
+#define NUM_NETSINK_BATCH_SIZE              64U     /**< Maximum number of packets handed to a single 'sendmmsg()' call */
+#define NUM_NETSINK_MAX_IOV_PER_PKT         8U      /**< Maximum number of memory blocks per packet mapped without merging */
+#define NUM_NETSINK_GSO_MAX_SEGMENTS        64U     /**< Maximum number of segments per GSO message (kernel's UDP_MAX_SEGMENTS) */
+#define NUM_NETSINK_GSO_MAX_SEG_SIZE        1472U   /**< Maximum GSO segment size (Ethernet MTU minus IPv4 and UDP headers) */
+#define NUM_NETSINK_GSO_MAX_BYTES           61440U  /**< Maximum payload size of a GSO message in bytes */
+#define NUM_NETSINK_DEFAULT_PORT            5004    /**< Default destination port (same as the stock 'udpsink') */
+#define STR_NETSINK_DEFAULT_HOST            "localhost" /**< Default destination host (same as the stock 'udpsink') */
+#define NUM_NETSINK_METER_REPORT_FRAMES     900U    /**< Number of frames between two network sink meter reports */
+#define NUM_NSEC_PER_SEC                    1000000000LL /**< Nanoseconds per second */
+#define NUM_RTP_HDR_MARKER_OFFSET           1U      /**< Offset of the byte holding the RTP marker bit */
+#define NUM_RTP_HDR_MARKER_MASK             0x80U   /**< Mask of the RTP marker bit */
+#define NUM_NETSINK_PATH_MAX                4U      /**< Maximum number of multipath paths */
+#define NUM_NETSINK_PATH_LOCAL_SIZE         64U     /**< Size of a path's local address or interface name */
+#define NUM_NETSINK_PATH_UPDATE_NS          100000000LL /**< Period of the path capacity estimation (100 ms) */
+#define NUM_NETSINK_PATH_RETRY_NS           1000000000LL /**< A failed path is tried again after this long */
+#define NUM_NETSINK_PATH_MIN_CAPACITY       125000.0 /**< Capacity floor of a path in bytes per second (1 Mbit/s) */
+#define NUM_NETSINK_PATH_EWMA_GAIN          0.25    /**< Weight of a new drain rate sample of a backlogged path */
+#define NUM_NETSINK_PATH_PROBE_GAIN         1.25    /**< Capacity growth per estimate of a path keeping up (at most twice its drain rate) */
+#define NUM_NETSINK_PATH_BACKLOG_DIV        4       /**< A path with more than 1/N of its send buffer unsent is backlogged */
+#define NUM_NETSINK_PATH_DEFICIT_MAX        262144.0 /**< Bound of the bonding scheduler's byte deficit per path */
+#define NUM_NETSINK_PATH_LOG_BURST          3U      /**< Number of records a path state log site may emit per window */
+#define NUM_NETSINK_PATH_LOG_WINDOW_SEC     60U     /**< Rate window of path state log sites in seconds (paths may flap) */
+
+
+/* Network sink related static type declarations */
+
+/**
+ * @brief   Enumeration of batched UDP network sink properties.
+ */
+typedef enum NetworkSinkProperty {
+
+    NETSINK_PROP_0      = 0,    /**< Reserved by GObject */
+    NETSINK_PROP_HOST   = 1,    /**< Destination host */
+    NETSINK_PROP_PORT   = 2,    /**< Destination port */
+    NETSINK_PROP_GSO    = 3,    /**< UDP segmentation offload enabled */
+    NETSINK_PROP_DSCP   = 4,    /**< DSCP of outgoing packets (-1: not set) */
+    NETSINK_PROP_PRIO   = 5,    /**< Socket priority (-1: not set) */
+    NETSINK_PROP_BUFSZ  = 6,    /**< Socket send buffer size (0: default) */
+    NETSINK_PROP_PATHS  = 7,    /**< Multipath path list (NULL: single path) */
+    NETSINK_PROP_MPMODE = 8     /**< Multipath mode */
+
+} NetworkSinkProperty_T;
+
+/**
+ * @brief   Enumeration of multipath modes.
+ */
+typedef enum NetworkSinkMultipathMode {
+
+    NETSINK_MULTIPATH_REDUNDANT = 0,    /**< Every packet is sent on every path (STR_NETSINK_MULTIPATH_REDUNDANT) */
+    NETSINK_MULTIPATH_BONDING   = 1     /**< Packets are split by the estimated path capacities (STR_NETSINK_MULTIPATH_BONDING) */
+
+} NetworkSinkMultipathMode_T;
+
+/**
+ * @brief   Multipath path.
+ *
+ * @details A path is an UDP socket bound to a local address or
+ *          network interface with its own destination. Capacity
+ *          is estimated from the bytes leaving the socket's send
+ *          queue (SIOCOUTQ) every NUM_NETSINK_PATH_UPDATE_NS: a
+ *          backlogged or congested path is worth its drain rate,
+ *          a path keeping up is probed upwards. A path failing
+ *          with a routing error is taken down and tried again
+ *          after NUM_NETSINK_PATH_RETRY_NS (its socket is opened
+ *          again if the interface or address went away).
+ */
+typedef struct NetworkSinkPath {
+
+    char local[NUM_NETSINK_PATH_LOCAL_SIZE];    /**< Local address or interface name */
+    struct sockaddr_storage localAddress;       /**< Local address (family AF_UNSPEC for an interface) */
+    socklen_t localAddressLength;               /**< Length of the local address (0 for an interface) */
+    struct sockaddr_storage destAddress;        /**< Resolved destination address */
+    socklen_t destAddressLength;                /**< Length of the destination address */
+    gint fixedPort;                             /**< Destination port of the path (0: 'port' property) */
+    int socketFd;                               /**< UDP socket (-1 while not open) */
+    int sendBufferSize;                         /**< Kernel send buffer size of the socket in bytes */
+    int up;                                     /**< Path in use */
+    int congested;                              /**< Send queue overflowed since the last estimate */
+    gint64 downSinceNs;                         /**< CLOCK_MONOTONIC of the last failure */
+    double capacity;                            /**< Estimated capacity in bytes per second */
+    double deficit;                             /**< Bytes owed to the path by the bonding scheduler */
+    guint64 intervalBytes;                      /**< Bytes handed to the kernel since the last estimate */
+    int lastQueued;                             /**< Unsent bytes of the socket at the last estimate */
+    guint64 packets;                            /**< Packets handed to the kernel */
+    guint64 bytes;                              /**< Bytes handed to the kernel */
+    guint64 errors;                             /**< Failed send system calls */
+
+} NetworkSinkPath_T;
+
+/**
+ * @brief   Batched UDP network sink instance.
+ *
+ * @details The per-packet arrays are part of the instance so
+ *          the streaming thread never allocates while sending.
+ *          Packet 'p' owns the I/O vector entries starting at
+ *          'packetIovStart[p]', which keeps the vectors of
+ *          consecutive packets contiguous for GSO messages.
+ */
+typedef struct BatchUdpSink {
+
+    GstBaseSink parent;                                                     /**< Parent instance */
+
+    gchar *host;                                                            /**< Destination host */
+    gint port;                                                              /**< Destination port */
+    gboolean gso;                                                           /**< UDP segmentation offload requested */
+    gint dscp;                                                              /**< DSCP of outgoing packets (-1: not set) */
+    gint priority;                                                          /**< Socket priority (-1: not set) */
+    gint bufferSize;                                                        /**< Socket send buffer size (0: default) */
+    gchar *paths;                                                           /**< Multipath path list (NULL: single path) */
+    gchar *multipathMode;                                                   /**< Multipath mode name */
+
+    int socketFd;                                                           /**< UDP socket (-1 with multipath) */
+    int gsoActive;                                                          /**< UDP segmentation offload in use */
+    struct sockaddr_storage destAddress;                                    /**< Resolved destination address */
+    socklen_t destAddressLength;                                            /**< Length of the destination address */
+    NetworkSinkPath_T path[NUM_NETSINK_PATH_MAX];                           /**< Multipath paths */
+    size_t pathCount;                                                       /**< Number of paths (0: single path) */
+    NetworkSinkMultipathMode_T mode;                                        /**< Multipath mode */
+    gint64 pathUpdateNs;                                                    /**< CLOCK_MONOTONIC of the last capacity estimate */
+
+    struct iovec iov[NUM_NETSINK_BATCH_SIZE * NUM_NETSINK_MAX_IOV_PER_PKT]; /**< I/O vectors of the mapped packets */
+    GstMapInfo memoryMaps[NUM_NETSINK_BATCH_SIZE * NUM_NETSINK_MAX_IOV_PER_PKT]; /**< Memory mappings backing 'iov' */
+    GstMapInfo bufferMaps[NUM_NETSINK_BATCH_SIZE];                          /**< Merged buffer mappings (many-memory packets) */
+    GstBuffer *mergedBuffers[NUM_NETSINK_BATCH_SIZE];                       /**< Buffers mapped as a whole (NULL otherwise) */
+    size_t packetIovStart[NUM_NETSINK_BATCH_SIZE];                          /**< First I/O vector of each packet */
+    size_t packetIovCount[NUM_NETSINK_BATCH_SIZE];                          /**< Number of I/O vectors of each packet */
+    size_t packetLength[NUM_NETSINK_BATCH_SIZE];                            /**< Length of each packet in bytes */
+    size_t messagePacket[NUM_NETSINK_BATCH_SIZE + 1];                       /**< First packet of each message (plus sentinel) */
+    struct mmsghdr messages[NUM_NETSINK_BATCH_SIZE];                        /**< Messages handed to 'sendmmsg()' */
+    union {
+
+        char buffer[CMSG_SPACE(sizeof(uint16_t))];
+        struct cmsghdr align;
+
+    } control[NUM_NETSINK_BATCH_SIZE];                                      /**< GSO control messages */
+
+    NetworkSinkStatistics_T stats;                                          /**< Statistics (protected by the object lock) */
+
+} BatchUdpSink;
+
+/**
+ * @brief   Batched UDP network sink class.
+ */
+typedef struct BatchUdpSinkClass {
+
+    GstBaseSinkClass parentClass;   /**< Parent class */
+
+} BatchUdpSinkClass;
+
+/**
+ * @brief   Network sink meter context.
+ */
+typedef struct NetworkSinkMeter {
+
+    GstElement *networkSink;                /**< Metered network sink element (not referenced) */
+    guint64 frames;                         /**< Frames since the last report */
+    guint64 packets;                        /**< Packets since the last report */
+    gint64 cpuTimeNs;                       /**< Streaming thread CPU time since the last report */
+    gint64 lastCpuTimeNs;                   /**< Streaming thread CPU time at the previous probe */
+    NetworkSinkStatistics_T lastStats;      /**< Sink statistics at the last report */
+
+} NetworkSinkMeter_T;
+
+
+/* Network sink related static variable declarations */
+
+static GstStaticPadTemplate networkSinkTemplate = GST_STATIC_PAD_TEMPLATE("sink", GST_PAD_SINK, GST_PAD_ALWAYS, GST_STATIC_CAPS_ANY);
+
+G_DEFINE_TYPE(BatchUdpSink, batch_udp_sink, GST_TYPE_BASE_SINK);
+
+
+/* Network sink related static function declarations */
+
+/**
+ * @brief       Get calling thread's CPU time.
+ *
+ * @return      Thread CPU time in nanoseconds.
+ */
+static gint64 getThreadCpuTimeNs(void);
+
+/**
+ * @brief       Get monotonic time.
+ *
+ * @return      CLOCK_MONOTONIC in nanoseconds.
+ */
+static gint64 getMonotonicTimeNs(void);
+
+/**
+ * @brief       Batched UDP network sink property setter.
+ *
+ * @param[in,out]   object Network sink instance.
+ * @param[in]   propertyId Property identifier (see NetworkSinkProperty_T).
+ * @param[in]   value New property value.
+ * @param[in]   pspec Property specification.
+ */
+static void batchUdpSinkSetProperty(GObject *object, guint propertyId, const GValue *value, GParamSpec *pspec);
+
+/**
+ * @brief       Batched UDP network sink property getter.
+ *
+ * @param[in]   object Network sink instance.
+ * @param[in]   propertyId Property identifier (see NetworkSinkProperty_T).
+ * @param[out]  value Property value.
+ * @param[in]   pspec Property specification.
+ */
+static void batchUdpSinkGetProperty(GObject *object, guint propertyId, GValue *value, GParamSpec *pspec);
+
+/**
+ * @brief       Batched UDP network sink finalizer.
+ *
+ * @param[in,out]   object Network sink instance.
+ */
+static void batchUdpSinkFinalize(GObject *object);
+
+/**
+ * @brief       Start batched UDP network sink.
+ *
+ * @details     Resolves the destination host, opens the UDP
+ *              socket, probes kernel support for UDP segmentation
+ *              offload and resets the statistics. Invoked by the
+ *              base class on the READY -> PAUSED transition.
+ *
+ * @param[in,out]   baseSink Network sink instance.
+ *
+ * @return      TRUE on success, FALSE otherwise.
+ */
+static gboolean batchUdpSinkStart(GstBaseSink *baseSink);
+
+/**
+ * @brief       Stop batched UDP network sink.
+ *
+ * @details     Closes the UDP socket and logs the statistics
+ *              collected since the sink was started.
+ *
+ * @param[in,out]   baseSink Network sink instance.
+ *
+ * @return      TRUE
+ */
+static gboolean batchUdpSinkStop(GstBaseSink *baseSink);
+
+/**
+ * @brief       Render a single buffer.
+ *
+ * @param[in,out]   baseSink Network sink instance.
+ * @param[in]   buffer RTP packet.
+ *
+ * @return      GST_FLOW_OK on success, GST_FLOW_ERROR otherwise.
+ */
+static GstFlowReturn batchUdpSinkRender(GstBaseSink *baseSink, GstBuffer *buffer);
+
+/**
+ * @brief       Render a buffer list.
+ *
+ * @details     Maps the RTP packets of the list in batches of at
+ *              most NUM_NETSINK_BATCH_SIZE packets and sends each
+ *              batch with as few system calls as possible.
+ *
+ * @param[in,out]   baseSink Network sink instance.
+ * @param[in]   bufferList RTP packets of (usually) one video frame.
+ *
+ * @return      GST_FLOW_OK on success, GST_FLOW_ERROR otherwise.
+ */
+static GstFlowReturn batchUdpSinkRenderList(GstBaseSink *baseSink, GstBufferList *bufferList);
+
+/**
+ * @brief       Map packet.
+ *
+ * @details     Maps the memory blocks of the given buffer into the
+ *              I/O vector slots of packet 'packet'. Buffers consisting
+ *              of more than NUM_NETSINK_MAX_IOV_PER_PKT memory blocks
+ *              are mapped as a whole (merged by GStreamer).
+ *
+ * @param[in,out]   sink Network sink instance.
+ * @param[in]   buffer RTP packet.
+ * @param[in]   packet Packet slot index.
+ * @param[in,out]   iovUsed Number of used I/O vector slots.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+static int mapPacket(BatchUdpSink *sink, GstBuffer *buffer, const size_t packet, size_t *iovUsed);
+
+/**
+ * @brief       Unmap packets.
+ *
+ * @param[in,out]   sink Network sink instance.
+ * @param[in]   packetCount Number of mapped packets.
+ */
+static void unmapPackets(BatchUdpSink *sink, const size_t packetCount);
+
+/**
+ * @brief       Build message batch.
+ *
+ * @details     Builds the 'sendmmsg()' message array from the mapped
+ *              packets 'firstPacket' to 'endPacket' (exclusive). With
+ *              segmentation offload active, runs of equal-sized packets
+ *              (the last one may be shorter) are coalesced into one
+ *              message carrying an UDP_SEGMENT control message;
+ *              otherwise each packet becomes a message on its own.
+ *
+ * @param[in,out]   sink Network sink instance.
+ * @param[in]   firstPacket Index of the first packet to be sent.
+ * @param[in]   endPacket Index after the last packet to be sent.
+ * @param[in]   destAddress Destination address of the messages.
+ * @param[in]   destAddressLength Length of the destination address.
+ *
+ * @return      Number of messages built.
+ */
+static size_t buildMessageBatch(BatchUdpSink *sink, const size_t firstPacket, const size_t endPacket,
+                                struct sockaddr_storage *destAddress, const socklen_t destAddressLength);
+
+/**
+ * @brief       Send packet batch.
+ *
+ * @details     Sends the mapped packets 'firstPacket' to 'endPacket'
+ *              (exclusive) using 'sendmmsg()' on the single socket or
+ *              on the given path. If the kernel or the egress device
+ *              rejects a segmentation offload message, offload is
+ *              switched off for the rest of the session and the unsent
+ *              packets are resent as plain batched datagrams. A path
+ *              never blocks: on a full send queue it is marked
+ *              congested and on a routing error it is taken down,
+ *              both leaving the rest of the packets unsent. Datagrams
+ *              failing for other reasons are dropped and counted.
+ *
+ * @param[in,out]   sink Network sink instance.
+ * @param[in,out]   path Multipath path (NULL: single socket).
+ * @param[in]   firstPacket Index of the first packet to be sent.
+ * @param[in]   endPacket Index after the last packet to be sent.
+ * @param[in,out]   stats Statistics of the current render call.
+ *
+ * @return      Index of the first packet not handed to the kernel ('endPacket' if none).
+ */
+static size_t sendPacketBatch(BatchUdpSink *sink, NetworkSinkPath_T *path, const size_t firstPacket, const size_t endPacket,
+                              NetworkSinkStatistics_T *stats);
+
+/**
+ * @brief       Schedule packet batch.
+ *
+ * @details     Sends the mapped packets on the single socket or on
+ *              the paths of the multipath mode: every up path gets
+ *              every packet in redundant mode, in bonding mode the
+ *              packets are split into one contiguous run per up path
+ *              (keeping segmentation offload) by a deficit scheduler
+ *              weighted with the path capacities. A run a path could
+ *              not take fails over to the other up paths at once.
+ *
+ * @param[in,out]   sink Network sink instance.
+ * @param[in]   packetCount Number of mapped packets.
+ * @param[in,out]   stats Statistics of the current render call.
+ */
+static void schedulePacketBatch(BatchUdpSink *sink, const size_t packetCount, NetworkSinkStatistics_T *stats);
+
+/**
+ * @brief       Send packet run.
+ *
+ * @details     Sends the mapped packets 'firstPacket' to 'endPacket'
+ *              (exclusive) on the preferred path and the rest on the
+ *              other up paths. Packets no path takes are dropped.
+ *
+ * @param[in,out]   sink Network sink instance.
+ * @param[in,out]   preferred Preferred path.
+ * @param[in]   firstPacket Index of the first packet to be sent.
+ * @param[in]   endPacket Index after the last packet to be sent.
+ * @param[in,out]   stats Statistics of the current render call.
+ */
+static void sendPacketRun(BatchUdpSink *sink, NetworkSinkPath_T *preferred, const size_t firstPacket, const size_t endPacket,
+                          NetworkSinkStatistics_T *stats);
+
+/**
+ * @brief       Update destination port.
+ *
+ * @details     Copies the current 'port' property into the resolved
+ *              destination address (of every path without a port of
+ *              its own), so port changes requested by the ground
+ *              control take effect without restarting the sink.
+ *
+ * @param[in,out]   sink Network sink instance.
+ */
+static void updateDestinationPort(BatchUdpSink *sink);
+
+/**
+ * @brief       Parse network paths.
+ *
+ * @details     Parses the 'paths' property, a comma separated list of
+ *              "<local>[@<host>[:<port>]]" entries where 'local' is a
+ *              local IP address or a network interface name and the
+ *              destination defaults to the 'host' and 'port' properties
+ *              (bracket IPv6 hosts with a port: "[<address>]:<port>").
+ *              Resolves the destinations and opens the paths; a path
+ *              failing to open is retried while streaming.
+ *
+ * @param[in,out]   sink Network sink instance.
+ * @param[in]   paths Path list.
+ * @param[in]   host Default destination host.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure (invalid list or unresolved destination)
+ */
+static int parseNetworkPaths(BatchUdpSink *sink, const gchar *paths, const gchar *host);
+
+/**
+ * @brief       Open network path.
+ *
+ * @details     Opens the UDP socket of the path bound to its local
+ *              address (any port) or interface (SO_BINDTODEVICE,
+ *              needs CAP_NET_RAW) with the traffic class and send
+ *              buffer of the sink. Segmentation offload is switched
+ *              off for the sink if the path's socket lacks it.
+ *
+ * @param[in,out]   sink Network sink instance.
+ * @param[in,out]   path Path to be opened.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+static int openNetworkPath(BatchUdpSink *sink, NetworkSinkPath_T *path);
+
+/**
+ * @brief       Update network paths.
+ *
+ * @details     Every NUM_NETSINK_PATH_UPDATE_NS estimates the capacity
+ *              of the up paths (see NetworkSinkPath_T) and brings the
+ *              paths failed for NUM_NETSINK_PATH_RETRY_NS back up.
+ *
+ * @param[in,out]   sink Network sink instance.
+ */
+static void updateNetworkPaths(BatchUdpSink *sink);
+
+/**
+ * @brief       Take network path down.
+ *
+ * @details     Stops scheduling packets to the path until it is
+ *              retried. The socket is closed if its interface or
+ *              local address is gone (it is opened again on retry).
+ *
+ * @param[in,out]   path Failed path.
+ * @param[in]   error Error number of the failed send.
+ */
+static void takeNetworkPathDown(NetworkSinkPath_T *path, const int error);
+
+/**
+ * @brief       Accumulate statistics.
+ *
+ * @param[in,out]   sink Network sink instance.
+ * @param[in]   stats Statistics of the current render call.
+ */
+static void accumulateStatistics(BatchUdpSink *sink, const NetworkSinkStatistics_T *stats);
+
+/**
+ * @brief       Network sink meter pad probe.
+ *
+ * @details     Counts packets and frames (RTP marker bit) reaching
+ *              the network sink and the streaming thread's CPU time
+ *              between consecutive probe invocations. Reports are
+ *              logged every NUM_NETSINK_METER_REPORT_FRAMES frames.
+ *
+ * @param[in]   pad Sink pad of the network sink.
+ * @param[in]   info Probe information.
+ * @param[in,out]   data Network sink meter context.
+ *
+ * @return      GST_PAD_PROBE_OK
+ */
+static GstPadProbeReturn networkSinkMeterProbe(GstPad *pad, GstPadProbeInfo *info, gpointer data);
+
+#ifdef CC_TRACE_ENABLED
+/**
+ * @brief       Network sink caps trace pad probe.
+ *
+ * @details     Emits a TRACE_PIPE_CAPS trace event when the caps
+ *              event (end of caps negotiation) reaches the sink.
+ *
+ * @param[in]   pad Sink pad of the network sink.
+ * @param[in]   info Probe information.
+ * @param[in]   data Not used.
+ *
+ * @return      GST_PAD_PROBE_OK
+ */
+static GstPadProbeReturn networkSinkCapsProbe(GstPad *pad, GstPadProbeInfo *info, gpointer data);
+#endif
+
+
+/* Network sink related function definitions */
+
+int registerNetworkSink(void) {
+
+    int retval = 0;
+
+    if(TRUE != gst_element_register(NULL, STR_NETSINK_FACTORY_NAME, GST_RANK_NONE, batch_udp_sink_get_type())) {
+
+        createLogMessage(STR_LOG_MSG_FUNC42_ELEM_REG_FAIL, LOG_SVRTY_ERR);
+        retval = -1;
+    }
+
+    return retval;
+}
+
+int getNetworkSinkStatistics(GstElement *networkSink, NetworkSinkStatistics_T *stats) {
+
+    int retval = 0;
+    BatchUdpSink *sink = NULL;
+
+    if((NULL != networkSink) && (NULL != stats) && G_TYPE_CHECK_INSTANCE_TYPE(networkSink, batch_udp_sink_get_type())) {
+
+        sink = (BatchUdpSink*)(networkSink);
+
+        GST_OBJECT_LOCK(sink);
+        *stats = sink->stats;
+        GST_OBJECT_UNLOCK(sink);
+    }
+    else {
+
+        retval = -1;
+    }
+
+    return retval;
+}
+
+int attachNetworkSinkMeter(GstElement *networkSink) {
+
+    int retval = 0;
+    GstPad *sinkPad = NULL;
+    NetworkSinkMeter_T *meter = NULL;
+
+    if(NULL == networkSink) {
+
+        createLogMessage(STR_LOG_MSG_FUNC43_ARG_INVAL, LOG_SVRTY_ERR);
+        retval = -1;
+        return retval;
+    }
+
+    sinkPad = gst_element_get_static_pad(networkSink, "sink");
+    if(NULL == sinkPad) {
+
+        createLogMessage(STR_LOG_MSG_FUNC43_PAD_GET_FAIL, LOG_SVRTY_ERR);
+        retval = -1;
+        return retval;
+    }
+
+    meter = g_new0(NetworkSinkMeter_T, 1);
+    meter->networkSink = networkSink;
+    meter->lastCpuTimeNs = -1;
+
+    gst_pad_add_probe(sinkPad, GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST, networkSinkMeterProbe, meter, g_free);
+    #ifdef CC_TRACE_ENABLED
+    gst_pad_add_probe(sinkPad, GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM, networkSinkCapsProbe, NULL, NULL);
+    #endif
+    gst_object_unref(sinkPad);
+
+    return retval;
+}
+
+static gint64 getThreadCpuTimeNs(void) {
+
+    struct timespec now = {0};
+
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+
+    return ((gint64)(now.tv_sec) * NUM_NSEC_PER_SEC) + (gint64)(now.tv_nsec);
+}
+
+static gint64 getMonotonicTimeNs(void) {
+
+    struct timespec now = {0};
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return ((gint64)(now.tv_sec) * NUM_NSEC_PER_SEC) + (gint64)(now.tv_nsec);
+}
+
+static void batch_udp_sink_class_init(BatchUdpSinkClass *klass) {
+
+    GObjectClass *objectClass = G_OBJECT_CLASS(klass);
+    GstElementClass *elementClass = GST_ELEMENT_CLASS(klass);
+    GstBaseSinkClass *baseSinkClass = GST_BASE_SINK_CLASS(klass);
+
+    objectClass->set_property = batchUdpSinkSetProperty;
+    objectClass->get_property = batchUdpSinkGetProperty;
+    objectClass->finalize = batchUdpSinkFinalize;
+
+    g_object_class_install_property(objectClass, NETSINK_PROP_HOST,
+        g_param_spec_string("host", "Host", "Destination host (resolved on start)",
+            STR_NETSINK_DEFAULT_HOST, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+    g_object_class_install_property(objectClass, NETSINK_PROP_PORT,
+        g_param_spec_int("port", "Port", "Destination port",
+            0, 65535, NUM_NETSINK_DEFAULT_PORT, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+    g_object_class_install_property(objectClass, NETSINK_PROP_GSO,
+        g_param_spec_boolean("gso", "GSO", "Use UDP segmentation offload where supported",
+            TRUE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+    g_object_class_install_property(objectClass, NETSINK_PROP_DSCP,
+        g_param_spec_int("qos-dscp", "QoS DSCP", "Differentiated services code point of outgoing packets (-1 = default)",
+            -1, 63, -1, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+    g_object_class_install_property(objectClass, NETSINK_PROP_PRIO,
+        g_param_spec_int("priority", "Priority", "Socket priority SO_PRIORITY (-1 = default)",
+            -1, 6, -1, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+    g_object_class_install_property(objectClass, NETSINK_PROP_BUFSZ,
+        g_param_spec_int("buffer-size", "Buffer size", "Size of the kernel send buffer in bytes (0 = default)",
+            0, G_MAXINT, 0, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+    g_object_class_install_property(objectClass, NETSINK_PROP_PATHS,
+        g_param_spec_string("paths", "Paths", "Multipath paths \"<local address|interface>[@<host>[:<port>]],...\" (NULL = single path)",
+            NULL, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+    g_object_class_install_property(objectClass, NETSINK_PROP_MPMODE,
+        g_param_spec_string("multipath-mode", "Multipath mode", "\"" STR_NETSINK_MULTIPATH_REDUNDANT "\" (every packet on every path) or \""
+            STR_NETSINK_MULTIPATH_BONDING "\" (packets split by path capacity)",
+            STR_NETSINK_MULTIPATH_REDUNDANT, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+    gst_element_class_set_static_metadata(elementClass,
+        "Batched UDP sink", "Sink/Network",
+        "Sends RTP buffer lists with sendmmsg() and UDP segmentation offload",
+        "Adam Csizy");
+    gst_element_class_add_static_pad_template(elementClass, &networkSinkTemplate);
+
+    baseSinkClass->start = batchUdpSinkStart;
+    baseSinkClass->stop = batchUdpSinkStop;
+    baseSinkClass->render = batchUdpSinkRender;
+    baseSinkClass->render_list = batchUdpSinkRenderList;
+}
+
+static void batch_udp_sink_init(BatchUdpSink *sink) {
+
+    sink->host = g_strdup(STR_NETSINK_DEFAULT_HOST);
+    sink->port = NUM_NETSINK_DEFAULT_PORT;
+    sink->gso = TRUE;
+    sink->dscp = -1;
+    sink->priority = -1;
+    sink->bufferSize = 0;
+    sink->paths = NULL;
+    sink->multipathMode = g_strdup(STR_NETSINK_MULTIPATH_REDUNDANT);
+    sink->socketFd = -1;
+    sink->gsoActive = FALSE;
+    sink->pathCount = 0;
+}
+
+static void batchUdpSinkSetProperty(GObject *object, guint propertyId, const GValue *value, GParamSpec *pspec) {
+
+    BatchUdpSink *sink = (BatchUdpSink*)(object);
+
+    GST_OBJECT_LOCK(sink);
+    switch(propertyId) {
+
+        case NETSINK_PROP_HOST:
+            g_free(sink->host);
+            sink->host = g_value_dup_string(value);
+            break;
+
+        case NETSINK_PROP_PORT:
+            sink->port = g_value_get_int(value);
+            break;
+
+        case NETSINK_PROP_GSO:
+            sink->gso = g_value_get_boolean(value);
+            break;
+
+        case NETSINK_PROP_DSCP:
+            sink->dscp = g_value_get_int(value);
+            break;
+
+        case NETSINK_PROP_PRIO:
+            sink->priority = g_value_get_int(value);
+            break;
+
+        case NETSINK_PROP_BUFSZ:
+            sink->bufferSize = g_value_get_int(value);
+            break;
+
+        case NETSINK_PROP_PATHS:
+            g_free(sink->paths);
+            sink->paths = g_value_dup_string(value);
+            break;
+
+        case NETSINK_PROP_MPMODE:
+            g_free(sink->multipathMode);
+            sink->multipathMode = g_value_dup_string(value);
+            break;
+
+        default:
+            G_OBJECT_WARN_INVALID_PROPERTY_ID(object, propertyId, pspec);
+            break;
+    }
+    GST_OBJECT_UNLOCK(sink);
+}
+
+static void batchUdpSinkGetProperty(GObject *object, guint propertyId, GValue *value, GParamSpec *pspec) {
+
+    BatchUdpSink *sink = (BatchUdpSink*)(object);
+
+    GST_OBJECT_LOCK(sink);
+    switch(propertyId) {
+
+        case NETSINK_PROP_HOST:
+            g_value_set_string(value, sink->host);
+            break;
+
+        case NETSINK_PROP_PORT:
+            g_value_set_int(value, sink->port);
+            break;
+
+        case NETSINK_PROP_GSO:
+            g_value_set_boolean(value, sink->gso);
+            break;
+
+        case NETSINK_PROP_DSCP:
+            g_value_set_int(value, sink->dscp);
+            break;
+
+        case NETSINK_PROP_PRIO:
+            g_value_set_int(value, sink->priority);
+            break;
+
+        case NETSINK_PROP_BUFSZ:
+            g_value_set_int(value, sink->bufferSize);
+            break;
+
+        case NETSINK_PROP_PATHS:
+            g_value_set_string(value, sink->paths);
+            break;
+
+        case NETSINK_PROP_MPMODE:
+            g_value_set_string(value, sink->multipathMode);
+            break;
+
+        default:
+            G_OBJECT_WARN_INVALID_PROPERTY_ID(object, propertyId, pspec);
+            break;
+    }
+    GST_OBJECT_UNLOCK(sink);
+}
+
+static void batchUdpSinkFinalize(GObject *object) {
+
+    BatchUdpSink *sink = (BatchUdpSink*)(object);
+
+    g_free(sink->host);
+    sink->host = NULL;
+    g_free(sink->paths);
+    sink->paths = NULL;
+    g_free(sink->multipathMode);
+    sink->multipathMode = NULL;
+
+    G_OBJECT_CLASS(batch_udp_sink_parent_class)->finalize(object);
+}
+
+static gboolean batchUdpSinkStart(GstBaseSink *baseSink) {
+
+    int errorCode, disabled = 0;
+    gint dscp, priority, bufferSize;
+    gchar *host = NULL;
+    gchar *paths = NULL;
+    gchar *mode = NULL;
+    gboolean gso;
+    struct addrinfo hints = {0};
+    struct addrinfo *result = NULL;
+    BatchUdpSink *sink = (BatchUdpSink*)(baseSink);
+
+    GST_OBJECT_LOCK(sink);
+    host = g_strdup(sink->host);
+    paths = g_strdup(sink->paths);
+    mode = g_strdup(sink->multipathMode);
+    gso = sink->gso;
+    dscp = sink->dscp;
+    priority = sink->priority;
+    bufferSize = sink->bufferSize;
+    memset(&sink->stats, 0, sizeof(sink->stats));
+    GST_OBJECT_UNLOCK(sink);
+
+    sink->pathCount = 0;
+    sink->pathUpdateNs = 0;
+
+    /* Multipath: one socket per path, no single socket */
+    if((NULL != paths) && ('\0' != paths[0])) {
+
+        if(0 == g_strcmp0(mode, STR_NETSINK_MULTIPATH_REDUNDANT)) {
+
+            sink->mode = NETSINK_MULTIPATH_REDUNDANT;
+        }
+        else if(0 == g_strcmp0(mode, STR_NETSINK_MULTIPATH_BONDING)) {
+
+            sink->mode = NETSINK_MULTIPATH_BONDING;
+        }
+        else {
+
+            LOG_MSG_ERR(LOG_MOD_NETSINK, STR_LOG_MSG_FUNC44_MPMODE_INVAL, (NULL != mode) ? mode : "");
+
+            g_free(host);
+            g_free(paths);
+            g_free(mode);
+            return FALSE;
+        }
+
+        /* Cleared by a path without segmentation offload */
+        sink->gsoActive = gso;
+        if(parseNetworkPaths(sink, paths, host)) {
+
+            g_free(host);
+            g_free(paths);
+            g_free(mode);
+            return FALSE;
+        }
+
+        LOG_MSG_INF(LOG_MOD_NETSINK, STR_LOG_MSG_FUNC44_MULTIPATH_INFO, mode, (unsigned int)(sink->pathCount));
+
+        g_free(host);
+        g_free(paths);
+        g_free(mode);
+        return TRUE;
+    }
+    g_free(paths);
+    g_free(mode);
+
+    /* Resolve destination host */
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    hints.ai_protocol = IPPROTO_UDP;
+
+    errorCode = getaddrinfo(host, NULL, &hints, &result);
+    if(0 != errorCode) {
+
+        LOG_MSG_ERR(LOG_MOD_NETSINK, STR_LOG_MSG_FUNC44_GETADDRINFO_FAIL, host, gai_strerror(errorCode));
+
+        g_free(host);
+        return FALSE;
+    }
+    g_free(host);
+
+    memset(&sink->destAddress, 0, sizeof(sink->destAddress));
+    memcpy(&sink->destAddress, result->ai_addr, result->ai_addrlen);
+    sink->destAddressLength = result->ai_addrlen;
+
+    /* Open UDP socket */
+    sink->socketFd = socket(result->ai_family, SOCK_DGRAM | SOCK_CLOEXEC, IPPROTO_UDP);
+    freeaddrinfo(result);
+    if(-1 == sink->socketFd) {
+
+        createLogMessage(STR_LOG_MSG_FUNC44_SOCK_CREAT_FAIL, LOG_SVRTY_ERR);
+        return FALSE;
+    }
+
+    /* Traffic class and send buffer (failures are logged, sending works without them) */
+    if(0 <= dscp) {
+
+        setSocketDscp(sink->socketFd, dscp);
+    }
+    if(0 <= priority) {
+
+        setSocketPriority(sink->socketFd, priority);
+    }
+    if(0 < bufferSize) {
+
+        setSocketBufferSize(sink->socketFd, SO_SNDBUF, bufferSize);
+    }
+
+    /* Probe kernel support of UDP segmentation offload (segment size 0 keeps it disabled per socket) */
+    sink->gsoActive = FALSE;
+    if(gso) {
+
+        if(0 == setsockopt(sink->socketFd, SOL_UDP, UDP_SEGMENT, &disabled, sizeof(disabled))) {
+
+            sink->gsoActive = TRUE;
+        }
+        else {
+
+            createLogMessage(STR_LOG_MSG_FUNC44_GSO_UNSUPPORTED, LOG_SVRTY_INF);
+        }
+    }
+
+    return TRUE;
+}
+
+static gboolean batchUdpSinkStop(GstBaseSink *baseSink) {
+
+    NetworkSinkStatistics_T stats;
+    guint64 renders;
+    size_t i;
+    NetworkSinkPath_T *path = NULL;
+    BatchUdpSink *sink = (BatchUdpSink*)(baseSink);
+
+    if(-1 != sink->socketFd) {
+
+        close(sink->socketFd);
+        sink->socketFd = -1;
+    }
+
+    for(i = 0;i < sink->pathCount;++i) {
+
+        path = &sink->path[i];
+        if(-1 != path->socketFd) {
+
+            close(path->socketFd);
+            path->socketFd = -1;
+        }
+
+        LOG_MSG_INF(LOG_MOD_NETSINK, STR_LOG_MSG_FUNC45_PATH_STATS_INFO, path->local,
+            (unsigned long long)(path->packets), (unsigned long long)(path->bytes),
+            (unsigned long long)(path->errors), path->capacity * 8.0 / 1000.0);
+    }
+    sink->pathCount = 0;
+
+    GST_OBJECT_LOCK(sink);
+    stats = sink->stats;
+    GST_OBJECT_UNLOCK(sink);
+
+    /* Report per-render (i.e. per-frame for list-pushing payloaders) cost */
+    renders = stats.buffers + stats.bufferLists;
+    if(0 < renders) {
+
+        LOG_MSG_INF(LOG_MOD_NETSINK, STR_LOG_MSG_FUNC45_STATS_INFO,
+            (unsigned long long)(stats.packets), (unsigned long long)(renders),
+            (double)(stats.packets) / (double)(renders), (double)(stats.syscalls) / (double)(renders),
+            (double)(stats.cpuTimeNs) / (double)(renders) / 1000.0,
+            (unsigned long long)(stats.gsoMessages), (unsigned long long)(stats.sendErrors));
+    }
+
+    return TRUE;
+}
+
+static GstFlowReturn batchUdpSinkRender(GstBaseSink *baseSink, GstBuffer *buffer) {
+
+    size_t iovUsed = 0;
+    gint64 cpuStart;
+    NetworkSinkStatistics_T stats = {0};
+    BatchUdpSink *sink = (BatchUdpSink*)(baseSink);
+
+    cpuStart = getThreadCpuTimeNs();
+    updateDestinationPort(sink);
+
+    if(mapPacket(sink, buffer, 0, &iovUsed)) {
+
+        createLogMessage(STR_LOG_MSG_FUNC46_BUF_MAP_FAIL, LOG_SVRTY_ERR);
+        return GST_FLOW_ERROR;
+    }
+
+    schedulePacketBatch(sink, 1, &stats);
+    unmapPackets(sink, 1);
+
+    stats.buffers = 1;
+    stats.cpuTimeNs = (guint64)(getThreadCpuTimeNs() - cpuStart);
+    accumulateStatistics(sink, &stats);
+
+    return GST_FLOW_OK;
+}
+
+static GstFlowReturn batchUdpSinkRenderList(GstBaseSink *baseSink, GstBufferList *bufferList) {
+
+    guint index = 0, length;
+    size_t packetCount, iovUsed;
+    gint64 cpuStart;
+    GstFlowReturn retval = GST_FLOW_OK;
+    NetworkSinkStatistics_T stats = {0};
+    BatchUdpSink *sink = (BatchUdpSink*)(baseSink);
+
+    cpuStart = getThreadCpuTimeNs();
+    updateDestinationPort(sink);
+
+    length = gst_buffer_list_length(bufferList);
+    while((index < length) && (GST_FLOW_OK == retval)) {
+
+        /* Map the next batch of packets */
+        packetCount = 0;
+        iovUsed = 0;
+        while((index < length) && (packetCount < NUM_NETSINK_BATCH_SIZE)) {
+
+            if(mapPacket(sink, gst_buffer_list_get(bufferList, index), packetCount, &iovUsed)) {
+
+                createLogMessage(STR_LOG_MSG_FUNC46_BUF_MAP_FAIL, LOG_SVRTY_ERR);
+                retval = GST_FLOW_ERROR;
+                break;
+            }
+
+            ++packetCount;
+            ++index;
+        }
+
+        if(GST_FLOW_OK == retval) {
+
+            schedulePacketBatch(sink, packetCount, &stats);
+        }
+        unmapPackets(sink, packetCount);
+    }
+
+    stats.bufferLists = 1;
+    stats.cpuTimeNs = (guint64)(getThreadCpuTimeNs() - cpuStart);
+    accumulateStatistics(sink, &stats);
+
+    return retval;
+}
+
+static int mapPacket(BatchUdpSink *sink, GstBuffer *buffer, const size_t packet, size_t *iovUsed) {
+
+    int retval = 0;
+    guint i, memoryCount;
+    size_t slot;
+    GstMemory *memory = NULL;
+
+    memoryCount = gst_buffer_n_memory(buffer);
+
+    sink->packetIovStart[packet] = *iovUsed;
+    sink->packetIovCount[packet] = 0;
+    sink->packetLength[packet] = 0;
+    sink->mergedBuffers[packet] = NULL;
+
+    if(memoryCount <= NUM_NETSINK_MAX_IOV_PER_PKT) {
+
+        /* Zero-copy: one I/O vector per memory block (RTP header + payload) */
+        for(i = 0;i < memoryCount;++i) {
+
+            slot = *iovUsed;
+            memory = gst_buffer_peek_memory(buffer, i);
+            if(TRUE != gst_memory_map(memory, &sink->memoryMaps[slot], GST_MAP_READ)) {
+
+                /* Release the blocks of this packet mapped so far */
+                for(slot = sink->packetIovStart[packet];slot < *iovUsed;++slot) {
+
+                    gst_memory_unmap(sink->memoryMaps[slot].memory, &sink->memoryMaps[slot]);
+                }
+                *iovUsed = sink->packetIovStart[packet];
+                retval = -1;
+                return retval;
+            }
+
+            sink->iov[slot].iov_base = sink->memoryMaps[slot].data;
+            sink->iov[slot].iov_len = sink->memoryMaps[slot].size;
+            sink->packetLength[packet] += sink->memoryMaps[slot].size;
+            ++(*iovUsed);
+        }
+        sink->packetIovCount[packet] = memoryCount;
+    }
+    else {
+
+        /* Too fragmented: let GStreamer merge the blocks */
+        if(TRUE != gst_buffer_map(buffer, &sink->bufferMaps[packet], GST_MAP_READ)) {
+
+            retval = -1;
+            return retval;
+        }
+
+        slot = *iovUsed;
+        sink->mergedBuffers[packet] = buffer;
+        sink->iov[slot].iov_base = sink->bufferMaps[packet].data;
+        sink->iov[slot].iov_len = sink->bufferMaps[packet].size;
+        sink->packetLength[packet] = sink->bufferMaps[packet].size;
+        sink->packetIovCount[packet] = 1;
+        ++(*iovUsed);
+    }
+
+    return retval;
+}
+
+static void unmapPackets(BatchUdpSink *sink, const size_t packetCount) {
+
+    size_t packet, slot;
+
+    for(packet = 0;packet < packetCount;++packet) {
+
+        if(NULL != sink->mergedBuffers[packet]) {
+
+            gst_buffer_unmap(sink->mergedBuffers[packet], &sink->bufferMaps[packet]);
+            sink->mergedBuffers[packet] = NULL;
+        }
+        else {
+
+            for(slot = sink->packetIovStart[packet];slot < (sink->packetIovStart[packet] + sink->packetIovCount[packet]);++slot) {
+
+                gst_memory_unmap(sink->memoryMaps[slot].memory, &sink->memoryMaps[slot]);
+            }
+        }
+
+        sink->packetIovCount[packet] = 0;
+    }
+}
+
+static size_t buildMessageBatch(BatchUdpSink *sink, const size_t firstPacket, const size_t endPacket,
+                                struct sockaddr_storage *destAddress, const socklen_t destAddressLength) {
+
+    size_t message = 0, packet = firstPacket, groupFirst, segmentSize, groupBytes;
+    struct msghdr *header = NULL;
+    struct cmsghdr *controlHeader = NULL;
+
+    while(packet < endPacket) {
+
+        groupFirst = packet;
+        segmentSize = sink->packetLength[packet];
+        groupBytes = segmentSize;
+        ++packet;
+
+        /* Coalesce equal-sized packets; a shorter packet closes the group */
+        if(sink->gsoActive && (0 < segmentSize) && (NUM_NETSINK_GSO_MAX_SEG_SIZE >= segmentSize)) {
+
+            while((packet < endPacket) &&
+                  ((packet - groupFirst) < NUM_NETSINK_GSO_MAX_SEGMENTS) &&
+                  (0 < sink->packetLength[packet]) &&
+                  (segmentSize >= sink->packetLength[packet]) &&
+                  (NUM_NETSINK_GSO_MAX_BYTES >= (groupBytes + sink->packetLength[packet]))) {
+
+                groupBytes += sink->packetLength[packet];
+                ++packet;
+
+                if(segmentSize > sink->packetLength[packet - 1]) {
+
+                    break;
+                }
+            }
+        }
+
+        header = &sink->messages[message].msg_hdr;
+        memset(header, 0, sizeof(*header));
+        header->msg_name = destAddress;
+        header->msg_namelen = destAddressLength;
+        header->msg_iov = &sink->iov[sink->packetIovStart[groupFirst]];
+        header->msg_iovlen = sink->packetIovStart[packet - 1] + sink->packetIovCount[packet - 1] - sink->packetIovStart[groupFirst];
+
+        if(1 < (packet - groupFirst)) {
+
+            header->msg_control = sink->control[message].buffer;
+            header->msg_controllen = sizeof(sink->control[message].buffer);
+            controlHeader = CMSG_FIRSTHDR(header);
+            controlHeader->cmsg_level = SOL_UDP;
+            controlHeader->cmsg_type = UDP_SEGMENT;
+            controlHeader->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+            *((uint16_t*)CMSG_DATA(controlHeader)) = (uint16_t)(segmentSize);
+        }
+
+        sink->messages[message].msg_len = 0;
+        sink->messagePacket[message] = groupFirst;
+        ++message;
+    }
+
+    sink->messagePacket[message] = endPacket;
+
+    return message;
+}
+
+static size_t sendPacketBatch(BatchUdpSink *sink, NetworkSinkPath_T *path, const size_t firstPacket, const size_t endPacket,
+                              NetworkSinkStatistics_T *stats) {
+
+    int ret, restart, stop = FALSE, socketFd, flags;
+    size_t packet = firstPacket, messageCount, sent, i;
+    struct sockaddr_storage *destAddress = NULL;
+    socklen_t destAddressLength;
+
+    if(NULL != path) {
+
+        /* A path must not hold up the others: never block on its send queue */
+        socketFd = path->socketFd;
+        destAddress = &path->destAddress;
+        destAddressLength = path->destAddressLength;
+        flags = MSG_DONTWAIT;
+    }
+    else {
+
+        socketFd = sink->socketFd;
+        destAddress = &sink->destAddress;
+        destAddressLength = sink->destAddressLength;
+        flags = 0;
+    }
+
+    while((packet < endPacket) && (!stop)) {
+
+        messageCount = buildMessageBatch(sink, packet, endPacket, destAddress, destAddressLength);
+        sent = 0;
+        restart = FALSE;
+
+        while((sent < messageCount) && (!restart) && (!stop)) {
+
+            TRACE_BEGIN(TRACE_SOCK_SENDMMSG, messageCount - sent);
+            ret = sendmmsg(socketFd, &sink->messages[sent], (unsigned int)(messageCount - sent), flags);
+            TRACE_END(TRACE_SOCK_SENDMMSG, ret);
+            stats->syscalls++;
+
+            if(0 > ret) {
+
+                if(EINTR == errno) {
+
+                    continue;
+                }
+
+                if(NULL != path) {
+
+                    path->errors++;
+                }
+
+                if(sink->gsoActive && (0 < sink->messages[sent].msg_hdr.msg_controllen) &&
+                   ((EIO == errno) || (EINVAL == errno) || (ENOPROTOOPT == errno))) {
+
+                    /* Egress path cannot segment (e.g. no checksum offload): resend without GSO */
+                    LOG_MSG_WRN(LOG_MOD_NETSINK, STR_LOG_MSG_FUNC47_GSO_DISABLED, strerror(errno));
+
+                    sink->gsoActive = FALSE;
+                    restart = TRUE;
+                }
+                else if((NULL != path) && ((EAGAIN == errno) || (EWOULDBLOCK == errno) || (ENOBUFS == errno))) {
+
+                    /* Send queue full: the rest goes elsewhere (bonding) or is lost on this path (redundant) */
+                    path->congested = TRUE;
+                    stop = TRUE;
+                }
+                else if((NULL != path) && ((ENETUNREACH == errno) || (EHOSTUNREACH == errno) || (ENETDOWN == errno) ||
+                        (ENODEV == errno) || (EADDRNOTAVAIL == errno) || (EPERM == errno))) {
+
+                    takeNetworkPathDown(path, errno);
+                    stop = TRUE;
+                }
+                else {
+
+                    /* Drop the datagram like the stock sink does */
+                    stats->sendErrors++;
+                    ++sent;
+                }
+            }
+            else {
+
+                for(i = sent;i < (sent + (size_t)(ret));++i) {
+
+                    stats->packets += sink->messagePacket[i + 1] - sink->messagePacket[i];
+                    stats->bytes += sink->messages[i].msg_len;
+                    if(0 < sink->messages[i].msg_hdr.msg_controllen) {
+
+                        stats->gsoMessages++;
+                    }
+                    if(NULL != path) {
+
+                        path->packets += sink->messagePacket[i + 1] - sink->messagePacket[i];
+                        path->bytes += sink->messages[i].msg_len;
+                        path->intervalBytes += sink->messages[i].msg_len;
+                    }
+                }
+                sent += (size_t)(ret);
+            }
+        }
+
+        packet = sink->messagePacket[sent];
+    }
+
+    return packet;
+}
+
+static void schedulePacketBatch(BatchUdpSink *sink, const size_t packetCount, NetworkSinkStatistics_T *stats) {
+
+    size_t i, packet, end, lastUp = NUM_NETSINK_PATH_MAX;
+    double batchBytes = 0.0, capacitySum = 0.0, runBytes;
+    NetworkSinkPath_T *path = NULL;
+
+    if(0 == sink->pathCount) {
+
+        sendPacketBatch(sink, NULL, 0, packetCount, stats);
+        return;
+    }
+
+    updateNetworkPaths(sink);
+
+    if(NETSINK_MULTIPATH_REDUNDANT == sink->mode) {
+
+        /* The ground control keeps the first copy of each packet */
+        for(i = 0;i < sink->pathCount;++i) {
+
+            if(sink->path[i].up) {
+
+                sendPacketBatch(sink, &sink->path[i], 0, packetCount, stats);
+            }
+        }
+        return;
+    }
+
+    /* Bonding: credit each up path its capacity share of the batch */
+    for(i = 0;i < sink->pathCount;++i) {
+
+        if(sink->path[i].up) {
+
+            capacitySum += sink->path[i].capacity;
+            lastUp = i;
+        }
+    }
+    if(NUM_NETSINK_PATH_MAX == lastUp) {
+
+        /* Every path is down: the batch is lost */
+        stats->sendErrors++;
+        return;
+    }
+    for(packet = 0;packet < packetCount;++packet) {
+
+        batchBytes += (double)(sink->packetLength[packet]);
+    }
+
+    packet = 0;
+    for(i = 0;(i <= lastUp) && (packet < packetCount);++i) {
+
+        path = &sink->path[i];
+        if(!path->up) {
+
+            continue;
+        }
+
+        path->deficit += batchBytes * path->capacity / capacitySum;
+
+        /* One contiguous run per path (segmentation offload needs consecutive packets), the last up path takes the rest */
+        end = packet;
+        runBytes = 0.0;
+        while((end < packetCount) &&
+              ((i == lastUp) || ((path->deficit - runBytes) >= ((double)(sink->packetLength[end]) / 2.0)))) {
+
+            runBytes += (double)(sink->packetLength[end]);
+            ++end;
+        }
+
+        path->deficit -= runBytes;
+        path->deficit = CLAMP(path->deficit, -NUM_NETSINK_PATH_DEFICIT_MAX, NUM_NETSINK_PATH_DEFICIT_MAX);
+
+        if(end > packet) {
+
+            sendPacketRun(sink, path, packet, end, stats);
+            packet = end;
+        }
+    }
+}
+
+static void sendPacketRun(BatchUdpSink *sink, NetworkSinkPath_T *preferred, const size_t firstPacket, const size_t endPacket,
+                          NetworkSinkStatistics_T *stats) {
+
+    size_t i, packet;
+
+    packet = sendPacketBatch(sink, preferred, firstPacket, endPacket, stats);
+
+    /* Fail over within the same render call: no packet waits for a path to recover */
+    for(i = 0;(i < sink->pathCount) && (packet < endPacket);++i) {
+
+        if((&sink->path[i] != preferred) && sink->path[i].up) {
+
+            packet = sendPacketBatch(sink, &sink->path[i], packet, endPacket, stats);
+        }
+    }
+
+    if(packet < endPacket) {
+
+        stats->sendErrors++;
+    }
+}
+
+static void updateDestinationPort(BatchUdpSink *sink) {
+
+    gint port;
+    size_t i;
+    struct sockaddr_storage *address = NULL;
+
+    GST_OBJECT_LOCK(sink);
+    port = sink->port;
+    GST_OBJECT_UNLOCK(sink);
+
+    for(i = 0;i <= sink->pathCount;++i) {
+
+        if(i < sink->pathCount) {
+
+            if(0 != sink->path[i].fixedPort) {
+
+                continue;
+            }
+            address = &sink->path[i].destAddress;
+        }
+        else {
+
+            address = &sink->destAddress;
+        }
+
+        if(AF_INET6 == address->ss_family) {
+
+            ((struct sockaddr_in6*)(address))->sin6_port = htons((uint16_t)(port));
+        }
+        else {
+
+            ((struct sockaddr_in*)(address))->sin_port = htons((uint16_t)(port));
+        }
+    }
+}
+
+static int parseNetworkPaths(BatchUdpSink *sink, const gchar *paths, const gchar *host) {
+
+    int retval = 0, errorCode;
+    guint i;
+    long port;
+    gchar **entries = NULL;
+    gchar *entry = NULL;
+    gchar *pathHost = NULL;
+    gchar *pathPort = NULL;
+    gchar *separator = NULL;
+    gchar *end = NULL;
+    struct addrinfo hints = {0};
+    struct addrinfo *result = NULL;
+    NetworkSinkPath_T *path = NULL;
+
+    entries = g_strsplit(paths, ",", -1);
+    for(i = 0;(NULL != entries[i]) && (0 == retval);++i) {
+
+        entry = g_strstrip(entries[i]);
+        if('\0' == entry[0]) {
+
+            continue;
+        }
+
+        if(NUM_NETSINK_PATH_MAX <= sink->pathCount) {
+
+            LOG_MSG_ERR(LOG_MOD_NETSINK, STR_LOG_MSG_FUNC100_PATH_COUNT_INVAL, NUM_NETSINK_PATH_MAX);
+            retval = -1;
+            break;
+        }
+
+        path = &sink->path[sink->pathCount];
+        memset(path, 0, sizeof(*path));
+        path->socketFd = -1;
+
+        /* "<local>[@<host>[:<port>]]" */
+        pathHost = (gchar*)(host);
+        pathPort = NULL;
+        separator = strchr(entry, '@');
+        if(NULL != separator) {
+
+            *separator = '\0';
+            pathHost = separator + 1;
+            if('[' == pathHost[0]) {
+
+                ++pathHost;
+                separator = strchr(pathHost, ']');
+                if(NULL != separator) {
+
+                    *separator = '\0';
+                    pathPort = (':' == separator[1]) ? (separator + 2) : NULL;
+                }
+            }
+            else {
+
+                separator = strchr(pathHost, ':');
+                if((NULL != separator) && (separator == strrchr(pathHost, ':'))) {
+
+                    *separator = '\0';
+                    pathPort = separator + 1;
+                }
+            }
+        }
+
+        if((NUM_NETSINK_PATH_LOCAL_SIZE <= strlen(entry)) || ('\0' == entry[0]) || ('\0' == pathHost[0])) {
+
+            LOG_MSG_ERR(LOG_MOD_NETSINK, STR_LOG_MSG_FUNC100_PATH_INVAL, entries[i]);
+            retval = -1;
+            break;
+        }
+        g_strlcpy(path->local, entry, sizeof(path->local));
+
+        if(NULL != pathPort) {
+
+            errno = 0;
+            port = strtol(pathPort, &end, 10);
+            if((0 != errno) || (end == pathPort) || ('\0' != *end) || (0 >= port) || (65535 < port)) {
+
+                LOG_MSG_ERR(LOG_MOD_NETSINK, STR_LOG_MSG_FUNC100_PATH_INVAL, path->local);
+                retval = -1;
+                break;
+            }
+            path->fixedPort = (gint)(port);
+        }
+
+        /* A local address selects the destination's family, an interface any */
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        if(1 == inet_pton(AF_INET, path->local, &((struct sockaddr_in*)(&path->localAddress))->sin_addr)) {
+
+            ((struct sockaddr_in*)(&path->localAddress))->sin_family = AF_INET;
+            path->localAddressLength = sizeof(struct sockaddr_in);
+            hints.ai_family = AF_INET;
+        }
+        else if(1 == inet_pton(AF_INET6, path->local, &((struct sockaddr_in6*)(&path->localAddress))->sin6_addr)) {
+
+            ((struct sockaddr_in6*)(&path->localAddress))->sin6_family = AF_INET6;
+            path->localAddressLength = sizeof(struct sockaddr_in6);
+            hints.ai_family = AF_INET6;
+        }
+        else if(IFNAMSIZ <= strlen(path->local)) {
+
+            LOG_MSG_ERR(LOG_MOD_NETSINK, STR_LOG_MSG_FUNC100_PATH_INVAL, path->local);
+            retval = -1;
+            break;
+        }
+        hints.ai_socktype = SOCK_DGRAM;
+        hints.ai_protocol = IPPROTO_UDP;
+
+        /* Resolved once: no name lookup in the streaming thread */
+        errorCode = getaddrinfo(pathHost, NULL, &hints, &result);
+        if(0 != errorCode) {
+
+            LOG_MSG_ERR(LOG_MOD_NETSINK, STR_LOG_MSG_FUNC100_RESOLVE_FAIL, path->local, pathHost, gai_strerror(errorCode));
+            retval = -1;
+            break;
+        }
+        memcpy(&path->destAddress, result->ai_addr, result->ai_addrlen);
+        path->destAddressLength = result->ai_addrlen;
+        freeaddrinfo(result);
+        result = NULL;
+
+        if(0 != path->fixedPort) {
+
+            if(AF_INET6 == path->destAddress.ss_family) {
+
+                ((struct sockaddr_in6*)(&path->destAddress))->sin6_port = htons((uint16_t)(path->fixedPort));
+            }
+            else {
+
+                ((struct sockaddr_in*)(&path->destAddress))->sin_port = htons((uint16_t)(path->fixedPort));
+            }
+        }
+
+        /* A path not available yet (e.g. modem still dialing) is retried while streaming */
+        path->capacity = NUM_NETSINK_PATH_MIN_CAPACITY;
+        if(openNetworkPath(sink, path)) {
+
+            path->up = FALSE;
+            path->downSinceNs = getMonotonicTimeNs();
+        }
+
+        LOG_MSG_INF(LOG_MOD_NETSINK, STR_LOG_MSG_FUNC100_PATH_INFO, path->local, pathHost,
+            (0 != path->fixedPort) ? path->fixedPort : -1, path->up ? "up" : "down");
+
+        ++sink->pathCount;
+    }
+    g_strfreev(entries);
+
+    if((0 == retval) && (0 == sink->pathCount)) {
+
+        LOG_MSG_ERR(LOG_MOD_NETSINK, STR_LOG_MSG_FUNC100_PATH_COUNT_INVAL, NUM_NETSINK_PATH_MAX);
+        retval = -1;
+    }
+
+    if(0 != retval) {
+
+        for(i = 0;i < sink->pathCount;++i) {
+
+            if(-1 != sink->path[i].socketFd) {
+
+                close(sink->path[i].socketFd);
+                sink->path[i].socketFd = -1;
+            }
+        }
+        sink->pathCount = 0;
+    }
+
+    return retval;
+}
+
+static int openNetworkPath(BatchUdpSink *sink, NetworkSinkPath_T *path) {
+
+    int retval = 0, disabled = 0, socketFd;
+    gint dscp, priority, bufferSize;
+    socklen_t optionLength = sizeof(path->sendBufferSize);
+
+    GST_OBJECT_LOCK(sink);
+    dscp = sink->dscp;
+    priority = sink->priority;
+    bufferSize = sink->bufferSize;
+    GST_OBJECT_UNLOCK(sink);
+
+    socketFd = socket(path->destAddress.ss_family, SOCK_DGRAM | SOCK_CLOEXEC, IPPROTO_UDP);
+    if(-1 == socketFd) {
+
+        LOG_MSG_RATE_WRN(LOG_MOD_NETSINK, NUM_NETSINK_PATH_LOG_BURST, NUM_NETSINK_PATH_LOG_WINDOW_SEC,
+            STR_LOG_MSG_FUNC101_OPEN_FAIL, path->local, strerror(errno));
+        retval = -1;
+        return retval;
+    }
+
+    /* Source address or egress interface of the path */
+    if(0 < path->localAddressLength) {
+
+        retval = bind(socketFd, (struct sockaddr*)(&path->localAddress), path->localAddressLength);
+    }
+    else {
+
+        retval = setsockopt(socketFd, SOL_SOCKET, SO_BINDTODEVICE, path->local, (socklen_t)(strlen(path->local) + 1));
+    }
+    if(0 != retval) {
+
+        LOG_MSG_RATE_WRN(LOG_MOD_NETSINK, NUM_NETSINK_PATH_LOG_BURST, NUM_NETSINK_PATH_LOG_WINDOW_SEC,
+            STR_LOG_MSG_FUNC101_OPEN_FAIL, path->local, strerror(errno));
+        close(socketFd);
+        retval = -1;
+        return retval;
+    }
+
+    /* Traffic class and send buffer (failures are logged, sending works without them) */
+    if(0 <= dscp) {
+
+        setSocketDscp(socketFd, dscp);
+    }
+    if(0 <= priority) {
+
+        setSocketPriority(socketFd, priority);
+    }
+    if(0 < bufferSize) {
+
+        setSocketBufferSize(socketFd, SO_SNDBUF, bufferSize);
+    }
+    if(0 != getsockopt(socketFd, SOL_SOCKET, SO_SNDBUF, &path->sendBufferSize, &optionLength)) {
+
+        path->sendBufferSize = 0;
+    }
+
+    /* Segmentation offload is a sink-wide setting: one path without it switches it off */
+    if(sink->gsoActive && (0 != setsockopt(socketFd, SOL_UDP, UDP_SEGMENT, &disabled, sizeof(disabled)))) {
+
+        createLogMessage(STR_LOG_MSG_FUNC101_GSO_UNSUPPORTED, LOG_SVRTY_INF);
+        sink->gsoActive = FALSE;
+    }
+
+    path->socketFd = socketFd;
+    path->up = TRUE;
+    path->congested = FALSE;
+    path->intervalBytes = 0;
+    path->lastQueued = 0;
+
+    return retval;
+}
+
+static void updateNetworkPaths(BatchUdpSink *sink) {
+
+    size_t i;
+    int queued;
+    gint64 now;
+    double seconds, rate;
+    NetworkSinkPath_T *path = NULL;
+
+    now = getMonotonicTimeNs();
+    if(0 == sink->pathUpdateNs) {
+
+        sink->pathUpdateNs = now;
+        return;
+    }
+    if(NUM_NETSINK_PATH_UPDATE_NS > (now - sink->pathUpdateNs)) {
+
+        return;
+    }
+    seconds = (double)(now - sink->pathUpdateNs) / (double)(NUM_NSEC_PER_SEC);
+    sink->pathUpdateNs = now;
+
+    for(i = 0;i < sink->pathCount;++i) {
+
+        path = &sink->path[i];
+
+        if(!path->up) {
+
+            /* Retry a failed path with the capacity floor (a dead path fails again on its first send) */
+            if(NUM_NETSINK_PATH_RETRY_NS <= (now - path->downSinceNs)) {
+
+                if((-1 != path->socketFd) || (0 == openNetworkPath(sink, path))) {
+
+                    path->up = TRUE;
+                    path->congested = FALSE;
+                    path->capacity = NUM_NETSINK_PATH_MIN_CAPACITY;
+                    path->deficit = 0.0;
+                    path->intervalBytes = 0;
+                    LOG_MSG_RATE_INF(LOG_MOD_NETSINK, NUM_NETSINK_PATH_LOG_BURST, NUM_NETSINK_PATH_LOG_WINDOW_SEC,
+                        STR_LOG_MSG_FUNC102_PATH_RETRY, path->local);
+                }
+                else {
+
+                    path->downSinceNs = now;
+                }
+            }
+            continue;
+        }
+
+        /* Bytes that left the send queue (handed to the device) during the interval */
+        if(0 != ioctl(path->socketFd, SIOCOUTQ, &queued)) {
+
+            queued = 0;
+        }
+        rate = ((double)(path->intervalBytes) + (double)(path->lastQueued) - (double)(queued)) / seconds;
+        rate = MAX(rate, 0.0);
+
+        if(path->congested || ((0 < path->sendBufferSize) && ((path->sendBufferSize / NUM_NETSINK_PATH_BACKLOG_DIV) < queued))) {
+
+            /* Backlogged: the drain rate is the path's capacity */
+            path->capacity += NUM_NETSINK_PATH_EWMA_GAIN * (rate - path->capacity);
+        }
+        else {
+
+            /* Keeping up: probe for more, bounded by what the path actually carried */
+            path->capacity = MIN(path->capacity * NUM_NETSINK_PATH_PROBE_GAIN, (2.0 * rate) + NUM_NETSINK_PATH_MIN_CAPACITY);
+        }
+        path->capacity = MAX(path->capacity, NUM_NETSINK_PATH_MIN_CAPACITY);
+
+        path->lastQueued = queued;
+        path->intervalBytes = 0;
+        path->congested = FALSE;
+    }
+}
+
+static void takeNetworkPathDown(NetworkSinkPath_T *path, const int error) {
+
+    LOG_MSG_RATE_WRN(LOG_MOD_NETSINK, NUM_NETSINK_PATH_LOG_BURST, NUM_NETSINK_PATH_LOG_WINDOW_SEC,
+        STR_LOG_MSG_FUNC103_PATH_DOWN, path->local, strerror(error));
+
+    path->up = FALSE;
+    path->downSinceNs = getMonotonicTimeNs();
+    path->capacity = NUM_NETSINK_PATH_MIN_CAPACITY;
+    path->deficit = 0.0;
+
+    /* The binding is stale once the interface or the local address is gone */
+    if((ENODEV == error) || (EADDRNOTAVAIL == error)) {
+
+        close(path->socketFd);
+        path->socketFd = -1;
+    }
+}
+
+static void accumulateStatistics(BatchUdpSink *sink, const NetworkSinkStatistics_T *stats) {
+
+    GST_OBJECT_LOCK(sink);
+    sink->stats.buffers += stats->buffers;
+    sink->stats.bufferLists += stats->bufferLists;
+    sink->stats.packets += stats->packets;
+    sink->stats.bytes += stats->bytes;
+    sink->stats.syscalls += stats->syscalls;
+    sink->stats.gsoMessages += stats->gsoMessages;
+    sink->stats.sendErrors += stats->sendErrors;
+    sink->stats.cpuTimeNs += stats->cpuTimeNs;
+    GST_OBJECT_UNLOCK(sink);
+}
+
+static GstPadProbeReturn networkSinkMeterProbe(GstPad *pad, GstPadProbeInfo *info, gpointer data) {
+
+    guint i, length;
+    guint8 markerByte;
+    gint64 now;
+    GstBuffer *buffer = NULL;
+    GstBufferList *bufferList = NULL;
+    NetworkSinkStatistics_T stats;
+    NetworkSinkMeter_T *meter = (NetworkSinkMeter_T*)(data);
+
+    /* Count packets and frames (marker bit set on the last packet of a frame) */
+    if(GST_PAD_PROBE_INFO_TYPE(info) & GST_PAD_PROBE_TYPE_BUFFER_LIST) {
+
+        bufferList = GST_PAD_PROBE_INFO_BUFFER_LIST(info);
+        length = gst_buffer_list_length(bufferList);
+        for(i = 0;i < length;++i) {
+
+            buffer = gst_buffer_list_get(bufferList, i);
+            if((1 == gst_buffer_extract(buffer, NUM_RTP_HDR_MARKER_OFFSET, &markerByte, 1)) && (markerByte & NUM_RTP_HDR_MARKER_MASK)) {
+
+                meter->frames++;
+                TRACE_INSTANT(TRACE_FRAME, meter->frames);
+            }
+        }
+        meter->packets += length;
+    }
+    else {
+
+        buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+        if((1 == gst_buffer_extract(buffer, NUM_RTP_HDR_MARKER_OFFSET, &markerByte, 1)) && (markerByte & NUM_RTP_HDR_MARKER_MASK)) {
+
+            meter->frames++;
+            TRACE_INSTANT(TRACE_FRAME, meter->frames);
+        }
+        meter->packets++;
+    }
+
+    /* Streaming thread CPU time since the previous push (capture, payloading and sending) */
+    now = getThreadCpuTimeNs();
+    if(0 <= meter->lastCpuTimeNs) {
+
+        meter->cpuTimeNs += now - meter->lastCpuTimeNs;
+    }
+    meter->lastCpuTimeNs = now;
+
+    if(NUM_NETSINK_METER_REPORT_FRAMES <= meter->frames) {
+
+        if(0 == getNetworkSinkStatistics(meter->networkSink, &stats)) {
+
+            LOG_MSG_DBG(LOG_MOD_NETSINK, STR_LOG_MSG_FUNC48_METER_BATCH_INFO,
+                (double)(meter->packets) / (double)(meter->frames),
+                (double)(stats.syscalls - meter->lastStats.syscalls) / (double)(meter->frames),
+                (double)(meter->cpuTimeNs) / (double)(meter->frames) / 1000.0,
+                (unsigned long long)(meter->frames));
+
+            meter->lastStats = stats;
+        }
+        else {
+
+            LOG_MSG_DBG(LOG_MOD_NETSINK, STR_LOG_MSG_FUNC48_METER_STOCK_INFO,
+                (double)(meter->packets) / (double)(meter->frames),
+                (double)(meter->cpuTimeNs) / (double)(meter->frames) / 1000.0,
+                (unsigned long long)(meter->frames));
+        }
+
+        meter->frames = 0;
+        meter->packets = 0;
+        meter->cpuTimeNs = 0;
+    }
+
+    return GST_PAD_PROBE_OK;
+}
+
+#ifdef CC_TRACE_ENABLED
+static GstPadProbeReturn networkSinkCapsProbe(GstPad *pad, GstPadProbeInfo *info, gpointer data) {
+
+    if(GST_EVENT_CAPS == GST_EVENT_TYPE(GST_PAD_PROBE_INFO_EVENT(info))) {
+
+        TRACE_INSTANT(TRACE_PIPE_CAPS, 0);
+    }
+
+    return GST_PAD_PROBE_OK;
+}
+#endif
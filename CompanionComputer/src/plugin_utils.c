@@ -0,0 +1,150 @@
+/**
+ * @file        plugin_utils.c
+ * @author      Adam Csizy
+ * @date        2021-05-21
+ * @version     v1.1.0
+ *
+ * @brief       GStreamer plugin loading utilities
+ */
+
+
+#include <gst/gst.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "log_utils.h"
+#include "plugin_utils.h"
+
+
+/* Plugin related macro definitions */
+
+#define NUM_PLUGIN_ELEMENT_NUM      24U     /**< Number of elements the streaming pipelines may use */
+
+
+/* Plugin related static type declarations */
+
+/**
+ * @brief   Struct of an element the streaming pipelines may use.
+ */
+typedef struct PluginElement {
+
+    const char *name;       /**< Element factory name */
+    int optional;           /**< Element has a fallback (only logged if missing) */
+
+} PluginElement_T;
+
+
+/* Plugin related static variable declarations */
+
+/**
+ * Elements of pipeBuilder(), createH264Encoder(), createVideoSource() and
+ * attachSnapshotBranch() (optional: the stream runs without snapshots).
+ * Keep in sync with the drone list of tools/pin_gst_plugins.py.
+ */
+static const PluginElement_T pluginElements[NUM_PLUGIN_ELEMENT_NUM] = {
+
+    {"v4l2src", FALSE},
+    {"videotestsrc", FALSE},
+    {"multifilesrc", FALSE},
+    {"capsfilter", FALSE},
+    {"identity", FALSE},
+    {"jpegenc", FALSE},
+    {"jpegparse", FALSE},
+    {"h264parse", FALSE},
+    {"autovideoconvert", FALSE},
+    {"omxh264enc", TRUE},
+    {"v4l2h264enc", TRUE},
+    {"x264enc", FALSE},
+    {"rtph265pay", FALSE},
+    {"rtph264pay", FALSE},
+    {"rtpvp8pay", FALSE},
+    {"rtpvp9pay", FALSE},
+    {"rtpjpegpay", FALSE},
+    {"rtph263pay", FALSE},
+    {"udpsink", TRUE},
+    {"tee", FALSE},
+    {"valve", TRUE},
+    {"queue", TRUE},
+    {"videoconvert", TRUE},
+    {"fakesink", TRUE}
+};
+
+
+/* Plugin related function definitions */
+
+int initPluginRegistry(const char *directory) {
+
+    int retval = 0;
+    gchar *registry = NULL;
+    struct stat status;
+
+    #ifdef CC_GST_STATIC
+    /* gstreamer-full registers the linked plugins in 'gst_init()', there is nothing to scan */
+    g_setenv("GST_REGISTRY_DISABLE", "yes", TRUE);
+    createLogMessage(STR_LOG_MSG_FUNC65_STATIC, LOG_SVRTY_INF);
+    return retval;
+    #endif
+
+    if((NULL == directory) || ('\0' == directory[0])) {
+
+        return retval;
+    }
+
+    if((0 != stat(directory, &status)) || !S_ISDIR(status.st_mode)) {
+
+        createLogMessageFormat(LOG_SVRTY_WRN, STR_LOG_MSG_FUNC65_DIR_INVAL, directory);
+        retval = -1;
+        return retval;
+    }
+
+    registry = g_build_filename(directory, STR_PLUGIN_REGISTRY_FILE, NULL);
+
+    /* Only the pinned plugins, no helper process scanning them */
+    g_setenv("GST_PLUGIN_SYSTEM_PATH_1_0", directory, TRUE);
+    g_setenv("GST_PLUGIN_PATH_1_0", "", TRUE);
+    g_setenv("GST_REGISTRY_1_0", registry, TRUE);
+    g_setenv("GST_REGISTRY_FORK", "no", TRUE);
+
+    /* Trust the pinned registry: no stat() of every plugin on startup */
+    if(0 == access(registry, R_OK)) {
+
+        g_setenv("GST_REGISTRY_UPDATE", "no", TRUE);
+        createLogMessageFormat(LOG_SVRTY_INF, STR_LOG_MSG_FUNC65_PINNED, registry);
+    }
+    else {
+
+        createLogMessageFormat(LOG_SVRTY_WRN, STR_LOG_MSG_FUNC65_REGISTRY_MISSING, registry);
+    }
+
+    g_free(registry);
+
+    return retval;
+}
+
+int checkRequiredPlugins(void) {
+
+    int missing = 0;
+    unsigned int i;
+    GstElementFactory *factory = NULL;
+
+    for(i = 0;i < NUM_PLUGIN_ELEMENT_NUM;++i) {
+
+        factory = gst_element_factory_find(pluginElements[i].name);
+        if(NULL != factory) {
+
+            gst_object_unref(factory);
+        }
+        else if(pluginElements[i].optional) {
+
+            LOG_MSG_INF(LOG_MOD_STREAM, STR_LOG_MSG_FUNC66_ELEM_UNAVAILABLE, pluginElements[i].name);
+        }
+        else {
+
+            LOG_MSG_WRN(LOG_MOD_STREAM, STR_LOG_MSG_FUNC66_ELEM_MISSING, pluginElements[i].name);
+            ++missing;
+        }
+    }
+
+    return missing;
+}
@@ -0,0 +1,735 @@
+/**
+ * @file        profiler_utils.c
+ * @author      Adam Csizy
+ * @date        2021-05-18
+ * @version     v1.1.0
+ *
+ * @brief       Runtime pipeline profiling utilities
+ */
+
+
+#include <glib-unix.h>
+#include <gst/gst.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "log_utils.h"
+#include "profiler_utils.h"
+
+
+/* Profiler related macro definitions */
+
+#define NUM_PROFILE_PATH_SIZE       512U    /**< Maximum length of a dump file path */
+#define NUM_PROFILE_LABEL_SIZE      512U    /**< Maximum length of a graph node label */
+#define NUM_NSEC_PER_SEC            1000000000ULL /**< Nanoseconds per second */
+#define NUM_PROFILE_HOT_SHARE       50.0    /**< Processing time share (%) of elements drawn red */
+#define NUM_PROFILE_WARM_SHARE      20.0    /**< Processing time share (%) of elements drawn orange */
+#define STR_PROFILE_QDATA           "pipeline-profile" /**< Element data key of the element profile */
+#define STR_PROFILE_TRACER_LOG      "gst-tracer" /**< Prefix of the GStreamer tracer log file */
+#define STR_PROFILE_COLOR_HOT       "#ff8080" /**< Fill color of elements above NUM_PROFILE_HOT_SHARE */
+#define STR_PROFILE_COLOR_WARM      "#ffd080" /**< Fill color of elements above NUM_PROFILE_WARM_SHARE */
+#define STR_PROFILE_COLOR_IDLE      "#ffffff" /**< Fill color of the other elements */
+
+
+/* Profiler related static type declarations */
+
+/**
+ * @brief   Profile of a pipeline element.
+ *
+ * @details The counters are updated by the pad probes in the
+ *          streaming threads. The sampled queue levels and the
+ *          counters of the previous dump belong to the default
+ *          main context.
+ */
+typedef struct ElementProfile {
+
+    _Atomic uint64_t inBuffers;     /**< Buffers entering the element */
+    _Atomic uint64_t inBytes;       /**< Bytes entering the element */
+    _Atomic uint64_t outBuffers;    /**< Buffers leaving the element */
+    _Atomic uint64_t outBytes;      /**< Bytes leaving the element */
+    _Atomic uint64_t procCount;     /**< Measured processing times */
+    _Atomic uint64_t procTotalNs;   /**< Sum of the processing times */
+    _Atomic uint64_t procMaxNs;     /**< Longest processing time since the previous dump */
+    _Atomic uint64_t entryNs;       /**< Arrival of the latest buffer without output yet (0: none) */
+    int queue;                      /**< Flag whether the element is a queue */
+
+    uint64_t queueSamples;          /**< Queue level samples since the previous dump */
+    uint64_t queueBuffersSum;       /**< Sum of the sampled queue levels in buffers */
+    uint64_t queueBuffersMax;       /**< Highest sampled queue level in buffers */
+    uint64_t queueTimeSumNs;        /**< Sum of the sampled queue levels in time */
+    uint64_t queueTimeMaxNs;        /**< Highest sampled queue level in time */
+
+    uint64_t lastInBuffers;         /**< 'inBuffers' at the previous dump */
+    uint64_t lastInBytes;           /**< 'inBytes' at the previous dump */
+    uint64_t lastOutBuffers;        /**< 'outBuffers' at the previous dump */
+    uint64_t lastOutBytes;          /**< 'outBytes' at the previous dump */
+    uint64_t lastProcCount;         /**< 'procCount' at the previous dump */
+    uint64_t lastProcTotalNs;       /**< 'procTotalNs' at the previous dump */
+    uint64_t lastDumpNs;            /**< Time of the previous dump (or of the attachment) */
+
+} ElementProfile_T;
+
+
+/* Profiler related static variable declarations */
+
+static char *profileDirectory = NULL;       /**< Dump directory (NULL: profiler disabled) */
+static GSList *profiledPipelines = NULL;    /**< Weak references of the profiled pipelines */
+static GMutex profilerLock;                 /**< Lock of 'profiledPipelines' */
+static _Atomic int dumpPending = 0;         /**< Non-zero while a dump is scheduled */
+static unsigned int dumpSequence = 0;       /**< Number of written dumps (main context only) */
+
+
+/* Profiler related static function declarations */
+
+/**
+ * @brief       Get CLOCK_MONOTONIC time in nanoseconds.
+ *
+ * @return      Monotonic time in nanoseconds.
+ */
+static uint64_t getMonotonicNs(void);
+
+/**
+ * @brief       Get element profile.
+ *
+ * @param[in]   element Pipeline element.
+ *
+ * @return      Profile of the element or NULL if not profiled.
+ */
+static ElementProfile_T* getElementProfile(GstElement *element);
+
+/**
+ * @brief       Get size of probed data.
+ *
+ * @param[in]   info Pad probe information (buffer or buffer list).
+ * @param[out]  buffers Number of buffers.
+ * @param[out]  bytes Number of bytes.
+ */
+static void getProbeDataSize(GstPadProbeInfo *info, uint64_t *buffers, uint64_t *bytes);
+
+/**
+ * @brief       Sink pad probe of a profiled element.
+ *
+ * @details     Counts the entering buffers and stamps their arrival.
+ *
+ * @param[in,out]   pad Sink pad.
+ * @param[in]   info Pad probe information.
+ * @param[in,out]   data Element profile.
+ *
+ * @return      GST_PAD_PROBE_OK.
+ */
+static GstPadProbeReturn profileSinkProbe(GstPad *pad, GstPadProbeInfo *info, gpointer data);
+
+/**
+ * @brief       Source pad probe of a profiled element.
+ *
+ * @details     Counts the leaving buffers. The first output after
+ *              an arrival closes a processing time measurement
+ *              (later outputs of the same input, e.g. the RTP
+ *              packets of a frame, are not measured again).
+ *
+ * @param[in,out]   pad Source pad.
+ * @param[in]   info Pad probe information.
+ * @param[in,out]   data Element profile.
+ *
+ * @return      GST_PAD_PROBE_OK.
+ */
+static GstPadProbeReturn profileSrcProbe(GstPad *pad, GstPadProbeInfo *info, gpointer data);
+
+/**
+ * @brief       Add profile probe to a pad.
+ *
+ * @details     'gst_element_foreach_pad()' compatible function.
+ *
+ * @param[in,out]   element Pipeline element.
+ * @param[in,out]   pad Pad of the element.
+ * @param[in,out]   data Element profile.
+ *
+ * @return      TRUE (continue with the next pad).
+ */
+static gboolean addProfileProbe(GstElement *element, GstPad *pad, gpointer data);
+
+/**
+ * @brief       Attach profile to an element.
+ *
+ * @details     'gst_iterator_foreach()' compatible function.
+ *
+ * @param[in]   item Pipeline element.
+ * @param[in]   data Not used.
+ */
+static void attachElementProfile(const GValue *item, gpointer data);
+
+/**
+ * @brief       Sample queue level of an element.
+ *
+ * @details     'gst_iterator_foreach()' compatible function.
+ *
+ * @param[in]   item Pipeline element.
+ * @param[in]   data Not used.
+ */
+static void sampleQueueLevel(const GValue *item, gpointer data);
+
+/**
+ * @brief       Get top-level elements of a pipeline.
+ *
+ * @param[in]   pipeline GStreamer pipeline.
+ *
+ * @return      Array of element references (free with 'g_ptr_array_unref()').
+ */
+static GPtrArray* getPipelineElements(GstElement *pipeline);
+
+/**
+ * @brief       Write profile of a pipeline.
+ *
+ * @details     Writes the annotated DOT graph of the pipeline (see
+ *              requestPipelineProfileDump()) and starts a new
+ *              measurement window.
+ *
+ * @param[in]   pipeline GStreamer pipeline.
+ * @param[in]   index Index of the pipeline in the dump.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+static int writePipelineProfile(GstElement *pipeline, const unsigned int index);
+
+/**
+ * @brief       Profile dump callback.
+ *
+ * @details     Idle callback on the default main context writing
+ *              the profile of every live profiled pipeline.
+ *
+ * @param[in]   data Not used.
+ *
+ * @return      G_SOURCE_REMOVE.
+ */
+static gboolean profileDumpCallback(gpointer data);
+
+/**
+ * @brief       Profile sample callback.
+ *
+ * @details     Periodic callback on the default main context
+ *              sampling the queue levels of the live profiled
+ *              pipelines and dropping the finalized ones.
+ *
+ * @param[in]   data Not used.
+ *
+ * @return      G_SOURCE_CONTINUE.
+ */
+static gboolean profileSampleCallback(gpointer data);
+
+/**
+ * @brief       Profile signal callback.
+ *
+ * @details     SIGUSR2 callback on the default main context.
+ *
+ * @param[in]   data Not used.
+ *
+ * @return      G_SOURCE_CONTINUE.
+ */
+static gboolean profileSignalCallback(gpointer data);
+
+
+/* Profiler related function definitions */
+
+int initPipelineProfiler(const char *directory) {
+
+    int retval = 0;
+    gchar *tracerLog = NULL;
+
+    if((NULL == directory) || ('\0' == directory[0])) {
+
+        return retval;
+    }
+
+    profileDirectory = g_strdup(directory);
+
+    /* GStreamer reads the tracer configuration in gst_init() */
+    g_setenv("GST_TRACERS", STR_PROFILE_DEFAULT_TRACERS, FALSE);
+    if(NULL == g_getenv("GST_DEBUG")) {
+
+        g_setenv("GST_DEBUG", STR_PROFILE_TRACER_DEBUG, TRUE);
+        if(NULL == g_getenv("GST_DEBUG_FILE")) {
+
+            tracerLog = g_strdup_printf("%s/%s-%d.log", profileDirectory, STR_PROFILE_TRACER_LOG, (int)getpid());
+            g_setenv("GST_DEBUG_FILE", tracerLog, TRUE);
+            g_free(tracerLog);
+        }
+    }
+
+    g_timeout_add(NUM_PROFILE_SAMPLE_PERIOD_MS, profileSampleCallback, NULL);
+    if(0 == g_unix_signal_add(SIGUSR2, profileSignalCallback, NULL)) {
+
+        createLogMessage(STR_LOG_MSG_FUNC59_SIGNAL_ADD_FAIL, LOG_SVRTY_WRN);
+        retval = -1;
+    }
+
+    createLogMessageFormat(LOG_SVRTY_INF, STR_LOG_MSG_FUNC59_PROFILER_ENABLED, profileDirectory);
+
+    return retval;
+}
+
+void attachPipelineProfiler(GstElement *pipeline) {
+
+    GstIterator *iterator = NULL;
+    GWeakRef *reference = NULL;
+
+    if((NULL == profileDirectory) || (NULL == pipeline)) {
+
+        return;
+    }
+
+    iterator = gst_bin_iterate_elements(GST_BIN(pipeline));
+    if(GST_ITERATOR_OK != gst_iterator_foreach(iterator, attachElementProfile, NULL)) {
+
+        createLogMessage(STR_LOG_MSG_FUNC60_ITERATE_FAIL, LOG_SVRTY_WRN);
+    }
+    gst_iterator_free(iterator);
+
+    reference = g_new0(GWeakRef, 1);
+    g_weak_ref_init(reference, pipeline);
+
+    g_mutex_lock(&profilerLock);
+    profiledPipelines = g_slist_prepend(profiledPipelines, reference);
+    g_mutex_unlock(&profilerLock);
+}
+
+void requestPipelineProfileDump(void) {
+
+    if((NULL != profileDirectory) && (0 == atomic_exchange(&dumpPending, 1))) {
+
+        g_idle_add(profileDumpCallback, NULL);
+    }
+}
+
+static uint64_t getMonotonicNs(void) {
+
+    struct timespec now = {0};
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return ((uint64_t)(now.tv_sec) * NUM_NSEC_PER_SEC) + (uint64_t)(now.tv_nsec);
+}
+
+static ElementProfile_T* getElementProfile(GstElement *element) {
+
+    return (ElementProfile_T*)g_object_get_data(G_OBJECT(element), STR_PROFILE_QDATA);
+}
+
+static void getProbeDataSize(GstPadProbeInfo *info, uint64_t *buffers, uint64_t *bytes) {
+
+    GstBufferList *list = NULL;
+
+    if(GST_PAD_PROBE_INFO_TYPE(info) & GST_PAD_PROBE_TYPE_BUFFER_LIST) {
+
+        list = GST_PAD_PROBE_INFO_BUFFER_LIST(info);
+        *buffers = gst_buffer_list_length(list);
+        *bytes = gst_buffer_list_calculate_size(list);
+    }
+    else {
+
+        *buffers = 1;
+        *bytes = gst_buffer_get_size(GST_PAD_PROBE_INFO_BUFFER(info));
+    }
+}
+
+static GstPadProbeReturn profileSinkProbe(GstPad *pad, GstPadProbeInfo *info, gpointer data) {
+
+    uint64_t buffers, bytes;
+    ElementProfile_T *profile = (ElementProfile_T*)data;
+
+    getProbeDataSize(info, &buffers, &bytes);
+    atomic_fetch_add_explicit(&profile->inBuffers, buffers, memory_order_relaxed);
+    atomic_fetch_add_explicit(&profile->inBytes, bytes, memory_order_relaxed);
+    atomic_store_explicit(&profile->entryNs, getMonotonicNs(), memory_order_relaxed);
+
+    return GST_PAD_PROBE_OK;
+}
+
+static GstPadProbeReturn profileSrcProbe(GstPad *pad, GstPadProbeInfo *info, gpointer data) {
+
+    uint64_t buffers, bytes, entryNs, procNs, maxNs;
+    ElementProfile_T *profile = (ElementProfile_T*)data;
+
+    getProbeDataSize(info, &buffers, &bytes);
+    atomic_fetch_add_explicit(&profile->outBuffers, buffers, memory_order_relaxed);
+    atomic_fetch_add_explicit(&profile->outBytes, bytes, memory_order_relaxed);
+
+    /* Queues hand buffers over to another thread: their level is sampled instead */
+    entryNs = atomic_exchange_explicit(&profile->entryNs, 0, memory_order_relaxed);
+    if((0U != entryNs) && (!profile->queue)) {
+
+        procNs = getMonotonicNs() - entryNs;
+        atomic_fetch_add_explicit(&profile->procCount, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&profile->procTotalNs, procNs, memory_order_relaxed);
+
+        maxNs = atomic_load_explicit(&profile->procMaxNs, memory_order_relaxed);
+        while((procNs > maxNs) && (!atomic_compare_exchange_weak_explicit(&profile->procMaxNs, &maxNs, procNs, memory_order_relaxed, memory_order_relaxed))) {
+
+            // NOP
+        }
+    }
+
+    return GST_PAD_PROBE_OK;
+}
+
+static gboolean addProfileProbe(GstElement *element, GstPad *pad, gpointer data) {
+
+    if(GST_PAD_SINK == GST_PAD_DIRECTION(pad)) {
+
+        gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST, profileSinkProbe, data, NULL);
+    }
+    else if(GST_PAD_SRC == GST_PAD_DIRECTION(pad)) {
+
+        gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST, profileSrcProbe, data, NULL);
+    }
+
+    return TRUE;
+}
+
+static void attachElementProfile(const GValue *item, gpointer data) {
+
+    GstElement *element = GST_ELEMENT(g_value_get_object(item));
+    ElementProfile_T *profile = NULL;
+
+    if(NULL != getElementProfile(element)) {
+
+        return;
+    }
+
+    /* Freed with the element (the probes go with its pads) */
+    profile = g_new0(ElementProfile_T, 1);
+    profile->queue = (NULL != g_object_class_find_property(G_OBJECT_GET_CLASS(element), "current-level-buffers"));
+    profile->lastDumpNs = getMonotonicNs();
+    g_object_set_data_full(G_OBJECT(element), STR_PROFILE_QDATA, profile, g_free);
+
+    gst_element_foreach_pad(element, addProfileProbe, profile);
+}
+
+static void sampleQueueLevel(const GValue *item, gpointer data) {
+
+    guint levelBuffers = 0;
+    guint64 levelTimeNs = 0;
+    GstElement *element = GST_ELEMENT(g_value_get_object(item));
+    ElementProfile_T *profile = getElementProfile(element);
+
+    if((NULL == profile) || (!profile->queue)) {
+
+        return;
+    }
+
+    g_object_get(element, "current-level-buffers", &levelBuffers, "current-level-time", &levelTimeNs, NULL);
+
+    ++profile->queueSamples;
+    profile->queueBuffersSum += levelBuffers;
+    profile->queueTimeSumNs += levelTimeNs;
+    profile->queueBuffersMax = (levelBuffers > profile->queueBuffersMax) ? levelBuffers : profile->queueBuffersMax;
+    profile->queueTimeMaxNs = (levelTimeNs > profile->queueTimeMaxNs) ? levelTimeNs : profile->queueTimeMaxNs;
+}
+
+static GPtrArray* getPipelineElements(GstElement *pipeline) {
+
+    gboolean done = FALSE;
+    GValue item = G_VALUE_INIT;
+    GstIterator *iterator = NULL;
+    GPtrArray *elements = g_ptr_array_new_with_free_func(gst_object_unref);
+
+    iterator = gst_bin_iterate_elements(GST_BIN(pipeline));
+    while(!done) {
+
+        switch(gst_iterator_next(iterator, &item)) {
+
+            case GST_ITERATOR_OK:
+
+                g_ptr_array_add(elements, gst_object_ref(g_value_get_object(&item)));
+                g_value_reset(&item);
+                break;
+
+            case GST_ITERATOR_RESYNC:
+
+                g_ptr_array_set_size(elements, 0);
+                gst_iterator_resync(iterator);
+                break;
+
+            default:
+
+                done = TRUE;
+                break;
+        }
+    }
+    g_value_unset(&item);
+    gst_iterator_free(iterator);
+
+    return elements;
+}
+
+static int writePipelineProfile(GstElement *pipeline, const unsigned int index) {
+
+    int retval = 0;
+    guint i;
+    gboolean live = FALSE;
+    GstClockTime minLatency = 0, maxLatency = GST_CLOCK_TIME_NONE;
+    uint64_t nowNs = getMonotonicNs();
+    uint64_t procDelta, procTotal = 0, bottleneckProc = 0;
+    uint64_t inBuffers, inBytes, outBuffers, outBytes, procCount, procNs, procMaxNs;
+    double window, share;
+    char path[NUM_PROFILE_PATH_SIZE];
+    char label[NUM_PROFILE_LABEL_SIZE];
+    size_t length;
+    const char *factoryName = NULL;
+    const char *mediaType = NULL;
+    GstElement *element = NULL;
+    GstElement *bottleneck = NULL;
+    GstElement *peerElement = NULL;
+    GstElementFactory *factory = NULL;
+    GstPad *pad = NULL;
+    GstPad *peer = NULL;
+    GstCaps *caps = NULL;
+    GstIterator *iterator = NULL;
+    GValue item = G_VALUE_INIT;
+    GstQuery *query = NULL;
+    GPtrArray *elements = NULL;
+    ElementProfile_T *profile = NULL;
+    FILE *file = NULL;
+    gchar *pipelineName = NULL;
+
+    pipelineName = gst_element_get_name(pipeline);
+    snprintf(path, sizeof(path), "%s/%s-%d-%u-%u.dot", profileDirectory, pipelineName, (int)getpid(), dumpSequence, index);
+
+    file = fopen(path, "w");
+    if(NULL == file) {
+
+        createLogMessageFormat(LOG_SVRTY_ERR, STR_LOG_MSG_FUNC61_FILE_OPEN_FAIL, path);
+        g_free(pipelineName);
+        retval = -1;
+        return retval;
+    }
+
+    elements = getPipelineElements(pipeline);
+
+    /* Processing time shares of the window */
+    for(i = 0;i < elements->len;++i) {
+
+        profile = getElementProfile(GST_ELEMENT(g_ptr_array_index(elements, i)));
+        if(NULL != profile) {
+
+            procDelta = atomic_load(&profile->procTotalNs) - profile->lastProcTotalNs;
+            procTotal += procDelta;
+            if(procDelta > bottleneckProc) {
+
+                bottleneckProc = procDelta;
+                bottleneck = GST_ELEMENT(g_ptr_array_index(elements, i));
+            }
+        }
+    }
+
+    query = gst_query_new_latency();
+    if(gst_element_query(pipeline, query)) {
+
+        gst_query_parse_latency(query, &live, &minLatency, &maxLatency);
+    }
+    gst_query_unref(query);
+
+    fprintf(file, "digraph \"%s\" {\n", pipelineName);
+    fprintf(file, "  rankdir=LR;\n  labelloc=t;\n  fontname=\"monospace\";\n");
+    fprintf(file, "  node [shape=box, style=\"rounded,filled\", fontname=\"monospace\", fontsize=10];\n");
+    fprintf(file, "  edge [fontname=\"monospace\", fontsize=9];\n");
+    fprintf(file, "  label=\"%s: latency %s min %.1f ms max %.1f ms, bottleneck %s (%.1f%% of processing time)\";\n",
+        pipelineName, live ? "live" : "non-live", (double)(minLatency) / 1e6,
+        GST_CLOCK_TIME_IS_VALID(maxLatency) ? (double)(maxLatency) / 1e6 : -1.0,
+        (NULL != bottleneck) ? GST_ELEMENT_NAME(bottleneck) : "none",
+        (0U < procTotal) ? 100.0 * (double)(bottleneckProc) / (double)(procTotal) : 0.0);
+
+    /* Nodes: rates and times since the previous dump */
+    for(i = 0;i < elements->len;++i) {
+
+        element = GST_ELEMENT(g_ptr_array_index(elements, i));
+        profile = getElementProfile(element);
+        factory = gst_element_get_factory(element);
+        factoryName = (NULL != factory) ? GST_OBJECT_NAME(factory) : G_OBJECT_TYPE_NAME(element);
+
+        length = (size_t)snprintf(label, sizeof(label), "%s\\n(%s)", GST_ELEMENT_NAME(element), factoryName);
+        share = 0.0;
+        if(NULL != profile) {
+
+            window = (double)(nowNs - profile->lastDumpNs) / 1e9;
+            window = (0.0 < window) ? window : 1e-9;
+
+            inBuffers = atomic_load(&profile->inBuffers) - profile->lastInBuffers;
+            inBytes = atomic_load(&profile->inBytes) - profile->lastInBytes;
+            outBuffers = atomic_load(&profile->outBuffers) - profile->lastOutBuffers;
+            outBytes = atomic_load(&profile->outBytes) - profile->lastOutBytes;
+            procCount = atomic_load(&profile->procCount) - profile->lastProcCount;
+            procNs = atomic_load(&profile->procTotalNs) - profile->lastProcTotalNs;
+            procMaxNs = atomic_exchange(&profile->procMaxNs, 0);
+
+            if((0U < inBuffers) && (length < sizeof(label))) {
+
+                length += (size_t)snprintf(&label[length], sizeof(label) - length, "\\nin  %.1f buf/s %.0f kbps",
+                    (double)(inBuffers) / window, (double)(inBytes) * 8.0 / 1e3 / window);
+            }
+            if((0U < outBuffers) && (length < sizeof(label))) {
+
+                length += (size_t)snprintf(&label[length], sizeof(label) - length, "\\nout %.1f buf/s %.0f kbps",
+                    (double)(outBuffers) / window, (double)(outBytes) * 8.0 / 1e3 / window);
+            }
+            if((0U < procCount) && (length < sizeof(label))) {
+
+                share = (0U < procTotal) ? 100.0 * (double)(procNs) / (double)(procTotal) : 0.0;
+                length += (size_t)snprintf(&label[length], sizeof(label) - length, "\\nproc avg %.3f ms max %.3f ms (%.1f%%)",
+                    (double)(procNs) / (double)(procCount) / 1e6, (double)(procMaxNs) / 1e6, share);
+            }
+            if((0U < profile->queueSamples) && (length < sizeof(label))) {
+
+                length += (size_t)snprintf(&label[length], sizeof(label) - length, "\\nqueue avg %.1f buf %.1f ms max %llu buf %.1f ms",
+                    (double)(profile->queueBuffersSum) / (double)(profile->queueSamples),
+                    (double)(profile->queueTimeSumNs) / (double)(profile->queueSamples) / 1e6,
+                    (unsigned long long)(profile->queueBuffersMax), (double)(profile->queueTimeMaxNs) / 1e6);
+            }
+
+            /* Start a new window */
+            profile->lastInBuffers += inBuffers;
+            profile->lastInBytes += inBytes;
+            profile->lastOutBuffers += outBuffers;
+            profile->lastOutBytes += outBytes;
+            profile->lastProcCount += procCount;
+            profile->lastProcTotalNs += procNs;
+            profile->lastDumpNs = nowNs;
+            profile->queueSamples = 0;
+            profile->queueBuffersSum = 0;
+            profile->queueBuffersMax = 0;
+            profile->queueTimeSumNs = 0;
+            profile->queueTimeMaxNs = 0;
+        }
+
+        fprintf(file, "  \"%s\" [label=\"%s\", fillcolor=\"%s\"%s];\n", GST_ELEMENT_NAME(element), label,
+            (NUM_PROFILE_HOT_SHARE <= share) ? STR_PROFILE_COLOR_HOT : ((NUM_PROFILE_WARM_SHARE <= share) ? STR_PROFILE_COLOR_WARM : STR_PROFILE_COLOR_IDLE),
+            (element == bottleneck) ? ", penwidth=3" : "");
+    }
+
+    /* Edges: links of the source pads labeled with the negotiated media type */
+    for(i = 0;i < elements->len;++i) {
+
+        element = GST_ELEMENT(g_ptr_array_index(elements, i));
+        iterator = gst_element_iterate_src_pads(element);
+        while(GST_ITERATOR_OK == gst_iterator_next(iterator, &item)) {
+
+            pad = GST_PAD(g_value_get_object(&item));
+            peer = gst_pad_get_peer(pad);
+            peerElement = (NULL != peer) ? gst_pad_get_parent_element(peer) : NULL;
+            if(NULL != peerElement) {
+
+                caps = gst_pad_get_current_caps(pad);
+                mediaType = ((NULL != caps) && (0 < gst_caps_get_size(caps))) ? gst_structure_get_name(gst_caps_get_structure(caps, 0)) : "";
+                fprintf(file, "  \"%s\" -> \"%s\" [label=\"%s\"];\n", GST_ELEMENT_NAME(element), GST_ELEMENT_NAME(peerElement), mediaType);
+                if(NULL != caps) {
+
+                    gst_caps_unref(caps);
+                }
+                gst_object_unref(peerElement);
+            }
+            if(NULL != peer) {
+
+                gst_object_unref(peer);
+            }
+            g_value_reset(&item);
+        }
+        g_value_unset(&item);
+        gst_iterator_free(iterator);
+    }
+
+    fprintf(file, "}\n");
+    if(0 != fclose(file)) {
+
+        createLogMessageFormat(LOG_SVRTY_ERR, STR_LOG_MSG_FUNC61_FILE_WRITE_FAIL, path);
+        retval = -1;
+    }
+    else {
+
+        createLogMessageFormat(LOG_SVRTY_INF, STR_LOG_MSG_FUNC61_PROFILE_WRITTEN, path,
+            (NULL != bottleneck) ? GST_ELEMENT_NAME(bottleneck) : "none",
+            (0U < procTotal) ? 100.0 * (double)(bottleneckProc) / (double)(procTotal) : 0.0);
+    }
+
+    g_ptr_array_unref(elements);
+    g_free(pipelineName);
+
+    return retval;
+}
+
+static gboolean profileDumpCallback(gpointer data) {
+
+    unsigned int index = 0;
+    GSList *node = NULL;
+    GSList *pipelines = NULL;
+    GstElement *pipeline = NULL;
+
+    atomic_store(&dumpPending, 0);
+
+    g_mutex_lock(&profilerLock);
+    for(node = profiledPipelines;NULL != node;node = node->next) {
+
+        pipeline = g_weak_ref_get((GWeakRef*)(node->data));
+        if(NULL != pipeline) {
+
+            pipelines = g_slist_prepend(pipelines, pipeline);
+        }
+    }
+    g_mutex_unlock(&profilerLock);
+
+    /* Written outside of the lock: pipelines may be attached meanwhile */
+    for(node = pipelines;NULL != node;node = node->next) {
+
+        writePipelineProfile(GST_ELEMENT(node->data), index++);
+    }
+    ++dumpSequence;
+    g_slist_free_full(pipelines, gst_object_unref);
+
+    return G_SOURCE_REMOVE;
+}
+
+static gboolean profileSampleCallback(gpointer data) {
+
+    GSList *node = NULL;
+    GSList *next = NULL;
+    GstElement *pipeline = NULL;
+    GstIterator *iterator = NULL;
+
+    g_mutex_lock(&profilerLock);
+    for(node = profiledPipelines;NULL != node;node = next) {
+
+        next = node->next;
+        pipeline = g_weak_ref_get((GWeakRef*)(node->data));
+        if(NULL == pipeline) {
+
+            /* Finalized pipeline */
+            g_weak_ref_clear((GWeakRef*)(node->data));
+            g_free(node->data);
+            profiledPipelines = g_slist_delete_link(profiledPipelines, node);
+        }
+        else {
+
+            iterator = gst_bin_iterate_elements(GST_BIN(pipeline));
+            gst_iterator_foreach(iterator, sampleQueueLevel, NULL);
+            gst_iterator_free(iterator);
+            gst_object_unref(pipeline);
+        }
+    }
+    g_mutex_unlock(&profilerLock);
+
+    return G_SOURCE_CONTINUE;
+}
+
+static gboolean profileSignalCallback(gpointer data) {
+
+    requestPipelineProfileDump();
+
+    return G_SOURCE_CONTINUE;
+}
@@ -0,0 +1,168 @@
+/**
+ * @file        qos_utils.c
+ * @author      Adam Csizy
+ * @date        2021-05-04
+ * @version     v1.1.0
+ *
+ * @brief       Network quality of service utilities
+ */
+
+
+#include <netinet/in.h>
+#include <netinet/ip.h>
+#include <stdint.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+
+#include "log_utils.h"
+#include "qos_utils.h"
+
+
+/* QoS related macro definitions */
+
+#define NUM_QOS_DSCP_SHIFT      2U  /**< DSCP position in the TOS/traffic class byte (ECN bits below) */
+
+
+/* QoS related function definitions */
+
+int getTrafficClassDscp(const TrafficClass_T trafficClass) {
+
+    return (QOS_CLASS_CONTROL == trafficClass) ? NUM_QOS_DSCP_CONTROL : NUM_QOS_DSCP_VIDEO;
+}
+
+int getTrafficClassPriority(const TrafficClass_T trafficClass) {
+
+    return (QOS_CLASS_CONTROL == trafficClass) ? NUM_QOS_PRIO_CONTROL : NUM_QOS_PRIO_VIDEO;
+}
+
+int setSocketDscp(const int sockFd, const int dscp) {
+
+    int retval = 0;
+    int tos = dscp << NUM_QOS_DSCP_SHIFT;
+    struct sockaddr_storage address = {0};
+    socklen_t addressLength = sizeof(address);
+
+    if((0 > sockFd) || (0 > dscp) || (63 < dscp)) {
+
+        createLogMessage(STR_LOG_MSG_FUNC49_ARG_INVAL, LOG_SVRTY_ERR);
+        retval = -1;
+        return retval;
+    }
+
+    if(0 > getsockname(sockFd, (struct sockaddr*)(&address), &addressLength)) {
+
+        createLogMessage(STR_LOG_MSG_FUNC49_SOCK_NAME_FAIL, LOG_SVRTY_ERR);
+        retval = -1;
+        return retval;
+    }
+
+    if(AF_INET6 == address.ss_family) {
+
+        if(0 > setsockopt(sockFd, IPPROTO_IPV6, IPV6_TCLASS, &tos, sizeof(tos))) {
+
+            createLogMessage(STR_LOG_MSG_FUNC49_TCLASS_SET_FAIL, LOG_SVRTY_WRN);
+            retval = -1;
+        }
+
+        /* IPv4-mapped destinations use the IPv4 TOS (fails harmlessly on IPv6-only sockets) */
+        setsockopt(sockFd, IPPROTO_IP, IP_TOS, &tos, sizeof(tos));
+    }
+    else {
+
+        if(0 > setsockopt(sockFd, IPPROTO_IP, IP_TOS, &tos, sizeof(tos))) {
+
+            createLogMessage(STR_LOG_MSG_FUNC49_TOS_SET_FAIL, LOG_SVRTY_WRN);
+            retval = -1;
+        }
+    }
+
+    return retval;
+}
+
+int setSocketPriority(const int sockFd, const int priority) {
+
+    int retval = 0;
+
+    if(0 > setsockopt(sockFd, SOL_SOCKET, SO_PRIORITY, &priority, sizeof(priority))) {
+
+        createLogMessage(STR_LOG_MSG_FUNC50_PRIO_SET_FAIL, LOG_SVRTY_WRN);
+        retval = -1;
+    }
+
+    return retval;
+}
+
+int setSocketTrafficClass(const int sockFd, const TrafficClass_T trafficClass) {
+
+    int retval = 0;
+
+    /* Priority is set last: setting IP_TOS also resets the socket priority on Linux */
+    if(setSocketDscp(sockFd, getTrafficClassDscp(trafficClass))) {
+
+        retval = -1;
+    }
+
+    if(setSocketPriority(sockFd, getTrafficClassPriority(trafficClass))) {
+
+        retval = -1;
+    }
+
+    return retval;
+}
+
+int computeSocketBufferSize(const int bitrateKbps, const int latencyMs) {
+
+    int64_t size;
+
+    /* kbit/s * ms = bit; divide by 8 for bytes */
+    size = ((int64_t)(bitrateKbps) * (int64_t)(latencyMs)) / 8;
+
+    if(NUM_QOS_SOCK_BUF_MIN > size) {
+
+        size = NUM_QOS_SOCK_BUF_MIN;
+    }
+    else if(NUM_QOS_SOCK_BUF_MAX < size) {
+
+        size = NUM_QOS_SOCK_BUF_MAX;
+    }
+
+    return (int)(size);
+}
+
+int setSocketBufferSize(const int sockFd, const int option, const int size) {
+
+    int effectiveSize = 0;
+    int forceOption = (SO_RCVBUF == option) ? SO_RCVBUFFORCE : SO_SNDBUFFORCE;
+    socklen_t optionLength = sizeof(effectiveSize);
+
+    if((0 > sockFd) || (0 >= size) || ((SO_RCVBUF != option) && (SO_SNDBUF != option))) {
+
+        createLogMessage(STR_LOG_MSG_FUNC51_ARG_INVAL, LOG_SVRTY_ERR);
+        return -1;
+    }
+
+    /* Unprivileged fallback is capped by net.core.rmem_max/wmem_max */
+    if(0 > setsockopt(sockFd, SOL_SOCKET, forceOption, &size, sizeof(size))) {
+
+        if(0 > setsockopt(sockFd, SOL_SOCKET, option, &size, sizeof(size))) {
+
+            createLogMessage(STR_LOG_MSG_FUNC51_BUF_SET_FAIL, LOG_SVRTY_WRN);
+            return -1;
+        }
+    }
+
+    if(0 > getsockopt(sockFd, SOL_SOCKET, option, &effectiveSize, &optionLength)) {
+
+        createLogMessage(STR_LOG_MSG_FUNC51_BUF_GET_FAIL, LOG_SVRTY_WRN);
+        return -1;
+    }
+
+    /* The kernel doubles the value for bookkeeping overhead */
+    effectiveSize /= 2;
+    if(effectiveSize < size) {
+
+        createLogMessage(STR_LOG_MSG_FUNC51_BUF_CAPPED, LOG_SVRTY_WRN);
+    }
+
+    return effectiveSize;
+}
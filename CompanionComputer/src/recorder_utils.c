@@ -0,0 +1,191 @@
+/**
+ * @file        recorder_utils.c
+ * @author      Adam Csizy
+ * @date        2021-05-08
+ * @version     v1.1.0
+ *
+ * @brief       Flight recorder utilities
+ */
+
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "log_utils.h"
+#include "recorder_utils.h"
+
+
+/* Flight recorder related macro definitions */
+
+#define NUM_NSEC_PER_SEC        1000000000ULL   /**< Nanoseconds per second */
+#define NUM_RECORDER_FILE_SIZE  (sizeof(FlightRecorderHeader_T) + ((size_t)(NUM_RECORDER_CAPACITY) * sizeof(FlightEvent_T))) /**< Size of the flight recorder file in bytes */
+
+_Static_assert(64 == sizeof(FlightRecorderHeader_T), "Flight recorder header layout changed");
+_Static_assert(128 == sizeof(FlightEvent_T), "Flight recorder event layout changed");
+
+
+/* Flight recorder related static variable declarations */
+
+static FlightRecorderHeader_T *recorderHeader = NULL;   /**< Header of the mapped flight recorder file */
+static FlightEvent_T *recorderEvents = NULL;            /**< Event slots of the mapped flight recorder file */
+
+
+/* Flight recorder related static function declarations */
+
+/**
+ * @brief       Get clock time in nanoseconds.
+ *
+ * @param[in]   clockId Clock identifier.
+ *
+ * @return      Clock time in nanoseconds.
+ */
+static uint64_t getClockNs(const clockid_t clockId);
+
+/**
+ * @brief       Check flight recorder header.
+ *
+ * @param[in]   header Flight recorder header.
+ *
+ * @return      Non-zero if the header matches the compiled geometry.
+ */
+static int isRecorderHeaderValid(const FlightRecorderHeader_T *header);
+
+
+/* Flight recorder related function definitions */
+
+int initFlightRecorder(void) {
+
+    int retval = 0;
+    int fd;
+    void *mapping = NULL;
+    const char *path = NULL;
+    FlightRecorderHeader_T *header = NULL;
+
+    path = getenv(STR_RECORDER_ENV_FILE);
+    if((NULL == path) || ('\0' == path[0])) {
+
+        path = STR_RECORDER_FILE_DEFAULT;
+    }
+
+    fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if(0 > fd) {
+
+        createLogMessageFormat(LOG_SVRTY_WRN, STR_LOG_MSG_FUNC52_OPEN_FAIL, path, strerror(errno));
+        retval = -1;
+        return retval;
+    }
+
+    /* Fixed size: growing (or shrinking) a file of another geometry is fine, it is reinitialized below */
+    if(0 > ftruncate(fd, (off_t)(NUM_RECORDER_FILE_SIZE))) {
+
+        createLogMessageFormat(LOG_SVRTY_WRN, STR_LOG_MSG_FUNC52_SIZE_FAIL, path, strerror(errno));
+        close(fd);
+        retval = -1;
+        return retval;
+    }
+
+    mapping = mmap(NULL, NUM_RECORDER_FILE_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if(MAP_FAILED == mapping) {
+
+        createLogMessageFormat(LOG_SVRTY_WRN, STR_LOG_MSG_FUNC52_MMAP_FAIL, path, strerror(errno));
+        retval = -1;
+        return retval;
+    }
+
+    header = (FlightRecorderHeader_T*)mapping;
+    if(isRecorderHeaderValid(header)) {
+
+        header->sessions++;
+        createLogMessageFormat(LOG_SVRTY_INF, STR_LOG_MSG_FUNC52_FILE_RESUMED, path,
+            (unsigned long long)(atomic_load_explicit(&header->nextIndex, memory_order_relaxed)), header->sessions);
+    }
+    else {
+
+        memset(mapping, 0, NUM_RECORDER_FILE_SIZE);
+        memcpy(header->magic, STR_RECORDER_MAGIC, NUM_RECORDER_MAGIC_SIZE);
+        header->version = NUM_RECORDER_VERSION;
+        header->eventSize = sizeof(FlightEvent_T);
+        header->capacity = NUM_RECORDER_CAPACITY;
+        header->sessions = 1;
+        atomic_init(&header->nextIndex, 0);
+        createLogMessageFormat(LOG_SVRTY_INF, STR_LOG_MSG_FUNC52_FILE_RESET, path);
+    }
+
+    recorderEvents = (FlightEvent_T*)((char*)(mapping) + sizeof(FlightRecorderHeader_T));
+    recorderHeader = header;
+
+    recordFlightEvent(REC_EVT_SESSION, 0, (int32_t)(getpid()), (int32_t)(header->sessions), path);
+    atexit(syncFlightRecorder);
+
+    return retval;
+}
+
+void recordFlightEvent(const FlightEventType_T type, const uint16_t code, const int32_t arg0, const int32_t arg1, const char *text) {
+
+    uint64_t index;
+    FlightEvent_T *event = NULL;
+
+    if(NULL == recorderHeader) {
+
+        return;
+    }
+
+    index = atomic_fetch_add_explicit(&recorderHeader->nextIndex, 1, memory_order_relaxed);
+    event = &recorderEvents[index % NUM_RECORDER_CAPACITY];
+
+    /* Invalidate the slot first: a crash below leaves it skipped instead of torn */
+    atomic_store_explicit(&event->sequence, 0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    event->timestampNs = getClockNs(CLOCK_REALTIME);
+    event->monotonicNs = getClockNs(CLOCK_MONOTONIC);
+    event->type = (uint16_t)(type);
+    event->code = code;
+    event->threadId = (uint32_t)(syscall(SYS_gettid));
+    event->arg0 = arg0;
+    event->arg1 = arg1;
+    if(NULL != text) {
+
+        strncpy(event->text, text, NUM_RECORDER_TEXT_SIZE - 1);
+        event->text[NUM_RECORDER_TEXT_SIZE - 1] = '\0';
+    }
+    else {
+
+        event->text[0] = '\0';
+    }
+
+    atomic_store_explicit(&event->sequence, index + 1, memory_order_release);
+}
+
+void syncFlightRecorder(void) {
+
+    if(NULL != recorderHeader) {
+
+        msync(recorderHeader, NUM_RECORDER_FILE_SIZE, MS_ASYNC);
+    }
+}
+
+static uint64_t getClockNs(const clockid_t clockId) {
+
+    struct timespec now = {0};
+
+    clock_gettime(clockId, &now);
+
+    return ((uint64_t)(now.tv_sec) * NUM_NSEC_PER_SEC) + (uint64_t)(now.tv_nsec);
+}
+
+static int isRecorderHeaderValid(const FlightRecorderHeader_T *header) {
+
+    return ((0 == memcmp(header->magic, STR_RECORDER_MAGIC, NUM_RECORDER_MAGIC_SIZE)) &&
+            (NUM_RECORDER_VERSION == header->version) &&
+            (sizeof(FlightEvent_T) == header->eventSize) &&
+            (NUM_RECORDER_CAPACITY == header->capacity));
+}
@@ -0,0 +1,465 @@
+/**
+ * @file        sched_utils.c
+ * @author      Adam Csizy
+ * @date        2021-05-25
+ * @version     v1.1.0
+ *
+ * @brief       Thread scheduling and CPU affinity utilities
+ */
+
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE     /**< CPU affinity and the Linux scheduling policies */
+#endif
+
+#include <errno.h>
+#include <gst/gst.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "log_utils.h"
+#include "sched_utils.h"
+
+
+/* Scheduling related macro definitions */
+
+#define NUM_SCHED_SPEC_SIZE         512U    /**< Maximum length of a scheduling specification */
+#define STR_SCHED_SPEC_DELIMITERS   " \t\n" /**< Separators of the scheduling specification entries */
+#define STR_SCHED_DATA_STAGE        "sched-stage" /**< Element data key of its pipeline stage (stored plus one, see setPipelineStage()) */
+#define NUM_SCHED_NICE_MIN          -20     /**< Lowest nice value */
+#define NUM_SCHED_NICE_MAX          19      /**< Highest nice value */
+
+
+/* Scheduling related static type declarations */
+
+/**
+ * @brief   Struct of a scheduling class entry.
+ */
+typedef struct SchedEntry {
+
+    int policySet;          /**< Flag whether the entry sets the policy */
+    int policy;             /**< Scheduling policy (SCHED_*) */
+    int priority;           /**< Real-time priority (SCHED_FIFO, SCHED_RR) or nice value */
+    int cpusSet;            /**< Flag whether the entry sets the CPU affinity */
+    cpu_set_t cpus;         /**< CPU affinity */
+
+} SchedEntry_T;
+
+
+/* Scheduling related static variable declarations */
+
+static SchedEntry_T schedEntries[SCHED_CLASS_COUNT];   /**< Scheduling of the classes (written before the threads start) */
+static int schedEnabled = FALSE;                        /**< Flag whether any class has an entry */
+static cpu_set_t defaultCpus;                           /**< CPU affinity of the process at initialization */
+static const char *const schedClassNames[SCHED_CLASS_COUNT] = {"capture", "encode", "send", "control", "network", "mainloop", "log"}; /**< Names of the scheduling classes */
+
+
+/* Scheduling related static function declarations */
+
+/**
+ * @brief       Parse scheduling specification entry.
+ *
+ * @param[in]   text Entry text (<class>=[<policy>[:<priority>]][@<cpus>], modified).
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure (invalid entry)
+ */
+static int parseSchedEntry(char *text);
+
+/**
+ * @brief       Parse CPU list.
+ *
+ * @param[in]   text CPU list (e.g. "0-1,3").
+ * @param[out]  cpus CPU set.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure (invalid list)
+ */
+static int parseCpuList(const char *text, cpu_set_t *cpus);
+
+/**
+ * @brief       Set scheduling of the calling thread.
+ *
+ * @param[in]   entry Scheduling to set.
+ * @param[in]   name Class name (logged on failure).
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+static int setThreadScheduling(const SchedEntry_T *entry, const char *name);
+
+/**
+ * @brief       Pipeline bus synchronous handler.
+ *
+ * @details     Applies the scheduling of the owner's pipeline stage
+ *              to a streaming thread entering its task and restores
+ *              the default scheduling when it leaves. Runs in the
+ *              streaming thread posting the stream status message.
+ *
+ * @param[in]   bus Pipeline bus.
+ * @param[in]   message Bus message.
+ * @param[in]   data Not used.
+ *
+ * @return      GST_BUS_PASS (every message reaches the signal watch).
+ */
+static GstBusSyncReply schedSyncHandler(GstBus *bus, GstMessage *message, gpointer data);
+
+
+/* Scheduling related function definitions */
+
+int initThreadScheduling(const char *spec) {
+
+    int retval = 0;
+    char *entry = NULL;
+    char *context = NULL;
+    char buffer[NUM_SCHED_SPEC_SIZE];
+
+    memset(schedEntries, 0, sizeof(schedEntries));
+    schedEnabled = FALSE;
+    if(sched_getaffinity(0, sizeof(defaultCpus), &defaultCpus)) {
+
+        CPU_ZERO(&defaultCpus);
+    }
+
+    if((NULL == spec) || ('\0' == spec[0])) {
+
+        return retval;
+    }
+
+    if(sizeof(buffer) <= strlen(spec)) {
+
+        LOG_MSG_ERR(LOG_MOD_GENERAL, STR_LOG_MSG_FUNC77_SPEC_TOO_LONG, (unsigned int)(sizeof(buffer) - 1U));
+        retval = -1;
+        return retval;
+    }
+    strcpy(buffer, spec);
+
+    for(entry = strtok_r(buffer, STR_SCHED_SPEC_DELIMITERS, &context);NULL != entry;entry = strtok_r(NULL, STR_SCHED_SPEC_DELIMITERS, &context)) {
+
+        if(parseSchedEntry(entry)) {
+
+            retval = -1;
+        }
+    }
+
+    if(schedEnabled) {
+
+        LOG_MSG_INF(LOG_MOD_GENERAL, STR_LOG_MSG_FUNC77_ENABLED, spec);
+    }
+
+    return retval;
+}
+
+int applyThreadScheduling(const SchedClass_T threadClass) {
+
+    int retval = 0;
+    const SchedEntry_T *entry = NULL;
+
+    if((0 > (int)(threadClass)) || (SCHED_CLASS_COUNT <= threadClass)) {
+
+        createLogMessage(STR_LOG_MSG_FUNC78_ARG_INVAL, LOG_SVRTY_ERR);
+        retval = -1;
+        return retval;
+    }
+
+    entry = &schedEntries[threadClass];
+    if(entry->policySet || entry->cpusSet) {
+
+        retval = setThreadScheduling(entry, schedClassNames[threadClass]);
+    }
+
+    return retval;
+}
+
+void setPipelineStage(GstElement *element, const SchedClass_T stage) {
+
+    if((NULL != element) && (SCHED_CLASS_COUNT > stage)) {
+
+        g_object_set_data(G_OBJECT(element), STR_SCHED_DATA_STAGE, GUINT_TO_POINTER((guint)stage + 1U));
+    }
+}
+
+void attachPipelineScheduling(GstElement *pipeline) {
+
+    GstBus *bus = NULL;
+
+    if(schedEnabled && (NULL != pipeline)) {
+
+        bus = gst_pipeline_get_bus(GST_PIPELINE(pipeline));
+        gst_bus_set_sync_handler(bus, schedSyncHandler, NULL, NULL);
+        gst_object_unref(bus);
+    }
+}
+
+static int parseSchedEntry(char *text) {
+
+    int retval = 0;
+    int i;
+    long value;
+    char *end = NULL;
+    char *policy = NULL;
+    char *priority = NULL;
+    char *cpus = NULL;
+    SchedEntry_T entry;
+
+    memset(&entry, 0, sizeof(entry));
+
+    policy = strchr(text, '=');
+    if(NULL == policy) {
+
+        LOG_MSG_ERR(LOG_MOD_GENERAL, STR_LOG_MSG_FUNC77_ENTRY_INVAL, text);
+        retval = -1;
+        return retval;
+    }
+    *policy++ = '\0';
+
+    for(i = 0;(i < (int)(SCHED_CLASS_COUNT)) && (0 != strcmp(text, schedClassNames[i]));++i);
+    if((int)(SCHED_CLASS_COUNT) == i) {
+
+        LOG_MSG_ERR(LOG_MOD_GENERAL, STR_LOG_MSG_FUNC77_ENTRY_INVAL, text);
+        retval = -1;
+        return retval;
+    }
+
+    cpus = strchr(policy, '@');
+    if(NULL != cpus) {
+
+        *cpus++ = '\0';
+        if(parseCpuList(cpus, &entry.cpus)) {
+
+            LOG_MSG_ERR(LOG_MOD_GENERAL, STR_LOG_MSG_FUNC77_ENTRY_INVAL, text);
+            retval = -1;
+            return retval;
+        }
+        entry.cpusSet = TRUE;
+    }
+
+    priority = strchr(policy, ':');
+    if(NULL != priority) {
+
+        *priority++ = '\0';
+        value = strtol(priority, &end, 10);
+        if((end == priority) || ('\0' != *end)) {
+
+            LOG_MSG_ERR(LOG_MOD_GENERAL, STR_LOG_MSG_FUNC77_ENTRY_INVAL, text);
+            retval = -1;
+            return retval;
+        }
+        entry.priority = (int)(value);
+    }
+
+    if('\0' != policy[0]) {
+
+        entry.policySet = TRUE;
+        if(0 == strcmp(policy, "other")) {
+
+            entry.policy = SCHED_OTHER;
+        }
+        else if(0 == strcmp(policy, "batch")) {
+
+            entry.policy = SCHED_BATCH;
+        }
+        else if(0 == strcmp(policy, "idle")) {
+
+            entry.policy = SCHED_IDLE;
+        }
+        else if(0 == strcmp(policy, "fifo")) {
+
+            entry.policy = SCHED_FIFO;
+        }
+        else if(0 == strcmp(policy, "rr")) {
+
+            entry.policy = SCHED_RR;
+        }
+        else {
+
+            entry.policySet = FALSE;
+        }
+
+        /* Real-time priority or nice value in range (SCHED_IDLE has neither) */
+        if(!entry.policySet ||
+           (((SCHED_FIFO == entry.policy) || (SCHED_RR == entry.policy)) &&
+            ((sched_get_priority_min(entry.policy) > entry.priority) || (sched_get_priority_max(entry.policy) < entry.priority))) ||
+           (((SCHED_OTHER == entry.policy) || (SCHED_BATCH == entry.policy)) &&
+            ((NUM_SCHED_NICE_MIN > entry.priority) || (NUM_SCHED_NICE_MAX < entry.priority))) ||
+           ((SCHED_IDLE == entry.policy) && (0 != entry.priority))) {
+
+            LOG_MSG_ERR(LOG_MOD_GENERAL, STR_LOG_MSG_FUNC77_ENTRY_INVAL, text);
+            retval = -1;
+            return retval;
+        }
+    }
+    else if(NULL != priority) {
+
+        /* A priority without policy */
+        LOG_MSG_ERR(LOG_MOD_GENERAL, STR_LOG_MSG_FUNC77_ENTRY_INVAL, text);
+        retval = -1;
+        return retval;
+    }
+
+    schedEntries[i] = entry;
+    schedEnabled = TRUE;
+
+    return retval;
+}
+
+static int parseCpuList(const char *text, cpu_set_t *cpus) {
+
+    int retval = 0;
+    long first, last, cpu;
+    char *end = NULL;
+
+    CPU_ZERO(cpus);
+
+    while('\0' != *text) {
+
+        first = strtol(text, &end, 10);
+        if((end == text) || (0 > first)) {
+
+            retval = -1;
+            return retval;
+        }
+
+        last = first;
+        if('-' == *end) {
+
+            text = end + 1;
+            last = strtol(text, &end, 10);
+            if((end == text) || (first > last)) {
+
+                retval = -1;
+                return retval;
+            }
+        }
+
+        if(CPU_SETSIZE <= last) {
+
+            retval = -1;
+            return retval;
+        }
+
+        for(cpu = first;cpu <= last;++cpu) {
+
+            CPU_SET((int)(cpu), cpus);
+        }
+
+        if(',' == *end) {
+
+            ++end;
+        }
+        else if('\0' != *end) {
+
+            retval = -1;
+            return retval;
+        }
+        text = end;
+    }
+
+    if(0 == CPU_COUNT(cpus)) {
+
+        retval = -1;
+    }
+
+    return retval;
+}
+
+static int setThreadScheduling(const SchedEntry_T *entry, const char *name) {
+
+    int retval = 0;
+    int errorCode;
+    struct sched_param param = {0};
+
+    if(entry->policySet) {
+
+        param.sched_priority = ((SCHED_FIFO == entry->policy) || (SCHED_RR == entry->policy)) ? entry->priority : 0;
+        errorCode = pthread_setschedparam(pthread_self(), entry->policy, &param);
+        if(0 != errorCode) {
+
+            LOG_MSG_WRN(LOG_MOD_GENERAL, STR_LOG_MSG_FUNC78_POLICY_FAIL, name, strerror(errorCode));
+            retval = -1;
+        }
+        else if(((SCHED_OTHER == entry->policy) || (SCHED_BATCH == entry->policy)) &&
+                setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), entry->priority)) {
+
+            /* The nice value is per thread on Linux */
+            LOG_MSG_WRN(LOG_MOD_GENERAL, STR_LOG_MSG_FUNC78_NICE_FAIL, name, strerror(errno));
+            retval = -1;
+        }
+    }
+
+    if(entry->cpusSet) {
+
+        errorCode = pthread_setaffinity_np(pthread_self(), sizeof(entry->cpus), &entry->cpus);
+        if(0 != errorCode) {
+
+            LOG_MSG_WRN(LOG_MOD_GENERAL, STR_LOG_MSG_FUNC78_AFFINITY_FAIL, name, strerror(errorCode));
+            retval = -1;
+        }
+    }
+
+    if(0 == retval) {
+
+        LOG_MSG_DBG(LOG_MOD_GENERAL, STR_LOG_MSG_FUNC78_APPLIED, name, (int)syscall(SYS_gettid));
+    }
+
+    return retval;
+}
+
+static GstBusSyncReply schedSyncHandler(GstBus *bus, GstMessage *message, gpointer data) {
+
+    guint stage = 0U;
+    GstStreamStatusType type;
+    GstElement *owner = NULL;
+    GstObject *object = NULL;
+    SchedEntry_T restore;
+
+    if(GST_MESSAGE_STREAM_STATUS != GST_MESSAGE_TYPE(message)) {
+
+        return GST_BUS_PASS;
+    }
+
+    gst_message_parse_stream_status(message, &type, &owner);
+    if((GST_STREAM_STATUS_TYPE_ENTER != type) && (GST_STREAM_STATUS_TYPE_LEAVE != type)) {
+
+        return GST_BUS_PASS;
+    }
+
+    /* The nearest tagged stage (elements of a source bin take the bin's stage) */
+    for(object = GST_OBJECT(owner);(NULL != object) && (0U == stage);object = GST_OBJECT_PARENT(object)) {
+
+        stage = GPOINTER_TO_UINT(g_object_get_data(G_OBJECT(object), STR_SCHED_DATA_STAGE));
+    }
+
+    if((0U == stage) || (!schedEntries[stage - 1U].policySet && !schedEntries[stage - 1U].cpusSet)) {
+
+        return GST_BUS_PASS;
+    }
+
+    if(GST_STREAM_STATUS_TYPE_ENTER == type) {
+
+        setThreadScheduling(&schedEntries[stage - 1U], schedClassNames[stage - 1U]);
+    }
+    else {
+
+        /* Task pool threads are reused by other tasks */
+        memset(&restore, 0, sizeof(restore));
+        restore.policySet = schedEntries[stage - 1U].policySet;
+        restore.policy = SCHED_OTHER;
+        restore.cpusSet = schedEntries[stage - 1U].cpusSet && (0 < CPU_COUNT(&defaultCpus));
+        restore.cpus = defaultCpus;
+        setThreadScheduling(&restore, schedClassNames[stage - 1U]);
+    }
+
+    return GST_BUS_PASS;
+}
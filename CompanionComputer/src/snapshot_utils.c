@@ -0,0 +1,429 @@
+/**
+ * @file        snapshot_utils.c
+ * @author      Adam Csizy
+ * @date        2021-05-27
+ * @version     v1.1.0
+ *
+ * @brief       Still snapshot utilities
+ */
+
+
+#include <errno.h>
+#include <gst/gst.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "com_utils.h"
+#include "log_utils.h"
+#include "snapshot_utils.h"
+
+
+/* Snapshot related macro definitions */
+
+#define STR_PIPE_ELEM_NAME_SNAPVALVE    "Snapshot_Valve"    /**< Name of the valve gating the snapshot frame */
+#define STR_PIPE_ELEM_NAME_SNAPQUEUE    "Snapshot_Queue"    /**< Name of the queue decoupling the snapshot branch from the capture thread */
+#define STR_PIPE_ELEM_NAME_SNAPCONV     "Snapshot_Converter" /**< Name of the snapshot video converter (RAW only) */
+#define STR_PIPE_ELEM_NAME_SNAPENC      "Snapshot_Encoder"  /**< Name of the snapshot JPEG encoder (RAW only) */
+#define STR_PIPE_ELEM_NAME_SNAPSINK     "Snapshot_Sink"     /**< Name of the snapshot sink */
+#define STR_SNAPSHOT_FILE_FORMAT        "%s/snapshot_%u.jpg" /**< Path of an on board snapshot file */
+#define NUM_SNAPSHOT_JPEG_QUALITY       95      /**< JPEG quality of encoded RAW snapshots */
+#define NUM_NSEC_PER_MSEC               1000000ULL /**< Nanoseconds in a millisecond */
+
+
+/* Snapshot related static type declarations */
+
+/**
+ * @brief   Enumeration of snapshot states.
+ */
+typedef enum SnapshotState {
+
+    SNAPSHOT_STATE_IDLE         = 0,    /**< No snapshot in progress */
+    SNAPSHOT_STATE_CAPTURING    = 1,    /**< Valve open, waiting for the frame */
+    SNAPSHOT_STATE_SENDING      = 2     /**< Image captured, chunks waiting to be sent */
+
+} SnapshotState_T;
+
+
+/* Snapshot related static variable declarations */
+
+static SnapshotState_T snapshotState = SNAPSHOT_STATE_IDLE;    /**< State of the current snapshot */
+static uint32_t snapshotId = 0U;            /**< ID of the current (or last) snapshot */
+static uint64_t captureStartNs = 0U;        /**< Monotonic time of opening the valve */
+static uint8_t *imageData = NULL;           /**< JPEG image of the current snapshot */
+static uint32_t imageSize = 0U;             /**< Size of the JPEG image */
+static uint32_t imageOffset = 0U;           /**< Offset of the next chunk to be sent */
+static pthread_mutex_t snapshotLock = PTHREAD_MUTEX_INITIALIZER;   /**< Lock of the snapshot state */
+
+
+/* Snapshot related static function declarations */
+
+/**
+ * @brief       Get monotonic time.
+ *
+ * @return      CLOCK_MONOTONIC time in nanoseconds.
+ */
+static uint64_t getMonotonicNs(void);
+
+/**
+ * @brief       Pad probe closing the snapshot valve.
+ *
+ * @details     Runs on the valve's source pad for the one buffer
+ *              let through: the valve drops the next one.
+ *
+ * @param[in]   pad Source pad of the valve.
+ * @param[in]   info Probe info.
+ * @param[in]   data Valve element.
+ *
+ * @return      GST_PAD_PROBE_OK
+ */
+static GstPadProbeReturn snapshotValveProbe(GstPad *pad, GstPadProbeInfo *info, gpointer data);
+
+/**
+ * @brief       Handoff callback of the snapshot sink.
+ *
+ * @details     Copies the JPEG image, saves it on board (if
+ *              enabled) and reports it to the ground control.
+ *              Runs on the snapshot branch's thread.
+ *
+ * @param[in]   sink Snapshot sink.
+ * @param[in]   buffer JPEG image.
+ * @param[in]   pad Sink pad.
+ * @param[in]   data User data (not used).
+ */
+static void snapshotHandoffCallback(GstElement *sink, GstBuffer *buffer, GstPad *pad, gpointer data);
+
+/**
+ * @brief       Save snapshot on board.
+ *
+ * @param[in]   id Snapshot ID.
+ * @param[in]   image JPEG image.
+ * @param[in]   size Size of the image.
+ */
+static void saveSnapshot(const uint32_t id, const uint8_t *image, const uint32_t size);
+
+/**
+ * @brief       Report snapshot result to the ground control.
+ *
+ * @param[in]   id Snapshot ID.
+ * @param[in]   size Size of the image (0 on failure).
+ * @param[in]   status 0 on success, -1 on failure.
+ */
+static void announceSnapshot(const uint32_t id, const uint32_t size, const int32_t status);
+
+
+/* Snapshot related function definitions */
+
+int isSnapshotSupported(const VideoCodingFormat_T codingFormat) {
+
+    return (CAM_FMT_RAW == codingFormat) || (CAM_FMT_JPEG == codingFormat);
+}
+
+int attachSnapshotBranch(GstElement *pipeline, GstElement *tee, const VideoCodingFormat_T codingFormat) {
+
+    int retval = 0;
+    GstPad *valvePad = NULL;
+    GstElement *valve = NULL;
+    GstElement *queue = NULL;
+    GstElement *converter = NULL;
+    GstElement *encoder = NULL;
+    GstElement *sink = NULL;
+
+    if((NULL == pipeline) || (NULL == tee) || !isSnapshotSupported(codingFormat)) {
+
+        createLogMessage(STR_LOG_MSG_FUNC85_ARG_INVAL, LOG_SVRTY_ERR);
+        retval = -1;
+        return retval;
+    }
+
+    valve = gst_element_factory_make("valve", STR_PIPE_ELEM_NAME_SNAPVALVE);
+    queue = gst_element_factory_make("queue", STR_PIPE_ELEM_NAME_SNAPQUEUE);
+    sink = gst_element_factory_make("fakesink", STR_PIPE_ELEM_NAME_SNAPSINK);
+    if(CAM_FMT_RAW == codingFormat) {
+
+        converter = gst_element_factory_make("videoconvert", STR_PIPE_ELEM_NAME_SNAPCONV);
+        encoder = gst_element_factory_make("jpegenc", STR_PIPE_ELEM_NAME_SNAPENC);
+    }
+
+    if(!valve || !queue || !sink || ((CAM_FMT_RAW == codingFormat) && (!converter || !encoder))) {
+
+        createLogMessage(STR_LOG_MSG_FUNC85_CREAT_ELEM_FAIL, LOG_SVRTY_WRN);
+
+        /* Elements are not in the bin yet: release them one by one */
+        g_clear_object(&valve);
+        g_clear_object(&queue);
+        g_clear_object(&converter);
+        g_clear_object(&encoder);
+        g_clear_object(&sink);
+        retval = -1;
+        return retval;
+    }
+
+    /* Closed until a snapshot is requested: dropping costs the capture thread a buffer unref */
+    g_object_set(valve, "drop", TRUE, NULL);
+
+    /* The capture thread never waits for the encoder: a busy branch loses the older frame */
+    g_object_set(queue, "leaky", 2, "max-size-buffers", 1U, "max-size-bytes", 0U, "max-size-time", (guint64)0, NULL);
+    g_object_set(sink, "sync", FALSE, "async", FALSE, "signal-handoffs", TRUE, "enable-last-sample", FALSE, NULL);
+    if(NULL != encoder) {
+
+        g_object_set(encoder, "quality", NUM_SNAPSHOT_JPEG_QUALITY, NULL);
+    }
+    g_signal_connect(sink, "handoff", G_CALLBACK(snapshotHandoffCallback), NULL);
+
+    if(CAM_FMT_RAW == codingFormat) {
+
+        gst_bin_add_many(GST_BIN(pipeline), valve, queue, converter, encoder, sink, NULL);
+        retval = (TRUE == gst_element_link_many(tee, valve, queue, converter, encoder, sink, NULL)) ? 0 : -1;
+    }
+    else {
+
+        gst_bin_add_many(GST_BIN(pipeline), valve, queue, sink, NULL);
+        retval = (TRUE == gst_element_link_many(tee, valve, queue, sink, NULL)) ? 0 : -1;
+    }
+
+    if(retval) {
+
+        createLogMessage(STR_LOG_MSG_FUNC85_LINK_FAIL, LOG_SVRTY_WRN);
+
+        /* Elements are in the bin: removing them releases them */
+        gst_element_unlink(tee, valve);
+        gst_bin_remove_many(GST_BIN(pipeline), valve, queue, sink, NULL);
+        if(CAM_FMT_RAW == codingFormat) {
+
+            gst_bin_remove_many(GST_BIN(pipeline), converter, encoder, NULL);
+        }
+        return retval;
+    }
+
+    valvePad = gst_element_get_static_pad(valve, "src");
+    gst_pad_add_probe(valvePad, GST_PAD_PROBE_TYPE_BUFFER, snapshotValveProbe, valve, NULL);
+    gst_object_unref(valvePad);
+
+    return retval;
+}
+
+int requestSnapshot(GstElement *pipeline) {
+
+    int retval = 0;
+    uint32_t id;
+    GstState state = GST_STATE_NULL;
+    GstElement *valve = NULL;
+
+    pthread_mutex_lock(&snapshotLock);
+
+    /* The frame never came (e.g. the pipeline was rebuilt meanwhile) */
+    if((SNAPSHOT_STATE_CAPTURING == snapshotState) &&
+       ((getMonotonicNs() - captureStartNs) > (NUM_SNAPSHOT_CAPTURE_TIMEOUT_MS * NUM_NSEC_PER_MSEC))) {
+
+        snapshotState = SNAPSHOT_STATE_IDLE;
+    }
+
+    id = ++snapshotId;
+    if(SNAPSHOT_STATE_IDLE != snapshotState) {
+
+        pthread_mutex_unlock(&snapshotLock);
+        LOG_MSG_WRN(LOG_MOD_STREAM, STR_LOG_MSG_FUNC86_BUSY, id);
+        announceSnapshot(id, 0U, -1);
+        retval = -1;
+        return retval;
+    }
+
+    if(NULL != pipeline) {
+
+        gst_element_get_state(pipeline, &state, NULL, 0);
+        valve = gst_bin_get_by_name(GST_BIN(pipeline), STR_PIPE_ELEM_NAME_SNAPVALVE);
+    }
+
+    if((GST_STATE_PLAYING != state) || (NULL == valve)) {
+
+        pthread_mutex_unlock(&snapshotLock);
+        LOG_MSG_WRN(LOG_MOD_STREAM, STR_LOG_MSG_FUNC86_UNAVAILABLE, id, (NULL == valve) ? "no snapshot branch" : "stream not playing");
+        if(NULL != valve) {
+
+            gst_object_unref(valve);
+        }
+        announceSnapshot(id, 0U, -1);
+        retval = -1;
+        return retval;
+    }
+
+    snapshotState = SNAPSHOT_STATE_CAPTURING;
+    captureStartNs = getMonotonicNs();
+    pthread_mutex_unlock(&snapshotLock);
+
+    /* Closed again by snapshotValveProbe() after one frame */
+    g_object_set(valve, "drop", FALSE, NULL);
+    gst_object_unref(valve);
+    LOG_MSG_INF(LOG_MOD_STREAM, STR_LOG_MSG_FUNC86_REQUESTED, id);
+
+    return retval;
+}
+
+int isSnapshotPending(void) {
+
+    int pending;
+
+    pthread_mutex_lock(&snapshotLock);
+    pending = (SNAPSHOT_STATE_SENDING == snapshotState);
+    pthread_mutex_unlock(&snapshotLock);
+
+    return pending;
+}
+
+int takeSnapshotChunk(uint32_t *id, uint32_t *offset, uint8_t data[NUM_SNAPSHOT_CHUNK_SIZE], uint32_t *length) {
+
+    int retval = 1;
+    uint32_t remaining;
+
+    if((NULL == id) || (NULL == offset) || (NULL == data) || (NULL == length)) {
+
+        return retval;
+    }
+
+    pthread_mutex_lock(&snapshotLock);
+    if(SNAPSHOT_STATE_SENDING == snapshotState) {
+
+        remaining = imageSize - imageOffset;
+        *id = snapshotId;
+        *offset = imageOffset;
+        *length = (NUM_SNAPSHOT_CHUNK_SIZE < remaining) ? NUM_SNAPSHOT_CHUNK_SIZE : remaining;
+        memcpy(data, &imageData[imageOffset], *length);
+        imageOffset += *length;
+
+        if(imageOffset == imageSize) {
+
+            free(imageData);
+            imageData = NULL;
+            snapshotState = SNAPSHOT_STATE_IDLE;
+        }
+        retval = 0;
+    }
+    pthread_mutex_unlock(&snapshotLock);
+
+    return retval;
+}
+
+static uint64_t getMonotonicNs(void) {
+
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return ((uint64_t)(now.tv_sec) * 1000ULL * NUM_NSEC_PER_MSEC) + (uint64_t)(now.tv_nsec);
+}
+
+static GstPadProbeReturn snapshotValveProbe(GstPad *pad, GstPadProbeInfo *info, gpointer data) {
+
+    /* The valve checks the flag per buffer on this thread: the next one is dropped */
+    g_object_set(GST_ELEMENT(data), "drop", TRUE, NULL);
+
+    return GST_PAD_PROBE_OK;
+}
+
+static void snapshotHandoffCallback(GstElement *sink, GstBuffer *buffer, GstPad *pad, gpointer data) {
+
+    uint32_t id;
+    uint8_t *image = NULL;
+    GstMapInfo map;
+
+    if(!gst_buffer_map(buffer, &map, GST_MAP_READ)) {
+
+        createLogMessage(STR_LOG_MSG_FUNC87_MAP_FAIL, LOG_SVRTY_ERR);
+        return;
+    }
+
+    image = (0U < map.size) ? (uint8_t*)malloc(map.size) : NULL;
+    if(NULL != image) {
+
+        memcpy(image, map.data, map.size);
+    }
+    gst_buffer_unmap(buffer, &map);
+
+    /* Saved before the sender may take (and release) it */
+    if((NULL != image) && (UINT32_MAX >= map.size)) {
+
+        pthread_mutex_lock(&snapshotLock);
+        id = snapshotId;
+        pthread_mutex_unlock(&snapshotLock);
+        saveSnapshot(id, image, (uint32_t)(map.size));
+    }
+
+    pthread_mutex_lock(&snapshotLock);
+    id = snapshotId;
+    if((SNAPSHOT_STATE_CAPTURING != snapshotState) || (NULL == image) || (UINT32_MAX < map.size)) {
+
+        /* Abandoned capture or no memory: a failed capture is reported */
+        if(SNAPSHOT_STATE_CAPTURING == snapshotState) {
+
+            snapshotState = SNAPSHOT_STATE_IDLE;
+            pthread_mutex_unlock(&snapshotLock);
+            createLogMessage(STR_LOG_MSG_FUNC87_ALLOC_FAIL, LOG_SVRTY_ERR);
+            announceSnapshot(id, 0U, -1);
+        }
+        else {
+
+            pthread_mutex_unlock(&snapshotLock);
+        }
+        free(image);
+        return;
+    }
+
+    imageData = image;
+    imageSize = (uint32_t)(map.size);
+    imageOffset = 0U;
+    snapshotState = SNAPSHOT_STATE_SENDING;
+    pthread_mutex_unlock(&snapshotLock);
+
+    LOG_MSG_INF(LOG_MOD_STREAM, STR_LOG_MSG_FUNC87_CAPTURED, id, (unsigned int)(map.size),
+        (unsigned int)((getMonotonicNs() - captureStartNs) / NUM_NSEC_PER_MSEC));
+    announceSnapshot(id, (uint32_t)(map.size), 0);
+}
+
+static void saveSnapshot(const uint32_t id, const uint8_t *image, const uint32_t size) {
+
+    char path[PATH_MAX];
+    const char *directory = NULL;
+    FILE *file = NULL;
+
+    directory = getenv(STR_SNAPSHOT_ENV_DIR);
+    if((NULL == directory) || ('\0' == directory[0])) {
+
+        return;
+    }
+
+    snprintf(path, sizeof(path), STR_SNAPSHOT_FILE_FORMAT, directory, id);
+    file = fopen(path, "wb");
+    if((NULL == file) || (size != fwrite(image, 1, size, file))) {
+
+        LOG_MSG_WRN(LOG_MOD_STREAM, STR_LOG_MSG_FUNC88_WRITE_FAIL, path, strerror(errno));
+    }
+    if((NULL != file) && fclose(file)) {
+
+        LOG_MSG_WRN(LOG_MOD_STREAM, STR_LOG_MSG_FUNC88_WRITE_FAIL, path, strerror(errno));
+    }
+}
+
+static void announceSnapshot(const uint32_t id, const uint32_t size, const int32_t status) {
+
+    ModuleMessage_T *message = NULL;
+
+    message = (ModuleMessage_T*)calloc(1, sizeof(ModuleMessage_T));
+    if(NULL == message) {
+
+        createLogMessage(STR_LOG_MSG_FUNC89_MSG_ALLOC_FAIL, LOG_SVRTY_ERR);
+        return;
+    }
+
+    message->address = MOD_NAME_GCCOMMON;
+    message->code = MOD_MSG_CODE_SNAPSHOT;
+    message->data.snapshot.id = id;
+    message->data.snapshot.size = size;
+    message->data.snapshot.status = status;
+
+    /* Also wakes the network output thread for the image chunks */
+    insertModuleMessage(&networkMsgq, message, MOD_MSGQ_BLOCK);
+}
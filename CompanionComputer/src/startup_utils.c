@@ -0,0 +1,307 @@
+/**
+ * @file        startup_utils.c
+ * @author      Adam Csizy
+ * @date        2021-05-20
+ * @version     v1.1.0
+ *
+ * @brief       Startup task graph and startup milestone utilities
+ */
+
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "log_utils.h"
+#include "startup_utils.h"
+
+
+/* Startup related macro definitions */
+
+#define NUM_NSEC_PER_SEC        1000000000ULL   /**< Nanoseconds per second */
+#define NUM_NSEC_PER_MSEC       1000000.0       /**< Nanoseconds per millisecond */
+
+
+/* Startup related static type declarations */
+
+/**
+ * @brief   Enumeration of startup task states.
+ */
+typedef enum StartupTaskState {
+
+    STARTUP_TASK_PENDING    = 0,    /**< Waiting for its dependencies */
+    STARTUP_TASK_RUNNING    = 1,    /**< Running on its own thread */
+    STARTUP_TASK_SUCCEEDED  = 2,    /**< Finished successfully */
+    STARTUP_TASK_FAILED     = 3,    /**< Finished with failure */
+    STARTUP_TASK_SKIPPED    = 4     /**< Not started (a dependency failed or was skipped) */
+
+} StartupTaskState_T;
+
+/**
+ * @brief   Struct of a startup task graph run.
+ */
+typedef struct StartupGraph StartupGraph_T;
+
+/**
+ * @brief   Struct of a startup task run.
+ */
+typedef struct StartupTaskRun {
+
+    StartupGraph_T *graph;          /**< Graph run of the task */
+    size_t index;                   /**< Index of the task */
+    pthread_t thread;               /**< Thread of the task */
+    StartupTaskState_T state;       /**< State of the task (guarded by the graph's lock) */
+    uint64_t startNs;               /**< Start time (CLOCK_MONOTONIC) */
+    uint64_t endNs;                 /**< End time (CLOCK_MONOTONIC) */
+
+} StartupTaskRun_T;
+
+struct StartupGraph {
+
+    const StartupTask_T *tasks;                     /**< Startup tasks */
+    StartupTaskRun_T runs[NUM_STARTUP_TASK_MAX];    /**< Task runs */
+    size_t running;                                 /**< Number of running tasks (guarded by the lock) */
+    pthread_mutex_t lock;                           /**< Lock of the task states */
+    pthread_cond_t finished;                        /**< Signaled when a task finishes */
+
+};
+
+
+/* Startup related static variable declarations */
+
+static _Atomic uint64_t startupClockNs = 0;     /**< Reference time of the startup milestones (CLOCK_MONOTONIC, 0 if unset) */
+static atomic_flag milestoneReached[STARTUP_MILESTONE_COUNT] = {ATOMIC_FLAG_INIT, ATOMIC_FLAG_INIT, ATOMIC_FLAG_INIT}; /**< Milestones already logged */
+static const char *const milestoneNames[STARTUP_MILESTONE_COUNT] = {"connected", "ready", "first_packet"}; /**< Names of the startup milestones */
+
+
+/* Startup related static function declarations */
+
+/**
+ * @brief       Get monotonic clock time in nanoseconds.
+ *
+ * @return      Monotonic clock time in nanoseconds.
+ */
+static uint64_t getMonotonicNs(void);
+
+/**
+ * @brief       Start routine of a startup task thread.
+ *
+ * @details     Runs the task function, records its result and
+ *              end time and wakes up the scheduler.
+ *
+ * @param[in,out]   arg Task run (StartupTaskRun_T).
+ *
+ * @return      Any (not used).
+ */
+static void* threadFuncStartupTask(void *arg);
+
+/**
+ * @brief       Schedule startup tasks.
+ *
+ * @details     Starts the pending tasks whose dependencies succeeded
+ *              and skips the ones with a failed or skipped dependency.
+ *              Called with the graph's lock held.
+ *
+ * @param[in,out]   graph Startup task graph run.
+ * @param[in]   count Number of startup tasks.
+ *
+ * @return      Number of tasks which changed state.
+ */
+static size_t scheduleStartupTasks(StartupGraph_T *graph, const size_t count);
+
+
+/* Startup related function definitions */
+
+void initStartupClock(void) {
+
+    uint64_t expected = 0;
+
+    atomic_compare_exchange_strong(&startupClockNs, &expected, getMonotonicNs());
+}
+
+void markStartupMilestone(const StartupMilestone_T milestone) {
+
+    uint64_t now = getMonotonicNs();
+    uint64_t expected = 0;
+
+    if((STARTUP_MILESTONE_COUNT > milestone) && !atomic_flag_test_and_set(&milestoneReached[milestone])) {
+
+        /* Without a startup clock the first milestone becomes the reference */
+        atomic_compare_exchange_strong(&startupClockNs, &expected, now);
+        expected = atomic_load(&startupClockNs);
+
+        LOG_MSG_INF(LOG_MOD_GENERAL, STR_LOG_MSG_FUNC63_MILESTONE, milestoneNames[milestone], (double)(now - expected) / NUM_NSEC_PER_MSEC);
+    }
+}
+
+int runStartupTasks(const StartupTask_T tasks[], const size_t count) {
+
+    int retval = 0;
+    size_t i;
+    uint32_t validDependencies;
+    uint64_t graphStartNs;
+    StartupGraph_T graph;
+
+    if((NULL == tasks) || (0 == count) || (NUM_STARTUP_TASK_MAX < count)) {
+
+        createLogMessage(STR_LOG_MSG_FUNC62_ARG_INVAL, LOG_SVRTY_ERR);
+        retval = -1;
+        return retval;
+    }
+
+    validDependencies = (NUM_STARTUP_TASK_MAX == count) ? UINT32_MAX : (STARTUP_TASK_BIT(count) - 1U);
+    for(i = 0;i < count;++i) {
+
+        if((NULL == tasks[i].function) || (0 != (tasks[i].dependencies & ~validDependencies))) {
+
+            createLogMessage(STR_LOG_MSG_FUNC62_ARG_INVAL, LOG_SVRTY_ERR);
+            retval = -1;
+            return retval;
+        }
+    }
+
+    memset(&graph, 0, sizeof(graph));
+    graph.tasks = tasks;
+    pthread_mutex_init(&graph.lock, NULL);
+    pthread_cond_init(&graph.finished, NULL);
+    for(i = 0;i < count;++i) {
+
+        graph.runs[i].graph = &graph;
+        graph.runs[i].index = i;
+        graph.runs[i].state = STARTUP_TASK_PENDING;
+    }
+
+    graphStartNs = getMonotonicNs();
+
+    /* Start tasks as their dependencies succeed until nothing is left to start or wait for */
+    pthread_mutex_lock(&graph.lock);
+    while((0 < scheduleStartupTasks(&graph, count)) || (0 < graph.running)) {
+
+        if(0 < graph.running) {
+
+            pthread_cond_wait(&graph.finished, &graph.lock);
+        }
+    }
+    pthread_mutex_unlock(&graph.lock);
+
+    /* Tasks left pending depend on each other */
+    for(i = 0;i < count;++i) {
+
+        if(STARTUP_TASK_PENDING == graph.runs[i].state) {
+
+            graph.runs[i].state = STARTUP_TASK_SKIPPED;
+        }
+
+        switch(graph.runs[i].state) {
+
+            case STARTUP_TASK_SUCCEEDED:
+
+                pthread_join(graph.runs[i].thread, NULL);
+                LOG_MSG_INF(LOG_MOD_GENERAL, STR_LOG_MSG_FUNC62_TASK_DONE, tasks[i].name,
+                    (double)(graph.runs[i].startNs - graphStartNs) / NUM_NSEC_PER_MSEC,
+                    (double)(graph.runs[i].endNs - graph.runs[i].startNs) / NUM_NSEC_PER_MSEC);
+                break;
+
+            case STARTUP_TASK_FAILED:
+
+                pthread_join(graph.runs[i].thread, NULL);
+                LOG_MSG_ERR(LOG_MOD_GENERAL, STR_LOG_MSG_FUNC62_TASK_FAIL, tasks[i].name,
+                    (double)(graph.runs[i].endNs - graph.runs[i].startNs) / NUM_NSEC_PER_MSEC);
+                retval = -1;
+                break;
+
+            default:
+
+                LOG_MSG_ERR(LOG_MOD_GENERAL, STR_LOG_MSG_FUNC62_TASK_SKIPPED, tasks[i].name);
+                retval = -1;
+                break;
+        }
+    }
+
+    pthread_cond_destroy(&graph.finished);
+    pthread_mutex_destroy(&graph.lock);
+
+    return retval;
+}
+
+static uint64_t getMonotonicNs(void) {
+
+    struct timespec now = {0};
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return ((uint64_t)(now.tv_sec) * NUM_NSEC_PER_SEC) + (uint64_t)(now.tv_nsec);
+}
+
+static void* threadFuncStartupTask(void *arg) {
+
+    int result;
+    StartupTaskRun_T *run = (StartupTaskRun_T*)arg;
+    StartupGraph_T *graph = run->graph;
+
+    result = graph->tasks[run->index].function(graph->tasks[run->index].argument);
+
+    pthread_mutex_lock(&graph->lock);
+    run->endNs = getMonotonicNs();
+    run->state = (0 == result) ? STARTUP_TASK_SUCCEEDED : STARTUP_TASK_FAILED;
+    --graph->running;
+    pthread_cond_signal(&graph->finished);
+    pthread_mutex_unlock(&graph->lock);
+
+    return NULL;
+}
+
+static size_t scheduleStartupTasks(StartupGraph_T *graph, const size_t count) {
+
+    size_t i, j;
+    size_t changed = 0;
+    uint32_t succeeded = 0, unsuccessful = 0;
+    StartupTaskRun_T *run = NULL;
+
+    for(j = 0;j < count;++j) {
+
+        if(STARTUP_TASK_SUCCEEDED == graph->runs[j].state) {
+
+            succeeded |= STARTUP_TASK_BIT(j);
+        }
+        else if((STARTUP_TASK_FAILED == graph->runs[j].state) || (STARTUP_TASK_SKIPPED == graph->runs[j].state)) {
+
+            unsuccessful |= STARTUP_TASK_BIT(j);
+        }
+    }
+
+    for(i = 0;i < count;++i) {
+
+        run = &graph->runs[i];
+        if(STARTUP_TASK_PENDING != run->state) {
+
+            continue;
+        }
+
+        if(0 != (graph->tasks[i].dependencies & unsuccessful)) {
+
+            /* Skipping may unblock the skipping of further tasks in the next round */
+            run->state = STARTUP_TASK_SKIPPED;
+            ++changed;
+        }
+        else if(graph->tasks[i].dependencies == (graph->tasks[i].dependencies & succeeded)) {
+
+            run->startNs = getMonotonicNs();
+            if(pthread_create(&run->thread, NULL, threadFuncStartupTask, run)) {
+
+                LOG_MSG_ERR(LOG_MOD_GENERAL, STR_LOG_MSG_FUNC62_THRD_START_FAIL, graph->tasks[i].name);
+                run->state = STARTUP_TASK_SKIPPED;
+            }
+            else {
+
+                run->state = STARTUP_TASK_RUNNING;
+                ++graph->running;
+            }
+            ++changed;
+        }
+    }
+
+    return changed;
+}
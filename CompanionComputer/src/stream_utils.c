@@ -9,26 +9,38 @@
 
 
 #include <gst/gst.h>
+#include <limits.h>
 #include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <syslog.h>
 
 #include "camera_utils.h"
 #include "com_utils.h"
 #include "log_utils.h"
+#include "recorder_utils.h"
+#include "startup_utils.h"
+#include "trace_utils.h"
+#include "netsink_utils.h"
+#include "watchdog_utils.h"
+#include "plugin_utils.h"
+#include "profiler_utils.h"
+#include "qos_utils.h"
+#include "sched_utils.h"
+#include "snapshot_utils.h"
+#include "frame_export_utils.h"
+#include "calibration_utils.h"
+#include "clock_utils.h"
 #include "stream_utils.h"
 
 
 /* Streaming related macro definitions */
 
 #define NUM_STREAM_MSGQ_SIZE        8U  /**< Size of streaming module's message queue */
-#define NUM_STREAM_STATE_NUM        2U  /**< Number of stream states */
-#define NUM_STREAM_EVENT_NUM        4U  /**< Number of stream events */
+#define NUM_STREAM_STATE_NUM        4U  /**< Number of stream states */
+#define NUM_STREAM_EVENT_NUM        5U  /**< Number of stream events */
 #define SM_UPDATE_REQUIRED          1U  /**< State machine update required */
 #define SM_UPDATE_NOT_REQUIRED      0U  /**< State machine update not required */
-#define NUM_CAM_DEV_PATH_SIZE       64U /**< Camera device path size */
 //#define STR_STREAM_DEST_ADDR        "195.441.0.134" /**< Default address of RTP stream destination (LAN) */
 #define STR_STREAM_DEST_ADDR        "any_custom_domain.ddns.net" /**< Default address of RTP stream destination (WAN) */
 //#define STR_STREAM_DEST_PORT        "5000" /**< Default service port of RTP stream destination (LAN) */
@@ -36,13 +48,21 @@
 //#define NUM_STREAM_DEST_PORT        5000 /**< Default service port of RTP stream destination (LAN) */
 #define NUM_STREAM_DEST_PORT        17000 /**< Default service port of RTP stream destination (WAN) */
 #define PIPE_INITIAL_STATE          GST_STATE_READY /**< Initial state of the video streaming pipeline */
-#define NUM_UDP_MTU                 64000 /**< MTU for UDP packets in bytes. Theoretical ceiling is 64kB but GStreamer payloaders might not support such a high value.  */
+#define NUM_UDP_MTU                 1400 /**< MTU for UDP packets in bytes. Keeps RTP packets below the path MTU (no IP fragmentation); the batched network sink sends a frame's packets in one or two system calls. */
 #define STR_PIPE_ELEM_NAME_VIDSRC   "Video_Source" /**< Name of the video source pipeline element */
 #define STR_PIPE_ELEM_NAME_VIDCONV  "Video_Converter" /**< Name of the video converter pipeline element */
 #define STR_PIPE_ELEM_NAME_CAPSFLTR "Video_Caps_Filter" /**< Name of the video capabilities-filter pipeline element */
 #define STR_PIPE_ELEM_NAME_ENCODER  "Video_Encoder" /**< Name of the video encoder pipeline element */
 #define STR_PIPE_ELEM_NAME_PAYLDR   "Payloader" /**< Name of the payloader pipeline element */
 #define STR_PIPE_ELEM_NAME_NETSINK  "Network_Sink" /**< Name of the network sink pipeline element */
+#define NUM_H264_ENCODER_NUM        3U  /**< Number of H.264 encoder candidates for RAW sources */
+#define NUM_RECOVERY_SAME_RETRIES   3U  /**< Recovery attempts with the failed coding format before falling back to other formats */
+#define NUM_RECOVERY_BACKOFF_MS     250U /**< Delay of the first recovery attempt in milliseconds (doubled per attempt) */
+#define NUM_RECOVERY_BACKOFF_MAX_MS 4000U /**< Maximum delay between recovery attempts in milliseconds (attempts never stop) */
+#define NUM_RECOVERY_BACKOFF_SHIFT  4U  /**< Doublings of the recovery delay before it reaches its maximum */
+#define NUM_STALL_TIMEOUT_MS        3000U /**< Default time without buffers after which a playing pipeline counts as stalled */
+#define STR_STALL_WATCH_CAPTURE     "capture" /**< Stall watch of the video source output */
+#define STR_STALL_WATCH_SINK        "sink" /**< Stall watch of the network sink input */
 
 /* Streaming related static type declarations */
 
@@ -56,7 +76,8 @@ typedef enum StreamEvent {
     STREAM_EVENT_STREAM_REQ     = 0,    /**< Ground control requested video stream (type) */
     STREAM_EVENT_STREAM_START   = 1,    /**< Ground control requested to start video stream */
     STREAM_EVENT_STREAM_STOP    = 2,    /**< Ground control requested to stop video stream */
-    STREAM_EVENT_PIPE_ERROR     = 3     /**< Error occured in streaming pipeline */
+    STREAM_EVENT_PIPE_ERROR     = 3,    /**< Error occured in streaming pipeline */
+    STREAM_EVENT_RECOVERY_RETRY = 4     /**< Recovery delay expired (see scheduleRecoveryAttempt()) */
 
 } StreamEvent_T;
 
@@ -67,6 +88,8 @@ typedef enum StreamState {
 
     STREAM_STATE_STANDBY        = 0,    /**< Pipeline in standby state */
     STREAM_STATE_PLAYING        = 1,    /**< Pipeline in playing state */
+    STREAM_STATE_RECOVER_STANDBY = 2,   /**< No pipeline, recovering it for standby */
+    STREAM_STATE_RECOVER_PLAYING = 3    /**< No pipeline, recovering it and resuming the stream (ground control still wants video) */
 
 } StreamState_T;
 
@@ -80,6 +103,45 @@ typedef struct StateContext {
 
 } StateContext_T;
 
+/**
+ * @brief   Enumeration of stream module startup tasks (see runStartupTasks()).
+ */
+typedef enum StreamStartupTask {
+
+    STREAM_STARTUP_GST_INIT     = 0,    /**< Initialize GStreamer and register the network sink */
+    STREAM_STARTUP_SOURCE       = 1,    /**< Select the video source (camera discovery) */
+    STREAM_STARTUP_MAIN_LOOP    = 2,    /**< Start the main loop thread */
+    STREAM_STARTUP_CAPS         = 3,    /**< Probe the video coding capabilities of the source */
+    STREAM_STARTUP_CALIBRATION  = 4,    /**< Rank the video coding formats (see initFormatRanking()) */
+    STREAM_STARTUP_PIPE_BUILD   = 5,    /**< Build the pipeline candidates and select one */
+    STREAM_STARTUP_TASK_NUM     = 6     /**< Number of stream module startup tasks */
+
+} StreamStartupTask_T;
+
+/**
+ * @brief   Struct of a speculatively built pipeline candidate.
+ */
+typedef struct PipelineCandidate {
+
+    pthread_t thread;                   /**< Builder thread */
+    int started;                        /**< Builder thread started (joined before selection) */
+    int result;                         /**< Result of pipeBuilder() */
+    VideoCodingFormat_T codingFormat;   /**< Video coding format of the candidate */
+    GstElement *pipeline;               /**< Candidate pipeline (NULL on failure) */
+
+} PipelineCandidate_T;
+
+/**
+ * @brief   Struct of a pipeline recovery (see streamErrorHandler()).
+ */
+typedef struct StreamRecovery {
+
+    unsigned int attempt;               /**< Recovery attempts made */
+    gint64 startUs;                     /**< Monotonic time of the pipeline error in microseconds */
+    VideoCodingFormat_T failedFormat;   /**< Video coding format of the failed pipeline */
+
+} StreamRecovery_T;
+
 
 /* Streaming related global variable declarations */
 
@@ -91,6 +153,16 @@ ModuleMessageQueue_T streamMsgq;
 static pthread_t threadStreamControl;   /**< Thread object for handling video stream state machine */
 static pthread_t threadStreamMainLoop;  /**< Thread object for handling main loop context of the video stream */
 static VideoCodingFormat_T currentCodingFormat = CAM_FMT_UNK;   /**< Current coding format used by the video streaming pipeline */
+static VideoSourceConfig_T sourceConfig;                        /**< Video source of the video streaming pipeline */
+static VideoCodingFormatCaps_T cameraCapabilities[NUM_SUP_VID_COD_FMT]; /**< Video coding capabilities of the video source */
+static const char *const h264EncoderNames[NUM_H264_ENCODER_NUM] = {"omxh264enc", "v4l2h264enc", "x264enc"};    /**< H.264 encoders in order of preference (hardware first) */
+static unsigned int h264EncoderFirst = 0;       /**< First H.264 encoder tried (raised by the recovery, see recoverPipeline()) */
+static unsigned int h264EncoderSelected = 0;    /**< H.264 encoder of the last RAW pipeline */
+static gint streamDestinationPort = NUM_STREAM_DEST_PORT;   /**< RTP stream target port of the last stream request (outlives pipeline rebuilds) */
+static StreamRecovery_T recovery;               /**< Current pipeline recovery (stream control thread only) */
+static GstElement *sparePipeline = NULL;        /**< Warm spare pipeline in its initial state without signal watch (NULL if none) */
+static VideoCodingFormat_T spareCodingFormat = CAM_FMT_UNK;     /**< Video coding format of the warm spare pipeline */
+static unsigned int stallTimeoutMs = NUM_STALL_TIMEOUT_MS;      /**< Pipeline stall threshold in milliseconds (0: watchdog disabled) */
 
 
 /* Streaming related static function declarations */
@@ -201,11 +273,16 @@ static void* streamStartHandler(ModuleMessage_T* *message, GstElement* *pipeline
  * 
  * @details     Event handler for stream error events. On errors
  *              coming from the GStreamer pipeline elements the
- *              video streaming is stopped and the pipeline is
- *              set back to NULL state resulting an internal
- *              state reset for each pipeline component. The given
- *              module message is forwarded to the ground control
- *              over the network module.
+ *              video streaming is stopped, the pipeline is
+ *              released and its recovery is scheduled (see
+ *              scheduleRecoveryAttempt()). The given module
+ *              message is forwarded to the ground control over
+ *              the network module.
+ * 
+ * @note        The pipeline is set to NULL: the stream controller
+ *              waits in a recovery state until a recovery attempt
+ *              succeeds (see streamRecoveryHandler() and
+ *              streamResumeHandler()).
  *              
  * @param[in,out]   message Module message.
  * @param[in,out]   pipeline GStreamer video streaming pipeline.
@@ -214,17 +291,52 @@ static void* streamStartHandler(ModuleMessage_T* *message, GstElement* *pipeline
  */
 static void* streamErrorHandler(ModuleMessage_T* *message, GstElement* *pipeline);
 
+/**
+ * @brief       Stream recovery event handler.
+ *
+ * @details     Event handler for recovery retry events in standby.
+ *              Makes a recovery attempt (see recoverPipeline()) and
+ *              schedules the next one on failure. A recovered
+ *              pipeline waits in its initial state for the next
+ *              stream request.
+ *
+ * @param[in,out]   message Module message.
+ * @param[in,out]   pipeline GStreamer video streaming pipeline.
+ *
+ * @return      Any (not used).
+ */
+static void* streamRecoveryHandler(ModuleMessage_T* *message, GstElement* *pipeline);
+
+/**
+ * @brief       Stream resume event handler.
+ *
+ * @details     Event handler for recovery retry events while the
+ *              ground control still wants video (no stream stop
+ *              since the error). Makes a recovery attempt, sets the
+ *              recovered pipeline to playing state and tells the
+ *              ground control to resume its display in the
+ *              recovered video coding format.
+ *
+ * @param[in,out]   message Module message.
+ * @param[in,out]   pipeline GStreamer video streaming pipeline.
+ *
+ * @return      Any (not used).
+ */
+static void* streamResumeHandler(ModuleMessage_T* *message, GstElement* *pipeline);
+
 /**
  * @brief       Initializes camera capabilities.
  * 
  * @details     Initializes camera capabilities array in the
  *              given initialization context with capabilities
- *              of the camera device under path 'camDevPath'.
+ *              of the given video source. Camera devices are
+ *              queried through a v4l2src pipeline, virtual
+ *              sources advertise their configured capabilities.
  * 
  * @note        GStreamer core and plugins must be initialized
  *              using 'gst_init()' before invoking this function.
  * 
- * @param[in]   camDevPath Path to camera device.
+ * @param[in]   source Video source configuration.
  * @param[in]   initCtx Capabilities's initialization context.
  * 
  * @return      Result of execution.
@@ -232,7 +344,18 @@ static void* streamErrorHandler(ModuleMessage_T* *message, GstElement* *pipeline
  * @retval      0 Success
  * @retval      -1 Failure
  */
-static int initCameraCapabilities(const char *camDevPath, VideoCodingFormatContext_T *initCtx);
+static int initCameraCapabilities(const VideoSourceConfig_T *source, VideoCodingFormatContext_T *initCtx);
+
+/**
+ * @brief       Creates an H.264 encoder.
+ *
+ * @details     Creates the first available encoder of
+ *              h264EncoderNames for RAW video sources. The
+ *              software encoder is configured for low latency.
+ *
+ * @return      Floating reference to the encoder or NULL.
+ */
+static GstElement* createH264Encoder(void);
 
 /**
  * @brief       Build media pipeline.
@@ -244,21 +367,25 @@ static int initCameraCapabilities(const char *camDevPath, VideoCodingFormatConte
  *              each supported video coding format and is used to
  *              enhance the video stream quality. The video stream
  *              is forwarded over UDP/RTP to the ground control.
+ *              A calibration pipeline ends in a null sink instead and
+ *              gets none of the optional taps (snapshots, frame
+ *              export, clock mapping, scheduling, meter, profiler).
  * 
  * @note        GStreamer core and plugins must be initialized
  *              using 'gst_init()' before invoking this function.
  *
  * @param[in,out]   pipeline Pointer to a pipeline to be built.
- * @param[in]   camDevPath Path to camera device.
+ * @param[in]   source Video source configuration.
  * @param[in]   codingFormat Video encoding format.
  * @param[in]   caps Video coding capabilities.
+ * @param[in]   calibration Build a calibration pipeline (see buildCalibrationPipeline()).
  * 
  * @return      Result of execution.
  * 
  * @retval      0 Success
  * @retval      -1 Failure
  */
-static int pipeBuilder(GstElement* *pipeline, const char *camDevPath, const VideoCodingFormat_T codingFormat, const VideoCodingFormatCaps_T caps[NUM_SUP_VID_COD_FMT]);
+static int pipeBuilder(GstElement* *pipeline, const VideoSourceConfig_T *source, const VideoCodingFormat_T codingFormat, const VideoCodingFormatCaps_T caps[NUM_SUP_VID_COD_FMT], const int calibration);
 
 /**
  * @brief       Pipeline error signal callback.
@@ -329,19 +456,307 @@ static void pipelineStatechangedCallback(GstBus *bus, GstMessage *message, gpoin
  */
 static int registerCallbackFunctions(GstElement *pipeline);
 
+/**
+ * @brief       Release video streaming pipeline.
+ * 
+ * @details     Sets the pipeline to NULL state, removes the
+ *              signal watch of its bus (see registerCallbackFunctions())
+ *              and drops the pipeline with its elements.
+ * 
+ * @param[in,out]   pipeline GStreamer pipeline (set to NULL).
+ */
+static void releasePipeline(GstElement* *pipeline);
+
+/**
+ * @brief       Startup task initializing GStreamer.
+ *
+ * @details     Initializes GStreamer and registers the batched
+ *              network sink (a failed registration is not fatal:
+ *              pipeBuilder() falls back to the stock udpsink).
+ *
+ * @param[in]   arg Task argument (not used).
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+static int initGstreamerTask(void *arg);
+
+/**
+ * @brief       Startup task selecting the video source.
+ *
+ * @details     Detects a compatible camera device unless a video
+ *              source is configured (see getVideoSourceConfig()).
+ *              Needs no GStreamer, runs alongside its initialization.
+ *
+ * @param[in]   arg Task argument (not used).
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+static int selectVideoSourceTask(void *arg);
+
+/**
+ * @brief       Startup task starting the main loop thread.
+ *
+ * @param[in]   arg Task argument (not used).
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+static int startMainLoopTask(void *arg);
+
+/**
+ * @brief       Startup task probing the video source capabilities.
+ *
+ * @param[in,out]   arg Capabilities's initialization context (VideoCodingFormatContext_T).
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+static int probeCapabilitiesTask(void *arg);
+
+/**
+ * @brief       Startup task ranking the video coding formats.
+ *
+ * @details     Ranks the formats on the actual hardware if
+ *              CC_FORMAT_OBJECTIVE is set (see initFormatRanking())
+ *              and starts the H.264 encoder search of RAW sources
+ *              at the best encoder. Not fatal: the formats keep the
+ *              VideoCodingFormat_T order on failure.
+ *
+ * @param[in]   arg Launch argument (not used).
+ *
+ * @return      0
+ */
+static int calibrateFormatsTask(void *arg);
+
+/**
+ * @brief       Build calibration pipeline (CalibrationBuildFunc_T).
+ *
+ * @details     Builds the calibration variant of a format's streaming
+ *              pipeline (see pipeBuilder()) with the given H.264
+ *              encoder (RAW only).
+ *
+ * @param[out]  pipeline Calibration pipeline.
+ * @param[out]  capsfilter Capture caps filter of the pipeline.
+ * @param[out]  payloader Payloader of the pipeline.
+ * @param[in]   codingFormat Video coding format.
+ * @param[in]   encoder Index of h264EncoderNames (RAW only, -1 otherwise).
+ * @param[in]   data User data (not used).
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+static int buildCalibrationPipeline(GstElement* *pipeline, GstElement* *capsfilter, GstElement* *payloader,
+                                    const VideoCodingFormat_T codingFormat, const int encoder, void *data);
+
+/**
+ * @brief       Startup task building the streaming pipeline.
+ *
+ * @details     Builds the pipeline candidates (see
+ *              buildPipelineCandidates()), registers the callback
+ *              functions of the selected one and marks its first
+ *              RTP packet as a startup milestone.
+ *
+ * @param[out]  arg Pointer to the pipeline to be built (GstElement**).
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+static int buildPipelineTask(void *arg);
+
+/**
+ * @brief       Build pipeline candidates.
+ *
+ * @details     Builds a pipeline for every supported video coding
+ *              format concurrently instead of trying the formats one
+ *              after the other, so the fallback formats cost no extra
+ *              startup time when the preferred format fails. The
+ *              first candidate in the order of preference which was
+ *              built is selected, the others are released.
+ *
+ * @param[out]  pipeline Selected pipeline.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure (no candidate could be built)
+ */
+static int buildPipelineCandidates(GstElement* *pipeline);
+
+/**
+ * @brief       Start routine of a pipeline candidate builder thread.
+ *
+ * @param[in,out]   arg Pipeline candidate (PipelineCandidate_T).
+ *
+ * @return      Any (not used).
+ */
+static void* threadFuncPipelineCandidate(void *arg);
+
+/**
+ * @brief       First packet pad probe.
+ *
+ * @details     Marks STARTUP_MILESTONE_FIRST_PACKET when the first
+ *              RTP packet reaches the network sink and removes itself.
+ *
+ * @param[in]   pad Sink pad of the network sink.
+ * @param[in]   info Probe information.
+ * @param[in]   data Custom data (not used).
+ *
+ * @return      GST_PAD_PROBE_REMOVE.
+ */
+static GstPadProbeReturn firstPacketProbe(GstPad *pad, GstPadProbeInfo *info, gpointer data);
+
+/**
+ * @brief       Schedule pipeline recovery attempt.
+ *
+ * @details     Inserts a recovery retry message into the streaming
+ *              module's message queue after an exponential backoff
+ *              delay (NUM_RECOVERY_BACKOFF_MS doubled per attempt up
+ *              to NUM_RECOVERY_BACKOFF_MAX_MS). The delay expires on
+ *              a detached timer thread, the stream controller keeps
+ *              handling stream requests meanwhile.
+ */
+static void scheduleRecoveryAttempt(void);
+
+/**
+ * @brief       Start routine of a recovery timer thread.
+ *
+ * @param[in]   arg Delay in milliseconds (GUINT_TO_POINTER()).
+ *
+ * @return      Any (not used).
+ */
+static void* threadFuncRecoveryTimer(void *arg);
+
+/**
+ * @brief       Select video coding format of a recovery attempt.
+ *
+ * @details     The first NUM_RECOVERY_SAME_RETRIES attempts retry
+ *              the failed format. Later attempts cycle through the
+ *              supported formats in the order of preference, starting
+ *              after the failed one and ending with it.
+ *
+ * @param[in]   attempt Recovery attempt (0 for the first one).
+ *
+ * @return      Video coding format.
+ */
+static VideoCodingFormat_T selectRecoveryFormat(const unsigned int attempt);
+
+/**
+ * @brief       Recover video streaming pipeline.
+ *
+ * @details     Makes one recovery attempt: past the retries of the
+ *              failed format the warm spare pipeline is swapped in
+ *              without a build, otherwise a pipeline is built with
+ *              the format of selectRecoveryFormat(). A failed RAW
+ *              pipeline comes back in a lower mode: with the next
+ *              H.264 encoder of h264EncoderNames (hardware encoders
+ *              fall back to the software one for good). The callback
+ *              functions and the stream target port are set on the
+ *              recovered pipeline and the recovery time is logged.
+ *
+ * @param[out]  pipeline Recovered pipeline (NULL on failure).
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+static int recoverPipeline(GstElement* *pipeline);
+
+/**
+ * @brief       Build warm spare pipeline.
+ *
+ * @details     Builds the most preferred supported video coding
+ *              format other than the current one into its initial
+ *              state, unless there is a spare already or the source
+ *              supports one format only. The spare takes over at once
+ *              when the retries of a failed format run out.
+ */
+static void buildSparePipeline(void);
+
+/**
+ * @brief       Release a pipeline without signal watch.
+ *
+ * @details     Sets the pipeline to NULL state and drops it. For
+ *              the pipeline candidates and the warm spare, which get
+ *              their signal watch when selected (see
+ *              releasePipeline()).
+ *
+ * @param[in,out]   pipeline GStreamer pipeline (set to NULL).
+ */
+static void releaseUnwatchedPipeline(GstElement* *pipeline);
+
+/**
+ * @brief       Attach stall watches.
+ *
+ * @details     Replaces the stall watches with the ones of the
+ *              selected pipeline: the video source output (a camera
+ *              or driver which stops producing frames without an
+ *              error) and the network sink input (a stuck converter,
+ *              encoder or payloader). Failures are logged, the
+ *              pipeline streams unwatched.
+ *
+ * @param[in]   pipeline Selected video streaming pipeline.
+ */
+static void attachStallWatches(GstElement *pipeline);
+
+/**
+ * @brief       Pipeline stall callback.
+ *
+ * @details     Called on the main loop thread by the stall watchdog.
+ *              Records the stall and feeds it into the stream state
+ *              machine like a pipeline error, which starts the
+ *              pipeline recovery (see streamErrorHandler()).
+ *
+ * @param[in]   watchName Name of the stalled watch.
+ * @param[in]   stalledMs Time since the watch's last buffer in milliseconds.
+ * @param[in]   data Not used.
+ */
+static void pipelineStallCallback(const char *watchName, const unsigned int stalledMs, void *data);
+
 
 /* Streaming related function definitions */
 
 int initStreamModule(void) {
 
     int retval = 0;
+    char *end = NULL;
+    const char *stallTimeout = NULL;
+    unsigned long timeoutMs;
 
-    if(FALSE == gst_init_check(NULL, NULL, NULL)) {
+    /*
+     * Optional, configures the GStreamer tracers before 'gst_init()' (failures are logged).
+     * Runs before the startup tasks: it modifies the environment, and so does
+     * the plugin registry configuration (pinned plugins or static build).
+     */
+    initPipelineProfiler(getenv(STR_PROFILE_ENV_DIR));
+    initPluginRegistry(getenv(STR_PLUGIN_ENV_DIR));
 
-        createLogMessage(STR_LOG_MSG_FUNC20_GST_INIT_FAIL, LOG_SVRTY_ERR);
+    stallTimeout = getenv(STR_STREAM_ENV_STALL_TIMEOUT);
+    if(NULL != stallTimeout) {
 
-        retval = -1;
-        return retval;
+        timeoutMs = strtoul(stallTimeout, &end, 10);
+        if((end == stallTimeout) || ('\0' != *end) || (UINT_MAX < timeoutMs)) {
+
+            LOG_MSG_WRN(LOG_MOD_STREAM, STR_LOG_MSG_FUNC20_STALL_TIMEOUT_INVAL, stallTimeout, stallTimeoutMs);
+        }
+        else {
+
+            stallTimeoutMs = (unsigned int)(timeoutMs);
+        }
     }
 
     if(initModuleMessageQueue(&streamMsgq, NUM_STREAM_MSGQ_SIZE)) {
@@ -371,78 +786,52 @@ static void* threadFuncStreamControl(void *arg) {
     int updateRequired = SM_UPDATE_NOT_REQUIRED;
     StreamEvent_T event;
     StreamState_T state = STREAM_STATE_STANDBY;
+    StreamState_T nextState;
     StateContext_T streamController[NUM_STREAM_STATE_NUM][NUM_STREAM_EVENT_NUM] = {0};
     ModuleMessage_T *message = NULL;
 
     /* Pipeline related variables */
 
-    int i, errorCode, built;
-    char camDevPath[NUM_CAM_DEV_PATH_SIZE] = {0};
     GstElement *pipeline = NULL;
-    VideoCodingFormatCaps_T cameraCapabilities[NUM_SUP_VID_COD_FMT] = {0};
     VideoCodingFormatContext_T context = {
 
         .capsArray = cameraCapabilities,
         .size = NUM_SUP_VID_COD_FMT
     };
 
-    /* Detect compatible camera device */
-    if(getCameraDevicePath(camDevPath, NUM_CAM_DEV_PATH_SIZE)) {
-
-        createLogMessage(STR_LOG_MSG_FUNC21_CAMDEV_NOT_FOUND, LOG_SVRTY_ERR);
-        kill(getpid(), SIGTERM);
-        pthread_exit(NULL);
-    }
-
-    /* Initialize camera device capabilities */
-    if(initCameraCapabilities(camDevPath, &context)) {
-
-        createLogMessage(STR_LOG_MSG_FUNC21_CAM_CAPS_INIT_FAIL, LOG_SVRTY_ERR);
-        kill(getpid(), SIGTERM);
-        pthread_exit(NULL);
-    }
-
-    /* Build video streaming pipeline and set current video coding format */
-    built = FALSE;
-    for(i = 0;(i<NUM_SUP_VID_COD_FMT) && (!built);++i) {
-
-        if(cameraCapabilities[i].supported) {
-
-            if(0 == pipeBuilder(&pipeline, camDevPath, (VideoCodingFormat_T)(i), cameraCapabilities)) {
-                currentCodingFormat = (VideoCodingFormat_T)(i);
-                built = TRUE;
-            }
-        }
-    }
-
-    /* Check if pipeline was built */
-    if(!built) {
-
-        createLogMessage(STR_LOG_MSG_FUNC21_PIPE_BUILD_FAIL, LOG_SVRTY_ERR);
-        kill(getpid(), SIGTERM);
-        pthread_exit(NULL);
-    }
+    /*
+     * Startup task graph: GStreamer initialization, video source selection and
+     * the main loop run concurrently, the capability probe waits for the first
+     * two, the format calibration (a no-op unless enabled, the camera must be free)
+     * for the probe and the pipeline build (every candidate format at once) for
+     * the calibration.
+     * The network module connects to the ground control on its own thread meanwhile.
+     */
+    const StartupTask_T startupTasks[STREAM_STARTUP_TASK_NUM] = {
+
+        [STREAM_STARTUP_GST_INIT]   = {"gst_init", initGstreamerTask, NULL, 0},
+        [STREAM_STARTUP_SOURCE]     = {"video_source", selectVideoSourceTask, NULL, 0},
+        [STREAM_STARTUP_MAIN_LOOP]  = {"main_loop", startMainLoopTask, NULL, 0},
+        [STREAM_STARTUP_CAPS]       = {"capabilities", probeCapabilitiesTask, &context,
+                                       STARTUP_TASK_BIT(STREAM_STARTUP_GST_INIT) | STARTUP_TASK_BIT(STREAM_STARTUP_SOURCE)},
+        [STREAM_STARTUP_CALIBRATION] = {"calibration", calibrateFormatsTask, NULL,
+                                       STARTUP_TASK_BIT(STREAM_STARTUP_CAPS)},
+        [STREAM_STARTUP_PIPE_BUILD] = {"pipeline", buildPipelineTask, &pipeline,
+                                       STARTUP_TASK_BIT(STREAM_STARTUP_CALIBRATION)}
+    };
 
-    /* Register pipeline callback functions for error detection */
-    if(registerCallbackFunctions(pipeline)) {
+    applyThreadScheduling(SCHED_CLASS_CONTROL);
 
-        createLogMessage(STR_LOG_MSG_FUNC21_REG_CBS_FAIL, LOG_SVRTY_ERR);
+    if(runStartupTasks(startupTasks, STREAM_STARTUP_TASK_NUM)) {
 
-        gst_object_unref(pipeline);
+        /* The failed task logged the reason */
+        releasePipeline(&pipeline);
+        flushLogMessages();
         kill(getpid(), SIGTERM);
         pthread_exit(NULL);
     }
 
-    /* Start main loop thread for pipeline event management */
-    errorCode = pthread_create(&threadStreamMainLoop, NULL, threadFuncStreamMainLoop, NULL);
-    if(0 != errorCode) {
-
-        createLogMessage(STR_LOG_MSG_FUNC21_THRD_START_FAIL, LOG_SVRTY_ERR);
-
-        gst_object_unref(pipeline);
-        kill(getpid(), SIGTERM);
-        pthread_exit(NULL);
-    }
+    markStartupMilestone(STARTUP_MILESTONE_READY);
 
     initStreamController(streamController);
 
@@ -475,10 +864,36 @@ static void* threadFuncStreamControl(void *arg) {
                     break;
 
                 case MOD_MSG_CODE_STREAM_ERROR:
+                case MOD_MSG_CODE_STREAM_STALL:
 
+                    /* A silent stall is recovered like a pipeline error */
                     event = STREAM_EVENT_PIPE_ERROR;
                     updateRequired = SM_UPDATE_REQUIRED;
                     break;
+
+                case MOD_MSG_CODE_STREAM_RETRY:
+
+                    event = STREAM_EVENT_RECOVERY_RETRY;
+                    updateRequired = SM_UPDATE_REQUIRED;
+                    break;
+
+                case MOD_MSG_CODE_PROFILE_DUMP:
+
+                    /* Not a stream event: the profile is written on the main loop thread */
+                    requestPipelineProfileDump();
+                    free(message);
+                    message = NULL;
+                    updateRequired = SM_UPDATE_NOT_REQUIRED;
+                    break;
+
+                case MOD_MSG_CODE_SNAPSHOT_REQ:
+
+                    /* Not a stream event: the playing pipeline keeps streaming (failures are reported) */
+                    requestSnapshot(pipeline);
+                    free(message);
+                    message = NULL;
+                    updateRequired = SM_UPDATE_NOT_REQUIRED;
+                    break;
             
                 default:
 
@@ -489,8 +904,23 @@ static void* threadFuncStreamControl(void *arg) {
 
             if(updateRequired) {
 
+                TRACE_BEGIN(TRACE_SM_TRANSITION, event);
                 streamController[state][event].eventHandler(&message, &pipeline);
-                state = streamController[state][event].nextState;
+                nextState = streamController[state][event].nextState;
+
+                /* Without a pipeline (error or failed recovery attempt) the next recovery attempt is awaited */
+                if((NULL == pipeline) && (STREAM_STATE_PLAYING == nextState)) {
+
+                    nextState = STREAM_STATE_RECOVER_PLAYING;
+                }
+                else if((NULL == pipeline) && (STREAM_STATE_STANDBY == nextState)) {
+
+                    nextState = STREAM_STATE_RECOVER_STANDBY;
+                }
+
+                TRACE_END(TRACE_SM_TRANSITION, nextState);
+                recordFlightEvent(REC_EVT_STATE, (uint16_t)event, (int32_t)state, (int32_t)nextState, NULL);
+                state = nextState;
                 updateRequired = SM_UPDATE_NOT_REQUIRED;
             }
         }
@@ -503,6 +933,8 @@ static void* threadFuncStreamMainLoop(void *arg) {
 
     GMainLoop *loop = NULL;
 
+    applyThreadScheduling(SCHED_CLASS_MAIN_LOOP);
+
     loop = g_main_loop_new(NULL, FALSE);
     if(NULL != loop) {
 
@@ -530,11 +962,25 @@ static void initStreamController(StateContext_T controller[NUM_STREAM_STATE_NUM]
     controller[STREAM_STATE_STANDBY][STREAM_EVENT_STREAM_REQ]   = (StateContext_T) {.nextState = STREAM_STATE_STANDBY, .eventHandler = streamRequestHandler};
     controller[STREAM_STATE_STANDBY][STREAM_EVENT_STREAM_START] = (StateContext_T) {.nextState = STREAM_STATE_PLAYING, .eventHandler = streamStartHandler};
     controller[STREAM_STATE_STANDBY][STREAM_EVENT_STREAM_STOP]  = (StateContext_T) {.nextState = STREAM_STATE_STANDBY, .eventHandler = emptyHandler};
-    controller[STREAM_STATE_STANDBY][STREAM_EVENT_PIPE_ERROR]   = (StateContext_T) {.nextState = STREAM_STATE_STANDBY, .eventHandler = streamErrorHandler};
+    controller[STREAM_STATE_STANDBY][STREAM_EVENT_PIPE_ERROR]   = (StateContext_T) {.nextState = STREAM_STATE_RECOVER_STANDBY, .eventHandler = streamErrorHandler};
+    controller[STREAM_STATE_STANDBY][STREAM_EVENT_RECOVERY_RETRY] = (StateContext_T) {.nextState = STREAM_STATE_STANDBY, .eventHandler = emptyHandler};
     controller[STREAM_STATE_PLAYING][STREAM_EVENT_STREAM_REQ]   = (StateContext_T) {.nextState = STREAM_STATE_PLAYING, .eventHandler = emptyHandler};
     controller[STREAM_STATE_PLAYING][STREAM_EVENT_STREAM_START] = (StateContext_T) {.nextState = STREAM_STATE_PLAYING, .eventHandler = emptyHandler};
     controller[STREAM_STATE_PLAYING][STREAM_EVENT_STREAM_STOP]  = (StateContext_T) {.nextState = STREAM_STATE_STANDBY, .eventHandler = streamStopHandler};
-    controller[STREAM_STATE_PLAYING][STREAM_EVENT_PIPE_ERROR]   = (StateContext_T) {.nextState = STREAM_STATE_STANDBY, .eventHandler = streamErrorHandler};
+    controller[STREAM_STATE_PLAYING][STREAM_EVENT_PIPE_ERROR]   = (StateContext_T) {.nextState = STREAM_STATE_RECOVER_PLAYING, .eventHandler = streamErrorHandler};
+    controller[STREAM_STATE_PLAYING][STREAM_EVENT_RECOVERY_RETRY] = (StateContext_T) {.nextState = STREAM_STATE_PLAYING, .eventHandler = emptyHandler};
+
+    /* Recovery states: errors of the released pipeline are dropped, a stream stop or start only decides about resuming */
+    controller[STREAM_STATE_RECOVER_STANDBY][STREAM_EVENT_STREAM_REQ]   = (StateContext_T) {.nextState = STREAM_STATE_RECOVER_STANDBY, .eventHandler = streamRequestHandler};
+    controller[STREAM_STATE_RECOVER_STANDBY][STREAM_EVENT_STREAM_START] = (StateContext_T) {.nextState = STREAM_STATE_RECOVER_PLAYING, .eventHandler = emptyHandler};
+    controller[STREAM_STATE_RECOVER_STANDBY][STREAM_EVENT_STREAM_STOP]  = (StateContext_T) {.nextState = STREAM_STATE_RECOVER_STANDBY, .eventHandler = emptyHandler};
+    controller[STREAM_STATE_RECOVER_STANDBY][STREAM_EVENT_PIPE_ERROR]   = (StateContext_T) {.nextState = STREAM_STATE_RECOVER_STANDBY, .eventHandler = emptyHandler};
+    controller[STREAM_STATE_RECOVER_STANDBY][STREAM_EVENT_RECOVERY_RETRY] = (StateContext_T) {.nextState = STREAM_STATE_STANDBY, .eventHandler = streamRecoveryHandler};
+    controller[STREAM_STATE_RECOVER_PLAYING][STREAM_EVENT_STREAM_REQ]   = (StateContext_T) {.nextState = STREAM_STATE_RECOVER_PLAYING, .eventHandler = streamRequestHandler};
+    controller[STREAM_STATE_RECOVER_PLAYING][STREAM_EVENT_STREAM_START] = (StateContext_T) {.nextState = STREAM_STATE_RECOVER_PLAYING, .eventHandler = emptyHandler};
+    controller[STREAM_STATE_RECOVER_PLAYING][STREAM_EVENT_STREAM_STOP]  = (StateContext_T) {.nextState = STREAM_STATE_RECOVER_STANDBY, .eventHandler = emptyHandler};
+    controller[STREAM_STATE_RECOVER_PLAYING][STREAM_EVENT_PIPE_ERROR]   = (StateContext_T) {.nextState = STREAM_STATE_RECOVER_PLAYING, .eventHandler = emptyHandler};
+    controller[STREAM_STATE_RECOVER_PLAYING][STREAM_EVENT_RECOVERY_RETRY] = (StateContext_T) {.nextState = STREAM_STATE_PLAYING, .eventHandler = streamResumeHandler};
 }
 
 static void* emptyHandler(ModuleMessage_T* *message, GstElement* *pipeline) {
@@ -559,13 +1005,15 @@ static void* streamRequestHandler(ModuleMessage_T* *message, GstElement* *pipeli
 
     if((NULL != message) && (NULL != pipeline)) {
 
-        /* Update video stream target port */
-        networkSink = gst_bin_get_by_name(GST_BIN(*pipeline), STR_PIPE_ELEM_NAME_NETSINK);
+        /* Update video stream target port (a recovered pipeline gets it when built) */
+        streamDestinationPort = (gint)((*message)->data.videoStreamPort);
+        networkSink = (NULL != *pipeline) ? gst_bin_get_by_name(GST_BIN(*pipeline), STR_PIPE_ELEM_NAME_NETSINK) : NULL;
         if(NULL != networkSink) {
 
-            g_object_set(networkSink, "port", (gint)((*message)->data.videoStreamPort), NULL);
+            g_object_set(networkSink, "port", streamDestinationPort, NULL);
+            gst_object_unref(networkSink);
         }
-        else {
+        else if(NULL != *pipeline) {
 
             createLogMessage(STR_LOG_MSG_FUNC37_PORT_SET_FAIL, LOG_SVRTY_ERR);
         }
@@ -607,12 +1055,17 @@ static void* streamStopHandler(ModuleMessage_T* *message, GstElement* *pipeline)
         *message = NULL;
 
         /* Set pipeline to its initial state */
+        TRACE_BEGIN(TRACE_PIPE_SET_STATE, PIPE_INITIAL_STATE);
         ret = gst_element_set_state(*pipeline, PIPE_INITIAL_STATE);
+        TRACE_END(TRACE_PIPE_SET_STATE, ret);
         if(GST_STATE_CHANGE_FAILURE == ret) {
 
             createLogMessage(STR_LOG_MSG_FUNC38_PIPE_SET_INIT_FAIL, LOG_SVRTY_ERR);
             createLogMessage(STR_LOG_MSG_FUNC38_SM_STATE_INCON, LOG_SVRTY_INF);
         }
+
+        /* A stopped pipeline passes no buffers */
+        disarmStallWatchdog();
     }
     else {
 
@@ -632,12 +1085,18 @@ static void* streamStartHandler(ModuleMessage_T* *message, GstElement* *pipeline
         *message = NULL;
 
         /* Set pipeline to playing state */
+        TRACE_BEGIN(TRACE_PIPE_SET_STATE, GST_STATE_PLAYING);
         ret = gst_element_set_state(*pipeline, GST_STATE_PLAYING);
+        TRACE_END(TRACE_PIPE_SET_STATE, ret);
         if(GST_STATE_CHANGE_FAILURE == ret) {
 
             createLogMessage(STR_LOG_MSG_FUNC39_PIPE_SET_PLAY_FAIL, LOG_SVRTY_ERR);
             createLogMessage(STR_LOG_MSG_FUNC39_SM_STATE_INCON, LOG_SVRTY_INF);
         }
+        else {
+
+            armStallWatchdog();
+        }
     }
     else {
 
@@ -649,22 +1108,23 @@ static void* streamStartHandler(ModuleMessage_T* *message, GstElement* *pipeline
 
 static void* streamErrorHandler(ModuleMessage_T* *message, GstElement* *pipeline) {
 
-    GstStateChangeReturn ret;
-
     if((NULL != message) && (NULL != pipeline)) {
 
-        /* Notify ground control by forwarding the message */
+        /* Notify ground control by forwarding the message (a stall is an error for the ground control) */
         (*message)->address = MOD_NAME_GCCOMMON;
+        (*message)->code = MOD_MSG_CODE_STREAM_ERROR;
         insertModuleMessage(&networkMsgq, *message, MOD_MSGQ_BLOCK);
         *message = NULL;
 
-        /* Set pipeline to NULL state */
-        ret = gst_element_set_state(*pipeline, GST_STATE_NULL);
-        if(GST_STATE_CHANGE_FAILURE == ret) {
+        /* Release the failed pipeline (resets the internal state of each pipeline component) */
+        releasePipeline(pipeline);
 
-            createLogMessage(STR_LOG_MSG_FUNC40_PIPE_SET_NULL_FAIL, LOG_SVRTY_ERR);
-            createLogMessage(STR_LOG_MSG_FUNC40_SM_STATE_INCON, LOG_SVRTY_INF);
-        }
+        /* Recover it in the background (the recovery states keep answering stream requests) */
+        recovery.attempt = 0;
+        recovery.startUs = g_get_monotonic_time();
+        recovery.failedFormat = currentCodingFormat;
+        LOG_MSG_WRN(LOG_MOD_STREAM, STR_LOG_MSG_FUNC40_RECOVERY_START, (int)currentCodingFormat);
+        scheduleRecoveryAttempt();
     }
     else {
 
@@ -674,43 +1134,139 @@ static void* streamErrorHandler(ModuleMessage_T* *message, GstElement* *pipeline
     return NULL;
 }
 
-static int initCameraCapabilities(const char *camDevPath, VideoCodingFormatContext_T *initCtx) {
+static void* streamRecoveryHandler(ModuleMessage_T* *message, GstElement* *pipeline) {
 
-    int retval = 0;
-    int terminate = FALSE;
-    GError *error = NULL;
-    gchar *debugInfo = NULL;
+    if((NULL != message) && (NULL != pipeline)) {
+
+        free(*message);
+        *message = NULL;
+
+        if(recoverPipeline(pipeline)) {
+
+            scheduleRecoveryAttempt();
+        }
+        else {
+
+            buildSparePipeline();
+        }
+    }
+    else {
+
+        createLogMessage(STR_LOG_MSG_FUNC70_ARG_INVAL, LOG_SVRTY_ERR);
+    }
+
+    return NULL;
+}
+
+static void* streamResumeHandler(ModuleMessage_T* *message, GstElement* *pipeline) {
+
+    GstStateChangeReturn ret;
+    ModuleMessage_T *recoveredMessage = NULL;
+
+    if((NULL != message) && (NULL != pipeline)) {
+
+        free(*message);
+        *message = NULL;
+
+        if(recoverPipeline(pipeline)) {
+
+            scheduleRecoveryAttempt();
+            return NULL;
+        }
+
+        /* Set recovered pipeline to playing state */
+        TRACE_BEGIN(TRACE_PIPE_SET_STATE, GST_STATE_PLAYING);
+        ret = gst_element_set_state(*pipeline, GST_STATE_PLAYING);
+        TRACE_END(TRACE_PIPE_SET_STATE, ret);
+        if(GST_STATE_CHANGE_FAILURE == ret) {
+
+            createLogMessage(STR_LOG_MSG_FUNC71_PIPE_SET_PLAY_FAIL, LOG_SVRTY_ERR);
+            releasePipeline(pipeline);
+            scheduleRecoveryAttempt();
+            return NULL;
+        }
+
+        LOG_MSG_INF(LOG_MOD_STREAM, STR_LOG_MSG_FUNC71_RESUMED, (int)currentCodingFormat,
+            (double)(g_get_monotonic_time() - recovery.startUs) / 1000.0);
+        armStallWatchdog();
+
+        /* Ground control restarts its display (rebuilt if the coding format changed) */
+        recoveredMessage = (ModuleMessage_T*)calloc(1, sizeof(ModuleMessage_T));
+        if(NULL != recoveredMessage) {
+
+            recoveredMessage->address = MOD_NAME_GCCOMMON;
+            recoveredMessage->code = MOD_MSG_CODE_STREAM_RECOVERED;
+            recoveredMessage->data.codingFormat = currentCodingFormat;
+
+            insertModuleMessage(&networkMsgq, recoveredMessage, MOD_MSGQ_BLOCK);
+            recoveredMessage = NULL;
+        }
+        else {
+
+            createLogMessage(STR_LOG_MSG_FUNC71_MSG_ALLOC_FAIL, LOG_SVRTY_ERR);
+        }
+
+        /* Streaming again, so the spare build costs no outage */
+        buildSparePipeline();
+    }
+    else {
+
+        createLogMessage(STR_LOG_MSG_FUNC71_ARG_INVAL, LOG_SVRTY_ERR);
+    }
+
+    return NULL;
+}
+
+static int initCameraCapabilities(const VideoSourceConfig_T *source, VideoCodingFormatContext_T *initCtx) {
+
+    int retval = 0;
+    int terminate = FALSE;
+    GError *error = NULL;
+    gchar *debugInfo = NULL;
     GstElement *pipeline = NULL, *videoSource = NULL;
     GstBus *bus = NULL;
     GstMessage *message = NULL;
     GstState newState;
     GstStateChangeReturn ret;
 
-    if((NULL != camDevPath) && (NULL != initCtx)) {
+    if((NULL != source) && (NULL != initCtx) && (VIDEO_SRC_V4L2 != source->type)) {
+
+        /* Virtual sources need no probing pipeline */
+        if(getVideoSourceCapabilities(source, initCtx)) {
+
+            createLogMessage(STR_LOG_MSG_FUNC22_CAM_CAPS_GET_FAIL, LOG_SVRTY_ERR);
+            retval = -1;
+        }
+    }
+    else if((NULL != source) && (NULL != initCtx)) {
 
         /* Initialize capabilities array to zero */
         memset(initCtx->capsArray, 0, sizeof(VideoCodingFormatCaps_T)*initCtx->size);
 
-        /* Instantiate pipeline and video source element */
-        videoSource = gst_element_factory_make("v4l2src", "Video_Source");
+        /* Instantiate pipeline and video source element (v4l2src of the camera device) */
+        videoSource = createVideoSource(source, "Video_Source");
         pipeline = gst_pipeline_new("Camera_Pipeline");
 
         if(!pipeline || !videoSource) {
 
             createLogMessage(STR_LOG_MSG_FUNC22_CREAT_ELEM_FAIL, LOG_SVRTY_ERR);
+
+            /* Elements are not in the bin yet: release them one by one */
+            g_clear_object(&videoSource);
+            g_clear_object(&pipeline);
             retval = -1;
             return retval;
         }
 
-        /* Set camera device path */
-        g_object_set(videoSource, "device", camDevPath, NULL);
-
         /* Build the pipeline and set state to PAUSED */
         gst_bin_add(GST_BIN(pipeline), videoSource);
+        TRACE_BEGIN(TRACE_PIPE_SET_STATE, GST_STATE_PAUSED);
         ret = gst_element_set_state(pipeline, GST_STATE_PAUSED);
+        TRACE_END(TRACE_PIPE_SET_STATE, ret);
         if(GST_STATE_CHANGE_FAILURE == ret) {
 
             createLogMessage(STR_LOG_MSG_FUNC22_PIPE_STATE_SET_FAIL, LOG_SVRTY_ERR);
+            gst_element_set_state(pipeline, GST_STATE_NULL);
             gst_object_unref(pipeline);
 
             retval = -1;
@@ -732,13 +1288,8 @@ static int initCameraCapabilities(const char *camDevPath, VideoCodingFormatConte
 
                         /* Error occured in the media pipeline */
                         gst_message_parse_error(message, &error, &debugInfo);
-                        #ifdef CC_DEBUG_MODE
-                        fprintf(stdout, STR_LOG_MSG_FUNC22_PIPE_ELEM_ERROR_MSG, GST_OBJECT_NAME(message->src), error->message);
-                        fprintf(stdout, STR_LOG_MSG_FUNC22_PIPE_ELEM_ERROR_DBG, (debugInfo ? debugInfo : "none"));
-                        fflush(stdout);
-                        #endif
-                        syslog(LOG_DAEMON | LOG_ERR, STR_LOG_MSG_FUNC22_PIPE_ELEM_ERROR_MSG, GST_OBJECT_NAME(message->src), error->message);
-                        syslog(LOG_DAEMON | LOG_ERR, STR_LOG_MSG_FUNC22_PIPE_ELEM_ERROR_DBG, (debugInfo ? debugInfo : "none"));
+                        LOG_MSG_ERR(LOG_MOD_STREAM, STR_LOG_MSG_FUNC22_PIPE_ELEM_ERROR_MSG, GST_OBJECT_NAME(message->src), error->message);
+                        LOG_MSG_ERR(LOG_MOD_STREAM, STR_LOG_MSG_FUNC22_PIPE_ELEM_ERROR_DBG, (debugInfo ? debugInfo : "none"));
 
                         g_clear_error(&error);
                         g_free(debugInfo);
@@ -782,7 +1333,9 @@ static int initCameraCapabilities(const char *camDevPath, VideoCodingFormatConte
 
         /* Stop pipeline and free resourcces */
         gst_object_unref(bus);
+        TRACE_BEGIN(TRACE_PIPE_SET_STATE, GST_STATE_NULL);
         gst_element_set_state(pipeline, GST_STATE_NULL);
+        TRACE_END(TRACE_PIPE_SET_STATE, 0);
         gst_object_unref(pipeline);
     }
     else {
@@ -794,10 +1347,14 @@ static int initCameraCapabilities(const char *camDevPath, VideoCodingFormatConte
     return retval;
 }
 
-static int pipeBuilder(GstElement* *pipeline, const char *camDevPath, const VideoCodingFormat_T codingFormat, const VideoCodingFormatCaps_T caps[NUM_SUP_VID_COD_FMT]) {
+static int pipeBuilder(GstElement* *pipeline, const VideoSourceConfig_T *source, const VideoCodingFormat_T codingFormat, const VideoCodingFormatCaps_T caps[NUM_SUP_VID_COD_FMT], const int calibration) {
 
     int retval = 0;
+    int snapshotWanted;
     char mediaType[32] = {0};
+    const char *destinationAddress = NULL;
+    const char *multipathPaths = NULL;
+    const char *multipathMode = NULL;
 
     GstStateChangeReturn ret;
     GstCaps *capsConfig = NULL;
@@ -807,15 +1364,16 @@ static int pipeBuilder(GstElement* *pipeline, const char *camDevPath, const Vide
     GstElement *encoder = NULL;
     GstElement *payloader = NULL;
     GstElement *networkSink = NULL;
+    GstElement *snapshotTee = NULL;
 
-    if((NULL != pipeline) && (NULL != camDevPath) && (NUM_SUP_VID_COD_FMT > codingFormat)) {
+    if((NULL != pipeline) && (NULL != source) && (NUM_SUP_VID_COD_FMT > codingFormat)) {
 
         /* Instantiate pipeline and its elements */
 
-        videoSource = gst_element_factory_make("v4l2src", STR_PIPE_ELEM_NAME_VIDSRC);
+        videoSource = createVideoSource(source, STR_PIPE_ELEM_NAME_VIDSRC);
         if(CAM_FMT_RAW == codingFormat) {
 
-            /* Use OpenMax H.264 for RAW camera output */
+            /* Encode RAW camera output to H.264 (hardware encoder if available) */
             videoConverter = gst_element_factory_make("autovideoconvert", STR_PIPE_ELEM_NAME_VIDCONV);
             capsfilter = gst_element_factory_make("capsfilter", STR_PIPE_ELEM_NAME_CAPSFLTR);
             capsConfig = gst_caps_new_simple(
@@ -827,7 +1385,7 @@ static int pipeBuilder(GstElement* *pipeline, const char *camDevPath, const Vide
             );
             g_object_set(capsfilter, "caps", capsConfig, NULL);
             gst_caps_unref(capsConfig);
-            encoder = gst_element_factory_make("omxh264enc", STR_PIPE_ELEM_NAME_ENCODER);
+            encoder = createH264Encoder();
             payloader = gst_element_factory_make("rtph264pay", STR_PIPE_ELEM_NAME_PAYLDR);
         }
         else {
@@ -872,51 +1430,159 @@ static int pipeBuilder(GstElement* *pipeline, const char *camDevPath, const Vide
 
                 default:
                     createLogMessage(STR_LOG_MSG_FUNC30_CODING_FMT_INVAL, LOG_SVRTY_ERR);
-                    gst_object_unref(videoSource);
+                    g_clear_object(&videoSource);
+                    g_clear_object(&capsfilter);
                     retval = -1;
                     return retval;
             }
         }
-        networkSink = gst_element_factory_make("udpsink", STR_PIPE_ELEM_NAME_NETSINK);
+        /* Snapshot branch source (see attachSnapshotBranch()) */
+        snapshotWanted = !calibration && isSnapshotSupported(codingFormat);
+        if(snapshotWanted) {
+
+            snapshotTee = gst_element_factory_make("tee", STR_PIPE_ELEM_NAME_SNAPTEE);
+        }
+        if(calibration) {
+
+            networkSink = gst_element_factory_make("fakesink", STR_PIPE_ELEM_NAME_NETSINK);
+        }
+        else {
+
+            #ifdef CC_NETSINK_STOCK
+            networkSink = gst_element_factory_make(STR_NETSINK_STOCK_NAME, STR_PIPE_ELEM_NAME_NETSINK);
+            #else
+            networkSink = gst_element_factory_make(STR_NETSINK_FACTORY_NAME, STR_PIPE_ELEM_NAME_NETSINK);
+            if(NULL == networkSink) {
+
+                createLogMessage(STR_LOG_MSG_FUNC30_NETSINK_FALLBACK, LOG_SVRTY_WRN);
+                networkSink = gst_element_factory_make(STR_NETSINK_STOCK_NAME, STR_PIPE_ELEM_NAME_NETSINK);
+            }
+            #endif
+        }
         *pipeline = gst_pipeline_new("Video_Streaming_Pipeline");
 
         if(CAM_FMT_RAW == codingFormat) {
 
-            if (!(*pipeline) || !videoSource || !videoConverter || !capsfilter || !encoder || !payloader || !networkSink) {
+            if (!(*pipeline) || !videoSource || !videoConverter || !capsfilter || (snapshotWanted && !snapshotTee) || !encoder || !payloader || !networkSink) {
 
                 createLogMessage(STR_LOG_MSG_FUNC30_CREAT_ELEM_FAIL , LOG_SVRTY_ERR);
 
-                *pipeline = NULL;
+                /* Elements are not in the bin yet: release them one by one */
+                g_clear_object(&videoSource);
+                g_clear_object(&videoConverter);
+                g_clear_object(&capsfilter);
+                g_clear_object(&snapshotTee);
+                g_clear_object(&encoder);
+                g_clear_object(&payloader);
+                g_clear_object(&networkSink);
+                g_clear_object(pipeline);
                 retval = -1;
                 return retval;
             }
         }
         else {
 
-            if (!(*pipeline) || !videoSource || !capsfilter || !payloader || !networkSink) {
+            if (!(*pipeline) || !videoSource || !capsfilter || (snapshotWanted && !snapshotTee) || !payloader || !networkSink) {
 
                 createLogMessage(STR_LOG_MSG_FUNC30_CREAT_ELEM_FAIL , LOG_SVRTY_ERR);
 
-                *pipeline = NULL;
+                /* Elements are not in the bin yet: release them one by one */
+                g_clear_object(&videoSource);
+                g_clear_object(&videoConverter);
+                g_clear_object(&capsfilter);
+                g_clear_object(&snapshotTee);
+                g_clear_object(&encoder);
+                g_clear_object(&payloader);
+                g_clear_object(&networkSink);
+                g_clear_object(pipeline);
                 retval = -1;
                 return retval;
             }
         }
 
         /* Set pipeline common elements' properties */
-        g_object_set(videoSource, "device", camDevPath, NULL);
         g_object_set(payloader, "mtu", NUM_UDP_MTU, NULL);
-        g_object_set(
+
+        /* Calibration pipelines measure the encoding only: no sending, no taps */
+        if(calibration) {
+
+            g_object_set(networkSink, "sync", FALSE, "async", FALSE, NULL);
+        }
+        else {
+
+            /* Stream destination (overridable, e.g. for loopback runs) */
+            destinationAddress = getenv(STR_STREAM_ENV_DEST_ADDR);
+            if((NULL == destinationAddress) || ('\0' == destinationAddress[0])) {
+
+                destinationAddress = STR_STREAM_DEST_ADDR;
+            }
+
+            /* Set pipeline common elements' properties */
+            g_object_set(
             
-            networkSink,
-            "host", STR_STREAM_DEST_ADDR,
-            "port", NUM_STREAM_DEST_PORT,
-            "sync", FALSE,
-            "async", FALSE, NULL
-        );
+                networkSink,
+                "host", destinationAddress,
+                "port", NUM_STREAM_DEST_PORT,
+                "sync", FALSE,
+                "async", FALSE,
+                "qos-dscp", getTrafficClassDscp(QOS_CLASS_VIDEO),
+                "buffer-size", computeSocketBufferSize(NUM_QOS_VIDEO_BITRATE_KBPS, NUM_QOS_TARGET_LATENCY_MS), NULL
+            );
+
+            /* Socket priority is only available on the batched network sink */
+            if(NULL != g_object_class_find_property(G_OBJECT_GET_CLASS(networkSink), "priority")) {
+
+                g_object_set(networkSink, "priority", getTrafficClassPriority(QOS_CLASS_VIDEO), NULL);
+            }
+
+            /* Multipath sending is only available on the batched network sink as well */
+            multipathPaths = getenv(STR_STREAM_ENV_MULTIPATH);
+            if((NULL != multipathPaths) && ('\0' != multipathPaths[0])) {
+
+                if(NULL != g_object_class_find_property(G_OBJECT_GET_CLASS(networkSink), "paths")) {
+
+                    g_object_set(networkSink, "paths", multipathPaths, NULL);
+                    multipathMode = getenv(STR_STREAM_ENV_MULTIPATH_MODE);
+                    if((NULL != multipathMode) && ('\0' != multipathMode[0])) {
+
+                        g_object_set(networkSink, "multipath-mode", multipathMode, NULL);
+                    }
+                }
+                else {
+
+                    createLogMessage(STR_LOG_MSG_FUNC30_MULTIPATH_UNAVAIL, LOG_SVRTY_WRN);
+                }
+            }
+
+            /* Measure per-frame sending cost (see attachNetworkSinkMeter()) */
+            if(attachNetworkSinkMeter(networkSink)) {
+
+                createLogMessage(STR_LOG_MSG_FUNC30_METER_ATTACH_FAIL, LOG_SVRTY_WRN);
+            }
+
+            /* Scheduling classes of the streaming threads (see sched_utils.h) */
+            setPipelineStage(videoSource, SCHED_CLASS_CAPTURE);
+            setPipelineStage(videoConverter, SCHED_CLASS_ENCODE);
+            setPipelineStage(encoder, SCHED_CLASS_ENCODE);
+            setPipelineStage(payloader, SCHED_CLASS_SEND);
+            setPipelineStage(networkSink, SCHED_CLASS_SEND);
+        }
 
         /* Build the pipeline */
-        if(CAM_FMT_RAW == codingFormat) {
+        if((CAM_FMT_RAW == codingFormat) && (NULL != snapshotTee)) {
+
+            gst_bin_add_many(GST_BIN(*pipeline), videoSource, videoConverter, capsfilter, snapshotTee, encoder, payloader, networkSink, NULL);
+            if(TRUE != gst_element_link_many(videoSource, videoConverter, capsfilter, snapshotTee, encoder, payloader, networkSink, NULL)) {
+
+                createLogMessage(STR_LOG_MSG_FUNC30_PIPE_LINK_FAIL, LOG_SVRTY_ERR);
+
+                gst_object_unref(*pipeline);
+                *pipeline = NULL;
+                retval = -1;
+                return retval;
+            }
+        }
+        else if(CAM_FMT_RAW == codingFormat) {
 
             gst_bin_add_many(GST_BIN(*pipeline), videoSource, videoConverter, capsfilter, encoder, payloader, networkSink, NULL);
             if(TRUE != gst_element_link_many(videoSource, videoConverter, capsfilter, encoder, payloader, networkSink, NULL)) {
@@ -929,6 +1595,19 @@ static int pipeBuilder(GstElement* *pipeline, const char *camDevPath, const Vide
                 return retval;
             }
         }
+        else if(NULL != snapshotTee) {
+
+            gst_bin_add_many(GST_BIN(*pipeline), videoSource, capsfilter, snapshotTee, payloader, networkSink, NULL);
+            if(TRUE != gst_element_link_many(videoSource, capsfilter, snapshotTee, payloader, networkSink, NULL)) {
+
+                createLogMessage(STR_LOG_MSG_FUNC30_PIPE_LINK_FAIL, LOG_SVRTY_ERR);
+
+                gst_object_unref(*pipeline);
+                *pipeline = NULL;
+                retval = -1;
+                return retval;
+            }
+        }
         else {
 
             gst_bin_add_many(GST_BIN(*pipeline), videoSource, capsfilter, payloader, networkSink, NULL);
@@ -943,24 +1622,47 @@ static int pipeBuilder(GstElement* *pipeline, const char *camDevPath, const Vide
             }
         }
 
+        /* Snapshots are optional: without the branch the tee feeds the live branch only */
+        if(NULL != snapshotTee) {
+
+            attachSnapshotBranch(*pipeline, snapshotTee, codingFormat);
+        }
+
+        if(!calibration) {
+
+            /* Publish frames to other on board processes (if enabled, see frame_export_utils.h) */
+            attachFrameExport(capsfilter, payloader);
+
+            /* Map RTP timestamps to the ground control's clock (if synchronized, see clock_utils.h) */
+            attachClockMapping(payloader);
+
+            /* Schedule the streaming threads as they start (if enabled) */
+            attachPipelineScheduling(*pipeline);
+        }
+
         /* Set pipeline to its initial state */
+        TRACE_BEGIN(TRACE_PIPE_SET_STATE, PIPE_INITIAL_STATE);
         ret = gst_element_set_state(*pipeline, PIPE_INITIAL_STATE);
+        TRACE_END(TRACE_PIPE_SET_STATE, ret);
         if(GST_STATE_CHANGE_FAILURE == ret) {
 
             createLogMessage(STR_LOG_MSG_FUNC30_PIPE_SET_INIT_FAIL, LOG_SVRTY_ERR);
 
+            gst_element_set_state(*pipeline, GST_STATE_NULL);
             gst_object_unref(*pipeline);
             *pipeline = NULL;
             retval = -1;
             return retval;
         }
 
+        /* Profile the pipeline's elements (if enabled, see profiler_utils.h) */
+        if(!calibration) {
+
+            attachPipelineProfiler(*pipeline);
+        }
+
         /* Log debug info */
-        #ifdef CC_DEBUG_MODE
-        fprintf(stdout, STR_LOG_MSG_FUNC30_PIPE_TYPE_INFO, mediaType);
-        fflush(stdout);
-        #endif
-        syslog(LOG_DAEMON | LOG_INFO, STR_LOG_MSG_FUNC30_PIPE_TYPE_INFO, mediaType);
+        LOG_MSG_INF(LOG_MOD_STREAM, STR_LOG_MSG_FUNC30_PIPE_TYPE_INFO, mediaType);
     }
     else {
 
@@ -971,6 +1673,35 @@ static int pipeBuilder(GstElement* *pipeline, const char *camDevPath, const Vide
     return retval;
 }
 
+static GstElement* createH264Encoder(void) {
+
+    unsigned int i;
+    GstElement *encoder = NULL;
+
+    for(i = h264EncoderFirst;(i < NUM_H264_ENCODER_NUM) && (NULL == encoder);++i) {
+
+        encoder = gst_element_factory_make(h264EncoderNames[i], STR_PIPE_ELEM_NAME_ENCODER);
+    }
+
+    if(NULL == encoder) {
+
+        createLogMessage(STR_LOG_MSG_FUNC58_ENC_NOT_FOUND, LOG_SVRTY_ERR);
+        return NULL;
+    }
+
+    /* Software fallback: no lookahead, fastest preset */
+    if(0 == strcmp(h264EncoderNames[i - 1], "x264enc")) {
+
+        gst_util_set_object_arg(G_OBJECT(encoder), "tune", "zerolatency");
+        gst_util_set_object_arg(G_OBJECT(encoder), "speed-preset", "ultrafast");
+    }
+
+    h264EncoderSelected = i - 1;
+    LOG_MSG_INF(LOG_MOD_STREAM, STR_LOG_MSG_FUNC58_ENC_SELECTED, h264EncoderNames[i - 1]);
+
+    return encoder;
+}
+
 static void pipelineErrorCallback(GstBus *bus, GstMessage *message, gpointer data) {
 
     GError *error = NULL;
@@ -980,14 +1711,10 @@ static void pipelineErrorCallback(GstBus *bus, GstMessage *message, gpointer dat
     if(NULL != message) {
 
         gst_message_parse_error(message, &error, &debugInfo);
+        recordFlightEvent(REC_EVT_BUS, REC_BUS_ERROR, error->code, 0, GST_OBJECT_NAME(message->src));
 
-        #ifdef CC_DEBUG_MODE
-        fprintf(stdout, STR_LOG_MSG_FUNC31_PIPE_ELEM_ERROR_MSG, GST_OBJECT_NAME(message->src), error->message);
-        fprintf(stdout, STR_LOG_MSG_FUNC31_PIPE_ELEM_ERROR_DBG, (debugInfo ? debugInfo : "none"));
-        fflush(stdout);
-        #endif
-        syslog(LOG_DAEMON | LOG_INFO, STR_LOG_MSG_FUNC31_PIPE_ELEM_ERROR_MSG, GST_OBJECT_NAME(message->src), error->message);
-        syslog(LOG_DAEMON | LOG_INFO, STR_LOG_MSG_FUNC31_PIPE_ELEM_ERROR_DBG, (debugInfo ? debugInfo : "none"));
+        LOG_MSG_INF(LOG_MOD_STREAM, STR_LOG_MSG_FUNC31_PIPE_ELEM_ERROR_MSG, GST_OBJECT_NAME(message->src), error->message);
+        LOG_MSG_INF(LOG_MOD_STREAM, STR_LOG_MSG_FUNC31_PIPE_ELEM_ERROR_DBG, (debugInfo ? debugInfo : "none"));
 
         moduleMessage = (ModuleMessage_T*)calloc(1, sizeof(ModuleMessage_T));
         if(NULL != moduleMessage) {
@@ -1015,6 +1742,7 @@ static void pipelineEosCallback(GstBus *bus, GstMessage *message, gpointer data)
 
     ModuleMessage_T *moduleMessage = NULL;
 
+    recordFlightEvent(REC_EVT_BUS, REC_BUS_EOS, 0, 0, NULL);
     createLogMessage(STR_LOG_MSG_FUNC32_PIPE_EOS, LOG_SVRTY_INF);
 
     /* We should not reach EOS so we handle it as an error */
@@ -1044,12 +1772,9 @@ static void pipelineStatechangedCallback(GstBus *bus, GstMessage *message, gpoin
         if(GST_MESSAGE_SRC(message) == GST_OBJECT(pipeline)) {
 
             gst_message_parse_state_changed(message, &oldState, &newState, &pendingState);
-            #ifdef CC_DEBUG_MODE
-            fprintf(stdout, STR_LOG_MSG_FUNC33_PIPE_STATE_CHANGE,
-                gst_element_state_get_name(oldState), gst_element_state_get_name(newState));
-            fflush(stdout);
-            #endif
-            syslog(LOG_DAEMON | LOG_INFO, STR_LOG_MSG_FUNC33_PIPE_STATE_CHANGE,
+            recordFlightEvent(REC_EVT_BUS, REC_BUS_STATE_CHANGED, (int32_t)oldState, (int32_t)newState, GST_OBJECT_NAME(message->src));
+            TRACE_INSTANT(TRACE_PIPE_STATE_CHANGED, (oldState * 16) + newState);
+            LOG_MSG_INF(LOG_MOD_STREAM, STR_LOG_MSG_FUNC33_PIPE_STATE_CHANGE,
                 gst_element_state_get_name(oldState), gst_element_state_get_name(newState));
         }
     }
@@ -1083,3 +1808,513 @@ static int registerCallbackFunctions(GstElement *pipeline) {
 
     return retval;
 }
+
+static void releasePipeline(GstElement* *pipeline) {
+
+    GstBus *bus = NULL;
+
+    if((NULL != pipeline) && (NULL != *pipeline)) {
+
+        /* The watches hold references to the pipeline's pads */
+        clearStallWatches();
+
+        TRACE_BEGIN(TRACE_PIPE_SET_STATE, GST_STATE_NULL);
+        gst_element_set_state(*pipeline, GST_STATE_NULL);
+        TRACE_END(TRACE_PIPE_SET_STATE, 0);
+
+        /* The signal watch holds a reference to the bus */
+        bus = gst_pipeline_get_bus(GST_PIPELINE(*pipeline));
+        gst_bus_remove_signal_watch(bus);
+        gst_object_unref(bus);
+
+        gst_object_unref(*pipeline);
+        *pipeline = NULL;
+    }
+}
+
+static int initGstreamerTask(void *arg) {
+
+    int retval = 0;
+
+    if(FALSE == gst_init_check(NULL, NULL, NULL)) {
+
+        createLogMessage(STR_LOG_MSG_FUNC20_GST_INIT_FAIL, LOG_SVRTY_ERR);
+
+        retval = -1;
+        return retval;
+    }
+
+    /* Not fatal: reports a stale pinned plugin directory or static build early */
+    checkRequiredPlugins();
+
+    /* Not fatal: pipeBuilder() falls back to the stock udpsink */
+    if(registerNetworkSink()) {
+
+        createLogMessage(STR_LOG_MSG_FUNC20_NETSINK_REG_FAIL, LOG_SVRTY_WRN);
+    }
+
+    /* Checks the pipeline selected later on the main loop (disarmed until the stream starts) */
+    initStallWatchdog(pipelineStallCallback, NULL);
+
+    return retval;
+}
+
+static int selectVideoSourceTask(void *arg) {
+
+    int retval = 0;
+
+    /* Select video source (detects compatible camera device by default) */
+    if(getVideoSourceConfig(&sourceConfig)) {
+
+        createLogMessage(STR_LOG_MSG_FUNC21_CAMDEV_NOT_FOUND, LOG_SVRTY_ERR);
+        retval = -1;
+    }
+
+    return retval;
+}
+
+static int startMainLoopTask(void *arg) {
+
+    int retval = 0;
+
+    /* Start main loop thread for pipeline event management */
+    if(pthread_create(&threadStreamMainLoop, NULL, threadFuncStreamMainLoop, NULL)) {
+
+        createLogMessage(STR_LOG_MSG_FUNC21_THRD_START_FAIL, LOG_SVRTY_ERR);
+        retval = -1;
+    }
+
+    return retval;
+}
+
+static int probeCapabilitiesTask(void *arg) {
+
+    int retval = 0;
+
+    /* Initialize camera device capabilities */
+    if(initCameraCapabilities(&sourceConfig, (VideoCodingFormatContext_T*)arg)) {
+
+        createLogMessage(STR_LOG_MSG_FUNC21_CAM_CAPS_INIT_FAIL, LOG_SVRTY_ERR);
+        retval = -1;
+    }
+
+    return retval;
+}
+
+static int calibrateFormatsTask(void *arg) {
+
+    int encoder;
+    unsigned int encoderFirst = h264EncoderFirst;
+
+    initFormatRanking(&sourceConfig, cameraCapabilities, h264EncoderNames, NUM_H264_ENCODER_NUM, buildCalibrationPipeline, NULL);
+
+    /* The calibration pipelines moved the encoder search: start at the best encoder (or where it was) */
+    encoder = getRankedEncoder();
+    h264EncoderFirst = (0 <= encoder) ? (unsigned int)(encoder) : encoderFirst;
+
+    return 0;
+}
+
+static int buildCalibrationPipeline(GstElement* *pipeline, GstElement* *capsfilter, GstElement* *payloader,
+                                    const VideoCodingFormat_T codingFormat, const int encoder, void *data) {
+
+    int retval = 0;
+
+    if(0 <= encoder) {
+
+        h264EncoderFirst = (unsigned int)(encoder);
+    }
+
+    if(pipeBuilder(pipeline, &sourceConfig, codingFormat, cameraCapabilities, TRUE)) {
+
+        retval = -1;
+        return retval;
+    }
+
+    *capsfilter = gst_bin_get_by_name(GST_BIN(*pipeline), STR_PIPE_ELEM_NAME_CAPSFLTR);
+    *payloader = gst_bin_get_by_name(GST_BIN(*pipeline), STR_PIPE_ELEM_NAME_PAYLDR);
+
+    /* A fallback encoder would be measured in place of the requested one */
+    if((NULL == *capsfilter) || (NULL == *payloader) ||
+       ((0 <= encoder) && ((unsigned int)(encoder) != h264EncoderSelected))) {
+
+        g_clear_object(capsfilter);
+        g_clear_object(payloader);
+        releaseUnwatchedPipeline(pipeline);
+        retval = -1;
+        return retval;
+    }
+
+    /* The pipeline keeps its own references */
+    gst_object_unref(*capsfilter);
+    gst_object_unref(*payloader);
+
+    return retval;
+}
+
+static int buildPipelineTask(void *arg) {
+
+    int retval = 0;
+    GstElement* *pipeline = (GstElement**)arg;
+    GstElement *networkSink = NULL;
+    GstPad *sinkPad = NULL;
+
+    /* Build video streaming pipeline and set current video coding format */
+    if(buildPipelineCandidates(pipeline)) {
+
+        createLogMessage(STR_LOG_MSG_FUNC21_PIPE_BUILD_FAIL, LOG_SVRTY_ERR);
+        retval = -1;
+        return retval;
+    }
+
+    /* Register pipeline callback functions for error detection */
+    if(registerCallbackFunctions(*pipeline)) {
+
+        createLogMessage(STR_LOG_MSG_FUNC21_REG_CBS_FAIL, LOG_SVRTY_ERR);
+        retval = -1;
+        return retval;
+    }
+
+    attachStallWatches(*pipeline);
+
+    /* Time to first packet (the probe removes itself) */
+    networkSink = gst_bin_get_by_name(GST_BIN(*pipeline), STR_PIPE_ELEM_NAME_NETSINK);
+    if(NULL != networkSink) {
+
+        sinkPad = gst_element_get_static_pad(networkSink, "sink");
+        if(NULL != sinkPad) {
+
+            gst_pad_add_probe(sinkPad, GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST, firstPacketProbe, NULL, NULL);
+            gst_object_unref(sinkPad);
+        }
+        gst_object_unref(networkSink);
+    }
+
+    return retval;
+}
+
+static int buildPipelineCandidates(GstElement* *pipeline) {
+
+    int retval = 0;
+    int i, built = 0, candidates = 0;
+    PipelineCandidate_T candidate[NUM_SUP_VID_COD_FMT];
+    PipelineCandidate_T *ranked = NULL;
+    VideoCodingFormat_T ranking[NUM_SUP_VID_COD_FMT];
+
+    memset(candidate, 0, sizeof(candidate));
+    getFormatRanking(ranking);
+
+    /* Build every supported format at once (RAW sources get the encoder on top) */
+    for(i = 0;i < NUM_SUP_VID_COD_FMT;++i) {
+
+        candidate[i].result = -1;
+        candidate[i].codingFormat = (VideoCodingFormat_T)(i);
+
+        if(cameraCapabilities[i].supported) {
+
+            ++candidates;
+            if(pthread_create(&candidate[i].thread, NULL, threadFuncPipelineCandidate, &candidate[i])) {
+
+                LOG_MSG_WRN(LOG_MOD_STREAM, STR_LOG_MSG_FUNC64_CANDIDATE_FAIL, i);
+                threadFuncPipelineCandidate(&candidate[i]);
+            }
+            else {
+
+                candidate[i].started = TRUE;
+            }
+        }
+    }
+
+    /* Select the first built candidate in the order of preference (see getFormatRanking()) */
+    *pipeline = NULL;
+    for(i = 0;i < NUM_SUP_VID_COD_FMT;++i) {
+
+        ranked = &candidate[ranking[i]];
+
+        if(ranked->started) {
+
+            pthread_join(ranked->thread, NULL);
+        }
+
+        if((0 == ranked->result) && (NULL != ranked->pipeline)) {
+
+            ++built;
+            if(NULL == *pipeline) {
+
+                *pipeline = ranked->pipeline;
+                currentCodingFormat = ranked->codingFormat;
+                ranked->pipeline = NULL;
+            }
+            else if(NULL == sparePipeline) {
+
+                /* The runner-up stays as warm spare for the pipeline recovery (see recoverPipeline()) */
+                sparePipeline = ranked->pipeline;
+                spareCodingFormat = ranked->codingFormat;
+                ranked->pipeline = NULL;
+            }
+            else {
+
+                releaseUnwatchedPipeline(&ranked->pipeline);
+            }
+        }
+    }
+
+    LOG_MSG_INF(LOG_MOD_STREAM, STR_LOG_MSG_FUNC64_CANDIDATES_BUILT, built, candidates, (int)currentCodingFormat);
+
+    if(NULL == *pipeline) {
+
+        retval = -1;
+    }
+
+    return retval;
+}
+
+static void* threadFuncPipelineCandidate(void *arg) {
+
+    PipelineCandidate_T *candidate = (PipelineCandidate_T*)arg;
+
+    TRACE_BEGIN(TRACE_PIPE_BUILD, candidate->codingFormat);
+    candidate->result = pipeBuilder(&candidate->pipeline, &sourceConfig, candidate->codingFormat, cameraCapabilities, FALSE);
+    TRACE_END(TRACE_PIPE_BUILD, (0 == candidate->result));
+
+    return NULL;
+}
+
+static GstPadProbeReturn firstPacketProbe(GstPad *pad, GstPadProbeInfo *info, gpointer data) {
+
+    markStartupMilestone(STARTUP_MILESTONE_FIRST_PACKET);
+
+    return GST_PAD_PROBE_REMOVE;
+}
+
+static void scheduleRecoveryAttempt(void) {
+
+    unsigned int delayMs;
+    pthread_t thread;
+    pthread_attr_t attributes;
+
+    delayMs = MIN(NUM_RECOVERY_BACKOFF_MS << MIN(recovery.attempt, NUM_RECOVERY_BACKOFF_SHIFT), NUM_RECOVERY_BACKOFF_MAX_MS);
+
+    pthread_attr_init(&attributes);
+    pthread_attr_setdetachstate(&attributes, PTHREAD_CREATE_DETACHED);
+    if(pthread_create(&thread, &attributes, threadFuncRecoveryTimer, GUINT_TO_POINTER(delayMs))) {
+
+        createLogMessage(STR_LOG_MSG_FUNC67_THRD_START_FAIL, LOG_SVRTY_WRN);
+        threadFuncRecoveryTimer(GUINT_TO_POINTER(delayMs));
+    }
+    pthread_attr_destroy(&attributes);
+}
+
+static void* threadFuncRecoveryTimer(void *arg) {
+
+    ModuleMessage_T *message = NULL;
+
+    g_usleep((gulong)(GPOINTER_TO_UINT(arg)) * 1000UL);
+
+    message = (ModuleMessage_T*)calloc(1, sizeof(ModuleMessage_T));
+    if(NULL != message) {
+
+        message->address = MOD_NAME_STREAM;
+        message->code = MOD_MSG_CODE_STREAM_RETRY;
+        insertModuleMessage(&streamMsgq, message, MOD_MSGQ_BLOCK);
+        message = NULL;
+    }
+    else {
+
+        createLogMessage(STR_LOG_MSG_FUNC67_MSG_ALLOC_FAIL, LOG_SVRTY_ERR);
+    }
+
+    return NULL;
+}
+
+static VideoCodingFormat_T selectRecoveryFormat(const unsigned int attempt) {
+
+    unsigned int i, step, supported = 0;
+    VideoCodingFormat_T ranking[NUM_SUP_VID_COD_FMT];
+
+    getFormatRanking(ranking);
+    for(i = 0;i < NUM_SUP_VID_COD_FMT;++i) {
+
+        if(cameraCapabilities[i].supported) {
+
+            ++supported;
+        }
+    }
+
+    if((NUM_RECOVERY_SAME_RETRIES > attempt) || (0 == supported)) {
+
+        return recovery.failedFormat;
+    }
+
+    /* Cycle through the supported formats in the order of preference starting after the failed one */
+    step = (attempt - NUM_RECOVERY_SAME_RETRIES) % supported;
+    i = 0;
+    while((i < NUM_SUP_VID_COD_FMT) && (ranking[i] != recovery.failedFormat)) {
+
+        ++i;
+    }
+    while(1) {
+
+        i = (i + 1U) % NUM_SUP_VID_COD_FMT;
+        if(cameraCapabilities[ranking[i]].supported) {
+
+            if(0 == step) {
+
+                break;
+            }
+            --step;
+        }
+    }
+
+    return ranking[i];
+}
+
+static int recoverPipeline(GstElement* *pipeline) {
+
+    int retval = 0;
+    int fromSpare = FALSE;
+    VideoCodingFormat_T codingFormat;
+    GstElement *networkSink = NULL;
+
+    codingFormat = selectRecoveryFormat(recovery.attempt);
+    if((NUM_RECOVERY_SAME_RETRIES <= recovery.attempt) && (NULL != sparePipeline)) {
+
+        /* The failed format keeps failing: swap in the warm spare without a build */
+        *pipeline = sparePipeline;
+        codingFormat = spareCodingFormat;
+        sparePipeline = NULL;
+        spareCodingFormat = CAM_FMT_UNK;
+        fromSpare = TRUE;
+    }
+    else if((NUM_RECOVERY_SAME_RETRIES <= recovery.attempt) && (CAM_FMT_RAW == codingFormat) &&
+            (recovery.failedFormat == codingFormat) && ((NUM_H264_ENCODER_NUM - 1U) > h264EncoderSelected)) {
+
+        /* Lower mode: the failed RAW pipeline comes back with the next H.264 encoder */
+        h264EncoderFirst = h264EncoderSelected + 1U;
+        h264EncoderSelected = h264EncoderFirst;
+        LOG_MSG_WRN(LOG_MOD_STREAM, STR_LOG_MSG_FUNC68_LOWER_MODE, h264EncoderNames[h264EncoderFirst]);
+    }
+
+    ++recovery.attempt;
+    LOG_MSG_INF(LOG_MOD_STREAM, STR_LOG_MSG_FUNC68_ATTEMPT, recovery.attempt, (int)codingFormat, fromSpare);
+
+    TRACE_BEGIN(TRACE_PIPE_BUILD, codingFormat);
+    if(!fromSpare && pipeBuilder(pipeline, &sourceConfig, codingFormat, cameraCapabilities, FALSE)) {
+
+        *pipeline = NULL;
+        retval = -1;
+    }
+    else if(registerCallbackFunctions(*pipeline)) {
+
+        releasePipeline(pipeline);
+        retval = -1;
+    }
+    else {
+
+        /* Keep the stream target port of the last stream request */
+        networkSink = gst_bin_get_by_name(GST_BIN(*pipeline), STR_PIPE_ELEM_NAME_NETSINK);
+        if(NULL != networkSink) {
+
+            g_object_set(networkSink, "port", streamDestinationPort, NULL);
+            gst_object_unref(networkSink);
+        }
+        currentCodingFormat = codingFormat;
+        attachStallWatches(*pipeline);
+    }
+    TRACE_END(TRACE_PIPE_BUILD, (0 == retval));
+
+    if(retval) {
+
+        LOG_MSG_WRN(LOG_MOD_STREAM, STR_LOG_MSG_FUNC68_ATTEMPT_FAIL, recovery.attempt, (int)codingFormat);
+    }
+    else {
+
+        LOG_MSG_INF(LOG_MOD_STREAM, STR_LOG_MSG_FUNC68_RECOVERED, (int)codingFormat, recovery.attempt,
+            (double)(g_get_monotonic_time() - recovery.startUs) / 1000.0);
+    }
+
+    return retval;
+}
+
+static void buildSparePipeline(void) {
+
+    int i;
+    VideoCodingFormat_T codingFormat = CAM_FMT_UNK;
+    VideoCodingFormat_T ranking[NUM_SUP_VID_COD_FMT];
+
+    if(NULL != sparePipeline) {
+
+        return;
+    }
+
+    getFormatRanking(ranking);
+    for(i = 0;(i < NUM_SUP_VID_COD_FMT) && (CAM_FMT_UNK == codingFormat);++i) {
+
+        if(cameraCapabilities[ranking[i]].supported && (ranking[i] != currentCodingFormat)) {
+
+            codingFormat = ranking[i];
+        }
+    }
+
+    if(CAM_FMT_UNK != codingFormat) {
+
+        TRACE_BEGIN(TRACE_PIPE_BUILD, codingFormat);
+        if(pipeBuilder(&sparePipeline, &sourceConfig, codingFormat, cameraCapabilities, FALSE)) {
+
+            LOG_MSG_WRN(LOG_MOD_STREAM, STR_LOG_MSG_FUNC69_SPARE_FAIL, (int)codingFormat);
+            sparePipeline = NULL;
+        }
+        else {
+
+            LOG_MSG_INF(LOG_MOD_STREAM, STR_LOG_MSG_FUNC69_SPARE_BUILT, (int)codingFormat);
+            spareCodingFormat = codingFormat;
+        }
+        TRACE_END(TRACE_PIPE_BUILD, (NULL != sparePipeline));
+    }
+}
+
+static void releaseUnwatchedPipeline(GstElement* *pipeline) {
+
+    if((NULL != pipeline) && (NULL != *pipeline)) {
+
+        gst_element_set_state(*pipeline, GST_STATE_NULL);
+        gst_object_unref(*pipeline);
+        *pipeline = NULL;
+    }
+}
+
+static void attachStallWatches(GstElement *pipeline) {
+
+    clearStallWatches();
+
+    /* Upstream first: a capture stall starves the sink too */
+    if(addStallWatch(pipeline, STR_PIPE_ELEM_NAME_VIDSRC, "src", STR_STALL_WATCH_CAPTURE, stallTimeoutMs)) {
+
+        LOG_MSG_WRN(LOG_MOD_STREAM, STR_LOG_MSG_FUNC76_WATCH_FAIL, STR_STALL_WATCH_CAPTURE);
+    }
+
+    if(addStallWatch(pipeline, STR_PIPE_ELEM_NAME_NETSINK, "sink", STR_STALL_WATCH_SINK, stallTimeoutMs)) {
+
+        LOG_MSG_WRN(LOG_MOD_STREAM, STR_LOG_MSG_FUNC76_WATCH_FAIL, STR_STALL_WATCH_SINK);
+    }
+}
+
+static void pipelineStallCallback(const char *watchName, const unsigned int stalledMs, void *data) {
+
+    ModuleMessage_T *moduleMessage = NULL;
+
+    recordFlightEvent(REC_EVT_BUS, REC_BUS_STALL, (int32_t)stalledMs, 0, watchName);
+
+    moduleMessage = (ModuleMessage_T*)calloc(1, sizeof(ModuleMessage_T));
+    if(NULL != moduleMessage) {
+
+        moduleMessage->address = MOD_NAME_STREAM;
+        moduleMessage->code = MOD_MSG_CODE_STREAM_STALL;
+        insertModuleMessage(&streamMsgq, moduleMessage, MOD_MSGQ_BLOCK);
+        moduleMessage = NULL;
+    }
+    else {
+
+        createLogMessage(STR_LOG_MSG_FUNC75_MSG_ALLOC_FAIL, LOG_SVRTY_ERR);
+    }
+}
@@ -0,0 +1,370 @@
+/**
+ * @file        telemetry_utils.c
+ * @author      Adam Csizy
+ * @date        2021-05-26
+ * @version     v1.1.0
+ *
+ * @brief       Flight telemetry utilities
+ */
+
+
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "log_utils.h"
+#include "sched_utils.h"
+#include "telemetry_utils.h"
+
+
+/* Telemetry related macro definitions */
+
+#define NUM_TELEMETRY_DGRAM_SIZE    128U    /**< Size of the producer datagram buffer (longer samples are truncated and rejected) */
+#define STR_TELEMETRY_DELIMITERS    " \t\r\n" /**< Separators of a producer sample's fields */
+#define NUM_NSEC_PER_MSEC           1000000ULL /**< Nanoseconds in a millisecond */
+
+
+/* Telemetry related static type declarations */
+
+/**
+ * @brief   Struct of a telemetry channel's state.
+ */
+typedef struct TelemetrySlot {
+
+    int pending;                            /**< Flag whether the sample is not sent yet */
+    int32_t values[NUM_TELEMETRY_VALUES];   /**< Latest sample values */
+    uint64_t publishedNs;                   /**< Monotonic time of publishing the latest sample */
+    uint64_t sentNs;                        /**< Monotonic time of sending the channel's last sample */
+    uint64_t replaced;                      /**< Number of samples replaced before being sent */
+
+} TelemetrySlot_T;
+
+
+/* Telemetry related static variable declarations */
+
+static TelemetrySlot_T slots[TLM_CHAN_COUNT];   /**< State of the telemetry channels */
+static unsigned int nextChannel = 0;            /**< Channel checked first by the next take (round robin) */
+static uint64_t periodNs = 0;                   /**< Minimum time between two samples of a channel */
+static atomic_int telemetryEnabled = 0;         /**< Flag whether telemetry is sent */
+static int producerSocket = -1;                 /**< Producer socket */
+static pthread_t threadTelemetryProducer;       /**< Thread object of the producer socket reader */
+static pthread_mutex_t telemetryLock = PTHREAD_MUTEX_INITIALIZER;  /**< Lock of the channel states */
+static const char *const channelNames[TLM_CHAN_COUNT] = {"position", "battery", "link"};  /**< Names of the telemetry channels */
+
+
+/* Telemetry related static function declarations */
+
+/**
+ * @brief       Get monotonic time.
+ *
+ * @return      CLOCK_MONOTONIC time in nanoseconds.
+ */
+static uint64_t getMonotonicNs(void);
+
+/**
+ * @brief       Parse producer sample.
+ *
+ * @details     Parses a producer datagram ("<channel> <value>
+ *              [<value> [<value>]]") and publishes the sample.
+ *
+ * @param[in]   text Datagram text (null terminated, modified).
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure (invalid sample)
+ */
+static int parseProducerSample(char *text);
+
+/**
+ * @brief       Start routine of the producer socket reader thread.
+ *
+ * @details     Publishes the samples received on the producer
+ *              socket.
+ *
+ * @param[in]   arg Launch argument (not used).
+ *
+ * @return      Any (not used).
+ */
+static void* threadFuncTelemetryProducer(void *arg);
+
+
+/* Telemetry related function definitions */
+
+int initTelemetryModule(void) {
+
+    int retval = 0;
+    unsigned long rate = NUM_TELEMETRY_RATE_HZ;
+    char *end = NULL;
+    const char *text = NULL;
+    const char *path = NULL;
+    struct sockaddr_un address;
+
+    text = getenv(STR_TELEMETRY_ENV_RATE);
+    if((NULL != text) && ('\0' != text[0])) {
+
+        errno = 0;
+        rate = strtoul(text, &end, 10);
+        if((0 != errno) || ('\0' != *end) || (1000UL < rate)) {
+
+            LOG_MSG_WRN(LOG_MOD_NETWORK, STR_LOG_MSG_FUNC79_RATE_INVAL, text, NUM_TELEMETRY_RATE_HZ);
+            rate = NUM_TELEMETRY_RATE_HZ;
+        }
+    }
+
+    if(0UL == rate) {
+
+        LOG_MSG_INF(LOG_MOD_NETWORK, STR_LOG_MSG_FUNC79_DISABLED);
+        return retval;
+    }
+    periodNs = 1000ULL * NUM_NSEC_PER_MSEC / rate;
+
+    path = getenv(STR_TELEMETRY_ENV_SOCKET);
+    if((NULL == path) || ('\0' == path[0])) {
+
+        path = STR_TELEMETRY_SOCKET_DEFAULT;
+    }
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if(sizeof(address.sun_path) <= strlen(path)) {
+
+        LOG_MSG_ERR(LOG_MOD_NETWORK, STR_LOG_MSG_FUNC79_PATH_INVAL, path);
+        retval = -1;
+        return retval;
+    }
+    strcpy(address.sun_path, path);
+
+    producerSocket = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if(0 > producerSocket) {
+
+        LOG_MSG_ERR(LOG_MOD_NETWORK, STR_LOG_MSG_FUNC79_SOCK_FAIL, path, strerror(errno));
+        retval = -1;
+        return retval;
+    }
+
+    /* A previous instance's socket file is left behind after a crash */
+    unlink(path);
+    if(0 > bind(producerSocket, (struct sockaddr*)(&address), sizeof(address))) {
+
+        LOG_MSG_ERR(LOG_MOD_NETWORK, STR_LOG_MSG_FUNC79_SOCK_FAIL, path, strerror(errno));
+        close(producerSocket);
+        producerSocket = -1;
+        retval = -1;
+        return retval;
+    }
+
+    if(pthread_create(&threadTelemetryProducer, NULL, threadFuncTelemetryProducer, NULL)) {
+
+        createLogMessage(STR_LOG_MSG_FUNC79_THRD_START_FAIL, LOG_SVRTY_ERR);
+        close(producerSocket);
+        producerSocket = -1;
+        unlink(path);
+        retval = -1;
+        return retval;
+    }
+
+    atomic_store(&telemetryEnabled, 1);
+    LOG_MSG_INF(LOG_MOD_NETWORK, STR_LOG_MSG_FUNC79_ENABLED, path, (unsigned int)(rate));
+
+    return retval;
+}
+
+int publishTelemetry(const TelemetryChannel_T channel, const int32_t values[NUM_TELEMETRY_VALUES]) {
+
+    int retval = 0;
+    TelemetrySlot_T *slot = NULL;
+
+    if((0 > (int)(channel)) || (TLM_CHAN_COUNT <= channel) || (NULL == values)) {
+
+        createLogMessage(STR_LOG_MSG_FUNC80_ARG_INVAL, LOG_SVRTY_ERR);
+        retval = -1;
+        return retval;
+    }
+
+    pthread_mutex_lock(&telemetryLock);
+    slot = &slots[channel];
+    if(slot->pending) {
+
+        /* Latest value wins */
+        ++slot->replaced;
+    }
+    memcpy(slot->values, values, sizeof(slot->values));
+    slot->publishedNs = getMonotonicNs();
+    slot->pending = 1;
+    pthread_mutex_unlock(&telemetryLock);
+
+    return retval;
+}
+
+int takeTelemetrySample(TelemetrySample_T *sample, unsigned int *delayMs) {
+
+    int retval = 1;
+    unsigned int i;
+    unsigned int channel;
+    uint64_t now;
+    uint64_t dueNs;
+    uint64_t waitNs = NUM_TELEMETRY_IDLE_WAIT_MS * NUM_NSEC_PER_MSEC;
+    uint64_t replaced = 0;
+    TelemetrySlot_T *slot = NULL;
+
+    if((NULL == sample) || (NULL == delayMs) || !atomic_load(&telemetryEnabled)) {
+
+        retval = -1;
+        return retval;
+    }
+
+    pthread_mutex_lock(&telemetryLock);
+    now = getMonotonicNs();
+    for(i = 0;(i < TLM_CHAN_COUNT) && (1 == retval);++i) {
+
+        channel = (nextChannel + i) % TLM_CHAN_COUNT;
+        slot = &slots[channel];
+        if(!slot->pending) {
+
+            continue;
+        }
+
+        dueNs = slot->sentNs + periodNs;
+        if((0U == slot->sentNs) || (now >= dueNs)) {
+
+            sample->channel = (TelemetryChannel_T)(channel);
+            sample->ageMs = (uint32_t)((now - slot->publishedNs) / NUM_NSEC_PER_MSEC);
+            memcpy(sample->values, slot->values, sizeof(sample->values));
+            replaced = slot->replaced;
+            slot->replaced = 0;
+            slot->pending = 0;
+            slot->sentNs = now;
+            nextChannel = (channel + 1U) % TLM_CHAN_COUNT;
+            retval = 0;
+        }
+        else if((dueNs - now) < waitNs) {
+
+            waitNs = dueNs - now;
+        }
+    }
+    pthread_mutex_unlock(&telemetryLock);
+
+    if(0U < replaced) {
+
+        LOG_MSG_DBG(LOG_MOD_NETWORK, STR_LOG_MSG_FUNC82_REPLACED, getTelemetryChannelName(sample->channel), (unsigned long long)(replaced));
+    }
+
+    /* Rounded up: waking before the due time would only spin */
+    *delayMs = (unsigned int)((waitNs + NUM_NSEC_PER_MSEC - 1U) / NUM_NSEC_PER_MSEC);
+
+    return retval;
+}
+
+const char *getTelemetryChannelName(const TelemetryChannel_T channel) {
+
+    if((0 > (int)(channel)) || (TLM_CHAN_COUNT <= channel)) {
+
+        return "unknown";
+    }
+
+    return channelNames[channel];
+}
+
+static uint64_t getMonotonicNs(void) {
+
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return ((uint64_t)(now.tv_sec) * 1000ULL * NUM_NSEC_PER_MSEC) + (uint64_t)(now.tv_nsec);
+}
+
+static int parseProducerSample(char *text) {
+
+    int retval = 0;
+    int channel;
+    unsigned int count = 0;
+    long value;
+    char *field = NULL;
+    char *context = NULL;
+    char *end = NULL;
+    int32_t values[NUM_TELEMETRY_VALUES] = {0};
+
+    field = strtok_r(text, STR_TELEMETRY_DELIMITERS, &context);
+    if(NULL == field) {
+
+        retval = -1;
+        return retval;
+    }
+
+    for(channel = 0;(channel < (int)(TLM_CHAN_COUNT)) && (0 != strcmp(field, channelNames[channel]));++channel);
+    if((int)(TLM_CHAN_COUNT) == channel) {
+
+        retval = -1;
+        return retval;
+    }
+
+    for(field = strtok_r(NULL, STR_TELEMETRY_DELIMITERS, &context);NULL != field;field = strtok_r(NULL, STR_TELEMETRY_DELIMITERS, &context)) {
+
+        errno = 0;
+        value = strtol(field, &end, 10);
+        if((NUM_TELEMETRY_VALUES <= count) || (0 != errno) || ('\0' != *end) || (INT32_MIN > value) || (INT32_MAX < value)) {
+
+            retval = -1;
+            return retval;
+        }
+        values[count++] = (int32_t)(value);
+    }
+
+    if(0U == count) {
+
+        retval = -1;
+        return retval;
+    }
+
+    retval = publishTelemetry((TelemetryChannel_T)(channel), values);
+
+    return retval;
+}
+
+static void* threadFuncTelemetryProducer(void *arg) {
+
+    ssize_t length;
+    char datagram[NUM_TELEMETRY_DGRAM_SIZE];
+    char sample[NUM_TELEMETRY_DGRAM_SIZE];
+
+    applyThreadScheduling(SCHED_CLASS_NETWORK);
+
+    while(1) {
+
+        length = recv(producerSocket, datagram, sizeof(datagram) - 1U, MSG_TRUNC);
+        if(0 > length) {
+
+            if(EINTR != errno) {
+
+                LOG_MSG_ERR(LOG_MOD_NETWORK, STR_LOG_MSG_FUNC81_RECV_FAIL, strerror(errno));
+                sleep(1);
+            }
+            continue;
+        }
+
+        /* MSG_TRUNC: the length of a truncated datagram exceeds the buffer */
+        if((ssize_t)(sizeof(datagram) - 1U) < length) {
+
+            LOG_MSG_WRN(LOG_MOD_NETWORK, STR_LOG_MSG_FUNC81_SAMPLE_INVAL, "(too long)");
+            continue;
+        }
+
+        datagram[length] = '\0';
+        memcpy(sample, datagram, (size_t)(length) + 1U);
+        if(parseProducerSample(sample)) {
+
+            LOG_MSG_WRN(LOG_MOD_NETWORK, STR_LOG_MSG_FUNC81_SAMPLE_INVAL, datagram);
+        }
+    }
+
+    return NULL;
+}
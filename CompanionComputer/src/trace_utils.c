@@ -0,0 +1,434 @@
+/**
+ * @file        trace_utils.c
+ * @author      Adam Csizy
+ * @date        2021-05-10
+ * @version     v1.1.0
+ *
+ * @brief       Event tracing utilities
+ */
+
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "log_utils.h"
+#include "trace_utils.h"
+
+
+/* Trace related macro definitions */
+
+#define NUM_TRACE_BUFFER_MASK       (NUM_TRACE_BUFFER_RECORDS - 1U) /**< Record index mask */
+#define NUM_TRACE_PATH_SIZE         256U    /**< Maximum length of the trace file path */
+#define NUM_TRACE_COMM_PATH_SIZE    64U     /**< Size of the /proc/self/task/<tid>/comm path */
+#define NUM_NSEC_PER_SEC            1000000000ULL /**< Nanoseconds per second */
+#define STR_TRACE_TMP_SUFFIX        ".tmp"  /**< Suffix of the file written before renaming it into place */
+
+_Static_assert(24 == sizeof(TraceRecord_T), "Trace record layout changed");
+_Static_assert(32 == sizeof(TraceFileHeader_T), "Trace file header layout changed");
+_Static_assert(32 == sizeof(TraceThreadHeader_T), "Trace thread header layout changed");
+
+
+/* Trace related static type declarations */
+
+/**
+ * @brief   Per-thread trace buffer.
+ *
+ * @details Written only by the owner thread. Buffers are never
+ *          freed; the buffer of an exited thread is adopted (and
+ *          restarted) by the next new thread.
+ */
+typedef struct TraceBuffer {
+
+    TraceRecord_T records[NUM_TRACE_BUFFER_RECORDS];    /**< Record slots */
+    _Atomic uint64_t head;                              /**< Number of records ever written */
+    _Atomic int owned;                                  /**< Non-zero while a live thread owns the buffer */
+    uint32_t threadId;                                  /**< Kernel thread identifier of the owner */
+    struct TraceBuffer *next;                           /**< Next buffer in the global list (immutable once published) */
+
+} TraceBuffer_T;
+
+
+/* Trace related static variable declarations */
+
+static _Atomic(TraceBuffer_T*) bufferList = NULL;       /**< Lock-free list of all thread buffers */
+static __thread TraceBuffer_T *threadBuffer = NULL;     /**< Buffer of the calling thread */
+static __thread int threadBufferFailed = 0;             /**< Non-zero if the buffer allocation of the calling thread failed */
+static pthread_key_t bufferKey;                         /**< Key whose destructor releases a thread's buffer */
+static pthread_once_t bufferKeyOnce = PTHREAD_ONCE_INIT; /**< One-time initializer of 'bufferKey' */
+static _Atomic int traceFileBusy = 0;                   /**< Non-zero while the trace file is being written */
+static char traceFilePath[NUM_TRACE_PATH_SIZE] = STR_TRACE_FILE_DEFAULT; /**< Trace file path */
+static char traceFileTmpPath[NUM_TRACE_PATH_SIZE + sizeof(STR_TRACE_TMP_SUFFIX)] = STR_TRACE_FILE_DEFAULT STR_TRACE_TMP_SUFFIX; /**< Temporary trace file path */
+
+
+/* Trace related static function declarations */
+
+/**
+ * @brief       Get clock time in nanoseconds.
+ *
+ * @param[in]   clockId Clock identifier.
+ *
+ * @return      Clock time in nanoseconds.
+ */
+static uint64_t getClockNs(const clockid_t clockId);
+
+/**
+ * @brief       Create buffer key.
+ *
+ * @details     One-time initializer creating the thread-specific
+ *              key whose destructor releases the buffer of an
+ *              exiting thread.
+ */
+static void createBufferKey(void);
+
+/**
+ * @brief       Release thread buffer.
+ *
+ * @param[in,out]   buffer Buffer of the exiting thread.
+ */
+static void releaseThreadBuffer(void *buffer);
+
+/**
+ * @brief       Acquire thread buffer.
+ *
+ * @details     Adopts an unowned buffer or allocates a new one and
+ *              pushes it onto the global list with a compare-and-swap.
+ *
+ * @return      Buffer of the calling thread or NULL on allocation failure.
+ */
+static TraceBuffer_T* acquireThreadBuffer(void);
+
+/**
+ * @brief       Write all.
+ *
+ * @details     Async-signal-safe 'write()' loop.
+ *
+ * @param[in]   fd File descriptor.
+ * @param[in]   data Data to write.
+ * @param[in]   size Size of the data.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+static int writeAll(const int fd, const void *data, size_t size);
+
+/**
+ * @brief       Read thread name.
+ *
+ * @details     Reads /proc/self/task/<tid>/comm without stdio so that
+ *              names set after the buffer was created are also found.
+ *
+ * @param[in]   threadId Kernel thread identifier.
+ * @param[out]  name Thread name buffer (NUM_TRACE_THREAD_NAME_SIZE bytes).
+ */
+static void readThreadName(const uint32_t threadId, char name[]);
+
+/**
+ * @brief       Write trace file at exit.
+ *
+ * @details     'atexit()' compatible wrapper of writeTraceFile().
+ */
+static void writeTraceFileAtExit(void);
+
+/**
+ * @brief       Trace signal handler.
+ *
+ * @details     Writes the trace file. On SIGTERM and SIGINT the
+ *              default action is restored and the signal re-raised.
+ *
+ * @param[in]   signalNumber Signal number.
+ */
+static void traceSignalHandler(int signalNumber);
+
+
+/* Trace related function definitions */
+
+int initTraceModule(void) {
+
+    int retval = 0;
+    const char *path = NULL;
+    struct sigaction action;
+
+    path = getenv(STR_TRACE_ENV_FILE);
+    if((NULL != path) && ('\0' != path[0]) && (NUM_TRACE_PATH_SIZE > strlen(path))) {
+
+        strcpy(traceFilePath, path);
+        strcpy(traceFileTmpPath, path);
+        strcat(traceFileTmpPath, STR_TRACE_TMP_SUFFIX);
+    }
+
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = traceSignalHandler;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+
+    if((0 > sigaction(SIGTERM, &action, NULL)) || (0 > sigaction(SIGINT, &action, NULL)) || (0 > sigaction(SIGUSR1, &action, NULL))) {
+
+        createLogMessage(STR_LOG_MSG_FUNC53_SIGACTION_FAIL, LOG_SVRTY_WRN);
+        retval = -1;
+    }
+
+    atexit(writeTraceFileAtExit);
+    createLogMessageFormat(LOG_SVRTY_INF, STR_LOG_MSG_FUNC53_TRACE_ENABLED, traceFilePath);
+
+    return retval;
+}
+
+void recordTraceEvent(const TracePoint_T point, const TracePhase_T phase, const int64_t arg) {
+
+    uint64_t head;
+    TraceRecord_T *record = NULL;
+    TraceBuffer_T *buffer = threadBuffer;
+
+    if(NULL == buffer) {
+
+        buffer = acquireThreadBuffer();
+        if(NULL == buffer) {
+
+            return;
+        }
+    }
+
+    head = atomic_load_explicit(&buffer->head, memory_order_relaxed);
+    record = &buffer->records[head & NUM_TRACE_BUFFER_MASK];
+    record->timestampNs = getClockNs(CLOCK_MONOTONIC);
+    record->arg = arg;
+    record->point = (uint16_t)(point);
+    record->phase = (uint8_t)(phase);
+
+    atomic_store_explicit(&buffer->head, head + 1, memory_order_release);
+}
+
+int writeTraceFile(void) {
+
+    int retval = 0;
+    int fd, expected = 0;
+    uint64_t head, count, first;
+    uint32_t threads = 0;
+    TraceBuffer_T *buffer = NULL;
+    TraceBuffer_T *listHead = NULL;
+    TraceFileHeader_T fileHeader;
+    TraceThreadHeader_T threadHeader;
+
+    /* A second caller (e.g. signal during exit) skips instead of interleaving */
+    if(!atomic_compare_exchange_strong(&traceFileBusy, &expected, 1)) {
+
+        retval = -1;
+        return retval;
+    }
+
+    /* Snapshot the list: buffers published later are not part of this file */
+    listHead = atomic_load_explicit(&bufferList, memory_order_acquire);
+    for(buffer = listHead;NULL != buffer;buffer = buffer->next) {
+
+        ++threads;
+    }
+
+    memset(&fileHeader, 0, sizeof(fileHeader));
+    memcpy(fileHeader.magic, STR_TRACE_MAGIC, NUM_TRACE_MAGIC_SIZE);
+    fileHeader.version = NUM_TRACE_VERSION;
+    fileHeader.recordSize = sizeof(TraceRecord_T);
+    fileHeader.threads = threads;
+    fileHeader.pid = (uint32_t)(getpid());
+    fileHeader.realtimeOffsetNs = (int64_t)(getClockNs(CLOCK_REALTIME) - getClockNs(CLOCK_MONOTONIC));
+
+    fd = open(traceFileTmpPath, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if(0 > fd) {
+
+        atomic_store(&traceFileBusy, 0);
+        retval = -1;
+        return retval;
+    }
+
+    retval = writeAll(fd, &fileHeader, sizeof(fileHeader));
+
+    for(buffer = listHead;(NULL != buffer) && (0 == retval);buffer = buffer->next) {
+
+        head = atomic_load_explicit(&buffer->head, memory_order_acquire);
+        count = (NUM_TRACE_BUFFER_RECORDS < head) ? NUM_TRACE_BUFFER_RECORDS : head;
+        first = (head - count) & NUM_TRACE_BUFFER_MASK;
+
+        memset(&threadHeader, 0, sizeof(threadHeader));
+        threadHeader.threadId = buffer->threadId;
+        threadHeader.records = (uint32_t)(count);
+        threadHeader.overwritten = head - count;
+        readThreadName(buffer->threadId, threadHeader.name);
+
+        retval = writeAll(fd, &threadHeader, sizeof(threadHeader));
+        if((0 == retval) && (0 < count)) {
+
+            if((first + count) <= NUM_TRACE_BUFFER_RECORDS) {
+
+                retval = writeAll(fd, &buffer->records[first], count * sizeof(TraceRecord_T));
+            }
+            else {
+
+                retval = writeAll(fd, &buffer->records[first], (NUM_TRACE_BUFFER_RECORDS - first) * sizeof(TraceRecord_T));
+                if(0 == retval) {
+
+                    retval = writeAll(fd, &buffer->records[0], (count - (NUM_TRACE_BUFFER_RECORDS - first)) * sizeof(TraceRecord_T));
+                }
+            }
+        }
+    }
+
+    close(fd);
+    if(0 == retval) {
+
+        retval = (0 > rename(traceFileTmpPath, traceFilePath)) ? -1 : 0;
+    }
+
+    atomic_store(&traceFileBusy, 0);
+
+    return retval;
+}
+
+static uint64_t getClockNs(const clockid_t clockId) {
+
+    struct timespec now = {0};
+
+    clock_gettime(clockId, &now);
+
+    return ((uint64_t)(now.tv_sec) * NUM_NSEC_PER_SEC) + (uint64_t)(now.tv_nsec);
+}
+
+static void createBufferKey(void) {
+
+    pthread_key_create(&bufferKey, releaseThreadBuffer);
+}
+
+static void releaseThreadBuffer(void *buffer) {
+
+    atomic_store_explicit(&((TraceBuffer_T*)buffer)->owned, 0, memory_order_release);
+}
+
+static TraceBuffer_T* acquireThreadBuffer(void) {
+
+    int expected;
+    TraceBuffer_T *buffer = NULL;
+    TraceBuffer_T *listHead = NULL;
+
+    if(threadBufferFailed) {
+
+        return NULL;
+    }
+
+    /* Adopt the buffer of an exited thread (its history is restarted) */
+    for(buffer = atomic_load_explicit(&bufferList, memory_order_acquire);NULL != buffer;buffer = buffer->next) {
+
+        expected = 0;
+        if(atomic_compare_exchange_strong_explicit(&buffer->owned, &expected, 1, memory_order_acq_rel, memory_order_relaxed)) {
+
+            atomic_store_explicit(&buffer->head, 0, memory_order_relaxed);
+            buffer->threadId = (uint32_t)(syscall(SYS_gettid));
+            break;
+        }
+    }
+
+    /* Allocate and publish a new buffer */
+    if(NULL == buffer) {
+
+        buffer = (TraceBuffer_T*)calloc(1, sizeof(TraceBuffer_T));
+        if(NULL == buffer) {
+
+            threadBufferFailed = 1;
+            return NULL;
+        }
+
+        atomic_init(&buffer->owned, 1);
+        buffer->threadId = (uint32_t)(syscall(SYS_gettid));
+        listHead = atomic_load_explicit(&bufferList, memory_order_relaxed);
+        do {
+
+            buffer->next = listHead;
+
+        } while(!atomic_compare_exchange_weak_explicit(&bufferList, &listHead, buffer, memory_order_release, memory_order_relaxed));
+    }
+
+    pthread_once(&bufferKeyOnce, createBufferKey);
+    pthread_setspecific(bufferKey, buffer);
+    threadBuffer = buffer;
+
+    return buffer;
+}
+
+static int writeAll(const int fd, const void *data, size_t size) {
+
+    ssize_t written;
+    const char *cursor = (const char*)data;
+
+    while(0 < size) {
+
+        written = write(fd, cursor, size);
+        if(0 >= written) {
+
+            return -1;
+        }
+        cursor += written;
+        size -= (size_t)(written);
+    }
+
+    return 0;
+}
+
+static void readThreadName(const uint32_t threadId, char name[]) {
+
+    int fd, position;
+    ssize_t length;
+    uint32_t divisor;
+    char path[NUM_TRACE_COMM_PATH_SIZE] = "/proc/self/task/";
+
+    /* Append the decimal thread identifier without snprintf() (not async-signal-safe) */
+    position = (int)(strlen(path));
+    for(divisor = 1000000000U;(divisor > 1U) && (0 == (threadId / divisor));divisor /= 10U) {
+
+        // NOP
+    }
+    for(;0 < divisor;divisor /= 10U) {
+
+        path[position++] = (char)('0' + ((threadId / divisor) % 10U));
+    }
+    strcpy(&path[position], "/comm");
+
+    memset(name, 0, NUM_TRACE_THREAD_NAME_SIZE);
+    fd = open(path, O_RDONLY | O_CLOEXEC);
+    if(0 <= fd) {
+
+        length = read(fd, name, NUM_TRACE_THREAD_NAME_SIZE - 1);
+        close(fd);
+        if((0 < length) && ('\n' == name[length - 1])) {
+
+            name[length - 1] = '\0';
+        }
+    }
+}
+
+static void writeTraceFileAtExit(void) {
+
+    writeTraceFile();
+}
+
+static void traceSignalHandler(int signalNumber) {
+
+    int savedErrno = errno;
+
+    writeTraceFile();
+
+    if(SIGUSR1 != signalNumber) {
+
+        signal(signalNumber, SIG_DFL);
+        raise(signalNumber);
+    }
+
+    errno = savedErrno;
+}
@@ -0,0 +1,248 @@
+/**
+ * @file        watchdog_utils.c
+ * @author      Adam Csizy
+ * @date        2021-05-24
+ * @version     v1.1.0
+ *
+ * @brief       Pipeline stall watchdog utilities
+ */
+
+
+#include <gst/gst.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "log_utils.h"
+#include "watchdog_utils.h"
+
+
+/* Watchdog related static type declarations */
+
+/**
+ * @brief   Struct of a stall watch.
+ *
+ * @details The arrival time is written by the buffer probe in
+ *          the streaming thread, the rest is guarded by the
+ *          watchdog lock.
+ */
+typedef struct StallWatch {
+
+    const char *name;               /**< Name of the watch */
+    GstPad *pad;                    /**< Watched pad (reference held) */
+    gulong probeId;                 /**< Buffer probe of the pad */
+    gint64 thresholdUs;             /**< Stall threshold in microseconds */
+    _Atomic int64_t lastBufferUs;   /**< Monotonic time of the last buffer (or of the end of the arming grace) */
+
+} StallWatch_T;
+
+
+/* Watchdog related static variable declarations */
+
+static StallWatch_T watches[NUM_STALL_WATCH_MAX];   /**< Stall watches (upstream first) */
+static unsigned int watchCount = 0;                 /**< Number of stall watches */
+static int armed = FALSE;                           /**< Flag whether the stall check runs */
+static StallCallback_T stallCallback = NULL;        /**< Stall callback */
+static void *stallCallbackData = NULL;              /**< User data of the stall callback */
+static pthread_mutex_t watchdogLock = PTHREAD_MUTEX_INITIALIZER;   /**< Lock of the watches and the arming */
+
+
+/* Watchdog related static function declarations */
+
+/**
+ * @brief       Stall watch buffer probe.
+ *
+ * @details     Takes the arrival time of the buffer (or buffer list).
+ *
+ * @param[in]   pad Watched pad.
+ * @param[in]   info Probe info.
+ * @param[in,out]   data Stall watch (StallWatch_T).
+ *
+ * @return      GST_PAD_PROBE_OK (the buffer passes).
+ */
+static GstPadProbeReturn stallWatchProbe(GstPad *pad, GstPadProbeInfo *info, gpointer data);
+
+/**
+ * @brief       Periodic stall check.
+ *
+ * @details     Runs on the default main context every
+ *              NUM_STALL_CHECK_PERIOD_MS. Reports the most upstream
+ *              stalled watch of an armed watchdog and disarms it.
+ *
+ * @param[in]   data Not used.
+ *
+ * @return      G_SOURCE_CONTINUE (the check keeps running).
+ */
+static gboolean stallCheckCallback(gpointer data);
+
+
+/* Watchdog related function definitions */
+
+int initStallWatchdog(StallCallback_T callback, void *data) {
+
+    int retval = 0;
+
+    if(NULL == callback) {
+
+        createLogMessage(STR_LOG_MSG_FUNC72_ARG_INVAL, LOG_SVRTY_ERR);
+        retval = -1;
+        return retval;
+    }
+
+    pthread_mutex_lock(&watchdogLock);
+    stallCallback = callback;
+    stallCallbackData = data;
+    pthread_mutex_unlock(&watchdogLock);
+
+    /* Cheap while disarmed, so it runs for the whole process lifetime */
+    g_timeout_add(NUM_STALL_CHECK_PERIOD_MS, stallCheckCallback, NULL);
+
+    return retval;
+}
+
+int addStallWatch(GstElement *pipeline, const char *elementName, const char *padName, const char *watchName, const unsigned int thresholdMs) {
+
+    int retval = 0;
+    GstElement *element = NULL;
+    GstPad *pad = NULL;
+    StallWatch_T *watch = NULL;
+
+    if((NULL == pipeline) || (NULL == elementName) || (NULL == padName) || (NULL == watchName)) {
+
+        createLogMessage(STR_LOG_MSG_FUNC73_ARG_INVAL, LOG_SVRTY_ERR);
+        retval = -1;
+        return retval;
+    }
+
+    if(0U == thresholdMs) {
+
+        return retval;
+    }
+
+    element = gst_bin_get_by_name(GST_BIN(pipeline), elementName);
+    if(NULL != element) {
+
+        pad = gst_element_get_static_pad(element, padName);
+        gst_object_unref(element);
+    }
+    if(NULL == pad) {
+
+        LOG_MSG_ERR(LOG_MOD_STREAM, STR_LOG_MSG_FUNC73_PAD_NOT_FOUND, watchName, elementName, padName);
+        retval = -1;
+        return retval;
+    }
+
+    pthread_mutex_lock(&watchdogLock);
+    if(NUM_STALL_WATCH_MAX <= watchCount) {
+
+        pthread_mutex_unlock(&watchdogLock);
+        gst_object_unref(pad);
+        LOG_MSG_ERR(LOG_MOD_STREAM, STR_LOG_MSG_FUNC73_WATCHES_FULL, watchName);
+        retval = -1;
+        return retval;
+    }
+
+    watch = &watches[watchCount];
+    watch->name = watchName;
+    watch->pad = pad;
+    watch->thresholdUs = (gint64)(thresholdMs) * 1000;
+    atomic_store(&watch->lastBufferUs, g_get_monotonic_time());
+    watch->probeId = gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST, stallWatchProbe, watch, NULL);
+    ++watchCount;
+    pthread_mutex_unlock(&watchdogLock);
+
+    LOG_MSG_DBG(LOG_MOD_STREAM, STR_LOG_MSG_FUNC73_WATCH_ADDED, watchName, elementName, padName, thresholdMs);
+
+    return retval;
+}
+
+void clearStallWatches(void) {
+
+    unsigned int i;
+
+    pthread_mutex_lock(&watchdogLock);
+    armed = FALSE;
+    for(i = 0;i < watchCount;++i) {
+
+        gst_pad_remove_probe(watches[i].pad, watches[i].probeId);
+        gst_object_unref(watches[i].pad);
+    }
+    memset(watches, 0, sizeof(watches));
+    watchCount = 0;
+    pthread_mutex_unlock(&watchdogLock);
+}
+
+void armStallWatchdog(void) {
+
+    unsigned int i;
+    int64_t graceEndUs;
+
+    pthread_mutex_lock(&watchdogLock);
+    graceEndUs = g_get_monotonic_time() + ((int64_t)(NUM_STALL_ARM_GRACE_MS) * 1000);
+    for(i = 0;i < watchCount;++i) {
+
+        atomic_store(&watches[i].lastBufferUs, graceEndUs);
+    }
+    armed = TRUE;
+    pthread_mutex_unlock(&watchdogLock);
+}
+
+void disarmStallWatchdog(void) {
+
+    pthread_mutex_lock(&watchdogLock);
+    armed = FALSE;
+    pthread_mutex_unlock(&watchdogLock);
+}
+
+static GstPadProbeReturn stallWatchProbe(GstPad *pad, GstPadProbeInfo *info, gpointer data) {
+
+    StallWatch_T *watch = (StallWatch_T*)data;
+
+    atomic_store_explicit(&watch->lastBufferUs, g_get_monotonic_time(), memory_order_relaxed);
+
+    return GST_PAD_PROBE_OK;
+}
+
+static gboolean stallCheckCallback(gpointer data) {
+
+    unsigned int i;
+    unsigned int stalledMs = 0;
+    gint64 now;
+    gint64 silentUs;
+    const char *stalledName = NULL;
+    StallCallback_T callback = NULL;
+    void *callbackData = NULL;
+
+    pthread_mutex_lock(&watchdogLock);
+    if(armed) {
+
+        now = g_get_monotonic_time();
+        for(i = 0;(i < watchCount) && (NULL == stalledName);++i) {
+
+            silentUs = now - (gint64)atomic_load_explicit(&watches[i].lastBufferUs, memory_order_relaxed);
+            if(silentUs > watches[i].thresholdUs) {
+
+                stalledName = watches[i].name;
+                stalledMs = (unsigned int)(silentUs / 1000);
+            }
+        }
+
+        if(NULL != stalledName) {
+
+            /* Reported once: the owner rearms after handling the stall */
+            armed = FALSE;
+            callback = stallCallback;
+            callbackData = stallCallbackData;
+        }
+    }
+    pthread_mutex_unlock(&watchdogLock);
+
+    if(NULL != callback) {
+
+        LOG_MSG_WRN(LOG_MOD_STREAM, STR_LOG_MSG_FUNC74_STALLED, stalledName, stalledMs);
+        callback(stalledName, stalledMs, callbackData);
+    }
+
+    return G_SOURCE_CONTINUE;
+}
@@ -0,0 +1,223 @@
+/**
+ * @file        flight_recorder_decode.c
+ * @author      Adam Csizy
+ * @date        2021-05-08
+ * @version     v1.1.0
+ *
+ * @brief       Offline decoder of the flight recorder file
+ */
+
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "recorder_utils.h"
+
+/*
+ * Compile like this:
+ *
+ * gcc -O2 -Wall flight_recorder_decode.c -I/<path_to_repo>/CompanionComputer/includes -o flight_recorder_decode
+ *
+ * or run "make tools" in the CompanionComputer directory.
+ *
+ * Launch like this (works on a copy of the file taken after a crash or power cut):
+ *
+ * ./flight_recorder_decode
+ * ./flight_recorder_decode <FILE> [<NUM_EVENTS>]
+ */
+
+
+#define NUM_DEFAULT_EVENTS      50U     /**< Number of events printed by default */
+#define NUM_NSEC_PER_SEC        1000000000ULL /**< Nanoseconds per second */
+#define NUM_TIME_STR_SIZE       32U     /**< Size of the timestamp string */
+
+#define NAME_OR_NUM(table, index) \
+    ((((size_t)(index)) < (sizeof(table) / sizeof((table)[0]))) && (NULL != (table)[(size_t)(index)]) ? (table)[(size_t)(index)] : "?") /**< Name of a table entry or "?" */
+
+
+static const char *const eventTypeNames[] = {NULL, "SESSION", "STATE", "MSG_IN", "MSG_OUT", "BUS", "LOG"};
+static const char *const streamStateNames[] = {"STANDBY", "PLAYING", "RECOVER_STANDBY", "RECOVER_PLAYING"};
+static const char *const streamEventNames[] = {"STREAM_REQ", "STREAM_START", "STREAM_STOP", "PIPE_ERROR", "RECOVERY_RETRY"};
+static const char *const moduleNames[] = {NULL, "NETWORK", "STREAM", "GCCOMMON"};
+static const char *const messageCodeNames[] = {NULL, "LOGIN", "LOGIN_ACK", "STREAM_REQ", "STREAM_ERROR", "STREAM_START", "STREAM_STOP", "STREAM_TYPE", "LOGIN_NACK",
+                                               "PROFILE_DUMP", "STREAM_RETRY", "STREAM_RECOVERED", "STREAM_STALL"};
+static const char *const busCodeNames[] = {NULL, "ERROR", "EOS", "STATE_CHANGED", "STALL"};
+static const char *const gstStateNames[] = {"VOID_PENDING", "NULL", "READY", "PAUSED", "PLAYING"};
+static const char *const severityNames[] = {"ERROR", "WARNING", "INFO", "DEBUG"};
+
+
+/**
+ * @brief       Compare events by sequence number (qsort callback).
+ *
+ * @param[in]   first Pointer to the first event pointer.
+ * @param[in]   second Pointer to the second event pointer.
+ *
+ * @return      Negative, zero or positive like 'strcmp()'.
+ */
+static int compareEvents(const void *first, const void *second) {
+
+    uint64_t a = atomic_load_explicit(&(*(const FlightEvent_T *const *)first)->sequence, memory_order_relaxed);
+    uint64_t b = atomic_load_explicit(&(*(const FlightEvent_T *const *)second)->sequence, memory_order_relaxed);
+
+    return (a > b) - (a < b);
+}
+
+/**
+ * @brief       Print a single event.
+ *
+ * @param[in]   event Flight recorder event.
+ * @param[in]   sequence Sequence number of the event.
+ */
+static void printEvent(const FlightEvent_T *event, const uint64_t sequence) {
+
+    char timeString[NUM_TIME_STR_SIZE] = {0};
+    time_t seconds = (time_t)(event->timestampNs / NUM_NSEC_PER_SEC);
+    struct tm localTime;
+
+    localtime_r(&seconds, &localTime);
+    strftime(timeString, sizeof(timeString), "%Y-%m-%d %H:%M:%S", &localTime);
+
+    fprintf(stdout, "%s.%06llu #%-8llu tid=%-6u %-7s ", timeString,
+        (unsigned long long)((event->timestampNs % NUM_NSEC_PER_SEC) / 1000ULL),
+        (unsigned long long)(sequence - 1), event->threadId, NAME_OR_NUM(eventTypeNames, event->type));
+
+    switch(event->type) {
+
+        case REC_EVT_SESSION:
+            fprintf(stdout, "pid=%d session=%d file=%s\n", event->arg0, event->arg1, event->text);
+            break;
+
+        case REC_EVT_STATE:
+            fprintf(stdout, "%s --%s--> %s\n", NAME_OR_NUM(streamStateNames, event->arg0),
+                NAME_OR_NUM(streamEventNames, event->code), NAME_OR_NUM(streamStateNames, event->arg1));
+            break;
+
+        case REC_EVT_MSG_IN:
+        case REC_EVT_MSG_OUT:
+            fprintf(stdout, "module=%s code=%s%s%s\n", NAME_OR_NUM(moduleNames, event->arg0),
+                NAME_OR_NUM(messageCodeNames, event->code), ('\0' != event->text[0]) ? " peer=" : "", event->text);
+            break;
+
+        case REC_EVT_BUS:
+            if(REC_BUS_STATE_CHANGED == event->code) {
+
+                fprintf(stdout, "%s src=%s %s -> %s\n", NAME_OR_NUM(busCodeNames, event->code), event->text,
+                    NAME_OR_NUM(gstStateNames, event->arg0), NAME_OR_NUM(gstStateNames, event->arg1));
+            }
+            else {
+
+                fprintf(stdout, "%s src=%s code=%d\n", NAME_OR_NUM(busCodeNames, event->code),
+                    ('\0' != event->text[0]) ? event->text : "-", event->arg0);
+            }
+            break;
+
+        case REC_EVT_LOG:
+            fprintf(stdout, "[%s] %s\n", NAME_OR_NUM(severityNames, event->code), event->text);
+            break;
+
+        default:
+            fprintf(stdout, "code=%u arg0=%d arg1=%d text=%s\n", event->code, event->arg0, event->arg1, event->text);
+            break;
+    }
+}
+
+/**
+ * @brief       The decoder's main function.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      1 Failure
+ */
+int main(int argc, char *argv[]) {
+
+    int fd;
+    size_t i, valid, first, count = NUM_DEFAULT_EVENTS;
+    uint64_t sequence;
+    const char *path = STR_RECORDER_FILE_DEFAULT;
+    void *mapping = NULL;
+    struct stat fileStat;
+    const FlightRecorderHeader_T *header = NULL;
+    FlightEvent_T *events = NULL;
+    FlightEvent_T **sorted = NULL;
+
+    if(1 < argc) {
+
+        path = argv[1];
+    }
+    if(2 < argc) {
+
+        count = strtoul(argv[2], NULL, 10);
+    }
+
+    fd = open(path, O_RDONLY);
+    if((0 > fd) || (0 > fstat(fd, &fileStat))) {
+
+        perror(path);
+        return 1;
+    }
+
+    if((size_t)(fileStat.st_size) < sizeof(FlightRecorderHeader_T)) {
+
+        fprintf(stderr, "%s: file too short\n", path);
+        return 1;
+    }
+
+    mapping = mmap(NULL, (size_t)(fileStat.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(MAP_FAILED == mapping) {
+
+        perror("mmap");
+        return 1;
+    }
+
+    header = (const FlightRecorderHeader_T*)mapping;
+    if((0 != memcmp(header->magic, STR_RECORDER_MAGIC, NUM_RECORDER_MAGIC_SIZE)) ||
+       (NUM_RECORDER_VERSION != header->version) || (sizeof(FlightEvent_T) != header->eventSize) ||
+       ((size_t)(fileStat.st_size) < (sizeof(FlightRecorderHeader_T) + ((size_t)(header->capacity) * sizeof(FlightEvent_T))))) {
+
+        fprintf(stderr, "%s: not a flight recorder file (version %u expected)\n", path, NUM_RECORDER_VERSION);
+        return 1;
+    }
+
+    events = (FlightEvent_T*)((char*)(mapping) + sizeof(FlightRecorderHeader_T));
+    sorted = (FlightEvent_T**)calloc(header->capacity, sizeof(FlightEvent_T*));
+    if(NULL == sorted) {
+
+        perror("calloc");
+        return 1;
+    }
+
+    /* Collect published slots; torn or stale slots fail the sequence/index check */
+    for(i = 0, valid = 0;i < header->capacity;++i) {
+
+        sequence = atomic_load_explicit(&events[i].sequence, memory_order_relaxed);
+        if((0 != sequence) && (((sequence - 1) % header->capacity) == i)) {
+
+            events[i].text[NUM_RECORDER_TEXT_SIZE - 1] = '\0';
+            sorted[valid++] = &events[i];
+        }
+    }
+
+    qsort(sorted, valid, sizeof(FlightEvent_T*), compareEvents);
+
+    fprintf(stdout, "%s: %u sessions, %llu events written, %zu retained\n", path, header->sessions,
+        (unsigned long long)(atomic_load_explicit(&header->nextIndex, memory_order_relaxed)), valid);
+
+    first = (valid > count) ? (valid - count) : 0;
+    for(i = first;i < valid;++i) {
+
+        printEvent(sorted[i], atomic_load_explicit(&sorted[i]->sequence, memory_order_relaxed));
+    }
+
+    free(sorted);
+    munmap(mapping, (size_t)(fileStat.st_size));
+
+    return 0;
+}
@@ -0,0 +1,375 @@
+/**
+ * @file        frame_export_reader.c
+ * @author      Adam Csizy
+ * @date        2021-05-28
+ * @version     v1.1.0
+ *
+ * @brief       Example consumer of the shared memory frame export
+ */
+
+
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "frame_export_utils.h"
+
+/*
+ * Compile like this:
+ *
+ * gcc -O2 -Wall frame_export_reader.c -I/<path_to_repo>/CompanionComputer/includes -o frame_export_reader -lrt
+ *
+ * or run "make tools" in the CompanionComputer directory.
+ *
+ * Launch like this (next to a streamer running with CC_FRAME_EXPORT=capture,encoded):
+ *
+ * ./frame_export_reader <capture|encoded> [--slow <MS>] [--seconds <N>]
+ *
+ * Reads the newest frames in place and prints a line per second:
+ *
+ *     [frames] point=<POINT> fps=<RATE> mbps=<RATE> skipped=<N> dropped=<N> oversize=<N>
+ *
+ * where 'skipped' counts frames published while the previous one was read and
+ * 'dropped' reads invalidated by the writer. --slow holds every frame for the
+ * given time to show that a slow consumer does not slow down the stream.
+ */
+
+
+#define NUM_WAIT_TIMEOUT_MS     100U    /**< Longest wait for a frame before checking the streamer */
+#define NUM_NSEC_PER_MSEC       1000000ULL /**< Nanoseconds in a millisecond */
+#define NUM_NSEC_PER_SEC        1000000000ULL /**< Nanoseconds in a second */
+#define NUM_TOUCH_STRIDE        64U     /**< Stride of the bytes read from a frame (one per cache line) */
+
+
+static volatile sig_atomic_t stopRequested = 0;    /**< Set by SIGINT and SIGTERM */
+
+
+/**
+ * @brief       Signal handler stopping the reader.
+ *
+ * @param[in]   signal Signal number.
+ */
+static void stopHandler(int signal) {
+
+    (void)signal;
+    stopRequested = 1;
+}
+
+/**
+ * @brief       Get monotonic time.
+ *
+ * @return      CLOCK_MONOTONIC time in nanoseconds.
+ */
+static uint64_t getMonotonicNs(void) {
+
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return ((uint64_t)(now.tv_sec) * NUM_NSEC_PER_SEC) + (uint64_t)(now.tv_nsec);
+}
+
+/**
+ * @brief       Map the frame export area of a point.
+ *
+ * @param[in]   shmName Name of the shared memory object.
+ * @param[out]  areaSize Size of the mapped area.
+ *
+ * @return      Mapped area or NULL.
+ */
+static FrameExportHeader_T *mapArea(const char *shmName, size_t *areaSize) {
+
+    int fd;
+    struct stat status;
+    FrameExportHeader_T *header = NULL;
+
+    fd = shm_open(shmName, O_RDWR | O_CLOEXEC, 0);
+    if(0 > fd) {
+
+        fprintf(stderr, "Failed to open %s: %s (is the streamer running with CC_FRAME_EXPORT?)\n", shmName, strerror(errno));
+        return NULL;
+    }
+
+    if((0 > fstat(fd, &status)) || ((size_t)(status.st_size) < sizeof(FrameExportHeader_T))) {
+
+        fprintf(stderr, "Invalid frame export area %s\n", shmName);
+        close(fd);
+        return NULL;
+    }
+
+    header = (FrameExportHeader_T*)mmap(NULL, (size_t)(status.st_size), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if(MAP_FAILED == header) {
+
+        fprintf(stderr, "Failed to map %s: %s\n", shmName, strerror(errno));
+        return NULL;
+    }
+    *areaSize = (size_t)(status.st_size);
+
+    if((0 != memcmp(header->magic, STR_FRAME_EXPORT_MAGIC, NUM_FRAME_EXPORT_MAGIC_SIZE)) ||
+       (NUM_FRAME_EXPORT_VERSION != header->version) || (sizeof(FrameExportHeader_T) != header->headerSize) ||
+       (NUM_FRAME_EXPORT_SLOTS != header->slotCount) || (NUM_FRAME_EXPORT_CONSUMER_MAX < header->consumerCount) ||
+       (*areaSize < ((size_t)(header->dataOffset) + ((size_t)(header->slotCount) * header->slotSize)))) {
+
+        fprintf(stderr, "Incompatible frame export area %s\n", shmName);
+        munmap(header, *areaSize);
+        return NULL;
+    }
+
+    return header;
+}
+
+/**
+ * @brief       Claim a consumer entry.
+ *
+ * @param[in,out]   header Mapped area.
+ *
+ * @return      Consumer entry or NULL if every entry is used.
+ */
+static FrameExportConsumer_T *attachConsumer(FrameExportHeader_T *header) {
+
+    unsigned int i;
+    int32_t expected;
+    FrameExportConsumer_T *consumer = NULL;
+
+    for(i = 0;i < header->consumerCount;++i) {
+
+        consumer = &header->consumers[i];
+        expected = 0;
+        if(atomic_compare_exchange_strong(&consumer->pid, &expected, (int32_t)(getpid()))) {
+
+            atomic_store(&consumer->reading, 0U);
+            atomic_store(&consumer->drops, 0U);
+            atomic_store(&consumer->state, FRAME_CONSUMER_ATTACHED);
+            return consumer;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief       Read caps string (sequence lock).
+ *
+ * @param[in]   header Mapped area.
+ * @param[out]  caps Caps string.
+ *
+ * @return      Sequence of the caps read.
+ */
+static uint32_t readCaps(const FrameExportHeader_T *header, char caps[NUM_FRAME_EXPORT_CAPS_SIZE]) {
+
+    uint32_t before;
+    uint32_t after;
+
+    do {
+
+        before = atomic_load_explicit(&header->capsSequence, memory_order_acquire);
+        memcpy(caps, header->caps, NUM_FRAME_EXPORT_CAPS_SIZE);
+        atomic_thread_fence(memory_order_acquire);
+        after = atomic_load_explicit(&header->capsSequence, memory_order_relaxed);
+
+    } while((before & 1U) || (before != after));
+
+    caps[NUM_FRAME_EXPORT_CAPS_SIZE - 1] = '\0';
+
+    return before;
+}
+
+int main(int argc, char **argv) {
+
+    int i;
+    const char *pointName = NULL;
+    const char *shmName = NULL;
+    unsigned long slowMs = 0UL;
+    unsigned long seconds = 0UL;
+    size_t areaSize = 0U;
+    FrameExportHeader_T *header = NULL;
+    FrameExportConsumer_T *consumer = NULL;
+    FrameExportSlot_T *slot = NULL;
+    const uint8_t *data = NULL;
+    char caps[NUM_FRAME_EXPORT_CAPS_SIZE];
+    uint32_t capsSequence = 0U;
+    uint32_t futexValue;
+    uint32_t size;
+    uint32_t expected;
+    uint64_t sequence;
+    uint64_t lastSequence = 0U;
+    uint64_t frames = 0U;
+    uint64_t bytes = 0U;
+    uint64_t skipped = 0U;
+    uint64_t dropped = 0U;
+    uint64_t startNs;
+    uint64_t reportNs;
+    uint64_t nowNs;
+    unsigned int checksum = 0U;
+    uint32_t offset;
+    int valid;
+    struct timespec timeout = {.tv_sec = 0, .tv_nsec = (long)(NUM_WAIT_TIMEOUT_MS * NUM_NSEC_PER_MSEC)};
+    struct timespec slowTime;
+
+    if(2 > argc) {
+
+        fprintf(stderr, "Usage: %s <capture|encoded> [--slow <MS>] [--seconds <N>]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    pointName = argv[1];
+    if(0 == strcmp(pointName, "capture")) {
+
+        shmName = STR_FRAME_EXPORT_SHM_CAPTURE;
+    }
+    else if(0 == strcmp(pointName, "encoded")) {
+
+        shmName = STR_FRAME_EXPORT_SHM_ENCODED;
+    }
+    else {
+
+        fprintf(stderr, "Unknown export point: %s\n", pointName);
+        return EXIT_FAILURE;
+    }
+
+    for(i = 2;i < argc;++i) {
+
+        if((0 == strcmp(argv[i], "--slow")) && ((i + 1) < argc)) {
+
+            slowMs = strtoul(argv[++i], NULL, 10);
+        }
+        else if((0 == strcmp(argv[i], "--seconds")) && ((i + 1) < argc)) {
+
+            seconds = strtoul(argv[++i], NULL, 10);
+        }
+        else {
+
+            fprintf(stderr, "Unknown option: %s\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+    }
+    slowTime.tv_sec = (time_t)(slowMs / 1000UL);
+    slowTime.tv_nsec = (long)((slowMs % 1000UL) * NUM_NSEC_PER_MSEC);
+
+    header = mapArea(shmName, &areaSize);
+    if(NULL == header) {
+
+        return EXIT_FAILURE;
+    }
+
+    consumer = attachConsumer(header);
+    if(NULL == consumer) {
+
+        fprintf(stderr, "Every consumer entry of %s is used (see CC_FRAME_EXPORT_CONSUMERS)\n", shmName);
+        munmap(header, areaSize);
+        return EXIT_FAILURE;
+    }
+
+    signal(SIGINT, stopHandler);
+    signal(SIGTERM, stopHandler);
+
+    /* Start with the next frame */
+    lastSequence = atomic_load(&header->sequence);
+    startNs = getMonotonicNs();
+    reportNs = startNs;
+
+    while(!stopRequested) {
+
+        nowNs = getMonotonicNs();
+        if((nowNs - reportNs) >= NUM_NSEC_PER_SEC) {
+
+            if(atomic_load(&header->capsSequence) != capsSequence) {
+
+                capsSequence = readCaps(header, caps);
+                fprintf(stdout, "[caps] point=%s %s\n", pointName, caps);
+            }
+            fprintf(stdout, "[frames] point=%s fps=%.1f mbps=%.2f skipped=%llu dropped=%llu oversize=%llu\n", pointName,
+                (double)(frames) * NUM_NSEC_PER_SEC / (double)(nowNs - reportNs),
+                (double)(bytes) * 8.0 * 1000.0 / (double)(nowNs - reportNs),
+                (unsigned long long)(skipped), (unsigned long long)(dropped),
+                (unsigned long long)(atomic_load(&header->oversize)));
+            fflush(stdout);
+            frames = 0U;
+            bytes = 0U;
+            reportNs = nowNs;
+
+            if((0UL < seconds) && ((nowNs - startNs) >= (seconds * NUM_NSEC_PER_SEC))) {
+
+                break;
+            }
+        }
+
+        /* Read the counter before the sequence: a frame published in between ends the wait at once */
+        futexValue = atomic_load(&header->futex);
+        sequence = atomic_load_explicit(&header->sequence, memory_order_acquire);
+        if(sequence == lastSequence) {
+
+            syscall(SYS_futex, &header->futex, FUTEX_WAIT, futexValue, &timeout, NULL, 0);
+            if((0 > kill((pid_t)(atomic_load(&header->writerPid)), 0)) && (ESRCH == errno)) {
+
+                fprintf(stderr, "Streamer exited\n");
+                break;
+            }
+            continue;
+        }
+
+        /* Announce the read, then check that the slot still holds the frame */
+        slot = &header->slots[sequence % header->slotCount];
+        atomic_store(&consumer->reading, sequence);
+        if(atomic_load(&slot->sequence) != sequence) {
+
+            atomic_store(&consumer->reading, 0U);
+            continue;
+        }
+
+        /* Zero-copy: the frame is processed in place */
+        size = slot->size;
+        data = (const uint8_t*)header + header->dataOffset + ((size_t)(sequence % header->slotCount) * header->slotSize);
+        for(offset = 0U;offset < size;offset += NUM_TOUCH_STRIDE) {
+
+            checksum += data[offset];
+        }
+        if(0UL < slowMs) {
+
+            nanosleep(&slowTime, NULL);
+        }
+
+        /* The writer drops readers of a slot it overwrites (the fence keeps the data loads before the check) */
+        atomic_thread_fence(memory_order_acquire);
+        valid = (atomic_load(&slot->sequence) == sequence) && (FRAME_CONSUMER_ATTACHED == atomic_load(&consumer->state));
+        atomic_store(&consumer->reading, 0U);
+
+        if(valid) {
+
+            ++frames;
+            bytes += size;
+        }
+        else {
+
+            ++dropped;
+            expected = FRAME_CONSUMER_DROPPED;
+            atomic_compare_exchange_strong(&consumer->state, &expected, FRAME_CONSUMER_ATTACHED);
+        }
+
+        if((0U < lastSequence) && (sequence > (lastSequence + 1U))) {
+
+            skipped += sequence - lastSequence - 1U;
+        }
+        lastSequence = sequence;
+    }
+
+    /* Release the consumer entry */
+    atomic_store(&consumer->state, FRAME_CONSUMER_FREE);
+    atomic_store(&consumer->reading, 0U);
+    atomic_store(&consumer->pid, 0);
+    munmap(header, areaSize);
+
+    fprintf(stdout, "checksum=%u\n", checksum);
+
+    return EXIT_SUCCESS;
+}
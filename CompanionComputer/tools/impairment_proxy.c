@@ -0,0 +1,977 @@
+/**
+ * @file        impairment_proxy.c
+ * @author      Adam Csizy
+ * @date        2021-05-15
+ * @version     v1.1.0
+ *
+ * @brief       Userspace network impairment proxy between drone and ground control
+ */
+
+
+#include <errno.h>
+#include <inttypes.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * Compile like this:
+ *
+ * gcc -O2 -Wall impairment_proxy.c -o impairment_proxy
+ *
+ * or run "make tools" in the CompanionComputer directory.
+ *
+ * Launch like this (no root and no tc netem needed, everything on loopback):
+ *
+ * ./controlapp -H -p 5001                                   # drone is asked to stream to the proxy
+ * ./impairment_proxy -t 5011:127.0.0.1:5010 -u 5001:127.0.0.1:5000 -f bench/scenarios/urban_radio.txt -l truth.jsonl
+ * CC_STREAM_DEST_ADDR=127.0.0.1 ./streamerapp 127.0.0.1 5011
+ *
+ * or pass "--impairment <SCENARIO>" to bench/loopback_bench.py.
+ *
+ * -t relays the TCP control connection, -u the UDP (RTP) stream. Both
+ * directions of both are impaired with the same link parameters. The
+ * scenario file holds one step per line, applied at its time offset and
+ * kept until changed:
+ *
+ *   # time_s  parameter=value ...
+ *   0         rate_kbps=4000 delay_ms=20 jitter_ms=5 loss=0.002
+ *   10        ge_p=0.02 ge_r=0.3 ge_loss=0.8          # bursty loss (Gilbert-Elliott)
+ *   20        outage_ms=1500                          # link down for 1.5 s
+ *
+ * Parameters (default 0 = off):
+ *
+ *   rate_kbps      bandwidth cap (packets are serialized at this rate)
+ *   queue_ms       bottleneck queue depth (default 200): UDP packets queued longer are dropped
+ *   delay_ms       one-way delay
+ *   jitter_ms      uniform extra delay 0..jitter_ms (packet order is kept)
+ *   loss           random loss probability
+ *   ge_p, ge_r     Gilbert-Elliott good->bad and bad->good transition probabilities per packet
+ *   ge_loss        loss probability in the bad state
+ *   reorder        probability of holding a packet back by reorder_ms (default 10) so later ones overtake it
+ *   outage_ms      link outage starting at the step: UDP is dropped, TCP is held until the link is back
+ *
+ * TCP is never dropped or reordered (the kernel would retransmit); it only
+ * sees the rate cap, the delays and the outages.
+ *
+ * The ground truth is written every second as one JSON object per link and
+ * line (-l <FILE>, default: stderr) with cumulative counters, so that the
+ * losses, delays and outages the applications detect can be checked
+ * against what was actually done to the traffic.
+ */
+
+
+#define NUM_PROXY_QUEUE_SIZE        4096U       /**< Packets held per link */
+#define NUM_PROXY_TCP_HIGH_WATER    3072U       /**< TCP is not read while the link holds more chunks than this */
+#define NUM_PROXY_BUFFER_SIZE       65536U      /**< Receive buffer size (largest UDP datagram) */
+#define NUM_PROXY_TCP_CHUNK_SIZE    16384U      /**< TCP bytes read at once */
+#define NUM_PROXY_STEPS             256U        /**< Maximal number of scenario steps */
+#define NUM_PROXY_LINE_SIZE         512U        /**< Maximal scenario line length */
+#define NUM_PROXY_STATS_PERIOD_NS   1000000000ULL   /**< Ground truth period */
+#define NUM_PROXY_MAX_WAIT_MS       100         /**< Longest poll() wait (scenario steps and statistics) */
+#define NUM_PROXY_DEFAULT_QUEUE_MS  200.0       /**< Default bottleneck queue depth */
+#define NUM_PROXY_DEFAULT_REORDER_MS 10.0       /**< Default hold-back of reordered packets */
+#define NUM_NS_PER_MS               1000000.0   /**< Nanoseconds per millisecond */
+
+
+/* Impairment proxy related type definitions */
+
+/**
+ * @brief   Link parameters (indices of LinkParams_T.value).
+ */
+typedef enum LinkParam {
+
+    PARAM_RATE_KBPS     = 0,
+    PARAM_QUEUE_MS      = 1,
+    PARAM_DELAY_MS      = 2,
+    PARAM_JITTER_MS     = 3,
+    PARAM_LOSS          = 4,
+    PARAM_GE_P          = 5,
+    PARAM_GE_R          = 6,
+    PARAM_GE_LOSS       = 7,
+    PARAM_REORDER       = 8,
+    PARAM_REORDER_MS    = 9,
+    PARAM_OUTAGE_MS     = 10,
+    PARAM_COUNT         = 11
+
+} LinkParam_T;
+
+/**
+ * @brief   Scenario step.
+ */
+typedef struct ScenarioStep {
+
+    uint64_t timeNs;                /**< Offset from the proxy start */
+    unsigned int setMask;           /**< Parameters set by the step (bit per LinkParam_T) */
+    double value[PARAM_COUNT];      /**< Values of the set parameters */
+
+} ScenarioStep_T;
+
+/**
+ * @brief   Packet (UDP datagram or TCP chunk) held by a link.
+ */
+typedef struct PendingPacket {
+
+    uint64_t releaseNs;             /**< Time to forward the packet */
+    uint64_t arrivalNs;             /**< Time the packet was received */
+    uint64_t sequence;              /**< Arrival order (heap tie-break) */
+    size_t length;                  /**< Payload length */
+    uint8_t *data;                  /**< Payload */
+
+} PendingPacket_T;
+
+/**
+ * @brief   Ground truth counters of a link (cumulative).
+ */
+typedef struct LinkStats {
+
+    uint64_t packetsIn;             /**< Packets received */
+    uint64_t bytesIn;               /**< Bytes received */
+    uint64_t packetsOut;            /**< Packets forwarded */
+    uint64_t bytesOut;              /**< Bytes forwarded */
+    uint64_t dropLoss;              /**< Random losses */
+    uint64_t dropBurst;             /**< Gilbert-Elliott bad state losses */
+    uint64_t dropQueue;             /**< Bottleneck queue overflows */
+    uint64_t dropOutage;            /**< Losses during outages */
+    uint64_t reordered;             /**< Packets held back for reordering */
+    uint64_t delaySumNs;            /**< Sum of the forwarding delays */
+    uint64_t delayMaxNs;            /**< Largest forwarding delay */
+
+} LinkStats_T;
+
+/**
+ * @brief   One direction of a relayed connection.
+ */
+typedef struct ProxyLink {
+
+    const char *name;               /**< Name in the ground truth */
+    int reliable;                   /**< TCP: no loss, no reordering, held during outages */
+    int outFd;                      /**< Socket the packets are forwarded on */
+    struct sockaddr_storage outAddress; /**< Destination of UDP packets */
+    socklen_t outAddressLength;     /**< Length of outAddress (0: unknown yet) */
+    PendingPacket_T heap[NUM_PROXY_QUEUE_SIZE]; /**< Held packets (min-heap on release time) */
+    size_t count;                   /**< Number of held packets */
+    uint64_t sequence;              /**< Next arrival sequence number */
+    uint64_t linkFreeNs;            /**< Time the bottleneck finishes serializing the queued packets */
+    uint64_t lastReleaseNs;         /**< Release time of the last in-order packet */
+    int geBad;                      /**< Gilbert-Elliott state (1: bad) */
+    LinkStats_T stats;              /**< Ground truth */
+
+} ProxyLink_T;
+
+
+/* Impairment proxy related static variable declarations */
+
+static const char *const paramNames[PARAM_COUNT] = {
+    "rate_kbps", "queue_ms", "delay_ms", "jitter_ms", "loss", "ge_p", "ge_r", "ge_loss", "reorder", "reorder_ms", "outage_ms"
+};
+
+static double params[PARAM_COUNT];                  /**< Current link parameters */
+static ScenarioStep_T steps[NUM_PROXY_STEPS];       /**< Scenario */
+static size_t stepCount = 0;                        /**< Number of scenario steps */
+static size_t nextStep = 0;                         /**< Next scenario step to apply */
+static uint64_t outageEndNs = 0;                    /**< End of the current outage */
+static uint64_t randomState = 0x9E3779B97F4A7C15ULL; /**< PRNG state (-s) */
+static volatile sig_atomic_t running = 1;           /**< Cleared by SIGINT/SIGTERM */
+
+static ProxyLink_T udpUp = {.name = "udp_up"};      /**< Drone -> ground control RTP */
+static ProxyLink_T udpDown = {.name = "udp_down"};  /**< Ground control -> drone RTP (RTCP) */
+static ProxyLink_T tcpUp = {.name = "tcp_up", .reliable = 1};       /**< Drone -> ground control control messages */
+static ProxyLink_T tcpDown = {.name = "tcp_down", .reliable = 1};   /**< Ground control -> drone control messages */
+
+
+/* Impairment proxy related function definitions */
+
+/**
+ * @brief       Get monotonic time.
+ *
+ * @return      CLOCK_MONOTONIC in nanoseconds.
+ */
+static uint64_t getTimeNs(void) {
+
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)(now.tv_sec) * 1000000000ULL + (uint64_t)(now.tv_nsec);
+}
+
+/**
+ * @brief       Get a uniform random number (xorshift64*).
+ *
+ * @return      Random number in [0, 1).
+ */
+static double getRandom(void) {
+
+    randomState ^= randomState >> 12;
+    randomState ^= randomState << 25;
+    randomState ^= randomState >> 27;
+
+    return (double)((randomState * 0x2545F4914F6CDD1DULL) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/**
+ * @brief       Signal handler of SIGINT and SIGTERM.
+ *
+ * @param[in]   signalNumber Signal number (not used).
+ */
+static void stopHandler(int signalNumber) {
+
+    running = 0;
+}
+
+/**
+ * @brief       Load scenario file.
+ *
+ * @param[in]   path Scenario file path.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+static int loadScenario(const char *path) {
+
+    int consumed, param, lineNumber = 0;
+    double timeS;
+    char line[NUM_PROXY_LINE_SIZE];
+    char *token = NULL, *separator = NULL, *end = NULL;
+    FILE *file = NULL;
+
+    file = fopen(path, "r");
+    if(NULL == file) {
+
+        perror(path);
+        return -1;
+    }
+
+    while(NULL != fgets(line, sizeof(line), file)) {
+
+        ++lineNumber;
+        if(NULL != (separator = strchr(line, '#'))) {
+
+            *separator = '\0';
+        }
+
+        if(1 != sscanf(line, " %lf%n", &timeS, &consumed)) {
+
+            /* Empty or comment line */
+            if(NULL == strtok(line, " \t\r\n")) {
+
+                continue;
+            }
+
+            fprintf(stderr, "%s:%d: Missing step time.\n", path, lineNumber);
+            fclose(file);
+            return -1;
+        }
+
+        if((NUM_PROXY_STEPS <= stepCount) || (0.0 > timeS) ||
+           ((0 < stepCount) && ((uint64_t)(timeS * 1e9) < steps[stepCount - 1].timeNs))) {
+
+            fprintf(stderr, "%s:%d: Too many steps or step time out of order.\n", path, lineNumber);
+            fclose(file);
+            return -1;
+        }
+
+        memset(&steps[stepCount], 0, sizeof(ScenarioStep_T));
+        steps[stepCount].timeNs = (uint64_t)(timeS * 1e9);
+
+        for(token = strtok(&line[consumed], " \t\r\n");NULL != token;token = strtok(NULL, " \t\r\n")) {
+
+            separator = strchr(token, '=');
+            if(NULL != separator) {
+
+                *separator = '\0';
+            }
+
+            for(param = 0;(param < PARAM_COUNT) && (0 != strcmp(token, paramNames[param]));++param) {
+
+                /* Look up parameter */
+            }
+
+            if((NULL == separator) || (PARAM_COUNT == param)) {
+
+                fprintf(stderr, "%s:%d: Unknown parameter '%s'.\n", path, lineNumber, token);
+                fclose(file);
+                return -1;
+            }
+
+            steps[stepCount].value[param] = strtod(separator + 1, &end);
+            if((end == separator + 1) || (0.0 > steps[stepCount].value[param])) {
+
+                fprintf(stderr, "%s:%d: Invalid value of '%s'.\n", path, lineNumber, token);
+                fclose(file);
+                return -1;
+            }
+            steps[stepCount].setMask |= (1U << param);
+        }
+
+        ++stepCount;
+    }
+
+    fclose(file);
+
+    return 0;
+}
+
+/**
+ * @brief       Apply the due scenario steps.
+ *
+ * @param[in]   startNs Proxy start time.
+ * @param[in]   nowNs Current time.
+ */
+static void applyScenario(const uint64_t startNs, const uint64_t nowNs) {
+
+    int param;
+
+    while((nextStep < stepCount) && (startNs + steps[nextStep].timeNs <= nowNs)) {
+
+        for(param = 0;param < PARAM_COUNT;++param) {
+
+            if(steps[nextStep].setMask & (1U << param)) {
+
+                params[param] = steps[nextStep].value[param];
+            }
+        }
+
+        if(steps[nextStep].setMask & (1U << PARAM_OUTAGE_MS)) {
+
+            outageEndNs = startNs + steps[nextStep].timeNs + (uint64_t)(params[PARAM_OUTAGE_MS] * NUM_NS_PER_MS);
+        }
+
+        fprintf(stderr, "impairment_proxy: step %zu at %.3f s applied\n", nextStep, (double)(steps[nextStep].timeNs) / 1e9);
+        ++nextStep;
+    }
+}
+
+/**
+ * @brief       Compare two held packets.
+ *
+ * @return      Non-zero if packet a is released before packet b.
+ */
+static int isReleasedBefore(const PendingPacket_T *a, const PendingPacket_T *b) {
+
+    return (a->releaseNs < b->releaseNs) || ((a->releaseNs == b->releaseNs) && (a->sequence < b->sequence));
+}
+
+/**
+ * @brief       Insert a packet into the heap of a link.
+ *
+ * @param[in,out]   link Link.
+ * @param[in]   packet Packet (the link takes over its data).
+ */
+static void pushPacket(ProxyLink_T *link, const PendingPacket_T *packet) {
+
+    size_t index = link->count++;
+    PendingPacket_T swap;
+
+    link->heap[index] = *packet;
+    while((0 < index) && isReleasedBefore(&link->heap[index], &link->heap[(index - 1) / 2])) {
+
+        swap = link->heap[index];
+        link->heap[index] = link->heap[(index - 1) / 2];
+        link->heap[(index - 1) / 2] = swap;
+        index = (index - 1) / 2;
+    }
+}
+
+/**
+ * @brief       Remove the first packet from the heap of a link.
+ *
+ * @param[in,out]   link Link (at least one packet held).
+ * @param[out]  packet Removed packet (the caller takes over its data).
+ */
+static void popPacket(ProxyLink_T *link, PendingPacket_T *packet) {
+
+    size_t index = 0, child;
+    PendingPacket_T swap;
+
+    *packet = link->heap[0];
+    link->heap[0] = link->heap[--link->count];
+
+    while((child = 2 * index + 1) < link->count) {
+
+        if((child + 1 < link->count) && isReleasedBefore(&link->heap[child + 1], &link->heap[child])) {
+
+            ++child;
+        }
+        if(!isReleasedBefore(&link->heap[child], &link->heap[index])) {
+
+            break;
+        }
+
+        swap = link->heap[index];
+        link->heap[index] = link->heap[child];
+        link->heap[child] = swap;
+        index = child;
+    }
+}
+
+/**
+ * @brief       Drop every packet held by a link (connection closed).
+ *
+ * @param[in,out]   link Link.
+ */
+static void flushLink(ProxyLink_T *link) {
+
+    PendingPacket_T packet;
+
+    while(0 < link->count) {
+
+        popPacket(link, &packet);
+        free(packet.data);
+    }
+
+    link->linkFreeNs = 0;
+    link->lastReleaseNs = 0;
+}
+
+/**
+ * @brief       Impair a received packet.
+ *
+ * @details     Applies the outage, loss, bottleneck, delay,
+ *              jitter and reordering of the current link
+ *              parameters and holds the packet until its
+ *              release time.
+ *
+ * @param[in,out]   link Link the packet was received on.
+ * @param[in]   data Packet data.
+ * @param[in]   length Packet length.
+ * @param[in]   nowNs Arrival time.
+ */
+static void impairPacket(ProxyLink_T *link, const uint8_t *data, const size_t length, const uint64_t nowNs) {
+
+    uint64_t startNs;
+    PendingPacket_T packet = {0};
+
+    link->stats.packetsIn++;
+    link->stats.bytesIn += length;
+
+    if(!link->reliable) {
+
+        if(nowNs < outageEndNs) {
+
+            link->stats.dropOutage++;
+            return;
+        }
+
+        /* Gilbert-Elliott channel state, then the loss of the state */
+        if(link->geBad) {
+
+            link->geBad = !(getRandom() < params[PARAM_GE_R]);
+        }
+        else {
+
+            link->geBad = (getRandom() < params[PARAM_GE_P]);
+        }
+
+        if(link->geBad && (getRandom() < params[PARAM_GE_LOSS])) {
+
+            link->stats.dropBurst++;
+            return;
+        }
+
+        if(getRandom() < params[PARAM_LOSS]) {
+
+            link->stats.dropLoss++;
+            return;
+        }
+    }
+
+    /* Bottleneck: serialize at the rate cap behind the queued packets (TCP waits out outages) */
+    startNs = (link->linkFreeNs > nowNs) ? link->linkFreeNs : nowNs;
+    if(link->reliable && (startNs < outageEndNs)) {
+
+        startNs = outageEndNs;
+    }
+
+    if((!link->reliable) && ((double)(startNs - nowNs) > params[PARAM_QUEUE_MS] * NUM_NS_PER_MS)) {
+
+        link->stats.dropQueue++;
+        return;
+    }
+
+    if(NUM_PROXY_QUEUE_SIZE == link->count) {
+
+        link->stats.dropQueue++;
+        return;
+    }
+
+    link->linkFreeNs = startNs;
+    if(0.0 < params[PARAM_RATE_KBPS]) {
+
+        link->linkFreeNs += (uint64_t)((double)(length * 8U) * 1e6 / params[PARAM_RATE_KBPS]);
+    }
+
+    packet.releaseNs = link->linkFreeNs + (uint64_t)((params[PARAM_DELAY_MS] + getRandom() * params[PARAM_JITTER_MS]) * NUM_NS_PER_MS);
+
+    if((!link->reliable) && (getRandom() < params[PARAM_REORDER])) {
+
+        /* Held back: later packets overtake it */
+        packet.releaseNs += (uint64_t)(params[PARAM_REORDER_MS] * NUM_NS_PER_MS);
+        link->stats.reordered++;
+    }
+    else {
+
+        /* Jitter does not reorder */
+        if(packet.releaseNs < link->lastReleaseNs) {
+
+            packet.releaseNs = link->lastReleaseNs;
+        }
+        link->lastReleaseNs = packet.releaseNs;
+    }
+
+    packet.data = (uint8_t*)malloc(length);
+    if(NULL == packet.data) {
+
+        link->stats.dropQueue++;
+        return;
+    }
+
+    memcpy(packet.data, data, length);
+    packet.length = length;
+    packet.arrivalNs = nowNs;
+    packet.sequence = link->sequence++;
+    pushPacket(link, &packet);
+}
+
+/**
+ * @brief       Forward the due packets of a link.
+ *
+ * @param[in,out]   link Link.
+ * @param[in]   nowNs Current time.
+ */
+static void releasePackets(ProxyLink_T *link, const uint64_t nowNs) {
+
+    size_t sent;
+    ssize_t length;
+    uint64_t delayNs;
+    PendingPacket_T packet;
+
+    while((0 < link->count) && (link->heap[0].releaseNs <= nowNs)) {
+
+        popPacket(link, &packet);
+
+        if(link->reliable) {
+
+            for(sent = 0, length = 0;(0 <= link->outFd) && (sent < packet.length) && (0 <= length);sent += (size_t)((0 < length) ? length : 0)) {
+
+                length = send(link->outFd, &packet.data[sent], packet.length - sent, MSG_NOSIGNAL);
+                if((0 > length) && (EINTR == errno)) {
+
+                    length = 0;
+                }
+            }
+        }
+        else if(0 < link->outAddressLength) {
+
+            length = sendto(link->outFd, packet.data, packet.length, 0, (struct sockaddr*)(&link->outAddress), link->outAddressLength);
+        }
+        else {
+
+            length = -1;
+        }
+
+        if(0 <= length) {
+
+            delayNs = nowNs - packet.arrivalNs;
+            link->stats.packetsOut++;
+            link->stats.bytesOut += packet.length;
+            link->stats.delaySumNs += delayNs;
+            if(delayNs > link->stats.delayMaxNs) {
+
+                link->stats.delayMaxNs = delayNs;
+            }
+        }
+
+        free(packet.data);
+    }
+}
+
+/**
+ * @brief       Write the ground truth of a link.
+ *
+ * @param[in]   output Output stream.
+ * @param[in]   link Link.
+ * @param[in]   elapsedNs Time since the proxy start.
+ */
+static void writeLinkStats(FILE *output, const ProxyLink_T *link, const uint64_t elapsedNs) {
+
+    const LinkStats_T *stats = &link->stats;
+
+    fprintf(output,
+        "{\"t\":%.3f,\"link\":\"%s\",\"in\":%" PRIu64 ",\"in_bytes\":%" PRIu64 ",\"out\":%" PRIu64 ",\"out_bytes\":%" PRIu64
+        ",\"drop_loss\":%" PRIu64 ",\"drop_burst\":%" PRIu64 ",\"drop_queue\":%" PRIu64 ",\"drop_outage\":%" PRIu64
+        ",\"reordered\":%" PRIu64 ",\"held\":%zu,\"delay_avg_ms\":%.3f,\"delay_max_ms\":%.3f,\"outage\":%d,\"ge_bad\":%d}\n",
+        (double)(elapsedNs) / 1e9, link->name, stats->packetsIn, stats->bytesIn, stats->packetsOut, stats->bytesOut,
+        stats->dropLoss, stats->dropBurst, stats->dropQueue, stats->dropOutage, stats->reordered, link->count,
+        (0 < stats->packetsOut) ? (double)(stats->delaySumNs) / (double)(stats->packetsOut) / NUM_NS_PER_MS : 0.0,
+        (double)(stats->delayMaxNs) / NUM_NS_PER_MS, (outageEndNs > getTimeNs()) ? 1 : 0, link->geBad);
+}
+
+/**
+ * @brief       Parse a relay specification.
+ *
+ * @param[in]   specification "<LISTEN_PORT>:<TARGET_HOST>:<TARGET_PORT>".
+ * @param[in]   socketType SOCK_STREAM or SOCK_DGRAM.
+ * @param[out]  listenPort Local port.
+ * @param[out]  target Target address.
+ * @param[out]  targetLength Length of the target address.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+static int parseRelay(const char *specification, const int socketType, int *listenPort, struct sockaddr_storage *target, socklen_t *targetLength) {
+
+    int errorCode;
+    char host[256] = {0}, port[16] = {0};
+    struct addrinfo hints = {0}, *result = NULL;
+
+    if(3 != sscanf(specification, "%d:%255[^:]:%15s", listenPort, host, port)) {
+
+        fprintf(stderr, "Invalid relay '%s' (expected <LISTEN_PORT>:<TARGET_HOST>:<TARGET_PORT>).\n", specification);
+        return -1;
+    }
+
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = socketType;
+    errorCode = getaddrinfo(host, port, &hints, &result);
+    if(0 != errorCode) {
+
+        fprintf(stderr, "%s: %s\n", host, gai_strerror(errorCode));
+        return -1;
+    }
+
+    memcpy(target, result->ai_addr, result->ai_addrlen);
+    *targetLength = result->ai_addrlen;
+    freeaddrinfo(result);
+
+    return 0;
+}
+
+/**
+ * @brief       Create a socket bound to a local port.
+ *
+ * @param[in]   socketType SOCK_STREAM (listening) or SOCK_DGRAM.
+ * @param[in]   port Local port (0: any).
+ *
+ * @return      Socket file descriptor or -1.
+ */
+static int createBoundSocket(const int socketType, const int port) {
+
+    int fd, reuseAddrState = 1;
+    struct sockaddr_in address = {0};
+
+    fd = socket(AF_INET, socketType | SOCK_CLOEXEC, 0);
+    if(0 > fd) {
+
+        perror("socket");
+        return -1;
+    }
+
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuseAddrState, sizeof(reuseAddrState));
+
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons((uint16_t)(port));
+    if((0 > bind(fd, (struct sockaddr*)(&address), sizeof(address))) ||
+       ((SOCK_STREAM == socketType) && (0 > listen(fd, 4)))) {
+
+        perror("bind/listen");
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+/**
+ * @brief       Get the earliest release time of the links.
+ *
+ * @return      Earliest release time or UINT64_MAX.
+ */
+static uint64_t getNextReleaseNs(void) {
+
+    size_t i;
+    uint64_t nextNs = UINT64_MAX;
+    const ProxyLink_T *links[] = {&udpUp, &udpDown, &tcpUp, &tcpDown};
+
+    for(i = 0;i < sizeof(links) / sizeof(links[0]);++i) {
+
+        if((0 < links[i]->count) && (links[i]->heap[0].releaseNs < nextNs)) {
+
+            nextNs = links[i]->heap[0].releaseNs;
+        }
+    }
+
+    return nextNs;
+}
+
+/**
+ * @brief       Print usage.
+ *
+ * @param[in]   program Program name.
+ */
+static void printUsage(const char *program) {
+
+    fprintf(stderr, "Usage: %s [-t <PORT>:<HOST>:<PORT>] [-u <PORT>:<HOST>:<PORT>] [-f <SCENARIO>] [-l <TRUTH_FILE>] [-s <SEED>]\n", program);
+}
+
+/**
+ * @brief       The impairment proxy's main function.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      1 Failure
+ */
+int main(int argc, char *argv[]) {
+
+    int option, fd, pollCount, waitMs;
+    int tcpPort = -1, udpPort = -1;
+    int tcpListenFd = -1, tcpClientFd = -1, tcpServerFd = -1, udpListenFd = -1, udpUpstreamFd = -1;
+    ssize_t length;
+    uint64_t startNs, nowNs, nextNs, statsNs;
+    socklen_t tcpTargetLength = 0, udpTargetLength = 0;
+    struct sockaddr_storage tcpTarget, udpTarget;
+    struct pollfd pollArray[5];
+    struct sigaction action = {0};
+    static uint8_t buffer[NUM_PROXY_BUFFER_SIZE];
+    const char *scenarioPath = NULL;
+    FILE *truth = stderr;
+    ProxyLink_T *links[] = {&udpUp, &udpDown, &tcpUp, &tcpDown};
+    size_t i;
+
+    params[PARAM_QUEUE_MS] = NUM_PROXY_DEFAULT_QUEUE_MS;
+    params[PARAM_REORDER_MS] = NUM_PROXY_DEFAULT_REORDER_MS;
+
+    while(-1 != (option = getopt(argc, argv, "t:u:f:l:s:h"))) {
+
+        switch(option) {
+
+            case 't':
+                if(parseRelay(optarg, SOCK_STREAM, &tcpPort, &tcpTarget, &tcpTargetLength)) {
+
+                    return 1;
+                }
+                break;
+
+            case 'u':
+                if(parseRelay(optarg, SOCK_DGRAM, &udpPort, &udpTarget, &udpTargetLength)) {
+
+                    return 1;
+                }
+                break;
+
+            case 'f':
+                scenarioPath = optarg;
+                break;
+
+            case 'l':
+                truth = fopen(optarg, "w");
+                if(NULL == truth) {
+
+                    perror(optarg);
+                    return 1;
+                }
+                break;
+
+            case 's':
+                randomState = strtoull(optarg, NULL, 0) | 1ULL;
+                break;
+
+            default:
+                printUsage(argv[0]);
+                return 1;
+        }
+    }
+
+    if(((0 > tcpPort) && (0 > udpPort)) || ((NULL != scenarioPath) && loadScenario(scenarioPath))) {
+
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    if(0 <= tcpPort) {
+
+        tcpListenFd = createBoundSocket(SOCK_STREAM, tcpPort);
+    }
+    if(0 <= udpPort) {
+
+        udpListenFd = createBoundSocket(SOCK_DGRAM, udpPort);
+        udpUpstreamFd = createBoundSocket(SOCK_DGRAM, 0);
+    }
+    if(((0 <= tcpPort) && (0 > tcpListenFd)) || ((0 <= udpPort) && ((0 > udpListenFd) || (0 > udpUpstreamFd)))) {
+
+        return 1;
+    }
+
+    /* Drone -> ground control goes to the target, the replies to the last drone address */
+    udpUp.outFd = udpUpstreamFd;
+    memcpy(&udpUp.outAddress, &udpTarget, sizeof(udpTarget));
+    udpUp.outAddressLength = udpTargetLength;
+    udpDown.outFd = udpListenFd;
+    tcpUp.outFd = -1;
+    tcpDown.outFd = -1;
+
+    action.sa_handler = stopHandler;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    startNs = getTimeNs();
+    statsNs = startNs + NUM_PROXY_STATS_PERIOD_NS;
+
+    while(running) {
+
+        nowNs = getTimeNs();
+        applyScenario(startNs, nowNs);
+        for(i = 0;i < sizeof(links) / sizeof(links[0]);++i) {
+
+            releasePackets(links[i], nowNs);
+        }
+
+        if(nowNs >= statsNs) {
+
+            for(i = 0;i < sizeof(links) / sizeof(links[0]);++i) {
+
+                writeLinkStats(truth, links[i], nowNs - startNs);
+            }
+            fflush(truth);
+            statsNs += NUM_PROXY_STATS_PERIOD_NS;
+        }
+
+        /* Wait for traffic or the next release */
+        nextNs = getNextReleaseNs();
+        waitMs = NUM_PROXY_MAX_WAIT_MS;
+        if(nextNs <= nowNs) {
+
+            waitMs = 0;
+        }
+        else if(nextNs - nowNs < (uint64_t)(NUM_PROXY_MAX_WAIT_MS) * 1000000ULL) {
+
+            waitMs = (int)((nextNs - nowNs + 999999ULL) / 1000000ULL);
+        }
+
+        pollArray[0].fd = tcpListenFd;
+        pollArray[1].fd = ((0 <= tcpClientFd) && (NUM_PROXY_TCP_HIGH_WATER > tcpUp.count)) ? tcpClientFd : -1;
+        pollArray[2].fd = ((0 <= tcpServerFd) && (NUM_PROXY_TCP_HIGH_WATER > tcpDown.count)) ? tcpServerFd : -1;
+        pollArray[3].fd = udpListenFd;
+        pollArray[4].fd = udpUpstreamFd;
+        for(i = 0;i < sizeof(pollArray) / sizeof(pollArray[0]);++i) {
+
+            pollArray[i].events = POLLIN;
+            pollArray[i].revents = 0;
+        }
+
+        pollCount = poll(pollArray, sizeof(pollArray) / sizeof(pollArray[0]), waitMs);
+        if(0 >= pollCount) {
+
+            continue;
+        }
+        nowNs = getTimeNs();
+
+        /* New control connection replaces the previous one (the drone reconnected) */
+        if(pollArray[0].revents & POLLIN) {
+
+            fd = accept(tcpListenFd, NULL, NULL);
+            if(0 <= fd) {
+
+                if(0 <= tcpClientFd) {
+
+                    close(tcpClientFd);
+                    close(tcpServerFd);
+                    flushLink(&tcpUp);
+                    flushLink(&tcpDown);
+                }
+
+                tcpClientFd = fd;
+                tcpServerFd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+                if((0 > tcpServerFd) || (0 > connect(tcpServerFd, (struct sockaddr*)(&tcpTarget), tcpTargetLength))) {
+
+                    perror("connect");
+                    if(0 <= tcpServerFd) {
+
+                        close(tcpServerFd);
+                    }
+                    close(tcpClientFd);
+                    tcpClientFd = tcpServerFd = -1;
+                }
+                tcpUp.outFd = tcpServerFd;
+                tcpDown.outFd = tcpClientFd;
+            }
+        }
+
+        /* Control messages in both directions */
+        for(i = 1;i <= 2;++i) {
+
+            if((0 > pollArray[i].fd) || !(pollArray[i].revents & (POLLIN | POLLHUP | POLLERR))) {
+
+                continue;
+            }
+
+            length = recv(pollArray[i].fd, buffer, NUM_PROXY_TCP_CHUNK_SIZE, 0);
+            if(0 < length) {
+
+                impairPacket((1 == i) ? &tcpUp : &tcpDown, buffer, (size_t)(length), nowNs);
+            }
+            else if((0 == length) || (EINTR != errno)) {
+
+                /* One side closed: close both */
+                close(tcpClientFd);
+                close(tcpServerFd);
+                tcpClientFd = tcpServerFd = -1;
+                tcpUp.outFd = tcpDown.outFd = -1;
+                flushLink(&tcpUp);
+                flushLink(&tcpDown);
+                break;
+            }
+        }
+
+        /* Video stream from the drone (remember its address for the replies) */
+        if(pollArray[3].revents & POLLIN) {
+
+            udpDown.outAddressLength = sizeof(udpDown.outAddress);
+            length = recvfrom(udpListenFd, buffer, sizeof(buffer), 0, (struct sockaddr*)(&udpDown.outAddress), &udpDown.outAddressLength);
+            if(0 < length) {
+
+                impairPacket(&udpUp, buffer, (size_t)(length), nowNs);
+            }
+        }
+
+        if(pollArray[4].revents & POLLIN) {
+
+            length = recv(udpUpstreamFd, buffer, sizeof(buffer), 0);
+            if((0 < length) && (0 < udpDown.outAddressLength)) {
+
+                impairPacket(&udpDown, buffer, (size_t)(length), nowNs);
+            }
+        }
+    }
+
+    /* Final ground truth */
+    nowNs = getTimeNs();
+    for(i = 0;i < sizeof(links) / sizeof(links[0]);++i) {
+
+        writeLinkStats(truth, links[i], nowNs - startNs);
+        flushLink(links[i]);
+    }
+
+    if(stderr != truth) {
+
+        fclose(truth);
+    }
+
+    return 0;
+}
@@ -0,0 +1,127 @@
+#!/usr/bin/env python3
+"""
+@file        pin_gst_plugins.py
+@author      Adam Csizy
+@date        2021-05-21
+@version     v1.1.0
+
+@brief       Pins the GStreamer plugins of the streamer or the ground control
+
+Creates a plugin directory holding symbolic links to only the plugins
+which provide the elements of the application's pipelines, and writes
+its registry by scanning the directory once. Pointed at the directory
+(CC_GST_PLUGIN_DIR=<DIR> for the streamer, -R <DIR> for the ground
+control) the application loads the pinned registry without scanning or
+validating the system plugin directories (see plugin_utils.h).
+
+Rerun after a GStreamer upgrade: the registry is not checked for stale
+plugins at runtime. Elements the application can do without (hardware
+encoders, video sinks of other display servers) are skipped if missing.
+
+Launch like this (or "make plugins"):
+
+./pin_gst_plugins.py --app <drone|gc> -o <PLUGIN_DIR> [--gst-inspect <PATH>]
+"""
+
+import argparse
+import os
+import subprocess
+import sys
+
+
+REGISTRY_FILE = "registry.bin"              # STR_PLUGIN_REGISTRY_FILE of plugin_utils.h
+
+# Elements of the pipelines (keep in sync with pluginElements of plugin_utils.c), True: optional
+ELEMENTS = {
+    "drone": {
+        "v4l2src": False, "videotestsrc": False, "multifilesrc": False, "capsfilter": False,
+        "identity": False, "jpegenc": False, "jpegparse": False, "h264parse": False,
+        "autovideoconvert": False, "omxh264enc": True, "v4l2h264enc": True, "x264enc": False,
+        "rtph265pay": False, "rtph264pay": False, "rtpvp8pay": False, "rtpvp9pay": False,
+        "rtpjpegpay": False, "rtph263pay": False, "udpsink": True, "tee": False,
+        # Snapshot branch (the stream runs without it)
+        "valve": True, "queue": True, "fakesink": True,
+        # Picked by autovideoconvert at runtime
+        "videoconvert": False, "videoscale": True,
+    },
+    "gc": {
+        "udpsrc": False, "capsfilter": False, "rtph265depay": False, "rtph264depay": False,
+        "rtpvp8depay": False, "rtpvp9depay": False, "rtpjpegdepay": False, "rtph263depay": False,
+        "avdec_h265": False, "avdec_h264": False, "vp8dec": False, "vp9dec": False,
+        "jpegdec": False, "avdec_h263": False, "videoconvert": False, "videoscale": False,
+        "appsink": False, "fakesink": False, "autovideosink": False,
+        # Picked by autovideosink at runtime
+        "xvimagesink": True, "ximagesink": True, "glimagesink": True, "waylandsink": True,
+    },
+}
+
+
+def plugin_file(gst_inspect, element, environment=None):
+    """Return the plugin file providing an element or None."""
+
+    try:
+        output = subprocess.run([gst_inspect, element], stdout=subprocess.PIPE, stderr=subprocess.DEVNULL,
+                                universal_newlines=True, env=environment, check=False).stdout
+    except OSError as error:
+        sys.exit("pin_gst_plugins: %s: %s" % (gst_inspect, error))
+
+    for line in output.splitlines():
+        fields = line.split(None, 1)
+        if 2 == len(fields) and "Filename" == fields[0]:
+            return fields[1].strip()
+    return None
+
+
+def main():
+
+    parser = argparse.ArgumentParser(description="Pin the GStreamer plugins of an application.")
+    parser.add_argument("--app", required=True, choices=sorted(ELEMENTS), help="application of the plugins")
+    parser.add_argument("-o", "--output", required=True, help="plugin directory (created, its links are replaced)")
+    parser.add_argument("--gst-inspect", default="gst-inspect-1.0", help="gst-inspect binary (default: %(default)s)")
+    args = parser.parse_args()
+
+    plugins = set()
+    missing = []
+    for element, optional in sorted(ELEMENTS[args.app].items()):
+        path = plugin_file(args.gst_inspect, element)
+        if path is not None:
+            plugins.add(os.path.realpath(path))
+        elif optional:
+            print("pin_gst_plugins: %s: optional element %s not available, skipped" % (args.app, element), file=sys.stderr)
+        else:
+            missing.append(element)
+
+    if missing:
+        print("pin_gst_plugins: %s: elements not available: %s" % (args.app, " ".join(missing)), file=sys.stderr)
+        return 1
+
+    # Replace the previous links and registry (the registry is trusted without a rescan)
+    os.makedirs(args.output, exist_ok=True)
+    for name in os.listdir(args.output):
+        path = os.path.join(args.output, name)
+        if os.path.islink(path) or REGISTRY_FILE == name:
+            os.remove(path)
+    for path in sorted(plugins):
+        os.symlink(path, os.path.join(args.output, os.path.basename(path)))
+
+    # Scan the pinned plugins once into the pinned registry
+    directory = os.path.abspath(args.output)
+    environment = dict(os.environ,
+                       GST_PLUGIN_SYSTEM_PATH_1_0=directory,
+                       GST_PLUGIN_PATH_1_0="",
+                       GST_REGISTRY_1_0=os.path.join(directory, REGISTRY_FILE),
+                       GST_REGISTRY_FORK="no")
+    for element, optional in sorted(ELEMENTS[args.app].items()):
+        if plugin_file(args.gst_inspect, element, environment) is None and not optional:
+            missing.append(element)
+
+    if missing or not os.path.exists(os.path.join(directory, REGISTRY_FILE)):
+        print("pin_gst_plugins: %s: pinned registry lacks: %s" % (args.app, " ".join(missing) or REGISTRY_FILE), file=sys.stderr)
+        return 1
+
+    print("pin_gst_plugins: %s: %d plugins pinned in %s" % (args.app, len(plugins), directory), file=sys.stderr)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,1308 @@
+/**
+ * @file        rtp_analyzer.c
+ * @author      Adam Csizy
+ * @date        2021-05-17
+ * @version     v1.1.0
+ *
+ * @brief       Offline analyzer of captured RTP video streams
+ */
+
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/*
+ * Compile like this:
+ *
+ * gcc -O2 -Wall rtp_analyzer.c -o rtp_analyzer -lm
+ *
+ * or run "make tools" in the CompanionComputer directory.
+ *
+ * Capture the stream with tcpdump (classic pcap, not pcapng) or let the
+ * ground control dump what it receives (controlapp -d <DUMP_FILE>):
+ *
+ * tcpdump -i any -w stream.pcap udp port 5000
+ * ./rtp_analyzer [-c <CODEC>] [-p <PORT>] [-j <JSON_FILE>] stream.pcap
+ *
+ * A summary is printed per RTP stream (SSRC):
+ *
+ *   loss           expected minus received packets, gap events and the longest gap
+ *   reordering     packets older than the highest sequence number so far, duplicates
+ *   jitter         RFC 3550 interarrival jitter (90 kHz clock of the video payloaders)
+ *   frames         packets with the same timestamp, complete if the first packet
+ *                  starts a frame, the last one has the marker bit and none is missing
+ *   frame gaps     arrival time between the first packets of consecutive frames,
+ *                  stalls are gaps over NUM_STALL_FACTOR frame intervals
+ *   frame sizes    RTP payload bytes per frame
+ *   keyframes      IDR/IRAP, VP8/VP9 key frames (every JPEG frame is one)
+ *   bitrate        RTP bytes per second of arrival
+ *
+ * The payload format is taken from the static payload type (26: JPEG),
+ * otherwise the format the first packets of the stream parse best as
+ * (H.264, H.265, VP8, VP9) unless -c sets it for every stream. -p keeps
+ * the UDP packets to the given port only (pcap captures). -j writes the
+ * report as JSON too, with the bitrate timeline.
+ */
+
+
+#define NUM_MAX_STREAMS             32U         /**< Maximal number of analyzed RTP streams (SSRCs) */
+#define NUM_MAX_PACKET_SIZE         262144U     /**< Largest captured packet */
+#define NUM_CODEC_VOTE_PACKETS      64U         /**< Packets of a stream parsed to guess its payload format */
+#define NUM_FRAME_LOOKBACK          16U         /**< Recent frames a late packet is matched against */
+#define NUM_RTP_HEADER_SIZE         12U         /**< Fixed RTP header size */
+#define NUM_RTP_CLOCK_RATE          90000.0     /**< RTP clock rate of the video payloaders */
+#define NUM_RTP_PT_JPEG             26U         /**< Static payload type of JPEG (RFC 3551) */
+#define NUM_JITTER_GAIN             16.0        /**< Jitter smoothing (RFC 3550) */
+#define NUM_STALL_FACTOR            2.5         /**< Frame gaps above this many nominal frame intervals are stalls */
+#define NUM_NS_PER_SEC              1000000000ULL   /**< Nanoseconds per second */
+#define NUM_TIMELINE_COLUMNS        10U         /**< Bitrate timeline values per printed line */
+#define NUM_PCAP_MAGIC_US           0xA1B2C3D4U /**< pcap magic (microsecond timestamps) */
+#define NUM_PCAP_MAGIC_NS           0xA1B23C4DU /**< pcap magic (nanosecond timestamps) */
+#define NUM_PCAP_HEADER_SIZE        24U         /**< pcap file header size */
+#define NUM_PCAP_RECORD_SIZE        16U         /**< pcap record header size */
+#define NUM_LINKTYPE_NULL           0U          /**< BSD loopback */
+#define NUM_LINKTYPE_ETHERNET       1U          /**< Ethernet */
+#define NUM_LINKTYPE_RAW            101U        /**< Raw IPv4/IPv6 */
+#define NUM_LINKTYPE_LINUX_SLL      113U        /**< Linux cooked capture ("-i any") */
+#define NUM_LINKTYPE_LINUX_SLL2     276U        /**< Linux cooked capture v2 */
+
+/*
+ * Ground control RTP dump layout: must match GroundControl/CLIGroundControl/src/stream_utils.c
+ */
+#define STR_RTP_DUMP_MAGIC          "GCRTPDMP"  /**< RTP dump file magic (without the terminating null) */
+#define NUM_RTP_DUMP_VERSION        1U          /**< RTP dump file version */
+
+
+/* RTP analyzer related type definitions */
+
+/**
+ * @brief   RTP payload formats.
+ */
+typedef enum Codec {
+
+    CODEC_UNKNOWN   = 0,
+    CODEC_H264      = 1,
+    CODEC_H265      = 2,
+    CODEC_VP8       = 3,
+    CODEC_VP9       = 4,
+    CODEC_JPEG      = 5,
+    CODEC_COUNT     = 6
+
+} Codec_T;
+
+/**
+ * @brief   Frame (RTP packets with the same timestamp).
+ */
+typedef struct FrameRecord {
+
+    uint32_t timestamp;             /**< RTP timestamp */
+    uint64_t firstNs;               /**< Arrival of the frame's first packet */
+    uint64_t bytes;                 /**< RTP payload bytes */
+    uint32_t packets;               /**< Received packets */
+    int64_t firstSequence;          /**< Lowest extended sequence number */
+    int64_t lastSequence;           /**< Highest extended sequence number */
+    int marker;                     /**< Flag whether the packet with the marker bit arrived */
+    int start;                      /**< Flag whether the packet starting the frame arrived */
+    int keyframe;                   /**< Flag whether the frame is a key frame */
+
+} FrameRecord_T;
+
+/**
+ * @brief   RTP stream state and statistics.
+ */
+typedef struct RtpStream {
+
+    uint32_t ssrc;                  /**< Synchronization source */
+    uint16_t port;                  /**< UDP destination port (0: unknown) */
+    uint8_t payloadType;            /**< RTP payload type */
+    Codec_T codec;                  /**< Payload format */
+    unsigned int votes[CODEC_COUNT];    /**< Packets parsed as each payload format (first pass) */
+    unsigned int votedPackets;      /**< Packets voted on (first pass) */
+
+    uint64_t packets;               /**< Received packets (duplicates included) */
+    uint64_t bytes;                 /**< Received RTP bytes */
+    uint64_t duplicates;            /**< Duplicate packets */
+    uint64_t reordered;             /**< Packets older than the highest sequence number */
+    uint64_t gapEvents;             /**< Sequence number jumps */
+    int64_t maxGap;                 /**< Longest sequence number jump */
+    int64_t maxReorder;             /**< Largest reordering distance */
+    int64_t baseSequence;           /**< Lowest extended sequence number */
+    int64_t highestSequence;        /**< Highest extended sequence number */
+    uint32_t *seen;                 /**< Extended sequence number + 1 last seen per 16-bit sequence number */
+
+    uint64_t firstNs;               /**< Arrival of the first packet */
+    uint64_t lastNs;                /**< Arrival of the last packet */
+    double jitter;                  /**< RFC 3550 interarrival jitter in RTP clock units */
+    double maxJitter;               /**< Highest jitter */
+    double lastArrival;             /**< Arrival of the previous packet in RTP clock units */
+    uint32_t lastTimestamp;         /**< RTP timestamp of the previous packet */
+
+    FrameRecord_T *frames;          /**< Frames in order of arrival */
+    size_t frameCount;              /**< Number of frames */
+    size_t frameCapacity;           /**< Allocated frames */
+    uint64_t *secondBytes;          /**< RTP bytes per second of arrival */
+    size_t secondCount;             /**< Number of seconds */
+
+} RtpStream_T;
+
+/**
+ * @brief   Packet handler of the capture reader.
+ */
+typedef void (*PacketHandler_T)(uint64_t arrivalNs, uint16_t port, const uint8_t *data, size_t length);
+
+
+/* RTP analyzer related static variable declarations */
+
+static const char *const codecNames[CODEC_COUNT] = {"unknown", "h264", "h265", "vp8", "vp9", "jpeg"};
+static RtpStream_T streams[NUM_MAX_STREAMS];    /**< Analyzed streams */
+static size_t streamCount = 0;                  /**< Number of analyzed streams */
+static uint64_t ignoredPackets = 0;             /**< Packets of streams over NUM_MAX_STREAMS */
+static Codec_T forcedCodec = CODEC_UNKNOWN;     /**< Payload format of every stream (-c) */
+static int portFilter = -1;                     /**< UDP destination port filter (-p) */
+
+
+/* RTP analyzer related function definitions */
+
+/**
+ * @brief       Read a 16-bit big-endian value.
+ */
+static uint16_t readBe16(const uint8_t *data) {
+
+    return (uint16_t)(((uint16_t)(data[0]) << 8) | data[1]);
+}
+
+/**
+ * @brief       Read a 32-bit big-endian value.
+ */
+static uint32_t readBe32(const uint8_t *data) {
+
+    return ((uint32_t)(data[0]) << 24) | ((uint32_t)(data[1]) << 16) | ((uint32_t)(data[2]) << 8) | data[3];
+}
+
+/**
+ * @brief       Read a 32-bit pcap header field.
+ *
+ * @param[in]   data Field.
+ * @param[in]   swapped Flag whether the capture has the other byte order.
+ */
+static uint32_t readPcap32(const uint8_t *data, const int swapped) {
+
+    uint32_t value;
+
+    memcpy(&value, data, sizeof(value));
+    if(swapped) {
+
+        value = ((value & 0xFFU) << 24) | ((value & 0xFF00U) << 8) | ((value >> 8) & 0xFF00U) | (value >> 24);
+    }
+
+    return value;
+}
+
+/**
+ * @brief       Parse a payload as the given format.
+ *
+ * @details     Finds out whether the packet starts a frame and
+ *              whether the frame is a key frame. The checks are
+ *              strict enough to tell the formats apart on the
+ *              first packets of a stream (see NUM_CODEC_VOTE_PACKETS).
+ *
+ * @param[in]   codec Payload format.
+ * @param[in]   payload RTP payload.
+ * @param[in]   length RTP payload length.
+ * @param[out]  start Flag whether the packet starts a frame.
+ * @param[out]  keyframe Flag whether the packet belongs to a key frame.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Valid payload of the format
+ * @retval      -1 Invalid payload
+ */
+static int parsePayload(const Codec_T codec, const uint8_t *payload, const size_t length, int *start, int *keyframe) {
+
+    size_t offset;
+    unsigned int type;
+
+    *start = 0;
+    *keyframe = 0;
+
+    switch(codec) {
+
+        case CODEC_H264:
+
+            /* Forbidden bit clear, single NAL (1-23), STAP-A (24) or FU-A (28) */
+            if((2 > length) || (payload[0] & 0x80U)) {
+
+                return -1;
+            }
+            type = payload[0] & 0x1FU;
+            if((1U <= type) && (23U >= type)) {
+
+                *start = 1;
+                *keyframe = ((5U == type) || (7U == type));
+            }
+            else if(24U == type) {
+
+                *start = 1;
+                for(offset = 1;offset + 2 < length;offset += 2 + readBe16(&payload[offset])) {
+
+                    type = payload[offset + 2] & 0x1FU;
+                    *keyframe |= ((5U == type) || (7U == type));
+                }
+            }
+            else if(28U == type) {
+
+                *start = (0 != (payload[1] & 0x80U));
+                type = payload[1] & 0x1FU;
+                *keyframe = (5U == type);
+                if((0U == type) || (23U < type)) {
+
+                    return -1;
+                }
+            }
+            else {
+
+                return -1;
+            }
+            break;
+
+        case CODEC_H265:
+
+            /* Forbidden bit and layer ID clear, temporal ID above 0, single NAL (0-47), AP (48) or FU (49) */
+            if((3 > length) || (payload[0] & 0x81U) || (0U == (payload[1] & 0x07U))) {
+
+                return -1;
+            }
+            type = (payload[0] >> 1) & 0x3FU;
+            if(48U > type) {
+
+                *start = 1;
+                *keyframe = (((16U <= type) && (21U >= type)) || (32U == type) || (33U == type));
+            }
+            else if(48U == type) {
+
+                *start = 1;
+                for(offset = 2;offset + 2 < length;offset += 2 + readBe16(&payload[offset])) {
+
+                    type = (payload[offset + 2] >> 1) & 0x3FU;
+                    *keyframe |= (((16U <= type) && (21U >= type)) || (32U == type) || (33U == type));
+                }
+            }
+            else if(49U == type) {
+
+                *start = (0 != (payload[2] & 0x80U));
+                type = payload[2] & 0x3FU;
+                *keyframe = ((16U <= type) && (21U >= type));
+                if(47U < type) {
+
+                    return -1;
+                }
+            }
+            else {
+
+                return -1;
+            }
+            break;
+
+        case CODEC_VP8:
+
+            /* Payload descriptor (reserved bit clear), optional extensions, then the VP8 payload header */
+            if((2 > length) || (payload[0] & 0x40U) || (7U < (payload[0] & 0x0FU))) {
+
+                return -1;
+            }
+            offset = 1;
+            if(payload[0] & 0x80U) {
+
+                offset = 2;
+                if(payload[1] & 0x80U) {
+
+                    offset += ((length > offset) && (payload[offset] & 0x80U)) ? 2 : 1;
+                }
+                if(payload[1] & 0x40U) {
+
+                    ++offset;
+                }
+                if(payload[1] & 0x30U) {
+
+                    ++offset;
+                }
+            }
+            if(offset >= length) {
+
+                return -1;
+            }
+            *start = ((0 != (payload[0] & 0x10U)) && (0U == (payload[0] & 0x07U)));
+            *keyframe = (*start && (0U == (payload[offset] & 0x01U)));
+            break;
+
+        case CODEC_VP9:
+
+            /* Payload descriptor: B starts a frame, P clear on key frames */
+            if(2 > length) {
+
+                return -1;
+            }
+            *start = (0 != (payload[0] & 0x08U));
+            *keyframe = (*start && (0U == (payload[0] & 0x40U)));
+            break;
+
+        case CODEC_JPEG:
+
+            /* Main JPEG header (8 bytes): the fragment offset is 0 on the first packet */
+            if(8 > length) {
+
+                return -1;
+            }
+            *start = (0U == (readBe32(payload) & 0x00FFFFFFU));
+            *keyframe = 1;
+            break;
+
+        default:
+
+            *start = 1;
+            break;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief       Parse an RTP packet.
+ *
+ * @param[in]   data UDP payload.
+ * @param[in]   length UDP payload length.
+ * @param[out]  payloadOffset Offset of the RTP payload.
+ * @param[out]  payloadLength Length of the RTP payload (padding excluded).
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 RTP packet
+ * @retval      -1 Not an RTP packet (or RTCP)
+ */
+static int parseRtp(const uint8_t *data, const size_t length, size_t *payloadOffset, size_t *payloadLength) {
+
+    size_t offset, padding = 0;
+    unsigned int payloadType;
+
+    if((NUM_RTP_HEADER_SIZE > length) || (2U != (data[0] >> 6))) {
+
+        return -1;
+    }
+
+    /* RTCP sender/receiver reports, SDES, BYE and APP share the version */
+    payloadType = data[1] & 0x7FU;
+    if((72U <= payloadType) && (76U >= payloadType)) {
+
+        return -1;
+    }
+
+    offset = NUM_RTP_HEADER_SIZE + 4U * (data[0] & 0x0FU);
+    if((data[0] & 0x10U) && (offset + 4 <= length)) {
+
+        offset += 4U + 4U * readBe16(&data[offset + 2]);
+    }
+    if(data[0] & 0x20U) {
+
+        padding = data[length - 1];
+    }
+    if(offset + padding > length) {
+
+        return -1;
+    }
+
+    *payloadOffset = offset;
+    *payloadLength = length - offset - padding;
+
+    return 0;
+}
+
+/**
+ * @brief       Get the stream of an SSRC.
+ *
+ * @param[in]   ssrc Synchronization source.
+ * @param[in]   port UDP destination port.
+ * @param[in]   payloadType RTP payload type.
+ *
+ * @return      Stream or NULL (too many streams).
+ */
+static RtpStream_T* getStream(const uint32_t ssrc, const uint16_t port, const uint8_t payloadType) {
+
+    size_t i;
+    RtpStream_T *stream = NULL;
+
+    for(i = 0;i < streamCount;++i) {
+
+        if((streams[i].ssrc == ssrc) && (streams[i].port == port)) {
+
+            return &streams[i];
+        }
+    }
+
+    if(NUM_MAX_STREAMS <= streamCount) {
+
+        return NULL;
+    }
+
+    stream = &streams[streamCount++];
+    memset(stream, 0, sizeof(RtpStream_T));
+    stream->ssrc = ssrc;
+    stream->port = port;
+    stream->payloadType = payloadType;
+
+    return stream;
+}
+
+/**
+ * @brief       First pass packet handler: payload format votes.
+ */
+static void votePacket(uint64_t arrivalNs, uint16_t port, const uint8_t *data, size_t length) {
+
+    int codec, start, keyframe;
+    size_t payloadOffset, payloadLength;
+    RtpStream_T *stream = NULL;
+
+    if(((0 <= portFilter) && (0U != port) && (port != (uint16_t)(portFilter))) || parseRtp(data, length, &payloadOffset, &payloadLength)) {
+
+        return;
+    }
+
+    stream = getStream(readBe32(&data[8]), port, data[1] & 0x7FU);
+    if((NULL == stream) || (NUM_CODEC_VOTE_PACKETS <= stream->votedPackets) || (0U == payloadLength)) {
+
+        return;
+    }
+
+    ++stream->votedPackets;
+    for(codec = CODEC_H264;codec < CODEC_COUNT;++codec) {
+
+        if(0 == parsePayload((Codec_T)(codec), &data[payloadOffset], payloadLength, &start, &keyframe)) {
+
+            ++stream->votes[codec];
+        }
+    }
+}
+
+/**
+ * @brief       Choose the payload format of every stream.
+ *
+ * @details     -c wins, then the static JPEG payload type, then
+ *              the dynamic formats in order of the first pass votes
+ *              (ties go to the earlier format: H.264, H.265, VP8, VP9).
+ */
+static void chooseCodecs(void) {
+
+    size_t i;
+    int codec;
+    Codec_T chosen;
+    RtpStream_T *stream = NULL;
+
+    for(i = 0;i < streamCount;++i) {
+
+        stream = &streams[i];
+        chosen = CODEC_UNKNOWN;
+        if(CODEC_UNKNOWN != forcedCodec) {
+
+            chosen = forcedCodec;
+        }
+        else if(NUM_RTP_PT_JPEG == stream->payloadType) {
+
+            chosen = CODEC_JPEG;
+        }
+        else {
+
+            for(codec = CODEC_H264;codec < CODEC_JPEG;++codec) {
+
+                if((0U < stream->votes[codec]) && ((CODEC_UNKNOWN == chosen) || (stream->votes[codec] > stream->votes[chosen]))) {
+
+                    chosen = (Codec_T)(codec);
+                }
+            }
+        }
+
+        /* The second pass starts over with the stream's format */
+        memset(stream->votes, 0, sizeof(stream->votes));
+        stream->votedPackets = 0;
+        stream->codec = chosen;
+    }
+}
+
+/**
+ * @brief       Second pass packet handler: statistics.
+ */
+static void analyzePacket(uint64_t arrivalNs, uint16_t port, const uint8_t *data, size_t length) {
+
+    int start, keyframe;
+    int duplicate = 0;
+    int64_t sequence, delta;
+    size_t i, second, payloadOffset, payloadLength;
+    uint32_t timestamp;
+    uint16_t sequence16;
+    double arrival, difference;
+    RtpStream_T *stream = NULL;
+    FrameRecord_T *frame = NULL;
+    void *grown = NULL;
+
+    if(((0 <= portFilter) && (0U != port) && (port != (uint16_t)(portFilter))) || parseRtp(data, length, &payloadOffset, &payloadLength)) {
+
+        return;
+    }
+
+    stream = getStream(readBe32(&data[8]), port, data[1] & 0x7FU);
+    if(NULL == stream) {
+
+        ++ignoredPackets;
+        return;
+    }
+
+    sequence16 = readBe16(&data[2]);
+    timestamp = readBe32(&data[4]);
+    arrival = (double)(arrivalNs) * NUM_RTP_CLOCK_RATE / (double)(NUM_NS_PER_SEC);
+
+    if(NULL == stream->seen) {
+
+        stream->seen = calloc(65536U, sizeof(uint32_t));
+        if(NULL == stream->seen) {
+
+            ++ignoredPackets;
+            return;
+        }
+    }
+
+    /* Sequence numbers: extend to 64 bits around the highest one */
+    if(0U == stream->packets) {
+
+        sequence = 65536 + sequence16;
+        stream->baseSequence = sequence;
+        stream->highestSequence = sequence;
+        stream->firstNs = arrivalNs;
+    }
+    else {
+
+        sequence = stream->highestSequence + (int16_t)(uint16_t)(sequence16 - (uint16_t)(stream->highestSequence));
+        if(sequence > stream->highestSequence) {
+
+            delta = sequence - stream->highestSequence - 1;
+            if(0 < delta) {
+
+                ++stream->gapEvents;
+                stream->maxGap = (delta > stream->maxGap) ? delta : stream->maxGap;
+            }
+            stream->highestSequence = sequence;
+        }
+        else if(stream->seen[sequence16] == (uint32_t)(sequence + 1)) {
+
+            ++stream->duplicates;
+            duplicate = 1;
+        }
+        else {
+
+            ++stream->reordered;
+            delta = stream->highestSequence - sequence;
+            stream->maxReorder = (delta > stream->maxReorder) ? delta : stream->maxReorder;
+            stream->baseSequence = (sequence < stream->baseSequence) ? sequence : stream->baseSequence;
+        }
+
+        /* RFC 3550 interarrival jitter */
+        difference = fabs((arrival - stream->lastArrival) - (double)((int32_t)(timestamp - stream->lastTimestamp)));
+        stream->jitter += (difference - stream->jitter) / NUM_JITTER_GAIN;
+        stream->maxJitter = (stream->jitter > stream->maxJitter) ? stream->jitter : stream->maxJitter;
+    }
+    stream->seen[sequence16] = (uint32_t)(sequence + 1);
+    stream->lastArrival = arrival;
+    stream->lastTimestamp = timestamp;
+    stream->lastNs = arrivalNs;
+    ++stream->packets;
+    stream->bytes += length;
+
+    /* Bitrate timeline */
+    second = (size_t)((arrivalNs - stream->firstNs) / NUM_NS_PER_SEC);
+    if(second >= stream->secondCount) {
+
+        grown = realloc(stream->secondBytes, (second + 1) * sizeof(uint64_t));
+        if(NULL == grown) {
+
+            return;
+        }
+        stream->secondBytes = grown;
+        memset(&stream->secondBytes[stream->secondCount], 0, (second + 1 - stream->secondCount) * sizeof(uint64_t));
+        stream->secondCount = second + 1;
+    }
+    stream->secondBytes[second] += length;
+
+    if(duplicate) {
+
+        return;
+    }
+
+    /* Frames: packets with the same timestamp (late packets join a recent frame) */
+    for(i = stream->frameCount;(i > 0) && (i + NUM_FRAME_LOOKBACK > stream->frameCount);--i) {
+
+        if(stream->frames[i - 1].timestamp == timestamp) {
+
+            frame = &stream->frames[i - 1];
+            break;
+        }
+    }
+    if(NULL == frame) {
+
+        if(stream->frameCount == stream->frameCapacity) {
+
+            grown = realloc(stream->frames, (stream->frameCapacity ? 2 * stream->frameCapacity : 1024) * sizeof(FrameRecord_T));
+            if(NULL == grown) {
+
+                return;
+            }
+            stream->frames = grown;
+            stream->frameCapacity = stream->frameCapacity ? 2 * stream->frameCapacity : 1024;
+        }
+        frame = &stream->frames[stream->frameCount++];
+        memset(frame, 0, sizeof(FrameRecord_T));
+        frame->timestamp = timestamp;
+        frame->firstNs = arrivalNs;
+        frame->firstSequence = sequence;
+        frame->lastSequence = sequence;
+    }
+
+    ++frame->packets;
+    frame->bytes += payloadLength;
+    frame->firstSequence = (sequence < frame->firstSequence) ? sequence : frame->firstSequence;
+    frame->lastSequence = (sequence > frame->lastSequence) ? sequence : frame->lastSequence;
+    frame->marker |= (0 != (data[1] & 0x80U));
+    if(0 == parsePayload(stream->codec, &data[payloadOffset], payloadLength, &start, &keyframe)) {
+
+        frame->start |= start;
+        frame->keyframe |= keyframe;
+    }
+}
+
+/**
+ * @brief       Decode a link layer frame down to the UDP payload.
+ *
+ * @param[in]   linkType pcap link type.
+ * @param[in]   data Captured frame.
+ * @param[in]   length Captured length.
+ * @param[out]  port UDP destination port.
+ * @param[out]  payloadOffset Offset of the UDP payload.
+ * @param[out]  payloadLength Length of the UDP payload.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 UDP datagram
+ * @retval      -1 Other traffic (or a fragment)
+ */
+static int decodeFrame(const uint32_t linkType, const uint8_t *data, const size_t length, uint16_t *port, size_t *payloadOffset, size_t *payloadLength) {
+
+    size_t offset = 0;
+    size_t udpLength;
+    unsigned int etherType = 0;
+    uint32_t family;
+
+    switch(linkType) {
+
+        case NUM_LINKTYPE_NULL:
+
+            /* Address family in the capturing host's byte order */
+            if(4 > length) {
+
+                return -1;
+            }
+            memcpy(&family, data, sizeof(family));
+            etherType = ((2U == family) || (0x02000000U == family)) ? 0x0800U : 0x86DDU;
+            offset = 4;
+            break;
+
+        case NUM_LINKTYPE_ETHERNET:
+
+            if(14 > length) {
+
+                return -1;
+            }
+            etherType = readBe16(&data[12]);
+            offset = 14;
+            if((0x8100U == etherType) && (18 <= length)) {
+
+                etherType = readBe16(&data[16]);
+                offset = 18;
+            }
+            break;
+
+        case NUM_LINKTYPE_RAW:
+
+            if(1 > length) {
+
+                return -1;
+            }
+            etherType = (4U == (data[0] >> 4)) ? 0x0800U : 0x86DDU;
+            break;
+
+        case NUM_LINKTYPE_LINUX_SLL:
+
+            if(16 > length) {
+
+                return -1;
+            }
+            etherType = readBe16(&data[14]);
+            offset = 16;
+            break;
+
+        case NUM_LINKTYPE_LINUX_SLL2:
+
+            if(20 > length) {
+
+                return -1;
+            }
+            etherType = readBe16(&data[0]);
+            offset = 20;
+            break;
+
+        default:
+
+            return -1;
+    }
+
+    if((0x0800U == etherType) && (offset + 20 <= length) && (4U == (data[offset] >> 4))) {
+
+        /* IPv4: UDP, no fragments */
+        if((17U != data[offset + 9]) || (readBe16(&data[offset + 6]) & 0x3FFFU)) {
+
+            return -1;
+        }
+        offset += 4U * (data[offset] & 0x0FU);
+    }
+    else if((0x86DDU == etherType) && (offset + 40 <= length) && (6U == (data[offset] >> 4))) {
+
+        /* IPv6: UDP right after the fixed header */
+        if(17U != data[offset + 6]) {
+
+            return -1;
+        }
+        offset += 40;
+    }
+    else {
+
+        return -1;
+    }
+
+    if(offset + 8 > length) {
+
+        return -1;
+    }
+    udpLength = readBe16(&data[offset + 4]);
+    if((8 > udpLength) || (offset + udpLength > length)) {
+
+        return -1;
+    }
+
+    *port = readBe16(&data[offset + 2]);
+    *payloadOffset = offset + 8;
+    *payloadLength = udpLength - 8;
+
+    return 0;
+}
+
+/**
+ * @brief       Read a capture file.
+ *
+ * @details     Reads classic pcap captures (both byte orders,
+ *              microsecond and nanosecond timestamps) and RTP
+ *              dumps of the ground control, and passes every
+ *              UDP payload to the handler.
+ *
+ * @param[in]   path Capture file.
+ * @param[in]   handler Packet handler.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+static int readCapture(const char *path, const PacketHandler_T handler) {
+
+    int retval = 0;
+    int swapped = 0;
+    int nanoseconds = 0;
+    uint8_t header[NUM_PCAP_HEADER_SIZE];
+    uint8_t record[NUM_PCAP_RECORD_SIZE];
+    uint32_t magic, linkType, captured, version[2];
+    uint64_t arrivalNs;
+    uint16_t port;
+    size_t payloadOffset, payloadLength;
+    static uint8_t packet[NUM_MAX_PACKET_SIZE];
+    FILE *file = NULL;
+
+    file = fopen(path, "rb");
+    if(NULL == file) {
+
+        perror(path);
+        retval = -1;
+        return retval;
+    }
+
+    if(1 != fread(header, 8, 1, file)) {
+
+        fprintf(stderr, "%s: empty or truncated capture\n", path);
+        fclose(file);
+        retval = -1;
+        return retval;
+    }
+
+    if(0 == memcmp(header, STR_RTP_DUMP_MAGIC, strlen(STR_RTP_DUMP_MAGIC))) {
+
+        /* Ground control RTP dump (host byte order) */
+        if((1 != fread(version, sizeof(version), 1, file)) || (NUM_RTP_DUMP_VERSION != version[0])) {
+
+            fprintf(stderr, "%s: unsupported RTP dump version\n", path);
+            fclose(file);
+            retval = -1;
+            return retval;
+        }
+
+        while((1 == fread(&arrivalNs, sizeof(arrivalNs), 1, file)) && (1 == fread(&captured, sizeof(captured), 1, file))) {
+
+            if((NUM_MAX_PACKET_SIZE < captured) || ((0U < captured) && (1 != fread(packet, captured, 1, file)))) {
+
+                fprintf(stderr, "%s: truncated RTP dump record\n", path);
+                break;
+            }
+            handler(arrivalNs, 0U, packet, captured);
+        }
+
+        fclose(file);
+        return retval;
+    }
+
+    memcpy(&magic, header, sizeof(magic));
+    if((NUM_PCAP_MAGIC_US == magic) || (NUM_PCAP_MAGIC_NS == magic)) {
+
+        nanoseconds = (NUM_PCAP_MAGIC_NS == magic);
+    }
+    else if((NUM_PCAP_MAGIC_US == readPcap32(header, 1)) || (NUM_PCAP_MAGIC_NS == readPcap32(header, 1))) {
+
+        swapped = 1;
+        nanoseconds = (NUM_PCAP_MAGIC_NS == readPcap32(header, 1));
+    }
+    else {
+
+        fprintf(stderr, "%s: not a pcap capture or RTP dump (pcapng: convert with \"editcap -F pcap\")\n", path);
+        fclose(file);
+        retval = -1;
+        return retval;
+    }
+
+    if(1 != fread(&header[8], NUM_PCAP_HEADER_SIZE - 8, 1, file)) {
+
+        fprintf(stderr, "%s: truncated pcap header\n", path);
+        fclose(file);
+        retval = -1;
+        return retval;
+    }
+    linkType = readPcap32(&header[20], swapped) & 0x0FFFFFFFU;
+
+    while(1 == fread(record, NUM_PCAP_RECORD_SIZE, 1, file)) {
+
+        captured = readPcap32(&record[8], swapped);
+        if((NUM_MAX_PACKET_SIZE < captured) || ((0U < captured) && (1 != fread(packet, captured, 1, file)))) {
+
+            fprintf(stderr, "%s: truncated pcap record\n", path);
+            break;
+        }
+
+        arrivalNs = (uint64_t)(readPcap32(record, swapped)) * NUM_NS_PER_SEC +
+            (uint64_t)(readPcap32(&record[4], swapped)) * (nanoseconds ? 1ULL : 1000ULL);
+        if(0 == decodeFrame(linkType, packet, captured, &port, &payloadOffset, &payloadLength)) {
+
+            handler(arrivalNs, port, &packet[payloadOffset], payloadLength);
+        }
+    }
+
+    fclose(file);
+
+    return retval;
+}
+
+/**
+ * @brief       Compare doubles (qsort).
+ */
+static int compareDoubles(const void *a, const void *b) {
+
+    const double x = *(const double*)a;
+    const double y = *(const double*)b;
+
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief       Get a percentile (nearest rank).
+ *
+ * @param[in,out]   values Values (sorted in place).
+ * @param[in]   count Number of values.
+ * @param[in]   percentile Percentile (0-100).
+ *
+ * @return      Percentile or 0 without values.
+ */
+static double getPercentile(double *values, const size_t count, const double percentile) {
+
+    size_t rank;
+
+    if(0 == count) {
+
+        return 0.0;
+    }
+
+    qsort(values, count, sizeof(double), compareDoubles);
+    rank = (size_t)(ceil(percentile / 100.0 * (double)(count)));
+
+    return values[(0 < rank) ? rank - 1 : 0];
+}
+
+/**
+ * @brief       Frame statistics of a stream.
+ */
+typedef struct FrameSummary {
+
+    size_t complete;                /**< Complete frames */
+    double nominalMs;               /**< Nominal frame interval (median timestamp step) */
+    double sizeMin, sizeMedian, sizeP95, sizeMax;   /**< Frame sizes in bytes */
+    double gapMedian, gapP99, gapMax;               /**< Frame gaps in ms */
+    size_t stalls;                  /**< Frame gaps over NUM_STALL_FACTOR nominal intervals */
+    double stallMs;                 /**< Total time of the stalls beyond the nominal interval */
+    size_t keyframes;               /**< Key frames */
+    double keyIntervalFrames;       /**< Mean key frame interval in frames */
+    double keyIntervalMaxFrames;    /**< Longest key frame interval in frames */
+    double keyIntervalSec;          /**< Mean key frame interval in seconds (timestamps) */
+    double kbpsMin, kbpsMean, kbpsMax;  /**< Bitrate per second of arrival (last partial second excluded) */
+
+} FrameSummary_T;
+
+/**
+ * @brief       Summarize the frames and the bitrate of a stream.
+ *
+ * @param[in]   stream RTP stream.
+ * @param[out]  summary Frame statistics.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure (out of memory)
+ */
+static int summarizeFrames(const RtpStream_T *stream, FrameSummary_T *summary) {
+
+    size_t i, count = stream->frameCount;
+    size_t lastKey = 0, keyIntervals = 0, seconds;
+    uint32_t lastKeyTimestamp = 0;
+    double *values = NULL;
+    double keyFramesSum = 0.0, keySecondsSum = 0.0, kbps;
+    const FrameRecord_T *frame = NULL;
+
+    memset(summary, 0, sizeof(FrameSummary_T));
+    values = malloc((count ? count : 1) * sizeof(double));
+    if(NULL == values) {
+
+        return -1;
+    }
+
+    for(i = 0;i < count;++i) {
+
+        frame = &stream->frames[i];
+        if(frame->marker && frame->start && ((int64_t)(frame->packets) >= frame->lastSequence - frame->firstSequence + 1)) {
+
+            ++summary->complete;
+        }
+        if(frame->keyframe) {
+
+            if(0 < summary->keyframes) {
+
+                keyFramesSum += (double)(i - lastKey);
+                keySecondsSum += (double)(frame->timestamp - lastKeyTimestamp) / NUM_RTP_CLOCK_RATE;
+                summary->keyIntervalMaxFrames = ((double)(i - lastKey) > summary->keyIntervalMaxFrames) ? (double)(i - lastKey) : summary->keyIntervalMaxFrames;
+                ++keyIntervals;
+            }
+            ++summary->keyframes;
+            lastKey = i;
+            lastKeyTimestamp = frame->timestamp;
+        }
+        values[i] = (double)(frame->bytes);
+    }
+    if(0 < keyIntervals) {
+
+        summary->keyIntervalFrames = keyFramesSum / (double)(keyIntervals);
+        summary->keyIntervalSec = keySecondsSum / (double)(keyIntervals);
+    }
+
+    summary->sizeMedian = getPercentile(values, count, 50.0);
+    summary->sizeP95 = getPercentile(values, count, 95.0);
+    summary->sizeMin = count ? values[0] : 0.0;
+    summary->sizeMax = count ? values[count - 1] : 0.0;
+
+    /* Nominal interval: median forward timestamp step */
+    for(i = 1;i < count;++i) {
+
+        values[i - 1] = (double)((int32_t)(stream->frames[i].timestamp - stream->frames[i - 1].timestamp)) / NUM_RTP_CLOCK_RATE * 1e3;
+    }
+    summary->nominalMs = getPercentile(values, count ? count - 1 : 0, 50.0);
+
+    /* Frame gaps: arrival of consecutive frames */
+    for(i = 1;i < count;++i) {
+
+        values[i - 1] = (double)(stream->frames[i].firstNs - stream->frames[i - 1].firstNs) / 1e6;
+        if((0.0 < summary->nominalMs) && (values[i - 1] > NUM_STALL_FACTOR * summary->nominalMs)) {
+
+            ++summary->stalls;
+            summary->stallMs += values[i - 1] - summary->nominalMs;
+        }
+    }
+    summary->gapMedian = getPercentile(values, count ? count - 1 : 0, 50.0);
+    summary->gapP99 = getPercentile(values, count ? count - 1 : 0, 99.0);
+    summary->gapMax = (1 < count) ? values[count - 2] : 0.0;
+
+    /* Bitrate of the full seconds */
+    seconds = (1 < stream->secondCount) ? stream->secondCount - 1 : stream->secondCount;
+    for(i = 0;i < seconds;++i) {
+
+        kbps = (double)(stream->secondBytes[i]) * 8.0 / 1e3;
+        summary->kbpsMin = ((0 == i) || (kbps < summary->kbpsMin)) ? kbps : summary->kbpsMin;
+        summary->kbpsMax = (kbps > summary->kbpsMax) ? kbps : summary->kbpsMax;
+        summary->kbpsMean += kbps / (double)(seconds);
+    }
+
+    free(values);
+
+    return 0;
+}
+
+/**
+ * @brief       Print the report of a stream.
+ *
+ * @param[in]   stream RTP stream.
+ * @param[in]   summary Frame statistics.
+ * @param[in]   index Stream index.
+ */
+static void printStream(const RtpStream_T *stream, const FrameSummary_T *summary, const size_t index) {
+
+    size_t i;
+    int64_t expected = stream->highestSequence - stream->baseSequence + 1;
+    int64_t lost = expected - (int64_t)(stream->packets - stream->duplicates);
+    double duration = (double)(stream->lastNs - stream->firstNs) / 1e9;
+
+    printf("Stream %zu: SSRC 0x%08" PRIx32 " PT %u (%s)", index + 1, stream->ssrc, (unsigned int)(stream->payloadType), codecNames[stream->codec]);
+    if(0U != stream->port) {
+
+        printf(" port %u", (unsigned int)(stream->port));
+    }
+    printf("\n");
+    printf("  duration      %.2f s, %" PRIu64 " packets, %.2f MB, %.1f kbps mean\n", duration, stream->packets,
+        (double)(stream->bytes) / 1e6, (0.0 < duration) ? (double)(stream->bytes) * 8.0 / 1e3 / duration : 0.0);
+    printf("  loss          %" PRId64 " of %" PRId64 " expected (%.3f %%), %" PRIu64 " gap events, longest gap %" PRId64 " packets\n",
+        lost, expected, (0 < expected) ? 100.0 * (double)(lost) / (double)(expected) : 0.0, stream->gapEvents, stream->maxGap);
+    printf("  reordering    %" PRIu64 " reordered (max distance %" PRId64 "), %" PRIu64 " duplicates\n",
+        stream->reordered, stream->maxReorder, stream->duplicates);
+    printf("  jitter        %.2f ms at the end, %.2f ms max\n", stream->jitter / NUM_RTP_CLOCK_RATE * 1e3, stream->maxJitter / NUM_RTP_CLOCK_RATE * 1e3);
+    printf("  frames        %zu (%zu complete, %zu incomplete), nominal interval %.1f ms\n",
+        stream->frameCount, summary->complete, stream->frameCount - summary->complete, summary->nominalMs);
+    printf("  frame size    min %.0f, median %.0f, p95 %.0f, max %.0f bytes\n", summary->sizeMin, summary->sizeMedian, summary->sizeP95, summary->sizeMax);
+    printf("  frame gap     median %.1f ms, p99 %.1f ms, max %.1f ms, %zu stalls (%.1f ms lost)\n",
+        summary->gapMedian, summary->gapP99, summary->gapMax, summary->stalls, summary->stallMs);
+    printf("  keyframes     %zu, interval mean %.1f frames (%.2f s), max %.0f frames\n",
+        summary->keyframes, summary->keyIntervalFrames, summary->keyIntervalSec, summary->keyIntervalMaxFrames);
+    printf("  bitrate       min %.1f, mean %.1f, max %.1f kbps per second\n", summary->kbpsMin, summary->kbpsMean, summary->kbpsMax);
+    for(i = 0;i < stream->secondCount;++i) {
+
+        printf("%s%8.0f", (0 == i % NUM_TIMELINE_COLUMNS) ? "    " : "", (double)(stream->secondBytes[i]) * 8.0 / 1e3);
+        if((NUM_TIMELINE_COLUMNS - 1 == i % NUM_TIMELINE_COLUMNS) || (stream->secondCount - 1 == i)) {
+
+            printf("\n");
+        }
+    }
+}
+
+/**
+ * @brief       Write the report of a stream as a JSON object.
+ *
+ * @param[in,out]   json JSON file.
+ * @param[in]   stream RTP stream.
+ * @param[in]   summary Frame statistics.
+ */
+static void writeStreamJson(FILE *json, const RtpStream_T *stream, const FrameSummary_T *summary) {
+
+    size_t i;
+    int64_t expected = stream->highestSequence - stream->baseSequence + 1;
+
+    fprintf(json, "    {\"ssrc\": %" PRIu32 ", \"port\": %u, \"payload_type\": %u, \"codec\": \"%s\", ",
+        stream->ssrc, (unsigned int)(stream->port), (unsigned int)(stream->payloadType), codecNames[stream->codec]);
+    fprintf(json, "\"duration_s\": %.3f, \"packets\": %" PRIu64 ", \"bytes\": %" PRIu64 ", ",
+        (double)(stream->lastNs - stream->firstNs) / 1e9, stream->packets, stream->bytes);
+    fprintf(json, "\"expected\": %" PRId64 ", \"lost\": %" PRId64 ", \"gap_events\": %" PRIu64 ", \"max_gap\": %" PRId64 ", ",
+        expected, expected - (int64_t)(stream->packets - stream->duplicates), stream->gapEvents, stream->maxGap);
+    fprintf(json, "\"reordered\": %" PRIu64 ", \"max_reorder\": %" PRId64 ", \"duplicates\": %" PRIu64 ", ",
+        stream->reordered, stream->maxReorder, stream->duplicates);
+    fprintf(json, "\"jitter_ms\": %.3f, \"max_jitter_ms\": %.3f, ",
+        stream->jitter / NUM_RTP_CLOCK_RATE * 1e3, stream->maxJitter / NUM_RTP_CLOCK_RATE * 1e3);
+    fprintf(json, "\"frames\": %zu, \"complete_frames\": %zu, \"nominal_interval_ms\": %.3f, ",
+        stream->frameCount, summary->complete, summary->nominalMs);
+    fprintf(json, "\"frame_size\": {\"min\": %.0f, \"median\": %.0f, \"p95\": %.0f, \"max\": %.0f}, ",
+        summary->sizeMin, summary->sizeMedian, summary->sizeP95, summary->sizeMax);
+    fprintf(json, "\"frame_gap_ms\": {\"median\": %.3f, \"p99\": %.3f, \"max\": %.3f}, \"stalls\": %zu, \"stall_ms\": %.3f, ",
+        summary->gapMedian, summary->gapP99, summary->gapMax, summary->stalls, summary->stallMs);
+    fprintf(json, "\"keyframes\": %zu, \"keyframe_interval_frames\": %.2f, \"keyframe_interval_max_frames\": %.0f, \"keyframe_interval_s\": %.3f, ",
+        summary->keyframes, summary->keyIntervalFrames, summary->keyIntervalMaxFrames, summary->keyIntervalSec);
+    fprintf(json, "\"kbps\": {\"min\": %.1f, \"mean\": %.1f, \"max\": %.1f}, \"kbps_timeline\": [",
+        summary->kbpsMin, summary->kbpsMean, summary->kbpsMax);
+    for(i = 0;i < stream->secondCount;++i) {
+
+        fprintf(json, "%s%.1f", i ? ", " : "", (double)(stream->secondBytes[i]) * 8.0 / 1e3);
+    }
+    fprintf(json, "]}");
+}
+
+/**
+ * @brief       Parse a payload format name.
+ *
+ * @param[in]   name Format name (see codecNames).
+ *
+ * @return      Payload format or CODEC_UNKNOWN.
+ */
+static Codec_T parseCodecName(const char *name) {
+
+    int codec;
+
+    for(codec = CODEC_H264;codec < CODEC_COUNT;++codec) {
+
+        if(0 == strcmp(name, codecNames[codec])) {
+
+            return (Codec_T)(codec);
+        }
+    }
+
+    return CODEC_UNKNOWN;
+}
+
+/**
+ * @brief       Print usage.
+ *
+ * @param[in]   program Program name.
+ */
+static void printUsage(const char *program) {
+
+    fprintf(stderr, "Usage: %s [-c h264|h265|vp8|vp9|jpeg] [-p <PORT>] [-j <JSON_FILE>] <PCAP_OR_RTP_DUMP>\n", program);
+}
+
+/**
+ * @brief       The RTP analyzer's main function.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      1 Failure
+ */
+int main(int argc, char *argv[]) {
+
+    int option;
+    int retval = 0;
+    size_t i;
+    const char *jsonPath = NULL;
+    FILE *json = NULL;
+    FrameSummary_T summary;
+
+    while(-1 != (option = getopt(argc, argv, "c:p:j:h"))) {
+
+        switch(option) {
+
+            case 'c':
+                forcedCodec = parseCodecName(optarg);
+                if(CODEC_UNKNOWN == forcedCodec) {
+
+                    printUsage(argv[0]);
+                    return 1;
+                }
+                break;
+
+            case 'p':
+                portFilter = atoi(optarg);
+                break;
+
+            case 'j':
+                jsonPath = optarg;
+                break;
+
+            default:
+                printUsage(argv[0]);
+                return 1;
+        }
+    }
+
+    if(optind + 1 != argc) {
+
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    /* First pass guesses the payload formats, the second one measures */
+    if(readCapture(argv[optind], votePacket)) {
+
+        return 1;
+    }
+    chooseCodecs();
+    if(readCapture(argv[optind], analyzePacket)) {
+
+        return 1;
+    }
+
+    if(0 == streamCount) {
+
+        fprintf(stderr, "%s: no RTP packets\n", argv[optind]);
+        return 1;
+    }
+
+    if(NULL != jsonPath) {
+
+        json = fopen(jsonPath, "w");
+        if(NULL == json) {
+
+            perror(jsonPath);
+            return 1;
+        }
+        fprintf(json, "{\n  \"capture\": \"%s\",\n  \"ignored_packets\": %" PRIu64 ",\n  \"streams\": [\n", argv[optind], ignoredPackets);
+    }
+
+    for(i = 0;i < streamCount;++i) {
+
+        if(summarizeFrames(&streams[i], &summary)) {
+
+            fprintf(stderr, "out of memory\n");
+            retval = 1;
+            break;
+        }
+
+        printStream(&streams[i], &summary, i);
+        if(NULL != json) {
+
+            writeStreamJson(json, &streams[i], &summary);
+            fprintf(json, "%s\n", (i + 1 < streamCount) ? "," : "");
+        }
+    }
+
+    if(0U < ignoredPackets) {
+
+        printf("%" PRIu64 " packets of streams over the first %u ignored\n", ignoredPackets, NUM_MAX_STREAMS);
+    }
+
+    if(NULL != json) {
+
+        fprintf(json, "  ]\n}\n");
+        fclose(json);
+    }
+
+    for(i = 0;i < streamCount;++i) {
+
+        free(streams[i].seen);
+        free(streams[i].frames);
+        free(streams[i].secondBytes);
+    }
+
+    return retval;
+}
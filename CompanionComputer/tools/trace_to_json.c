@@ -0,0 +1,205 @@
+/**
+ * @file        trace_to_json.c
+ * @author      Adam Csizy
+ * @date        2021-05-10
+ * @version     v1.1.0
+ *
+ * @brief       Converter of the trace file to Chrome trace / Perfetto JSON
+ */
+
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "trace_utils.h"
+
+/*
+ * Compile like this:
+ *
+ * gcc -O2 -Wall trace_to_json.c -I/<path_to_repo>/CompanionComputer/includes -o trace_to_json
+ *
+ * or run "make tools" in the CompanionComputer directory.
+ *
+ * Record a trace like this (streamer built with -DCC_TRACE_ENABLED):
+ *
+ * kill -USR1 $(pidof streamerapp)      # or stop the streamer
+ * ./trace_to_json /var/tmp/DroneVideoStreamer.trace > trace.json
+ *
+ * Open trace.json in https://ui.perfetto.dev or chrome://tracing.
+ */
+
+
+static const char *const tracePointNames[] = TRACE_POINT_NAMES;
+
+
+/**
+ * @brief       Get trace point name.
+ *
+ * @param[in]   point Trace point.
+ *
+ * @return      Name of the trace point or "unknown".
+ */
+static const char* getTracePointName(const uint16_t point) {
+
+    if((point < (sizeof(tracePointNames) / sizeof(tracePointNames[0]))) && (NULL != tracePointNames[point])) {
+
+        return tracePointNames[point];
+    }
+
+    return "unknown";
+}
+
+/**
+ * @brief       Print JSON string.
+ *
+ * @details     Prints a quoted string escaping quotes, backslashes
+ *              and control characters.
+ *
+ * @param[in]   text String to print.
+ */
+static void printJsonString(const char *text) {
+
+    fputc('"', stdout);
+    for(;'\0' != *text;++text) {
+
+        if(('"' == *text) || ('\\' == *text)) {
+
+            fprintf(stdout, "\\%c", *text);
+        }
+        else if(0x20 > (unsigned char)(*text)) {
+
+            fprintf(stdout, "\\u%04x", (unsigned int)(unsigned char)(*text));
+        }
+        else {
+
+            fputc(*text, stdout);
+        }
+    }
+    fputc('"', stdout);
+}
+
+/**
+ * @brief       Print trace record as JSON event.
+ *
+ * @param[in]   record Trace record.
+ * @param[in]   pid Process identifier.
+ * @param[in]   tid Thread identifier.
+ * @param[in]   firstEvent Non-zero for the first event (no leading comma).
+ */
+static void printRecord(const TraceRecord_T *record, const uint32_t pid, const uint32_t tid, const int firstEvent) {
+
+    const char *name = getTracePointName(record->point);
+
+    fprintf(stdout, "%s\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%" PRIu64 ".%03" PRIu64 ",\"pid\":%" PRIu32 ",\"tid\":%" PRIu32,
+        firstEvent ? "" : ",", name, (char)(record->phase),
+        record->timestampNs / 1000U, record->timestampNs % 1000U, pid, tid);
+
+    switch(record->phase) {
+
+        case TRACE_PHASE_FLOW_START:
+            fprintf(stdout, ",\"cat\":\"flow\",\"id\":\"0x%" PRIx64 "\"}", (uint64_t)(record->arg));
+            break;
+
+        case TRACE_PHASE_FLOW_END:
+            fprintf(stdout, ",\"cat\":\"flow\",\"id\":\"0x%" PRIx64 "\",\"bp\":\"e\"}", (uint64_t)(record->arg));
+            break;
+
+        case TRACE_PHASE_INSTANT:
+            if(TRACE_PIPE_STATE_CHANGED == record->point) {
+
+                fprintf(stdout, ",\"s\":\"t\",\"args\":{\"old\":%" PRId64 ",\"new\":%" PRId64 "}}", record->arg / 16, record->arg % 16);
+            }
+            else {
+
+                fprintf(stdout, ",\"s\":\"t\",\"args\":{\"arg\":%" PRId64 "}}", record->arg);
+            }
+            break;
+
+        default:
+            fprintf(stdout, ",\"args\":{\"arg\":%" PRId64 "}}", record->arg);
+            break;
+    }
+}
+
+/**
+ * @brief       The converter's main function.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      1 Failure
+ */
+int main(int argc, char *argv[]) {
+
+    int firstEvent = 1;
+    uint32_t thread, index;
+    uint64_t overwritten = 0;
+    const char *path = STR_TRACE_FILE_DEFAULT;
+    FILE *file = NULL;
+    TraceFileHeader_T fileHeader;
+    TraceThreadHeader_T threadHeader;
+    TraceRecord_T record;
+
+    if(1 < argc) {
+
+        path = argv[1];
+    }
+
+    file = fopen(path, "rb");
+    if(NULL == file) {
+
+        perror(path);
+        return 1;
+    }
+
+    if((1 != fread(&fileHeader, sizeof(fileHeader), 1, file)) ||
+       (0 != memcmp(fileHeader.magic, STR_TRACE_MAGIC, NUM_TRACE_MAGIC_SIZE)) ||
+       (NUM_TRACE_VERSION != fileHeader.version) || (sizeof(TraceRecord_T) != fileHeader.recordSize)) {
+
+        fprintf(stderr, "%s: not a trace file (version %u expected)\n", path, NUM_TRACE_VERSION);
+        fclose(file);
+        return 1;
+    }
+
+    fprintf(stdout, "{\"displayTimeUnit\":\"ms\",\"otherData\":{\"realtimeOffsetNs\":\"%" PRId64 "\"},\"traceEvents\":[", fileHeader.realtimeOffsetNs);
+    fprintf(stdout, "\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%" PRIu32 ",\"args\":{\"name\":\"DroneVideoStreamer\"}}", fileHeader.pid);
+    firstEvent = 0;
+
+    for(thread = 0;thread < fileHeader.threads;++thread) {
+
+        if(1 != fread(&threadHeader, sizeof(threadHeader), 1, file)) {
+
+            fprintf(stderr, "%s: truncated in thread section %u\n", path, thread);
+            break;
+        }
+
+        threadHeader.name[NUM_TRACE_THREAD_NAME_SIZE - 1] = '\0';
+        fprintf(stdout, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%" PRIu32 ",\"tid\":%" PRIu32 ",\"args\":{\"name\":",
+            fileHeader.pid, threadHeader.threadId);
+        printJsonString(('\0' != threadHeader.name[0]) ? threadHeader.name : "thread");
+        fprintf(stdout, "}}");
+        overwritten += threadHeader.overwritten;
+
+        for(index = 0;index < threadHeader.records;++index) {
+
+            if(1 != fread(&record, sizeof(record), 1, file)) {
+
+                fprintf(stderr, "%s: truncated in thread section %u\n", path, thread);
+                break;
+            }
+            printRecord(&record, fileHeader.pid, threadHeader.threadId, firstEvent);
+        }
+    }
+
+    fprintf(stdout, "\n]}\n");
+    fclose(file);
+
+    if(0 < overwritten) {
+
+        fprintf(stderr, "%s: %" PRIu64 " oldest records were overwritten in the thread buffers\n", path, overwritten);
+    }
+
+    return 0;
+}
@@ -0,0 +1,136 @@
+/**
+ * @file        clock_utils.h
+ * @author      Adam Csizy
+ * @date        2021-05-31
+ * @version     v1.1.0
+ *
+ * @brief       Ground clock and RTP clock mapping utilities
+ *
+ * @details     The ground time (CLOCK_REALTIME of the ground control)
+ *              is the common timebase of every drone: the drones
+ *              estimate their offset to it from clock exchanges on
+ *              the control link (see the drone's clock_utils.h) and
+ *              map the RTP timestamps of their video stream to it.
+ */
+
+#pragma once
+
+
+#include <stdint.h>
+
+
+/* Clock related public macro definitions */
+
+#define NUM_CLOCK_MAPPING_MAX           4U      /**< Maximum number of mapped video streams */
+#define NUM_CLOCK_RTP_RATE              90000U  /**< RTP clock rate of the video streams in Hz */
+
+
+/* Clock related public type definitions */
+
+/**
+ * @brief   Struct of an RTP clock mapping.
+ *
+ * @details Maps an RTP timestamp of a video stream to the ground
+ *          time of the frame's capture on the drone. Other RTP
+ *          timestamps of the stream follow at NUM_CLOCK_RTP_RATE.
+ */
+typedef struct ClockMapping {
+
+    uint32_t ssrc;              /**< SSRC of the video stream */
+    uint32_t rtpTimestamp;      /**< RTP timestamp */
+    uint64_t groundNs;          /**< Ground time of the capture of the RTP timestamp's frame */
+    uint32_t uncertaintyUs;     /**< Error bound of the ground time in microseconds (drone's estimate) */
+
+} ClockMapping_T;
+
+/**
+ * @brief   Struct of the capture to arrival latency of frames.
+ */
+typedef struct ArrivalLatency {
+
+    uint64_t frames;            /**< Number of frames measured */
+    int64_t meanUs;             /**< Mean latency in microseconds */
+    int64_t maxUs;              /**< Maximum latency in microseconds */
+    uint32_t uncertaintyUs;     /**< Error bound of the latencies in microseconds */
+
+} ArrivalLatency_T;
+
+
+/* Clock related public function declarations */
+
+/**
+ * @brief       Get ground time.
+ *
+ * @return      CLOCK_REALTIME time in nanoseconds.
+ */
+uint64_t getGroundTimeNs(void);
+
+/**
+ * @brief       Update RTP clock mapping.
+ *
+ * @details     Stores the latest mapping of a drone's video stream
+ *              (the mapping of the least recently updated stream is
+ *              replaced if every entry is taken). Thread-safe.
+ *
+ * @param[in]   droneID Drone ID.
+ * @param[in]   mapping Received mapping.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+int updateClockMapping(const uint32_t droneID, const ClockMapping_T *mapping);
+
+/**
+ * @brief       Drop RTP clock mappings of a drone.
+ *
+ * @details     Called when the drone disconnects. Thread-safe.
+ *
+ * @param[in]   droneID Drone ID.
+ */
+void dropClockMappings(const uint32_t droneID);
+
+/**
+ * @brief       Convert RTP timestamp to ground time.
+ *
+ * @details     Thread-safe.
+ *
+ * @param[in]   ssrc SSRC of the video stream.
+ * @param[in]   rtpTimestamp RTP timestamp (within 6 hours of the mapped one).
+ * @param[out]  groundNs Ground time of the capture of the RTP timestamp's frame.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure (stream not mapped)
+ */
+int convertRtpToGroundTime(const uint32_t ssrc, const uint32_t rtpTimestamp, uint64_t *groundNs);
+
+/**
+ * @brief       Record frame arrival.
+ *
+ * @details     Adds the capture to arrival latency of a frame of a
+ *              mapped stream to the measurement. Invoked in the
+ *              streaming thread of the network source. Thread-safe.
+ *
+ * @param[in]   ssrc SSRC of the video stream.
+ * @param[in]   rtpTimestamp RTP timestamp of the frame.
+ * @param[in]   arrivalNs Ground time of the frame's arrival (its last packet).
+ */
+void recordFrameArrival(const uint32_t ssrc, const uint32_t rtpTimestamp, const uint64_t arrivalNs);
+
+/**
+ * @brief       Take frame arrival latency.
+ *
+ * @details     Takes the latency of the frames recorded since the
+ *              previous take. Thread-safe.
+ *
+ * @param[out]  latency Latency of the recorded frames.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure (no frame recorded)
+ */
+int takeArrivalLatency(ArrivalLatency_T *latency);
@@ -70,7 +70,18 @@ typedef enum ModuleMessageCode {
     MOD_MSG_CODE_STREAM_START   = 5,    /**< Start video stream (ground control) */
     MOD_MSG_CODE_STREAM_STOP    = 6,    /**< Stop video stream (ground control) */
     MOD_MSG_CODE_STREAM_TYPE    = 7,    /**< Type of requested video stream (drone) */
-    MOD_MSG_CODE_LOGIN_NACK     = 8     /**< Login not confirmed (ground control) */
+    MOD_MSG_CODE_LOGIN_NACK     = 8,    /**< Login not confirmed (ground control) */
+    MOD_MSG_CODE_PROFILE_DUMP   = 9,    /**< Dump pipeline profile (ground control, see profiler_utils.h) */
+    MOD_MSG_CODE_STREAM_RETRY   = 10,   /**< Retry pipeline recovery (drone internal, see streamErrorHandler()) */
+    MOD_MSG_CODE_STREAM_RECOVERED = 11, /**< Video stream recovered and resumed in the given coding format (drone) */
+    MOD_MSG_CODE_STREAM_STALL   = 12,   /**< Pipeline stalled without error (drone internal, see watchdog_utils.h) */
+    MOD_MSG_CODE_TELEMETRY      = 13,   /**< Latest telemetry sample of a channel (drone, see telemetry_utils.h) */
+    MOD_MSG_CODE_SNAPSHOT_REQ   = 14,   /**< Take a still snapshot (ground control) */
+    MOD_MSG_CODE_SNAPSHOT       = 15,   /**< Snapshot captured or failed (drone, see snapshot_utils.h) */
+    MOD_MSG_CODE_SNAPSHOT_DATA  = 16,   /**< Chunk of a captured snapshot (drone) */
+    MOD_MSG_CODE_CLOCK_REQ      = 17,   /**< Clock exchange request (drone) */
+    MOD_MSG_CODE_CLOCK_RESP     = 18,   /**< Clock exchange response (ground control) */
+    MOD_MSG_CODE_CLOCK_MAP      = 19    /**< RTP timestamp to ground time mapping of the video stream (drone, see clock_utils.h) */
 
 } ModuleMessageCode_T;
 
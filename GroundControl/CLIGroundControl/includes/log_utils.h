@@ -19,6 +19,7 @@
 #define STR_LOG_MSG_FUNC1_THRD_START_FAIL       "initCommunicationModule(): Failed to start drone service threads."
 
 #define STR_LOG_MSG_FUNC2_SOCK_CREAT_FAIL       "startServer(): Failed to create server socket."
+#define STR_LOG_MSG_FUNC2_MPTCP_FALLBACK        "startServer(): Multipath TCP is not available, listening with TCP."
 #define STR_LOG_MSG_FUNC2_SOCK_CONF_FAIL        "startServer(): Failed to configure server socket."
 #define STR_LOG_MSG_FUNC2_SOCK_BIND_FAIL        "startServer(): Failed to bind server socket to server address."
 #define STR_LOG_MSG_FUNC2_SOCK_LISTEN_FAIL      "startServer(): Failed to set server socket to passive mode."
@@ -27,6 +28,7 @@
 
 #define STR_LOG_MSG_FUNC4_CONN_ACCEPT_FAIL      "[WARNING] threadFuncDroneService(): Thread %d failed to accept connection request.\n"
 #define STR_LOG_MSG_FUNC4_SOCK_CONF_FAIL        "[WARNING] threadFuncDroneService(): Thread %d failed to configure service socket.\n"
+#define STR_LOG_MSG_FUNC4_SOCK_QOS_FAIL         "[WARNING] threadFuncDroneService(): Thread %d failed to set control traffic class on service socket.\n"
 #define STR_LOG_MSG_FUNC4_DRONE_AUTH_FAIL       "[WARNING] threadFuncDroneService(): Thread %d failed to authenticate drone with ID <%d>.\n"
 #define STR_LOG_MSG_FUNC4_DRONE_AUTH_SUCCESS    "[INFO] threadFuncDroneService(): Thread %d succeeded to authenticate drone with ID <%d>.\n"
 #define STR_LOG_MSG_FUNC4_CONN_CLOSED           "[WARNING] threadFuncDroneService(): Connection lost or closed by the drone in thread %d.\n"
@@ -34,6 +36,8 @@
 #define STR_LOG_MSG_FUNC4_CLI_HANDLE_FAIL       "[WARNING] threadFuncDroneService(): Thread %d failed to handle CLI input."
 #define STR_LOG_MSG_FUNC4_DRONE_ADDR_RES        "[INFO] threadFuncDroneService(): Thread %d accepted drone connection from IP <%s> PORT <%s>.\n"
 #define STR_LOG_MSG_FUNC4_DRONE_ADDR_RES_FAIL   "[INFO] threadFuncDroneService(): Thread %d accepted drone connection. Drone address could not be resolved. Reason: %s.\n"
+#define STR_LOG_MSG_FUNC4_HEADLESS_REQ_FAIL     "[WARNING] threadFuncDroneService(): Thread %d failed to request video stream in headless mode.\n"
+#define STR_LOG_MSG_FUNC4_STALL_HANDLE_FAIL     "[WARNING] threadFuncDroneService(): Thread %d failed to handle video display stall."
 
 #define STR_LOG_MSG_FUNC5_ARG_INVAL             "authDrone(): Invalid input argument(s)."
 #define STR_LOG_MSG_FUNC5_LOGIN_RECV_FAIL       "authDrone(): Failed to receive login message or response timed out."
@@ -45,17 +49,28 @@
 #define STR_LOG_MSG_FUNC6_PIPE_SET_INIT_FAIL    "pipeBuilder(): Failed to set pipeline to its initial state."
 #define STR_LOG_MSG_FUNC6_MAIN_LOOP_START_FAIL  "pipeBuilder(): Failed to start GStreamer main loop thread."
 #define STR_LOG_MSG_FUNC6_FMT_INVAL             "pipeBuilder(): Invalid video coding format."
+#define STR_LOG_MSG_FUNC6_SOCK_CREAT_FAIL       "pipeBuilder(): Failed to create network source socket."
+#define STR_LOG_MSG_FUNC6_REORDER_CREAT_FAIL    "pipeBuilder(): Failed to create multipath reorder buffer (rtpjitterbuffer). Packets are not reordered."
 
 #define STR_LOG_MSG_FUNC7_GST_INIT_FAIL         "initStreamModule(): Failed to initialize GStreamer core and its plugins."
+#define STR_LOG_MSG_FUNC7_DUMP_OPEN_FAIL        "initStreamModule(): Failed to open RTP dump file."
+#define STR_LOG_MSG_FUNC7_STALL_PIPE_FAIL       "initStreamModule(): Failed to create stall report pipe."
 
 #define STR_LOG_MSG_FUNC8_ARG_INVAL             "inputMessageHandler(): Invalid input argument(s)."
 #define STR_LOG_MSG_FUNC8_MSG_RECV_FAIL         "inputMessageHandler(): Failed to receive module message or response timed out."
 #define STR_LOG_MSG_FUNC8_MSG_RECV_INVAL        "inputMessageHandler(): Invalid module message received."
 #define STR_LOG_MSG_FUNC8_STRM_STOP_FAIL        "inputMessageHandler(): Failed to stop ground control video display pipeline."
+#define STR_LOG_MSG_FUNC8_MSG_DATA_RECV_FAIL    "inputMessageHandler(): Failed to receive module message data or response timed out."
+#define STR_LOG_MSG_FUNC8_STRM_RESUME_FAIL      "inputMessageHandler(): Failed to resume ground control video display pipeline."
+#define STR_LOG_MSG_FUNC8_TELEMETRY_INVAL       "inputMessageHandler(): Invalid telemetry sample received."
+#define STR_LOG_MSG_FUNC8_SNAPSHOT_FAIL         "[WARNING] inputMessageHandler(): Drone failed to take snapshot %u.\n"
+#define STR_LOG_MSG_FUNC8_SNAPSHOT_INVAL        "inputMessageHandler(): Invalid snapshot data chunk received."
 
 #define STR_LOG_MSG_FUNC9_ARG_INVAL             "inputCommandHandler(): Invalid input argument(s)."
 #define STR_LOG_MSG_FUNC9_REQ_STRM_FAIL         "inputCommandHandler(): Failed to accomplish user command 'play'."
 #define STR_LOG_MSG_FUNC9_STOP_STRM_FAIL        "inputCommandHandler(): Failed to accomplish user command 'stop'."
+#define STR_LOG_MSG_FUNC9_PROF_DUMP_FAIL        "inputCommandHandler(): Failed to accomplish user command 'prof'."
+#define STR_LOG_MSG_FUNC9_SNAPSHOT_FAIL         "inputCommandHandler(): Failed to accomplish user command 'snap'."
 
 #define STR_LOG_MSG_FUNC10_ARG_INVAL            "stopStream(): Invalid input argument(s)."
 #define STR_LOG_MSG_FUNC10_PIPE_SET_INIT_FAIL   "stopStream(): Failed to set pipeline to its initial state."
@@ -70,8 +85,7 @@
 #define STR_LOG_MSG_FUNC12_MSG_FMT_RECV_FAIL    "requestStream(): Failed to receive video stream coding format or response timed out."
 #define STR_LOG_MSG_FUNC12_MSG_TYP_INVAL        "requestStream(): Invalid STREAM TYPE module message code."
 #define STR_LOG_MSG_FUNC12_MSG_START_SEND_FAIL  "requestStream(): Failed to send STREAM START module message header."
-#define STR_LOG_MSG_FUNC12_PIPE_SET_PLAY_FAIL   "requestStream(): Failed to set video display pipeline to PLAYING state."
-#define STR_LOG_MSG_FUNC12_PIPE_BUILD_FAIL      "requestStream(): Failed to build video display pipeline."
+#define STR_LOG_MSG_FUNC12_PIPE_PLAY_FAIL       "requestStream(): Failed to play video display pipeline."
 
 #define STR_LOG_MSG_FUNC13_ARG_INVAL            "waitPipeStateChange(): Invalid input argument(s)."
 #define STR_LOG_MSG_FUNC13_PIPE_ERROR           "waitPipeStateChange(): Error occured while waiting for state change."
@@ -82,6 +96,101 @@
 
 #define STR_LOG_MSG_FUNC15_LOOP_CREAT_FAIL      "threadFuncStreamMainLoop(): Failed to create main loop."
 
+#define STR_LOG_MSG_FUNC16_ARG_INVAL            "setSocketDscp(): Invalid input argument(s)."
+#define STR_LOG_MSG_FUNC16_SOCK_NAME_FAIL       "setSocketDscp(): Failed to get socket address family."
+#define STR_LOG_MSG_FUNC16_TOS_SET_FAIL         "setSocketDscp(): Failed to set socket option IP_TOS."
+#define STR_LOG_MSG_FUNC16_TCLASS_SET_FAIL      "setSocketDscp(): Failed to set socket option IPV6_TCLASS."
+
+#define STR_LOG_MSG_FUNC17_PRIO_SET_FAIL        "setSocketPriority(): Failed to set socket option SO_PRIORITY."
+
+#define STR_LOG_MSG_FUNC18_ARG_INVAL            "setSocketBufferSize(): Invalid input argument(s)."
+#define STR_LOG_MSG_FUNC18_BUF_SET_FAIL         "setSocketBufferSize(): Failed to set socket buffer size."
+#define STR_LOG_MSG_FUNC18_BUF_GET_FAIL         "setSocketBufferSize(): Failed to get socket buffer size."
+#define STR_LOG_MSG_FUNC18_BUF_CAPPED           "setSocketBufferSize(): Socket buffer size capped by the kernel. Raise net.core.wmem_max/rmem_max or run with CAP_NET_ADMIN."
+
+#define STR_LOG_MSG_FUNC19_ARG_INVAL            "getSocketDropCount(): Invalid input argument(s)."
+
+#define STR_LOG_MSG_FUNC20_ARG_INVAL            "startReceiveBufferAutotune(): Invalid input argument(s)."
+#define STR_LOG_MSG_FUNC20_DROPS_UNSUPPORTED    "startReceiveBufferAutotune(): Kernel drop counter is not available (SO_MEMINFO). Receive buffer autotuning disabled."
+
+#define STR_LOG_MSG_FUNC21_DROPS_DETECTED       "[WARNING] receiveBufferAutotuneCallback(): Kernel dropped %u RTP datagrams (%u in total). Receive buffer is %d bytes.\n"
+
+#define STR_LOG_MSG_FUNC22_ARG_INVAL            "createNetworkSourceSocket(): Invalid input argument(s)."
+#define STR_LOG_MSG_FUNC22_SOCK_CREAT_FAIL      "createNetworkSourceSocket(): Failed to create UDP socket."
+#define STR_LOG_MSG_FUNC22_SOCK_CONF_FAIL       "createNetworkSourceSocket(): Failed to configure UDP socket."
+#define STR_LOG_MSG_FUNC22_SOCK_BIND_FAIL       "createNetworkSourceSocket(): Failed to bind UDP socket to the stream source port."
+#define STR_LOG_MSG_FUNC22_GSOCK_CREAT_FAIL     "createNetworkSourceSocket(): Failed to wrap UDP socket into a GSocket."
+#define STR_LOG_MSG_FUNC22_AUTOTUNE_FAIL        "createNetworkSourceSocket(): Failed to start receive buffer autotuning."
+
+#define STR_LOG_MSG_FUNC23_REQ_STRM_RETRY       "requestHeadlessStream(): Video stream request failed. Retrying."
+
+#define STR_LOG_MSG_FUNC24_DUMP_WRITE_FAIL      "rtpDumpProbe(): Failed to write RTP dump file. Dump stopped."
+
+#define STR_LOG_MSG_FUNC25_SIGNAL_ADD_FAIL      "initPipelineProfiler(): Failed to add SIGUSR2 source. Dumps are available on user command only."
+#define STR_LOG_MSG_FUNC25_PROFILER_ENABLED     "[INFO] initPipelineProfiler(): Pipeline profiling enabled. Profiles are written to %s on SIGUSR2 and on the 'prof' command.\n"
+
+#define STR_LOG_MSG_FUNC26_ITERATE_FAIL         "attachPipelineProfiler(): Failed to profile every pipeline element."
+
+#define STR_LOG_MSG_FUNC27_FILE_OPEN_FAIL       "[ERROR] writePipelineProfile(): Failed to open profile file %s.\n"
+#define STR_LOG_MSG_FUNC27_FILE_WRITE_FAIL      "[ERROR] writePipelineProfile(): Failed to write profile file %s.\n"
+#define STR_LOG_MSG_FUNC27_PROFILE_WRITTEN      "[INFO] writePipelineProfile(): Profile written to %s (bottleneck %s, %.1f %% of processing time).\n"
+
+#define STR_LOG_MSG_FUNC28_ARG_INVAL            "sendProfileMessage(): Invalid input argument(s)."
+#define STR_LOG_MSG_FUNC28_MSG_SEND_FAIL        "sendProfileMessage(): Failed to send module message."
+
+#define STR_LOG_MSG_FUNC29_STATIC               "[INFO] initPluginRegistry(): Static GStreamer build, plugin registry disabled.\n"
+#define STR_LOG_MSG_FUNC29_DIR_INVAL            "[WARNING] initPluginRegistry(): Pinned plugin directory %s is not a directory. Using the system plugins.\n"
+#define STR_LOG_MSG_FUNC29_PINNED               "[INFO] initPluginRegistry(): Using pinned plugin registry %s without rescanning.\n"
+#define STR_LOG_MSG_FUNC29_REGISTRY_MISSING     "[WARNING] initPluginRegistry(): Pinned plugin registry %s is missing. Scanning the pinned plugins once.\n"
+
+#define STR_LOG_MSG_FUNC30_ELEM_MISSING         "[WARNING] checkRequiredPlugins(): Element %s is missing (stale pinned plugins?).\n"
+
+#define STR_LOG_MSG_FUNC31_ARG_INVAL            "resumeStream(): Invalid input argument(s)."
+#define STR_LOG_MSG_FUNC31_PIPE_PLAY_FAIL       "resumeStream(): Failed to play video display pipeline."
+#define STR_LOG_MSG_FUNC31_RESUMED              "[INFO] resumeStream(): Drone recovered the video stream (coding format %u). Resuming video display.\n"
+
+#define STR_LOG_MSG_FUNC32_PIPE_BUILD_FAIL      "playPipeline(): Failed to build video display pipeline."
+#define STR_LOG_MSG_FUNC32_PIPE_SET_PLAY_FAIL   "playPipeline(): Failed to set video display pipeline to PLAYING state."
+#define STR_LOG_MSG_FUNC32_WATCH_FAIL           "[WARNING] playPipeline(): Failed to add %s stall watch, its stalls go undetected.\n"
+
+#define STR_LOG_MSG_FUNC33_ARG_INVAL            "initStallWatchdog(): Invalid input argument(s)."
+
+#define STR_LOG_MSG_FUNC34_ARG_INVAL            "addStallWatch(): Invalid input argument(s)."
+#define STR_LOG_MSG_FUNC34_PAD_NOT_FOUND        "[ERROR] addStallWatch(): Pad %s of element %s not found, %s stall watch not added.\n"
+#define STR_LOG_MSG_FUNC34_WATCHES_FULL         "[ERROR] addStallWatch(): No free stall watch for %s.\n"
+
+#define STR_LOG_MSG_FUNC35_STALLED              "[WARNING] stallCheckCallback(): Video display pipeline stalled at %s for %u ms without error.\n"
+
+#define STR_LOG_MSG_FUNC36_ARG_INVAL            "handleStreamStall(): Invalid input argument(s)."
+#define STR_LOG_MSG_FUNC36_REPORT_READ_FAIL     "handleStreamStall(): Failed to read stall report."
+#define STR_LOG_MSG_FUNC36_DECODER_RESTART      "[WARNING] handleStreamStall(): Video decoding stalled for %u ms while video packets arrive. Restarting video display.\n"
+#define STR_LOG_MSG_FUNC36_NETWORK_STALLED      "[WARNING] handleStreamStall(): No video packets from the drone for %u ms. Issue 'stop' and 'play' if the video does not come back.\n"
+#define STR_LOG_MSG_FUNC36_PIPE_PLAY_FAIL       "handleStreamStall(): Failed to restart video display pipeline."
+
+#define STR_LOG_MSG_FUNC37_REPORT_WRITE_FAIL    "displayStallCallback(): Failed to write stall report."
+
+#define STR_LOG_MSG_FUNC38_REGISTRY_FULL        "[WARNING] openTelemetrySession(): Telemetry registry is full, telemetry of drone <%u> is dropped.\n"
+
+#define STR_LOG_MSG_FUNC39_ARG_INVAL            "publishTelemetry(): Invalid input argument(s)."
+#define STR_LOG_MSG_FUNC39_NO_SESSION           "publishTelemetry(): No telemetry session of the drone."
+
+#define STR_LOG_MSG_FUNC40_RECV_FULL            "beginSnapshot(): Too many snapshots received at a time, snapshot dropped."
+#define STR_LOG_MSG_FUNC40_FILE_OPEN_FAIL       "[ERROR] beginSnapshot(): Failed to open snapshot file %s (%s), snapshot dropped.\n"
+
+#define STR_LOG_MSG_FUNC41_ARG_INVAL            "receiveSnapshotData(): Invalid input argument(s)."
+#define STR_LOG_MSG_FUNC41_DROPPED              "[WARNING] receiveSnapshotData(): Snapshot %u of drone <%u> dropped (%u bytes received, chunk at %u).\n"
+#define STR_LOG_MSG_FUNC41_SAVED                "[INFO] receiveSnapshotData(): Snapshot %u of drone <%u> saved to %s (%u bytes in %u ms).\n"
+
+#define STR_LOG_MSG_FUNC42_ARG_INVAL            "sendSnapshotMessage(): Invalid input argument(s)."
+#define STR_LOG_MSG_FUNC42_MSG_SEND_FAIL        "sendSnapshotMessage(): Failed to send module message."
+
+#define STR_LOG_MSG_FUNC43_ARG_INVAL            "sendClockResponse(): Invalid input argument(s)."
+#define STR_LOG_MSG_FUNC43_MSG_SEND_FAIL        "sendClockResponse(): Failed to send module message."
+
+#define STR_LOG_MSG_FUNC44_ARG_INVAL            "updateClockMapping(): Invalid input argument(s)."
+#define STR_LOG_MSG_FUNC44_MAPPED               "[INFO] updateClockMapping(): Video stream %08x of drone <%u> mapped to the ground clock (uncertainty %u us).\n"
+
+#define STR_LOG_MSG_MAIN_ARG_INVAL              "main(): Invalid command line argument(s)."
 #define STR_LOG_MSG_MAIN_PROG_STARTUP           "main(): Ground Control launched!"
 #define STR_LOG_MSG_MAIN_SERVER_INIT_FAIL       "main(): Failed to initialize and launch ground control services."
 #define STR_LOG_MSG_MAIN_STREAM_INIT_FAIL       "main(): Failed to initialize streaming services."
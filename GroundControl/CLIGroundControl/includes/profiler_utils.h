@@ -0,0 +1,83 @@
+/**
+ * @file        profiler_utils.h
+ * @author      Adam Csizy
+ * @date        2021-05-18
+ * @version     v1.1.0
+ *
+ * @brief       Runtime pipeline profiling utilities
+ */
+
+#pragma once
+
+
+#include <gst/gst.h>
+
+
+/* Profiler related public macro definitions */
+
+#define STR_PROFILE_DEFAULT_TRACERS     "latency(flags=pipeline+element)"   /**< GStreamer tracers enabled with the profiler unless GST_TRACERS is set */
+#define STR_PROFILE_TRACER_DEBUG        "GST_TRACER:7"      /**< GStreamer debug level of the tracer records unless GST_DEBUG is set */
+#define NUM_PROFILE_SAMPLE_PERIOD_MS    100U                /**< Period of the queue level sampling in milliseconds */
+
+
+/* Profiler related public function declarations */
+
+/**
+ * @brief       Initialize pipeline profiler.
+ *
+ * @details     Enables the profiler if a dump directory is given.
+ *              Must be called before 'gst_init()': the GStreamer
+ *              latency tracer (STR_PROFILE_DEFAULT_TRACERS) is
+ *              enabled through the environment and its records
+ *              are written to gst-tracer-<pid>.log in the dump
+ *              directory unless GST_TRACERS, GST_DEBUG or
+ *              GST_DEBUG_FILE are already set (set GST_TRACERS to
+ *              add e.g. the proctime and queuelevel tracers of
+ *              GstShark). A dump of every profiled pipeline is
+ *              requested on SIGUSR2 (and by the 'prof' user
+ *              command). The queue levels are sampled
+ *              and the dumps are written on the default main
+ *              context.
+ *
+ * @param[in]   directory Dump directory (NULL or empty: profiler disabled).
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success (or disabled)
+ * @retval      -1 Failure
+ */
+int initPipelineProfiler(const char *directory);
+
+/**
+ * @brief       Attach pipeline profiler.
+ *
+ * @details     Adds buffer probes to the pads of the pipeline's
+ *              top-level elements (bins are measured at their
+ *              ghost pads) counting the buffers and bytes entering
+ *              and leaving each element and measuring the processing
+ *              time from a buffer's arrival to the element's first
+ *              output after it. Queues (elements with a
+ *              'current-level-buffers' property) report their
+ *              sampled fill level instead. The pipeline is dropped
+ *              from the profiler when it is finalized. No-op if
+ *              the profiler is disabled.
+ *
+ * @param[in]   pipeline GStreamer pipeline.
+ */
+void attachPipelineProfiler(GstElement *pipeline);
+
+/**
+ * @brief       Request profile dump.
+ *
+ * @details     Schedules a dump of every profiled pipeline on the
+ *              default main context. Each pipeline is written as a
+ *              DOT graph (<pipeline>-<pid>-<sequence>-<index>.dot in
+ *              the dump directory) whose nodes are annotated with the
+ *              buffer rates, bitrates, processing times and queue
+ *              levels measured since the previous dump. The element
+ *              with the largest share of the processing time is
+ *              marked as the bottleneck. Render the graph with
+ *              "dot -Tsvg". Thread-safe; no-op if the profiler is
+ *              disabled.
+ */
+void requestPipelineProfileDump(void);
@@ -0,0 +1,187 @@
+/**
+ * @file        qos_utils.h
+ * @author      Adam Csizy
+ * @date        2021-05-04
+ * @version     v1.1.0
+ *
+ * @brief       Network quality of service utilities
+ */
+
+#pragma once
+
+
+#include <stdint.h>
+
+
+/* QoS related public macro definitions */
+
+#define NUM_QOS_DSCP_CONTROL            48      /**< DSCP of control traffic: CS6 (WMM voice access category) */
+#define NUM_QOS_DSCP_VIDEO              34      /**< DSCP of video traffic: AF41 (WMM video access category) */
+#define NUM_QOS_PRIO_CONTROL            6       /**< Socket priority of control traffic (highest unprivileged value) */
+#define NUM_QOS_PRIO_VIDEO              5       /**< Socket priority of video traffic */
+#define NUM_QOS_VIDEO_BITRATE_KBPS      8000    /**< Target (peak) video bitrate in kbit/s used for buffer sizing */
+#define NUM_QOS_TARGET_LATENCY_MS       200     /**< Target latency in milliseconds the media socket buffers must cover */
+#define NUM_QOS_SOCK_BUF_MIN            65536   /**< Lower bound of computed socket buffer sizes in bytes */
+#define NUM_QOS_SOCK_BUF_MAX            16777216 /**< Upper bound of computed socket buffer sizes in bytes */
+#define NUM_QOS_AUTOTUNE_PERIOD_SEC     1U      /**< Period of the receive buffer autotuning checks in seconds */
+
+
+/* QoS related public type definitions */
+
+/**
+ * @brief   Enumeration of traffic classes.
+ *
+ * @details Control traffic is marked above video traffic so
+ *          that commands are not queued behind keyframe bursts.
+ */
+typedef enum TrafficClass {
+
+    QOS_CLASS_CONTROL   = 0,    /**< Control link (TCP) */
+    QOS_CLASS_VIDEO     = 1     /**< Media path (UDP/RTP) */
+
+} TrafficClass_T;
+
+
+/* QoS related public function declarations */
+
+/**
+ * @brief       Get DSCP of a traffic class.
+ *
+ * @param[in]   trafficClass Traffic class.
+ *
+ * @return      Differentiated services code point (0..63).
+ */
+int getTrafficClassDscp(const TrafficClass_T trafficClass);
+
+/**
+ * @brief       Get socket priority of a traffic class.
+ *
+ * @param[in]   trafficClass Traffic class.
+ *
+ * @return      Socket priority (SO_PRIORITY).
+ */
+int getTrafficClassPriority(const TrafficClass_T trafficClass);
+
+/**
+ * @brief       Set socket DSCP.
+ *
+ * @details     Sets the DSCP field of outgoing packets using
+ *              IP_TOS or IPV6_TCLASS depending on the socket's
+ *              address family. IPv6 sockets also get IP_TOS for
+ *              IPv4-mapped destinations.
+ *
+ * @param[in]   sockFd Socket file descriptor.
+ * @param[in]   dscp Differentiated services code point (0..63).
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+int setSocketDscp(const int sockFd, const int dscp);
+
+/**
+ * @brief       Set socket priority.
+ *
+ * @details     Sets SO_PRIORITY which selects the queue of the
+ *              local traffic control (e.g. pfifo_fast band or
+ *              the 802.11 access category of the WLAN driver).
+ *
+ * @param[in]   sockFd Socket file descriptor.
+ * @param[in]   priority Socket priority (0..6 without CAP_NET_ADMIN).
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+int setSocketPriority(const int sockFd, const int priority);
+
+/**
+ * @brief       Set socket traffic class.
+ *
+ * @details     Applies both the DSCP and the socket priority
+ *              of the given traffic class.
+ *
+ * @param[in]   sockFd Socket file descriptor.
+ * @param[in]   trafficClass Traffic class.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+int setSocketTrafficClass(const int sockFd, const TrafficClass_T trafficClass);
+
+/**
+ * @brief       Compute socket buffer size.
+ *
+ * @details     Returns the number of bytes produced at the given
+ *              bitrate during the given latency (bandwidth-delay
+ *              product), clamped to [NUM_QOS_SOCK_BUF_MIN,
+ *              NUM_QOS_SOCK_BUF_MAX].
+ *
+ * @param[in]   bitrateKbps Bitrate in kbit/s.
+ * @param[in]   latencyMs Latency in milliseconds.
+ *
+ * @return      Socket buffer size in bytes.
+ */
+int computeSocketBufferSize(const int bitrateKbps, const int latencyMs);
+
+/**
+ * @brief       Set socket buffer size.
+ *
+ * @details     Sets the send or receive buffer of the socket. The
+ *              privileged SO_SNDBUFFORCE/SO_RCVBUFFORCE options are
+ *              tried first so the size is not capped by the
+ *              net.core.wmem_max/rmem_max sysctls.
+ *
+ * @param[in]   sockFd Socket file descriptor.
+ * @param[in]   option SO_SNDBUF or SO_RCVBUF.
+ * @param[in]   size Requested buffer size in bytes.
+ *
+ * @return      Effective buffer size in bytes or -1 on failure.
+ */
+int setSocketBufferSize(const int sockFd, const int option, const int size);
+
+/**
+ * @brief       Get socket drop count.
+ *
+ * @details     Reads the number of datagrams the kernel dropped
+ *              on the given socket because its receive buffer was
+ *              full. This is the sk_drops counter that SO_RXQ_OVFL
+ *              attaches to received datagrams; it is read with
+ *              SO_MEMINFO here because the datagrams themselves
+ *              are received by GStreamer's 'udpsrc'.
+ *
+ * @param[in]   sockFd Socket file descriptor.
+ * @param[out]  drops Number of dropped datagrams since socket creation.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+int getSocketDropCount(const int sockFd, uint32_t *drops);
+
+/**
+ * @brief       Start receive buffer autotuning.
+ *
+ * @details     Adds a periodic timeout source to the default main
+ *              context which checks the kernel drop counter of the
+ *              given socket every NUM_QOS_AUTOTUNE_PERIOD_SEC seconds.
+ *              When new drops appear they are logged and the receive
+ *              buffer is doubled (up to NUM_QOS_SOCK_BUF_MAX).
+ *
+ * @note        The checks run in the thread running the default
+ *              main loop (see threadFuncStreamMainLoop()).
+ *
+ * @param[in]   sockFd Socket file descriptor.
+ * @param[in]   initialSize Current receive buffer size in bytes.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+int startReceiveBufferAutotune(const int sockFd, const int initialSize);
@@ -0,0 +1,76 @@
+/**
+ * @file        snapshot_utils.h
+ * @author      Adam Csizy
+ * @date        2021-05-27
+ * @version     v1.1.0
+ *
+ * @brief       Drone snapshot receiver
+ */
+
+#pragma once
+
+
+#include <stdint.h>
+
+
+/* Snapshot related public macro definitions */
+
+#define NUM_SNAPSHOT_RECV_MAX           4U      /**< Maximum number of snapshots received at a time (one per drone) */
+#define NUM_SNAPSHOT_CHUNK_SIZE         8192U   /**< Maximum size of a snapshot data chunk in bytes (see the drone's snapshot_utils.h) */
+#define STR_SNAPSHOT_FILE_FORMAT        "snapshot_%u_%u.jpg" /**< Snapshot file in the working directory (drone ID, snapshot ID) */
+
+
+/* Snapshot related public function declarations */
+
+/**
+ * @brief       Begin snapshot.
+ *
+ * @details     Creates the snapshot file of a captured snapshot
+ *              announced by the drone. A previous unfinished
+ *              snapshot of the drone is dropped. Thread-safe.
+ *
+ * @param[in]   droneID Drone ID.
+ * @param[in]   id Snapshot ID.
+ * @param[in]   size Size of the JPEG image in bytes.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure (the data of the snapshot is ignored)
+ */
+int beginSnapshot(const uint32_t droneID, const uint32_t id, const uint32_t size);
+
+/**
+ * @brief       Receive snapshot data chunk.
+ *
+ * @details     Appends a chunk to the snapshot file. The last chunk
+ *              completes the file and reports it; in headless mode
+ *              also on the standard output:
+ *
+ *                  [snapshot] drone=<ID> id=<ID> bytes=<SIZE> ms=<TIME> path=<FILE>
+ *
+ *              Chunks of unknown snapshots are ignored, a missing
+ *              chunk drops the snapshot. Thread-safe.
+ *
+ * @param[in]   droneID Drone ID.
+ * @param[in]   id Snapshot ID.
+ * @param[in]   offset Offset of the chunk in the image.
+ * @param[in]   data Chunk data.
+ * @param[in]   length Length of the chunk.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success (or ignored)
+ * @retval      -1 Failure (snapshot dropped)
+ */
+int receiveSnapshotData(const uint32_t droneID, const uint32_t id, const uint32_t offset, const uint8_t *data, const uint32_t length);
+
+/**
+ * @brief       Drop snapshots of a drone.
+ *
+ * @details     Removes the unfinished snapshot file of a
+ *              disconnected drone. Thread-safe.
+ *
+ * @param[in]   droneID Drone ID.
+ */
+void dropSnapshots(const uint32_t droneID);
@@ -12,6 +12,33 @@
 
 #include <gst/gst.h>
 
+#include "com_utils.h"
+
+
+/* Streaming related public macro definitions */
+
+#define NUM_STREAM_STALL_TIMEOUT_MS 3000U   /**< Default time without buffers after which the playing display pipeline counts as stalled */
+
+
+/* Streaming related public type definitions */
+
+/**
+ * @brief   Streaming services initialization context.
+ */
+typedef struct StreamInitContext {
+
+    int headless;                   /**< Count frames instead of displaying them and request the stream on connection */
+    int latency;                    /**< Decode the latency stamp of the frames (headless only) */
+    VideoStreamPort_T streamPort;   /**< Port to which the drone is asked to stream (0: default) */
+    const char *dumpPath;           /**< File receiving the raw RTP packets (NULL: no dump) */
+    const char *profileDir;         /**< Directory of the pipeline profiles (NULL: profiler disabled) */
+    const char *pluginDir;          /**< Pinned plugin directory (NULL: system plugins, see plugin_utils.h) */
+    unsigned int stallMs;           /**< Stall threshold of the display pipeline in milliseconds (0: watchdog disabled) */
+    int multipath;                  /**< Multipath reception: the drone may stream and connect over several paths */
+    unsigned int reorderMs;         /**< Reorder window of the packets of different paths in milliseconds (0: no reordering, multipath only) */
+
+} StreamInitContext_T;
+
 
 /* Streaming related public function declarations */
 
@@ -19,13 +46,56 @@
  * @brief       Initialize streaming services.
  * 
  * @details     Initializes GStreamer core and its plugins.
+ *              In headless mode the video display is replaced
+ *              by a frame counting sink and the time of the
+ *              first frame and the received frame count are
+ *              reported on the standard output every second
+ *              (see bench/loopback_bench.py of CompanionComputer).
+ *              With latency decoding the latency stamp of the
+ *              drone's test source is read from every decoded
+ *              frame and its glass-to-glass latency is reported
+ *              on the standard output (see bench/latency_bench.py
+ *              of CompanionComputer). With a dump path every
+ *              received RTP packet is written to the dump file
+ *              with its arrival time for offline analysis (see
+ *              tools/rtp_analyzer.c of CompanionComputer). With
+ *              a profile directory the display pipelines are
+ *              profiled (see profiler_utils.h). With a pinned
+ *              plugin directory only its plugins are loaded from
+ *              its registry without a scan (see plugin_utils.h).
+ *              The playing display pipeline is watched for stalls
+ *              at the network source and at the decoder output
+ *              (see handleStreamStall()). Duplicate RTP packets
+ *              (e.g. of a drone streaming on several paths) are
+ *              dropped by sequence number at the network source.
+ *              With multipath reception the control server accepts
+ *              Multipath TCP connections (see isStreamMultipath())
+ *              and with a reorder window the packets of the paths
+ *              are also put back in order by a jitter buffer of
+ *              that latency.
+ * 
+ * @param[in]   initCtx Initialization context (NULL: defaults).
  * 
  * @return      Result of execution.
  * 
  * @retval      0 Success
  * @retval      -1 Failure
  */
-int initStreamServices(void);
+int initStreamServices(const StreamInitContext_T *initCtx);
+
+/**
+ * @brief       Check headless mode.
+ * 
+ * @return      Non-zero if streaming services run headless.
+ */
+int isStreamHeadless(void);
+
+/**
+ * @brief       Check multipath reception.
+ * 
+ * @return      Non-zero if the drone may stream and connect over several paths.
+ */
+int isStreamMultipath(void);
 
 /**
  * @brief       Stop video stream.
@@ -70,4 +140,72 @@ int stopStream(GstElement* *pipeline);
  * @retval      0 Success
  * @retval      -1 Failure
  */
-int requestStream(const int socketFd, GstElement* *pipeline);
\ No newline at end of file
+int requestStream(const int socketFd, GstElement* *pipeline);
+
+/**
+ * @brief       Resume video stream.
+ * 
+ * @details     Restarts the video display after the drone recovered
+ *              its streaming pipeline and resumed the RTP video
+ *              stream on its own (see MOD_MSG_CODE_STREAM_RECOVERED).
+ *              The pipeline is rebuilt if the drone fell back to
+ *              another video coding format.
+ * 
+ * @note        GStreamer core and plugins must be initialized
+ *              before invoking this function.
+ * 
+ *              Only to be invoked while the user still wants video
+ *              (no 'stop' command since the stream request).
+ * 
+ * @param [in,out]  pipeline GStreamer video display pipeline.
+ * @param [in]  codingFormat Video coding format of the resumed stream.
+ * 
+ * @return      Result of execution.
+ * 
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+int resumeStream(GstElement* *pipeline, const VideoCodingFormat_T codingFormat);
+
+/**
+ * @brief       Release video stream.
+ * 
+ * @details     Stops and drops the video display pipeline
+ *              together with its stall watches.
+ * 
+ * @param [in,out]  pipeline GStreamer video display pipeline (set to NULL).
+ */
+void releaseStream(GstElement* *pipeline);
+
+/**
+ * @brief       Get stall report descriptor.
+ * 
+ * @details     The descriptor becomes readable when the stall
+ *              watchdog reports a stalled display pipeline. Poll it
+ *              next to the service socket and call handleStreamStall()
+ *              on POLLIN.
+ * 
+ * @return      File descriptor (negative if the watchdog is disabled).
+ */
+int getStreamStallFd(void);
+
+/**
+ * @brief       Handle video stream stall.
+ * 
+ * @details     Reads the stall reports. A display pipeline whose
+ *              decoder output stalled while video packets arrive is
+ *              rebuilt and restarted. A stalled network source is
+ *              only reported: the drone recovers its own pipeline
+ *              (see MOD_MSG_CODE_STREAM_RECOVERED) and a lost link
+ *              needs the user.
+ * 
+ * @note        Must be invoked from the thread owning the pipeline.
+ * 
+ * @param [in,out]  pipeline GStreamer video display pipeline.
+ * 
+ * @return      Result of execution.
+ * 
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+int handleStreamStall(GstElement* *pipeline);
\ No newline at end of file
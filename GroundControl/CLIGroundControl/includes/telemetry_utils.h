@@ -0,0 +1,131 @@
+/**
+ * @file        telemetry_utils.h
+ * @author      Adam Csizy
+ * @date        2021-05-26
+ * @version     v1.1.0
+ *
+ * @brief       Drone telemetry session registry
+ */
+
+#pragma once
+
+
+#include <stdint.h>
+
+
+/* Telemetry related public macro definitions */
+
+#define NUM_TELEMETRY_SESSION_MAX       4U      /**< Maximum number of drone sessions in the registry */
+#define NUM_TELEMETRY_VALUES            3U      /**< Number of values in a telemetry sample */
+
+
+/* Telemetry related public type definitions */
+
+/**
+ * @brief   Enumeration of telemetry channels.
+ *
+ * @details The meaning of the sample values per channel (see the
+ *          drone's telemetry_utils.h).
+ */
+typedef enum TelemetryChannel {
+
+    TLM_CHAN_POSITION   = 0,    /**< Latitude and longitude (1e-7 degrees), altitude (mm) */
+    TLM_CHAN_BATTERY    = 1,    /**< Voltage (mV), current (mA), remaining capacity (%) */
+    TLM_CHAN_LINK       = 2,    /**< RSSI (dBm), link quality (%), noise (dBm) */
+    TLM_CHAN_COUNT      = 3     /**< Number of telemetry channels */
+
+} TelemetryChannel_T;
+
+/**
+ * @brief   Struct of a telemetry sample.
+ */
+typedef struct TelemetrySample {
+
+    TelemetryChannel_T channel;             /**< Telemetry channel */
+    uint32_t ageMs;                         /**< Age of the sample in milliseconds */
+    int32_t values[NUM_TELEMETRY_VALUES];   /**< Sample values (see TelemetryChannel_T) */
+
+} TelemetrySample_T;
+
+
+/* Telemetry related public function declarations */
+
+/**
+ * @brief       Open telemetry session.
+ *
+ * @details     Registers a connected drone. Its telemetry is kept
+ *              until the session is closed. Thread-safe.
+ *
+ * @param[in]   droneID Drone ID.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure (registry full)
+ */
+int openTelemetrySession(const uint32_t droneID);
+
+/**
+ * @brief       Close telemetry session.
+ *
+ * @details     Drops a disconnected drone's telemetry. Thread-safe.
+ *
+ * @param[in]   droneID Drone ID.
+ */
+void closeTelemetrySession(const uint32_t droneID);
+
+/**
+ * @brief       Publish telemetry sample.
+ *
+ * @details     Stores the sample as the latest one of its channel in
+ *              the drone's session. In headless mode the sample is
+ *              also reported on the standard output:
+ *
+ *                  [telemetry] drone=<ID> channel=<NAME> v0=<V> v1=<V> v2=<V> age_ms=<AGE>
+ *
+ *              Thread-safe.
+ *
+ * @param[in]   droneID Drone ID.
+ * @param[in]   sample Received telemetry sample (age as sent by the drone).
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure (invalid sample or no session)
+ */
+int publishTelemetry(const uint32_t droneID, const TelemetrySample_T *sample);
+
+/**
+ * @brief       Get latest telemetry sample.
+ *
+ * @details     Thread-safe.
+ *
+ * @param[in]   droneID Drone ID.
+ * @param[in]   channel Telemetry channel.
+ * @param[out]  sample Latest sample of the channel (age includes the time since it was received).
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure (no session or no sample yet)
+ */
+int getTelemetry(const uint32_t droneID, const TelemetryChannel_T channel, TelemetrySample_T *sample);
+
+/**
+ * @brief       Print telemetry of a drone.
+ *
+ * @details     Prints the latest sample of every channel of the
+ *              drone's session on the standard output.
+ *
+ * @param[in]   droneID Drone ID.
+ */
+void printTelemetry(const uint32_t droneID);
+
+/**
+ * @brief       Get telemetry channel name.
+ *
+ * @param[in]   channel Telemetry channel.
+ *
+ * @return      Name of the channel ("unknown" if invalid).
+ */
+const char *getTelemetryChannelName(const TelemetryChannel_T channel);
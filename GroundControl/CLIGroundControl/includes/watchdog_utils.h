@@ -0,0 +1,107 @@
+/**
+ * @file        watchdog_utils.h
+ * @author      Adam Csizy
+ * @date        2021-05-24
+ * @version     v1.1.0
+ *
+ * @brief       Pipeline stall watchdog utilities
+ */
+
+#pragma once
+
+
+#include <gst/gst.h>
+
+
+/* Watchdog related public macro definitions */
+
+#define NUM_STALL_WATCH_MAX             4U      /**< Maximum number of watched pads */
+#define NUM_STALL_CHECK_PERIOD_MS       250U    /**< Period of the stall check in milliseconds */
+#define NUM_STALL_ARM_GRACE_MS          3000U   /**< Time given to the first buffer after arming in milliseconds */
+
+
+/* Watchdog related public type definitions */
+
+/**
+ * @brief   Stall callback function.
+ *
+ * @details Called on the default main context when a watched
+ *          pad passed no buffer for longer than its threshold.
+ *
+ * @param[in]   watchName Name of the stalled watch.
+ * @param[in]   stalledMs Time since the watch's last buffer in milliseconds.
+ * @param[in,out]   data User data of initStallWatchdog().
+ */
+typedef void (*StallCallback_T)(const char *watchName, const unsigned int stalledMs, void *data);
+
+
+/* Watchdog related public function declarations */
+
+/**
+ * @brief       Initialize pipeline stall watchdog.
+ *
+ * @details     Registers the stall callback and the periodic stall
+ *              check on the default main context. Must be called
+ *              after 'gst_init()' and before the other watchdog
+ *              functions. The watchdog starts disarmed.
+ *
+ * @param[in]   callback Stall callback.
+ * @param[in]   data User data passed to the callback.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+int initStallWatchdog(StallCallback_T callback, void *data);
+
+/**
+ * @brief       Add stall watch.
+ *
+ * @details     Adds a buffer probe to a pad of a pipeline element
+ *              taking the arrival time of every buffer passing it.
+ *              Watches must be added from upstream to downstream:
+ *              if several watches stall, only the most upstream
+ *              one is reported (the others starve behind it). A
+ *              zero threshold disables the watch.
+ *
+ * @param[in]   pipeline GStreamer pipeline.
+ * @param[in]   elementName Name of the pipeline element.
+ * @param[in]   padName Name of the element's static pad.
+ * @param[in]   watchName Name of the watch (reported, static string).
+ * @param[in]   thresholdMs Stall threshold in milliseconds (0: disabled).
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success (or disabled)
+ * @retval      -1 Failure
+ */
+int addStallWatch(GstElement *pipeline, const char *elementName, const char *padName, const char *watchName, const unsigned int thresholdMs);
+
+/**
+ * @brief       Clear stall watches.
+ *
+ * @details     Disarms the watchdog and removes the probes of every
+ *              watch. To be called before the watched pipeline is
+ *              released.
+ */
+void clearStallWatches(void);
+
+/**
+ * @brief       Arm stall watchdog.
+ *
+ * @details     Starts the stall check of the watches once the
+ *              pipeline is playing. Each watch gets
+ *              NUM_STALL_ARM_GRACE_MS for its first buffer on top
+ *              of its threshold. Thread-safe.
+ */
+void armStallWatchdog(void);
+
+/**
+ * @brief       Disarm stall watchdog.
+ *
+ * @details     Stops the stall check (e.g. the pipeline is stopped
+ *              or failed). The watchdog disarms itself after
+ *              reporting a stall. Thread-safe.
+ */
+void disarmStallWatchdog(void);
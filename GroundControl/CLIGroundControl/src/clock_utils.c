@@ -0,0 +1,253 @@
+/**
+ * @file        clock_utils.c
+ * @author      Adam Csizy
+ * @date        2021-05-31
+ * @version     v1.1.0
+ *
+ * @brief       Ground clock and RTP clock mapping utilities
+ */
+
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <syslog.h>
+#include <time.h>
+
+#include "clock_utils.h"
+#include "log_utils.h"
+
+
+/* Clock related macro definitions */
+
+#define NUM_NSEC_PER_SEC            1000000000LL    /**< Nanoseconds in a second */
+
+
+/* Clock related static type declarations */
+
+/**
+ * @brief   Struct of a mapped video stream.
+ */
+typedef struct ClockMappingEntry {
+
+    int used;                   /**< Flag whether the entry is used */
+    uint32_t droneID;           /**< Drone ID */
+    ClockMapping_T mapping;     /**< Latest mapping of the stream */
+    uint64_t updatedNs;         /**< Ground time of receiving the mapping */
+
+} ClockMappingEntry_T;
+
+
+/* Clock related static variable declarations */
+
+static ClockMappingEntry_T entries[NUM_CLOCK_MAPPING_MAX];      /**< Mapped video streams */
+static ArrivalLatency_T arrivalLatency;                         /**< Latency of the frames recorded since the last take */
+static int64_t arrivalLatencySumUs = 0;                         /**< Sum of the recorded latencies */
+static pthread_mutex_t clockLock = PTHREAD_MUTEX_INITIALIZER;   /**< Lock of the mappings and the latency */
+
+
+/* Clock related static function declarations */
+
+/**
+ * @brief       Find mapping of a video stream.
+ *
+ * @note        The clock lock must be held.
+ *
+ * @param[in]   ssrc SSRC of the video stream.
+ *
+ * @return      Entry of the stream or NULL.
+ */
+static ClockMappingEntry_T *findMapping(const uint32_t ssrc);
+
+/**
+ * @brief       Apply mapping to RTP timestamp.
+ *
+ * @param[in]   mapping RTP clock mapping.
+ * @param[in]   rtpTimestamp RTP timestamp.
+ *
+ * @return      Ground time of the RTP timestamp.
+ */
+static uint64_t applyClockMapping(const ClockMapping_T *mapping, const uint32_t rtpTimestamp);
+
+
+/* Clock related function definitions */
+
+uint64_t getGroundTimeNs(void) {
+
+    struct timespec now;
+
+    clock_gettime(CLOCK_REALTIME, &now);
+
+    return (uint64_t)(now.tv_sec) * (uint64_t)(NUM_NSEC_PER_SEC) + (uint64_t)(now.tv_nsec);
+}
+
+int updateClockMapping(const uint32_t droneID, const ClockMapping_T *mapping) {
+
+    int retval = 0;
+    int mapped;
+    unsigned int i;
+    ClockMappingEntry_T *entry = NULL;
+
+    if(NULL == mapping) {
+
+        createLogMessage(STR_LOG_MSG_FUNC44_ARG_INVAL, LOG_SVRTY_ERR);
+        retval = -1;
+        return retval;
+    }
+
+    pthread_mutex_lock(&clockLock);
+
+    entry = findMapping(mapping->ssrc);
+    mapped = (NULL != entry);
+    for(i = 0;(i < NUM_CLOCK_MAPPING_MAX) && (NULL == entry);++i) {
+
+        if(!entries[i].used) {
+
+            entry = &entries[i];
+        }
+    }
+
+    /* Every entry taken: the stream updated least recently is gone most likely */
+    if(NULL == entry) {
+
+        entry = &entries[0];
+        for(i = 1;i < NUM_CLOCK_MAPPING_MAX;++i) {
+
+            if(entries[i].updatedNs < entry->updatedNs) {
+
+                entry = &entries[i];
+            }
+        }
+    }
+
+    entry->used = 1;
+    entry->droneID = droneID;
+    entry->mapping = *mapping;
+    entry->updatedNs = getGroundTimeNs();
+
+    pthread_mutex_unlock(&clockLock);
+
+    if(!mapped) {
+
+        fprintf(stdout, STR_LOG_MSG_FUNC44_MAPPED, mapping->ssrc, droneID, mapping->uncertaintyUs);
+        fflush(stdout);
+        syslog(LOG_USER | LOG_INFO, STR_LOG_MSG_FUNC44_MAPPED, mapping->ssrc, droneID, mapping->uncertaintyUs);
+    }
+
+    return retval;
+}
+
+void dropClockMappings(const uint32_t droneID) {
+
+    unsigned int i;
+
+    pthread_mutex_lock(&clockLock);
+
+    for(i = 0;i < NUM_CLOCK_MAPPING_MAX;++i) {
+
+        if(entries[i].used && (droneID == entries[i].droneID)) {
+
+            memset(&entries[i], 0, sizeof(entries[i]));
+        }
+    }
+
+    pthread_mutex_unlock(&clockLock);
+}
+
+int convertRtpToGroundTime(const uint32_t ssrc, const uint32_t rtpTimestamp, uint64_t *groundNs) {
+
+    int retval = -1;
+    ClockMappingEntry_T *entry = NULL;
+
+    if(NULL == groundNs) {
+
+        return retval;
+    }
+
+    pthread_mutex_lock(&clockLock);
+
+    entry = findMapping(ssrc);
+    if(NULL != entry) {
+
+        *groundNs = applyClockMapping(&entry->mapping, rtpTimestamp);
+        retval = 0;
+    }
+
+    pthread_mutex_unlock(&clockLock);
+
+    return retval;
+}
+
+void recordFrameArrival(const uint32_t ssrc, const uint32_t rtpTimestamp, const uint64_t arrivalNs) {
+
+    int64_t latencyUs;
+    ClockMappingEntry_T *entry = NULL;
+
+    pthread_mutex_lock(&clockLock);
+
+    entry = findMapping(ssrc);
+    if(NULL != entry) {
+
+        latencyUs = ((int64_t)(arrivalNs) - (int64_t)(applyClockMapping(&entry->mapping, rtpTimestamp))) / 1000LL;
+        if((0U == arrivalLatency.frames) || (latencyUs > arrivalLatency.maxUs)) {
+
+            arrivalLatency.maxUs = latencyUs;
+        }
+        if(entry->mapping.uncertaintyUs > arrivalLatency.uncertaintyUs) {
+
+            arrivalLatency.uncertaintyUs = entry->mapping.uncertaintyUs;
+        }
+        arrivalLatencySumUs += latencyUs;
+        ++arrivalLatency.frames;
+    }
+
+    pthread_mutex_unlock(&clockLock);
+}
+
+int takeArrivalLatency(ArrivalLatency_T *latency) {
+
+    int retval = -1;
+
+    if(NULL == latency) {
+
+        return retval;
+    }
+
+    pthread_mutex_lock(&clockLock);
+
+    if(0U < arrivalLatency.frames) {
+
+        arrivalLatency.meanUs = arrivalLatencySumUs / (int64_t)(arrivalLatency.frames);
+        *latency = arrivalLatency;
+        memset(&arrivalLatency, 0, sizeof(arrivalLatency));
+        arrivalLatencySumUs = 0;
+        retval = 0;
+    }
+
+    pthread_mutex_unlock(&clockLock);
+
+    return retval;
+}
+
+static ClockMappingEntry_T *findMapping(const uint32_t ssrc) {
+
+    unsigned int i;
+
+    for(i = 0;i < NUM_CLOCK_MAPPING_MAX;++i) {
+
+        if(entries[i].used && (ssrc == entries[i].mapping.ssrc)) {
+
+            return &entries[i];
+        }
+    }
+
+    return NULL;
+}
+
+static uint64_t applyClockMapping(const ClockMapping_T *mapping, const uint32_t rtpTimestamp) {
+
+    /* Signed distance: frames before the mapped one map too (the RTP timestamp wraps every 13 hours) */
+    int64_t ticks = (int64_t)((int32_t)(rtpTimestamp - mapping->rtpTimestamp));
+
+    return mapping->groundNs + (uint64_t)(ticks * NUM_NSEC_PER_SEC / (int64_t)(NUM_CLOCK_RTP_RATE));
+}
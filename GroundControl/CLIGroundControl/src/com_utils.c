@@ -21,9 +21,14 @@
 #include <sys/socket.h>
 #include <sys/types.h>
 
+#include "clock_utils.h"
 #include "com_utils.h"
 #include "log_utils.h"
+#include "profiler_utils.h"
+#include "qos_utils.h"
+#include "snapshot_utils.h"
 #include "stream_utils.h"
+#include "telemetry_utils.h"
 
 
 /* Communication related macro definitions */
@@ -32,6 +37,9 @@
 #define LoginMessageField_T uint32_t    /**< Type of the fields in the login netork message */
 
 #define SOCK_FD_INVAL -1                /**< Invalid socket file descriptor */
+#ifndef IPPROTO_MPTCP
+#define IPPROTO_MPTCP 262               /**< Multipath TCP protocol number (older libc headers, Linux 5.6+) */
+#endif
 #define NUM_SERVER_PORT 5010            /**< Port number of TCP server */
 #define NUM_SERVER_PEND_QUEUE_LIMIT 16  /**< Maximal number of pending connections */
 #define NUM_DRONE_SRVC_THRD_POOL_SIZE 1 /**< Thread pool size of drone service threads */
@@ -41,15 +49,40 @@
 #define NUM_LOGIN_MSG_SIZE 2U           /**< Size of login message array in LoginMessageField_T */
 #define IDX_LOGIN_MSG_CODE 0U           /**< Index of module message code in login message array */
 #define IDX_LOGIN_MSG_ID 1U             /**< Index of drone ID in login message array */
-#define NUM_POLL_ARR_SIZE 2U            /**< Size of poll array */
+#define NUM_POLL_ARR_SIZE 3U            /**< Size of poll array */
 #define IDX_POLL_ARR_SOCK 1U            /**< Index of socket element in poll array */
 #define IDX_POLL_ARR_CLI 0U             /**< Index of CLI element in poll array */
+#define IDX_POLL_ARR_STALL 2U           /**< Index of stall report element in poll array */
 #define NUM_MAX_CMD_ARGS 1U             /**< Maximal number of user command arguments including the command itself */
 #define NUM_CMD_BUFF_SIZE 64U           /**< Size of the user command buffer in bytes */
+#define NUM_TELEMETRY_MSG_FIELDS 5U     /**< Size of telemetry message data array in uint32_t (channel, age, values) */
+#define IDX_TELEMETRY_MSG_CHANNEL 0U    /**< Index of telemetry channel in telemetry message data array */
+#define IDX_TELEMETRY_MSG_AGE 1U        /**< Index of sample age in telemetry message data array */
+#define IDX_TELEMETRY_MSG_VALUES 2U     /**< Index of the first sample value in telemetry message data array */
+#define NUM_SNAPSHOT_MSG_FIELDS 3U      /**< Size of snapshot (and snapshot data) message data array in uint32_t */
+#define IDX_SNAPSHOT_MSG_ID 0U          /**< Index of snapshot ID in snapshot message data array */
+#define IDX_SNAPSHOT_MSG_SIZE 1U        /**< Index of image size in snapshot message data array */
+#define IDX_SNAPSHOT_MSG_STATUS 2U      /**< Index of status in snapshot message data array */
+#define IDX_SNAPSHOT_MSG_OFFSET 1U      /**< Index of chunk offset in snapshot data message data array */
+#define IDX_SNAPSHOT_MSG_LENGTH 2U      /**< Index of chunk length in snapshot data message data array */
+#define NUM_CLOCK_REQ_MSG_FIELDS 2U     /**< Size of clock request message data array in uint32_t (origin time) */
+#define NUM_CLOCK_RESP_MSG_FIELDS 6U    /**< Size of clock response message data array in uint32_t (origin, receive and transmit time) */
+#define IDX_CLOCK_MSG_ORIGIN 0U         /**< Index of origin time (high half) in clock message data array */
+#define IDX_CLOCK_MSG_RECEIVE 2U        /**< Index of receive time (high half) in clock response message data array */
+#define IDX_CLOCK_MSG_TRANSMIT 4U       /**< Index of transmit time (high half) in clock response message data array */
+#define NUM_CLOCK_MAP_MSG_FIELDS 5U     /**< Size of RTP clock mapping message data array in uint32_t */
+#define IDX_CLOCK_MAP_MSG_SSRC 0U       /**< Index of SSRC in RTP clock mapping message data array */
+#define IDX_CLOCK_MAP_MSG_RTP 1U        /**< Index of RTP timestamp in RTP clock mapping message data array */
+#define IDX_CLOCK_MAP_MSG_GROUND 2U     /**< Index of ground time (high half) in RTP clock mapping message data array */
+#define IDX_CLOCK_MAP_MSG_UNCERTAINTY 4U /**< Index of uncertainty in RTP clock mapping message data array */
+#define NUM_HEADLESS_REQ_ATTEMPTS 3U    /**< Stream request attempts in headless mode (the drone may still be building its pipeline) */
 
 #define STR_USR_CMD_STRM_PLAY   "play"  /**< String of 'play' user command */
 #define STR_USR_CMD_STRM_STOP   "stop"  /**< String of 'stop' user command */
 #define STR_USR_CMD_DRN_DCON    "dconn" /**< String of 'dconn' user command */
+#define STR_USR_CMD_PROF_DUMP   "prof"  /**< String of 'prof' user command */
+#define STR_USR_CMD_TELEMETRY   "telem" /**< String of 'telem' user command */
+#define STR_USR_CMD_SNAPSHOT    "snap"  /**< String of 'snap' user command */
 
 
 /* Communication related static variable declarations */
@@ -138,14 +171,16 @@ static int authDrone(const int serviceSocket, LoginMessageField_T *droneID);
  *              is cleaned up to preserve consistency. 
  * 
  * @param[in]   serviceSocket File descriptor of service socket.
+ * @param[in]   droneID Drone ID (telemetry session).
  * @param[in,out]   pipeline GStreamer video display pipeline.
+ * @param[in]   streamWanted Non-zero if the user still wants video (resumes recovered streams).
  * 
  * @return      Result of execution.
  * 
  * @retval      0 Success
  * @retval      -1 Failure
  */
-static int inputMessageHandler(const int serviceSocket, GstElement* *pipeline);
+static int inputMessageHandler(const int serviceSocket, const uint32_t droneID, GstElement* *pipeline, const int streamWanted);
 
 /**
  * @brief       Handle input commands.
@@ -156,15 +191,17 @@ static int inputMessageHandler(const int serviceSocket, GstElement* *pipeline);
  *              handler functions.
  * 
  * @param[in]   stdinFd File descriptor of the standard input.
+ * @param[in]   droneID Drone ID (telemetry session).
  * @param[in,out]   exitCondition Exit condition for the caller thread.
  * @param[in,out]   pipeline GStreamer video display pipeline.
+ * @param[in,out]   streamWanted Set by 'play', cleared by 'stop'.
  * 
  * @return      Result of execution.
  * 
  * @retval      0 Success
  * @retval      -1 Failure
  */
-static int inputCommandHandler(const int stdinFd, int *exitCondition, GstElement* *pipeline);
+static int inputCommandHandler(const int stdinFd, const uint32_t droneID, int *exitCondition, GstElement* *pipeline, int *streamWanted);
 
 /**
  * @brief       Send stream stop message.
@@ -181,6 +218,55 @@ static int inputCommandHandler(const int stdinFd, int *exitCondition, GstElement
  */
 static int sendStopMessage(const int serviceSocket);
 
+/**
+ * @brief       Send profile dump message.
+ * 
+ * @details     Asks the drone to dump the profile of its
+ *              video streaming pipeline (see profiler_utils.h).
+ * 
+ * @param[in]   serviceSocket File descriptor of service socket.
+ * 
+ * @return      Result of execution.
+ * 
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+static int sendProfileMessage(const int serviceSocket);
+
+/**
+ * @brief       Send snapshot request message.
+ * 
+ * @details     Asks the drone to take a full resolution still
+ *              snapshot of the running stream (see snapshot_utils.h).
+ * 
+ * @param[in]   serviceSocket File descriptor of service socket.
+ * 
+ * @return      Result of execution.
+ * 
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+static int sendSnapshotMessage(const int serviceSocket);
+
+/**
+ * @brief       Send clock response message.
+ * 
+ * @details     Answers a clock request of the drone with the origin
+ *              time of the request, the ground time of its receipt
+ *              and the ground time of sending the response (stamped
+ *              right before sending, see clock_utils.h).
+ * 
+ * @param[in]   serviceSocket File descriptor of service socket.
+ * @param[in]   originNs Origin time of the request (drone's local time).
+ * @param[in]   receiveNs Ground time of receiving the request.
+ * 
+ * @return      Result of execution.
+ * 
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+static int sendClockResponse(const int serviceSocket, const uint64_t originNs, const uint64_t receiveNs);
+
 /**
  * @brief       Clean up input messages.
  * 
@@ -197,6 +283,24 @@ static int sendStopMessage(const int serviceSocket);
  */
 static void cleanupInputMessages(const int sockFd);
 
+/**
+ * @brief       Request video stream in headless mode.
+ * 
+ * @details     Requests the video stream right after the drone
+ *              connected, without user command. Failed requests
+ *              are retried NUM_HEADLESS_REQ_ATTEMPTS times; late
+ *              responses of a failed attempt are discarded.
+ * 
+ * @param[in]   serviceSocket File descriptor of service socket.
+ * @param[in,out]   pipeline Video display pipeline.
+ * 
+ * @return      Result of execution.
+ * 
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+static int requestHeadlessStream(const int serviceSocket, GstElement* *pipeline);
+
 
 /* Communication related function definitions */
 
@@ -247,8 +351,22 @@ static int startServer(void) {
     int reuseAddrState = 1;
     struct sockaddr_in6 serverAddress;
 
+    /* Multipath drones keep their control link over the remaining paths (plain TCP drones are accepted too) */
+    serverSocketFd = SOCK_FD_INVAL;
+    if (isStreamMultipath()) {
+
+        serverSocketFd = socket(PF_INET6, SOCK_STREAM, IPPROTO_MPTCP);
+        if (0 > serverSocketFd) {
+
+            createLogMessage(STR_LOG_MSG_FUNC2_MPTCP_FALLBACK, LOG_SVRTY_WRN);
+        }
+    }
+
     /* Create a TCP server socket with IPv6 compatibility */
-    serverSocketFd = socket(PF_INET6, SOCK_STREAM, 0);
+    if (0 > serverSocketFd) {
+
+        serverSocketFd = socket(PF_INET6, SOCK_STREAM, 0);
+    }
     if (0 > serverSocketFd) {
 
         perror("socket");
@@ -343,6 +461,7 @@ static void *threadFuncDroneService(void *arg) {
     struct sockaddr_storage clientAddress;
     struct pollfd pollArray[NUM_POLL_ARR_SIZE];
     socklen_t clientAddressLength = sizeof(clientAddress);
+    int streamWanted = FALSE;
     GstElement *pipeline = NULL;
     LoginMessageField_T droneID = 0U;
     // Use thread context wrapper if more params needed to be passed as arguments
@@ -401,6 +520,14 @@ static void *threadFuncDroneService(void *arg) {
                 syslog(LOG_USER | LOG_ERR, STR_LOG_MSG_FUNC4_SOCK_CONF_FAIL, threadId);
             }
 
+            /* Mark control traffic above video */
+            if (setSocketTrafficClass(serviceSocket, QOS_CLASS_CONTROL)) {
+
+                fprintf(stdout, STR_LOG_MSG_FUNC4_SOCK_QOS_FAIL, threadId);
+                fflush(stdout);
+                syslog(LOG_USER | LOG_WARNING, STR_LOG_MSG_FUNC4_SOCK_QOS_FAIL, threadId);
+            }
+
             /* Authenticate drone */
             if (0 > authDrone(serviceSocket, &droneID)) {
 
@@ -418,14 +545,28 @@ static void *threadFuncDroneService(void *arg) {
                 fflush(stdout);
                 syslog(LOG_USER | LOG_INFO, STR_LOG_MSG_FUNC4_DRONE_AUTH_SUCCESS, threadId, droneID);
 
-                /* Initialize poll array and exit condition */
+                /* Telemetry of the drone is kept until it disconnects (failure only drops the telemetry) */
+                openTelemetrySession(droneID);
+
+                /* Initialize poll array and exit condition (no user commands in headless mode) */
                 pollArray[IDX_POLL_ARR_CLI].events = POLLIN;
-                pollArray[IDX_POLL_ARR_CLI].fd = STDIN_FILENO;
+                pollArray[IDX_POLL_ARR_CLI].fd = isStreamHeadless() ? SOCK_FD_INVAL : STDIN_FILENO;
                 pollArray[IDX_POLL_ARR_SOCK].events = POLLIN;
                 pollArray[IDX_POLL_ARR_SOCK].fd = serviceSocket;
+                pollArray[IDX_POLL_ARR_STALL].events = POLLIN;
+                pollArray[IDX_POLL_ARR_STALL].fd = getStreamStallFd();
 
                 exitCondition = 0;
 
+                /* Headless mode plays the stream without user command */
+                streamWanted = isStreamHeadless();
+                if (isStreamHeadless() && requestHeadlessStream(serviceSocket, &pipeline)) {
+
+                    fprintf(stdout, STR_LOG_MSG_FUNC4_HEADLESS_REQ_FAIL, threadId);
+                    fflush(stdout);
+                    syslog(LOG_USER | LOG_ERR, STR_LOG_MSG_FUNC4_HEADLESS_REQ_FAIL, threadId);
+                }
+
                 /* Communication loop */
                 while (!exitCondition) {
 
@@ -456,7 +597,7 @@ static void *threadFuncDroneService(void *arg) {
                             else {
 
                                 /* Handle incoming drone message */
-                                if(inputMessageHandler(pollArray[IDX_POLL_ARR_SOCK].fd, &pipeline)) {
+                                if(inputMessageHandler(pollArray[IDX_POLL_ARR_SOCK].fd, droneID, &pipeline, streamWanted)) {
                                     syslog(LOG_USER | LOG_ERR, STR_LOG_MSG_FUNC4_MSG_HANDLE_FAIL, threadId);
                                 }
                                 // TODO Update exit condition if needed
@@ -466,19 +607,28 @@ static void *threadFuncDroneService(void *arg) {
                         if ((pollArray[IDX_POLL_ARR_CLI].revents & (POLLIN)) && (!exitCondition)) {
 
                             /* Handle CLI user input */
-                            if(inputCommandHandler(pollArray[IDX_POLL_ARR_SOCK].fd, &exitCondition, &pipeline)) {
+                            if(inputCommandHandler(pollArray[IDX_POLL_ARR_SOCK].fd, droneID, &exitCondition, &pipeline, &streamWanted)) {
                                 syslog(LOG_USER | LOG_ERR, STR_LOG_MSG_FUNC4_CLI_HANDLE_FAIL, threadId);
                             }
                         }
+
+                        if ((pollArray[IDX_POLL_ARR_STALL].revents & (POLLIN)) && (!exitCondition)) {
+
+                            /* Handle stall of the video display pipeline (see stream_utils.h) */
+                            if(handleStreamStall(&pipeline)) {
+                                syslog(LOG_USER | LOG_ERR, STR_LOG_MSG_FUNC4_STALL_HANDLE_FAIL, threadId);
+                            }
+                        }
                     }
                 }
 
                 /* Free pipeline */
-                if(NULL != pipeline) {
-                    gst_element_set_state(pipeline, GST_STATE_NULL);
-                    gst_object_unref(pipeline);
-                    pipeline = NULL;
-                }
+                releaseStream(&pipeline);
+
+                /* Drop telemetry and unfinished snapshots of the drone */
+                closeTelemetrySession(droneID);
+                dropSnapshots(droneID);
+                dropClockMappings(droneID);
 
                 // Stop auxiliary threads if necessary
 
@@ -556,10 +706,19 @@ static int authDrone(const int serviceSocket, LoginMessageField_T *droneID) {
     return retval;
 }
 
-static int inputMessageHandler(const int serviceSocket, GstElement* *pipeline) {
+static int inputMessageHandler(const int serviceSocket, const uint32_t droneID, GstElement* *pipeline, const int streamWanted) {
 
     int retval = 0;
     int length;
+    unsigned int i;
+    uint32_t codingFormat = 0U;
+    uint32_t telemetryData[NUM_TELEMETRY_MSG_FIELDS] = {0};
+    uint32_t snapshotData[NUM_SNAPSHOT_MSG_FIELDS] = {0};
+    static uint8_t snapshotChunk[NUM_SNAPSHOT_CHUNK_SIZE];
+    uint32_t clockData[NUM_CLOCK_MAP_MSG_FIELDS] = {0};
+    uint64_t receiveNs;
+    TelemetrySample_T sample;
+    ClockMapping_T mapping;
     MessageHeaderField_T messageHeader[NUM_MSG_HEADER_SIZE] = {0};
 
     if ((0 > serverSocketFd) || (NULL == pipeline)) {
@@ -569,6 +728,9 @@ static int inputMessageHandler(const int serviceSocket, GstElement* *pipeline) {
     }
     else {
 
+        /* Receive time of clock requests: the message is readable already */
+        receiveNs = getGroundTimeNs();
+
         length = recvTimeout(serviceSocket, messageHeader, sizeof(messageHeader), MSG_WAITALL, 2, 0);
         if (length < 0) {
 
@@ -588,7 +750,7 @@ static int inputMessageHandler(const int serviceSocket, GstElement* *pipeline) {
 
                 case MOD_MSG_CODE_STREAM_ERROR:
 
-                    printf("\n[WARNING]: Video stream closed due to internal error on drone side.\n");
+                    printf("\n[WARNING]: Video stream closed due to internal error on drone side. The drone is recovering it.\n");
                     fflush(stdout);
                     if(stopStream(pipeline)) {
 
@@ -597,6 +759,131 @@ static int inputMessageHandler(const int serviceSocket, GstElement* *pipeline) {
                     }
                     break;
 
+                case MOD_MSG_CODE_STREAM_RECOVERED:
+
+                    /* Ignored after 'stop' (the drone resumed before the stop message arrived) */
+                    length = recvTimeout(serviceSocket, &codingFormat, sizeof(codingFormat), MSG_WAITALL, 2, 0);
+                    if(sizeof(codingFormat) > length) {
+
+                        createLogMessage(STR_LOG_MSG_FUNC8_MSG_DATA_RECV_FAIL, LOG_SVRTY_ERR);
+                        retval = -1;
+                    }
+                    else if(streamWanted && resumeStream(pipeline, (VideoCodingFormat_T)(codingFormat))) {
+
+                        createLogMessage(STR_LOG_MSG_FUNC8_STRM_RESUME_FAIL, LOG_SVRTY_ERR);
+                        retval = -1;
+                    }
+                    break;
+
+                case MOD_MSG_CODE_TELEMETRY:
+
+                    length = recvTimeout(serviceSocket, telemetryData, sizeof(telemetryData), MSG_WAITALL, 2, 0);
+                    if(sizeof(telemetryData) > length) {
+
+                        createLogMessage(STR_LOG_MSG_FUNC8_MSG_DATA_RECV_FAIL, LOG_SVRTY_ERR);
+                        retval = -1;
+                    }
+                    else if(TLM_CHAN_COUNT <= telemetryData[IDX_TELEMETRY_MSG_CHANNEL]) {
+
+                        /* Channel of a newer drone: the message is consumed, the sample is dropped */
+                        createLogMessage(STR_LOG_MSG_FUNC8_TELEMETRY_INVAL, LOG_SVRTY_WRN);
+                    }
+                    else {
+
+                        sample.channel = (TelemetryChannel_T)(telemetryData[IDX_TELEMETRY_MSG_CHANNEL]);
+                        sample.ageMs = telemetryData[IDX_TELEMETRY_MSG_AGE];
+                        for(i = 0;i < NUM_TELEMETRY_VALUES;++i) {
+
+                            sample.values[i] = (int32_t)(telemetryData[IDX_TELEMETRY_MSG_VALUES + i]);
+                        }
+                        publishTelemetry(droneID, &sample);
+                    }
+                    break;
+
+                case MOD_MSG_CODE_SNAPSHOT:
+
+                    length = recvTimeout(serviceSocket, snapshotData, sizeof(snapshotData), MSG_WAITALL, 2, 0);
+                    if(sizeof(snapshotData) > length) {
+
+                        createLogMessage(STR_LOG_MSG_FUNC8_MSG_DATA_RECV_FAIL, LOG_SVRTY_ERR);
+                        retval = -1;
+                    }
+                    else if((0 != (int32_t)(snapshotData[IDX_SNAPSHOT_MSG_STATUS])) || (0U == snapshotData[IDX_SNAPSHOT_MSG_SIZE])) {
+
+                        fprintf(stdout, STR_LOG_MSG_FUNC8_SNAPSHOT_FAIL, snapshotData[IDX_SNAPSHOT_MSG_ID]);
+                        fflush(stdout);
+                        syslog(LOG_USER | LOG_WARNING, STR_LOG_MSG_FUNC8_SNAPSHOT_FAIL, snapshotData[IDX_SNAPSHOT_MSG_ID]);
+                    }
+                    else {
+
+                        /* Failure is logged, the data chunks are ignored then */
+                        beginSnapshot(droneID, snapshotData[IDX_SNAPSHOT_MSG_ID], snapshotData[IDX_SNAPSHOT_MSG_SIZE]);
+                    }
+                    break;
+
+                case MOD_MSG_CODE_SNAPSHOT_DATA:
+
+                    /* Fixed part, then the chunk (the service thread is the only reader of the chunk buffer) */
+                    length = recvTimeout(serviceSocket, snapshotData, sizeof(snapshotData), MSG_WAITALL, 2, 0);
+                    if(sizeof(snapshotData) > length) {
+
+                        createLogMessage(STR_LOG_MSG_FUNC8_MSG_DATA_RECV_FAIL, LOG_SVRTY_ERR);
+                        retval = -1;
+                    }
+                    else if(NUM_SNAPSHOT_CHUNK_SIZE < snapshotData[IDX_SNAPSHOT_MSG_LENGTH]) {
+
+                        cleanupInputMessages(serviceSocket);
+                        createLogMessage(STR_LOG_MSG_FUNC8_SNAPSHOT_INVAL, LOG_SVRTY_WRN);
+                        retval = -1;
+                    }
+                    else if((int)(snapshotData[IDX_SNAPSHOT_MSG_LENGTH]) > recvTimeout(serviceSocket, snapshotChunk,
+                                snapshotData[IDX_SNAPSHOT_MSG_LENGTH], MSG_WAITALL, 2, 0)) {
+
+                        createLogMessage(STR_LOG_MSG_FUNC8_MSG_DATA_RECV_FAIL, LOG_SVRTY_ERR);
+                        retval = -1;
+                    }
+                    else {
+
+                        receiveSnapshotData(droneID, snapshotData[IDX_SNAPSHOT_MSG_ID], snapshotData[IDX_SNAPSHOT_MSG_OFFSET],
+                            snapshotChunk, snapshotData[IDX_SNAPSHOT_MSG_LENGTH]);
+                    }
+                    break;
+
+                case MOD_MSG_CODE_CLOCK_REQ:
+
+                    length = recvTimeout(serviceSocket, clockData, NUM_CLOCK_REQ_MSG_FIELDS * sizeof(uint32_t), MSG_WAITALL, 2, 0);
+                    if((int)(NUM_CLOCK_REQ_MSG_FIELDS * sizeof(uint32_t)) > length) {
+
+                        createLogMessage(STR_LOG_MSG_FUNC8_MSG_DATA_RECV_FAIL, LOG_SVRTY_ERR);
+                        retval = -1;
+                    }
+                    else {
+
+                        /* Failure is logged, the drone sends another request later */
+                        sendClockResponse(serviceSocket, ((uint64_t)(clockData[IDX_CLOCK_MSG_ORIGIN]) << 32) |
+                            (uint64_t)(clockData[IDX_CLOCK_MSG_ORIGIN + 1U]), receiveNs);
+                    }
+                    break;
+
+                case MOD_MSG_CODE_CLOCK_MAP:
+
+                    length = recvTimeout(serviceSocket, clockData, sizeof(clockData), MSG_WAITALL, 2, 0);
+                    if(sizeof(clockData) > length) {
+
+                        createLogMessage(STR_LOG_MSG_FUNC8_MSG_DATA_RECV_FAIL, LOG_SVRTY_ERR);
+                        retval = -1;
+                    }
+                    else {
+
+                        mapping.ssrc = clockData[IDX_CLOCK_MAP_MSG_SSRC];
+                        mapping.rtpTimestamp = clockData[IDX_CLOCK_MAP_MSG_RTP];
+                        mapping.groundNs = ((uint64_t)(clockData[IDX_CLOCK_MAP_MSG_GROUND]) << 32) |
+                            (uint64_t)(clockData[IDX_CLOCK_MAP_MSG_GROUND + 1U]);
+                        mapping.uncertaintyUs = clockData[IDX_CLOCK_MAP_MSG_UNCERTAINTY];
+                        updateClockMapping(droneID, &mapping);
+                    }
+                    break;
+
                 default:
 
                     /* Invalid module message received. Clean up RX buffer. */
@@ -610,7 +897,7 @@ static int inputMessageHandler(const int serviceSocket, GstElement* *pipeline) {
     return retval;
 }
 
-static int inputCommandHandler(const int serviceSocket, int *exitCondition, GstElement* *pipeline) {
+static int inputCommandHandler(const int serviceSocket, const uint32_t droneID, int *exitCondition, GstElement* *pipeline, int *streamWanted) {
 
     int retval = 0;
     int cmdArgIndex = 0;
@@ -618,7 +905,7 @@ static int inputCommandHandler(const int serviceSocket, int *exitCondition, GstE
     const char delim[] = " ";
     char cmdInputBuffer[NUM_CMD_BUFF_SIZE] = {0};
 
-    if ((0 > serviceSocket) || (NULL == pipeline) || (NULL == exitCondition)) {
+    if ((0 > serviceSocket) || (NULL == pipeline) || (NULL == exitCondition) || (NULL == streamWanted)) {
 
         createLogMessage(STR_LOG_MSG_FUNC9_ARG_INVAL, LOG_SVRTY_ERR);
         retval = -1;
@@ -648,6 +935,7 @@ static int inputCommandHandler(const int serviceSocket, int *exitCondition, GstE
                 /* Request video stream */
                 printf(">> Ground control requested video stream <<\n");
                 fflush(stdout);
+                *streamWanted = TRUE;
                 if(requestStream(serviceSocket, pipeline)) {
                     createLogMessage(STR_LOG_MSG_FUNC9_REQ_STRM_FAIL, LOG_SVRTY_ERR);
                     retval = -1;
@@ -658,6 +946,7 @@ static int inputCommandHandler(const int serviceSocket, int *exitCondition, GstE
                 /* Stop video stream */
                 printf(">> Ground control stopped video stream <<\n");
                 fflush(stdout);
+                *streamWanted = FALSE;
                 if(stopStream(pipeline)) {
                     createLogMessage(STR_LOG_MSG_FUNC9_STOP_STRM_FAIL, LOG_SVRTY_ERR);
                     retval = -1;
@@ -667,6 +956,32 @@ static int inputCommandHandler(const int serviceSocket, int *exitCondition, GstE
                     retval = -1;
                 }
             }
+            else if(0 == strcmp(cmdArgs[0], STR_USR_CMD_PROF_DUMP)) {
+
+                /* Dump pipeline profiles on both sides (profilers are enabled with -P and CC_PROFILE_DIR) */
+                printf(">> Ground control requested pipeline profiles <<\n");
+                fflush(stdout);
+                requestPipelineProfileDump();
+                if(sendProfileMessage(serviceSocket)) {
+                    createLogMessage(STR_LOG_MSG_FUNC9_PROF_DUMP_FAIL, LOG_SVRTY_ERR);
+                    retval = -1;
+                }
+            }
+            else if(0 == strcmp(cmdArgs[0], STR_USR_CMD_TELEMETRY)) {
+
+                /* Print latest telemetry of the drone */
+                printTelemetry(droneID);
+            }
+            else if(0 == strcmp(cmdArgs[0], STR_USR_CMD_SNAPSHOT)) {
+
+                /* Request still snapshot (the stream keeps playing) */
+                printf(">> Ground control requested snapshot <<\n");
+                fflush(stdout);
+                if(sendSnapshotMessage(serviceSocket)) {
+                    createLogMessage(STR_LOG_MSG_FUNC9_SNAPSHOT_FAIL, LOG_SVRTY_ERR);
+                    retval = -1;
+                }
+            }
             else if(0 == strcmp(cmdArgs[0], STR_USR_CMD_DRN_DCON)) {
 
                 /* Disconnect drone */
@@ -677,7 +992,7 @@ static int inputCommandHandler(const int serviceSocket, int *exitCondition, GstE
             else {
 
                 /* Invalid user command */
-                printf("\nInvalid command. Possible commands are:\n\n\tplay - Request video stream\n\tstop - Stop video stream\n\tdconn - Disconnect drone\n\n");
+                printf("\nInvalid command. Possible commands are:\n\n\tplay - Request video stream\n\tstop - Stop video stream\n\tprof - Dump pipeline profiles\n\ttelem - Print drone telemetry\n\tsnap - Take full resolution snapshot\n\tdconn - Disconnect drone\n\n");
                 fflush(stdout);
                 retval = -1;
             }
@@ -714,6 +1029,97 @@ static int sendStopMessage(const int serviceSocket) {
     return retval;
 }
 
+static int sendProfileMessage(const int serviceSocket) {
+
+    int retval = 0;
+    int length;
+    MessageHeaderField_T messageHeader[NUM_MSG_HEADER_SIZE] = {0};
+
+    if (0 > serviceSocket) {
+
+        createLogMessage(STR_LOG_MSG_FUNC28_ARG_INVAL, LOG_SVRTY_ERR);
+        retval = -1;
+    }
+    else {
+
+        messageHeader[IDX_MSG_HEADER_MODULE] = MOD_NAME_STREAM;
+        messageHeader[IDX_MSG_HEADER_CODE] = MOD_MSG_CODE_PROFILE_DUMP;
+        length = send(serviceSocket, messageHeader, sizeof(messageHeader), MSG_NOSIGNAL);
+        if (0 > length) {
+
+            perror("send");
+            createLogMessage(STR_LOG_MSG_FUNC28_MSG_SEND_FAIL, LOG_SVRTY_ERR);
+            retval = -1;
+        }
+    }
+
+    return retval;
+}
+
+static int sendSnapshotMessage(const int serviceSocket) {
+
+    int retval = 0;
+    int length;
+    MessageHeaderField_T messageHeader[NUM_MSG_HEADER_SIZE] = {0};
+
+    if (0 > serviceSocket) {
+
+        createLogMessage(STR_LOG_MSG_FUNC42_ARG_INVAL, LOG_SVRTY_ERR);
+        retval = -1;
+    }
+    else {
+
+        messageHeader[IDX_MSG_HEADER_MODULE] = MOD_NAME_STREAM;
+        messageHeader[IDX_MSG_HEADER_CODE] = MOD_MSG_CODE_SNAPSHOT_REQ;
+        length = send(serviceSocket, messageHeader, sizeof(messageHeader), MSG_NOSIGNAL);
+        if (0 > length) {
+
+            perror("send");
+            createLogMessage(STR_LOG_MSG_FUNC42_MSG_SEND_FAIL, LOG_SVRTY_ERR);
+            retval = -1;
+        }
+    }
+
+    return retval;
+}
+
+static int sendClockResponse(const int serviceSocket, const uint64_t originNs, const uint64_t receiveNs) {
+
+    int retval = 0;
+    int length;
+    uint64_t transmitNs;
+    uint32_t message[NUM_MSG_HEADER_SIZE + NUM_CLOCK_RESP_MSG_FIELDS] = {0};
+    uint32_t *clockData = &message[NUM_MSG_HEADER_SIZE];
+
+    if (0 > serviceSocket) {
+
+        createLogMessage(STR_LOG_MSG_FUNC43_ARG_INVAL, LOG_SVRTY_ERR);
+        retval = -1;
+    }
+    else {
+
+        /* Header and data in one send: the transmit time is stamped right before it */
+        message[IDX_MSG_HEADER_MODULE] = MOD_NAME_NETWORK;
+        message[IDX_MSG_HEADER_CODE] = MOD_MSG_CODE_CLOCK_RESP;
+        clockData[IDX_CLOCK_MSG_ORIGIN] = (uint32_t)(originNs >> 32);
+        clockData[IDX_CLOCK_MSG_ORIGIN + 1U] = (uint32_t)(originNs);
+        clockData[IDX_CLOCK_MSG_RECEIVE] = (uint32_t)(receiveNs >> 32);
+        clockData[IDX_CLOCK_MSG_RECEIVE + 1U] = (uint32_t)(receiveNs);
+        transmitNs = getGroundTimeNs();
+        clockData[IDX_CLOCK_MSG_TRANSMIT] = (uint32_t)(transmitNs >> 32);
+        clockData[IDX_CLOCK_MSG_TRANSMIT + 1U] = (uint32_t)(transmitNs);
+        length = send(serviceSocket, message, sizeof(message), MSG_NOSIGNAL);
+        if (0 > length) {
+
+            perror("send");
+            createLogMessage(STR_LOG_MSG_FUNC43_MSG_SEND_FAIL, LOG_SVRTY_ERR);
+            retval = -1;
+        }
+    }
+
+    return retval;
+}
+
 static void cleanupInputMessages(const int sockFd) {
 
     char data[256];
@@ -722,3 +1128,21 @@ static void cleanupInputMessages(const int sockFd) {
         // NOP
     }
 }
+
+static int requestHeadlessStream(const int serviceSocket, GstElement* *pipeline) {
+
+    int retval = -1;
+    unsigned int attempt;
+
+    for (attempt = 0; (attempt < NUM_HEADLESS_REQ_ATTEMPTS) && (0 != retval); ++attempt) {
+
+        retval = requestStream(serviceSocket, pipeline);
+        if (0 != retval) {
+
+            createLogMessage(STR_LOG_MSG_FUNC23_REQ_STRM_RETRY, LOG_SVRTY_WRN);
+            cleanupInputMessages(serviceSocket);
+        }
+    }
+
+    return retval;
+}
@@ -8,8 +8,10 @@
  */
 
 
+#include <stdio.h>
 #include <stdlib.h>
 #include <syslog.h>
+#include <unistd.h>
 
 #include "com_utils.h"
 #include "log_utils.h"
@@ -19,11 +21,46 @@
 /*
  * Compile like this:
  * 
- * gcc -DGC_DEBUG_MODE -O0 -ggdb -Wall stream_utils.c log_utils.c com_utils.c main.c -pthread -I/<path_to_repo>/GroundControl/CLIGroundControl/includes -o controlapp `pkg-config --cflags --libs gstreamer-1.0`
+ * gcc -DGC_DEBUG_MODE -O0 -ggdb -Wall plugin_utils.c profiler_utils.c qos_utils.c watchdog_utils.c clock_utils.c stream_utils.c snapshot_utils.c telemetry_utils.c log_utils.c com_utils.c main.c -pthread -I/<path_to_repo>/GroundControl/CLIGroundControl/includes -o controlapp `pkg-config --cflags --libs gstreamer-1.0 gio-2.0`
  * 
  * Launch like this:
  * 
  * ./controlapp
+ * ./controlapp [-H] [-L] [-p <STREAM_PORT>] [-d <DUMP_FILE>] [-P <PROFILE_DIR>] [-R <PLUGIN_DIR>] [-S <STALL_MS>] [-m] [-M <REORDER_MS>]
+ *
+ * -H runs headless: no video window and no user commands, the stream is
+ * requested as soon as the drone connects and the received frames are
+ * counted on the standard output (used by CompanionComputer/bench/loopback_bench.py).
+ * -L runs headless and reports the latency of every frame stamped by the drone's
+ * test source (CC_LATENCY_STAMP=1, used by CompanionComputer/bench/latency_bench.py).
+ * -p sets the port the drone is asked to stream to (e.g. 5000 on a LAN or loopback).
+ * -d writes every received RTP packet with its arrival time to the dump file
+ * (analyze it with CompanionComputer/tools/rtp_analyzer.c).
+ * -P profiles the display pipeline: the 'prof' command (or SIGUSR2) writes
+ * its graph annotated with per-element rates, processing times and queue
+ * levels into the directory and asks the drone to do the same (the drone
+ * profiles with CC_PROFILE_DIR set, see its profiler_utils.h).
+ * -R loads only the pinned plugins of the directory from its registry without
+ * a scan (see CompanionComputer/tools/pin_gst_plugins.py). Add -DGC_GST_STATIC
+ * and link against gstreamer-full-1.0 instead to link the plugins in.
+ * -S sets how long the playing display may pass no packets at the network source or
+ * no frames at the decoder output before it counts as stalled (default 3000, 0 disables
+ * the watchdog): a stalled decoder is restarted, a stalled network is reported.
+ * -m receives a drone streaming over several paths (CC_MULTIPATH_PATHS of the drone): the
+ * control server accepts Multipath TCP connections, so the control link survives a path loss,
+ * and headless mode reports the count of the duplicate RTP packets (always dropped).
+ * -M implies -m and reorders the packets of the paths within REORDER_MS (e.g. 50, about the
+ * delay difference of the paths), needed when the drone splits the packets between the paths
+ * (CC_MULTIPATH_MODE=bonding of the drone). Redundant paths need no reordering.
+ *
+ * The 'telem' command prints the latest telemetry of the drone (headless mode
+ * reports every received sample as a "[telemetry] ..." line instead).
+ * The 'snap' command asks the drone for a full resolution still of the running stream
+ * (RAW and JPEG cameras), saved as snapshot_<DRONE>_<ID>.jpg in the working directory.
+ *
+ * The drones synchronize to the clock of the ground control (CLOCK_REALTIME, the common
+ * timebase of every drone) and map the RTP timestamps of their stream to it: headless
+ * mode reports the capture to arrival latency of the frames with the clock uncertainty.
  */
 
 /*
@@ -57,23 +94,76 @@
  */
 int main(int argc, char* argv[]) {
     
+    int option;
+    StreamInitContext_T streamCtx = {.stallMs = NUM_STREAM_STALL_TIMEOUT_MS};
+
     /* Open connection to the system logger */
     openlog(STR_SYSLOG_PROG_NAME, LOG_PID | LOG_NDELAY, LOG_USER);
 
+    /* Parse command line options */
+    while(-1 != (option = getopt(argc, argv, "HLp:d:P:R:S:mM:"))) {
+
+        switch(option) {
+
+            case 'H':
+                streamCtx.headless = 1;
+                break;
+
+            case 'L':
+                streamCtx.headless = 1;
+                streamCtx.latency = 1;
+                break;
+
+            case 'p':
+                streamCtx.streamPort = (VideoStreamPort_T)strtoul(optarg, NULL, 10);
+                break;
+
+            case 'd':
+                streamCtx.dumpPath = optarg;
+                break;
+
+            case 'P':
+                streamCtx.profileDir = optarg;
+                break;
+
+            case 'R':
+                streamCtx.pluginDir = optarg;
+                break;
+
+            case 'S':
+                streamCtx.stallMs = (unsigned int)strtoul(optarg, NULL, 10);
+                break;
+
+            case 'm':
+                streamCtx.multipath = 1;
+                break;
+
+            case 'M':
+                streamCtx.multipath = 1;
+                streamCtx.reorderMs = (unsigned int)strtoul(optarg, NULL, 10);
+                break;
+
+            default:
+                fprintf(stderr, "Usage: %s [-H] [-L] [-p <STREAM_PORT>] [-d <DUMP_FILE>] [-P <PROFILE_DIR>] [-R <PLUGIN_DIR>] [-S <STALL_MS>] [-m] [-M <REORDER_MS>]\n", argv[0]);
+                createLogMessage(STR_LOG_MSG_MAIN_ARG_INVAL, LOG_SVRTY_ERR);
+                return EXIT_FAILURE;
+        }
+    }
+
     /* Log program startup */
     createLogMessage(STR_LOG_MSG_MAIN_PROG_STARTUP, LOG_SVRTY_INF);
 
-    /* Initialize and start ground control services */
-    if(initGroundControlServices()) {
+    /* Initialize streaming services (before drones may connect) */
+    if(initStreamServices(&streamCtx)) {
 
-        createLogMessage(STR_LOG_MSG_MAIN_SERVER_INIT_FAIL, LOG_SVRTY_ERR);
+        createLogMessage(STR_LOG_MSG_MAIN_STREAM_INIT_FAIL, LOG_SVRTY_ERR);
         return EXIT_FAILURE;
     }
 
-    /* Initialize streaming services */
-    if(initStreamServices()) {
+    /* Initialize and start ground control services */
+    if(initGroundControlServices()) {
 
-        createLogMessage(STR_LOG_MSG_MAIN_STREAM_INIT_FAIL, LOG_SVRTY_ERR);
+        createLogMessage(STR_LOG_MSG_MAIN_SERVER_INIT_FAIL, LOG_SVRTY_ERR);
         return EXIT_FAILURE;
     }
 
@@ -0,0 +1,124 @@
+/**
+ * @file        plugin_utils.c
+ * @author      Adam Csizy
+ * @date        2021-05-21
+ * @version     v1.1.0
+ *
+ * @brief       GStreamer plugin loading utilities
+ */
+
+
+#include <gst/gst.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <syslog.h>
+#include <unistd.h>
+
+#include "log_utils.h"
+#include "plugin_utils.h"
+
+
+/* Plugin related macro definitions */
+
+#define NUM_PLUGIN_ELEMENT_NUM      18U     /**< Number of elements the display pipelines may use */
+
+
+/* Plugin related static variable declarations */
+
+/**
+ * Elements of pipeBuilder().
+ * Keep in sync with the ground control list of CompanionComputer/tools/pin_gst_plugins.py.
+ */
+static const char *const pluginElements[NUM_PLUGIN_ELEMENT_NUM] = {
+
+    "udpsrc", "capsfilter",
+    "rtph265depay", "rtph264depay", "rtpvp8depay", "rtpvp9depay", "rtpjpegdepay", "rtph263depay",
+    "avdec_h265", "avdec_h264", "vp8dec", "vp9dec", "jpegdec", "avdec_h263",
+    "videoconvert", "videoscale", "appsink", "fakesink"
+};
+
+
+/* Plugin related function definitions */
+
+int initPluginRegistry(const char *directory) {
+
+    int retval = 0;
+    gchar *registry = NULL;
+    struct stat status;
+
+    #ifdef GC_GST_STATIC
+    /* gstreamer-full registers the linked plugins in 'gst_init()', there is nothing to scan */
+    g_setenv("GST_REGISTRY_DISABLE", "yes", TRUE);
+    fprintf(stdout, STR_LOG_MSG_FUNC29_STATIC);
+    fflush(stdout);
+    syslog(LOG_USER | LOG_INFO, STR_LOG_MSG_FUNC29_STATIC);
+    return retval;
+    #endif
+
+    if((NULL == directory) || ('\0' == directory[0])) {
+
+        return retval;
+    }
+
+    if((0 != stat(directory, &status)) || !S_ISDIR(status.st_mode)) {
+
+        fprintf(stdout, STR_LOG_MSG_FUNC29_DIR_INVAL, directory);
+        fflush(stdout);
+        syslog(LOG_USER | LOG_WARNING, STR_LOG_MSG_FUNC29_DIR_INVAL, directory);
+        retval = -1;
+        return retval;
+    }
+
+    registry = g_build_filename(directory, STR_PLUGIN_REGISTRY_FILE, NULL);
+
+    /* Only the pinned plugins, no helper process scanning them */
+    g_setenv("GST_PLUGIN_SYSTEM_PATH_1_0", directory, TRUE);
+    g_setenv("GST_PLUGIN_PATH_1_0", "", TRUE);
+    g_setenv("GST_REGISTRY_1_0", registry, TRUE);
+    g_setenv("GST_REGISTRY_FORK", "no", TRUE);
+
+    /* Trust the pinned registry: no stat() of every plugin on startup */
+    if(0 == access(registry, R_OK)) {
+
+        g_setenv("GST_REGISTRY_UPDATE", "no", TRUE);
+        fprintf(stdout, STR_LOG_MSG_FUNC29_PINNED, registry);
+        fflush(stdout);
+        syslog(LOG_USER | LOG_INFO, STR_LOG_MSG_FUNC29_PINNED, registry);
+    }
+    else {
+
+        fprintf(stdout, STR_LOG_MSG_FUNC29_REGISTRY_MISSING, registry);
+        fflush(stdout);
+        syslog(LOG_USER | LOG_WARNING, STR_LOG_MSG_FUNC29_REGISTRY_MISSING, registry);
+    }
+
+    g_free(registry);
+
+    return retval;
+}
+
+int checkRequiredPlugins(void) {
+
+    int missing = 0;
+    unsigned int i;
+    GstElementFactory *factory = NULL;
+
+    for(i = 0;i < NUM_PLUGIN_ELEMENT_NUM;++i) {
+
+        factory = gst_element_factory_find(pluginElements[i]);
+        if(NULL != factory) {
+
+            gst_object_unref(factory);
+        }
+        else {
+
+            fprintf(stdout, STR_LOG_MSG_FUNC30_ELEM_MISSING, pluginElements[i]);
+            fflush(stdout);
+            syslog(LOG_USER | LOG_WARNING, STR_LOG_MSG_FUNC30_ELEM_MISSING, pluginElements[i]);
+            ++missing;
+        }
+    }
+
+    return missing;
+}
@@ -0,0 +1,305 @@
+/**
+ * @file        qos_utils.c
+ * @author      Adam Csizy
+ * @date        2021-05-04
+ * @version     v1.1.0
+ *
+ * @brief       Network quality of service utilities
+ */
+
+
+#include <gst/gst.h>
+
+#include <netinet/in.h>
+#include <netinet/ip.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <syslog.h>
+
+#include "log_utils.h"
+#include "qos_utils.h"
+
+
+/* QoS related macro definitions */
+
+#define NUM_QOS_DSCP_SHIFT      2U  /**< DSCP position in the TOS/traffic class byte (ECN bits below) */
+
+#ifndef SO_MEMINFO
+#define SO_MEMINFO              55  /**< Socket memory information option (Linux 4.6+) */
+#endif
+
+#define IDX_SK_MEMINFO_DROPS    8U  /**< Index of the drop counter in the SO_MEMINFO array (SK_MEMINFO_DROPS) */
+#define NUM_SK_MEMINFO_VARS     9U  /**< Number of SO_MEMINFO array elements (SK_MEMINFO_VARS) */
+
+
+/* QoS related static type declarations */
+
+/**
+ * @brief   Receive buffer autotuning context.
+ */
+typedef struct AutotuneContext {
+
+    int sockFd;             /**< Media socket */
+    int bufferSize;         /**< Current receive buffer size in bytes */
+    uint32_t lastDrops;     /**< Kernel drop counter at the previous check */
+
+} AutotuneContext_T;
+
+
+/* QoS related static variable declarations */
+
+static AutotuneContext_T autotuneContext = {.sockFd = -1};  /**< Receive buffer autotuning context (single media socket) */
+
+
+/* QoS related static function declarations */
+
+/**
+ * @brief       Receive buffer autotuning timeout callback.
+ *
+ * @details     Compares the socket's kernel drop counter with the
+ *              previous value. On new drops the event is logged and
+ *              the receive buffer is doubled up to NUM_QOS_SOCK_BUF_MAX.
+ *
+ * @param[in,out]   data Autotuning context.
+ *
+ * @return      G_SOURCE_CONTINUE to keep the timeout source alive.
+ */
+static gboolean receiveBufferAutotuneCallback(gpointer data);
+
+
+/* QoS related function definitions */
+
+int getTrafficClassDscp(const TrafficClass_T trafficClass) {
+
+    return (QOS_CLASS_CONTROL == trafficClass) ? NUM_QOS_DSCP_CONTROL : NUM_QOS_DSCP_VIDEO;
+}
+
+int getTrafficClassPriority(const TrafficClass_T trafficClass) {
+
+    return (QOS_CLASS_CONTROL == trafficClass) ? NUM_QOS_PRIO_CONTROL : NUM_QOS_PRIO_VIDEO;
+}
+
+int setSocketDscp(const int sockFd, const int dscp) {
+
+    int retval = 0;
+    int tos = dscp << NUM_QOS_DSCP_SHIFT;
+    struct sockaddr_storage address = {0};
+    socklen_t addressLength = sizeof(address);
+
+    if((0 > sockFd) || (0 > dscp) || (63 < dscp)) {
+
+        createLogMessage(STR_LOG_MSG_FUNC16_ARG_INVAL, LOG_SVRTY_ERR);
+        retval = -1;
+        return retval;
+    }
+
+    if(0 > getsockname(sockFd, (struct sockaddr*)(&address), &addressLength)) {
+
+        createLogMessage(STR_LOG_MSG_FUNC16_SOCK_NAME_FAIL, LOG_SVRTY_ERR);
+        retval = -1;
+        return retval;
+    }
+
+    if(AF_INET6 == address.ss_family) {
+
+        if(0 > setsockopt(sockFd, IPPROTO_IPV6, IPV6_TCLASS, &tos, sizeof(tos))) {
+
+            createLogMessage(STR_LOG_MSG_FUNC16_TCLASS_SET_FAIL, LOG_SVRTY_WRN);
+            retval = -1;
+        }
+
+        /* IPv4-mapped destinations use the IPv4 TOS (fails harmlessly on IPv6-only sockets) */
+        setsockopt(sockFd, IPPROTO_IP, IP_TOS, &tos, sizeof(tos));
+    }
+    else {
+
+        if(0 > setsockopt(sockFd, IPPROTO_IP, IP_TOS, &tos, sizeof(tos))) {
+
+            createLogMessage(STR_LOG_MSG_FUNC16_TOS_SET_FAIL, LOG_SVRTY_WRN);
+            retval = -1;
+        }
+    }
+
+    return retval;
+}
+
+int setSocketPriority(const int sockFd, const int priority) {
+
+    int retval = 0;
+
+    if(0 > setsockopt(sockFd, SOL_SOCKET, SO_PRIORITY, &priority, sizeof(priority))) {
+
+        createLogMessage(STR_LOG_MSG_FUNC17_PRIO_SET_FAIL, LOG_SVRTY_WRN);
+        retval = -1;
+    }
+
+    return retval;
+}
+
+int setSocketTrafficClass(const int sockFd, const TrafficClass_T trafficClass) {
+
+    int retval = 0;
+
+    /* Priority is set last: setting IP_TOS also resets the socket priority on Linux */
+    if(setSocketDscp(sockFd, getTrafficClassDscp(trafficClass))) {
+
+        retval = -1;
+    }
+
+    if(setSocketPriority(sockFd, getTrafficClassPriority(trafficClass))) {
+
+        retval = -1;
+    }
+
+    return retval;
+}
+
+int computeSocketBufferSize(const int bitrateKbps, const int latencyMs) {
+
+    int64_t size;
+
+    /* kbit/s * ms = bit; divide by 8 for bytes */
+    size = ((int64_t)(bitrateKbps) * (int64_t)(latencyMs)) / 8;
+
+    if(NUM_QOS_SOCK_BUF_MIN > size) {
+
+        size = NUM_QOS_SOCK_BUF_MIN;
+    }
+    else if(NUM_QOS_SOCK_BUF_MAX < size) {
+
+        size = NUM_QOS_SOCK_BUF_MAX;
+    }
+
+    return (int)(size);
+}
+
+int setSocketBufferSize(const int sockFd, const int option, const int size) {
+
+    int effectiveSize = 0;
+    int forceOption = (SO_RCVBUF == option) ? SO_RCVBUFFORCE : SO_SNDBUFFORCE;
+    socklen_t optionLength = sizeof(effectiveSize);
+
+    if((0 > sockFd) || (0 >= size) || ((SO_RCVBUF != option) && (SO_SNDBUF != option))) {
+
+        createLogMessage(STR_LOG_MSG_FUNC18_ARG_INVAL, LOG_SVRTY_ERR);
+        return -1;
+    }
+
+    /* Unprivileged fallback is capped by net.core.rmem_max/wmem_max */
+    if(0 > setsockopt(sockFd, SOL_SOCKET, forceOption, &size, sizeof(size))) {
+
+        if(0 > setsockopt(sockFd, SOL_SOCKET, option, &size, sizeof(size))) {
+
+            createLogMessage(STR_LOG_MSG_FUNC18_BUF_SET_FAIL, LOG_SVRTY_WRN);
+            return -1;
+        }
+    }
+
+    if(0 > getsockopt(sockFd, SOL_SOCKET, option, &effectiveSize, &optionLength)) {
+
+        createLogMessage(STR_LOG_MSG_FUNC18_BUF_GET_FAIL, LOG_SVRTY_WRN);
+        return -1;
+    }
+
+    /* The kernel doubles the value for bookkeeping overhead */
+    effectiveSize /= 2;
+    if(effectiveSize < size) {
+
+        createLogMessage(STR_LOG_MSG_FUNC18_BUF_CAPPED, LOG_SVRTY_WRN);
+    }
+
+    return effectiveSize;
+}
+
+int getSocketDropCount(const int sockFd, uint32_t *drops) {
+
+    int retval = 0;
+    uint32_t memInfo[NUM_SK_MEMINFO_VARS] = {0};
+    socklen_t memInfoLength = sizeof(memInfo);
+
+    if((0 > sockFd) || (NULL == drops)) {
+
+        createLogMessage(STR_LOG_MSG_FUNC19_ARG_INVAL, LOG_SVRTY_ERR);
+        retval = -1;
+        return retval;
+    }
+
+    if((0 > getsockopt(sockFd, SOL_SOCKET, SO_MEMINFO, memInfo, &memInfoLength)) ||
+       (memInfoLength <= (IDX_SK_MEMINFO_DROPS * sizeof(uint32_t)))) {
+
+        retval = -1;
+        return retval;
+    }
+
+    *drops = memInfo[IDX_SK_MEMINFO_DROPS];
+
+    return retval;
+}
+
+int startReceiveBufferAutotune(const int sockFd, const int initialSize) {
+
+    int retval = 0;
+    uint32_t drops = 0;
+
+    if((0 > sockFd) || (0 >= initialSize)) {
+
+        createLogMessage(STR_LOG_MSG_FUNC20_ARG_INVAL, LOG_SVRTY_ERR);
+        retval = -1;
+        return retval;
+    }
+
+    /* Drop counter must be readable, otherwise autotuning would be blind */
+    if(getSocketDropCount(sockFd, &drops)) {
+
+        createLogMessage(STR_LOG_MSG_FUNC20_DROPS_UNSUPPORTED, LOG_SVRTY_WRN);
+        retval = -1;
+        return retval;
+    }
+
+    autotuneContext.sockFd = sockFd;
+    autotuneContext.bufferSize = initialSize;
+    autotuneContext.lastDrops = drops;
+
+    g_timeout_add_seconds(NUM_QOS_AUTOTUNE_PERIOD_SEC, receiveBufferAutotuneCallback, &autotuneContext);
+
+    return retval;
+}
+
+static gboolean receiveBufferAutotuneCallback(gpointer data) {
+
+    int newSize;
+    uint32_t drops = 0, newDrops;
+    AutotuneContext_T *context = (AutotuneContext_T*)data;
+
+    if(getSocketDropCount(context->sockFd, &drops)) {
+
+        return G_SOURCE_CONTINUE;
+    }
+
+    newDrops = drops - context->lastDrops;
+    context->lastDrops = drops;
+
+    if(0 < newDrops) {
+
+        /* Keyframe bursts overflowed the buffer: grow it geometrically */
+        newSize = context->bufferSize;
+        if((NUM_QOS_SOCK_BUF_MAX / 2) >= context->bufferSize) {
+
+            newSize = setSocketBufferSize(context->sockFd, SO_RCVBUF, context->bufferSize * 2);
+            if(0 < newSize) {
+
+                context->bufferSize = newSize;
+            }
+        }
+
+        #ifdef GC_DEBUG_MODE
+        fprintf(stdout, STR_LOG_MSG_FUNC21_DROPS_DETECTED, newDrops, drops, context->bufferSize);
+        fflush(stdout);
+        #endif
+        syslog(LOG_USER | LOG_WARNING, STR_LOG_MSG_FUNC21_DROPS_DETECTED, newDrops, drops, context->bufferSize);
+    }
+
+    return G_SOURCE_CONTINUE;
+}
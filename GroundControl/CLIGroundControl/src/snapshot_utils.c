@@ -0,0 +1,252 @@
+/**
+ * @file        snapshot_utils.c
+ * @author      Adam Csizy
+ * @date        2021-05-27
+ * @version     v1.1.0
+ *
+ * @brief       Drone snapshot receiver
+ */
+
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <syslog.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "log_utils.h"
+#include "snapshot_utils.h"
+#include "stream_utils.h"
+
+
+/* Snapshot related macro definitions */
+
+#define STR_HEADLESS_SNAPSHOT       "[snapshot] drone=%u id=%u bytes=%u ms=%u path=%s\n" /**< Headless report of a received snapshot */
+#define NUM_SNAPSHOT_PATH_SIZE      64U     /**< Size of a snapshot file path */
+#define NUM_NSEC_PER_MSEC           1000000ULL /**< Nanoseconds in a millisecond */
+
+
+/* Snapshot related static type declarations */
+
+/**
+ * @brief   Struct of a snapshot being received.
+ */
+typedef struct SnapshotReceive {
+
+    FILE *file;                             /**< Snapshot file (NULL if the slot is free) */
+    uint32_t droneID;                       /**< Drone ID */
+    uint32_t id;                            /**< Snapshot ID */
+    uint32_t size;                          /**< Size of the JPEG image */
+    uint32_t received;                      /**< Bytes received so far */
+    uint64_t beginNs;                       /**< Monotonic time of the announcement */
+    char path[NUM_SNAPSHOT_PATH_SIZE];      /**< Path of the snapshot file */
+
+} SnapshotReceive_T;
+
+
+/* Snapshot related static variable declarations */
+
+static SnapshotReceive_T receives[NUM_SNAPSHOT_RECV_MAX];          /**< Snapshots being received */
+static pthread_mutex_t receiveLock = PTHREAD_MUTEX_INITIALIZER;     /**< Lock of the snapshots being received */
+
+
+/* Snapshot related static function declarations */
+
+/**
+ * @brief       Get monotonic time.
+ *
+ * @return      CLOCK_MONOTONIC time in nanoseconds.
+ */
+static uint64_t getMonotonicNs(void);
+
+/**
+ * @brief       Find snapshot being received from a drone.
+ *
+ * @note        The receive lock must be held.
+ *
+ * @param[in]   droneID Drone ID.
+ *
+ * @return      Snapshot of the drone or NULL.
+ */
+static SnapshotReceive_T *findReceive(const uint32_t droneID);
+
+/**
+ * @brief       Drop snapshot being received.
+ *
+ * @details     Closes and removes the unfinished file.
+ *
+ * @note        The receive lock must be held.
+ *
+ * @param[in,out]   receive Snapshot being received.
+ */
+static void dropReceive(SnapshotReceive_T *receive);
+
+
+/* Snapshot related function definitions */
+
+int beginSnapshot(const uint32_t droneID, const uint32_t id, const uint32_t size) {
+
+    int retval = 0;
+    unsigned int i;
+    SnapshotReceive_T *receive = NULL;
+
+    pthread_mutex_lock(&receiveLock);
+
+    receive = findReceive(droneID);
+    if(NULL != receive) {
+
+        dropReceive(receive);
+    }
+    for(i = 0;(i < NUM_SNAPSHOT_RECV_MAX) && (NULL == receive);++i) {
+
+        if(NULL == receives[i].file) {
+
+            receive = &receives[i];
+        }
+    }
+
+    if(NULL == receive) {
+
+        pthread_mutex_unlock(&receiveLock);
+        createLogMessage(STR_LOG_MSG_FUNC40_RECV_FULL, LOG_SVRTY_WRN);
+        retval = -1;
+        return retval;
+    }
+
+    snprintf(receive->path, sizeof(receive->path), STR_SNAPSHOT_FILE_FORMAT, droneID, id);
+    receive->file = fopen(receive->path, "wb");
+    if(NULL == receive->file) {
+
+        fprintf(stdout, STR_LOG_MSG_FUNC40_FILE_OPEN_FAIL, receive->path, strerror(errno));
+        fflush(stdout);
+        syslog(LOG_USER | LOG_ERR, STR_LOG_MSG_FUNC40_FILE_OPEN_FAIL, receive->path, strerror(errno));
+        pthread_mutex_unlock(&receiveLock);
+        retval = -1;
+        return retval;
+    }
+
+    receive->droneID = droneID;
+    receive->id = id;
+    receive->size = size;
+    receive->received = 0U;
+    receive->beginNs = getMonotonicNs();
+    pthread_mutex_unlock(&receiveLock);
+
+    return retval;
+}
+
+int receiveSnapshotData(const uint32_t droneID, const uint32_t id, const uint32_t offset, const uint8_t *data, const uint32_t length) {
+
+    int retval = 0;
+    unsigned int elapsedMs;
+    SnapshotReceive_T *receive = NULL;
+
+    if((NULL == data) && (0U < length)) {
+
+        createLogMessage(STR_LOG_MSG_FUNC41_ARG_INVAL, LOG_SVRTY_ERR);
+        retval = -1;
+        return retval;
+    }
+
+    pthread_mutex_lock(&receiveLock);
+
+    receive = findReceive(droneID);
+    if((NULL == receive) || (id != receive->id)) {
+
+        /* Announcement failed or sent to a previous connection */
+        pthread_mutex_unlock(&receiveLock);
+        return retval;
+    }
+
+    if((offset != receive->received) || (length > (receive->size - receive->received)) ||
+       (length != fwrite(data, 1, length, receive->file))) {
+
+        fprintf(stdout, STR_LOG_MSG_FUNC41_DROPPED, id, droneID, receive->received, offset);
+        fflush(stdout);
+        syslog(LOG_USER | LOG_WARNING, STR_LOG_MSG_FUNC41_DROPPED, id, droneID, receive->received, offset);
+        dropReceive(receive);
+        pthread_mutex_unlock(&receiveLock);
+        retval = -1;
+        return retval;
+    }
+
+    receive->received += length;
+    if(receive->received < receive->size) {
+
+        pthread_mutex_unlock(&receiveLock);
+        return retval;
+    }
+
+    /* Last chunk */
+    elapsedMs = (unsigned int)((getMonotonicNs() - receive->beginNs) / NUM_NSEC_PER_MSEC);
+    if(fclose(receive->file)) {
+
+        receive->file = NULL;
+        fprintf(stdout, STR_LOG_MSG_FUNC41_DROPPED, id, droneID, receive->received, offset);
+        fflush(stdout);
+        syslog(LOG_USER | LOG_WARNING, STR_LOG_MSG_FUNC41_DROPPED, id, droneID, receive->received, offset);
+        unlink(receive->path);
+        pthread_mutex_unlock(&receiveLock);
+        retval = -1;
+        return retval;
+    }
+    receive->file = NULL;
+
+    fprintf(stdout, STR_LOG_MSG_FUNC41_SAVED, id, droneID, receive->path, receive->size, elapsedMs);
+    fflush(stdout);
+    syslog(LOG_USER | LOG_INFO, STR_LOG_MSG_FUNC41_SAVED, id, droneID, receive->path, receive->size, elapsedMs);
+    if(isStreamHeadless()) {
+
+        fprintf(stdout, STR_HEADLESS_SNAPSHOT, droneID, id, receive->size, elapsedMs, receive->path);
+        fflush(stdout);
+    }
+    pthread_mutex_unlock(&receiveLock);
+
+    return retval;
+}
+
+void dropSnapshots(const uint32_t droneID) {
+
+    SnapshotReceive_T *receive = NULL;
+
+    pthread_mutex_lock(&receiveLock);
+    receive = findReceive(droneID);
+    if(NULL != receive) {
+
+        dropReceive(receive);
+    }
+    pthread_mutex_unlock(&receiveLock);
+}
+
+static uint64_t getMonotonicNs(void) {
+
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return ((uint64_t)(now.tv_sec) * 1000ULL * NUM_NSEC_PER_MSEC) + (uint64_t)(now.tv_nsec);
+}
+
+static SnapshotReceive_T *findReceive(const uint32_t droneID) {
+
+    unsigned int i;
+
+    for(i = 0;i < NUM_SNAPSHOT_RECV_MAX;++i) {
+
+        if((NULL != receives[i].file) && (droneID == receives[i].droneID)) {
+
+            return &receives[i];
+        }
+    }
+
+    return NULL;
+}
+
+static void dropReceive(SnapshotReceive_T *receive) {
+
+    fclose(receive->file);
+    receive->file = NULL;
+    unlink(receive->path);
+}
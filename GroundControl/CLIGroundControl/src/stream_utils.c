@@ -8,17 +8,34 @@
  */
 
 
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE     /**< pipe2() */
+#endif
+
+#include <gio/gio.h>
 #include <gst/gst.h>
 
 #include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
 #include <pthread.h>
+#include <stdatomic.h>
 #include <stdio.h>
+#include <string.h>
+#include <syslog.h>
+#include <time.h>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <unistd.h>
 
+#include "clock_utils.h"
 #include "com_utils.h"
 #include "log_utils.h"
+#include "plugin_utils.h"
+#include "profiler_utils.h"
+#include "qos_utils.h"
 #include "stream_utils.h"
+#include "watchdog_utils.h"
 
 
 /* Streaming related macro definitions */
@@ -27,18 +44,96 @@
 //#define NUM_STREAM_PORT_DRONE       5000 /**< Port to which the drone streams the RTP video. (LAN) */
 #define NUM_STREAM_PORT_DRONE       17000 /**< Port to which the drone streams the RTP video. (WAN) */
 #define PIPE_INITIAL_STATE          GST_STATE_READY /**< Initial state of the video display pipeline */
+#define STR_PIPE_DATA_CODING_FORMAT "coding-format" /**< Pipeline data key of its video coding format (stored plus one, see playPipeline()) */
+#define NUM_PIPE_STATE_TIMEOUT_NS   5000000000ULL /**< Wait for asynchronous state changes to playing at most this long */
 #define NUM_MSG_HEADER_SIZE         2U          /**< Size of message header array in MessageHeaderField_T */
 #define IDX_MSG_HEADER_MODULE       0U        /**< Index of module name in message header array */
 #define IDX_MSG_HEADER_CODE         1U          /**< Index of module message code in message header array */
 #define NUM_UDP_MTU                 64000 /**< MTU for UDP packets in bytes. Theoretical ceiling is 64kB but GStreamer payloaders might not support such a high value.  */
+#define NUM_HEADLESS_REPORT_PERIOD  1U /**< Period of headless frame reports in seconds */
+#define STR_HEADLESS_FIRST_FRAME    "[headless] first_frame_ns=%llu\n" /**< Headless report of the first frame's CLOCK_REALTIME arrival */
+#define STR_HEADLESS_FRAMES         "[headless] frames=%llu t_ns=%llu\n" /**< Headless report of the received frames until CLOCK_REALTIME t_ns */
+#define STR_LATENCY_SAMPLE          "[latency] frame=%u latency_us=%lld\n" /**< Latency report of a stamped frame */
+#define STR_LATENCY_UNDECODED       "[latency] undecoded=%llu\n" /**< Latency report of the frames without a valid stamp so far */
+#define STR_LATENCY_SINK_FORMAT     "GRAY8"  /**< Raw format of the latency sink (luma plane only) */
+
+/*
+ * RTP dump layout: must match CompanionComputer/tools/rtp_analyzer.c
+ *
+ * header: magic (8 bytes), version (uint32), reserved (uint32)
+ * record: CLOCK_REALTIME arrival in ns (uint64), length (uint32), RTP packet
+ *
+ * Fields are in host byte order.
+ */
+#define STR_RTP_DUMP_MAGIC          "GCRTPDMP" /**< RTP dump file magic (without the terminating null) */
+#define NUM_RTP_DUMP_VERSION        1U      /**< RTP dump file version */
+#define NUM_RTP_DUMP_FLUSH_PERIOD_NS 1000000000ULL /**< RTP dump records are flushed at least this often */
+
+#define NUM_RTP_HEADER_SIZE         12U     /**< Size of the fixed RTP header */
+#define NUM_RTP_VERSION             2U      /**< RTP version (top two bits of the first header byte) */
+#define NUM_RTP_MARKER              0x80U   /**< Marker bit in the second header byte (last packet of a frame) */
+#define NUM_RTP_DEDUP_WINDOW        1024U   /**< Sequence numbers behind the highest one checked for duplicates (multiple of 64) */
+#define STR_HEADLESS_DUPLICATES     "[headless] duplicates=%llu\n" /**< Headless report of the duplicate RTP packets dropped so far */
+#define STR_HEADLESS_ARRIVAL        "[headless] arrival_latency_us=%lld arrival_latency_max_us=%lld clock_uncertainty_us=%u\n" /**< Headless report of the capture to arrival latency since the previous report */
+
+/*
+ * Latency stamp layout: must match CompanionComputer/includes/camera_utils.h
+ */
+#define NUM_LATENCY_STAMP_BLOCK     16      /**< Latency stamp block size in pixels */
+#define NUM_LATENCY_STAMP_COLUMNS   16      /**< Latency stamp bits per row */
+#define NUM_LATENCY_STAMP_ROWS      6       /**< Latency stamp words (4 time, frame counter, check) */
+#define NUM_LATENCY_STAMP_CHECK     0x5A5AU /**< Latency stamp check word seed */
+#define NUM_LATENCY_STAMP_THRESHOLD 128     /**< Average luma above which a block is a 1 bit */
+
+#define SOCK_FD_INVAL               -1 /**< Invalid socket file descriptor */
+
+#define STR_PIPE_ELEM_NAME_NETSRC   "UDP_Network_Source" /**< Name of the network source pipeline element */
+#define STR_PIPE_ELEM_NAME_VIDCONV  "Video_Converter" /**< Name of the video converter pipeline element (fed by the decoder) */
+#define STR_STALL_WATCH_NETWORK     "network" /**< Stall watch of the network source output */
+#define STR_STALL_WATCH_DECODER     "decoder" /**< Stall watch of the decoder output */
+#define IDX_STALL_PIPE_READ         0U  /**< Index of the read end in the stall report pipe */
+#define IDX_STALL_PIPE_WRITE        1U  /**< Index of the write end in the stall report pipe */
+#define NUM_STALL_REPORT_SIZE       2U  /**< Size of stall report array in guint32 */
+#define IDX_STALL_REPORT_DECODER    0U  /**< Index of the decoder stall flag in the stall report array */
+#define IDX_STALL_REPORT_MS         1U  /**< Index of the stalled milliseconds in the stall report array */
 
 #define MessageHeaderField_T uint32_t /**< Type of the fields in the header of network messages */
 
 
+/* Streaming related static type declarations */
+
+/**
+ * @brief   RTP duplicate filter state.
+ *
+ * @details Bit (s % NUM_RTP_DEDUP_WINDOW) of 'seen' is set once
+ *          sequence number s within the window behind 'highest'
+ *          has passed. A new SSRC (e.g. a restarted payloader)
+ *          clears the state.
+ */
+typedef struct RtpDedupState {
+
+    int valid;                                      /**< A packet has passed */
+    guint32 ssrc;                                   /**< SSRC of the stream */
+    guint16 highest;                                /**< Highest sequence number passed */
+    guint64 seen[NUM_RTP_DEDUP_WINDOW / 64U];       /**< Passed sequence numbers of the window */
+
+} RtpDedupState_T;
+
+
 /* Streaming related static global variable declarations */
 
 static pthread_t threadStreamMainLoop; /**< Thread object for handling main loop context of the video stream */
+static atomic_flag mainLoopStarted = ATOMIC_FLAG_INIT; /**< Main loop thread started by the first pipeline build */
 static GMainLoop *loop = NULL;  /* Main loop context */
+static GSocket *networkSourceSocket = NULL; /**< UDP socket of the network source (owned by the application, see createNetworkSourceSocket()) */
+static StreamInitContext_T streamContext = {.headless = FALSE, .latency = FALSE, .streamPort = NUM_STREAM_PORT_DRONE, .stallMs = NUM_STREAM_STALL_TIMEOUT_MS}; /**< Streaming services configuration */
+static atomic_ullong headlessFrames = 0;        /**< Frames received by the headless sink */
+static atomic_ullong headlessFirstFrameNs = 0;  /**< CLOCK_REALTIME of the first frame received by the headless sink */
+static atomic_ullong latencyUndecoded = 0;      /**< Frames reaching the latency sink without a valid latency stamp */
+static FILE *rtpDumpFile = NULL;                /**< RTP dump file (written in the streaming thread only) */
+static unsigned long long rtpDumpFlushNs = 0;   /**< CLOCK_REALTIME of the last RTP dump flush */
+static int stallPipeFds[2] = {SOCK_FD_INVAL, SOCK_FD_INVAL}; /**< Stall report pipe from the main loop to the drone service thread */
+static atomic_ullong rtpDuplicates = 0;         /**< Duplicate RTP packets dropped at the network source */
 
 
 /* Streaming related static function declarations */
@@ -83,6 +178,24 @@ static void* threadFuncStreamMainLoop(void *arg);
  */
 static int pipeBuilder(GstElement* *pipeline, const VideoCodingFormat_T codingFormat);
 
+/**
+ * @brief       Play video display pipeline.
+ *
+ * @details     Builds the pipeline for the given video coding
+ *              format if it does not exist yet or was built for
+ *              another format (the old one is released), then sets
+ *              it to playing state.
+ *
+ * @param[in,out]   pipeline GStreamer video display pipeline.
+ * @param[in]   codingFormat Video coding format of the stream.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+static int playPipeline(GstElement* *pipeline, const VideoCodingFormat_T codingFormat);
+
 /**
  * @brief       Pipeline error signal callback.
  * 
@@ -97,6 +210,128 @@ static int pipeBuilder(GstElement* *pipeline, const VideoCodingFormat_T codingFo
  */
 static void pipelineErrorCallback(GstBus *bus, GstMessage *message, gpointer data);
 
+/**
+ * @brief       Create network source socket.
+ *
+ * @details     Creates and binds the UDP socket of the RTP network
+ *              source with a receive buffer sized from the target
+ *              video bitrate and latency, then starts the receive
+ *              buffer autotuning on it. The socket is handed over to
+ *              'udpsrc' via its 'socket' property so that the kernel
+ *              drop counter of the very socket receiving the video
+ *              can be watched.
+ *
+ * @param[in]   port UDP port of the RTP stream source.
+ * @param[out]  gsocket Created socket.
+ *
+ * @return      Result of execution.
+ *
+ * @retval      0 Success
+ * @retval      -1 Failure
+ */
+static int createNetworkSourceSocket(const int port, GSocket* *gsocket);
+
+/**
+ * @brief       Headless sink handoff callback.
+ *
+ * @details     Counts the decoded frames reaching the headless
+ *              sink and records the arrival of the first one.
+ *              Invoked in the streaming thread.
+ *
+ * @param[in]   sink Headless sink (fakesink).
+ * @param[in]   buffer Decoded frame.
+ * @param[in]   pad Sink pad.
+ * @param[in]   data Custom data (not used).
+ */
+static void headlessHandoffCallback(GstElement *sink, GstBuffer *buffer, GstPad *pad, gpointer data);
+
+/**
+ * @brief       Latency sink new sample callback.
+ *
+ * @details     Counts the decoded frame like the headless sink,
+ *              decodes its latency stamp and reports the frame's
+ *              glass-to-glass latency (CLOCK_REALTIME of now
+ *              minus the capture time in the stamp). Invoked in
+ *              the streaming thread.
+ *
+ * @param[in]   sink Latency sink (appsink, GRAY8).
+ * @param[in]   data Custom data (not used).
+ *
+ * @return      GST_FLOW_OK (keep streaming).
+ */
+static GstFlowReturn latencySampleCallback(GstElement *sink, gpointer data);
+
+/**
+ * @brief       Count a frame reaching the headless sink.
+ *
+ * @details     Records the arrival of the first frame too.
+ */
+static void countHeadlessFrame(void);
+
+/**
+ * @brief       Headless report timer callback.
+ *
+ * @details     Prints the first frame's arrival once and the
+ *              received frame count every NUM_HEADLESS_REPORT_PERIOD
+ *              seconds on the standard output.
+ *
+ * @param[in]   data Custom data (not used).
+ *
+ * @return      G_SOURCE_CONTINUE (keep the timer).
+ */
+static gboolean headlessReportCallback(gpointer data);
+
+/**
+ * @brief       RTP dump probe.
+ *
+ * @details     Writes every RTP packet leaving the network source
+ *              to the RTP dump file with its arrival time. The
+ *              records are flushed every NUM_RTP_DUMP_FLUSH_PERIOD_NS
+ *              so that a killed ground control leaves a usable dump.
+ *              Invoked in the streaming thread.
+ *
+ * @param[in]   pad Source pad of the network source.
+ * @param[in]   info Probe info holding the RTP packet.
+ * @param[in]   data Custom data (not used).
+ *
+ * @return      GST_PAD_PROBE_OK (pass the packet on).
+ */
+static GstPadProbeReturn rtpDumpProbe(GstPad *pad, GstPadProbeInfo *info, gpointer data);
+
+/**
+ * @brief       RTP duplicate filter pad probe.
+ *
+ * @details     Drops RTP packets whose sequence number has already
+ *              passed within NUM_RTP_DEDUP_WINDOW packets behind the
+ *              highest one, so a drone sending every packet on
+ *              several paths is decoded once. Older packets and
+ *              non-RTP buffers are passed on (the depayloader drops
+ *              them). The arrival of the last packet of each frame
+ *              is recorded for the capture to arrival latency (see
+ *              recordFrameArrival()). Invoked in the streaming thread.
+ *
+ * @param[in]   pad Source pad of the network source.
+ * @param[in]   info Probe info holding the RTP packet.
+ * @param[in,out]   data Duplicate filter state (RtpDedupState_T).
+ *
+ * @return      GST_PAD_PROBE_DROP for a duplicate, GST_PAD_PROBE_OK otherwise.
+ */
+static GstPadProbeReturn rtpDedupProbe(GstPad *pad, GstPadProbeInfo *info, gpointer data);
+
+/**
+ * @brief       Display pipeline stall callback.
+ *
+ * @details     Called on the main loop thread by the stall watchdog.
+ *              Writes a stall report to the stall report pipe: the
+ *              pipeline belongs to the drone service thread (see
+ *              handleStreamStall()).
+ *
+ * @param[in]   watchName Name of the stalled watch.
+ * @param[in]   stalledMs Time since the watch's last buffer in milliseconds.
+ * @param[in]   data Not used.
+ */
+static void displayStallCallback(const char *watchName, const unsigned int stalledMs, void *data);
+
 
 /* Streaming related function definitions */
 
@@ -110,6 +345,7 @@ int stopStream(GstElement* *pipeline){
         if(NULL != *pipeline) {
 
             /* Set pipeline to its initial state */
+            disarmStallWatchdog();
             ret = gst_element_set_state(*pipeline, PIPE_INITIAL_STATE);
             if(GST_STATE_CHANGE_FAILURE == ret) {
 
@@ -134,8 +370,6 @@ int requestStream(const int socketFd, GstElement* *pipeline) {
     uint32_t codingFormat = 0U;
     VideoStreamPort_T streamPort = 0U;
     MessageHeaderField_T messageHeader[NUM_MSG_HEADER_SIZE] = {0};
-    GstStateChangeReturn ret;
-    GstClockTime stateChangeTimeout = 5000000000; // 5 sec in nanosecs
 
     if((0 > socketFd) || (NULL == pipeline)) {
 
@@ -147,7 +381,7 @@ int requestStream(const int socketFd, GstElement* *pipeline) {
         /* Request video stream on specified port */
         messageHeader[IDX_MSG_HEADER_MODULE] = MOD_NAME_STREAM;
         messageHeader[IDX_MSG_HEADER_CODE] = MOD_MSG_CODE_STREAM_REQ;
-        streamPort = NUM_STREAM_PORT_DRONE;
+        streamPort = streamContext.streamPort;
 
         length = send(socketFd, messageHeader, sizeof(messageHeader), MSG_NOSIGNAL);
         if(sizeof(messageHeader) > length) {
@@ -210,30 +444,13 @@ int requestStream(const int socketFd, GstElement* *pipeline) {
             return retval;
         }
 
-        /* Build pipeline if necessary */
-        if(NULL == *pipeline) {
-
-            if(pipeBuilder(pipeline, (VideoCodingFormat_T)(codingFormat))) {
-
-                createLogMessage(STR_LOG_MSG_FUNC12_PIPE_BUILD_FAIL, LOG_SVRTY_ERR);
-                retval = -1;
-                return retval;
-            }
-        }
-
-        /* Set state to playing */
-        ret = gst_element_set_state(*pipeline, GST_STATE_PLAYING);
-        if(GST_STATE_CHANGE_FAILURE == ret) {
+        /* Build pipeline if necessary and set state to playing */
+        if(playPipeline(pipeline, (VideoCodingFormat_T)(codingFormat))) {
 
-            createLogMessage(STR_LOG_MSG_FUNC12_PIPE_SET_PLAY_FAIL, LOG_SVRTY_ERR);
+            createLogMessage(STR_LOG_MSG_FUNC12_PIPE_PLAY_FAIL, LOG_SVRTY_ERR);
             retval = -1;
             return retval;
         }
-        else if(GST_STATE_CHANGE_ASYNC == ret) {
-
-            /* Wait for asynchronous state change completion */
-            gst_element_get_state(*pipeline, NULL, NULL, stateChangeTimeout);
-        }
 
         /* Send play message */
         messageHeader[IDX_MSG_HEADER_MODULE] = MOD_NAME_STREAM;
@@ -255,6 +472,168 @@ int requestStream(const int socketFd, GstElement* *pipeline) {
     return retval;
 }
 
+int resumeStream(GstElement* *pipeline, const VideoCodingFormat_T codingFormat) {
+
+    int retval = 0;
+
+    if(NULL != pipeline) {
+
+        fprintf(stdout, STR_LOG_MSG_FUNC31_RESUMED, (unsigned int)codingFormat);
+        fflush(stdout);
+        syslog(LOG_USER | LOG_INFO, STR_LOG_MSG_FUNC31_RESUMED, (unsigned int)codingFormat);
+
+        if(playPipeline(pipeline, codingFormat)) {
+
+            createLogMessage(STR_LOG_MSG_FUNC31_PIPE_PLAY_FAIL, LOG_SVRTY_ERR);
+            retval = -1;
+        }
+    }
+    else {
+
+        createLogMessage(STR_LOG_MSG_FUNC31_ARG_INVAL, LOG_SVRTY_ERR);
+        retval = -1;
+    }
+
+    return retval;
+}
+
+void releaseStream(GstElement* *pipeline) {
+
+    GstBus *bus = NULL;
+
+    if((NULL != pipeline) && (NULL != *pipeline)) {
+
+        /* The watches hold references to the pipeline's pads */
+        clearStallWatches();
+
+        gst_element_set_state(*pipeline, GST_STATE_NULL);
+        bus = gst_pipeline_get_bus(GST_PIPELINE(*pipeline));
+        gst_bus_remove_signal_watch(bus);
+        gst_object_unref(bus);
+        gst_object_unref(*pipeline);
+        *pipeline = NULL;
+    }
+}
+
+int getStreamStallFd(void) {
+
+    return stallPipeFds[IDX_STALL_PIPE_READ];
+}
+
+int handleStreamStall(GstElement* *pipeline) {
+
+    int retval = 0;
+    guint codingFormat;
+    GstState state = GST_STATE_NULL;
+    guint32 report[NUM_STALL_REPORT_SIZE] = {0};
+
+    if((NULL == pipeline) || (0 > stallPipeFds[IDX_STALL_PIPE_READ])) {
+
+        createLogMessage(STR_LOG_MSG_FUNC36_ARG_INVAL, LOG_SVRTY_ERR);
+        retval = -1;
+        return retval;
+    }
+
+    /* The watchdog disarms after a report, so there is at most one */
+    if(sizeof(report) != read(stallPipeFds[IDX_STALL_PIPE_READ], report, sizeof(report))) {
+
+        createLogMessage(STR_LOG_MSG_FUNC36_REPORT_READ_FAIL, LOG_SVRTY_ERR);
+        retval = -1;
+        return retval;
+    }
+
+    /* Stopped or released since the report */
+    if((NULL == *pipeline) || (GST_STATE_CHANGE_FAILURE == gst_element_get_state(*pipeline, &state, NULL, 0)) || (GST_STATE_PLAYING != state)) {
+
+        return retval;
+    }
+
+    if(report[IDX_STALL_REPORT_DECODER]) {
+
+        fprintf(stdout, STR_LOG_MSG_FUNC36_DECODER_RESTART, (unsigned int)report[IDX_STALL_REPORT_MS]);
+        fflush(stdout);
+        syslog(LOG_USER | LOG_WARNING, STR_LOG_MSG_FUNC36_DECODER_RESTART, (unsigned int)report[IDX_STALL_REPORT_MS]);
+
+        /* A fresh decoder of the same format (the stream keeps arriving meanwhile) */
+        codingFormat = GPOINTER_TO_UINT(g_object_get_data(G_OBJECT(*pipeline), STR_PIPE_DATA_CODING_FORMAT)) - 1U;
+        releaseStream(pipeline);
+        if(playPipeline(pipeline, (VideoCodingFormat_T)(codingFormat))) {
+
+            createLogMessage(STR_LOG_MSG_FUNC36_PIPE_PLAY_FAIL, LOG_SVRTY_ERR);
+            retval = -1;
+        }
+    }
+    else {
+
+        fprintf(stdout, STR_LOG_MSG_FUNC36_NETWORK_STALLED, (unsigned int)report[IDX_STALL_REPORT_MS]);
+        fflush(stdout);
+        syslog(LOG_USER | LOG_WARNING, STR_LOG_MSG_FUNC36_NETWORK_STALLED, (unsigned int)report[IDX_STALL_REPORT_MS]);
+    }
+
+    return retval;
+}
+
+static int playPipeline(GstElement* *pipeline, const VideoCodingFormat_T codingFormat) {
+
+    int retval = 0;
+    GstStateChangeReturn ret;
+
+    /* Release a pipeline of another coding format (e.g. after a drone-side format fallback) */
+    if((NULL != *pipeline) &&
+            (GPOINTER_TO_UINT(g_object_get_data(G_OBJECT(*pipeline), STR_PIPE_DATA_CODING_FORMAT)) != ((guint)codingFormat + 1U))) {
+
+        releaseStream(pipeline);
+    }
+
+    /* Build pipeline if necessary */
+    if(NULL == *pipeline) {
+
+        if(pipeBuilder(pipeline, codingFormat)) {
+
+            createLogMessage(STR_LOG_MSG_FUNC32_PIPE_BUILD_FAIL, LOG_SVRTY_ERR);
+            retval = -1;
+            return retval;
+        }
+        g_object_set_data(G_OBJECT(*pipeline), STR_PIPE_DATA_CODING_FORMAT, GUINT_TO_POINTER((guint)codingFormat + 1U));
+
+        /* Upstream first: a network stall starves the decoder too */
+        if(0 <= stallPipeFds[IDX_STALL_PIPE_READ]) {
+
+            if(addStallWatch(*pipeline, STR_PIPE_ELEM_NAME_NETSRC, "src", STR_STALL_WATCH_NETWORK, streamContext.stallMs)) {
+
+                fprintf(stdout, STR_LOG_MSG_FUNC32_WATCH_FAIL, STR_STALL_WATCH_NETWORK);
+                fflush(stdout);
+                syslog(LOG_USER | LOG_WARNING, STR_LOG_MSG_FUNC32_WATCH_FAIL, STR_STALL_WATCH_NETWORK);
+            }
+            if(addStallWatch(*pipeline, STR_PIPE_ELEM_NAME_VIDCONV, "sink", STR_STALL_WATCH_DECODER, streamContext.stallMs)) {
+
+                fprintf(stdout, STR_LOG_MSG_FUNC32_WATCH_FAIL, STR_STALL_WATCH_DECODER);
+                fflush(stdout);
+                syslog(LOG_USER | LOG_WARNING, STR_LOG_MSG_FUNC32_WATCH_FAIL, STR_STALL_WATCH_DECODER);
+            }
+        }
+    }
+
+    /* Set state to playing */
+    ret = gst_element_set_state(*pipeline, GST_STATE_PLAYING);
+    if(GST_STATE_CHANGE_FAILURE == ret) {
+
+        createLogMessage(STR_LOG_MSG_FUNC32_PIPE_SET_PLAY_FAIL, LOG_SVRTY_ERR);
+        retval = -1;
+    }
+    else {
+
+        if(GST_STATE_CHANGE_ASYNC == ret) {
+
+            /* Wait for asynchronous state change completion */
+            gst_element_get_state(*pipeline, NULL, NULL, NUM_PIPE_STATE_TIMEOUT_NS);
+        }
+        armStallWatchdog();
+    }
+
+    return retval;
+}
+
 static int pipeBuilder(GstElement* *pipeline, const VideoCodingFormat_T codingFormat) {
 
     int retval = 0;
@@ -268,14 +647,27 @@ static int pipeBuilder(GstElement* *pipeline, const VideoCodingFormat_T codingFo
     GstElement *videoConverter = NULL;
     GstElement *videoRescaler = NULL;
     GstElement *videoSink = NULL;
+    GstElement *reorderBuffer = NULL;
     GstBus *bus = NULL;
+    GstPad *pad = NULL;
+    gboolean linked;
 
     if((NULL != pipeline) && (NUM_SUP_VID_COD_FMT > codingFormat)) {
 
         /* Instantiate pipeline and its elements */
-        networkSource = gst_element_factory_make("udpsrc", "UDP_Network_Source");
+        networkSource = gst_element_factory_make("udpsrc", STR_PIPE_ELEM_NAME_NETSRC);
         capsfilter = gst_element_factory_make("capsfilter", "Capabilities_Filter");
 
+        /* Multipath: packets of a faster path overtake the others (not fatal: decoded with the depayloader's losses) */
+        if(0U < streamContext.reorderMs) {
+
+            reorderBuffer = gst_element_factory_make("rtpjitterbuffer", "Reorder_Buffer");
+            if(NULL == reorderBuffer) {
+
+                createLogMessage(STR_LOG_MSG_FUNC6_REORDER_CREAT_FAIL, LOG_SVRTY_WRN);
+            }
+        }
+
         switch(codingFormat) {
 
             case CAM_FMT_H265:
@@ -393,9 +785,20 @@ static int pipeBuilder(GstElement* *pipeline, const VideoCodingFormat_T codingFo
                 return retval;
         }
 
-        videoConverter = gst_element_factory_make("videoconvert", "Video_Converter");
+        videoConverter = gst_element_factory_make("videoconvert", STR_PIPE_ELEM_NAME_VIDCONV);
         videoRescaler = gst_element_factory_make("videoscale", "Video_Rescaler");
-        videoSink = gst_element_factory_make("autovideosink", "Video_Sink");
+        if(streamContext.latency) {
+
+            videoSink = gst_element_factory_make("appsink", "Video_Sink");
+        }
+        else if(streamContext.headless) {
+
+            videoSink = gst_element_factory_make("fakesink", "Video_Sink");
+        }
+        else {
+
+            videoSink = gst_element_factory_make("autovideosink", "Video_Sink");
+        }
 
         *pipeline = gst_pipeline_new("Video_Display_Pipeline");
 
@@ -409,22 +812,84 @@ static int pipeBuilder(GstElement* *pipeline, const VideoCodingFormat_T codingFo
             return retval;
         }
 
+        /* Create network source socket once (it outlives pipeline rebuilds) */
+        if(NULL == networkSourceSocket) {
+
+            if(createNetworkSourceSocket(NUM_STREAM_SRC_PORT, &networkSourceSocket)) {
+
+                createLogMessage(STR_LOG_MSG_FUNC6_SOCK_CREAT_FAIL, LOG_SVRTY_ERR);
+
+                gst_object_unref(*pipeline);
+                gst_object_unref(networkSource);
+                gst_object_unref(capsfilter);
+                gst_object_unref(depayloader);
+                gst_object_unref(decoder);
+                gst_object_unref(videoConverter);
+                gst_object_unref(videoRescaler);
+                gst_object_unref(videoSink);
+                g_clear_object(&reorderBuffer);
+                *pipeline = NULL;
+                retval = -1;
+                return retval;
+            }
+        }
+
         /* Set pipeline common elements' properties */
         g_object_set(
             
             networkSource,
-            "port", NUM_STREAM_SRC_PORT,
-            "reuse", TRUE,
+            "socket", networkSourceSocket,
+            "close-socket", FALSE,
             "mtu", NUM_UDP_MTU,
             NULL
         );
         g_object_set(videoSink, "sync", FALSE, NULL);
+        if(streamContext.latency) {
+
+            /* The converter hands over the luma plane only */
+            caps = gst_caps_new_simple("video/x-raw", "format", G_TYPE_STRING, STR_LATENCY_SINK_FORMAT, NULL);
+            g_object_set(videoSink, "caps", caps, "emit-signals", TRUE, NULL);
+            gst_caps_unref(caps);
+            g_signal_connect(videoSink, "new-sample", G_CALLBACK(latencySampleCallback), NULL);
+        }
+        else if(streamContext.headless) {
+
+            g_object_set(videoSink, "signal-handoffs", TRUE, NULL);
+            g_signal_connect(videoSink, "handoff", G_CALLBACK(headlessHandoffCallback), NULL);
+        }
+        if(NULL != rtpDumpFile) {
+
+            pad = gst_element_get_static_pad(networkSource, "src");
+            gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, rtpDumpProbe, NULL, NULL);
+            gst_object_unref(pad);
+        }
+
+        /* After the dump (it records every received packet): decode each packet once */
+        pad = gst_element_get_static_pad(networkSource, "src");
+        gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, rtpDedupProbe, g_new0(RtpDedupState_T, 1), g_free);
+        gst_object_unref(pad);
+
+        if(NULL != reorderBuffer) {
+
+            /* Reorder by arrival only: the drone's clock is not recovered */
+            g_object_set(reorderBuffer, "latency", streamContext.reorderMs, "mode", 0, NULL);
+        }
 
         /* Build the pipeline */
         gst_bin_add_many(GST_BIN(*pipeline), networkSource, capsfilter, depayloader, decoder,
                  videoConverter, videoRescaler, videoSink, NULL);
-        if(TRUE != gst_element_link_many(networkSource, capsfilter, depayloader, decoder, 
-                videoConverter, videoRescaler, videoSink, NULL)) {
+        if(NULL != reorderBuffer) {
+
+            gst_bin_add(GST_BIN(*pipeline), reorderBuffer);
+            linked = gst_element_link_many(networkSource, capsfilter, reorderBuffer, depayloader, decoder,
+                videoConverter, videoRescaler, videoSink, NULL);
+        }
+        else {
+
+            linked = gst_element_link_many(networkSource, capsfilter, depayloader, decoder,
+                videoConverter, videoRescaler, videoSink, NULL);
+        }
+        if(TRUE != linked) {
 
             createLogMessage(STR_LOG_MSG_FUNC6_PIPE_LINK_FAIL, LOG_SVRTY_ERR);
 
@@ -440,29 +905,12 @@ static int pipeBuilder(GstElement* *pipeline, const VideoCodingFormat_T codingFo
         g_signal_connect(bus, "message::error", G_CALLBACK (pipelineErrorCallback), *pipeline);
         gst_object_unref(bus);
 
-        /* Start global main loop */
-        
-        // Note: Protect the creation of main loop on multithreaded applications
-
-        if(pthread_create(&threadStreamMainLoop, NULL, threadFuncStreamMainLoop, &loop)) {
+        /* Start global main loop (once: pipelines are rebuilt on coding format changes) */
+        if(!atomic_flag_test_and_set(&mainLoopStarted) &&
+                pthread_create(&threadStreamMainLoop, NULL, threadFuncStreamMainLoop, &loop)) {
             createLogMessage(STR_LOG_MSG_FUNC6_MAIN_LOOP_START_FAIL, LOG_SVRTY_ERR);
         }
 
-        /*
-         * As for multithreaded applications the main loop is also
-         * a shared global variable. The main loop is launched by
-         * the first pipeline builder after constructing the pipeline.
-         * Consecutive pipebuilders (threads) must ensure that the
-         * mainloop is already running so it is not started multiple
-         * times. For such scenarios a shared variable shoud be used
-         * protected with mutex and indicatin the main loop status.
-         * 
-         * A much simpler alternative is to launch the main loop
-         * on program initialization. Although adding watchers to
-         * the default context with main loop running on needs to
-         * be tested !
-         */
-
         /* Set pipeline to its initial state */
         ret = gst_element_set_state(*pipeline, PIPE_INITIAL_STATE);
         if(GST_STATE_CHANGE_FAILURE == ret) {
@@ -474,6 +922,9 @@ static int pipeBuilder(GstElement* *pipeline, const VideoCodingFormat_T codingFo
             retval = -1;
             return retval;
         }
+
+        /* Profile the pipeline's elements (if enabled, see profiler_utils.h) */
+        attachPipelineProfiler(*pipeline);
     }
     else {
 
@@ -484,9 +935,14 @@ static int pipeBuilder(GstElement* *pipeline, const VideoCodingFormat_T codingFo
     return retval;
 }
 
-int initStreamServices(void) {
+int initStreamServices(const StreamInitContext_T *initCtx) {
 
     int retval = 0;
+    guint32 dumpHeader[2] = {NUM_RTP_DUMP_VERSION, 0U};
+
+    /* Optional, configures the GStreamer tracers before 'gst_init()' (failures are logged) */
+    initPipelineProfiler((NULL != initCtx) ? initCtx->profileDir : NULL);
+    initPluginRegistry((NULL != initCtx) ? initCtx->pluginDir : NULL);
 
     if(FALSE == gst_init_check(NULL, NULL, NULL)) {
 
@@ -496,6 +952,279 @@ int initStreamServices(void) {
         return retval;
     }
 
+    /* Not fatal: reports a stale pinned plugin directory or static build early */
+    checkRequiredPlugins();
+
+    if(NULL != initCtx) {
+
+        streamContext.headless = initCtx->headless;
+        streamContext.latency = initCtx->headless && initCtx->latency;
+        if(0U != initCtx->streamPort) {
+
+            streamContext.streamPort = initCtx->streamPort;
+        }
+        streamContext.stallMs = initCtx->stallMs;
+        streamContext.multipath = initCtx->multipath || (0U < initCtx->reorderMs);
+        streamContext.reorderMs = streamContext.multipath ? initCtx->reorderMs : 0U;
+    }
+
+    /* Stall reports reach the drone service thread through a pipe (not fatal: the display runs unwatched) */
+    if(0U < streamContext.stallMs) {
+
+        if(pipe2(stallPipeFds, O_CLOEXEC | O_NONBLOCK) || initStallWatchdog(displayStallCallback, NULL)) {
+
+            createLogMessage(STR_LOG_MSG_FUNC7_STALL_PIPE_FAIL, LOG_SVRTY_WRN);
+            if(0 <= stallPipeFds[IDX_STALL_PIPE_READ]) {
+
+                /* The pipe was created, the watchdog failed */
+                close(stallPipeFds[IDX_STALL_PIPE_READ]);
+                close(stallPipeFds[IDX_STALL_PIPE_WRITE]);
+            }
+            stallPipeFds[IDX_STALL_PIPE_READ] = SOCK_FD_INVAL;
+            stallPipeFds[IDX_STALL_PIPE_WRITE] = SOCK_FD_INVAL;
+        }
+    }
+
+    if((NULL != initCtx) && (NULL != initCtx->dumpPath)) {
+
+        rtpDumpFile = fopen(initCtx->dumpPath, "wb");
+        if((NULL == rtpDumpFile) || (1 != fwrite(STR_RTP_DUMP_MAGIC, strlen(STR_RTP_DUMP_MAGIC), 1, rtpDumpFile)) ||
+           (1 != fwrite(dumpHeader, sizeof(dumpHeader), 1, rtpDumpFile))) {
+
+            createLogMessage(STR_LOG_MSG_FUNC7_DUMP_OPEN_FAIL, LOG_SVRTY_ERR);
+
+            if(NULL != rtpDumpFile) {
+
+                fclose(rtpDumpFile);
+                rtpDumpFile = NULL;
+            }
+            retval = -1;
+            return retval;
+        }
+    }
+
+    /* Runs on the default main context (see threadFuncStreamMainLoop()) */
+    if(streamContext.headless) {
+
+        g_timeout_add_seconds(NUM_HEADLESS_REPORT_PERIOD, headlessReportCallback, NULL);
+    }
+
+    return retval;
+}
+
+int isStreamHeadless(void) {
+
+    return streamContext.headless;
+}
+
+int isStreamMultipath(void) {
+
+    return streamContext.multipath;
+}
+
+static void headlessHandoffCallback(GstElement *sink, GstBuffer *buffer, GstPad *pad, gpointer data) {
+
+    countHeadlessFrame();
+}
+
+static void countHeadlessFrame(void) {
+
+    struct timespec now;
+
+    if(0ULL == atomic_fetch_add_explicit(&headlessFrames, 1ULL, memory_order_relaxed)) {
+
+        clock_gettime(CLOCK_REALTIME, &now);
+        atomic_store(&headlessFirstFrameNs, (unsigned long long)(now.tv_sec) * 1000000000ULL + (unsigned long long)(now.tv_nsec));
+    }
+}
+
+static GstFlowReturn latencySampleCallback(GstElement *sink, gpointer data) {
+
+    int width = 0;
+    int height = 0;
+    int decoded = FALSE;
+    int row, column, x, y;
+    unsigned int lumaSum;
+    guint16 words[NUM_LATENCY_STAMP_ROWS] = {0};
+    guint16 check = NUM_LATENCY_STAMP_CHECK;
+    guint64 captureUs, nowUs;
+    gsize stride;
+    struct timespec now;
+    GstMapInfo map;
+    GstSample *sample = NULL;
+    GstBuffer *buffer = NULL;
+    GstStructure *structure = NULL;
+
+    g_signal_emit_by_name(sink, "pull-sample", &sample);
+    if(NULL == sample) {
+
+        return GST_FLOW_OK;
+    }
+
+    clock_gettime(CLOCK_REALTIME, &now);
+    nowUs = (guint64)(now.tv_sec) * 1000000ULL + (guint64)(now.tv_nsec) / 1000ULL;
+    countHeadlessFrame();
+
+    structure = gst_caps_get_structure(gst_sample_get_caps(sample), 0);
+    gst_structure_get_int(structure, "width", &width);
+    gst_structure_get_int(structure, "height", &height);
+    buffer = gst_sample_get_buffer(sample);
+
+    if((NUM_LATENCY_STAMP_COLUMNS * NUM_LATENCY_STAMP_BLOCK <= width) && (NUM_LATENCY_STAMP_ROWS * NUM_LATENCY_STAMP_BLOCK <= height) &&
+       (NULL != buffer) && (TRUE == gst_buffer_map(buffer, &map, GST_MAP_READ))) {
+
+        /* GRAY8 rows are 4-byte aligned */
+        stride = GST_ROUND_UP_4(width);
+        if(map.size >= stride * (gsize)(height)) {
+
+            /* Average the inner half of every block: block edges suffer most from compression */
+            for(row = 0;row < NUM_LATENCY_STAMP_ROWS;++row) {
+
+                for(column = 0;column < NUM_LATENCY_STAMP_COLUMNS;++column) {
+
+                    lumaSum = 0U;
+                    for(y = NUM_LATENCY_STAMP_BLOCK / 4;y < 3 * NUM_LATENCY_STAMP_BLOCK / 4;++y) {
+
+                        for(x = NUM_LATENCY_STAMP_BLOCK / 4;x < 3 * NUM_LATENCY_STAMP_BLOCK / 4;++x) {
+
+                            lumaSum += map.data[(row * NUM_LATENCY_STAMP_BLOCK + y) * stride + column * NUM_LATENCY_STAMP_BLOCK + x];
+                        }
+                    }
+
+                    words[row] = (guint16)((words[row] << 1) |
+                        ((lumaSum > NUM_LATENCY_STAMP_THRESHOLD * (NUM_LATENCY_STAMP_BLOCK / 2) * (NUM_LATENCY_STAMP_BLOCK / 2)) ? 1U : 0U));
+                }
+
+                if(NUM_LATENCY_STAMP_ROWS - 1 > row) {
+
+                    check ^= words[row];
+                }
+            }
+
+            decoded = (check == words[NUM_LATENCY_STAMP_ROWS - 1]);
+        }
+
+        gst_buffer_unmap(buffer, &map);
+    }
+
+    if(decoded) {
+
+        captureUs = ((guint64)(words[0]) << 48) | ((guint64)(words[1]) << 32) | ((guint64)(words[2]) << 16) | (guint64)(words[3]);
+        fprintf(stdout, STR_LATENCY_SAMPLE, (unsigned int)(words[4]), (long long)(nowUs) - (long long)(captureUs));
+    }
+    else {
+
+        atomic_fetch_add_explicit(&latencyUndecoded, 1ULL, memory_order_relaxed);
+    }
+
+    gst_sample_unref(sample);
+
+    return GST_FLOW_OK;
+}
+
+static gboolean headlessReportCallback(gpointer data) {
+
+    static int firstFrameReported = FALSE;
+    struct timespec now;
+    unsigned long long firstFrameNs;
+    ArrivalLatency_T arrival;
+
+    clock_gettime(CLOCK_REALTIME, &now);
+
+    firstFrameNs = atomic_load(&headlessFirstFrameNs);
+    if((!firstFrameReported) && (0ULL != firstFrameNs)) {
+
+        fprintf(stdout, STR_HEADLESS_FIRST_FRAME, firstFrameNs);
+        firstFrameReported = TRUE;
+    }
+
+    fprintf(stdout, STR_HEADLESS_FRAMES, atomic_load(&headlessFrames),
+        (unsigned long long)(now.tv_sec) * 1000000000ULL + (unsigned long long)(now.tv_nsec));
+    if(streamContext.latency) {
+
+        fprintf(stdout, STR_LATENCY_UNDECODED, atomic_load(&latencyUndecoded));
+    }
+    if(streamContext.multipath) {
+
+        fprintf(stdout, STR_HEADLESS_DUPLICATES, atomic_load(&rtpDuplicates));
+    }
+    if(0 == takeArrivalLatency(&arrival)) {
+
+        fprintf(stdout, STR_HEADLESS_ARRIVAL, (long long)(arrival.meanUs), (long long)(arrival.maxUs), arrival.uncertaintyUs);
+    }
+    fflush(stdout);
+
+    return G_SOURCE_CONTINUE;
+}
+
+static int createNetworkSourceSocket(const int port, GSocket* *gsocket) {
+
+    int retval = 0;
+    int sockFd = SOCK_FD_INVAL;
+    int reuseAddrState = 1;
+    int bufferSize;
+    struct sockaddr_in address = {0};
+    GError *error = NULL;
+
+    if((0 >= port) || (NULL == gsocket)) {
+
+        createLogMessage(STR_LOG_MSG_FUNC22_ARG_INVAL, LOG_SVRTY_ERR);
+        retval = -1;
+        return retval;
+    }
+
+    sockFd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, IPPROTO_UDP);
+    if(0 > sockFd) {
+
+        perror("socket");
+        fflush(stderr);
+        createLogMessage(STR_LOG_MSG_FUNC22_SOCK_CREAT_FAIL, LOG_SVRTY_ERR);
+        retval = -1;
+        return retval;
+    }
+
+    if(0 > setsockopt(sockFd, SOL_SOCKET, SO_REUSEADDR, &reuseAddrState, sizeof(reuseAddrState))) {
+
+        perror("setsockopt");
+        fflush(stderr);
+        createLogMessage(STR_LOG_MSG_FUNC22_SOCK_CONF_FAIL, LOG_SVRTY_ERR);
+        close(sockFd);
+        retval = -1;
+        return retval;
+    }
+
+    /* Buffer must hold a full target-latency worth of video before the first drop */
+    bufferSize = setSocketBufferSize(sockFd, SO_RCVBUF, computeSocketBufferSize(NUM_QOS_VIDEO_BITRATE_KBPS, NUM_QOS_TARGET_LATENCY_MS));
+
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons((uint16_t)(port));
+    if(0 > bind(sockFd, (struct sockaddr*)(&address), sizeof(address))) {
+
+        perror("bind");
+        fflush(stderr);
+        createLogMessage(STR_LOG_MSG_FUNC22_SOCK_BIND_FAIL, LOG_SVRTY_ERR);
+        close(sockFd);
+        retval = -1;
+        return retval;
+    }
+
+    /* The GSocket takes ownership of the descriptor */
+    *gsocket = g_socket_new_from_fd(sockFd, &error);
+    if(NULL == *gsocket) {
+
+        createLogMessage(STR_LOG_MSG_FUNC22_GSOCK_CREAT_FAIL, LOG_SVRTY_ERR);
+        g_clear_error(&error);
+        close(sockFd);
+        retval = -1;
+        return retval;
+    }
+
+    if((0 >= bufferSize) || startReceiveBufferAutotune(sockFd, bufferSize)) {
+
+        createLogMessage(STR_LOG_MSG_FUNC22_AUTOTUNE_FAIL, LOG_SVRTY_WRN);
+    }
+
     return retval;
 }
 
@@ -503,6 +1232,7 @@ static void pipelineErrorCallback(GstBus *bus, GstMessage *message, gpointer dat
 
     GstElement *pipeline = (GstElement*)data;
 
+    disarmStallWatchdog();
     gst_element_set_state(pipeline, GST_STATE_NULL);
     createLogMessage(STR_LOG_MSG_FUNC14_PIPE_ERROR, LOG_SVRTY_ERR);
     fprintf(stdout, "\nError detected in video display pipeline. Please issue the 'stop' command to reset the system.\n");
@@ -532,4 +1262,121 @@ static void* threadFuncStreamMainLoop(void *arg) {
     }
 
     return NULL;
-}
\ No newline at end of file
+}
+
+static GstPadProbeReturn rtpDumpProbe(GstPad *pad, GstPadProbeInfo *info, gpointer data) {
+
+    guint64 arrivalNs;
+    guint32 length;
+    struct timespec now;
+    GstMapInfo map;
+    GstBuffer *buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+
+    if((NULL == rtpDumpFile) || (NULL == buffer) || (TRUE != gst_buffer_map(buffer, &map, GST_MAP_READ))) {
+
+        return GST_PAD_PROBE_OK;
+    }
+
+    clock_gettime(CLOCK_REALTIME, &now);
+    arrivalNs = (guint64)(now.tv_sec) * 1000000000ULL + (guint64)(now.tv_nsec);
+    length = (guint32)(map.size);
+
+    if((1 != fwrite(&arrivalNs, sizeof(arrivalNs), 1, rtpDumpFile)) || (1 != fwrite(&length, sizeof(length), 1, rtpDumpFile)) ||
+       ((0U < length) && (1 != fwrite(map.data, length, 1, rtpDumpFile)))) {
+
+        createLogMessage(STR_LOG_MSG_FUNC24_DUMP_WRITE_FAIL, LOG_SVRTY_ERR);
+        fclose(rtpDumpFile);
+        rtpDumpFile = NULL;
+    }
+    else if(arrivalNs - rtpDumpFlushNs >= NUM_RTP_DUMP_FLUSH_PERIOD_NS) {
+
+        fflush(rtpDumpFile);
+        rtpDumpFlushNs = arrivalNs;
+    }
+
+    gst_buffer_unmap(buffer, &map);
+
+    return GST_PAD_PROBE_OK;
+}
+
+static GstPadProbeReturn rtpDedupProbe(GstPad *pad, GstPadProbeInfo *info, gpointer data) {
+
+    guint8 header[NUM_RTP_HEADER_SIZE];
+    guint16 sequence, step;
+    guint32 ssrc;
+    gint16 delta;
+    RtpDedupState_T *state = (RtpDedupState_T*)(data);
+    GstBuffer *buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+
+    if((NULL == buffer) || (sizeof(header) != gst_buffer_extract(buffer, 0, header, sizeof(header))) ||
+       (NUM_RTP_VERSION != (header[0] >> 6))) {
+
+        return GST_PAD_PROBE_OK;
+    }
+
+    sequence = (guint16)((header[2] << 8) | header[3]);
+    ssrc = ((guint32)(header[8]) << 24) | ((guint32)(header[9]) << 16) | ((guint32)(header[10]) << 8) | (guint32)(header[11]);
+
+    if((!state->valid) || (ssrc != state->ssrc)) {
+
+        memset(state->seen, 0, sizeof(state->seen));
+        state->valid = TRUE;
+        state->ssrc = ssrc;
+        state->highest = sequence;
+    }
+    else {
+
+        delta = (gint16)(sequence - state->highest);
+        if(0 < delta) {
+
+            /* Ahead: forget the sequence numbers leaving the window */
+            if(NUM_RTP_DEDUP_WINDOW <= (guint16)(delta)) {
+
+                memset(state->seen, 0, sizeof(state->seen));
+            }
+            else {
+
+                for(step = 1;step <= (guint16)(delta);++step) {
+
+                    state->seen[((guint16)(state->highest + step) % NUM_RTP_DEDUP_WINDOW) / 64U] &=
+                        ~(1ULL << (((guint16)(state->highest + step) % NUM_RTP_DEDUP_WINDOW) % 64U));
+                }
+            }
+            state->highest = sequence;
+        }
+        else if((0 == delta) || ((NUM_RTP_DEDUP_WINDOW > (guint16)(-delta)) &&
+                (state->seen[(sequence % NUM_RTP_DEDUP_WINDOW) / 64U] & (1ULL << ((sequence % NUM_RTP_DEDUP_WINDOW) % 64U))))) {
+
+            atomic_fetch_add(&rtpDuplicates, 1ULL);
+            return GST_PAD_PROBE_DROP;
+        }
+        else if(NUM_RTP_DEDUP_WINDOW <= (guint16)(-delta)) {
+
+            return GST_PAD_PROBE_OK;
+        }
+    }
+
+    state->seen[(sequence % NUM_RTP_DEDUP_WINDOW) / 64U] |= 1ULL << ((sequence % NUM_RTP_DEDUP_WINDOW) % 64U);
+
+    if(header[1] & NUM_RTP_MARKER) {
+
+        recordFrameArrival(ssrc, ((guint32)(header[4]) << 24) | ((guint32)(header[5]) << 16) |
+            ((guint32)(header[6]) << 8) | (guint32)(header[7]), getGroundTimeNs());
+    }
+
+    return GST_PAD_PROBE_OK;
+}
+
+static void displayStallCallback(const char *watchName, const unsigned int stalledMs, void *data) {
+
+    guint32 report[NUM_STALL_REPORT_SIZE] = {0};
+
+    report[IDX_STALL_REPORT_DECODER] = (0 == strcmp(watchName, STR_STALL_WATCH_DECODER));
+    report[IDX_STALL_REPORT_MS] = stalledMs;
+
+    /* Atomic write (below PIPE_BUF), never blocks the main loop */
+    if(sizeof(report) != write(stallPipeFds[IDX_STALL_PIPE_WRITE], report, sizeof(report))) {
+
+        createLogMessage(STR_LOG_MSG_FUNC37_REPORT_WRITE_FAIL, LOG_SVRTY_ERR);
+    }
+}
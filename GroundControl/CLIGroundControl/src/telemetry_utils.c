@@ -0,0 +1,238 @@
+/**
+ * @file        telemetry_utils.c
+ * @author      Adam Csizy
+ * @date        2021-05-26
+ * @version     v1.1.0
+ *
+ * @brief       Drone telemetry session registry
+ */
+
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <syslog.h>
+#include <time.h>
+
+#include "log_utils.h"
+#include "stream_utils.h"
+#include "telemetry_utils.h"
+
+
+/* Telemetry related macro definitions */
+
+#define STR_HEADLESS_TELEMETRY      "[telemetry] drone=%u channel=%s v0=%d v1=%d v2=%d age_ms=%u\n" /**< Headless report of a received telemetry sample */
+#define NUM_NSEC_PER_MSEC           1000000ULL /**< Nanoseconds in a millisecond */
+
+
+/* Telemetry related static type declarations */
+
+/**
+ * @brief   Struct of a drone's telemetry session.
+ */
+typedef struct TelemetrySession {
+
+    int open;                                   /**< Flag whether the session is open */
+    uint32_t droneID;                           /**< Drone ID */
+    int valid[TLM_CHAN_COUNT];                  /**< Flags whether a channel has a sample */
+    TelemetrySample_T samples[TLM_CHAN_COUNT];  /**< Latest sample of every channel */
+    uint64_t receivedNs[TLM_CHAN_COUNT];        /**< Monotonic time of receiving the latest samples */
+
+} TelemetrySession_T;
+
+
+/* Telemetry related static variable declarations */
+
+static TelemetrySession_T sessions[NUM_TELEMETRY_SESSION_MAX];     /**< Session registry */
+static pthread_mutex_t registryLock = PTHREAD_MUTEX_INITIALIZER;    /**< Lock of the session registry */
+static const char *const channelNames[TLM_CHAN_COUNT] = {"position", "battery", "link"};  /**< Names of the telemetry channels */
+
+
+/* Telemetry related static function declarations */
+
+/**
+ * @brief       Get monotonic time.
+ *
+ * @return      CLOCK_MONOTONIC time in nanoseconds.
+ */
+static uint64_t getMonotonicNs(void);
+
+/**
+ * @brief       Find open session of a drone.
+ *
+ * @note        The registry lock must be held.
+ *
+ * @param[in]   droneID Drone ID.
+ *
+ * @return      Session of the drone or NULL.
+ */
+static TelemetrySession_T *findSession(const uint32_t droneID);
+
+
+/* Telemetry related function definitions */
+
+int openTelemetrySession(const uint32_t droneID) {
+
+    int retval = 0;
+    unsigned int i;
+    TelemetrySession_T *session = NULL;
+
+    pthread_mutex_lock(&registryLock);
+
+    /* A reconnecting drone starts over */
+    session = findSession(droneID);
+    for(i = 0;(i < NUM_TELEMETRY_SESSION_MAX) && (NULL == session);++i) {
+
+        if(!sessions[i].open) {
+
+            session = &sessions[i];
+        }
+    }
+
+    if(NULL == session) {
+
+        pthread_mutex_unlock(&registryLock);
+        fprintf(stdout, STR_LOG_MSG_FUNC38_REGISTRY_FULL, droneID);
+        fflush(stdout);
+        syslog(LOG_USER | LOG_WARNING, STR_LOG_MSG_FUNC38_REGISTRY_FULL, droneID);
+        retval = -1;
+        return retval;
+    }
+
+    memset(session, 0, sizeof(*session));
+    session->open = 1;
+    session->droneID = droneID;
+    pthread_mutex_unlock(&registryLock);
+
+    return retval;
+}
+
+void closeTelemetrySession(const uint32_t droneID) {
+
+    TelemetrySession_T *session = NULL;
+
+    pthread_mutex_lock(&registryLock);
+    session = findSession(droneID);
+    if(NULL != session) {
+
+        memset(session, 0, sizeof(*session));
+    }
+    pthread_mutex_unlock(&registryLock);
+}
+
+int publishTelemetry(const uint32_t droneID, const TelemetrySample_T *sample) {
+
+    int retval = 0;
+    TelemetrySession_T *session = NULL;
+
+    if((NULL == sample) || (0 > (int)(sample->channel)) || (TLM_CHAN_COUNT <= sample->channel)) {
+
+        createLogMessage(STR_LOG_MSG_FUNC39_ARG_INVAL, LOG_SVRTY_ERR);
+        retval = -1;
+        return retval;
+    }
+
+    pthread_mutex_lock(&registryLock);
+    session = findSession(droneID);
+    if(NULL != session) {
+
+        session->samples[sample->channel] = *sample;
+        session->receivedNs[sample->channel] = getMonotonicNs();
+        session->valid[sample->channel] = 1;
+    }
+    pthread_mutex_unlock(&registryLock);
+
+    if(NULL == session) {
+
+        createLogMessage(STR_LOG_MSG_FUNC39_NO_SESSION, LOG_SVRTY_WRN);
+        retval = -1;
+        return retval;
+    }
+
+    if(isStreamHeadless()) {
+
+        fprintf(stdout, STR_HEADLESS_TELEMETRY, droneID, channelNames[sample->channel],
+            sample->values[0], sample->values[1], sample->values[2], sample->ageMs);
+        fflush(stdout);
+    }
+
+    return retval;
+}
+
+int getTelemetry(const uint32_t droneID, const TelemetryChannel_T channel, TelemetrySample_T *sample) {
+
+    int retval = -1;
+    TelemetrySession_T *session = NULL;
+
+    if((NULL == sample) || (0 > (int)(channel)) || (TLM_CHAN_COUNT <= channel)) {
+
+        return retval;
+    }
+
+    pthread_mutex_lock(&registryLock);
+    session = findSession(droneID);
+    if((NULL != session) && session->valid[channel]) {
+
+        *sample = session->samples[channel];
+        sample->ageMs += (uint32_t)((getMonotonicNs() - session->receivedNs[channel]) / NUM_NSEC_PER_MSEC);
+        retval = 0;
+    }
+    pthread_mutex_unlock(&registryLock);
+
+    return retval;
+}
+
+void printTelemetry(const uint32_t droneID) {
+
+    unsigned int channel;
+    TelemetrySample_T sample;
+
+    printf("\nTelemetry of drone <%u>:\n\n", droneID);
+    for(channel = 0;channel < TLM_CHAN_COUNT;++channel) {
+
+        if(getTelemetry(droneID, (TelemetryChannel_T)(channel), &sample)) {
+
+            printf("\t%-10s -\n", channelNames[channel]);
+        }
+        else {
+
+            printf("\t%-10s %d %d %d (%u ms ago)\n", channelNames[channel], sample.values[0], sample.values[1], sample.values[2], sample.ageMs);
+        }
+    }
+    printf("\n");
+    fflush(stdout);
+}
+
+const char *getTelemetryChannelName(const TelemetryChannel_T channel) {
+
+    if((0 > (int)(channel)) || (TLM_CHAN_COUNT <= channel)) {
+
+        return "unknown";
+    }
+
+    return channelNames[channel];
+}
+
+static uint64_t getMonotonicNs(void) {
+
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return ((uint64_t)(now.tv_sec) * 1000ULL * NUM_NSEC_PER_MSEC) + (uint64_t)(now.tv_nsec);
+}
+
+static TelemetrySession_T *findSession(const uint32_t droneID) {
+
+    unsigned int i;
+
+    for(i = 0;i < NUM_TELEMETRY_SESSION_MAX;++i) {
+
+        if(sessions[i].open && (droneID == sessions[i].droneID)) {
+
+            return &sessions[i];
+        }
+    }
+
+    return NULL;
+}